@@ -25,6 +25,7 @@ ITK-IO-BMP
 ITK-IO-GDCM
 ITK-IO-GE
 ITK-IO-GIPL
+ITK-IO-HDF5
 ITK-IO-IPL
 ITK-IO-JPEG
 ITK-IO-LSM
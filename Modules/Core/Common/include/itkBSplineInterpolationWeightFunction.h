@@ -98,6 +98,22 @@ public:
   virtual void Evaluate(const ContinuousIndexType & index,
                         WeightsType & weights, IndexType & startIndex) const;
 
+  /** Evaluate the SplineOrder + 1 weights along one axis at the continuous
+   * index coordinate x, and the first index of the support along that
+   * axis. The weights returned by Evaluate() are products of these 1D
+   * weights, so the 1D weights of an axis can be reused for all the points
+   * which have the same coordinate along that axis. */
+  void Evaluate1D(double x, IndexValueType & start,
+                  double *weights1D) const;
+
+  /** Lookup table type. */
+  typedef Array2D< unsigned long > TableType;
+
+  /** Get the table giving, for each weight returned by Evaluate(), the
+   * index in the support region of the 1D weight of each axis. */
+  const TableType & GetOffsetToIndexTable() const
+  { return m_OffsetToIndexTable; }
+
   /** Get support region size. */
   itkGetConstMacro(SupportSize, SizeType);
 
@@ -118,9 +134,6 @@ private:
   /** Size of support region. */
   SizeType m_SupportSize;
 
-  /** Lookup table type. */
-  typedef Array2D< unsigned long > TableType;
-
   /** Table mapping linear offset to indices. */
   TableType m_OffsetToIndexTable;
 
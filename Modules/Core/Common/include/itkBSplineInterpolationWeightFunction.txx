@@ -114,23 +114,12 @@ void BSplineInterpolationWeightFunction< TCoordRep, VSpaceDimension,
 {
   unsigned int j, k;
 
-  // Find the starting index of the support region
-  for ( j = 0; j < SpaceDimension; j++ )
-    {
-    startIndex[j] = Math::Floor< IndexValueType >(index[j] - static_cast< double >( SplineOrder - 1 ) / 2.0);
-    }
-
-  // Compute the weights
+  // Find the starting index of the support region and compute the
+  // weights along each axis
   Matrix< double, SpaceDimension, SplineOrder + 1 > weights1D;
   for ( j = 0; j < SpaceDimension; j++ )
     {
-    double x = index[j] - static_cast< double >( startIndex[j] );
-
-    for ( k = 0; k <= SplineOrder; k++ )
-      {
-      weights1D[j][k] = m_Kernel->Evaluate(x);
-      x -= 1.0;
-      }
+    this->Evaluate1D(index[j], startIndex[j], weights1D[j]);
     }
 
   for ( k = 0; k < m_NumberOfWeights; k++ )
@@ -143,6 +132,26 @@ void BSplineInterpolationWeightFunction< TCoordRep, VSpaceDimension,
       }
     }
 }
+
+/** Compute the weights along one axis */
+template< class TCoordRep, unsigned int VSpaceDimension,
+          unsigned int VSplineOrder >
+void BSplineInterpolationWeightFunction< TCoordRep, VSpaceDimension,
+                                         VSplineOrder >
+::Evaluate1D(
+  double x,
+  IndexValueType & start,
+  double *weights1D) const
+{
+  start = Math::Floor< IndexValueType >(x - static_cast< double >( SplineOrder - 1 ) / 2.0);
+
+  double u = x - static_cast< double >( start );
+  for ( unsigned int k = 0; k <= SplineOrder; k++ )
+    {
+    weights1D[k] = m_Kernel->Evaluate(u);
+    u -= 1.0;
+    }
+}
 } // end namespace itk
 
 #endif
@@ -31,6 +31,7 @@
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkIntTypes.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -41,6 +42,10 @@ namespace itk
  * swapping. Byte swapping is often used when reading or writing binary
  * files. Files can either be Big Endian (BE) or Little Endian (LE).
  *
+ * Large ranges swapped in place are split into pieces swapped on up to
+ * the number of threads given by the caller, usually the NumberOfThreads
+ * of the ImageIO.
+ *
  * \ingroup IOFilters
  * \ingroup OSSystemObjects
  * \ingroup ITK-Common
@@ -85,8 +90,10 @@ public:
    * done in-place. 2, 4 and 8 byte swapping
    * can be handled. Single byte types are not swapped;
    * others raise an exception. The method is used to
-   * swap to and from Big Endian. */
-  static void SwapRangeFromSystemToBigEndian(T *p, BufferSizeType num);
+   * swap to and from Big Endian. Large ranges are swapped on up to
+   * numberOfThreads threads. */
+  static void SwapRangeFromSystemToBigEndian(T *p, BufferSizeType num,
+                                             int numberOfThreads = 1);
 
   /** Generic swap method handles type T. The data is
    * swapped and written (in binary) to the ostream
@@ -109,8 +116,10 @@ public:
    * done in-place. 2, 4 and 8 byte swapping
    * can be handled. Single byte types are not swapped;
    * others raise an exception. The method is used to
-   * swap to and from Little Endian. */
-  static void SwapRangeFromSystemToLittleEndian(T *p, BufferSizeType num);
+   * swap to and from Little Endian. Large ranges are swapped on up to
+   * numberOfThreads threads. */
+  static void SwapRangeFromSystemToLittleEndian(T *p, BufferSizeType num,
+                                                int numberOfThreads = 1);
 
   /** Generic swap method handles type T. The data is
    * swapped and written (in binary) to the ostream
@@ -160,6 +169,24 @@ protected:
   static void SwapWrite8Range(void *p, BufferSizeType num, OStreamType *fp);
 
 private:
+  typedef void (*SwapRangeFunctionType)(void *, BufferSizeType);
+
+  /** Structure passed to the threads swapping the pieces of a range. */
+  struct SwapRangeThreadStruct {
+    SwapRangeFunctionType SwapRange;
+    char *Pointer;
+    BufferSizeType NumberOfWords;
+    unsigned int WordSize;
+  };
+
+  /** Swap the range of num words of wordSize bytes with swapRange, in
+   * pieces on several threads if the range is large. */
+  static void SwapRangeInPieces(SwapRangeFunctionType swapRange, void *p,
+                                BufferSizeType num, unsigned int wordSize,
+                                int maximumNumberOfThreads);
+
+  static ITK_THREAD_RETURN_TYPE SwapRangeThreaderCallback(void *arg);
+
   ByteSwapper(const ByteSwapper &);    //purposely not implemented
   void operator=(const ByteSwapper &); //purposely not implemented
 };
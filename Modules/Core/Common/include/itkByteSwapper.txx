@@ -86,7 +86,7 @@ ByteSwapper< T >
 template< class T >
 void
 ByteSwapper< T >
-::SwapRangeFromSystemToBigEndian(T *, BufferSizeType)
+::SwapRangeFromSystemToBigEndian(T *, BufferSizeType, int)
 {
   // nothing needs to be done here...
 }
@@ -95,20 +95,20 @@ ByteSwapper< T >
 template< class T >
 void
 ByteSwapper< T >
-::SwapRangeFromSystemToBigEndian(T *p, BufferSizeType num)
+::SwapRangeFromSystemToBigEndian(T *p, BufferSizeType num, int numberOfThreads)
 {
   switch ( sizeof( T ) )
     {
     case 1:
       return;
     case 2:
-      ByteSwapper< T >::Swap2Range( (void *)p, num );
+      ByteSwapper< T >::SwapRangeInPieces(&ByteSwapper< T >::Swap2Range, (void *)p, num, 2, numberOfThreads);
       return;
     case 4:
-      ByteSwapper< T >::Swap4Range( (void *)p, num );
+      ByteSwapper< T >::SwapRangeInPieces(&ByteSwapper< T >::Swap4Range, (void *)p, num, 4, numberOfThreads);
       return;
     case 8:
-      ByteSwapper< T >::Swap8Range( (void *)p, num );
+      ByteSwapper< T >::SwapRangeInPieces(&ByteSwapper< T >::Swap8Range, (void *)p, num, 8, numberOfThreads);
       return;
     default:
       itkGenericExceptionMacro (<< "Cannot swap number of bytes requested");
@@ -191,20 +191,20 @@ ByteSwapper< T >
 template< class T >
 void
 ByteSwapper< T >
-::SwapRangeFromSystemToLittleEndian(T *p, BufferSizeType num)
+::SwapRangeFromSystemToLittleEndian(T *p, BufferSizeType num, int numberOfThreads)
 {
   switch ( sizeof( T ) )
     {
     case 1:
       return;
     case 2:
-      ByteSwapper< T >::Swap2Range( (void *)p, num );
+      ByteSwapper< T >::SwapRangeInPieces(&ByteSwapper< T >::Swap2Range, (void *)p, num, 2, numberOfThreads);
       return;
     case 4:
-      ByteSwapper< T >::Swap4Range( (void *)p, num );
+      ByteSwapper< T >::SwapRangeInPieces(&ByteSwapper< T >::Swap4Range, (void *)p, num, 4, numberOfThreads);
       return;
     case 8:
-      ByteSwapper< T >::Swap8Range( (void *)p, num );
+      ByteSwapper< T >::SwapRangeInPieces(&ByteSwapper< T >::Swap8Range, (void *)p, num, 8, numberOfThreads);
       return;
     default:
       itkGenericExceptionMacro (<< "Cannot swap number of bytes requested");
@@ -215,7 +215,7 @@ ByteSwapper< T >
 template< class T >
 void
 ByteSwapper< T >
-::SwapRangeFromSystemToLittleEndian(T *, BufferSizeType) {}
+::SwapRangeFromSystemToLittleEndian(T *, BufferSizeType, int) {}
 #endif
 
 #ifdef CMAKE_WORDS_BIGENDIAN
@@ -532,6 +532,61 @@ ByteSwapper< T >
     }
   delete[] cpy;
 }
+
+//------threaded swapping----------------------------------------------
+
+template< class T >
+void
+ByteSwapper< T >
+::SwapRangeInPieces(SwapRangeFunctionType swapRange, void *p,
+                    BufferSizeType num, unsigned int wordSize,
+                    int maximumNumberOfThreads)
+{
+  // below this number of words per thread, starting the threads costs
+  // more than it saves
+  const BufferSizeType minimumNumberOfWordsPerThread = 1 << 18;
+
+  BufferSizeType numberOfThreads = num / minimumNumberOfWordsPerThread;
+  if ( maximumNumberOfThreads < 1 || numberOfThreads > static_cast< BufferSizeType >( maximumNumberOfThreads ) )
+    {
+    numberOfThreads = maximumNumberOfThreads > 1 ? maximumNumberOfThreads : 1;
+    }
+  if ( numberOfThreads < 2 )
+    {
+    ( *swapRange )(p, num);
+    return;
+    }
+
+  SwapRangeThreadStruct str;
+  str.SwapRange = swapRange;
+  str.Pointer = reinterpret_cast< char * >( p );
+  str.NumberOfWords = num;
+  str.WordSize = wordSize;
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast< int >( numberOfThreads ) );
+  threader->SetSingleMethod(Self::SwapRangeThreaderCallback, &str);
+  threader->SingleMethodExecute();
+}
+
+template< class T >
+ITK_THREAD_RETURN_TYPE
+ByteSwapper< T >
+::SwapRangeThreaderCallback(void *arg)
+{
+  const MultiThreader::ThreadInfoStruct *info = (MultiThreader::ThreadInfoStruct *)( arg );
+  const SwapRangeThreadStruct *          str = (SwapRangeThreadStruct *)( info->UserData );
+
+  const BufferSizeType numberOfThreads = info->NumberOfThreads;
+  const BufferSizeType threadId = info->ThreadID;
+  const BufferSizeType piece = str->NumberOfWords / numberOfThreads;
+  const BufferSizeType first = piece * threadId;
+  const BufferSizeType num = ( threadId == numberOfThreads - 1 ) ? str->NumberOfWords - first : piece;
+
+  ( *str->SwapRange )(str->Pointer + first * str->WordSize, num);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
 } // end namespace itk
 
 #endif
@@ -20,6 +20,7 @@
 
 #include "itkTransformMeshFilter.h"
 #include "itkMacro.h"
+#include <vector>
 
 namespace itk
 {
@@ -92,13 +93,31 @@ TransformMeshFilter< TInputMesh, TOutputMesh, TTransform >
   typename InputPointsContainer::ConstIterator inputPoint  = inPoints->Begin();
   typename OutputPointsContainer::Iterator outputPoint = outPoints->Begin();
 
+  // The points are transformed by blocks, with one call to the transform
+  // per block
+  typedef typename TransformType::InputPointType  TransformInputPointType;
+  typedef typename TransformType::OutputPointType TransformOutputPointType;
+
+  const SizeValueType blockSize = 1024;
+  std::vector< TransformInputPointType >  inputBlock(blockSize);
+  std::vector< TransformOutputPointType > outputBlock(blockSize);
+
   while ( inputPoint != inPoints->End() )
     {
-    outputPoint.Value() =
-      m_Transform->TransformPoint( inputPoint.Value() );
-
-    ++inputPoint;
-    ++outputPoint;
+    SizeValueType numberOfPoints = 0;
+    while ( inputPoint != inPoints->End() && numberOfPoints < blockSize )
+      {
+      inputBlock[numberOfPoints++] = inputPoint.Value();
+      ++inputPoint;
+      }
+
+    m_Transform->TransformPoints(&inputBlock[0], &outputBlock[0], numberOfPoints);
+
+    for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+      {
+      outputPoint.Value() = outputBlock[i];
+      ++outputPoint;
+      }
     }
 
   // Create duplicate references to the rest of data on the mesh
@@ -136,6 +136,25 @@ public:
   /** Transform from azimuth-elevation to cartesian. */
   OutputPointType     TransformPoint(const InputPointType  & point) const;
 
+  /** The mapping is not affine: the points are transformed one at a time
+   * by TransformPoint() instead of the matrix of the superclass. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const
+  {
+    this->Transform< TScalarType, NDimensions, NDimensions >::TransformPoints(
+      inputPoints, outputPoints, numberOfPoints);
+  }
+
+  virtual void TransformScanline(const InputPointType & firstPoint,
+                                 const typename Superclass::InputVectorType & step,
+                                 OutputPointType *outputPoints,
+                                 SizeValueType numberOfPoints) const
+  {
+    this->Transform< TScalarType, NDimensions, NDimensions >::TransformScanline(
+      firstPoint, step, outputPoints, numberOfPoints);
+  }
+
   /** Back transform from cartesian to azimuth-elevation.  */
   inline InputPointType  BackTransform(const OutputPointType  & point) const
   {
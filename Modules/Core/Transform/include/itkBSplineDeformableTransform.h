@@ -146,6 +146,7 @@ public:
 
   /** Standard Jacobian container. */
   typedef typename Superclass::JacobianType JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
 
   /** Standard vector type for this class. */
   typedef Vector< TScalarType,
@@ -338,6 +339,22 @@ public:
                               ParameterIndexArrayType & indices,
                               bool & inside) const;
 
+  /** Transform several points. The weights and indices arrays used by
+   * each point are allocated once for all the points. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const;
+
+  /** Transform the points of a scanline. The 1D weights of the axes of
+   * the grid are computed for each point, or once for the whole scanline
+   * along the axes it doesn't cross, as for the rows of an image aligned
+   * with the grid, and the coefficients are read directly from their
+   * buffers. */
+  virtual void TransformScanline(const InputPointType & firstPoint,
+                                 const InputVectorType & step,
+                                 OutputPointType *outputPoints,
+                                 SizeValueType numberOfPoints) const;
+
   virtual void GetJacobian(const InputPointType & inputPoint,
                            WeightsType & weights,
                            ParameterIndexArrayType & indices
@@ -375,6 +392,17 @@ public:
   /** Compute the Jacobian Matrix of the transformation at one point */
   virtual const JacobianType & GetJacobian(const InputPointType  & point) const;
 
+  /** Compute the part of the Jacobian which may be non zero at one point:
+   * the weights of the support region of the point, for each dimension.
+   * This method doesn't modify the transform, and can be called from
+   * several threads. */
+  virtual void GetSparseJacobian(const InputPointType & point,
+                                 JacobianType & jacobian,
+                                 NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
+  /** Return the number of parameters in the support region of a point. */
+  virtual unsigned int GetNumberOfNonZeroJacobianIndices(void) const;
+
   /** Return the number of parameters that completely define the Transfom */
   virtual unsigned int GetNumberOfParameters(void) const;
 
@@ -23,6 +23,7 @@
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkIdentityTransform.h"
+#include <vector>
 
 namespace itk
 {
@@ -872,6 +873,153 @@ BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
   return outputPoint;
 }
 
+// Transform several points
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPoints(const InputPointType *inputPoints,
+                  OutputPointType *outputPoints,
+                  SizeValueType numberOfPoints) const
+{
+  WeightsType             weights( this->m_WeightsFunction->GetNumberOfWeights() );
+  ParameterIndexArrayType indices( this->m_WeightsFunction->GetNumberOfWeights() );
+  bool                    inside;
+
+  for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    this->TransformPoint(inputPoints[i], outputPoints[i], weights, indices, inside);
+    }
+}
+
+// Transform the points of a scanline
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformScanline(const InputPointType & firstPoint,
+                    const InputVectorType & step,
+                    OutputPointType *outputPoints,
+                    SizeValueType numberOfPoints) const
+{
+  if ( numberOfPoints == 0 )
+    {
+    return;
+    }
+
+  if ( !this->m_CoefficientImage[0] )
+    {
+    // No deformation, the points are mapped one at a time
+    this->Superclass::TransformScanline(firstPoint, step, outputPoints, numberOfPoints);
+    return;
+    }
+
+  // Start from the points mapped by the bulk transform
+  if ( this->m_BulkTransform )
+    {
+    this->m_BulkTransform->TransformScanline(firstPoint, step, outputPoints, numberOfPoints);
+    }
+  else
+    {
+    for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+      {
+      for ( unsigned int j = 0; j < SpaceDimension; j++ )
+        {
+        outputPoints[i][j] = firstPoint[j] + static_cast< ScalarType >( i ) * step[j];
+        }
+      }
+    }
+
+  // The continuous index in the grid of the coefficients is an affine
+  // function of the position along the scanline
+  ContinuousIndexType firstIndex;
+  ContinuousIndexType nextIndex;
+  this->m_CoefficientImage[0]->TransformPhysicalPointToContinuousIndex(firstPoint, firstIndex);
+  this->m_CoefficientImage[0]->TransformPhysicalPointToContinuousIndex(firstPoint + step, nextIndex);
+
+  // Offsets in the coefficient buffers of the weights of the support
+  // region, relative to its first index
+  const unsigned long numberOfWeights = this->m_WeightsFunction->GetNumberOfWeights();
+  const typename WeightsFunctionType::TableType & offsetToIndex =
+    this->m_WeightsFunction->GetOffsetToIndexTable();
+  const OffsetValueType *offsetTable = this->m_CoefficientImage[0]->GetOffsetTable();
+  std::vector< OffsetValueType > supportOffsets(numberOfWeights);
+  for ( unsigned long k = 0; k < numberOfWeights; k++ )
+    {
+    supportOffsets[k] = 0;
+    for ( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      supportOffsets[k] += offsetToIndex[k][j] * offsetTable[j];
+      }
+    }
+
+  const ParametersValueType *coefficients[SpaceDimension];
+  for ( unsigned int j = 0; j < SpaceDimension; j++ )
+    {
+    coefficients[j] = this->m_CoefficientImage[j]->GetBufferPointer();
+    }
+
+  // The 1D weights of the axes along which the scanline doesn't move are
+  // computed once for all the points
+  double weights1D[SpaceDimension][SplineOrder + 1];
+  bool   constantAxis[SpaceDimension];
+  ContinuousIndexType delta;
+  IndexType           supportIndex;
+  for ( unsigned int j = 0; j < SpaceDimension; j++ )
+    {
+    delta[j] = nextIndex[j] - firstIndex[j];
+    constantAxis[j] = ( delta[j] == 0.0 );
+    if ( constantAxis[j] )
+      {
+      this->m_WeightsFunction->Evaluate1D(firstIndex[j], supportIndex[j], weights1D[j]);
+      }
+    }
+
+  ContinuousIndexType index;
+  for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    for ( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      index[j] = firstIndex[j] + static_cast< double >( i ) * delta[j];
+      }
+
+    // NOTE: if the support region does not lie totally within the grid
+    // we assume zero displacement
+    if ( !this->InsideValidRegion(index) )
+      {
+      continue;
+      }
+
+    for ( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      if ( !constantAxis[j] )
+        {
+        this->m_WeightsFunction->Evaluate1D(index[j], supportIndex[j], weights1D[j]);
+        }
+      }
+
+    const OffsetValueType supportOffset = this->m_CoefficientImage[0]->ComputeOffset(supportIndex);
+    OutputPointType       displacement;
+    displacement.Fill(NumericTraits< ScalarType >::Zero);
+    for ( unsigned long k = 0; k < numberOfWeights; k++ )
+      {
+      double weight = weights1D[0][offsetToIndex[k][0]];
+      for ( unsigned int j = 1; j < SpaceDimension; j++ )
+        {
+        weight *= weights1D[j][offsetToIndex[k][j]];
+        }
+      const OffsetValueType offset = supportOffset + supportOffsets[k];
+      for ( unsigned int j = 0; j < SpaceDimension; j++ )
+        {
+        displacement[j] += static_cast< ScalarType >( weight * coefficients[j][offset] );
+        }
+      }
+
+    for ( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      outputPoints[i][j] += displacement[j];
+      }
+    }
+}
+
 // Compute the Jacobian in one position
 template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
 const
@@ -993,6 +1141,75 @@ BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
     }
 }
 
+// Compute the non zero part of the Jacobian in one position
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::GetSparseJacobian(const InputPointType & point,
+                    JacobianType & jacobian,
+                    NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  const unsigned int numberOfWeights = this->m_WeightsFunction->GetNumberOfWeights();
+  const unsigned int numberOfIndices = this->GetNumberOfNonZeroJacobianIndices();
+
+  if ( jacobian.rows() != SpaceDimension || jacobian.cols() != numberOfIndices )
+    {
+    jacobian.SetSize(SpaceDimension, numberOfIndices);
+    }
+  if ( nonZeroJacobianIndices.Size() != numberOfIndices )
+    {
+    nonZeroJacobianIndices.SetSize(numberOfIndices);
+    }
+  jacobian.Fill(0.0);
+
+  ContinuousIndexType index;
+  this->m_CoefficientImage[0]->TransformPhysicalPointToContinuousIndex(point, index);
+
+  // NOTE: if the support region does not lie totally within the grid
+  // we assume zero displacement: the Jacobian is zero
+  if ( !this->InsideValidRegion(index) )
+    {
+    nonZeroJacobianIndices.Fill(0);
+    return;
+    }
+
+  // The weights are computed directly in the first row of the Jacobian: the
+  // parameters of the first dimension come first.
+  WeightsType weights(jacobian[0], numberOfWeights, false);
+  IndexType   supportIndex;
+  this->m_WeightsFunction->Evaluate(index, weights, supportIndex);
+
+  RegionType supportRegion;
+  supportRegion.SetSize(this->m_SupportSize);
+  supportRegion.SetIndex(supportIndex);
+
+  typedef ImageRegionConstIterator< ImageType > IteratorType;
+  IteratorType               coeffIterator(this->m_CoefficientImage[0], supportRegion);
+  const ParametersValueType *basePointer = this->m_CoefficientImage[0]->GetBufferPointer();
+  const unsigned long        parametersPerDimension = this->GetNumberOfParametersPerDimension();
+
+  unsigned int counter = 0;
+  while ( !coeffIterator.IsAtEnd() )
+    {
+    const unsigned long parameterIndex = &( coeffIterator.Value() ) - basePointer;
+    for ( unsigned int j = 0; j < SpaceDimension; j++ )
+      {
+      jacobian(j, j * numberOfWeights + counter) = weights[counter];
+      nonZeroJacobianIndices[j * numberOfWeights + counter] = parameterIndex + j * parametersPerDimension;
+      }
+    ++counter;
+    ++coeffIterator;
+    }
+}
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+unsigned int
+BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::GetNumberOfNonZeroJacobianIndices() const
+{
+  return SpaceDimension * this->m_WeightsFunction->GetNumberOfWeights();
+}
+
 template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
 unsigned int
 BSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
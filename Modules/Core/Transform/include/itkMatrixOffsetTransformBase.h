@@ -319,6 +319,19 @@ public:
    * its argument as a vector. */
   OutputPointType     TransformPoint(const InputPointType & point) const;
 
+  /** Transform several points with the matrix and the offset, without a
+   * virtual call per point. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const;
+
+  /** Transform the points of a scanline: the image of the step is
+   * computed once and added to the image of the previous point. */
+  virtual void TransformScanline(const InputPointType & firstPoint,
+                                 const InputVectorType & step,
+                                 OutputPointType *outputPoints,
+                                 SizeValueType numberOfPoints) const;
+
   OutputVectorType    TransformVector(const InputVectorType & vector) const;
 
   OutputVnlVectorType TransformVector(const InputVnlVectorType & vector) const;
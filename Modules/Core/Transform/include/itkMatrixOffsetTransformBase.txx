@@ -186,6 +186,60 @@ MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
   return m_Matrix * point + m_Offset;
 }
 
+// Transform several points
+template< class TScalarType, unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+void
+MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPoints(const InputPointType *inputPoints,
+                  OutputPointType *outputPoints,
+                  SizeValueType numberOfPoints) const
+{
+  for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    const InputPointType & point = inputPoints[i];
+    OutputPointType &      outputPoint = outputPoints[i];
+    for ( unsigned int r = 0; r < NOutputDimensions; r++ )
+      {
+      ScalarType sum = m_Offset[r];
+      for ( unsigned int c = 0; c < NInputDimensions; c++ )
+        {
+        sum += m_Matrix(r, c) * point[c];
+        }
+      outputPoint[r] = sum;
+      }
+    }
+}
+
+// Transform the points of a scanline
+template< class TScalarType, unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+void
+MatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformScanline(const InputPointType & firstPoint,
+                    const InputVectorType & step,
+                    OutputPointType *outputPoints,
+                    SizeValueType numberOfPoints) const
+{
+  if ( numberOfPoints == 0 )
+    {
+    return;
+    }
+
+  // The transform is linear: the points of the scanline are mapped to
+  // points separated by the image of the step.
+  const OutputVectorType outputStep = m_Matrix * step;
+
+  outputPoints[0] = m_Matrix * firstPoint + m_Offset;
+  for ( SizeValueType i = 1; i < numberOfPoints; i++ )
+    {
+    for ( unsigned int r = 0; r < NOutputDimensions; r++ )
+      {
+      outputPoints[i][r] = outputPoints[i - 1][r] + outputStep[r];
+      }
+    }
+}
+
 // Transform a vector
 template< class TScalarType, unsigned int NInputDimensions,
           unsigned int NOutputDimensions >
@@ -20,6 +20,7 @@
 
 #include "itkTransformBase.h"
 #include "itkVector.h"
+#include "itkIntTypes.h"
 #include "vnl/vnl_vector_fixed.h"
 
 
@@ -98,6 +99,10 @@ public:
   /** Type of the Jacobian matrix. */
   typedef  Array2D< double > JacobianType;
 
+  /** Type of the array of the indices of the parameters which have a non
+   * zero derivative at a point. */
+  typedef  Array< unsigned long > NonZeroJacobianIndicesType;
+
   /** Standard vector type for this class. */
   typedef Vector< TScalarType, NInputDimensions >  InputVectorType;
   typedef Vector< TScalarType, NOutputDimensions > OutputVectorType;
@@ -127,6 +132,25 @@ public:
    */
   virtual OutputPointType TransformPoint(const InputPointType  &) const = 0;
 
+  /** Transform numberOfPoints points at once. outputPoints must have room
+   * for numberOfPoints points and must not overlap inputPoints. The default
+   * implementation calls TransformPoint() for each point; transforms which
+   * can share work between the points override it. Like TransformPoint(),
+   * this method must be thread-safe. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const;
+
+  /** Transform the numberOfPoints points firstPoint + i * step of a
+   * scanline, for example the physical points of a row of an image. The
+   * default implementation calls TransformPoint() for each point; linear
+   * transforms override it to compute each point with one addition. Like
+   * TransformPoint(), this method must be thread-safe. */
+  virtual void TransformScanline(const InputPointType & firstPoint,
+                                 const InputVectorType & step,
+                                 OutputPointType *outputPoints,
+                                 SizeValueType numberOfPoints) const;
+
   /**  Method to transform a vector. */
   virtual OutputVectorType    TransformVector(const InputVectorType &) const = 0;
 
@@ -199,6 +223,33 @@ public:
    * */
   virtual const JacobianType & GetJacobian(const InputPointType  &) const = 0;
 
+  /** Compute the part of the Jacobian of the transformation which may be
+   * non zero at a given input point.
+   *
+   * On return, nonZeroJacobianIndices contains the indices of the
+   * parameters which may have a non zero derivative at that point, and
+   * the column k of jacobian is the column nonZeroJacobianIndices[k] of the
+   * Jacobian returned by GetJacobian(). The other columns are zero. Both
+   * arrays are resized if needed, so they can be reused from one call to
+   * the next without any allocation.
+   *
+   * For the transforms with local support, like the BSplineDeformableTransform,
+   * the size of that part doesn't depend on the number of parameters, and
+   * the metrics which use it don't have to visit all the parameters for
+   * each point. Unlike GetJacobian(), the implementations provided by such
+   * transforms don't modify the transform, and can be called from several
+   * threads. The default implementation copies the result of GetJacobian()
+   * and returns all the parameters. */
+  virtual void GetSparseJacobian(const InputPointType & point,
+                                 JacobianType & jacobian,
+                                 NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
+  /** Return the maximum number of parameters which may have a non zero
+   * derivative at a point, i.e. the size of the array filled by
+   * GetSparseJacobian(). */
+  virtual unsigned int GetNumberOfNonZeroJacobianIndices(void) const
+  { return this->GetNumberOfParameters(); }
+
   /** Return the number of parameters that completely define the Transfom  */
   virtual unsigned int GetNumberOfParameters(void) const
   { return this->m_Parameters.Size(); }
@@ -51,6 +51,75 @@ Transform< TScalarType, NInputDimensions, NOutputDimensions >
   m_Jacobian(dimension, numberOfParameters)
 {}
 
+/**
+ * Transform several points
+ */
+template< class TScalarType,
+          unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+void
+Transform< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPoints(const InputPointType *inputPoints,
+                  OutputPointType *outputPoints,
+                  SizeValueType numberOfPoints) const
+{
+  for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    outputPoints[i] = this->TransformPoint(inputPoints[i]);
+    }
+}
+
+/**
+ * Transform the points of a scanline
+ */
+template< class TScalarType,
+          unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+void
+Transform< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformScanline(const InputPointType & firstPoint,
+                    const InputVectorType & step,
+                    OutputPointType *outputPoints,
+                    SizeValueType numberOfPoints) const
+{
+  for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    // computed from the first point to avoid accumulating rounding errors
+    InputPointType point;
+    for ( unsigned int d = 0; d < NInputDimensions; d++ )
+      {
+      point[d] = firstPoint[d] + static_cast< TScalarType >( i ) * step[d];
+      }
+    outputPoints[i] = this->TransformPoint(point);
+    }
+}
+
+/**
+ * Compute the part of the Jacobian which may be non zero
+ */
+template< class TScalarType,
+          unsigned int NInputDimensions,
+          unsigned int NOutputDimensions >
+void
+Transform< TScalarType, NInputDimensions, NOutputDimensions >
+::GetSparseJacobian(const InputPointType & point,
+                    JacobianType & jacobian,
+                    NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  // all the parameters may have a non zero derivative
+  jacobian = this->GetJacobian(point);
+
+  const unsigned int numberOfParameters = jacobian.cols();
+  if ( nonZeroJacobianIndices.Size() != numberOfParameters )
+    {
+    nonZeroJacobianIndices.SetSize(numberOfParameters);
+    }
+  for ( unsigned int i = 0; i < numberOfParameters; i++ )
+    {
+    nonZeroJacobianIndices[i] = i;
+    }
+}
+
 /**
  * GenerateName
  */
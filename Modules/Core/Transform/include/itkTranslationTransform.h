@@ -129,6 +129,17 @@ public:
    * vector. */
   OutputPointType     TransformPoint(const InputPointType  & point) const;
 
+  /** Translate several points, without a virtual call per point. */
+  virtual void TransformPoints(const InputPointType *inputPoints,
+                               OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const;
+
+  /** Translate the points of a scanline. */
+  virtual void TransformScanline(const InputPointType & firstPoint,
+                                 const InputVectorType & step,
+                                 OutputPointType *outputPoints,
+                                 SizeValueType numberOfPoints) const;
+
   OutputVectorType    TransformVector(const InputVectorType & vector) const;
 
   OutputVnlVectorType TransformVector(const InputVnlVectorType & vector) const;
@@ -125,6 +125,39 @@ TranslationTransform< TScalarType, NDimensions >::TransformPoint(const InputPoin
   return point + m_Offset;
 }
 
+// Transform several points
+template< class TScalarType, unsigned int NDimensions >
+void
+TranslationTransform< TScalarType, NDimensions >::TransformPoints(const InputPointType *inputPoints,
+                                                                  OutputPointType *outputPoints,
+                                                                  SizeValueType numberOfPoints) const
+{
+  for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    for ( unsigned int d = 0; d < NDimensions; d++ )
+      {
+      outputPoints[i][d] = inputPoints[i][d] + m_Offset[d];
+      }
+    }
+}
+
+// Transform the points of a scanline
+template< class TScalarType, unsigned int NDimensions >
+void
+TranslationTransform< TScalarType, NDimensions >::TransformScanline(const InputPointType & firstPoint,
+                                                                    const InputVectorType & step,
+                                                                    OutputPointType *outputPoints,
+                                                                    SizeValueType numberOfPoints) const
+{
+  for ( SizeValueType i = 0; i < numberOfPoints; i++ )
+    {
+    for ( unsigned int d = 0; d < NDimensions; d++ )
+      {
+      outputPoints[i][d] = firstPoint[d] + static_cast< TScalarType >( i ) * step[d] + m_Offset[d];
+      }
+    }
+}
+
 // Transform a vector
 template< class TScalarType, unsigned int NDimensions >
 typename TranslationTransform< TScalarType, NDimensions >::OutputVectorType
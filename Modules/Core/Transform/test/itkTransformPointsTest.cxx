@@ -0,0 +1,243 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkBSplineDeformableTransform.h"
+#include "itkAffineTransform.h"
+#include "itkTranslationTransform.h"
+#include "itkAzimuthElevationToCartesianTransform.h"
+#include "itkTimeProbe.h"
+#include <vector>
+
+// Check that TransformPoints() and TransformScanline() give the same
+// points as TransformPoint() called for each point, and report the
+// number of points transformed per second by each method. A scanline
+// along the first axis, as when walking the rows of an image, is checked
+// when alongFirstAxis is set.
+
+template< class TTransform >
+int ComparePoints(const TTransform *transform, const char *name,
+                  bool alongFirstAxis = false)
+{
+  typedef typename TTransform::InputPointType  InputPointType;
+  typedef typename TTransform::OutputPointType OutputPointType;
+  typedef typename TTransform::InputVectorType InputVectorType;
+
+  const unsigned int Dimension = TTransform::InputSpaceDimension;
+  const unsigned int numberOfPoints = 1000;
+
+  InputPointType firstPoint;
+  InputVectorType step;
+  for ( unsigned int d = 0; d < Dimension; d++ )
+    {
+    firstPoint[d] = 0.3 + 1.1 * d;
+    step[d] = ( alongFirstAxis && d > 0 ) ? 0.0 : 0.011 * ( d + 1 );
+    }
+
+  std::vector< InputPointType > inputPoints(numberOfPoints);
+  std::vector< OutputPointType > expected(numberOfPoints);
+  for ( unsigned int i = 0; i < numberOfPoints; i++ )
+    {
+    for ( unsigned int d = 0; d < Dimension; d++ )
+      {
+      inputPoints[i][d] = firstPoint[d] + i * step[d];
+      }
+    expected[i] = transform->TransformPoint(inputPoints[i]);
+    }
+
+  std::vector< OutputPointType > points(numberOfPoints);
+  std::vector< OutputPointType > scanline(numberOfPoints);
+  transform->TransformPoints(&inputPoints[0], &points[0], numberOfPoints);
+  transform->TransformScanline(firstPoint, step, &scanline[0], numberOfPoints);
+
+  int status = EXIT_SUCCESS;
+  for ( unsigned int i = 0; i < numberOfPoints; i++ )
+    {
+    for ( unsigned int d = 0; d < TTransform::OutputSpaceDimension; d++ )
+      {
+      // the scanline of a linear transform accumulates the steps
+      const double tolerance = 1e-9 * ( 1.0 + vnl_math_abs( expected[i][d] ) );
+      if ( vnl_math_abs( points[i][d] - expected[i][d] ) > tolerance )
+        {
+        std::cerr << name << ": TransformPoints gives " << points[i] << " instead of "
+                  << expected[i] << " for " << inputPoints[i] << std::endl;
+        return EXIT_FAILURE;
+        }
+      if ( vnl_math_abs( scanline[i][d] - expected[i][d] ) > tolerance )
+        {
+        std::cerr << name << ": TransformScanline gives " << scanline[i] << " instead of "
+                  << expected[i] << " for " << inputPoints[i] << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // benchmark
+  const unsigned int numberOfRepetitions = 200;
+  itk::TimeProbe     pointTimer;
+  itk::TimeProbe     pointsTimer;
+  itk::TimeProbe     scanlineTimer;
+  pointTimer.Start();
+  for ( unsigned int r = 0; r < numberOfRepetitions; r++ )
+    {
+    for ( unsigned int i = 0; i < numberOfPoints; i++ )
+      {
+      points[i] = transform->TransformPoint(inputPoints[i]);
+      }
+    }
+  pointTimer.Stop();
+  pointsTimer.Start();
+  for ( unsigned int r = 0; r < numberOfRepetitions; r++ )
+    {
+    transform->TransformPoints(&inputPoints[0], &points[0], numberOfPoints);
+    }
+  pointsTimer.Stop();
+  scanlineTimer.Start();
+  for ( unsigned int r = 0; r < numberOfRepetitions; r++ )
+    {
+    transform->TransformScanline(firstPoint, step, &scanline[0], numberOfPoints);
+    }
+  scanlineTimer.Stop();
+
+  const double total = numberOfPoints * numberOfRepetitions;
+  std::cout << name << " points/s: TransformPoint "
+            << total / vnl_math_max( pointTimer.GetTotal(), 1e-9 )
+            << ", TransformPoints " << total / vnl_math_max( pointsTimer.GetTotal(), 1e-9 )
+            << ", TransformScanline " << total / vnl_math_max( scanlineTimer.GetTotal(), 1e-9 )
+            << std::endl;
+
+  return status;
+}
+
+int itkTransformPointsTest(int, char *[])
+{
+  const unsigned int Dimension = 3;
+
+  int status = EXIT_SUCCESS;
+
+  typedef itk::AffineTransform< double, Dimension > AffineType;
+  AffineType::Pointer affine = AffineType::New();
+  AffineType::OutputVectorType axis;
+  axis[0] = 1.0;
+  axis[1] = 2.0;
+  axis[2] = 0.5;
+  affine->Rotate3D(axis, 0.3);
+  affine->Scale(1.2);
+  AffineType::OutputVectorType translation;
+  translation[0] = 3.0;
+  translation[1] = -1.0;
+  translation[2] = 0.25;
+  affine->Translate(translation);
+  if ( ComparePoints( affine.GetPointer(), "AffineTransform" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // uses the default implementations
+  typedef itk::TranslationTransform< double, Dimension > TranslationType;
+  TranslationType::Pointer translationTransform = TranslationType::New();
+  translationTransform->Translate(translation);
+  if ( ComparePoints( translationTransform.GetPointer(), "TranslationTransform" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // an AffineTransform which is not affine
+  typedef itk::AzimuthElevationToCartesianTransform< double, Dimension > AzimuthElevationType;
+  AzimuthElevationType::Pointer azimuthElevation = AzimuthElevationType::New();
+  azimuthElevation->SetAzimuthElevationToCartesianParameters(0.5, 1.0, 45, 45);
+  if ( ComparePoints( azimuthElevation.GetPointer(), "AzimuthElevationToCartesianTransform" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::BSplineDeformableTransform< double, Dimension, 3 > BSplineType;
+  BSplineType::Pointer bspline = BSplineType::New();
+
+  BSplineType::RegionType::SizeType size;
+  size.Fill(10);
+  BSplineType::RegionType region;
+  region.SetSize(size);
+  BSplineType::SpacingType spacing;
+  spacing.Fill(2.0);
+  BSplineType::OriginType origin;
+  origin.Fill(-4.0);
+  bspline->SetGridSpacing(spacing);
+  bspline->SetGridOrigin(origin);
+  bspline->SetGridRegion(region);
+
+  BSplineType::ParametersType parameters( bspline->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < parameters.Size(); p++ )
+    {
+    parameters[p] = 0.01 * ( p % 17 );
+    }
+  bspline->SetParametersByValue(parameters);
+  bspline->SetBulkTransform(affine);
+
+  // the last points are outside the valid region of the grid
+  if ( ComparePoints( bspline.GetPointer(), "BSplineDeformableTransform" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( ComparePoints( bspline.GetPointer(), "BSplineDeformableTransform (rows)", true ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // a 2D grid with a direction
+  typedef itk::BSplineDeformableTransform< double, 2, 3 > BSpline2DType;
+  BSpline2DType::Pointer bspline2D = BSpline2DType::New();
+
+  BSpline2DType::RegionType::SizeType size2D;
+  size2D.Fill(12);
+  BSpline2DType::RegionType region2D;
+  region2D.SetSize(size2D);
+  BSpline2DType::SpacingType spacing2D;
+  spacing2D[0] = 1.5;
+  spacing2D[1] = 0.75;
+  BSpline2DType::OriginType origin2D;
+  origin2D.Fill(-3.0);
+  BSpline2DType::DirectionType direction2D;
+  direction2D[0][0] = 0.8;
+  direction2D[0][1] = -0.6;
+  direction2D[1][0] = 0.6;
+  direction2D[1][1] = 0.8;
+  bspline2D->SetGridSpacing(spacing2D);
+  bspline2D->SetGridOrigin(origin2D);
+  bspline2D->SetGridRegion(region2D);
+  bspline2D->SetGridDirection(direction2D);
+
+  BSpline2DType::ParametersType parameters2D( bspline2D->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < parameters2D.Size(); p++ )
+    {
+    parameters2D[p] = 0.02 * ( p % 13 ) - 0.1;
+    }
+  bspline2D->SetParametersByValue(parameters2D);
+  if ( ComparePoints( bspline2D.GetPointer(), "BSplineDeformableTransform 2D" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( ComparePoints( bspline2D.GetPointer(), "BSplineDeformableTransform 2D (rows)", true ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
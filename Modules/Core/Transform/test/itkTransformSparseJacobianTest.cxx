@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkBSplineDeformableTransform.h"
+#include "itkAffineTransform.h"
+
+// Check that the sparse Jacobian returned by GetSparseJacobian(), once
+// scattered in a matrix with one column per parameter, is equal to the
+// full Jacobian returned by GetJacobian().
+
+template< class TTransform >
+int CompareSparseAndFullJacobians(const TTransform *transform,
+                                  const typename TTransform::InputPointType & point,
+                                  const char *name)
+{
+  typedef typename TTransform::JacobianType               JacobianType;
+  typedef typename TTransform::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+
+  JacobianType               sparse;
+  NonZeroJacobianIndicesType indices;
+  transform->GetSparseJacobian(point, sparse, indices);
+
+  if ( indices.Size() != transform->GetNumberOfNonZeroJacobianIndices()
+       || sparse.cols() != indices.Size()
+       || sparse.rows() != TTransform::OutputSpaceDimension )
+    {
+    std::cerr << name << ": wrong size of the sparse Jacobian at " << point << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  JacobianType scattered(TTransform::OutputSpaceDimension, numberOfParameters);
+  scattered.Fill(0.0);
+  for ( unsigned int k = 0; k < indices.Size(); k++ )
+    {
+    if ( indices[k] >= numberOfParameters )
+      {
+      std::cerr << name << ": parameter index out of range at " << point << std::endl;
+      return EXIT_FAILURE;
+      }
+    for ( unsigned int d = 0; d < TTransform::OutputSpaceDimension; d++ )
+      {
+      scattered(d, indices[k]) += sparse(d, k);
+      }
+    }
+
+  const JacobianType & full = transform->GetJacobian(point);
+  for ( unsigned int d = 0; d < TTransform::OutputSpaceDimension; d++ )
+    {
+    for ( unsigned int p = 0; p < numberOfParameters; p++ )
+      {
+      if ( vnl_math_abs( scattered(d, p) - full(d, p) ) > 1e-10 )
+        {
+        std::cerr << name << ": the sparse and full Jacobians differ at " << point
+                  << " for the parameter " << p << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+int itkTransformSparseJacobianTest(int, char *[])
+{
+  const unsigned int Dimension = 3;
+
+  int status = EXIT_SUCCESS;
+
+  // a B-spline transform, whose Jacobian only has (SplineOrder + 1)^Dimension
+  // non zero columns per dimension
+  typedef itk::BSplineDeformableTransform< double, Dimension, 3 > BSplineType;
+  BSplineType::Pointer bspline = BSplineType::New();
+
+  BSplineType::RegionType::SizeType size;
+  size.Fill(8);
+  BSplineType::RegionType region;
+  region.SetSize(size);
+  BSplineType::SpacingType spacing;
+  spacing.Fill(2.0);
+  BSplineType::OriginType origin;
+  origin.Fill(-2.0);
+  bspline->SetGridSpacing(spacing);
+  bspline->SetGridOrigin(origin);
+  bspline->SetGridRegion(region);
+
+  BSplineType::ParametersType parameters( bspline->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < parameters.Size(); p++ )
+    {
+    parameters[p] = 0.01 * ( p % 17 );
+    }
+  bspline->SetParametersByValue(parameters);
+
+  if ( bspline->GetNumberOfNonZeroJacobianIndices() != Dimension * 64 )
+    {
+    std::cerr << "Wrong number of non zero Jacobian indices for the B-spline transform: "
+              << bspline->GetNumberOfNonZeroJacobianIndices() << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  BSplineType::InputPointType point;
+  for ( unsigned int i = 0; i < 20; i++ )
+    {
+    point[0] = 0.3 + 0.47 * i;
+    point[1] = 1.1 + 0.31 * i;
+    point[2] = 0.05 + 0.6 * i;
+    // the last points are outside the valid region of the grid
+    if ( CompareSparseAndFullJacobians( bspline.GetPointer(), point, "BSplineDeformableTransform" )
+         != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+
+  // an affine transform, which uses the default implementation
+  typedef itk::AffineTransform< double, Dimension > AffineType;
+  AffineType::Pointer affine = AffineType::New();
+  AffineType::OutputVectorType axis;
+  axis[0] = 1.0;
+  axis[1] = 2.0;
+  axis[2] = 0.5;
+  affine->Rotate3D(axis, 0.3);
+  affine->Scale(1.2);
+
+  if ( affine->GetNumberOfNonZeroJacobianIndices() != affine->GetNumberOfParameters() )
+    {
+    std::cerr << "Wrong number of non zero Jacobian indices for the affine transform." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  point[0] = 3.0;
+  point[1] = -1.5;
+  point[2] = 7.25;
+  if ( CompareSparseAndFullJacobians( affine.GetPointer(), point, "AffineTransform" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTieredRankHistogram_h
+#define __itkTieredRankHistogram_h
+
+#include "itkNumericTraits.h"
+#include "itkMacro.h"
+#include "itkIntTypes.h"
+#include <vector>
+#include <algorithm>
+
+namespace itk
+{
+namespace Function
+{
+/** \class TieredRankHistogram
+ * \brief A histogram with two levels of bins, to find quickly the value
+ * of a given rank among the pixels of a moving window.
+ *
+ * The histogram has one bin for each value of the pixel type, and the
+ * bins are grouped in blocks whose counts are kept up to date in a
+ * second, coarser, array.  Adding or removing a pixel is O(1), and
+ * finding the value of rank k only requires to scan the coarse array,
+ * then the fine bins of one block: 2 * 16 bins for 8 bit types and
+ * 2 * 256 bins for 16 bit types, instead of the 65536 bins of a flat
+ * histogram or the sort of the whole window.
+ *
+ * The histogram can only be used with integer pixel types of 16 bits
+ * or less: IsSupported() returns false for the other types, which must
+ * be handled by another algorithm, and no memory is allocated for them.
+ *
+ * \sa MedianImageFilter, RankImageFilter
+ * \ingroup ITK-ImageFilterBase
+ */
+template< class TPixel >
+class TieredRankHistogram
+{
+public:
+  typedef TPixel        PixelType;
+  typedef SizeValueType CountType;
+
+  TieredRankHistogram()
+  {
+    m_Entries = 0;
+    m_Minimum = 0;
+    m_Shift = 0;
+    if ( IsSupported() )
+      {
+      m_Minimum = static_cast< OffsetValueType >( NumericTraits< PixelType >::NonpositiveMin() );
+      const SizeValueType numberOfBins = static_cast< SizeValueType >(
+        static_cast< OffsetValueType >( NumericTraits< PixelType >::max() ) - m_Minimum + 1 );
+      // blocks of 2^(bits/2) bins: the coarse and fine scans have the same length
+      m_Shift = sizeof( PixelType ) * 4;
+      m_Bins.resize(numberOfBins, 0);
+      m_CoarseBins.resize( ( ( numberOfBins - 1 ) >> m_Shift ) + 1, 0 );
+      }
+  }
+
+  ~TieredRankHistogram() {}
+
+  /** Return true if the pixel type can be stored in the histogram. */
+  static bool IsSupported()
+  {
+    return NumericTraits< PixelType >::is_integer && sizeof( PixelType ) <= 2;
+  }
+
+  void AddPixel(const PixelType & p)
+  {
+    const SizeValueType bin = this->GetBin(p);
+
+    ++m_Bins[bin];
+    ++m_CoarseBins[bin >> m_Shift];
+    ++m_Entries;
+  }
+
+  void RemovePixel(const PixelType & p)
+  {
+    const SizeValueType bin = this->GetBin(p);
+
+    itkAssertInDebugAndIgnoreInReleaseMacro(m_Bins[bin] > 0);
+    --m_Bins[bin];
+    --m_CoarseBins[bin >> m_Shift];
+    --m_Entries;
+  }
+
+  /** Remove all the pixels from the histogram. */
+  void Clear()
+  {
+    std::fill(m_Bins.begin(), m_Bins.end(), 0);
+    std::fill(m_CoarseBins.begin(), m_CoarseBins.end(), 0);
+    m_Entries = 0;
+  }
+
+  CountType GetNumberOfEntries() const
+  {
+    return m_Entries;
+  }
+
+  /** Return the value at position rank, starting from 0, in the
+   * sorted list of the pixels of the histogram. rank must be lower
+   * than the number of entries. */
+  PixelType GetValueAtRank(CountType rank) const
+  {
+    itkAssertInDebugAndIgnoreInReleaseMacro(rank < m_Entries);
+
+    SizeValueType coarse = 0;
+    while ( m_CoarseBins[coarse] <= rank )
+      {
+      rank -= m_CoarseBins[coarse];
+      ++coarse;
+      }
+    SizeValueType bin = coarse << m_Shift;
+    while ( m_Bins[bin] <= rank )
+      {
+      rank -= m_Bins[bin];
+      ++bin;
+      }
+    return static_cast< PixelType >( static_cast< OffsetValueType >( bin ) + m_Minimum );
+  }
+
+  /** Return the maximum number of bins visited by GetValueAtRank(). It
+   * can be used to choose between this histogram and a sort of the
+   * pixels. */
+  static SizeValueType GetMaximumNumberOfVisitedBins()
+  {
+    if ( !IsSupported() )
+      {
+      return 0;
+      }
+    const unsigned int  shift = sizeof( PixelType ) * 4;
+    const SizeValueType numberOfBins = static_cast< SizeValueType >(
+      static_cast< OffsetValueType >( NumericTraits< PixelType >::max() )
+      - static_cast< OffsetValueType >( NumericTraits< PixelType >::NonpositiveMin() ) + 1 );
+    return ( ( numberOfBins - 1 ) >> shift ) + 1 + ( static_cast< SizeValueType >( 1 ) << shift );
+  }
+
+private:
+  SizeValueType GetBin(const PixelType & p) const
+  {
+    return static_cast< SizeValueType >( static_cast< OffsetValueType >( p ) - m_Minimum );
+  }
+
+  typedef std::vector< CountType > BinContainerType;
+
+  BinContainerType m_Bins;
+  BinContainerType m_CoarseBins;
+  CountType        m_Entries;
+  OffsetValueType  m_Minimum;
+  unsigned int     m_Shift;
+};
+} // end namespace Function
+} // end namespace itk
+
+#endif
@@ -22,6 +22,7 @@
 #include <iostream>
 
 #include "itkTernaryFunctorImageFilter.txx"
+#include "itkTieredRankHistogram.h"
 #include "itkFilterWatcher.h"
 #include "itkNoiseImageFilter.txx"
 #include "itkBinaryFunctorImageFilter.h"
@@ -25,6 +25,7 @@
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkSpecialCoordinatesImage.h"
+#include <vector>
 
 namespace itk
 {
@@ -246,16 +247,30 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
   // Get ths input pointers
   InputImageConstPointer inputPtr = this->GetInput();
 
-  // Create an iterator that will walk the output region for this thread.
-  typedef ImageRegionIteratorWithIndex< TOutputImage > OutputIterator;
+  // Create an iterator that will walk the output region for this thread,
+  // one scanline at a time.
+  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputIterator;
   OutputIterator outIt(outputPtr, outputRegionForThread);
+  outIt.SetDirection(0);
 
-  // Define a few indices that will be used to translate from an input pixel
-  // to an output pixel
-  PointType outputPoint;         // Coordinates of current output pixel
-  PointType inputPoint;          // Coordinates of current input pixel
+  // The points of an output scanline are mapped by the transform at once
+  const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+  std::vector< PointType > outputPoints(lineLength);
+  std::vector< PointType > inputPoints(lineLength);
+
+  // The physical points of a scanline are equally spaced, unless the
+  // output is a SpecialCoordinatesImage
+  typedef SpecialCoordinatesImage< PixelType, ImageDimension >
+  OutputSpecialCoordinatesImageType;
+  const bool outputIsLinear =
+    dynamic_cast< const OutputSpecialCoordinatesImageType * >( outputPtr.GetPointer() ) == 0;
+
+  typedef typename PointType::VectorType VectorType;
+  VectorType step;
+  step.Fill(0.0);
 
   ContinuousInputIndexType inputIndex;
+  IndexType                index;
 
   // Support for progress methods/callbacks
   ProgressReporter progress( this,
@@ -271,54 +286,85 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
   const OutputType minOutputValue = static_cast< OutputType >( minValue );
   const OutputType maxOutputValue = static_cast< OutputType >( maxValue );
 
+  if ( outputIsLinear && lineLength > 1 )
+    {
+    // The physical step between two pixels of a scanline
+    PointType firstPoint;
+    PointType nextPoint;
+    index = outIt.GetIndex();
+    outputPtr->TransformIndexToPhysicalPoint(index, firstPoint);
+    ++index[0];
+    outputPtr->TransformIndexToPhysicalPoint(index, nextPoint);
+    step = nextPoint - firstPoint;
+    }
+
   // Walk the output region
   outIt.GoToBegin();
 
   while ( !outIt.IsAtEnd() )
     {
-    // Determine the index of the current output pixel
-    outputPtr->TransformIndexToPhysicalPoint(outIt.GetIndex(), outputPoint);
-
-    // Compute corresponding input pixel position
-    inputPoint = this->m_Transform->TransformPoint(outputPoint);
-    inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
-
-    // Evaluate input at right position and copy to the output
-    if ( m_Interpolator->IsInsideBuffer(inputIndex) )
+    // Compute the input points of the pixels of the scanline
+    index = outIt.GetIndex();
+    if ( outputIsLinear )
       {
-      PixelType        pixval;
-      OutputType       value;
-      if ( m_InterpolatorIsBSpline )
-        {
-        value = m_BSplineInterpolator
-                 ->EvaluateAtContinuousIndex(inputIndex, threadId);
-        }
-      else
-        {
-        value = m_Interpolator ->EvaluateAtContinuousIndex(inputIndex);
-        }
-      // Check boundaries and assign
-      if ( value < minOutputValue )
+      PointType firstPoint;
+      outputPtr->TransformIndexToPhysicalPoint(index, firstPoint);
+      this->m_Transform->TransformScanline(firstPoint, step, &inputPoints[0], lineLength);
+      }
+    else
+      {
+      for ( SizeValueType i = 0; i < lineLength; i++ )
         {
-        pixval = minValue;
+        outputPtr->TransformIndexToPhysicalPoint(index, outputPoints[i]);
+        ++index[0];
         }
-      else if ( value > maxOutputValue )
+      this->m_Transform->TransformPoints(&outputPoints[0], &inputPoints[0], lineLength);
+      }
+
+    SizeValueType i = 0;
+    while ( !outIt.IsAtEndOfLine() )
+      {
+      inputPtr->TransformPhysicalPointToContinuousIndex(inputPoints[i], inputIndex);
+
+      // Evaluate input at right position and copy to the output
+      if ( m_Interpolator->IsInsideBuffer(inputIndex) )
         {
-        pixval = maxValue;
+        PixelType        pixval;
+        OutputType       value;
+        if ( m_InterpolatorIsBSpline )
+          {
+          value = m_BSplineInterpolator
+                   ->EvaluateAtContinuousIndex(inputIndex, threadId);
+          }
+        else
+          {
+          value = m_Interpolator ->EvaluateAtContinuousIndex(inputIndex);
+          }
+        // Check boundaries and assign
+        if ( value < minOutputValue )
+          {
+          pixval = minValue;
+          }
+        else if ( value > maxOutputValue )
+          {
+          pixval = maxValue;
+          }
+        else
+          {
+          pixval = static_cast< PixelType >( value );
+          }
+        outIt.Set(pixval);
         }
       else
         {
-        pixval = static_cast< PixelType >( value );
+        outIt.Set(m_DefaultPixelValue); // default background value
         }
-      outIt.Set(pixval);
-      }
-    else
-      {
-      outIt.Set(m_DefaultPixelValue); // default background value
-      }
 
-    progress.CompletedPixel();
-    ++outIt;
+      progress.CompletedPixel();
+      ++outIt;
+      ++i;
+      }
+    outIt.NextLine();
     }
 
   return;
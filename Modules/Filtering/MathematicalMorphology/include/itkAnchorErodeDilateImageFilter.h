@@ -22,6 +22,7 @@
 #include "itkProgressReporter.h"
 #include "itkAnchorErodeDilateLine.h"
 #include "itkBresenhamLine.h"
+#include "itkSharedMorphologyUtilities.h"
 
 namespace itk
 {
@@ -95,6 +96,8 @@ private:
 
   // the class that operates on lines
   typedef AnchorErodeDilateLine< InputImagePixelType, TFunction1 > AnchorLineType;
+
+  typedef CompareToExtremumFunctor< InputImagePixelType, TFunction1 > ExtremumFunctorType;
 }; // end of class
 } // end namespace itk
 
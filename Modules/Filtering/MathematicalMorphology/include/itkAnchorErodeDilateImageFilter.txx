@@ -102,22 +102,34 @@ AnchorErodeDilateImageFilter< TImage, TKernel, TFunction1 >
       ++SELength;
       }
 
-    InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
-
-    AnchorLine.SetSize(SELength);
-
-    DoAnchorFace< TImage, BresType, AnchorLineType, KernelLType >(
-      input,
-      output,
-      m_Boundary,
-      ThisLine,
-      AnchorLine,
-      TheseOffsets,
-      inbuffer,
-      buffer,
-      IReg,
-      BigFace
-      );
+    unsigned int axis;
+    if ( IsAxisAlignedLine< KernelLType >(ThisLine, axis) )
+      {
+      // lines along an image axis, as in the decomposition of the boxes
+      // and of the polygons, are processed by blocks of parallel lines
+      // with the van Herk/Gil-Werman algorithm, which gives the same
+      // result
+      DoAxisAlignedFace< TImage, ExtremumFunctorType >(input, output, m_Boundary, axis, SELength, IReg);
+      }
+    else
+      {
+      InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
+
+      AnchorLine.SetSize(SELength);
+
+      DoAnchorFace< TImage, BresType, AnchorLineType, KernelLType >(
+        input,
+        output,
+        m_Boundary,
+        ThisLine,
+        AnchorLine,
+        TheseOffsets,
+        inbuffer,
+        buffer,
+        IReg,
+        BigFace
+        );
+      }
     // after the first pass the input will be taken from the output
     input = internalbuffer;
     progress.CompletedPixel();
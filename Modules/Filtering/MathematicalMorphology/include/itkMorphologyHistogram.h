@@ -20,6 +20,7 @@
 
 #include <map>
 #include <vector>
+#include <algorithm>
 #include "itkIntTypes.h"
 #include "itkNumericTraits.h"
 
@@ -117,19 +118,29 @@ public:
   VectorMorphologyHistogram()
   {
     // initialize members need for the vector based algorithm
-    m_Vector.resize(NumericTraits< TInputPixel >::max() - NumericTraits< TInputPixel >::NonpositiveMin() + 1 , 0);
+    const SizeValueType numberOfBins = static_cast< SizeValueType >(
+      static_cast< OffsetValueType >( NumericTraits< TInputPixel >::max() )
+      - static_cast< OffsetValueType >( NumericTraits< TInputPixel >::NonpositiveMin() ) + 1 );
+    m_Vector.resize(numberOfBins, 0);
+    // the bins are grouped in blocks of 2^(bits/2) bins, and the number of
+    // pixels in each block is used to skip the empty blocks when searching
+    // for the new extremum
+    m_Shift = sizeof( TInputPixel ) * 4;
+    m_BlockVector.resize( ( ( numberOfBins - 1 ) >> m_Shift ) + 1, 0 );
     if ( m_Compare( NumericTraits< TInputPixel >::max(), NumericTraits< TInputPixel >::NonpositiveMin() ) )
       {
       m_InitValue = NumericTraits< TInputPixel >::NonpositiveMin();
-      m_CurrentValue = m_InitValue;
+      m_InitBin = 0;
       m_Direction = -1;
       }
     else
       {
       m_InitValue = NumericTraits< TInputPixel >::max();
-      m_CurrentValue = m_InitValue;
+      m_InitBin = numberOfBins - 1;
       m_Direction = 1;
       }
+    m_CurrentValue = m_InitValue;
+    m_CurrentBin = m_InitBin;
   }
 
   inline void AddBoundary()
@@ -144,21 +155,53 @@ public:
 
   inline void AddPixel(const TInputPixel & p)
   {
-    m_Vector[p - NumericTraits < TInputPixel > ::NonpositiveMin()]++;
+    const SizeValueType bin = GetBin(p);
+
+    m_Vector[bin]++;
+    m_BlockVector[bin >> m_Shift]++;
     if ( m_Compare(p, m_CurrentValue) )
       {
       m_CurrentValue = p;
+      m_CurrentBin = bin;
       }
   }
 
   inline void RemovePixel(const TInputPixel & p)
   {
-    m_Vector[p - NumericTraits < TInputPixel > ::NonpositiveMin()]--;
-    while ( m_Vector[m_CurrentValue - NumericTraits < TInputPixel > ::NonpositiveMin()] == 0
-            && m_CurrentValue != m_InitValue )
+    const SizeValueType bin = GetBin(p);
+
+    m_Vector[bin]--;
+    m_BlockVector[bin >> m_Shift]--;
+    if ( m_Vector[m_CurrentBin] != 0 )
+      {
+      return;
+      }
+    while ( m_Vector[m_CurrentBin] == 0 && m_CurrentBin != m_InitBin )
       {
-      m_CurrentValue += m_Direction;
+      if ( m_BlockVector[m_CurrentBin >> m_Shift] == 0 )
+        {
+        // jump over the rest of the empty block
+        const SizeValueType blockStart = ( m_CurrentBin >> m_Shift ) << m_Shift;
+        if ( m_Direction > 0 )
+          {
+          m_CurrentBin = std::min( blockStart + ( static_cast< SizeValueType >( 1 ) << m_Shift ), m_InitBin );
+          }
+        else
+          {
+          m_CurrentBin = blockStart > 0 ? blockStart - 1 : 0;
+          }
+        }
+      else if ( m_Direction > 0 )
+        {
+        ++m_CurrentBin;
+        }
+      else
+        {
+        --m_CurrentBin;
+        }
       }
+    m_CurrentValue = static_cast< TInputPixel >( static_cast< OffsetValueType >( m_CurrentBin )
+                                                 + NumericTraits< TInputPixel >::NonpositiveMin() );
   }
 
   inline TInputPixel GetValue()
@@ -181,9 +224,19 @@ public:
     return true;
   }
 
+  inline SizeValueType GetBin(const TInputPixel & p) const
+  {
+    return static_cast< SizeValueType >( static_cast< OffsetValueType >( p )
+                                         - NumericTraits< TInputPixel >::NonpositiveMin() );
+  }
+
   std::vector< IdentifierType >   m_Vector;
+  std::vector< IdentifierType >   m_BlockVector;
   TInputPixel                     m_InitValue;
   TInputPixel                     m_CurrentValue;
+  SizeValueType                   m_InitBin;
+  SizeValueType                   m_CurrentBin;
+  unsigned int                    m_Shift;
   TCompare                        m_Compare;
   signed int                      m_Direction;
   TInputPixel                     m_Boundary;
@@ -214,6 +267,38 @@ class MorphologyHistogram<bool, TCompare>:
 
 /** \endcond */
 
+/** \class MovingMorphologyHistogram
+ * \brief The histogram used by the moving histogram morphology filters.
+ *
+ * A histogram lives for the whole region of a thread in those filters, so
+ * the cost of the allocation of a vector with one bin per value is worth
+ * paying for the 16 bit types too. The other types are stored in a map,
+ * as in MorphologyHistogram.
+ *
+ * \ingroup ITK-MathematicalMorphology
+ */
+template< class TInputPixel, class TCompare >
+class MovingMorphologyHistogram:
+  public MorphologyHistogram< TInputPixel, TCompare >
+{
+};
+
+/** \cond HIDE_SPECIALIZATION_DOCUMENTATION */
+
+template< class TCompare >
+class MovingMorphologyHistogram<unsigned short, TCompare>:
+  public VectorMorphologyHistogram<unsigned short, TCompare>
+{
+};
+
+template< class TCompare >
+class MovingMorphologyHistogram<short, TCompare>:
+  public VectorMorphologyHistogram<short, TCompare>
+{
+};
+
+/** \endcond */
+
 } // end namespace Function
 } // end namespace itk
 
@@ -41,7 +41,7 @@ namespace itk
 template< class TInputImage, class TOutputImage, class TKernel >
 class ITK_EXPORT MovingHistogramDilateImageFilter:
   public MovingHistogramMorphologyImageFilter< TInputImage, TOutputImage, TKernel,
-                                               typename Function::MorphologyHistogram< typename TInputImage::PixelType,
+                                               typename Function::MovingMorphologyHistogram< typename TInputImage::PixelType,
                                                                                        typename std::greater< typename
                                                                                                               TInputImage
                                                                                                               ::PixelType > > >
@@ -50,7 +50,7 @@ public:
   /** Standard class typedefs. */
   typedef MovingHistogramDilateImageFilter Self;
   typedef MovingHistogramMorphologyImageFilter< TInputImage, TOutputImage, TKernel,
-                                                typename Function::MorphologyHistogram< typename TInputImage::PixelType,
+                                                typename Function::MovingMorphologyHistogram< typename TInputImage::PixelType,
                                                                                         typename std::greater< typename
                                                                                                                TInputImage
                                                                                                                ::PixelType > > >  Superclass;
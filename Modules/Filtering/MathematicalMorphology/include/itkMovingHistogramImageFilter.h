@@ -66,7 +66,10 @@ namespace itk
  *
  * One histogram is created for each thread by the method NewHistogram().
  * The NewHistogram() method can be overiden to pass some parameters to the
- * histogram.
+ * histogram. This histogram is moved over the region of the thread in snake
+ * order, alternately forward and backward along the lines, so it is never
+ * copied, and the output is split between the threads along the axes
+ * other than the one of the lines.
  *
  * The neighborhood is defined by a structuring element, and must a
  * itk::Neighborhood object or a subclass.
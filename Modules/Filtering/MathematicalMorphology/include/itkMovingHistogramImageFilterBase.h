@@ -149,6 +149,27 @@ protected:
                        OffsetType & Changes,
                        int & LineDirection);
 
+  typedef FixedArray< int, itkGetStaticConstMacro(ImageDimension) > DirectionType;
+
+  /** Find the next line of a traversal of region in snake order: the
+   * lines parallel to the best axis are traversed alternately forward
+   * and backward, so a single histogram can be moved of one pixel from
+   * the end of a line to the beginning of the next one. The axes are
+   * traversed in the order given by m_Axes, starting from the best one.
+   * On return, axis is the axis along which the histogram must be
+   * moved of direction[axis] to reach the next line, and the directions
+   * of the axes which have been traversed entirely are reversed. Returns
+   * false when the whole region has been traversed. */
+  bool GetNextSnakeLine(const RegionType & region,
+                        const IndexType & index,
+                        DirectionType & direction,
+                        int & axis) const;
+
+  /** Split the region along the largest axis other than the best one, so
+   * the threads don't have to initialize their histogram at each few
+   * pixels. */
+  int SplitRequestedRegion(int i, int num, OutputImageRegionType & splitRegion);
+
   // store the added and removed pixel offset in a list
   OffsetMapType m_AddedOffsets;
   OffsetMapType m_RemovedOffsets;
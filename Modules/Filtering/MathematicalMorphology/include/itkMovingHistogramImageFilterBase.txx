@@ -23,6 +23,7 @@
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
 #include "itkNumericTraits.h"
+#include "itkMath.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageLinearConstIteratorWithIndex.h"
 
@@ -216,6 +217,98 @@ MovingHistogramImageFilterBase< TInputImage, TOutputImage, TKernel >
     }
 }
 
+template< class TInputImage, class TOutputImage, class TKernel >
+bool
+MovingHistogramImageFilterBase< TInputImage, TOutputImage, TKernel >
+::GetNextSnakeLine(const RegionType & region,
+                   const IndexType & index,
+                   DirectionType & direction,
+                   int & axis) const
+{
+  // the best axis, m_Axes[ImageDimension - 1], is the one of the lines.
+  // Search for the first of the other axes along which we can still move.
+  for ( int k = ImageDimension - 2; k >= 0; k-- )
+    {
+    const int            a = m_Axes[k];
+    const OffsetValueType next = index[a] + direction[a];
+    if ( next >= region.GetIndex()[a]
+         && next < region.GetIndex()[a] + static_cast< OffsetValueType >( region.GetSize()[a] ) )
+      {
+      axis = a;
+      // the axes traversed before that one will now be traversed backward
+      for ( unsigned int j = k + 1; j < ImageDimension; j++ )
+        {
+        direction[m_Axes[j]] = -direction[m_Axes[j]];
+        }
+      return true;
+      }
+    }
+  return false;
+}
+
+template< class TInputImage, class TOutputImage, class TKernel >
+int
+MovingHistogramImageFilterBase< TInputImage, TOutputImage, TKernel >
+::SplitRequestedRegion(int i, int num, OutputImageRegionType & splitRegion)
+{
+  // Get the output pointer
+  OutputImageType *outputPtr = this->GetOutput();
+
+  const typename TOutputImage::SizeType & requestedRegionSize =
+    outputPtr->GetRequestedRegion().GetSize();
+
+  typename TOutputImage::IndexType splitIndex;
+  typename TOutputImage::SizeType splitSize;
+
+  // Initialize the splitRegion to the output requested region
+  splitRegion = outputPtr->GetRequestedRegion();
+  splitIndex = splitRegion.GetIndex();
+  splitSize = splitRegion.GetSize();
+
+  // split on the largest dimension, but avoid the one of the lines
+  // along which the histogram is moved
+  int splitAxis = -1;
+  for ( int d = ImageDimension - 1; d >= 0; d-- )
+    {
+    if ( d != m_Axes[ImageDimension - 1] && requestedRegionSize[d] > 1
+         && ( splitAxis < 0 || requestedRegionSize[d] > requestedRegionSize[splitAxis] ) )
+      {
+      splitAxis = d;
+      }
+    }
+  if ( splitAxis < 0 )
+    {
+    // only one line: use the default split
+    return Superclass::SplitRequestedRegion(i, num, splitRegion);
+    }
+
+  // determine the actual number of pieces that will be generated
+  typename TOutputImage::SizeType::SizeValueType range = requestedRegionSize[splitAxis];
+  int valuesPerThread = Math::Ceil< int >(range / (double)num);
+  int maxThreadIdUsed = Math::Ceil< int >(range / (double)valuesPerThread) - 1;
+
+  // Split the region
+  if ( i < maxThreadIdUsed )
+    {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = valuesPerThread;
+    }
+  if ( i == maxThreadIdUsed )
+    {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    // last thread needs to process the "rest" dimension being split
+    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
+    }
+
+  // set the split region ivars
+  splitRegion.SetIndex(splitIndex);
+  splitRegion.SetSize(splitSize);
+
+  itkDebugMacro("  Split Piece: " << splitRegion);
+
+  return maxThreadIdUsed + 1;
+}
+
 template< class TInputImage, class TOutputImage, class TKernel >
 void
 MovingHistogramImageFilterBase< TInputImage, TOutputImage, TKernel >
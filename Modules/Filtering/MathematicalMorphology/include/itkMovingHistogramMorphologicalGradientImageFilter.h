@@ -102,9 +102,18 @@ public:
   VectorMorphologicalGradientHistogram()
   {
     // initialize members need for the vector based algorithm
-    m_Vector.resize(NumericTraits< TInputPixel >::max() - NumericTraits< TInputPixel >::NonpositiveMin() + 1, 0);
+    const SizeValueType numberOfBins = static_cast< SizeValueType >(
+      static_cast< OffsetValueType >( NumericTraits< TInputPixel >::max() )
+      - static_cast< OffsetValueType >( NumericTraits< TInputPixel >::NonpositiveMin() ) + 1 );
+    m_Vector.resize(numberOfBins, 0);
+    // the number of pixels in the blocks of 2^(bits/2) bins, to skip the
+    // empty blocks when searching for the new minimum or maximum
+    m_Shift = sizeof( TInputPixel ) * 4;
+    m_BlockVector.resize( ( ( numberOfBins - 1 ) >> m_Shift ) + 1, 0 );
     m_Max = NumericTraits< TInputPixel >::NonpositiveMin();
     m_Min = NumericTraits< TInputPixel >::max();
+    m_MaxBin = 0;
+    m_MinBin = numberOfBins - 1;
     m_Count = 0;
   }
 
@@ -117,37 +126,65 @@ public:
 
   inline void AddPixel(const TInputPixel & p)
   {
-    m_Vector[p - NumericTraits < TInputPixel > ::NonpositiveMin()]++;
+    const SizeValueType bin = GetBin(p);
+
+    m_Vector[bin]++;
+    m_BlockVector[bin >> m_Shift]++;
     if ( p > m_Max )
       {
       m_Max = p;
+      m_MaxBin = bin;
       }
     if ( p < m_Min )
       {
       m_Min = p;
+      m_MinBin = bin;
       }
     m_Count++;
   }
 
   inline void RemovePixel(const TInputPixel & p)
   {
-    m_Vector[p - NumericTraits < TInputPixel > ::NonpositiveMin()]--;
+    const SizeValueType bin = GetBin(p);
+
+    m_Vector[bin]--;
+    m_BlockVector[bin >> m_Shift]--;
     m_Count--;
     if ( m_Count > 0 )
       {
-      while ( m_Vector[m_Max - NumericTraits < TInputPixel > ::NonpositiveMin()] == 0 )
+      const SizeValueType blockSize = static_cast< SizeValueType >( 1 ) << m_Shift;
+      while ( m_Vector[m_MaxBin] == 0 )
         {
-        m_Max--;
+        if ( m_BlockVector[m_MaxBin >> m_Shift] == 0 )
+          {
+          // the histogram is not empty, so there is a non empty block below
+          m_MaxBin = ( ( m_MaxBin >> m_Shift ) << m_Shift ) - 1;
+          }
+        else
+          {
+          m_MaxBin--;
+          }
         }
-      while ( m_Vector[m_Min - NumericTraits < TInputPixel > ::NonpositiveMin()] == 0 )
+      while ( m_Vector[m_MinBin] == 0 )
         {
-        m_Min++;
+        if ( m_BlockVector[m_MinBin >> m_Shift] == 0 )
+          {
+          m_MinBin = ( ( m_MinBin >> m_Shift ) << m_Shift ) + blockSize;
+          }
+        else
+          {
+          m_MinBin++;
+          }
         }
+      m_Max = GetValueOfBin(m_MaxBin);
+      m_Min = GetValueOfBin(m_MinBin);
       }
     else
       {
       m_Max = NumericTraits< TInputPixel >::NonpositiveMin();
       m_Min = NumericTraits< TInputPixel >::max();
+      m_MaxBin = 0;
+      m_MinBin = m_Vector.size() - 1;
       }
   }
 
@@ -173,9 +210,25 @@ public:
     return true;
   }
 
+  inline SizeValueType GetBin(const TInputPixel & p) const
+  {
+    return static_cast< SizeValueType >( static_cast< OffsetValueType >( p )
+                                         - NumericTraits< TInputPixel >::NonpositiveMin() );
+  }
+
+  inline TInputPixel GetValueOfBin(SizeValueType bin) const
+  {
+    return static_cast< TInputPixel >( static_cast< OffsetValueType >( bin )
+                                       + NumericTraits< TInputPixel >::NonpositiveMin() );
+  }
+
   std::vector< SizeValueType > m_Vector;
+  std::vector< SizeValueType > m_BlockVector;
   TInputPixel                  m_Min;
   TInputPixel                  m_Max;
+  SizeValueType                m_MinBin;
+  SizeValueType                m_MaxBin;
+  unsigned int                 m_Shift;
   SizeValueType                m_Count;
 };
 
@@ -202,6 +255,18 @@ class MorphologicalGradientHistogram<bool>:
 {
 };
 
+template<>
+class MorphologicalGradientHistogram<unsigned short>:
+  public VectorMorphologicalGradientHistogram<unsigned short>
+{
+};
+
+template<>
+class MorphologicalGradientHistogram<short>:
+  public VectorMorphologicalGradientHistogram<short>
+{
+};
+
 /** \endcond */
 
 } // end namespace Function
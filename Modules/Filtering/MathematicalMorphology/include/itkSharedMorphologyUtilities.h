@@ -72,6 +72,46 @@ MakeEnlargedFace(const TInputImage *input,
 template< class TLine >
 unsigned int GetLinePixels(const TLine line);
 
+// return true if the line is parallel to one of the image axes, and
+// the number of that axis
+template< class TLine >
+bool IsAxisAlignedLine(const TLine line, unsigned int & axis);
+
+// build an extremum functor, as used by the van Herk/Gil-Werman
+// algorithm, from a comparison functor like the one used by the anchor
+// algorithm
+template< class TPixel, class TCompare >
+class CompareToExtremumFunctor
+{
+public:
+  CompareToExtremumFunctor(){}
+  ~CompareToExtremumFunctor(){}
+  inline TPixel operator()(const TPixel & A, const TPixel & B) const
+  {
+    return m_Compare(A, B) ? A : B;
+  }
+
+private:
+  TCompare m_Compare;
+};
+
+// Erode or dilate all the lines of AllImage parallel to the given axis
+// with a line structuring element of KernLen pixels.  This gives the
+// same result as running the van Herk/Gil-Werman or anchor algorithm on
+// each line with the border value at both ends, but the lines are
+// processed by blocks of adjacent lines: a block is copied in a
+// transposed buffer where the pixels of the different lines at the
+// same position are contiguous, so the inner loops run over
+// independent lines and can be vectorized by the compiler, whatever
+// the axis.  input and output may be the same image.
+template< class TImage, class TFunction >
+void DoAxisAlignedFace(const TImage *input,
+                       TImage *output,
+                       typename TImage::PixelType border,
+                       const unsigned int axis,
+                       const unsigned int KernLen,
+                       const typename TImage::RegionType AllImage);
+
 } // namespace itk
 
 #ifndef ITK_MANUAL_INSTANTIATION
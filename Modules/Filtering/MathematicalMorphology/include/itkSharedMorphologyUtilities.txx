@@ -422,6 +422,231 @@ unsigned int GetLinePixels(const TLine line)
   N *= correction;
   return (int)( N + 0.5 );
 }
+
+template< class TLine >
+bool IsAxisAlignedLine(const TLine line, unsigned int & axis)
+{
+  unsigned int nonZero = 0;
+
+  for ( unsigned int i = 0; i < TLine::Dimension; i++ )
+    {
+    if ( line[i] != 0 )
+      {
+      axis = i;
+      nonZero++;
+      }
+    }
+  return ( nonZero == 1 );
+}
+
+template< class TImage, class TFunction >
+void DoAxisAlignedFace(const TImage *input,
+                       TImage *output,
+                       typename TImage::PixelType border,
+                       const unsigned int axis,
+                       const unsigned int KernLen,
+                       const typename TImage::RegionType AllImage)
+{
+  typedef typename TImage::PixelType  PixelType;
+  typedef typename TImage::RegionType RegionType;
+  typedef typename TImage::SizeType   SizeType;
+  typedef typename TImage::IndexType  IndexType;
+
+  // number of lines processed together
+  const unsigned int BlockSize = 64;
+
+  const unsigned int len = AllImage.GetSize()[axis];
+  if ( len == 0 )
+    {
+    return;
+    }
+  // compat: the border value is added at both ends of the lines
+  const unsigned int size = len + 2;
+  const unsigned int radius = KernLen / 2;
+
+  // the lines of a block are adjacent along laneDim, which is the
+  // first dimension, unless the lines are along the first dimension
+  const bool         hasLanes = TImage::ImageDimension > 1;
+  const unsigned int laneDim = ( axis == 0 ) ? 1 : 0;
+  const unsigned int nbOfLanes = hasLanes ? AllImage.GetSize()[laneDim] : 1;
+
+  const OffsetValueType inStride = input->GetOffsetTable()[axis];
+  const OffsetValueType outStride = output->GetOffsetTable()[axis];
+  const OffsetValueType inLaneStride = hasLanes ? input->GetOffsetTable()[laneDim] : 0;
+  const OffsetValueType outLaneStride = hasLanes ? output->GetOffsetTable()[laneDim] : 0;
+
+  // the face contains the first pixel of the first line of each block
+  RegionType face = AllImage;
+  SizeType   faceSize = AllImage.GetSize();
+  faceSize[axis] = 1;
+  if ( hasLanes )
+    {
+    faceSize[laneDim] = 1;
+    }
+  face.SetSize(faceSize);
+
+  // see DoFace() in itkVanHerkGilWermanUtilities.txx
+  typename TImage::Pointer dumbImg = TImage::New();
+  dumbImg->SetRegions(face);
+
+  std::vector< PixelType > pixbuffer(size * BlockSize);
+  std::vector< PixelType > fExtBuffer(size * BlockSize);
+  std::vector< PixelType > rExtBuffer(size * BlockSize);
+  TFunction m_TF;
+
+  const PixelType *inBuffer = input->GetBufferPointer();
+  PixelType *      outBuffer = output->GetBufferPointer();
+
+  for ( unsigned int it = 0; it < face.GetNumberOfPixels(); it++ )
+    {
+    const IndexType Ind = dumbImg->ComputeIndex(it);
+    const PixelType *inFirst = inBuffer + input->ComputeOffset(Ind);
+    PixelType *      outFirst = outBuffer + output->ComputeOffset(Ind);
+
+    for ( unsigned int firstLane = 0; firstLane < nbOfLanes; firstLane += BlockSize )
+      {
+      const unsigned int lanes = vnl_math_min(BlockSize, nbOfLanes - firstLane);
+      const PixelType *  inBlock = inFirst + firstLane * inLaneStride;
+      PixelType *        outBlock = outFirst + firstLane * outLaneStride;
+      PixelType *        pix = &( pixbuffer[0] );
+      PixelType *        fExt = &( fExtBuffer[0] );
+      PixelType *        rExt = &( rExtBuffer[0] );
+
+      // copy the block in the transposed buffer, reading the image in
+      // memory order
+      for ( unsigned int l = 0; l < lanes; l++ )
+        {
+        pix[l] = border;
+        pix[( size - 1 ) * lanes + l] = border;
+        }
+      if ( axis == 0 )
+        {
+        for ( unsigned int l = 0; l < lanes; l++ )
+          {
+          const PixelType *in = inBlock + l * inLaneStride;
+          for ( unsigned int j = 0; j < len; j++ )
+            {
+            pix[( j + 1 ) * lanes + l] = in[j];
+            }
+          }
+        }
+      else
+        {
+        for ( unsigned int j = 0; j < len; j++ )
+          {
+          const PixelType *in = inBlock + j * inStride;
+          PixelType *      p = pix + ( j + 1 ) * lanes;
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            p[l] = in[l * inLaneStride];
+            }
+          }
+        }
+
+      // forward and reverse extrema over blocks of KernLen pixels
+      for ( unsigned int j = 0; j < size; j++ )
+        {
+        const PixelType *p = pix + j * lanes;
+        PixelType *      f = fExt + j * lanes;
+        if ( j % KernLen == 0 )
+          {
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            f[l] = p[l];
+            }
+          }
+        else
+          {
+          const PixelType *fPrev = f - lanes;
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            f[l] = m_TF(p[l], fPrev[l]);
+            }
+          }
+        }
+      for ( unsigned int j = size; j > 0; j-- )
+        {
+        const PixelType *p = pix + ( j - 1 ) * lanes;
+        PixelType *      r = rExt + ( j - 1 ) * lanes;
+        if ( j == size || j % KernLen == 0 )
+          {
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            r[l] = p[l];
+            }
+          }
+        else
+          {
+          const PixelType *rNext = r + lanes;
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            r[l] = m_TF(p[l], rNext[l]);
+            }
+          }
+        }
+
+      // the result at position j is the extremum over [lo, hi], the
+      // window of the kernel cropped to the buffer. It is given by the
+      // forward extremum alone when the window starts a block, by the
+      // reverse extremum alone when it ends in the same block, and by
+      // the combination of both otherwise.
+      for ( unsigned int j = 1; j <= len; j++ )
+        {
+        const unsigned int lo = ( j > radius ) ? j - radius : 0;
+        const unsigned int hi = vnl_math_min(j + radius, size - 1);
+        const PixelType *  f = fExt + hi * lanes;
+        const PixelType *  r = rExt + lo * lanes;
+        PixelType *        p = pix + j * lanes;
+        if ( lo == 0 )
+          {
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            p[l] = f[l];
+            }
+          }
+        else if ( lo / KernLen == hi / KernLen )
+          {
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            p[l] = r[l];
+            }
+          }
+        else
+          {
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            p[l] = m_TF(r[l], f[l]);
+            }
+          }
+        }
+
+      // and copy the block back to the image
+      if ( axis == 0 )
+        {
+        for ( unsigned int l = 0; l < lanes; l++ )
+          {
+          PixelType *out = outBlock + l * outLaneStride;
+          for ( unsigned int j = 0; j < len; j++ )
+            {
+            out[j] = pix[( j + 1 ) * lanes + l];
+            }
+          }
+        }
+      else
+        {
+        for ( unsigned int j = 0; j < len; j++ )
+          {
+          PixelType *      out = outBlock + j * outStride;
+          const PixelType *p = pix + ( j + 1 ) * lanes;
+          for ( unsigned int l = 0; l < lanes; l++ )
+            {
+            out[l * outLaneStride] = p[l];
+            }
+          }
+        }
+      }
+    }
+}
 } // namespace itk
 
 #endif
@@ -100,12 +100,22 @@ VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
       ++SELength;
       }
 
-    InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
+    unsigned int axis;
+    if ( IsAxisAlignedLine< KernelLType >(ThisLine, axis) )
+      {
+      // lines along an image axis, as in the decomposition of the boxes
+      // and of the polygons, are processed by blocks of parallel lines
+      DoAxisAlignedFace< TImage, TFunction1 >(input, output, m_Boundary, axis, SELength, IReg);
+      }
+    else
+      {
+      InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
 
-    DoFace< TImage, BresType, TFunction1, KernelLType >(input, output, m_Boundary, ThisLine,
-                                                        TheseOffsets, SELength,
-                                                        buffer, forward,
-                                                        reverse, IReg, BigFace);
+      DoFace< TImage, BresType, TFunction1, KernelLType >(input, output, m_Boundary, ThisLine,
+                                                          TheseOffsets, SELength,
+                                                          buffer, forward,
+                                                          reverse, IReg, BigFace);
+      }
 
     // after the first pass the input will be taken from the output
     input = internalbuffer;
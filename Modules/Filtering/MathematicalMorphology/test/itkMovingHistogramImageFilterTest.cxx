@@ -0,0 +1,170 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkFlatStructuringElement.h"
+#include "itkGrayscaleDilateImageFilter.h"
+#include "itkGrayscaleErodeImageFilter.h"
+#include "itkMovingHistogramDilateImageFilter.h"
+#include "itkMovingHistogramErodeImageFilter.h"
+#include "itkMovingHistogramMorphologicalGradientImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+// Compare the moving histogram filters, which move a single histogram
+// over the region of each thread in snake order, to the basic algorithm,
+// with several numbers of threads.
+
+template< class TImage >
+unsigned long CountDifferences(const TImage *reference, const TImage *image)
+{
+  typedef itk::ImageRegionConstIterator< TImage > IteratorType;
+  IteratorType rit( reference, reference->GetLargestPossibleRegion() );
+  IteratorType it( image, reference->GetLargestPossibleRegion() );
+  unsigned long differences = 0;
+  for ( rit.GoToBegin(), it.GoToBegin(); !rit.IsAtEnd(); ++rit, ++it )
+    {
+    if ( rit.Get() != it.Get() )
+      {
+      differences++;
+      }
+    }
+  return differences;
+}
+
+template< class TPixel >
+int TestMovingHistogram(const char *name)
+{
+  const unsigned int Dimension = 3;
+
+  typedef itk::Image< TPixel, Dimension >           ImageType;
+  typedef itk::FlatStructuringElement< Dimension >  KernelType;
+
+  // a random image, with values spread over a large range
+  typename ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 29;
+  size[2] = 23;
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  unsigned long seed = 12345;
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = ( seed * 1103515245 + 12345 ) % 2147483648UL;
+    it.Set( static_cast< TPixel >( static_cast< long >( seed % 60000 ) - 30000 ) );
+    }
+
+  typename KernelType::RadiusType radius;
+  radius[0] = 3;
+  radius[1] = 2;
+  radius[2] = 4;
+  KernelType kernel = KernelType::Ball( radius );
+
+  typedef itk::GrayscaleDilateImageFilter< ImageType, ImageType, KernelType > BasicDilateType;
+  typename BasicDilateType::Pointer basicDilate = BasicDilateType::New();
+  basicDilate->SetInput( image );
+  basicDilate->SetKernel( kernel );
+  basicDilate->SetAlgorithm( BasicDilateType::BASIC );
+  basicDilate->Update();
+
+  typedef itk::GrayscaleErodeImageFilter< ImageType, ImageType, KernelType > BasicErodeType;
+  typename BasicErodeType::Pointer basicErode = BasicErodeType::New();
+  basicErode->SetInput( image );
+  basicErode->SetKernel( kernel );
+  basicErode->SetAlgorithm( BasicErodeType::BASIC );
+  basicErode->Update();
+
+  // the gradient ignores the pixels outside the image, as the default
+  // boundary values of the dilation and erosion do
+  typename ImageType::Pointer gradient = ImageType::New();
+  gradient->SetRegions( size );
+  gradient->Allocate();
+  itk::ImageRegionConstIterator< ImageType > dit( basicDilate->GetOutput(), image->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > eit( basicErode->GetOutput(), image->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< ImageType >      git( gradient, image->GetLargestPossibleRegion() );
+  for ( ; !git.IsAtEnd(); ++dit, ++eit, ++git )
+    {
+    git.Set( dit.Get() - eit.Get() );
+    }
+
+  typedef itk::MovingHistogramDilateImageFilter< ImageType, ImageType, KernelType >                DilateType;
+  typedef itk::MovingHistogramErodeImageFilter< ImageType, ImageType, KernelType >                 ErodeType;
+  typedef itk::MovingHistogramMorphologicalGradientImageFilter< ImageType, ImageType, KernelType > GradientType;
+
+  int status = EXIT_SUCCESS;
+  const int numberOfThreads[3] = { 1, 3, 8 };
+  for ( unsigned int t = 0; t < 3; t++ )
+    {
+    typename DilateType::Pointer dilate = DilateType::New();
+    dilate->SetInput( image );
+    dilate->SetKernel( kernel );
+    dilate->SetNumberOfThreads( numberOfThreads[t] );
+    dilate->Update();
+
+    typename ErodeType::Pointer erode = ErodeType::New();
+    erode->SetInput( image );
+    erode->SetKernel( kernel );
+    erode->SetNumberOfThreads( numberOfThreads[t] );
+    erode->Update();
+
+    typename GradientType::Pointer grad = GradientType::New();
+    grad->SetInput( image );
+    grad->SetKernel( kernel );
+    grad->SetNumberOfThreads( numberOfThreads[t] );
+    grad->Update();
+
+    const unsigned long dilateDifferences = CountDifferences( basicDilate->GetOutput(), dilate->GetOutput() );
+    const unsigned long erodeDifferences = CountDifferences( basicErode->GetOutput(), erode->GetOutput() );
+    const unsigned long gradientDifferences = CountDifferences( gradient.GetPointer(), grad->GetOutput() );
+    if ( dilateDifferences != 0 || erodeDifferences != 0 || gradientDifferences != 0 )
+      {
+      std::cerr << name << " with " << numberOfThreads[t] << " threads: "
+                << dilateDifferences << " pixels differ for the dilation, "
+                << erodeDifferences << " for the erosion and "
+                << gradientDifferences << " for the gradient." << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+  return status;
+}
+
+int itkMovingHistogramImageFilterTest(int, char *[])
+{
+  int status = EXIT_SUCCESS;
+
+  // a flat histogram is used for the 16 bit types, and a map for the others
+  if ( TestMovingHistogram< short >( "short" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( TestMovingHistogram< unsigned short >( "unsigned short" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( TestMovingHistogram< float >( "float" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
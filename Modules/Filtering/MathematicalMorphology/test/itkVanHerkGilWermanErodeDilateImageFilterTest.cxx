@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkFlatStructuringElement.h"
+#include "itkGrayscaleDilateImageFilter.h"
+#include "itkGrayscaleErodeImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+// Compare the van Herk/Gil-Werman and anchor algorithms, which process
+// the lines parallel to the image axes by blocks, to the basic
+// algorithm.
+
+template< class TFilter, class TImage, class TKernel >
+int CompareAlgorithms(TImage *input, const TKernel & kernel, const char *name)
+{
+  typedef itk::ImageRegionConstIterator< TImage > IteratorType;
+
+  typename TFilter::Pointer basic = TFilter::New();
+  basic->SetInput( input );
+  basic->SetKernel( kernel );
+  basic->SetAlgorithm( TFilter::BASIC );
+  basic->Update();
+
+  int algorithms[2] = { TFilter::VHGW, TFilter::ANCHOR };
+  int status = EXIT_SUCCESS;
+
+  for ( unsigned int a = 0; a < 2; a++ )
+    {
+    typename TFilter::Pointer filter = TFilter::New();
+    filter->SetInput( input );
+    filter->SetKernel( kernel );
+    filter->SetAlgorithm( algorithms[a] );
+    filter->Update();
+
+    unsigned long differences = 0;
+    IteratorType bit( basic->GetOutput(), basic->GetOutput()->GetLargestPossibleRegion() );
+    IteratorType fit( filter->GetOutput(), basic->GetOutput()->GetLargestPossibleRegion() );
+    for ( bit.GoToBegin(), fit.GoToBegin(); !bit.IsAtEnd(); ++bit, ++fit )
+      {
+      if ( bit.Get() != fit.Get() )
+        {
+        differences++;
+        }
+      }
+
+    if ( differences != 0 )
+      {
+      std::cerr << name << " with algorithm " << algorithms[a] << ": "
+                << differences << " pixels differ from the basic algorithm." << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+  return status;
+}
+
+int itkVanHerkGilWermanErodeDilateImageFilterTest(int, char *[])
+{
+  const unsigned int Dimension = 3;
+
+  typedef short                                     PixelType;
+  typedef itk::Image< PixelType, Dimension >        ImageType;
+  typedef itk::FlatStructuringElement< Dimension >  KernelType;
+
+  // a random image, with sizes which are not multiples of the number of
+  // lines processed together
+  ImageType::SizeType size;
+  size[0] = 71;
+  size[1] = 43;
+  size[2] = 37;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  unsigned long seed = 12345;
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = ( seed * 1103515245 + 12345 ) % 2147483648UL;
+    it.Set( static_cast< PixelType >( seed % 2000 ) - 1000 );
+    }
+
+  typedef itk::GrayscaleDilateImageFilter< ImageType, ImageType, KernelType > DilateType;
+  typedef itk::GrayscaleErodeImageFilter< ImageType, ImageType, KernelType >  ErodeType;
+
+  int status = EXIT_SUCCESS;
+
+  KernelType::RadiusType radius;
+  radius[0] = 4;
+  radius[1] = 1;
+  radius[2] = 3;
+  KernelType box = KernelType::Box( radius );
+
+  if ( CompareAlgorithms< DilateType >( image.GetPointer(), box, "Box dilation" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( CompareAlgorithms< ErodeType >( image.GetPointer(), box, "Box erosion" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // a kernel almost as large as the image along one dimension
+  radius[0] = 2;
+  radius[1] = 20;
+  radius[2] = 1;
+  box = KernelType::Box( radius );
+
+  if ( CompareAlgorithms< DilateType >( image.GetPointer(), box, "Large box dilation" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( CompareAlgorithms< ErodeType >( image.GetPointer(), box, "Large box erosion" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
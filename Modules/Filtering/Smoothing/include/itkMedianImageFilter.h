@@ -35,6 +35,13 @@ namespace itk
  * This filter requires that the input pixel type provides an operator<()
  * (LessThan Comparable).
  *
+ * For integer pixel types of 16 bits or less, and neighborhoods large
+ * enough for it to pay off, the median is not computed by sorting the
+ * neighborhood of each pixel: the neighborhood is moved along the lines
+ * of the image and kept in a TieredRankHistogram, so only the pixels
+ * entering and leaving the neighborhood are processed at each step.
+ * Both algorithms produce the same output.
+ *
  * \sa Image
  * \sa Neighborhood
  * \sa NeighborhoodOperator
@@ -110,6 +117,12 @@ protected:
   void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                             int threadId);
 
+  /** Compute the median with a histogram moved along the lines of the
+   * image. Only usable with the pixel types supported by
+   * TieredRankHistogram. */
+  void HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                     int threadId);
+
 private:
   MedianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);    //purposely not implemented
@@ -22,6 +22,8 @@
 #include "itkConstNeighborhoodIterator.h"
 #include "itkNeighborhoodInnerProduct.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkTieredRankHistogram.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
@@ -42,6 +44,25 @@ MedianImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        int threadId)
 {
+  // Use the moving histogram when reading the pixels entering and
+  // leaving the neighborhood and the bins of the histogram is cheaper
+  // than sorting the whole neighborhood.
+  typedef Function::TieredRankHistogram< InputPixelType > HistogramType;
+  if ( HistogramType::IsSupported() )
+    {
+    SizeValueType neighborhoodSize = 1;
+    for ( unsigned int i = 0; i < InputImageDimension; i++ )
+      {
+      neighborhoodSize *= 2 * this->GetRadius()[i] + 1;
+      }
+    const SizeValueType columnSize = neighborhoodSize / ( 2 * this->GetRadius()[0] + 1 );
+    if ( 2 * columnSize + HistogramType::GetMaximumNumberOfVisitedBins() < 2 * neighborhoodSize )
+      {
+      this->HistogramThreadedGenerateData(outputRegionForThread, threadId);
+      return;
+      }
+    }
+
   // Allocate output
   typename OutputImageType::Pointer output = this->GetOutput();
   typename  InputImageType::ConstPointer input  = this->GetInput();
@@ -94,6 +115,126 @@ MedianImageFilter< TInputImage, TOutputImage >
       }
     }
 }
+
+template< class TInputImage, class TOutputImage >
+void
+MedianImageFilter< TInputImage, TOutputImage >
+::HistogramThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                int threadId)
+{
+  typedef Function::TieredRankHistogram< InputPixelType > HistogramType;
+  typedef typename InputImageType::IndexType              IndexType;
+  typedef std::vector< OffsetValueType >                  OffsetContainerType;
+
+  OutputImageType *     output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
+  const InputSizeType   radius = this->GetRadius();
+
+  // The pixels outside the buffered region are replaced by the nearest
+  // pixel of the buffered region, as with the
+  // ZeroFluxNeumannBoundaryCondition used by the neighborhood iterator.
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+  const IndexType            bufferedIndex = bufferedRegion.GetIndex();
+  const OffsetValueType *    offsetTable = input->GetOffsetTable();
+  const InputPixelType *     buffer = input->GetBufferPointer();
+  IndexType                  bufferedLast;
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    bufferedLast[i] = bufferedIndex[i] + static_cast< OffsetValueType >( bufferedRegion.GetSize()[i] ) - 1;
+    }
+
+  SizeValueType neighborhoodSize = 1;
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    neighborhoodSize *= 2 * radius[i] + 1;
+    }
+  const SizeValueType   medianPosition = neighborhoodSize / 2;
+  const OffsetValueType radius0 = static_cast< OffsetValueType >( radius[0] );
+
+  // support progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels()
+                             / outputRegionForThread.GetSize()[0] );
+
+  HistogramType       histogram;
+  OffsetContainerType columnOffsets;
+  OffsetContainerType previousOffsets;
+
+  ImageLinearIteratorWithIndex< OutputImageType > it(output, outputRegionForThread);
+  it.SetDirection(0);
+  for ( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+    {
+    const IndexType lineStart = it.GetIndex();
+
+    // offsets in the buffer of the pixels of a column of the
+    // neighborhood, made of all the dimensions but the first one
+    columnOffsets.assign(1, 0);
+    for ( unsigned int i = 1; i < InputImageDimension; i++ )
+      {
+      previousOffsets.swap(columnOffsets);
+      columnOffsets.clear();
+      for ( OffsetValueType k = -static_cast< OffsetValueType >( radius[i] );
+            k <= static_cast< OffsetValueType >( radius[i] ); k++ )
+        {
+        const OffsetValueType coord =
+          vnl_math_min( vnl_math_max(lineStart[i] + k, bufferedIndex[i]), bufferedLast[i] );
+        const OffsetValueType offset = ( coord - bufferedIndex[i] ) * offsetTable[i];
+        for ( typename OffsetContainerType::const_iterator oit = previousOffsets.begin();
+              oit != previousOffsets.end(); ++oit )
+          {
+          columnOffsets.push_back(*oit + offset);
+          }
+        }
+      }
+
+    // fill the histogram with the neighborhood of the first pixel
+    OffsetValueType x = lineStart[0];
+    for ( OffsetValueType k = x - radius0; k <= x + radius0; k++ )
+      {
+      const InputPixelType *column = buffer
+                                     + vnl_math_min(vnl_math_max(k, bufferedIndex[0]), bufferedLast[0])
+                                     - bufferedIndex[0];
+      for ( typename OffsetContainerType::const_iterator oit = columnOffsets.begin();
+            oit != columnOffsets.end(); ++oit )
+        {
+        histogram.AddPixel(column[*oit]);
+        }
+      }
+
+    // and move it along the line
+    for ( it.GoToBeginOfLine(); !it.IsAtEndOfLine(); ++it, ++x )
+      {
+      it.Set( static_cast< OutputPixelType >( histogram.GetValueAtRank(medianPosition) ) );
+
+      const InputPixelType *removed = buffer
+                                      + vnl_math_min(vnl_math_max(x - radius0, bufferedIndex[0]), bufferedLast[0])
+                                      - bufferedIndex[0];
+      const InputPixelType *added = buffer
+                                    + vnl_math_min(vnl_math_max(x + radius0 + 1, bufferedIndex[0]), bufferedLast[0])
+                                    - bufferedIndex[0];
+      for ( typename OffsetContainerType::const_iterator oit = columnOffsets.begin();
+            oit != columnOffsets.end(); ++oit )
+        {
+        histogram.AddPixel(added[*oit]);
+        histogram.RemovePixel(removed[*oit]);
+        }
+      }
+
+    // empty the histogram for the next line: this is cheaper than
+    // clearing all the bins
+    for ( OffsetValueType k = x - radius0; k <= x + radius0; k++ )
+      {
+      const InputPixelType *column = buffer
+                                     + vnl_math_min(vnl_math_max(k, bufferedIndex[0]), bufferedLast[0])
+                                     - bufferedIndex[0];
+      for ( typename OffsetContainerType::const_iterator oit = columnOffsets.begin();
+            oit != columnOffsets.end(); ++oit )
+        {
+        histogram.RemovePixel(column[*oit]);
+        }
+      }
+    progress.CompletedPixel();
+    }
+}
 } // end namespace itk
 
 #endif
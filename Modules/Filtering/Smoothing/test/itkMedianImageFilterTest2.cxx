@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMedianImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+#include <vector>
+#include <algorithm>
+
+// Check the median filter on a 16 bit image, for which it uses a moving
+// histogram with the larger radii, against a direct computation, and
+// report the time spent for each radius.
+
+int itkMedianImageFilterTest2(int argc, char * argv[])
+{
+  typedef short                          PixelType;
+  typedef itk::Image< PixelType, 2 >     ImageType;
+  typedef ImageType::IndexType           IndexType;
+
+  unsigned int maximumRadius = 10;
+  if ( argc > 1 )
+    {
+    maximumRadius = atoi( argv[1] );
+    }
+
+  ImageType::SizeType size;
+  size[0] = 97;
+  size[1] = 64;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  // a noisy ramp, with values in the whole range of the pixel type
+  unsigned long seed = 1;
+  itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = ( seed * 1103515245 + 12345 ) % 2147483648UL;
+    const long value = static_cast< long >( it.GetIndex()[0] * 300 ) - 15000
+                       + static_cast< long >( seed % 40000 ) - 20000;
+    it.Set( static_cast< PixelType >( vnl_math_max( -32768L, vnl_math_min( 32767L, value ) ) ) );
+    }
+
+  typedef itk::MedianImageFilter< ImageType, ImageType > FilterType;
+
+  int status = EXIT_SUCCESS;
+  std::vector< PixelType > pixels;
+
+  for ( unsigned int r = 1; r <= maximumRadius; r++ )
+    {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    FilterType::InputSizeType radius;
+    radius.Fill( r );
+    filter->SetRadius( radius );
+
+    itk::TimeProbe timer;
+    timer.Start();
+    filter->Update();
+    timer.Stop();
+    std::cout << "Radius " << r << ": " << timer.GetMeanTime() << " s" << std::endl;
+
+    // compute the median of the neighborhood cropped to the image, with
+    // the pixels outside replaced by the nearest pixel of the image
+    unsigned long differences = 0;
+    itk::ImageRegionConstIteratorWithIndex< ImageType > oit( filter->GetOutput(),
+                                                             filter->GetOutput()->GetLargestPossibleRegion() );
+    for ( oit.GoToBegin(); !oit.IsAtEnd(); ++oit )
+      {
+      const IndexType center = oit.GetIndex();
+      pixels.clear();
+      for ( long y = -(long)r; y <= (long)r; y++ )
+        {
+        for ( long x = -(long)r; x <= (long)r; x++ )
+          {
+          IndexType idx;
+          idx[0] = vnl_math_max( 0L, vnl_math_min( (long)size[0] - 1, (long)center[0] + x ) );
+          idx[1] = vnl_math_max( 0L, vnl_math_min( (long)size[1] - 1, (long)center[1] + y ) );
+          pixels.push_back( image->GetPixel( idx ) );
+          }
+        }
+      std::nth_element( pixels.begin(), pixels.begin() + pixels.size() / 2, pixels.end() );
+      if ( pixels[pixels.size() / 2] != oit.Get() )
+        {
+        differences++;
+        }
+      }
+
+    if ( differences != 0 )
+      {
+      std::cerr << "Radius " << r << ": " << differences << " pixels differ from the expected median." << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+
+  return status;
+}
@@ -20,6 +20,8 @@
 
 #include "itkObject.h"
 #include "itkNumericTraits.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 
 namespace itk
 {
@@ -34,6 +36,11 @@ namespace itk
  * OutputConvertTraits() is the traits class.  The default one used is
  * DefaultConvertPixelTraits.
  *
+ * Large buffers are converted in pieces on up to the number of threads
+ * given by the caller, ImageFileReader passing its own number of
+ * threads. Each pixel is converted as on a single thread, so the result
+ * does not depend on the number of threads.
+ *
  * \ingroup ITK-IO-Base
  */
 template<
@@ -47,16 +54,28 @@ public:
   /** Determine the output data type. */
   typedef typename OutputConvertTraits::ComponentType OutputComponentType;
   typedef ConvertPixelBuffer                          Self;
-  /** General method converts from one type to another. */
+  /** General method converts from one type to another, on up to
+   * numberOfThreads threads. */
   static void Convert(InputPixelType *inputData,
                       int inputNumberOfComponents,
-                      OutputPixelType *outputData, size_t size);
+                      OutputPixelType *outputData, size_t size,
+                      int numberOfThreads = 1);
 
   static void ConvertVectorImage(InputPixelType *inputData,
                                  int inputNumberOfComponents,
-                                 OutputPixelType *outputData, size_t size);
+                                 OutputPixelType *outputData, size_t size,
+                                 int numberOfThreads = 1);
 
 protected:
+  /** Convert the pixels on the current thread. */
+  static void ConvertPiece(InputPixelType *inputData,
+                           int inputNumberOfComponents,
+                           OutputPixelType *outputData, size_t size);
+
+  static void ConvertVectorImagePiece(InputPixelType *inputData,
+                                      int inputNumberOfComponents,
+                                      OutputPixelType *outputData, size_t size);
+
   /** Convert to Gray output. */
   /** Input values are cast to output values. */
   static void ConvertGrayToGray(InputPixelType *inputData,
@@ -146,6 +165,27 @@ private:
   ConvertPixelBuffer();
   ~ConvertPixelBuffer();
 
+  /** Structure passed to the threads converting the pieces of a
+   * buffer. */
+  struct ConvertThreadStruct {
+    InputPixelType *InputData;
+    int InputNumberOfComponents;
+    OutputPixelType *OutputData;
+    size_t Size;
+    bool VectorImage;
+    SimpleFastMutexLock Lock;
+    bool Failed;
+    ExceptionObject Exception;
+  };
+
+  /** Convert the buffer in pieces on several threads if it is large. */
+  static void ConvertInPieces(InputPixelType *inputData,
+                              int inputNumberOfComponents,
+                              OutputPixelType *outputData, size_t size,
+                              bool vectorImage, int numberOfThreads);
+
+  static ITK_THREAD_RETURN_TYPE ConvertThreaderCallback(void *arg);
+
   /** the most common case, where InputComponentType == unsigned
    *  char, the alpha is in the range 0..255. I presume in the
    *  mythical world of rgba<X> for all integral scalar types X, alpha
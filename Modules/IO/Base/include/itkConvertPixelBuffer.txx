@@ -31,7 +31,135 @@ void
 ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
 ::Convert(InputPixelType *inputData,
           int inputNumberOfComponents,
-          OutputPixelType *outputData, size_t size)
+          OutputPixelType *outputData, size_t size,
+          int numberOfThreads)
+{
+  Self::ConvertInPieces(inputData, inputNumberOfComponents, outputData, size, false, numberOfThreads);
+}
+
+template< typename InputPixelType,
+          typename OutputPixelType,
+          class OutputConvertTraits
+          >
+void
+ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
+::ConvertVectorImage(InputPixelType *inputData,
+                     int inputNumberOfComponents,
+                     OutputPixelType *outputData, size_t size,
+                     int numberOfThreads)
+{
+  Self::ConvertInPieces(inputData, inputNumberOfComponents, outputData, size, true, numberOfThreads);
+}
+
+template< typename InputPixelType,
+          typename OutputPixelType,
+          class OutputConvertTraits
+          >
+void
+ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
+::ConvertInPieces(InputPixelType *inputData,
+                  int inputNumberOfComponents,
+                  OutputPixelType *outputData, size_t size,
+                  bool vectorImage, int maximumNumberOfThreads)
+{
+  // below this number of pixels per thread, starting the threads costs
+  // more than it saves
+  const size_t minimumNumberOfPixelsPerThread = 1 << 16;
+
+  size_t numberOfThreads = size / minimumNumberOfPixelsPerThread;
+  if ( maximumNumberOfThreads < 1 || numberOfThreads > static_cast< size_t >( maximumNumberOfThreads ) )
+    {
+    numberOfThreads = maximumNumberOfThreads > 1 ? maximumNumberOfThreads : 1;
+    }
+  if ( numberOfThreads < 2 )
+    {
+    if ( vectorImage )
+      {
+      Self::ConvertVectorImagePiece(inputData, inputNumberOfComponents, outputData, size);
+      }
+    else
+      {
+      Self::ConvertPiece(inputData, inputNumberOfComponents, outputData, size);
+      }
+    return;
+    }
+
+  ConvertThreadStruct str;
+  str.InputData = inputData;
+  str.InputNumberOfComponents = inputNumberOfComponents;
+  str.OutputData = outputData;
+  str.Size = size;
+  str.VectorImage = vectorImage;
+  str.Failed = false;
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( static_cast< int >( numberOfThreads ) );
+  threader->SetSingleMethod(Self::ConvertThreaderCallback, &str);
+  threader->SingleMethodExecute();
+
+  if ( str.Failed )
+    {
+    throw str.Exception;
+    }
+}
+
+template< typename InputPixelType,
+          typename OutputPixelType,
+          class OutputConvertTraits
+          >
+ITK_THREAD_RETURN_TYPE
+ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
+::ConvertThreaderCallback(void *arg)
+{
+  const MultiThreader::ThreadInfoStruct *info = (MultiThreader::ThreadInfoStruct *)( arg );
+  ConvertThreadStruct *                  str = (ConvertThreadStruct *)( info->UserData );
+
+  const size_t numberOfThreads = info->NumberOfThreads;
+  const size_t threadId = info->ThreadID;
+  const size_t piece = str->Size / numberOfThreads;
+  const size_t first = piece * threadId;
+  const size_t size = ( threadId == numberOfThreads - 1 ) ? str->Size - first : piece;
+
+  // the input pixels have InputNumberOfComponents components, as do the
+  // output pixels of a VectorImage
+  const size_t inputOffset = first * static_cast< size_t >( str->InputNumberOfComponents );
+  try
+    {
+    if ( str->VectorImage )
+      {
+      Self::ConvertVectorImagePiece(str->InputData + inputOffset, str->InputNumberOfComponents,
+                                    str->OutputData + inputOffset, size);
+      }
+    else
+      {
+      Self::ConvertPiece(str->InputData + inputOffset, str->InputNumberOfComponents,
+                         str->OutputData + first, size);
+      }
+    }
+  catch ( ExceptionObject & err )
+    {
+    // the first exception is rethrown once all the threads are done
+    str->Lock.Lock();
+    if ( !str->Failed )
+      {
+      str->Failed = true;
+      str->Exception = err;
+      }
+    str->Lock.Unlock();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< typename InputPixelType,
+          typename OutputPixelType,
+          class OutputConvertTraits
+          >
+void
+ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
+::ConvertPiece(InputPixelType *inputData,
+               int inputNumberOfComponents,
+               OutputPixelType *outputData, size_t size)
 {
   switch ( OutputConvertTraits::GetNumberOfComponents() )
     {
@@ -692,9 +820,9 @@ template< typename InputPixelType,
           class OutputConvertTraits >
 void
 ConvertPixelBuffer< InputPixelType, OutputPixelType, OutputConvertTraits >
-::ConvertVectorImage(InputPixelType *inputData,
-                     int inputNumberOfComponents,
-                     OutputPixelType *outputData, size_t size)
+::ConvertVectorImagePiece(InputPixelType *inputData,
+                          int inputNumberOfComponents,
+                          OutputPixelType *outputData, size_t size)
 {
   size_t length = size * (size_t)inputNumberOfComponents;
 
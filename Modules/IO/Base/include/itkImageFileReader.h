@@ -23,6 +23,7 @@
 #include "itkMacro.h"
 #include "itkImageRegion.h"
 #include "itkDefaultConvertPixelTraits.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -76,6 +77,17 @@ public:
  * raw binary format) have no accepted suffix, so you will have to
  * manually create the ImageIO instance of the write type.
  *
+ * When UseReadAhead is on and the output is updated piece by piece, as
+ * by StreamingImageFilter or by ImageFileWriter with several stream
+ * divisions, the reader starts reading the piece which is expected to
+ * come next in a background thread as soon as the current piece has
+ * been read, so that the disk is read while the pipeline downstream
+ * processes the current piece. The next piece is predicted from the
+ * step between the last two pieces along the slowest dimension they
+ * split. At most one piece is read ahead; it is dropped if another
+ * region is requested. The background thread uses the ImageIO of the
+ * reader: GetImageIO() waits for it to end before returning the ImageIO.
+ *
  * \sa ImageSeriesReader
  * \sa ImageIOBase
  *
@@ -132,7 +144,10 @@ public:
    * not work properly (e.g., unknown or unusual extension). */
   void  SetImageIO(ImageIOBase *imageIO);
 
-  itkGetObjectMacro(ImageIO, ImageIOBase);
+  /** Get the ImageIO helper class. Waits for the piece being read ahead,
+   * if any, so that the ImageIO is not used by another thread when it is
+   * returned. */
+  virtual ImageIOBase * GetImageIO();
 
   /** Prepare the allocation of the output image during the first back
    * propagation of the pipeline. */
@@ -149,6 +164,12 @@ public:
   itkSetMacro(UseStreaming, bool);
   itkGetConstReferenceMacro(UseStreaming, bool);
   itkBooleanMacro(UseStreaming);
+
+  /** Set/Get whether the next piece of a streamed read is read ahead in
+   * a background thread. Off by default. */
+  itkSetMacro(UseReadAhead, bool);
+  itkGetConstReferenceMacro(UseReadAhead, bool);
+  itkBooleanMacro(UseReadAhead);
 protected:
   ImageFileReader();
   ~ImageFileReader();
@@ -175,6 +196,8 @@ protected:
   std::string m_FileName; // The file to be read
 
   bool m_UseStreaming;
+
+  bool m_UseReadAhead;
 private:
   ImageFileReader(const Self &); //purposely not implemented
   void operator=(const Self &);  //purposely not implemented
@@ -184,6 +207,33 @@ private:
   // The region that the ImageIO class will return when we ask to
   // produce the requested region.
   ImageIORegion m_ActualIORegion;
+
+  typedef typename TOutputImage::PixelContainerPointer PixelContainerPointer;
+
+  /** Start reading the piece expected to follow m_ActualIORegion in a
+   * background thread. */
+  void StartReadAhead();
+
+  /** Wait for the read-ahead thread, which uses m_ImageIO, to end. */
+  void WaitForReadAhead();
+
+  /** Drop the piece read ahead. */
+  void ReleaseReadAhead();
+
+  static ITK_THREAD_RETURN_TYPE ReadAheadThreaderCallback(void *arg);
+
+  // The piece read ahead, into a pixel container handed to the output
+  // when the pixels need no conversion, and into a load buffer
+  // otherwise.
+  MultiThreader::Pointer m_ReadAheadThreader;
+  int                    m_ReadAheadThreadID;
+  ImageIORegion          m_ReadAheadIORegion;
+  PixelContainerPointer  m_ReadAheadPixelContainer;
+  char *                 m_ReadAheadLoadBuffer;
+  bool                   m_ReadAheadFailed;
+
+  // The region read before the current one.
+  ImageRegionType m_PreviousRegion;
 };
 } //namespace ITK
 
@@ -24,6 +24,7 @@
 #include "itkConvertPixelBuffer.h"
 #include "itkPixelTraits.h"
 #include "itkVectorImage.h"
+#include "vnl/vnl_math.h"
 
 #include "itksys/SystemTools.hxx"
 #include <fstream>
@@ -38,12 +39,19 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
   m_FileName = "";
   m_UserSpecifiedImageIO = false;
   m_UseStreaming = true;
+  m_UseReadAhead = false;
+  m_ReadAheadThreadID = -1;
+  m_ReadAheadLoadBuffer = 0;
+  m_ReadAheadFailed = false;
 }
 
 template< class TOutputImage, class ConvertPixelTraits >
 ImageFileReader< TOutputImage, ConvertPixelTraits >
 ::~ImageFileReader()
-{}
+{
+  this->WaitForReadAhead();
+  this->ReleaseReadAhead();
+}
 
 template< class TOutputImage, class ConvertPixelTraits >
 void ImageFileReader< TOutputImage, ConvertPixelTraits >
@@ -64,6 +72,7 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
   os << indent << "UserSpecifiedImageIO flag: " << m_UserSpecifiedImageIO << "\n";
   os << indent << "m_FileName: " << m_FileName << "\n";
   os << indent << "m_UseStreaming: " << m_UseStreaming << "\n";
+  os << indent << "m_UseReadAhead: " << m_UseReadAhead << "\n";
 }
 
 template< class TOutputImage, class ConvertPixelTraits >
@@ -74,12 +83,24 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
   itkDebugMacro("setting ImageIO to " << imageIO);
   if ( this->m_ImageIO != imageIO )
     {
+    this->WaitForReadAhead();
+    this->ReleaseReadAhead();
     this->m_ImageIO = imageIO;
     this->Modified();
     }
   m_UserSpecifiedImageIO = true;
 }
 
+template< class TOutputImage, class ConvertPixelTraits >
+ImageIOBase *
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::GetImageIO()
+{
+  itkDebugMacro("returning ImageIO address " << this->m_ImageIO);
+  this->WaitForReadAhead();
+  return this->m_ImageIO.GetPointer();
+}
+
 template< class TOutputImage, class ConvertPixelTraits >
 void
 ImageFileReader< TOutputImage, ConvertPixelTraits >
@@ -89,6 +110,11 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
 
   itkDebugMacro(<< "Reading file for GenerateOutputInformation()" << m_FileName);
 
+  // the file may have changed since the last piece was read ahead
+  this->WaitForReadAhead();
+  this->ReleaseReadAhead();
+  m_PreviousRegion = ImageRegionType();
+
   // Check to see if we can read the file given the name or prefix
   //
   if ( m_FileName == "" )
@@ -290,6 +316,10 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
 ::EnlargeOutputRequestedRegion(DataObject *output)
 {
   itkDebugMacro (<< "Starting EnlargeOutputRequestedRegion() ");
+
+  // the read-ahead thread uses m_ImageIO
+  this->WaitForReadAhead();
+
   typename TOutputImage::Pointer out = dynamic_cast< TOutputImage * >( output );
   typename TOutputImage::RegionType largestRegion = out->GetLargestPossibleRegion();
   ImageRegionType streamableRegion;
@@ -358,8 +388,32 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
                  << "Allocating the buffer with the EnlargedRequestedRegion \n"
                  << output->GetRequestedRegion() << "\n");
 
-  // allocated the output image to the size of the enlarge requested region
-  this->AllocateOutputs();
+  // the read-ahead thread uses m_ImageIO
+  this->WaitForReadAhead();
+
+  // take the piece read ahead if it is the one to read
+  PixelContainerPointer readAheadPixelContainer;
+  char *                loadBuffer = 0;
+  if ( m_ReadAheadIORegion == m_ActualIORegion
+       && ( m_ReadAheadPixelContainer.IsNotNull() || m_ReadAheadLoadBuffer ) )
+    {
+    itkDebugMacro(<< "Using the piece read ahead");
+    readAheadPixelContainer = m_ReadAheadPixelContainer;
+    loadBuffer = m_ReadAheadLoadBuffer;
+    m_ReadAheadLoadBuffer = 0;
+    }
+  this->ReleaseReadAhead();
+
+  if ( readAheadPixelContainer.IsNotNull() )
+    {
+    output->SetBufferedRegion( output->GetRequestedRegion() );
+    output->SetPixelContainer(readAheadPixelContainer);
+    }
+  else
+    {
+    // allocated the output image to the size of the enlarge requested region
+    this->AllocateOutputs();
+    }
 
   // Test if the file exists and if it can be opened.
   // An exception will be thrown otherwise, since we can't
@@ -379,11 +433,11 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 
   // Tell the ImageIO to read the file
   m_ImageIO->SetFileName( m_FileName.c_str() );
+  m_ImageIO->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   itkDebugMacro (<< "Setting imageIO IORegion to: " << m_ActualIORegion);
   m_ImageIO->SetIORegion(m_ActualIORegion);
 
-  char *loadBuffer = 0;
   // the size of the buffer is computed based on the actual number of
   // pixels to be read and the actual size of the pixels to be read
   // (as opposed to the sizes of the output)
@@ -410,8 +464,11 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
                      << " m_ImageIO->NumComponents "
                      << m_ImageIO->GetNumberOfComponents() );
 
-      loadBuffer = new char[sizeOfActualIORegion];
-      m_ImageIO->Read( static_cast< void * >( loadBuffer ) );
+      if ( !loadBuffer )
+        {
+        loadBuffer = new char[sizeOfActualIORegion];
+        m_ImageIO->Read( static_cast< void * >( loadBuffer ) );
+        }
 
       // See note below as to why the buffered region is needed and
       // not actualIOregion
@@ -430,8 +487,11 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
 
       OutputImagePixelType *outputBuffer = output->GetPixelContainer()->GetBufferPointer();
 
-      loadBuffer = new char[sizeOfActualIORegion];
-      m_ImageIO->Read( static_cast< void * >( loadBuffer ) );
+      if ( !loadBuffer )
+        {
+        loadBuffer = new char[sizeOfActualIORegion];
+        m_ImageIO->Read( static_cast< void * >( loadBuffer ) );
+        }
 
       // we use std::copy here as it should be optimized to memcpy for
       // plain old data, but still is oop
@@ -444,8 +504,11 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
       {
       itkDebugMacro(<< "No buffer conversion required.");
 
-      OutputImagePixelType *outputBuffer = output->GetPixelContainer()->GetBufferPointer();
-      m_ImageIO->Read(outputBuffer);
+      if ( readAheadPixelContainer.IsNull() )
+        {
+        OutputImagePixelType *outputBuffer = output->GetPixelContainer()->GetBufferPointer();
+        m_ImageIO->Read(outputBuffer);
+        }
       }
     }
   catch ( ... )
@@ -469,6 +532,173 @@ void ImageFileReader< TOutputImage, ConvertPixelTraits >
     delete[] loadBuffer;
     loadBuffer = 0;
     }
+
+  if ( m_UseReadAhead )
+    {
+    this->StartReadAhead();
+    }
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+void
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::StartReadAhead()
+{
+  typename TOutputImage::Pointer output = this->GetOutput();
+
+  const ImageRegionType current = output->GetBufferedRegion();
+  const ImageRegionType previous = m_PreviousRegion;
+  const ImageRegionType largestRegion = output->GetLargestPossibleRegion();
+  m_PreviousRegion = current;
+
+  // the slowest dimension along which the image is split into pieces
+  int splitDimension = -1;
+  for ( unsigned int i = 0; i < TOutputImage::ImageDimension; i++ )
+    {
+    if ( current.GetSize(i) < largestRegion.GetSize(i) )
+      {
+      splitDimension = i;
+      }
+    }
+  if ( splitDimension < 0 )
+    {
+    // the whole image has been read
+    return;
+    }
+
+  // the pieces overlap, leave gaps or go backward when the step between
+  // the last two pieces differs from their size
+  IndexValueType step = static_cast< IndexValueType >( current.GetSize(splitDimension) );
+  if ( previous.GetIndex(splitDimension) != current.GetIndex(splitDimension)
+       && previous.GetNumberOfPixels() != 0 )
+    {
+    bool sameOtherwise = true;
+    for ( unsigned int i = 0; i < TOutputImage::ImageDimension; i++ )
+      {
+      if ( static_cast< int >( i ) != splitDimension
+           && ( previous.GetIndex(i) != current.GetIndex(i) || previous.GetSize(i) != current.GetSize(i) ) )
+        {
+        sameOtherwise = false;
+        }
+      }
+    if ( sameOtherwise )
+      {
+      step = current.GetIndex(splitDimension) - previous.GetIndex(splitDimension);
+      }
+    }
+
+  const IndexValueType begin = largestRegion.GetIndex(splitDimension);
+  const IndexValueType end = begin + static_cast< IndexValueType >( largestRegion.GetSize(splitDimension) );
+  ImageRegionType next = current;
+  next.SetIndex(splitDimension, current.GetIndex(splitDimension) + step);
+  if ( next.GetIndex(splitDimension) < begin || next.GetIndex(splitDimension) >= end )
+    {
+    // the last piece has been read
+    return;
+    }
+  next.SetSize( splitDimension,
+                vnl_math_min( current.GetSize(splitDimension),
+                              static_cast< SizeValueType >( end - next.GetIndex(splitDimension) ) ) );
+
+  // the region the ImageIO will read when the next piece is requested,
+  // as in EnlargeOutputRequestedRegion()
+  typedef ImageIORegionAdaptor< TOutputImage::ImageDimension > ImageIOAdaptor;
+  ImageIORegion ioRequestedRegion(TOutputImage::ImageDimension);
+  ImageIOAdaptor::Convert( next, ioRequestedRegion, largestRegion.GetIndex() );
+  m_ReadAheadIORegion = m_ImageIO->GenerateStreamableReadRegionFromRequestedRegion(ioRequestedRegion);
+
+  ImageRegionType nextBufferedRegion;
+  ImageIOAdaptor::Convert( m_ReadAheadIORegion, nextBufferedRegion, largestRegion.GetIndex() );
+
+  ImageIOBase::IOComponentType ioType =
+    ImageIOBase
+    ::MapPixelType< ITK_TYPENAME ConvertPixelTraits::ComponentType >::CType;
+  if ( m_ImageIO->GetComponentType() == ioType
+       && m_ImageIO->GetNumberOfComponents() == ConvertPixelTraits::GetNumberOfComponents()
+       && m_ReadAheadIORegion.GetNumberOfPixels() == nextBufferedRegion.GetNumberOfPixels() )
+    {
+    // read into the buffer the output will use
+    typename TOutputImage::Pointer image = TOutputImage::New();
+    image->SetNumberOfComponentsPerPixel( output->GetNumberOfComponentsPerPixel() );
+    image->SetRegions(nextBufferedRegion);
+    image->Allocate();
+    m_ReadAheadPixelContainer = image->GetPixelContainer();
+    }
+  else
+    {
+    m_ReadAheadLoadBuffer =
+      new char[m_ReadAheadIORegion.GetNumberOfPixels()
+               * ( m_ImageIO->GetComponentSize() * m_ImageIO->GetNumberOfComponents() )];
+    }
+
+  if ( m_ReadAheadThreader.IsNull() )
+    {
+    m_ReadAheadThreader = MultiThreader::New();
+    }
+  try
+    {
+    m_ReadAheadThreadID = m_ReadAheadThreader->SpawnThread(Self::ReadAheadThreaderCallback, this);
+    }
+  catch ( ExceptionObject & )
+    {
+    // no thread can be spawned in a single threaded build
+    m_ReadAheadThreadID = -1;
+    this->ReleaseReadAhead();
+    }
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+ITK_THREAD_RETURN_TYPE
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::ReadAheadThreaderCallback(void *arg)
+{
+  Self *self = (Self *)( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  void *buffer = self->m_ReadAheadLoadBuffer;
+  if ( self->m_ReadAheadPixelContainer.IsNotNull() )
+    {
+    buffer = self->m_ReadAheadPixelContainer->GetBufferPointer();
+    }
+  try
+    {
+    self->m_ImageIO->SetIORegion(self->m_ReadAheadIORegion);
+    self->m_ImageIO->Read(buffer);
+    }
+  catch ( ... )
+    {
+    // the piece is read again, and the error reported, if it is requested
+    self->m_ReadAheadFailed = true;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+void
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::WaitForReadAhead()
+{
+  if ( m_ReadAheadThreadID < 0 )
+    {
+    return;
+    }
+  m_ReadAheadThreader->TerminateThread(m_ReadAheadThreadID);
+  m_ReadAheadThreadID = -1;
+  if ( m_ReadAheadFailed )
+    {
+    this->ReleaseReadAhead();
+    }
+}
+
+template< class TOutputImage, class ConvertPixelTraits >
+void
+ImageFileReader< TOutputImage, ConvertPixelTraits >
+::ReleaseReadAhead()
+{
+  delete[] m_ReadAheadLoadBuffer;
+  m_ReadAheadLoadBuffer = 0;
+  m_ReadAheadPixelContainer = 0;
+  m_ReadAheadFailed = false;
 }
 
 template< class TOutputImage, class ConvertPixelTraits >
@@ -509,7 +739,8 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
         ::ConvertVectorImage(static_cast< type * >( inputData ),        \
                              m_ImageIO->GetNumberOfComponents(),        \
                              outputData,                                \
-                             numberOfPixels);                           \
+                             numberOfPixels,                            \
+                             this->GetNumberOfThreads());               \
       }                                                                 \
     else                                                                \
       {                                                                 \
@@ -520,7 +751,8 @@ ImageFileReader< TOutputImage, ConvertPixelTraits >
         ::Convert(static_cast< type * >( inputData ),                   \
                   m_ImageIO->GetNumberOfComponents(),                   \
                   outputData,                                           \
-                  numberOfPixels);                                      \
+                  numberOfPixels,                                       \
+                  this->GetNumberOfThreads());                          \
       }                                                                 \
     }
 
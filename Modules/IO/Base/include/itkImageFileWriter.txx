@@ -231,6 +231,7 @@ ImageFileWriter< TInputImage >
 
   // configure compression
   m_ImageIO->SetUseCompression(m_UseCompression);
+  m_ImageIO->SetNumberOfThreads( this->GetNumberOfThreads() );
 
   // configure meta dictionary
   if ( m_UseInputMetaDataDictionary )
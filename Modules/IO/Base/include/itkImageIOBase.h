@@ -202,6 +202,13 @@ public:
   itkGetConstMacro(UseStreamedWriting, bool);
   itkBooleanMacro(UseStreamedWriting);
 
+  /** Set/Get the largest number of threads used to read or write the
+   * pixels, e.g. to swap their bytes. ImageFileReader, ImageFileWriter
+   * and ImageSeriesReader set it to their own number of threads.
+   * Defaults to the global default number of threads. */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, int);
+
   /** Convenience method returns the IOComponentType as a string. This can be
    * used for writing output files. */
   std::string GetComponentTypeAsString(IOComponentType) const;
@@ -316,6 +323,16 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer) = 0;
 
+  /** Create an ImageIO of the same type which reads files the way this
+   * one does, so that several files can be read at the same time. NULL
+   * is returned, the default, when the settings of this ImageIO can not
+   * be carried over. ImageSeriesReader reads the slices of a series with
+   * such copies of the ImageIO set by the user on several threads. */
+  virtual Pointer CreateAnotherForReading() const
+  {
+    return NULL;
+  }
+
   /*-------- This part of the interfaces deals with writing data ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -550,6 +567,9 @@ protected:
   /** Should we use streaming for writing */
   bool m_UseStreamedWriting;
 
+  /** The largest number of threads used on the pixels. */
+  int m_NumberOfThreads;
+
   /** The region to read or write. The region contains information about the
    * data within the region to read or write. */
   ImageIORegion m_IORegion;
@@ -23,6 +23,7 @@
 #include <string>
 #include "itkMetaDataDictionary.h"
 #include "itkImageFileReader.h"
+#include "itkSimpleFastMutexLock.h"
 
 namespace itk
 {
@@ -34,6 +35,17 @@ namespace itk
  * the files, but the image data must have the same Size for all
  * dimensions.
  *
+ * The slices covering the requested region are read concurrently by
+ * NumberOfThreads threads, each reading one slice at a time directly
+ * into the output buffer. The meta data dictionaries are stored in the
+ * order of the files whatever the order in which the slices are read. When
+ * an ImageIO is set with SetImageIO(), each thread reads with its own
+ * copy of it made by ImageIOBase::CreateAnotherForReading(), and the last
+ * slice is read with the ImageIO itself so that it is left holding the
+ * information of that slice, as when the slices are read one at a time.
+ * The slices are read one at a time when the ImageIO can not be copied.
+ * The reader of each slice converts its pixels on a single thread.
+ *
  * \sa GDCMSeriesFileNames
  * \sa NumericSeriesFileNames
  * \ingroup IOFilters
@@ -191,6 +203,36 @@ private:
 
   int ComputeMovingDimensionIndex(ReaderType *reader);
 
+  /** Structure passed to the threads reading the slices. The slices
+   * are handed out one at a time in the order of the files. */
+  struct ReadSlicesThreadStruct {
+    Self *Filter;
+    ImageRegionType RequestedRegion;
+    ImageRegionType SliceRegionToRequest;
+    SizeType ValidSize;
+    bool NeedToUpdateMetaDataDictionaryArray;
+    typename TOutputImage::InternalPixelType *OutputBuffer;
+    std::vector< int > Slices;
+    std::vector< DictionaryRawPointer > Dictionaries;
+    std::vector< ImageIOBase::Pointer > ImageIOs;
+    SimpleFastMutexLock Lock;
+    SizeValueType NextSlice;
+    SizeValueType NumberOfSlicesToRead;
+    SizeValueType NumberOfSlicesRead;
+    bool Failed;
+    ExceptionObject Exception;
+  };
+
+  /** Read the slice i into the output buffer if it is inside the
+   * requested region, and copy its meta data dictionary if it is
+   * needed. The slice is read with imageIO, or with an ImageIO created
+   * by the factory when it is NULL. */
+  void ReadSlice(int i, ReadSlicesThreadStruct *str, ImageIOBase *imageIO,
+                 DictionaryRawPointer & dictionary);
+
+  /** Read the slices handed out to the current thread. */
+  static ITK_THREAD_RETURN_TYPE ReadSlicesThreaderCallback(void *arg);
+
   /** Modified time of the MetaDataDictionaryArray */
   TimeStamp m_MetaDataDictionaryArrayMTime;
 
@@ -23,7 +23,6 @@
 #include "itkImageRegionIterator.h"
 #include "itkArray.h"
 #include "vnl/vnl_math.h"
-#include "itkProgressReporter.h"
 #include "itkMetaDataObject.h"
 
 namespace itk
@@ -280,12 +279,15 @@ void ImageSeriesReader< TOutputImage >
 {
   TOutputImage *output = this->GetOutput();
 
-  ImageRegionType requestedRegion = output->GetRequestedRegion();
+  ReadSlicesThreadStruct str;
+  str.Filter = this;
+  str.RequestedRegion = output->GetRequestedRegion();
+  str.SliceRegionToRequest = output->GetRequestedRegion();
+
   ImageRegionType largestRegion = output->GetLargestPossibleRegion();
-  ImageRegionType sliceRegionToRequest = output->GetRequestedRegion();
 
   // Each file must have the same size.
-  SizeType validSize = largestRegion.GetSize();
+  str.ValidSize = largestRegion.GetSize();
 
   // If more than one file is being read, then the input dimension
   // will be less than the output dimension.  In this case, set
@@ -294,32 +296,30 @@ void ImageSeriesReader< TOutputImage >
   // not be done because it will lower the dimension of the output image.
   if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
     {
-    validSize[this->m_NumberOfDimensionsInImage] = 1;
-    sliceRegionToRequest.SetSize(this->m_NumberOfDimensionsInImage, 1);
-    sliceRegionToRequest.SetIndex(this->m_NumberOfDimensionsInImage, 0);
+    str.ValidSize[this->m_NumberOfDimensionsInImage] = 1;
+    str.SliceRegionToRequest.SetSize(this->m_NumberOfDimensionsInImage, 1);
+    str.SliceRegionToRequest.SetIndex(this->m_NumberOfDimensionsInImage, 0);
     }
 
   // Allocate the output buffer
-  output->SetBufferedRegion(requestedRegion);
+  output->SetBufferedRegion(str.RequestedRegion);
   output->Allocate();
 
-  // progress reported on a per slice basis
-  ProgressReporter progress(this, 0,
-                            requestedRegion.GetSize(TOutputImage::ImageDimension-1),
-                            100);
-
   // We utilize the modified time of the output information to
   // know when the meta array needs to be updated, when the output
   // information is updated so should the meta array.
   // Each file can not be read in the UpdateOutputInformation methods
   // due to the poor performance of reading each file a second time there.
-  bool needToUpdateMetaDataDictionaryArray =
+  str.NeedToUpdateMetaDataDictionaryArray =
     this->m_OutputInformationMTime > this->m_MetaDataDictionaryArrayMTime
     && m_MetaDataDictionaryArrayUpdate;
 
-  typename  TOutputImage::InternalPixelType *outputBuffer = output->GetBufferPointer();
-  IndexType                           sliceStartIndex = requestedRegion.GetIndex();
-  const int                           numberOfFiles = static_cast< int >( m_FileNames.size() );
+  str.OutputBuffer = output->GetBufferPointer();
+
+  // the slices which are read, or whose meta data is needed
+  IndexType sliceStartIndex = str.RequestedRegion.GetIndex();
+  const int numberOfFiles = static_cast< int >( m_FileNames.size() );
+  str.NumberOfSlicesToRead = 0;
   for ( int i = 0; i != numberOfFiles; ++i )
     {
     if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
@@ -327,121 +327,284 @@ void ImageSeriesReader< TOutputImage >
       sliceStartIndex[this->m_NumberOfDimensionsInImage] = i;
       }
 
-    const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
-    const int  iFileName = ( m_ReverseOrder ? numberOfFiles - i - 1 : i );
+    const bool insideRequestedRegion = str.RequestedRegion.IsInside(sliceStartIndex);
 
     // check if we need this slice
-    if ( !insideRequestedRegion && !needToUpdateMetaDataDictionaryArray )
+    if ( !insideRequestedRegion && !str.NeedToUpdateMetaDataDictionaryArray )
       {
       continue;
       }
+    str.Slices.push_back(i);
+    if ( insideRequestedRegion )
+      {
+      ++str.NumberOfSlicesToRead;
+      }
+    }
 
-    // configure reader
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( m_FileNames[iFileName].c_str() );
+  str.Dictionaries.assign(str.Slices.size(), 0);
+  str.NextSlice = 0;
+  str.NumberOfSlicesRead = 0;
+  str.Failed = false;
 
-    TOutputImage * readerOutput = reader->GetOutput();
+  unsigned int numberOfThreads = this->GetNumberOfThreads();
+  if ( numberOfThreads > str.Slices.size() )
+    {
+    numberOfThreads = static_cast< unsigned int >( str.Slices.size() );
+    }
+  if ( numberOfThreads == 0 )
+    {
+    numberOfThreads = 1;
+    }
 
-    if ( m_ImageIO )
+  // an ImageIO given by the user can not be shared between threads, each
+  // thread reads with its own copy of it
+  if ( m_ImageIO && numberOfThreads > 1 )
+    {
+    for ( unsigned int t = 0; t < numberOfThreads; t++ )
       {
-      reader->SetImageIO(m_ImageIO);
+      ImageIOBase::Pointer imageIO = m_ImageIO->CreateAnotherForReading();
+      if ( imageIO.IsNull() )
+        {
+        str.ImageIOs.clear();
+        numberOfThreads = 1;
+        break;
+        }
+      str.ImageIOs.push_back(imageIO);
       }
-    reader->SetUseStreaming(m_UseStreaming);
-    readerOutput->SetRequestedRegion(sliceRegionToRequest);
+    }
 
-    // update the data or info
-    if ( !insideRequestedRegion )
+  try
+    {
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+    this->GetMultiThreader()->SetSingleMethod(this->ReadSlicesThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+  catch ( ... )
+    {
+    for ( unsigned int n = 0; n < str.Dictionaries.size(); n++ )
       {
-      reader->UpdateOutputInformation();
+      delete str.Dictionaries[n];
       }
-    else
+    throw;
+    }
+
+  // Move the MetaDataDictionaries into the array in the order of the files
+  for ( unsigned int n = 0; n < str.Dictionaries.size(); n++ )
+    {
+    if ( str.Dictionaries[n] )
+      {
+      m_MetaDataDictionaryArray.push_back(str.Dictionaries[n]);
+      }
+    }
+
+  if ( str.Failed )
+    {
+    throw str.Exception;
+    }
+
+  // update the time if we modified the meta array
+  if ( str.NeedToUpdateMetaDataDictionaryArray )
+    {
+    m_MetaDataDictionaryArrayMTime.Modified();
+    }
+
+  this->UpdateProgress(1.0f);
+}
+
+template< class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+ImageSeriesReader< TOutputImage >
+::ReadSlicesThreaderCallback(void *arg)
+{
+  const unsigned int threadId =
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  ReadSlicesThreadStruct *str = (ReadSlicesThreadStruct *)
+                                ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+  Self *self = str->Filter;
+
+  const SizeValueType numberOfSlices = str->Slices.size();
+  for (;; )
+    {
+    str->Lock.Lock();
+    const SizeValueType next = str->NextSlice++;
+    const bool          stop = str->Failed || self->GetAbortGenerateData();
+    str->Lock.Unlock();
+
+    if ( next >= numberOfSlices || stop )
       {
-      // read the meta data information
-      readerOutput->UpdateOutputInformation();
+      break;
+      }
 
-      // propagate the requested region to determin what the region
-      // will actually be read
-      readerOutput->PropagateRequestedRegion();
+    // the last slice is read with the ImageIO of the user, if any, to
+    // leave it holding the information of that slice
+    ImageIOBase *imageIO = self->m_ImageIO.GetPointer();
+    if ( !str->ImageIOs.empty() && next + 1 < numberOfSlices )
+      {
+      imageIO = str->ImageIOs[threadId].GetPointer();
+      }
 
-      // check that the size of each slice is the same
-      if ( readerOutput->GetLargestPossibleRegion().GetSize() != validSize )
+    try
+      {
+      self->ReadSlice(str->Slices[next], str, imageIO, str->Dictionaries[next]);
+      }
+    catch ( ExceptionObject & err )
+      {
+      // the first exception is rethrown once all the threads are done
+      str->Lock.Lock();
+      if ( !str->Failed )
         {
-        itkExceptionMacro( << "Size mismatch! The size of  "
-                           << m_FileNames[iFileName].c_str()
-                           << " is "
-                           << readerOutput->GetLargestPossibleRegion().GetSize()
-                           << " and does not match the required size "
-                           << validSize
-                           << " from file "
-                           << m_FileNames[m_ReverseOrder ? m_FileNames.size() - 1 : 0].c_str() );
+        str->Failed = true;
+        str->Exception = err;
         }
+      str->Lock.Unlock();
+      break;
+      }
 
-      // get the size of the region to be read
-      SizeType readSize = readerOutput->GetRequestedRegion().GetSize();
+    // progress reported on a per slice basis by the first thread
+    if ( threadId == 0 && str->NumberOfSlicesToRead > 0 )
+      {
+      str->Lock.Lock();
+      const SizeValueType numberOfSlicesRead = str->NumberOfSlicesRead;
+      str->Lock.Unlock();
+      self->UpdateProgress( static_cast< float >( numberOfSlicesRead )
+                            / static_cast< float >( str->NumberOfSlicesToRead ) );
+      }
+    }
 
-      if( readSize == sliceRegionToRequest.GetSize() )
-        {
-        // if the buffer of the ImageReader is going to match that of
-        // ourselves, then set the ImageReader's buffer to a section
-        // of ours
+  if ( threadId == 0 )
+    {
+    if ( self->GetAbortGenerateData() )
+      {
+      std::string    msg;
+      ProcessAborted e(__FILE__, __LINE__);
+      msg += "Object " + std::string( self->GetNameOfClass() ) + ": AbortGenerateDataOn";
+      e.SetDescription(msg);
+      throw e;
+      }
+    }
 
-        const size_t  numberOfPixelsInSlice = sliceRegionToRequest.GetNumberOfPixels();
+  return ITK_THREAD_RETURN_VALUE;
+}
 
-        typedef typename TOutputImage::AccessorFunctorType AccessorFunctorType;
-        const size_t      numberOfInternalComponentsPerPixel =  AccessorFunctorType::GetVectorLength( output );
+template< class TOutputImage >
+void ImageSeriesReader< TOutputImage >
+::ReadSlice(int i, ReadSlicesThreadStruct *str, ImageIOBase *imageIO,
+            DictionaryRawPointer & dictionary)
+{
+  TOutputImage *                output = this->GetOutput();
+  const ImageRegionType &       requestedRegion = str->RequestedRegion;
+  const ImageRegionType &       sliceRegionToRequest = str->SliceRegionToRequest;
+  const int                     numberOfFiles = static_cast< int >( m_FileNames.size() );
 
-        const ptrdiff_t   sliceOffset = ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage ) ?
-          ( i - requestedRegion.GetIndex(this->m_NumberOfDimensionsInImage)) : 0;
-        const ptrdiff_t  numberOfPixelComponentsUpToSlice =  numberOfPixelsInSlice * numberOfInternalComponentsPerPixel * sliceOffset;
-        const bool       bufferDelete = false;
+  IndexType sliceStartIndex = requestedRegion.GetIndex();
+  if ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage )
+    {
+    sliceStartIndex[this->m_NumberOfDimensionsInImage] = i;
+    }
 
+  const bool insideRequestedRegion = requestedRegion.IsInside(sliceStartIndex);
+  const int  iFileName = ( m_ReverseOrder ? numberOfFiles - i - 1 : i );
 
-        typename  TOutputImage::InternalPixelType * outputSliceBuffer = outputBuffer + numberOfPixelComponentsUpToSlice;
+  // configure reader
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( m_FileNames[iFileName].c_str() );
 
-        readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer, numberOfPixelsInSlice, bufferDelete );
-        readerOutput->UpdateOutputData();
-        }
-      else
-        {
-        // the read region isn't going to match exactly what we need
-        // to update to buffer created by the reader, then copy
+  TOutputImage * readerOutput = reader->GetOutput();
 
-        reader->Update();
+  if ( imageIO )
+    {
+    reader->SetImageIO(imageIO);
+    }
+  reader->SetUseStreaming(m_UseStreaming);
+  // the slices are already read on several threads
+  reader->SetNumberOfThreads(1);
+  readerOutput->SetRequestedRegion(sliceRegionToRequest);
 
-        ImageRegionIterator< TOutputImage > ot( output, requestedRegion );
-        // set the output iterator for this slice
-        ot.SetIndex(sliceStartIndex);
+  // update the data or info
+  if ( !insideRequestedRegion )
+    {
+    reader->UpdateOutputInformation();
+    }
+  else
+    {
+    // read the meta data information
+    readerOutput->UpdateOutputInformation();
 
-        ImageRegionConstIterator< TOutputImage > it (readerOutput, sliceRegionToRequest);
+    // propagate the requested region to determin what the region
+    // will actually be read
+    readerOutput->PropagateRequestedRegion();
 
-        // for loop copy
-        while ( !it.IsAtEnd() )
-          {
-          ot.Set( it.Get() );
-          ++it;
-          ++ot;
-          }
-        }
+    // check that the size of each slice is the same
+    if ( readerOutput->GetLargestPossibleRegion().GetSize() != str->ValidSize )
+      {
+      itkExceptionMacro( << "Size mismatch! The size of  "
+                         << m_FileNames[iFileName].c_str()
+                         << " is "
+                         << readerOutput->GetLargestPossibleRegion().GetSize()
+                         << " and does not match the required size "
+                         << str->ValidSize
+                         << " from file "
+                         << m_FileNames[m_ReverseOrder ? m_FileNames.size() - 1 : 0].c_str() );
+      }
+
+    // get the size of the region to be read
+    SizeType readSize = readerOutput->GetRequestedRegion().GetSize();
+
+    if( readSize == sliceRegionToRequest.GetSize() )
+      {
+      // if the buffer of the ImageReader is going to match that of
+      // ourselves, then set the ImageReader's buffer to a section
+      // of ours
+
+      const size_t  numberOfPixelsInSlice = sliceRegionToRequest.GetNumberOfPixels();
+
+      typedef typename TOutputImage::AccessorFunctorType AccessorFunctorType;
+      const size_t      numberOfInternalComponentsPerPixel =  AccessorFunctorType::GetVectorLength( output );
 
-      // report progress for read slices
-      progress.CompletedPixel();
+      const ptrdiff_t   sliceOffset = ( TOutputImage::ImageDimension != this->m_NumberOfDimensionsInImage ) ?
+        ( i - requestedRegion.GetIndex(this->m_NumberOfDimensionsInImage)) : 0;
+      const ptrdiff_t  numberOfPixelComponentsUpToSlice =  numberOfPixelsInSlice * numberOfInternalComponentsPerPixel * sliceOffset;
+      const bool       bufferDelete = false;
 
-     } // end !insidedRequestedRegion
 
-    // Deep copy the MetaDataDictionary into the array
-    if ( reader->GetImageIO() &&  needToUpdateMetaDataDictionaryArray )
+      typename  TOutputImage::InternalPixelType * outputSliceBuffer = str->OutputBuffer + numberOfPixelComponentsUpToSlice;
+
+      readerOutput->GetPixelContainer()->SetImportPointer( outputSliceBuffer, numberOfPixelsInSlice, bufferDelete );
+      readerOutput->UpdateOutputData();
+      }
+    else
       {
-      DictionaryRawPointer newDictionary = new DictionaryType;
-      *newDictionary = reader->GetImageIO()->GetMetaDataDictionary();
-      m_MetaDataDictionaryArray.push_back(newDictionary);
+      // the read region isn't going to match exactly what we need
+      // to update to buffer created by the reader, then copy
+
+      reader->Update();
+
+      ImageRegionIterator< TOutputImage > ot( output, requestedRegion );
+      // set the output iterator for this slice
+      ot.SetIndex(sliceStartIndex);
+
+      ImageRegionConstIterator< TOutputImage > it (readerOutput, sliceRegionToRequest);
+
+      // for loop copy
+      while ( !it.IsAtEnd() )
+        {
+        ot.Set( it.Get() );
+        ++it;
+        ++ot;
+        }
       }
 
-    } // end per slice loop
+    str->Lock.Lock();
+    ++str->NumberOfSlicesRead;
+    str->Lock.Unlock();
 
-  // update the time if we modified the meta array
-  if ( needToUpdateMetaDataDictionaryArray )
+    } // end !insidedRequestedRegion
+
+  // Deep copy the MetaDataDictionary
+  if ( reader->GetImageIO() &&  str->NeedToUpdateMetaDataDictionaryArray )
     {
-    m_MetaDataDictionaryArrayMTime.Modified();
+    dictionary = new DictionaryType;
+    *dictionary = reader->GetImageIO()->GetMetaDataDictionary();
     }
 }
 
@@ -26,6 +26,7 @@
 #include "itkCovariantVector.h"
 #include "itkDiffusionTensor3D.h"
 #include "itkImageRegionSplitter.h"
+#include "itkMultiThreader.h"
 
 namespace itk
 {
@@ -37,6 +38,7 @@ ImageIOBase::ImageIOBase():
   m_NumberOfDimensions(0)
 {
   Reset(false);
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
 }
 
 void ImageIOBase::Reset(const bool)
@@ -928,6 +930,7 @@ void ImageIOBase::PrintSelf(std::ostream & os, Indent indent) const
     {
     os << indent << "UseStreamedWriting: Off" << std::endl;
     }
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
 }
 
 } //namespace itk
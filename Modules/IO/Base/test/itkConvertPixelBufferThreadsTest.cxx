@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkConvertPixelBuffer.h"
+#include "itkDefaultConvertPixelTraits.h"
+#include "itkByteSwapper.h"
+#include "itkRGBAPixel.h"
+#include "itkTimeProbe.h"
+#include <vector>
+#include <cstring>
+
+// Convert and byte swap large buffers with one and several threads, check
+// that the results are the same, and report the time taken by both.
+
+namespace
+{
+// a buffer size which is not a multiple of the number of threads
+const size_t NumberOfPixels = 1000003;
+
+template< class TInput, class TOutput, class TTraits >
+int CompareConvert(const char *name, unsigned int numberOfComponents,
+                   unsigned int numberOfOutputComponents, bool vectorImage,
+                   int numberOfThreads)
+{
+  std::vector< TInput > input(NumberOfPixels * numberOfComponents);
+  for ( size_t i = 0; i < input.size(); i++ )
+    {
+    input[i] = static_cast< TInput >( ( i * 7919 ) % 251 );
+    }
+
+  typedef itk::ConvertPixelBuffer< TInput, TOutput, TTraits > ConverterType;
+  std::vector< TOutput > outputs[2];
+  itk::TimeProbe         timers[2];
+  for ( unsigned int threaded = 0; threaded < 2; threaded++ )
+    {
+    const int threads = threaded ? numberOfThreads : 1;
+    outputs[threaded].resize(NumberOfPixels * numberOfOutputComponents);
+    timers[threaded].Start();
+    if ( vectorImage )
+      {
+      ConverterType::ConvertVectorImage(&input[0], numberOfComponents,
+                                        &outputs[threaded][0], NumberOfPixels, threads);
+      }
+    else
+      {
+      ConverterType::Convert(&input[0], numberOfComponents,
+                             &outputs[threaded][0], NumberOfPixels, threads);
+      }
+    timers[threaded].Stop();
+    }
+
+  std::cout << name << ": " << timers[0].GetTotal() << " s, "
+            << numberOfThreads << " threads " << timers[1].GetTotal() << " s" << std::endl;
+
+  for ( size_t i = 0; i < outputs[0].size(); i++ )
+    {
+    if ( !( outputs[0][i] == outputs[1][i] ) )
+      {
+      std::cerr << name << ": pixel " << i << " is " << outputs[1][i]
+                << " with " << numberOfThreads << " threads instead of "
+                << outputs[0][i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+template< class T >
+int CompareSwap(const char *name, int numberOfThreads)
+{
+  // more than one piece per thread
+  const size_t numberOfWords = 4 * NumberOfPixels + 3;
+  std::vector< T > input(numberOfWords);
+  for ( size_t i = 0; i < numberOfWords; i++ )
+    {
+    input[i] = static_cast< T >( i * 2654435761u );
+    }
+
+  std::vector< T > outputs[2];
+  itk::TimeProbe   timers[2];
+  for ( unsigned int threaded = 0; threaded < 2; threaded++ )
+    {
+    const int threads = threaded ? numberOfThreads : 1;
+    outputs[threaded] = input;
+    timers[threaded].Start();
+    if ( itk::ByteSwapper< T >::SystemIsBigEndian() )
+      {
+      itk::ByteSwapper< T >::SwapRangeFromSystemToLittleEndian(&outputs[threaded][0], numberOfWords, threads);
+      }
+    else
+      {
+      itk::ByteSwapper< T >::SwapRangeFromSystemToBigEndian(&outputs[threaded][0], numberOfWords, threads);
+      }
+    timers[threaded].Stop();
+    }
+
+  std::cout << name << ": " << timers[0].GetTotal() << " s, "
+            << numberOfThreads << " threads " << timers[1].GetTotal() << " s" << std::endl;
+
+  for ( size_t i = 0; i < numberOfWords; i++ )
+    {
+    // the swapped words are the same, and swapped
+    const unsigned char *original = reinterpret_cast< const unsigned char * >( &input[i] );
+    const unsigned char *swapped = reinterpret_cast< const unsigned char * >( &outputs[1][i] );
+    for ( unsigned int b = 0; b < sizeof( T ); b++ )
+      {
+      if ( swapped[b] != original[sizeof( T ) - 1 - b] )
+        {
+        std::cerr << name << ": word " << i << " is not swapped with "
+                  << numberOfThreads << " threads" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    // the swapped words may be NaN, compare their bytes
+    if ( std::memcmp( &outputs[0][i], &outputs[1][i], sizeof( T ) ) != 0 )
+      {
+      std::cerr << name << ": word " << i << " differs with "
+                << numberOfThreads << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int itkConvertPixelBufferThreadsTest(int, char *[])
+{
+  const int numberOfThreads = 4;
+
+  typedef itk::RGBPixel< unsigned char >  RGBPixelType;
+  typedef itk::RGBAPixel< unsigned char > RGBAPixelType;
+
+  int status = EXIT_SUCCESS;
+  try
+    {
+    if ( CompareConvert< short, float, itk::DefaultConvertPixelTraits< float > >
+           ("short to float", 1, 1, false, numberOfThreads) != EXIT_SUCCESS
+         || CompareConvert< unsigned char, unsigned short, itk::DefaultConvertPixelTraits< unsigned short > >
+           ("RGB to gray", 3, 1, false, numberOfThreads) != EXIT_SUCCESS
+         || CompareConvert< unsigned char, float, itk::DefaultConvertPixelTraits< float > >
+           ("RGBA to gray", 4, 1, false, numberOfThreads) != EXIT_SUCCESS
+         || CompareConvert< unsigned char, RGBAPixelType, itk::DefaultConvertPixelTraits< RGBAPixelType > >
+           ("RGB to RGBA", 3, 1, false, numberOfThreads) != EXIT_SUCCESS
+         || CompareConvert< unsigned char, RGBPixelType, itk::DefaultConvertPixelTraits< RGBPixelType > >
+           ("5 components to RGB", 5, 1, false, numberOfThreads) != EXIT_SUCCESS
+         || CompareConvert< short, double, itk::DefaultConvertPixelTraits< double > >
+           ("vector image", 3, 3, true, numberOfThreads) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    if ( CompareSwap< unsigned short >("swap 2 bytes", numberOfThreads) != EXIT_SUCCESS
+         || CompareSwap< unsigned int >("swap 4 bytes", numberOfThreads) != EXIT_SUCCESS
+         || CompareSwap< double >("swap 8 bytes", numberOfThreads) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
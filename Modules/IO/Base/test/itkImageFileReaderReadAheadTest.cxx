@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+// Stream images through readers reading the next piece ahead, with
+// pieces following each other, overlapping and out of order, with and
+// without a pixel type conversion, and check the pixels. The ImageIO
+// returned by the reader must be done with the next piece. The time
+// taken with and without read-ahead is reported.
+
+typedef itk::Image< short, 3 > ShortImageType;
+typedef itk::Image< float, 3 > FloatImageType;
+
+static short ExpectedPixel(const ShortImageType::IndexType & index)
+{
+  return static_cast< short >( index[0] - 7 * index[1] + 300 * index[2] );
+}
+
+template< class TImage >
+static int CheckRegion(const TImage *image, const typename TImage::RegionType & region, const char *name)
+{
+  if ( !image->GetBufferedRegion().IsInside(region) )
+    {
+    std::cerr << name << ": the buffered region " << image->GetBufferedRegion()
+              << " does not contain " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ImageRegionConstIteratorWithIndex< TImage > it(image, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != static_cast< typename TImage::PixelType >( ExpectedPixel( it.GetIndex() ) ) )
+      {
+      std::cerr << name << ": pixel " << it.GetIndex() << " is " << it.Get()
+                << " instead of " << ExpectedPixel( it.GetIndex() ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+// request the slices [first, first + size) with first moving by step,
+// from the last slices when step is negative
+template< class TImage >
+static int ReadSlices(const std::string & fileName, bool readAhead, int size, int step)
+{
+  typedef itk::ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->SetUseReadAhead(readAhead);
+  reader->UpdateOutputInformation();
+
+  const typename TImage::RegionType largestRegion = reader->GetOutput()->GetLargestPossibleRegion();
+  const int numberOfSlices = static_cast< int >( largestRegion.GetSize(2) );
+  for ( int first = ( step > 0 ) ? 0 : numberOfSlices - size;
+        first < numberOfSlices && first + size > 0; first += step )
+    {
+    typename TImage::RegionType region = largestRegion;
+    region.SetIndex( 2, vnl_math_max(first, 0) );
+    region.SetSize( 2, vnl_math_min(first + size, numberOfSlices) - vnl_math_max(first, 0) );
+    reader->GetOutput()->SetRequestedRegion(region);
+    reader->GetOutput()->Update();
+    if ( CheckRegion(reader->GetOutput(), region, fileName.c_str()) != EXIT_SUCCESS )
+      {
+      return EXIT_FAILURE;
+      }
+
+    // once the step is known, the next piece is being read ahead, and
+    // GetImageIO() waits for it
+    const int next = first + step;
+    if ( readAhead && first != ( ( step > 0 ) ? 0 : numberOfSlices - size )
+         && next >= 0 && next + size <= numberOfSlices
+         && reader->GetImageIO()->GetIORegion().GetIndex(2) != next )
+      {
+      std::cerr << fileName << ": the ImageIO reads " << reader->GetImageIO()->GetIORegion()
+                << " instead of the slices from " << next << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+template< class TImage >
+static int StreamImage(const std::string & fileName, bool readAhead, double & time)
+{
+  typedef itk::ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->SetUseReadAhead(readAhead);
+
+  typedef itk::StreamingImageFilter< TImage, TImage > StreamerType;
+  typename StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( reader->GetOutput() );
+  streamer->SetNumberOfStreamDivisions(9);
+
+  itk::TimeProbe timer;
+  timer.Start();
+  streamer->Update();
+  timer.Stop();
+  time = timer.GetTotal();
+
+  return CheckRegion( streamer->GetOutput(), streamer->GetOutput()->GetLargestPossibleRegion(),
+                      fileName.c_str() );
+}
+
+int itkImageFileReaderReadAheadTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkIOTests itkImageFileReaderReadAheadTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ShortImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 57;
+  size[2] = 40;
+  ShortImageType::Pointer image = ShortImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ShortImageType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( ExpectedPixel( it.GetIndex() ) );
+    }
+
+  const std::string fileName = std::string(av[1]) + "/itkImageFileReaderReadAheadTest.mha";
+  typedef itk::ImageFileWriter< ShortImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+
+  int status = EXIT_SUCCESS;
+  try
+    {
+    writer->Update();
+
+    for ( unsigned int readAhead = 0; readAhead < 2; readAhead++ )
+      {
+      // consecutive, overlapping, spaced and backward pieces
+      const int pieces[4][2] = { { 5, 5 }, { 6, 4 }, { 3, 7 }, { 4, -4 } };
+      for ( unsigned int p = 0; p < 4; p++ )
+        {
+        if ( ReadSlices< ShortImageType >(fileName, readAhead != 0, pieces[p][0], pieces[p][1]) != EXIT_SUCCESS
+             || ReadSlices< FloatImageType >(fileName, readAhead != 0, pieces[p][0], pieces[p][1]) != EXIT_SUCCESS )
+          {
+          status = EXIT_FAILURE;
+          }
+        }
+
+      double shortTime;
+      double floatTime;
+      if ( StreamImage< ShortImageType >(fileName, readAhead != 0, shortTime) != EXIT_SUCCESS
+           || StreamImage< FloatImageType >(fileName, readAhead != 0, floatTime) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      std::cout << ( readAhead ? "With" : "Without" ) << " read-ahead: " << shortTime
+                << " s, " << floatTime << " s with a conversion to float" << std::endl;
+      }
+
+    // a streamed write pulls the pieces through the reader
+    typedef itk::ImageFileReader< ShortImageType > ReaderType;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(fileName);
+    reader->UseReadAheadOn();
+    const std::string copyFileName = std::string(av[1]) + "/itkImageFileReaderReadAheadTestCopy.mha";
+    writer->SetInput( reader->GetOutput() );
+    writer->SetFileName(copyFileName);
+    writer->SetNumberOfStreamDivisions(6);
+    writer->Update();
+
+    ReaderType::Pointer copyReader = ReaderType::New();
+    copyReader->SetFileName(copyFileName);
+    copyReader->Update();
+    if ( CheckRegion( copyReader->GetOutput(), copyReader->GetOutput()->GetLargestPossibleRegion(),
+                      copyFileName.c_str() ) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return status;
+}
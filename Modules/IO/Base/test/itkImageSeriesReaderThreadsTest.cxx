@@ -0,0 +1,202 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageSeriesReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMetaDataObject.h"
+#include <sstream>
+
+// Read a series of slices with one and several threads, and check the
+// pixels of the requested region and the order of the meta data
+// dictionaries.
+
+typedef itk::Image< short, 2 >              SliceType;
+typedef itk::Image< short, 3 >              VolumeType;
+typedef itk::ImageSeriesReader< VolumeType > SeriesReaderType;
+
+static short ExpectedPixel(const VolumeType::IndexType & index, unsigned int numberOfSlices, bool reverseOrder)
+{
+  const long slice = reverseOrder ? numberOfSlices - 1 - index[2] : index[2];
+  return static_cast< short >( 1000 * slice + index[0] + 20 * index[1] );
+}
+
+static int CheckSeries(const SeriesReaderType::FileNamesContainer & fileNames,
+                       unsigned int numberOfThreads, bool reverseOrder, bool streaming)
+{
+  const unsigned int numberOfSlices = static_cast< unsigned int >( fileNames.size() );
+
+  SeriesReaderType::Pointer reader = SeriesReaderType::New();
+  reader->SetFileNames(fileNames);
+  reader->SetNumberOfThreads(numberOfThreads);
+  reader->SetReverseOrder(reverseOrder);
+
+  VolumeType::RegionType region;
+  if ( streaming )
+    {
+    reader->UpdateOutputInformation();
+    region = reader->GetOutput()->GetLargestPossibleRegion();
+    region.SetIndex(2, 5);
+    region.SetSize(2, 7);
+    reader->GetOutput()->SetRequestedRegion(region);
+    reader->GetOutput()->Update();
+    }
+  else
+    {
+    reader->Update();
+    region = reader->GetOutput()->GetLargestPossibleRegion();
+    }
+
+  if ( reader->GetOutput()->GetBufferedRegion() != region )
+    {
+    std::cerr << "The buffered region is " << reader->GetOutput()->GetBufferedRegion()
+              << " instead of " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionIteratorWithIndex< VolumeType > it( reader->GetOutput(), region );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != ExpectedPixel(it.GetIndex(), numberOfSlices, reverseOrder) )
+      {
+      std::cerr << "Pixel " << it.GetIndex() << " is " << it.Get() << " instead of "
+                << ExpectedPixel(it.GetIndex(), numberOfSlices, reverseOrder)
+                << " with " << numberOfThreads << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the dictionaries of all the slices, in the order of the slices
+  const SeriesReaderType::DictionaryArrayType *dictionaries =
+    reader->GetMetaDataDictionaryArray();
+  if ( dictionaries->size() != numberOfSlices )
+    {
+    std::cerr << dictionaries->size() << " dictionaries instead of "
+              << numberOfSlices << std::endl;
+    return EXIT_FAILURE;
+    }
+  for ( unsigned int i = 0; i < numberOfSlices; i++ )
+    {
+    std::string sliceNumber;
+    itk::ExposeMetaData< std::string >( *( *dictionaries )[i], "SliceNumber", sliceNumber );
+    std::ostringstream expected;
+    expected << ( reverseOrder ? numberOfSlices - 1 - i : i );
+    if ( sliceNumber != expected.str() )
+      {
+      std::cerr << "Dictionary " << i << " is the one of slice " << sliceNumber
+                << " with " << numberOfThreads << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+int itkImageSeriesReaderThreadsTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkIOTests itkImageSeriesReaderThreadsTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int numberOfSlices = 24;
+
+  SliceType::SizeType size;
+  size[0] = 17;
+  size[1] = 13;
+
+  typedef itk::ImageFileWriter< SliceType > WriterType;
+  SeriesReaderType::FileNamesContainer fileNames;
+  for ( unsigned int i = 0; i < numberOfSlices; i++ )
+    {
+    SliceType::Pointer slice = SliceType::New();
+    slice->SetRegions(size);
+    slice->Allocate();
+    itk::ImageRegionIteratorWithIndex< SliceType > it( slice, slice->GetBufferedRegion() );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      it.Set( static_cast< short >( 1000 * i + it.GetIndex()[0] + 20 * it.GetIndex()[1] ) );
+      }
+
+    std::ostringstream sliceNumber;
+    sliceNumber << i;
+    itk::EncapsulateMetaData< std::string >( slice->GetMetaDataDictionary(), "SliceNumber",
+                                             sliceNumber.str() );
+
+    std::ostringstream fileName;
+    fileName << av[1] << "/itkImageSeriesReaderThreadsTest" << i << ".mha";
+    fileNames.push_back( fileName.str() );
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput(slice);
+    writer->SetFileName( fileName.str() );
+    writer->Update();
+    }
+
+  int status = EXIT_SUCCESS;
+  try
+    {
+    const unsigned int threads[3] = { 1, 3, 8 };
+    for ( unsigned int t = 0; t < 3; t++ )
+      {
+      for ( unsigned int mode = 0; mode < 4; mode++ )
+        {
+        if ( CheckSeries(fileNames, threads[t], ( mode & 1 ) != 0, ( mode & 2 ) != 0) != EXIT_SUCCESS )
+          {
+          status = EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // a slice of another size is reported by the thread reading it
+  SliceType::Pointer slice = SliceType::New();
+  size[0] = 25;
+  slice->SetRegions(size);
+  slice->Allocate();
+  slice->FillBuffer(0);
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(slice);
+  writer->SetFileName( fileNames[numberOfSlices - 3] );
+  writer->Update();
+
+  SeriesReaderType::Pointer reader = SeriesReaderType::New();
+  reader->SetFileNames(fileNames);
+  reader->SetNumberOfThreads(4);
+  try
+    {
+    reader->Update();
+    std::cerr << "The size mismatch is not reported" << std::endl;
+    status = EXIT_FAILURE;
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cout << "Caught expected exception: " << ex.GetDescription() << std::endl;
+    }
+
+  return status;
+}
@@ -255,7 +255,7 @@ void BioRadImageIO::Read(void *buffer)
     {
     ByteSwapper< unsigned short >::SwapRangeFromSystemToLittleEndian(
       reinterpret_cast< unsigned short * >( buffer ),
-      static_cast< SizeValueType >( this->GetImageSizeInComponents() ) );
+      static_cast< SizeValueType >( this->GetImageSizeInComponents() ), this->GetNumberOfThreads() );
     }
 
   //closing file:
@@ -573,7 +573,7 @@ void BioRadImageIO::Write(const void *buffer)
   if ( this->GetComponentType() == USHORT )
     {
     ByteSwapper< unsigned short >::SwapRangeFromSystemToBigEndian(
-      reinterpret_cast< unsigned short * >( tempmemory ), numberOfComponents);
+      reinterpret_cast< unsigned short * >( tempmemory ), numberOfComponents, this->GetNumberOfThreads());
     }
 
   // Write the actual pixel data
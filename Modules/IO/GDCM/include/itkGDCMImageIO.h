@@ -109,6 +109,10 @@ public:
   /** Reads the data from disk into the memory buffer provided. */
   virtual void Read(void *buffer);
 
+  /** Create a GDCMImageIO with the same settings, to read several DICOM
+   * files of a series at the same time. */
+  virtual ImageIOBase::Pointer CreateAnotherForReading() const;
+
   /** Get the original component type of the image. This differs from
    * ComponentType which may change as a function of rescale slope and
    * intercept. */
@@ -21,6 +21,7 @@
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkMacro.h"
+#include "itkMultiThreader.h"
 #include <vector>
 #include "gdcmSerieHelper.h"
 
@@ -44,6 +45,13 @@ namespace itk
  *    dicom objects, you may want to try calling ->SetUseSeriesDetails(true)
  *    prior to calling SetDirectory().
  *
+ * The headers of the files of the directory are parsed by NumberOfThreads
+ * threads, and the files are then grouped in the order of the directory
+ * listing. The pixel data is not kept. The parsed headers can be cached
+ * in a file set with SetHeaderCacheFileName(), so that scanning the
+ * directory again only parses the files modified since. The number of
+ * threads and the cache must be set prior to calling SetDirectory().
+ *
  * \ingroup IOFilters
  *
  * \ingroup ITK-IO-GDCM
@@ -169,6 +177,20 @@ public:
   itkSetMacro(LoadPrivateTags, bool);
   itkGetConstMacro(LoadPrivateTags, bool);
   itkBooleanMacro(LoadPrivateTags);
+
+  /** Set/Get the number of threads parsing the headers of the files of
+   * the input directory. Defaults to the global default number of
+   * threads of the MultiThreader. */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, int);
+
+  /** Set/Get the name of a file caching the parsed headers of the files
+   * of the input directory, keyed by the path, the modification time and
+   * the length of each file. The headers found in the cache are not
+   * parsed again, and the cache is rewritten when the directory has
+   * changed. Empty by default, for no cache. */
+  itkSetStringMacro(HeaderCacheFileName);
+  itkGetStringMacro(HeaderCacheFileName);
 protected:
   GDCMSeriesFileNames();
   ~GDCMSeriesFileNames();
@@ -178,6 +200,10 @@ private:
   GDCMSeriesFileNames(const Self &); //purposely not implemented
   void operator=(const Self &);      //purposely not implemented
 
+  /** Parse the headers of the files of the input directory and add the
+   * DICOM images to their series. */
+  void ScanDirectory();
+
   /** Contains the input directory where the DICOM serie is found */
   std::string m_InputDirectory;
 
@@ -198,6 +224,9 @@ private:
   bool m_Recursive;
   bool m_LoadSequences;
   bool m_LoadPrivateTags;
+
+  int         m_NumberOfThreads;
+  std::string m_HeaderCacheFileName;
 };
 } //namespace ITK
 
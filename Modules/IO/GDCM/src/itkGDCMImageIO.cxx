@@ -270,6 +270,17 @@ void GDCMImageIO::Read(void *pointer)
 #endif
 }
 
+ImageIOBase::Pointer GDCMImageIO::CreateAnotherForReading() const
+{
+  Pointer imageIO = Self::New();
+
+  imageIO->m_UIDPrefix = m_UIDPrefix;
+  imageIO->m_KeepOriginalUID = m_KeepOriginalUID;
+  imageIO->m_CompressionType = m_CompressionType;
+  imageIO->SetUseStreamedReading( this->GetUseStreamedReading() );
+  return imageIO.GetPointer();
+}
+
 // TODO: this function was not part of gdcm::Tag API as of gdcm 2.0.10:
 static std::string PrintAsPipeSeparatedString(const gdcm::Tag & tag)
 {
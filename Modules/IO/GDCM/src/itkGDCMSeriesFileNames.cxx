@@ -19,30 +19,230 @@
 #define _itkGDCMSeriesFileNames_h
 
 #include "itkGDCMSeriesFileNames.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkIntTypes.h"
 #include "itksys/SystemTools.hxx"
 
 #include "gdcmSerieHelper.h"
 #include "gdcmFile.h"
+#include "gdcmDirectory.h"
+#include "gdcmImageReader.h"
+#include "gdcmWriter.h"
 
 #include <vector>
 #include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
 
 namespace itk
 {
+namespace
+{
+/** gdcm::SerieHelper parses the files one at a time while it adds them
+ * to their series. This gives access to AddFile(), to add the files
+ * whose header has been parsed beforehand. */
+class GDCMSerieHelper:public gdcm::SerieHelper
+{
+public:
+  bool AddParsedFile(gdcm::FileWithName & file)
+  {
+    return this->AddFile(file);
+  }
+};
+
+/** A file of the input directory, with its parsed header if it is a
+ * DICOM image, and its header serialized for the cache. */
+struct HeaderEntry {
+  std::string FileName;
+  long ModifiedTime;
+  unsigned long Length;
+  bool Cached;
+  bool IsImage;
+  std::string Header;
+  gdcm::SmartPointer< gdcm::FileWithName > File;
+};
+
+typedef std::vector< HeaderEntry > HeaderEntryContainer;
+
+struct ParseHeadersThreadStruct {
+  HeaderEntryContainer *Entries;
+  bool SerializeHeaders;
+  SimpleFastMutexLock Lock;
+  SizeValueType NextEntry;
+};
+
+const char *HeaderCacheSignature = "GDCMSeriesFileNames header cache 1";
+
+/** Parse the header of a file, from the cache if it is there. As with
+ * gdcm::SerieHelper, only the files which gdcm::ImageReader reads are
+ * accepted. The pixel data is emptied, it is not needed to group and
+ * sort the files, but the element is left for gdcm::MediaStorage to
+ * recognize images without a SOP class. */
+void ParseHeader(HeaderEntry & entry, bool serializeHeader)
+{
+  if ( entry.Cached )
+    {
+    if ( !entry.IsImage )
+      {
+      return;
+      }
+    std::istringstream is(entry.Header);
+    gdcm::Reader       reader;
+    reader.SetStream(is);
+    if ( reader.Read() )
+      {
+      entry.File = new gdcm::FileWithName( reader.GetFile() );
+      entry.File->filename = entry.FileName;
+      return;
+      }
+    // parse the file itself
+    entry.Cached = false;
+    }
+
+  entry.IsImage = false;
+  entry.Header.clear();
+
+  gdcm::ImageReader reader;
+  reader.SetFileName( entry.FileName.c_str() );
+  if ( !reader.Read() )
+    {
+    return;
+    }
+  entry.IsImage = true;
+
+  gdcm::File &       file = reader.GetFile();
+  gdcm::DataElement pixelData( gdcm::Tag(0x7fe0, 0x0010) );
+  pixelData.SetVR(gdcm::VR::OW);
+  file.GetDataSet().Replace(pixelData);
+
+  entry.File = new gdcm::FileWithName(file);
+  entry.File->filename = entry.FileName;
+
+  if ( serializeHeader )
+    {
+    std::ostringstream os;
+    gdcm::Writer       writer;
+    writer.SetStream(os);
+    writer.SetFile(file);
+    writer.CheckFileMetaInformationOff();
+    if ( writer.Write() )
+      {
+      entry.Header = os.str();
+      }
+    }
+}
+
+ITK_THREAD_RETURN_TYPE ParseHeadersThreaderCallback(void *arg)
+{
+  ParseHeadersThreadStruct *str = (ParseHeadersThreadStruct *)
+                                  ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const SizeValueType numberOfEntries = str->Entries->size();
+  for (;; )
+    {
+    str->Lock.Lock();
+    const SizeValueType next = str->NextEntry++;
+    str->Lock.Unlock();
+
+    if ( next >= numberOfEntries )
+      {
+      break;
+      }
+    ParseHeader( ( *str->Entries )[next], str->SerializeHeaders );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Take the headers of the files which have not changed from the cache,
+ * and return the number of entries of the cache. */
+SizeValueType ReadHeaderCache(const std::string & cacheFileName, HeaderEntryContainer & entries)
+{
+  std::ifstream file(cacheFileName.c_str(), std::ios::in | std::ios::binary);
+  std::string   line;
+  if ( !file || !std::getline(file, line) || line != HeaderCacheSignature )
+    {
+    return 0;
+    }
+
+  std::map< std::string, HeaderEntry * > entryMap;
+  for ( HeaderEntryContainer::iterator it = entries.begin(); it != entries.end(); ++it )
+    {
+    entryMap[it->FileName] = &( *it );
+    }
+
+  SizeValueType numberOfCachedEntries = 0;
+  std::string   fileName;
+  while ( std::getline(file, fileName) )
+    {
+    long          modifiedTime;
+    unsigned long length;
+    bool          isImage;
+    SizeValueType headerLength;
+    if ( !( file >> modifiedTime >> length >> isImage >> headerLength ) || file.get() != '\n' )
+      {
+      break;
+      }
+    std::string header(headerLength, '\0');
+    if ( headerLength > 0 && !file.read(&header[0], headerLength) )
+      {
+      break;
+      }
+    ++numberOfCachedEntries;
+
+    std::map< std::string, HeaderEntry * >::iterator found = entryMap.find(fileName);
+    if ( found != entryMap.end()
+         && found->second->ModifiedTime == modifiedTime
+         && found->second->Length == length )
+      {
+      found->second->Cached = true;
+      found->second->IsImage = isImage;
+      found->second->Header.swap(header);
+      }
+    }
+  return numberOfCachedEntries;
+}
+
+bool WriteHeaderCache(const std::string & cacheFileName, const HeaderEntryContainer & entries)
+{
+  std::ofstream file(cacheFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if ( !file )
+    {
+    return false;
+    }
+  file << HeaderCacheSignature << '\n';
+  for ( HeaderEntryContainer::const_iterator it = entries.begin(); it != entries.end(); ++it )
+    {
+    // an image whose header could not be serialized is parsed every time
+    if ( it->IsImage && it->Header.empty() )
+      {
+      continue;
+      }
+    file << it->FileName << '\n' << it->ModifiedTime << ' ' << it->Length << ' '
+         << it->IsImage << ' ' << it->Header.size() << '\n';
+    file.write( it->Header.data(), it->Header.size() );
+    }
+  return !file.fail();
+}
+}
+
 GDCMSeriesFileNames::GDCMSeriesFileNames()
 {
-  m_SerieHelper = new gdcm::SerieHelper();
+  m_SerieHelper = new GDCMSerieHelper();
   m_InputDirectory = "";
   m_OutputDirectory = "";
   m_UseSeriesDetails = true;
   m_Recursive = false;
   m_LoadSequences = false;
   m_LoadPrivateTags = false;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_HeaderCacheFileName = "";
 }
 
 GDCMSeriesFileNames::~GDCMSeriesFileNames()
 {
-  delete m_SerieHelper;
+  delete static_cast< GDCMSerieHelper * >( m_SerieHelper );
 }
 
 void GDCMSeriesFileNames::SetInputDirectory(const char *name)
@@ -77,11 +277,80 @@ void GDCMSeriesFileNames::SetInputDirectory(std::string const & name)
   m_SerieHelper->SetUseSeriesDetails(m_UseSeriesDetails);
   m_SerieHelper->SetLoadMode( ( m_LoadSequences ? 0 : gdcm::LD_NOSEQ )
                               | ( m_LoadPrivateTags ? 0 : gdcm::LD_NOSHADOW ) );
-  m_SerieHelper->SetDirectory(name, m_Recursive);
+  this->ScanDirectory();
   //as a side effect it also execute
   this->Modified();
 }
 
+void GDCMSeriesFileNames::ScanDirectory()
+{
+  gdcm::Directory directory;
+  directory.Load(m_InputDirectory, m_Recursive);
+
+  const gdcm::Directory::FilenamesType & fileNames = directory.GetFilenames();
+  HeaderEntryContainer entries( fileNames.size() );
+  for ( SizeValueType i = 0; i < fileNames.size(); i++ )
+    {
+    entries[i].FileName = fileNames[i];
+    entries[i].ModifiedTime = 0;
+    entries[i].Length = 0;
+    entries[i].Cached = false;
+    entries[i].IsImage = false;
+    }
+
+  const bool    useCache = !m_HeaderCacheFileName.empty();
+  SizeValueType numberOfCachedEntries = 0;
+  if ( useCache )
+    {
+    for ( HeaderEntryContainer::iterator it = entries.begin(); it != entries.end(); ++it )
+      {
+      it->ModifiedTime = itksys::SystemTools::ModifiedTime( it->FileName.c_str() );
+      it->Length = itksys::SystemTools::FileLength( it->FileName.c_str() );
+      }
+    numberOfCachedEntries = ReadHeaderCache(m_HeaderCacheFileName, entries);
+    }
+
+  ParseHeadersThreadStruct str;
+  str.Entries = &entries;
+  str.SerializeHeaders = useCache;
+  str.NextEntry = 0;
+
+  int numberOfThreads = m_NumberOfThreads;
+  if ( static_cast< SizeValueType >( numberOfThreads ) > entries.size() )
+    {
+    numberOfThreads = static_cast< int >( entries.size() );
+    }
+  if ( numberOfThreads < 1 )
+    {
+    numberOfThreads = 1;
+    }
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(ParseHeadersThreaderCallback, &str);
+  threader->SingleMethodExecute();
+
+  // add the files in the order of the directory listing, as
+  // gdcm::SerieHelper::SetDirectory() does
+  GDCMSerieHelper *serieHelper = static_cast< GDCMSerieHelper * >( m_SerieHelper );
+  bool             cacheIsUpToDate = ( numberOfCachedEntries == entries.size() );
+  for ( HeaderEntryContainer::iterator it = entries.begin(); it != entries.end(); ++it )
+    {
+    if ( it->File )
+      {
+      serieHelper->AddParsedFile(*it->File);
+      }
+    cacheIsUpToDate = cacheIsUpToDate && it->Cached;
+    }
+
+  if ( useCache && !cacheIsUpToDate )
+    {
+    if ( !WriteHeaderCache(m_HeaderCacheFileName, entries) )
+      {
+      itkWarningMacro(<< "Could not write the header cache " << m_HeaderCacheFileName);
+      }
+    }
+}
+
 const SerieUIDContainer & GDCMSeriesFileNames::GetSeriesUIDs()
 {
   m_SeriesUIDs.clear();
@@ -279,6 +548,8 @@ void GDCMSeriesFileNames::PrintSelf(std::ostream & os, Indent indent) const
   os << indent << "InputDirectory: " << m_InputDirectory << std::endl;
   os << indent << "LoadSequences:" << m_LoadSequences << std::endl;
   os << indent << "LoadPrivateTags:" << m_LoadPrivateTags << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "HeaderCacheFileName: " << m_HeaderCacheFileName << std::endl;
   if ( m_Recursive )
     {
     os << indent << "Recursive: True" << std::endl;
@@ -0,0 +1,319 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkGDCMImageIO.h"
+#include "itkGDCMSeriesFileNames.h"
+#include "itkImageSeriesReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMetaDataObject.h"
+#include "itkIOCommon.h"
+#include "itksys/SystemTools.hxx"
+#include <fstream>
+#include <sstream>
+#include <map>
+
+// Write two DICOM series, one of them compressed, whose file names are
+// not in the order of the slices, and check that GDCMSeriesFileNames
+// finds the same sorted series with one and several threads, with and
+// without its header cache, and after files are added and removed. The
+// series are then read by ImageSeriesReader with a GDCMImageIO, with one
+// and several threads.
+
+typedef itk::Image< short, 2 >               SliceType;
+typedef itk::Image< short, 3 >               VolumeType;
+typedef itk::GDCMSeriesFileNames             NamesGeneratorType;
+typedef std::vector< std::string >           FileNamesContainer;
+typedef std::map< std::string, FileNamesContainer > SeriesMapType;
+
+static const char *SeriesUIDs[2] = { "1.2.826.0.1.3680043.2.1125.1.7301",
+                                     "1.2.826.0.1.3680043.2.1125.1.7302" };
+
+static const unsigned int NumberOfFiles[2] = { 10, 6 };
+
+static short ExpectedPixel(unsigned int series, unsigned int slice, const SliceType::IndexType & index)
+{
+  return static_cast< short >( 1000 * series + 50 * slice + index[0] + 3 * index[1] );
+}
+
+// the slice at the position i of the series is written to the file
+// (i * 7) % NumberOfFiles
+static unsigned int FileOfSlice(unsigned int series, unsigned int slice)
+{
+  return ( slice * 7 ) % NumberOfFiles[series];
+}
+
+static std::string FileName(const std::string & directory, unsigned int series, unsigned int file)
+{
+  std::ostringstream fileName;
+  fileName << directory << "/" << static_cast< char >( 'a' + series ) << file << ".dcm";
+  return fileName.str();
+}
+
+static void WriteSlice(const std::string & fileName, unsigned int series, unsigned int slice)
+{
+  SliceType::SizeType size;
+  size[0] = 16;
+  size[1] = 12;
+  SliceType::Pointer image = SliceType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< SliceType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( ExpectedPixel( series, slice, it.GetIndex() ) );
+    }
+
+  // a CT image, which has an image position
+  itk::MetaDataDictionary & dictionary = image->GetMetaDataDictionary();
+  itk::EncapsulateMetaData< std::string >(dictionary, "0002|0002", "1.2.840.10008.5.1.4.1.1.2");
+  itk::EncapsulateMetaData< std::string >(dictionary, "0008|0060", "CT");
+  itk::EncapsulateMetaData< std::string >(dictionary, "0020|000d", "1.2.826.0.1.3680043.2.1125.1.7300");
+  itk::EncapsulateMetaData< std::string >(dictionary, "0020|000e", SeriesUIDs[series]);
+  std::ostringstream instanceNumber;
+  instanceNumber << slice + 1;
+  itk::EncapsulateMetaData< std::string >( dictionary, "0020|0013", instanceNumber.str() );
+
+  // the position of the slice is taken from the ITK keys
+  itk::EncapsulateMetaData< unsigned int >(dictionary, itk::ITK_NumberOfDimensions, 3);
+  itk::Array< double > origin(3);
+  origin[0] = 0.0;
+  origin[1] = 0.0;
+  origin[2] = 2.5 * slice;
+  itk::EncapsulateMetaData< itk::Array< double > >(dictionary, itk::ITK_Origin, origin);
+  itk::Array< double > spacing(3);
+  spacing.Fill(1.0);
+  spacing[2] = 2.5;
+  itk::EncapsulateMetaData< itk::Array< double > >(dictionary, itk::ITK_Spacing, spacing);
+
+  itk::GDCMImageIO::Pointer dicomIO = itk::GDCMImageIO::New();
+  dicomIO->KeepOriginalUIDOn();
+  dicomIO->SetCompressionType(itk::GDCMImageIO::JPEG);
+
+  typedef itk::ImageFileWriter< SliceType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetImageIO(dicomIO);
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+  writer->SetUseCompression(series == 1);
+  writer->Update();
+}
+
+static SeriesMapType ScanDirectory(const std::string & directory, int numberOfThreads,
+                                   const std::string & cacheFileName)
+{
+  NamesGeneratorType::Pointer names = NamesGeneratorType::New();
+  names->SetUseSeriesDetails(false);
+  names->SetNumberOfThreads(numberOfThreads);
+  names->SetHeaderCacheFileName(cacheFileName);
+  names->SetInputDirectory(directory);
+
+  SeriesMapType seriesMap;
+  const std::vector< std::string > & seriesUIDs = names->GetSeriesUIDs();
+  for ( unsigned int s = 0; s < seriesUIDs.size(); s++ )
+    {
+    seriesMap[seriesUIDs[s]] = names->GetFileNames(seriesUIDs[s]);
+    }
+  return seriesMap;
+}
+
+static int CheckSeries(const SeriesMapType & seriesMap, const std::string & directory,
+                       const unsigned int *numberOfSlices, const char *name)
+{
+  if ( seriesMap.size() != 2 )
+    {
+    std::cerr << name << ": " << seriesMap.size() << " series found instead of 2" << std::endl;
+    return EXIT_FAILURE;
+    }
+  for ( unsigned int series = 0; series < 2; series++ )
+    {
+    SeriesMapType::const_iterator found = seriesMap.find(SeriesUIDs[series]);
+    if ( found == seriesMap.end() )
+      {
+      std::cerr << name << ": the series " << SeriesUIDs[series] << " is not found" << std::endl;
+      return EXIT_FAILURE;
+      }
+    const FileNamesContainer & fileNames = found->second;
+    if ( fileNames.size() != numberOfSlices[series] )
+      {
+      std::cerr << name << ": " << fileNames.size() << " files in the series " << series
+                << " instead of " << numberOfSlices[series] << std::endl;
+      return EXIT_FAILURE;
+      }
+    for ( unsigned int slice = 0; slice < fileNames.size(); slice++ )
+      {
+      const std::string expected = FileName( directory, series, FileOfSlice(series, slice) );
+      if ( fileNames[slice] != expected )
+        {
+        std::cerr << name << ": the slice " << slice << " of the series " << series << " is "
+                  << fileNames[slice] << " instead of " << expected << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+static int ReadSeries(const FileNamesContainer & fileNames, unsigned int series, int numberOfThreads)
+{
+  typedef itk::ImageSeriesReader< VolumeType > ReaderType;
+  itk::GDCMImageIO::Pointer dicomIO = itk::GDCMImageIO::New();
+  ReaderType::Pointer       reader = ReaderType::New();
+  reader->SetImageIO(dicomIO);
+  reader->SetFileNames(fileNames);
+  reader->SetNumberOfThreads(numberOfThreads);
+  reader->Update();
+
+  itk::ImageRegionIteratorWithIndex< VolumeType > it( reader->GetOutput(),
+                                                      reader->GetOutput()->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    SliceType::IndexType index;
+    index[0] = it.GetIndex()[0];
+    index[1] = it.GetIndex()[1];
+    const short expected = ExpectedPixel(series, it.GetIndex()[2], index);
+    if ( it.Get() != expected )
+      {
+      std::cerr << "Pixel " << it.GetIndex() << " of the series " << series << " is " << it.Get()
+                << " instead of " << expected << " with " << numberOfThreads << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the ImageIO holds the information of the last slice
+  std::string instanceNumber;
+  dicomIO->GetValueFromTag("0020|0013", instanceNumber);
+  if ( atoi( instanceNumber.c_str() ) != static_cast< int >( fileNames.size() ) )
+    {
+    std::cerr << "The ImageIO holds the instance number " << instanceNumber << " instead of "
+              << fileNames.size() << " with " << numberOfThreads << " threads" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( reader->GetMetaDataDictionaryArray()->size() != fileNames.size() )
+    {
+    std::cerr << reader->GetMetaDataDictionaryArray()->size() << " dictionaries instead of "
+              << fileNames.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+int itkGDCMSeriesFileNamesThreadsTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkGDCMSeriesFileNamesThreadsTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::string directory = std::string(av[1]) + "/itkGDCMSeriesFileNamesThreadsTest";
+  const std::string cacheFileName = std::string(av[1]) + "/itkGDCMSeriesFileNamesThreadsTest.cache";
+  itksys::SystemTools::RemoveADirectory( directory.c_str() );
+  itksys::SystemTools::MakeDirectory( directory.c_str() );
+  itksys::SystemTools::RemoveFile( cacheFileName.c_str() );
+
+  unsigned int numberOfSlices[2] = { NumberOfFiles[0], NumberOfFiles[1] };
+  int          status = EXIT_SUCCESS;
+  try
+    {
+    for ( unsigned int series = 0; series < 2; series++ )
+      {
+      for ( unsigned int slice = 0; slice < numberOfSlices[series]; slice++ )
+        {
+        WriteSlice(FileName( directory, series, FileOfSlice(series, slice) ), series, slice);
+        }
+      }
+    // a file which is not DICOM
+    std::ofstream notes( ( directory + "/notes.txt" ).c_str() );
+    notes << "not a DICOM file" << std::endl;
+    notes.close();
+
+    if ( CheckSeries(ScanDirectory(directory, 1, ""), directory, numberOfSlices, "1 thread")
+         != EXIT_SUCCESS
+         || CheckSeries(ScanDirectory(directory, 4, ""), directory, numberOfSlices, "4 threads")
+         != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    // the cache is written by the first scan and read by the second one
+    for ( unsigned int scan = 0; scan < 2; scan++ )
+      {
+      if ( CheckSeries(ScanDirectory(directory, 3, cacheFileName), directory, numberOfSlices,
+                       scan ? "from the cache" : "writing the cache") != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      if ( !itksys::SystemTools::FileExists( cacheFileName.c_str() ) )
+        {
+        std::cerr << "The header cache is not written" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    // the last slice of the second series is removed and a file added
+    itksys::SystemTools::RemoveFile(
+      FileName( directory, 1, FileOfSlice(1, numberOfSlices[1] - 1) ).c_str() );
+    numberOfSlices[1]--;
+    std::ofstream moreNotes( ( directory + "/more_notes.txt" ).c_str() );
+    moreNotes << "not a DICOM file either" << std::endl;
+    moreNotes.close();
+    if ( CheckSeries(ScanDirectory(directory, 3, cacheFileName), directory, numberOfSlices,
+                     "after a change of the directory") != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    // an invalid cache is ignored and rewritten
+    std::ofstream cache( cacheFileName.c_str() );
+    cache << "not a header cache" << std::endl;
+    cache.close();
+    if ( CheckSeries(ScanDirectory(directory, 3, cacheFileName), directory, numberOfSlices,
+                     "with an invalid cache") != EXIT_SUCCESS
+         || CheckSeries(ScanDirectory(directory, 3, cacheFileName), directory, numberOfSlices,
+                        "from the rewritten cache") != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    if ( status != EXIT_SUCCESS )
+      {
+      return status;
+      }
+
+    const SeriesMapType seriesMap = ScanDirectory(directory, 2, cacheFileName);
+    for ( unsigned int series = 0; series < 2; series++ )
+      {
+      const FileNamesContainer & fileNames = seriesMap.find(SeriesUIDs[series])->second;
+      if ( ReadSeries(fileNames, series, 1) != EXIT_SUCCESS
+           || ReadSeries(fileNames, series, 4) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return status;
+}
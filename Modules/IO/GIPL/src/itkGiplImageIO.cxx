@@ -625,12 +625,12 @@ GiplImageIO
       if ( m_ByteOrder == LittleEndian )
         {
         ByteSwapper< char >::SwapRangeFromSystemToLittleEndian(
-          (char *)buffer, numberOfPixels);
+          (char *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       else if ( m_ByteOrder == BigEndian )
         {
         ByteSwapper< char >::SwapRangeFromSystemToBigEndian(
-          (char *)buffer, numberOfPixels);
+          (char *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       break;
       }
@@ -639,12 +639,12 @@ GiplImageIO
       if ( m_ByteOrder == LittleEndian )
         {
         ByteSwapper< unsigned char >::SwapRangeFromSystemToLittleEndian(
-          (unsigned char *)buffer, numberOfPixels);
+          (unsigned char *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       else if ( m_ByteOrder == BigEndian )
         {
         ByteSwapper< unsigned char >::SwapRangeFromSystemToBigEndian(
-          (unsigned char *)buffer, numberOfPixels);
+          (unsigned char *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       break;
       }
@@ -653,12 +653,12 @@ GiplImageIO
       if ( m_ByteOrder == LittleEndian )
         {
         ByteSwapper< short >::SwapRangeFromSystemToLittleEndian(
-          (short *)buffer, numberOfPixels);
+          (short *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       else if ( m_ByteOrder == BigEndian )
         {
         ByteSwapper< short >::SwapRangeFromSystemToBigEndian(
-          (short *)buffer, numberOfPixels);
+          (short *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       break;
       }
@@ -667,12 +667,12 @@ GiplImageIO
       if ( m_ByteOrder == LittleEndian )
         {
         ByteSwapper< unsigned short >::SwapRangeFromSystemToLittleEndian(
-          (unsigned short *)buffer, numberOfPixels);
+          (unsigned short *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       else if ( m_ByteOrder == BigEndian )
         {
         ByteSwapper< unsigned short >::SwapRangeFromSystemToBigEndian(
-          (unsigned short *)buffer, numberOfPixels);
+          (unsigned short *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       break;
       }
@@ -681,12 +681,12 @@ GiplImageIO
       if ( m_ByteOrder == LittleEndian )
         {
         ByteSwapper< float >::SwapRangeFromSystemToLittleEndian(
-          (float *)buffer, numberOfPixels);
+          (float *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       else if ( m_ByteOrder == BigEndian )
         {
         ByteSwapper< float >::SwapRangeFromSystemToBigEndian(
-          (float *)buffer, numberOfPixels);
+          (float *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       break;
       }
@@ -695,12 +695,12 @@ GiplImageIO
       if ( m_ByteOrder == LittleEndian )
         {
         ByteSwapper< double >::SwapRangeFromSystemToLittleEndian(
-          (double *)buffer, numberOfPixels);
+          (double *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       else if ( m_ByteOrder == BigEndian )
         {
         ByteSwapper< double >::SwapRangeFromSystemToBigEndian(
-          (double *)buffer, numberOfPixels);
+          (double *)buffer, numberOfPixels, this->GetNumberOfThreads());
         }
       break;
       }
@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkHDF5ImageIO_h
+#define __itkHDF5ImageIO_h
+
+#ifdef _MSC_VER
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageIOBase.h"
+#include <vector>
+
+namespace itk
+{
+/** \class HDF5ImageIO
+ *
+ * \brief Read and write images in the HDF5 file format.
+ *
+ * The image is stored in the group /ITKImage/0 of the file: the
+ * origin, spacing, size, direction cosines and pixel type are stored
+ * in small datasets next to the VoxelData dataset which holds the
+ * pixels, and the entries of the meta data dictionary whose type is a
+ * string or a scalar number are stored in the MetaData sub-group.
+ *
+ * The pixels are stored in a chunked dataset, in the order of the
+ * image (the fastest axis of the image is the last axis of the
+ * dataset). The chunks are made of whole hyperslices along the
+ * outermost axis of the image and hold at most
+ * MaximumChunkSizeInBytes bytes. When UseCompression is on, each chunk
+ * is compressed with deflate at CompressionLevel.
+ *
+ * Reading and writing select the hyperslab of the IO region in the
+ * dataset, so both streaming and pasting are supported, with or
+ * without compression. The pieces written by ImageFileWriter when
+ * streaming the whole image are aligned on the chunks, so each chunk
+ * is compressed only once.
+ *
+ * When NumberOfResolutionLevels is more than 1, the writer also stores
+ * a pyramid of the image in the ResolutionLevels group of the image,
+ * each level averaging blocks of 2 pixels along the axes of the
+ * previous one which can be halved. The levels are updated with each
+ * piece written, so a streamed or pasted write keeps them consistent.
+ * ReadImageInformation reports the number of levels in the file, and
+ * the level given by ResolutionLevel is read: set it on the ImageIO
+ * given to ImageFileReader::SetImageIO to read a coarse level.
+ *
+ * The HDF5 library is not thread safe: all the HDF5ImageIO objects share
+ * a lock held during each call to the library, so files read or written
+ * on several threads, e.g. by ImageSeriesReader, are accessed one at a
+ * time.
+ *
+ * \ingroup IOFilters
+ * \ingroup ITK-IO-HDF5
+ */
+class ITK_EXPORT HDF5ImageIO:public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef HDF5ImageIO          Self;
+  typedef ImageIOBase          Superclass;
+  typedef SmartPointer< Self > Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(HDF5ImageIO, Superclass);
+
+  /** HDF5 supports images of any dimension. */
+  virtual bool SupportsDimension(unsigned long)
+  {
+    return true;
+  }
+
+  /** Set/Get the deflate level used when UseCompression is on, from 0
+   * (no compression) to 9 (best compression). Defaults to 5. */
+  itkSetClampMacro(CompressionLevel, int, 0, 9);
+  itkGetConstMacro(CompressionLevel, int);
+
+  /** Set/Get the largest size of a chunk of the VoxelData dataset
+   * written by this ImageIO. Defaults to 1 MiB. */
+  itkSetMacro(MaximumChunkSizeInBytes, SizeValueType);
+  itkGetConstMacro(MaximumChunkSizeInBytes, SizeValueType);
+
+  /** Set/Get the number of resolution levels written, the image
+   * included. Defaults to 1: no pyramid is written. After
+   * ReadImageInformation, the number of resolution levels in the
+   * file. */
+  itkSetClampMacro( NumberOfResolutionLevels, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro(NumberOfResolutionLevels, unsigned int);
+
+  /** Set/Get the resolution level read, 0 being the image itself.
+   * Defaults to 0. */
+  itkSetMacro(ResolutionLevel, unsigned int);
+  itkGetConstMacro(ResolutionLevel, unsigned int);
+
+  /*-------- This part of the interfaces deals with reading data. ----- */
+
+  /** Determine the file type. Returns true if this ImageIO can read the
+   * file specified. */
+  virtual bool CanReadFile(const char *);
+
+  /** Set the spacing and dimension information for the set filename. */
+  virtual void ReadImageInformation();
+
+  /** Reads the IO region of the image into the memory buffer provided. */
+  virtual void Read(void *buffer);
+
+  /*-------- This part of the interfaces deals with writing data. ----- */
+
+  /** Determine the file type. Returns true if this ImageIO can write the
+   * file specified. */
+  virtual bool CanWriteFile(const char *);
+
+  /** The image information is written with the first piece of the
+   * image. */
+  virtual void WriteImageInformation() {}
+
+  /** Writes the IO region of the image from the memory buffer provided.
+   * The file is created when the whole image is written or when it does
+   * not exist yet, otherwise the IO region is written in the existing
+   * file. */
+  virtual void Write(const void *buffer);
+
+  /** Any region of the image can be read or written, even compressed. */
+  virtual bool CanStreamRead()
+  {
+    return true;
+  }
+
+  virtual bool CanStreamWrite()
+  {
+    return true;
+  }
+
+  /** Method for supporting streaming.  Given a requested region, calculate what
+   * could be the region that we can read from the file. This is called the
+   * streamable region, which will be smaller than the LargestPossibleRegion and
+   * greater or equal to the RequestedRegion */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
+
+  /** The pieces are split along the outermost axis of the paste region
+   * whose size is not 1, on the boundaries of the chunks. */
+  virtual unsigned int
+  GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                    const ImageIORegion & pasteRegion,
+                                    const ImageIORegion & largestPossibleRegion);
+
+  virtual ImageIORegion
+  GetSplitRegionForWriting(unsigned int ithPiece,
+                           unsigned int numberOfActualSplits,
+                           const ImageIORegion & pasteRegion,
+                           const ImageIORegion & largestPossibleRegion);
+
+protected:
+  HDF5ImageIO();
+  ~HDF5ImageIO();
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+private:
+  HDF5ImageIO(const Self &);    //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  /** Size of the chunks of a VoxelData dataset of the given size, in
+   * the order of the image, for the current pixel type. */
+  std::vector< SizeValueType > ComputeChunkSize(const std::vector< SizeValueType > & size) const;
+
+  /** Number of resolution levels written for the current dimensions. */
+  unsigned int ComputeNumberOfResolutionLevels() const;
+
+  /** Axis along which the paste region is split and the number of
+   * indices in each piece. Returns false when the region can not be
+   * split. */
+  bool ComputeSplit(unsigned int numberOfRequestedSplits,
+                    const ImageIORegion & pasteRegion,
+                    unsigned int & splitAxis,
+                    SizeValueType & valuesPerPiece) const;
+
+  /** Create the file and write the header and the empty VoxelData
+   * datasets of the image and its resolution levels. Called by Write()
+   * with the lock of the HDF5 library held. */
+  void WriteImageHeader();
+
+  int           m_CompressionLevel;
+  SizeValueType m_MaximumChunkSizeInBytes;
+  unsigned int  m_NumberOfResolutionLevels;
+  unsigned int  m_ResolutionLevel;
+};
+} // end namespace itk
+
+#endif // __itkHDF5ImageIO_h
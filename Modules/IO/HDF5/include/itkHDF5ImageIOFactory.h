@@ -0,0 +1,67 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkHDF5ImageIOFactory_h
+#define __itkHDF5ImageIOFactory_h
+
+#include "itkObjectFactoryBase.h"
+#include "itkImageIOBase.h"
+
+namespace itk
+{
+/** \class HDF5ImageIOFactory
+ * \brief Create instances of HDF5ImageIO objects using an object factory.
+ * \ingroup ITK-IO-HDF5
+ */
+class ITK_EXPORT HDF5ImageIOFactory:public ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef HDF5ImageIOFactory         Self;
+  typedef ObjectFactoryBase          Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Class methods used to interface with the registered factories. */
+  virtual const char * GetITKSourceVersion(void) const;
+
+  virtual const char * GetDescription(void) const;
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(HDF5ImageIOFactory, ObjectFactoryBase);
+
+  /** Register one factory of this type  */
+  static void RegisterOneFactory(void)
+  {
+    HDF5ImageIOFactory::Pointer hdf5Factory = HDF5ImageIOFactory::New();
+
+    ObjectFactoryBase::RegisterFactoryInternal(hdf5Factory);
+  }
+
+protected:
+  HDF5ImageIOFactory();
+  ~HDF5ImageIOFactory();
+private:
+  HDF5ImageIOFactory(const Self &); //purposely not implemented
+  void operator=(const Self &);     //purposely not implemented
+};
+} // end namespace itk
+
+#endif
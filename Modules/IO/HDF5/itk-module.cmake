@@ -0,0 +1 @@
+itk_module(ITK-IO-HDF5 DEPENDS ITK-HDF5 ITK-IO-Base TEST_DEPENDS ITK-TestKernel)
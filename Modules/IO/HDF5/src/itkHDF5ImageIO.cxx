@@ -0,0 +1,1189 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifdef _MSC_VER
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkHDF5ImageIO.h"
+#include "itkMetaDataObject.h"
+#include "itkByteSwapper.h"
+#include "itkVersion.h"
+#include "itkMutexLockHolder.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itksys/SystemTools.hxx"
+#include "itk_hdf5.h"
+#include <algorithm>
+#include <sstream>
+
+namespace itk
+{
+namespace
+{
+// names of the groups and datasets of the file
+const char *const ITKVersionName = "/ITKVersion";
+const char *const ImageGroupName = "/ITKImage";
+const char *const ImageName = "/ITKImage/0";
+const char *const OriginName = "Origin";
+const char *const SpacingName = "Spacing";
+const char *const DimensionName = "Dimension";
+const char *const DirectionsName = "Directions";
+const char *const PixelTypeName = "PixelType";
+const char *const VoxelDataName = "VoxelData";
+const char *const MetaDataName = "MetaData";
+const char *const ResolutionLevelsName = "ResolutionLevels";
+
+/** The HDF5 library is not built thread safe, and ImageSeriesReader may
+ * read several files at once: every call to the library is made with
+ * this lock held. */
+SimpleFastMutexLock HDF5Lock;
+typedef MutexLockHolder< SimpleFastMutexLock > HDF5LockHolder;
+
+/** Name of the group holding a resolution level, level 0 being the
+ * image itself. */
+std::string ResolutionLevelName(unsigned int level)
+{
+  std::ostringstream name;
+  name << ImageName;
+  if ( level > 0 )
+    {
+    name << '/' << ResolutionLevelsName << '/' << level;
+    }
+  return name.str();
+}
+
+/** Close an HDF5 identifier when going out of scope. */
+class HDF5Handle
+{
+public:
+  typedef herr_t ( *CloseFunctionType )(hid_t);
+
+  HDF5Handle(hid_t id, CloseFunctionType close):m_Id(id), m_Close(close) {}
+  ~HDF5Handle()
+  {
+    if ( m_Id >= 0 )
+      {
+      m_Close(m_Id);
+      }
+  }
+
+  operator hid_t() const { return m_Id; }
+  bool IsValid() const { return m_Id >= 0; }
+
+private:
+  HDF5Handle(const HDF5Handle &);     //purposely not implemented
+  void operator=(const HDF5Handle &); //purposely not implemented
+
+  hid_t             m_Id;
+  CloseFunctionType m_Close;
+};
+
+hid_t ComponentTypeToHDF5(ImageIOBase::IOComponentType componentType)
+{
+  switch ( componentType )
+    {
+    case ImageIOBase::UCHAR:
+      return H5T_NATIVE_UCHAR;
+    case ImageIOBase::CHAR:
+      return H5T_NATIVE_SCHAR;
+    case ImageIOBase::USHORT:
+      return H5T_NATIVE_USHORT;
+    case ImageIOBase::SHORT:
+      return H5T_NATIVE_SHORT;
+    case ImageIOBase::UINT:
+      return H5T_NATIVE_UINT;
+    case ImageIOBase::INT:
+      return H5T_NATIVE_INT;
+    case ImageIOBase::ULONG:
+      return H5T_NATIVE_ULONG;
+    case ImageIOBase::LONG:
+      return H5T_NATIVE_LONG;
+    case ImageIOBase::FLOAT:
+      return H5T_NATIVE_FLOAT;
+    case ImageIOBase::DOUBLE:
+      return H5T_NATIVE_DOUBLE;
+    default:
+      return -1;
+    }
+}
+
+/** The component type matching a type of the file, which is converted
+ * to the closest native type. */
+ImageIOBase::IOComponentType ComponentTypeFromHDF5(hid_t type)
+{
+  HDF5Handle nativeType(H5Tget_native_type(type, H5T_DIR_ASCEND), H5Tclose);
+  if ( !nativeType.IsValid() )
+    {
+    return ImageIOBase::UNKNOWNCOMPONENTTYPE;
+    }
+
+  // int before long, where both have the same size
+  const ImageIOBase::IOComponentType componentTypes[] = {
+    ImageIOBase::UCHAR, ImageIOBase::CHAR, ImageIOBase::USHORT, ImageIOBase::SHORT,
+    ImageIOBase::UINT, ImageIOBase::INT, ImageIOBase::ULONG, ImageIOBase::LONG,
+    ImageIOBase::FLOAT, ImageIOBase::DOUBLE
+  };
+  for ( unsigned int i = 0; i < sizeof( componentTypes ) / sizeof( componentTypes[0] ); i++ )
+    {
+    if ( H5Tequal(nativeType, ComponentTypeToHDF5(componentTypes[i])) > 0 )
+      {
+      return componentTypes[i];
+      }
+    }
+  return ImageIOBase::UNKNOWNCOMPONENTTYPE;
+}
+
+bool WriteString(hid_t location, const char *name, const std::string & value)
+{
+  HDF5Handle type(H5Tcopy(H5T_C_S1), H5Tclose);
+  HDF5Handle space(H5Screate(H5S_SCALAR), H5Sclose);
+  if ( !type.IsValid() || !space.IsValid()
+       || H5Tset_size( type, std::max( value.size(), static_cast< size_t >( 1 ) ) ) < 0 )
+    {
+    return false;
+    }
+  HDF5Handle dataset(H5Dcreate2(location, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+                     H5Dclose);
+  // an empty string is written as a single null character
+  const std::string buffer = value.empty() ? std::string(1, '\0') : value;
+  return dataset.IsValid()
+         && H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.c_str()) >= 0;
+}
+
+bool ReadString(hid_t location, const char *name, std::string & value)
+{
+  HDF5Handle dataset(H5Dopen2(location, name, H5P_DEFAULT), H5Dclose);
+  if ( !dataset.IsValid() )
+    {
+    return false;
+    }
+  HDF5Handle fileType(H5Dget_type(dataset), H5Tclose);
+  if ( H5Tget_class(fileType) != H5T_STRING || H5Tis_variable_str(fileType) > 0 )
+    {
+    return false;
+    }
+  const size_t size = H5Tget_size(fileType);
+  HDF5Handle type(H5Tcopy(H5T_C_S1), H5Tclose);
+  H5Tset_size(type, size + 1);
+  std::vector< char > buffer(size + 1, '\0');
+  if ( H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &buffer[0]) < 0 )
+    {
+    return false;
+    }
+  value = &buffer[0];
+  return true;
+}
+
+/** Write an array of values, with the given dimensions. */
+template< class T >
+bool WriteArray(hid_t location, const char *name, hid_t type,
+                const std::vector< T > & values, const std::vector< hsize_t > & dimensions)
+{
+  HDF5Handle space(H5Screate_simple(static_cast< int >( dimensions.size() ), &dimensions[0], 0),
+                   H5Sclose);
+  if ( !space.IsValid() )
+    {
+    return false;
+    }
+  HDF5Handle dataset(H5Dcreate2(location, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+                     H5Dclose);
+  return dataset.IsValid()
+         && ( values.empty() || H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &values[0]) >= 0 );
+}
+
+/** Read all the values of a dataset, converted to the given type. */
+template< class T >
+bool ReadArray(hid_t location, const char *name, hid_t type, std::vector< T > & values)
+{
+  HDF5Handle dataset(H5Dopen2(location, name, H5P_DEFAULT), H5Dclose);
+  if ( !dataset.IsValid() )
+    {
+    return false;
+    }
+  HDF5Handle space(H5Dget_space(dataset), H5Sclose);
+  const hssize_t numberOfValues = H5Sget_simple_extent_npoints(space);
+  if ( numberOfValues < 0 )
+    {
+    return false;
+    }
+  values.resize(numberOfValues);
+  return values.empty() || H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &values[0]) >= 0;
+}
+
+template< class T >
+bool WriteMetaDataObject(hid_t group, const std::string & key, const MetaDataObjectBase *object, hid_t type)
+{
+  const MetaDataObject< T > *metaDataObject = dynamic_cast< const MetaDataObject< T > * >( object );
+  if ( !metaDataObject )
+    {
+    return false;
+    }
+  const std::vector< T >       values( 1, metaDataObject->GetMetaDataObjectValue() );
+  const std::vector< hsize_t > dimensions(1, 1);
+  return WriteArray(group, key.c_str(), type, values, dimensions);
+}
+
+template< class T >
+bool ReadMetaDataObject(hid_t group, const std::string & key, hid_t nativeType, hid_t type,
+                        MetaDataDictionary & dictionary)
+{
+  std::vector< T > values;
+  if ( H5Tequal(nativeType, type) <= 0
+       || !ReadArray(group, key.c_str(), type, values) || values.size() != 1 )
+    {
+    return false;
+    }
+  EncapsulateMetaData< T >(dictionary, key, values[0]);
+  return true;
+}
+
+/** Select the hyperslab of an IO region in the space of the VoxelData
+ * dataset, and return the matching memory space. The IO region may have
+ * more axes than the dataset, e.g. when ImageSeriesReader reads a slice,
+ * as long as they hold one index. */
+hid_t SelectIORegion(hid_t fileSpace, const ImageIORegion & region, unsigned int numberOfComponents)
+{
+  const int fileRank = H5Sget_simple_extent_ndims(fileSpace);
+  const int componentAxes = numberOfComponents > 1 ? 1 : 0;
+  if ( fileRank <= componentAxes
+       || fileRank - componentAxes > static_cast< int >( region.GetImageDimension() ) )
+    {
+    return -1;
+    }
+  const unsigned int dimension = static_cast< unsigned int >( fileRank - componentAxes );
+  for ( unsigned int i = dimension; i < region.GetImageDimension(); i++ )
+    {
+    if ( region.GetIndex(i) != 0 || region.GetSize(i) != 1 )
+      {
+      return -1;
+      }
+    }
+
+  const unsigned int    rank = static_cast< unsigned int >( fileRank );
+  std::vector< hsize_t > start(rank, 0);
+  std::vector< hsize_t > count(rank, numberOfComponents);
+  for ( unsigned int i = 0; i < dimension; i++ )
+    {
+    start[dimension - 1 - i] = region.GetIndex(i);
+    count[dimension - 1 - i] = region.GetSize(i);
+    }
+  if ( H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, &start[0], 0, &count[0], 0) < 0 )
+    {
+    return -1;
+    }
+  return H5Screate_simple(rank, &count[0], 0);
+}
+
+/** Read an IO region of a VoxelData dataset into a buffer of the
+ * region. */
+bool ReadIORegion(hid_t dataset, hid_t type, const ImageIORegion & region,
+                  unsigned int numberOfComponents, void *buffer)
+{
+  HDF5Handle fileSpace(H5Dget_space(dataset), H5Sclose);
+  HDF5Handle memorySpace(SelectIORegion(fileSpace, region, numberOfComponents), H5Sclose);
+  return memorySpace.IsValid()
+         && H5Dread(dataset, type, memorySpace, fileSpace, H5P_DEFAULT, buffer) >= 0;
+}
+
+/** Write an IO region of a VoxelData dataset from a buffer of the
+ * region. */
+bool WriteIORegion(hid_t dataset, hid_t type, const ImageIORegion & region,
+                   unsigned int numberOfComponents, const void *buffer)
+{
+  HDF5Handle fileSpace(H5Dget_space(dataset), H5Sclose);
+  HDF5Handle memorySpace(SelectIORegion(fileSpace, region, numberOfComponents), H5Sclose);
+  return memorySpace.IsValid()
+         && H5Dwrite(dataset, type, memorySpace, fileSpace, H5P_DEFAULT, buffer) >= 0;
+}
+
+/** Number of resolution levels stored with an image, the image
+ * included. */
+unsigned int CountResolutionLevels(hid_t image)
+{
+  unsigned int numberOfLevels = 1;
+  H5E_BEGIN_TRY
+    {
+    HDF5Handle levels(H5Gopen2(image, ResolutionLevelsName, H5P_DEFAULT), H5Gclose);
+    H5G_info_t info;
+    if ( levels.IsValid() && H5Gget_info(levels, &info) >= 0 )
+      {
+      numberOfLevels += static_cast< unsigned int >( info.nlinks );
+      }
+    }
+  H5E_END_TRY;
+  return numberOfLevels;
+}
+
+/** Size of the next resolution level: the axes whose size is at least 2
+ * are halved, rounded down. Returns false when no axis can be
+ * halved. */
+bool HalveSize(std::vector< SizeValueType > & size)
+{
+  bool halved = false;
+  for ( unsigned int i = 0; i < size.size(); i++ )
+    {
+    if ( size[i] >= 2 )
+      {
+      size[i] /= 2;
+      halved = true;
+      }
+    }
+  return halved;
+}
+
+template< class T >
+T RoundAverage(double value)
+{
+  return NumericTraits< T >::is_integer ? static_cast< T >( vcl_floor(value + 0.5) ) : static_cast< T >( value );
+}
+
+/** Average the blocks of pixels of a region of a resolution level into
+ * the matching region of the next level. The blocks are made of two
+ * pixels along the halved axes, and start at the index of the input
+ * region. */
+template< class T >
+void AverageBlocks(const void *inputBuffer, const ImageIORegion & inputRegion,
+                   void *outputBuffer, const ImageIORegion & outputRegion,
+                   const std::vector< bool > & halved, unsigned int numberOfComponents)
+{
+  const T           *input = static_cast< const T * >( inputBuffer );
+  T                 *output = static_cast< T * >( outputBuffer );
+  const unsigned int dimension = inputRegion.GetImageDimension();
+
+  // offsets in the input of the values averaged with the first one
+  std::vector< OffsetValueType > blockOffsets(1, 0);
+  std::vector< OffsetValueType > strides(dimension);
+  OffsetValueType                stride = numberOfComponents;
+  for ( unsigned int i = 0; i < dimension; i++ )
+    {
+    strides[i] = halved[i] ? 2 * stride : stride;
+    if ( halved[i] )
+      {
+      const size_t numberOfOffsets = blockOffsets.size();
+      for ( size_t j = 0; j < numberOfOffsets; j++ )
+        {
+        blockOffsets.push_back(blockOffsets[j] + stride);
+        }
+      }
+    stride *= inputRegion.GetSize(i);
+    }
+  const double scale = 1.0 / blockOffsets.size();
+
+  std::vector< SizeValueType > index(dimension, 0);
+  const SizeValueType          numberOfPixels = outputRegion.GetNumberOfPixels();
+  for ( SizeValueType p = 0; p < numberOfPixels; p++ )
+    {
+    OffsetValueType offset = 0;
+    for ( unsigned int i = 0; i < dimension; i++ )
+      {
+      offset += index[i] * strides[i];
+      }
+    for ( unsigned int c = 0; c < numberOfComponents; c++ )
+      {
+      double sum = 0.0;
+      for ( size_t j = 0; j < blockOffsets.size(); j++ )
+        {
+        sum += static_cast< double >( input[offset + blockOffsets[j] + c] );
+        }
+      *output++ = RoundAverage< T >(sum * scale);
+      }
+
+    for ( unsigned int i = 0; i < dimension && ++index[i] == outputRegion.GetSize(i); i++ )
+      {
+      index[i] = 0;
+      }
+    }
+}
+
+bool ShrinkRegion(ImageIOBase::IOComponentType componentType,
+                  const void *input, const ImageIORegion & inputRegion,
+                  void *output, const ImageIORegion & outputRegion,
+                  const std::vector< bool > & halved, unsigned int numberOfComponents)
+{
+  switch ( componentType )
+    {
+    case ImageIOBase::UCHAR:
+      AverageBlocks< unsigned char >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::CHAR:
+      AverageBlocks< char >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::USHORT:
+      AverageBlocks< unsigned short >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::SHORT:
+      AverageBlocks< short >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::UINT:
+      AverageBlocks< unsigned int >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::INT:
+      AverageBlocks< int >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::ULONG:
+      AverageBlocks< unsigned long >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::LONG:
+      AverageBlocks< long >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::FLOAT:
+      AverageBlocks< float >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    case ImageIOBase::DOUBLE:
+      AverageBlocks< double >(input, inputRegion, output, outputRegion, halved, numberOfComponents);
+      break;
+    default:
+      return false;
+    }
+  return true;
+}
+} // end anonymous namespace
+
+HDF5ImageIO::HDF5ImageIO()
+{
+  m_CompressionLevel = 5;
+  m_MaximumChunkSizeInBytes = 1024 * 1024;
+  m_NumberOfResolutionLevels = 1;
+  m_ResolutionLevel = 0;
+
+  // the pixels are converted to the native types by the library
+  if ( ByteSwapper< int >::SystemIsBigEndian() )
+    {
+    m_ByteOrder = BigEndian;
+    }
+  else
+    {
+    m_ByteOrder = LittleEndian;
+    }
+
+  const char *extensions[] = { ".h5", ".hdf5", ".hdf", ".hd5" };
+  for ( unsigned int i = 0; i < sizeof( extensions ) / sizeof( extensions[0] ); i++ )
+    {
+    this->AddSupportedWriteExtension(extensions[i]);
+    this->AddSupportedReadExtension(extensions[i]);
+    }
+}
+
+HDF5ImageIO::~HDF5ImageIO()
+{}
+
+void HDF5ImageIO::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "CompressionLevel: " << m_CompressionLevel << "\n";
+  os << indent << "MaximumChunkSizeInBytes: " << m_MaximumChunkSizeInBytes << "\n";
+  os << indent << "NumberOfResolutionLevels: " << m_NumberOfResolutionLevels << "\n";
+  os << indent << "ResolutionLevel: " << m_ResolutionLevel << "\n";
+}
+
+bool HDF5ImageIO::CanReadFile(const char *filename)
+{
+  if ( filename == 0 || *filename == '\0' )
+    {
+    return false;
+    }
+
+  // probing a file which is not an HDF5 image is not an error
+  HDF5LockHolder lock(HDF5Lock);
+  bool           canRead = false;
+  H5E_BEGIN_TRY
+    {
+    if ( H5Fis_hdf5(filename) > 0 )
+      {
+      HDF5Handle file(H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT), H5Fclose);
+      if ( file.IsValid() )
+        {
+        HDF5Handle image(H5Gopen2(file, ImageName, H5P_DEFAULT), H5Gclose);
+        if ( image.IsValid() )
+          {
+          HDF5Handle dataset(H5Dopen2(image, VoxelDataName, H5P_DEFAULT), H5Dclose);
+          canRead = dataset.IsValid();
+          }
+        }
+      }
+    }
+  H5E_END_TRY;
+  return canRead;
+}
+
+void HDF5ImageIO::ReadImageInformation()
+{
+  HDF5LockHolder lock(HDF5Lock);
+
+  HDF5Handle file(H5Fopen(m_FileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT), H5Fclose);
+  if ( !file.IsValid() )
+    {
+    itkExceptionMacro("Unable to open file: " << m_FileName);
+    }
+  HDF5Handle image(H5Gopen2(file, ImageName, H5P_DEFAULT), H5Gclose);
+  if ( !image.IsValid() )
+    {
+    itkExceptionMacro("No image in file: " << m_FileName);
+    }
+
+  // the origin, spacing and size are those of the resolution level read
+  m_NumberOfResolutionLevels = CountResolutionLevels(image);
+  if ( m_ResolutionLevel >= m_NumberOfResolutionLevels )
+    {
+    itkExceptionMacro("No resolution level " << m_ResolutionLevel << " in file: " << m_FileName
+                      << ", which has " << m_NumberOfResolutionLevels << " resolution levels");
+    }
+  HDF5Handle level(H5Gopen2(file, ResolutionLevelName(m_ResolutionLevel).c_str(), H5P_DEFAULT), H5Gclose);
+  if ( !level.IsValid() )
+    {
+    itkExceptionMacro("Unable to open resolution level " << m_ResolutionLevel << " in file: " << m_FileName);
+    }
+
+  std::vector< double > origin;
+  std::vector< double > spacing;
+  std::vector< double > directions;
+  if ( !ReadArray(level, OriginName, H5T_NATIVE_DOUBLE, origin)
+       || !ReadArray(level, SpacingName, H5T_NATIVE_DOUBLE, spacing)
+       || !ReadArray(image, DirectionsName, H5T_NATIVE_DOUBLE, directions) )
+    {
+    itkExceptionMacro("Unable to read the geometry of the image in file: " << m_FileName);
+    }
+  const unsigned int dimension = static_cast< unsigned int >( origin.size() );
+  if ( dimension == 0 || spacing.size() != dimension || directions.size() != dimension * dimension )
+    {
+    itkExceptionMacro("Invalid geometry of the image in file: " << m_FileName);
+    }
+
+  HDF5Handle dataset(H5Dopen2(level, VoxelDataName, H5P_DEFAULT), H5Dclose);
+  if ( !dataset.IsValid() )
+    {
+    itkExceptionMacro("Unable to open the VoxelData dataset in file: " << m_FileName);
+    }
+  HDF5Handle type(H5Dget_type(dataset), H5Tclose);
+  HDF5Handle space(H5Dget_space(dataset), H5Sclose);
+  const int  rank = H5Sget_simple_extent_ndims(space);
+  if ( rank != static_cast< int >( dimension ) && rank != static_cast< int >( dimension + 1 ) )
+    {
+    itkExceptionMacro("The VoxelData dataset does not have " << dimension
+                      << " dimensions in file: " << m_FileName);
+    }
+  std::vector< hsize_t > dimensions(rank);
+  H5Sget_simple_extent_dims(space, &dimensions[0], 0);
+
+  this->SetNumberOfDimensions(dimension);
+  for ( unsigned int i = 0; i < dimension; i++ )
+    {
+    m_Dimensions[i] = static_cast< SizeValueType >( dimensions[dimension - 1 - i] );
+    m_Origin[i] = origin[i];
+    m_Spacing[i] = spacing[i];
+    std::vector< double > direction(directions.begin() + i * dimension,
+                                    directions.begin() + ( i + 1 ) * dimension);
+    this->SetDirection(i, direction);
+    }
+
+  m_ComponentType = ComponentTypeFromHDF5(type);
+  if ( m_ComponentType == UNKNOWNCOMPONENTTYPE )
+    {
+    itkExceptionMacro("Unsupported type of the pixels in file: " << m_FileName);
+    }
+  this->SetNumberOfComponents( rank > static_cast< int >( dimension )
+                               ? static_cast< unsigned int >( dimensions[dimension] ) : 1 );
+
+  m_PixelType = this->GetNumberOfComponents() == 1 ? SCALAR : VECTOR;
+  std::string pixelType;
+  if ( ReadString(image, PixelTypeName, pixelType) )
+    {
+    for ( int t = SCALAR; t <= COMPLEX; t++ )
+      {
+      if ( pixelType == this->GetPixelTypeAsString( static_cast< IOPixelType >( t ) ) )
+        {
+        m_PixelType = static_cast< IOPixelType >( t );
+        }
+      }
+    }
+
+  // the meta data which can be converted back to strings and numbers
+  MetaDataDictionary & dictionary = this->GetMetaDataDictionary();
+  H5E_BEGIN_TRY
+    {
+    HDF5Handle metaData(H5Gopen2(image, MetaDataName, H5P_DEFAULT), H5Gclose);
+    H5G_info_t info;
+    if ( metaData.IsValid() && H5Gget_info(metaData, &info) >= 0 )
+      {
+      for ( hsize_t i = 0; i < info.nlinks; i++ )
+        {
+        const ssize_t size = H5Lget_name_by_idx(metaData, ".", H5_INDEX_NAME, H5_ITER_INC, i,
+                                                0, 0, H5P_DEFAULT);
+        if ( size <= 0 )
+          {
+          continue;
+          }
+        std::vector< char > name(size + 1, '\0');
+        H5Lget_name_by_idx(metaData, ".", H5_INDEX_NAME, H5_ITER_INC, i, &name[0], size + 1, H5P_DEFAULT);
+        const std::string key(&name[0]);
+
+        std::string value;
+        if ( ReadString(metaData, key.c_str(), value) )
+          {
+          EncapsulateMetaData< std::string >(dictionary, key, value);
+          continue;
+          }
+        HDF5Handle entry(H5Dopen2(metaData, key.c_str(), H5P_DEFAULT), H5Dclose);
+        if ( !entry.IsValid() )
+          {
+          continue;
+          }
+        HDF5Handle entryType(H5Dget_type(entry), H5Tclose);
+        HDF5Handle nativeType(H5Tget_native_type(entryType, H5T_DIR_ASCEND), H5Tclose);
+        if ( nativeType.IsValid() )
+          {
+          ReadMetaDataObject< double >(metaData, key, nativeType, H5T_NATIVE_DOUBLE, dictionary)
+          || ReadMetaDataObject< float >(metaData, key, nativeType, H5T_NATIVE_FLOAT, dictionary)
+          || ReadMetaDataObject< int >(metaData, key, nativeType, H5T_NATIVE_INT, dictionary)
+          || ReadMetaDataObject< unsigned int >(metaData, key, nativeType, H5T_NATIVE_UINT, dictionary)
+          || ReadMetaDataObject< long >(metaData, key, nativeType, H5T_NATIVE_LONG, dictionary)
+          || ReadMetaDataObject< unsigned long >(metaData, key, nativeType, H5T_NATIVE_ULONG, dictionary)
+          || ReadMetaDataObject< short >(metaData, key, nativeType, H5T_NATIVE_SHORT, dictionary)
+          || ReadMetaDataObject< unsigned short >(metaData, key, nativeType, H5T_NATIVE_USHORT, dictionary);
+          }
+        }
+      }
+    }
+  H5E_END_TRY;
+}
+
+void HDF5ImageIO::Read(void *buffer)
+{
+  HDF5LockHolder lock(HDF5Lock);
+
+  HDF5Handle file(H5Fopen(m_FileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT), H5Fclose);
+  if ( !file.IsValid() )
+    {
+    itkExceptionMacro("Unable to open file: " << m_FileName);
+    }
+  HDF5Handle level(H5Gopen2(file, ResolutionLevelName(m_ResolutionLevel).c_str(), H5P_DEFAULT), H5Gclose);
+  HDF5Handle dataset(level.IsValid() ? H5Dopen2(level, VoxelDataName, H5P_DEFAULT) : -1, H5Dclose);
+  if ( !dataset.IsValid() )
+    {
+    itkExceptionMacro("Unable to open the VoxelData dataset of resolution level " << m_ResolutionLevel
+                      << " in file: " << m_FileName);
+    }
+
+  if ( !ReadIORegion(dataset, ComponentTypeToHDF5(m_ComponentType), m_IORegion,
+                     this->GetNumberOfComponents(), buffer) )
+    {
+    itkExceptionMacro("Unable to read the region " << m_IORegion << " from file: " << m_FileName);
+    }
+}
+
+bool HDF5ImageIO::CanWriteFile(const char *name)
+{
+  if ( name == 0 || *name == '\0' )
+    {
+    return false;
+    }
+
+  const std::string extension =
+    itksys::SystemTools::LowerCase( itksys::SystemTools::GetFilenameLastExtension(name) );
+  const ArrayOfExtensionsType & extensions = this->GetSupportedWriteExtensions();
+  return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+}
+
+std::vector< SizeValueType >
+HDF5ImageIO::ComputeChunkSize(const std::vector< SizeValueType > & size) const
+{
+  const unsigned int           dimension = static_cast< unsigned int >( size.size() );
+  std::vector< SizeValueType > chunkSize(dimension);
+  SizeValueType                bytes = this->GetComponentSize() * this->GetNumberOfComponents();
+  for ( unsigned int i = 0; i < dimension; i++ )
+    {
+    chunkSize[i] = std::max( size[i], static_cast< SizeValueType >( 1 ) );
+    bytes *= chunkSize[i];
+    }
+
+  // halve the outermost axes first, so a chunk is made of whole
+  // hyperslices whenever possible
+  for ( int i = dimension - 1; i >= 0 && bytes > m_MaximumChunkSizeInBytes; )
+    {
+    if ( chunkSize[i] == 1 )
+      {
+      --i;
+      continue;
+      }
+    bytes = bytes / chunkSize[i];
+    chunkSize[i] = ( chunkSize[i] + 1 ) / 2;
+    bytes *= chunkSize[i];
+    }
+  return chunkSize;
+}
+
+unsigned int HDF5ImageIO::ComputeNumberOfResolutionLevels() const
+{
+  std::vector< SizeValueType > size(m_Dimensions);
+  unsigned int                 numberOfLevels = 1;
+  while ( numberOfLevels < m_NumberOfResolutionLevels && HalveSize(size) )
+    {
+    ++numberOfLevels;
+    }
+  return numberOfLevels;
+}
+
+void HDF5ImageIO::WriteImageHeader()
+{
+  const unsigned int dimension = this->GetNumberOfDimensions();
+  const hid_t        type = ComponentTypeToHDF5(m_ComponentType);
+  if ( type < 0 )
+    {
+    itkExceptionMacro("Unsupported component type: " << this->GetComponentTypeAsString(m_ComponentType));
+    }
+
+  HDF5Handle file(H5Fcreate(m_FileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT), H5Fclose);
+  if ( !file.IsValid() )
+    {
+    itkExceptionMacro("Unable to create file: " << m_FileName);
+    }
+  if ( !WriteString( file, ITKVersionName, Version::GetITKVersion() ) )
+    {
+    itkExceptionMacro("Unable to write the version in file: " << m_FileName);
+    }
+  HDF5Handle imageGroup(H5Gcreate2(file, ImageGroupName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), H5Gclose);
+  HDF5Handle image(imageGroup.IsValid() ? H5Gcreate2(file, ImageName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT) : -1,
+                   H5Gclose);
+  if ( !image.IsValid() )
+    {
+    itkExceptionMacro("Unable to create the image group in file: " << m_FileName);
+    }
+
+  // geometry
+  std::vector< double >        origin(dimension);
+  std::vector< double >        spacing(dimension);
+  std::vector< unsigned long > size(dimension);
+  std::vector< double >        directions;
+  for ( unsigned int i = 0; i < dimension; i++ )
+    {
+    origin[i] = m_Origin[i];
+    spacing[i] = m_Spacing[i];
+    size[i] = m_Dimensions[i];
+    const std::vector< double > & direction = this->GetDirection(i);
+    directions.insert( directions.end(), direction.begin(), direction.end() );
+    }
+  const std::vector< hsize_t > vectorDimensions(1, dimension);
+  const std::vector< hsize_t > matrixDimensions(2, dimension);
+  if ( !WriteArray(image, OriginName, H5T_NATIVE_DOUBLE, origin, vectorDimensions)
+       || !WriteArray(image, SpacingName, H5T_NATIVE_DOUBLE, spacing, vectorDimensions)
+       || !WriteArray(image, DimensionName, H5T_NATIVE_ULONG, size, vectorDimensions)
+       || !WriteArray(image, DirectionsName, H5T_NATIVE_DOUBLE, directions, matrixDimensions)
+       || !WriteString( image, PixelTypeName, this->GetPixelTypeAsString(m_PixelType) ) )
+    {
+    itkExceptionMacro("Unable to write the geometry of the image in file: " << m_FileName);
+    }
+
+  // the meta data which are strings or numbers
+  HDF5Handle metaData(H5Gcreate2(image, MetaDataName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), H5Gclose);
+  if ( !metaData.IsValid() )
+    {
+    itkExceptionMacro("Unable to create the meta data group in file: " << m_FileName);
+    }
+  const MetaDataDictionary & dictionary = this->GetMetaDataDictionary();
+  for ( MetaDataDictionary::ConstIterator it = dictionary.Begin(); it != dictionary.End(); ++it )
+    {
+    const std::string &        key = it->first;
+    const MetaDataObjectBase *object = it->second;
+    if ( key.empty() || key.find('/') != std::string::npos || key == "." )
+      {
+      itkDebugMacro("Meta data " << key << " is not written");
+      continue;
+      }
+    const MetaDataObject< std::string > *stringObject =
+      dynamic_cast< const MetaDataObject< std::string > * >( object );
+    if ( stringObject )
+      {
+      WriteString( metaData, key.c_str(), stringObject->GetMetaDataObjectValue() );
+      continue;
+      }
+    if ( !WriteMetaDataObject< double >(metaData, key, object, H5T_NATIVE_DOUBLE)
+         && !WriteMetaDataObject< float >(metaData, key, object, H5T_NATIVE_FLOAT)
+         && !WriteMetaDataObject< int >(metaData, key, object, H5T_NATIVE_INT)
+         && !WriteMetaDataObject< unsigned int >(metaData, key, object, H5T_NATIVE_UINT)
+         && !WriteMetaDataObject< long >(metaData, key, object, H5T_NATIVE_LONG)
+         && !WriteMetaDataObject< unsigned long >(metaData, key, object, H5T_NATIVE_ULONG)
+         && !WriteMetaDataObject< short >(metaData, key, object, H5T_NATIVE_SHORT)
+         && !WriteMetaDataObject< unsigned short >(metaData, key, object, H5T_NATIVE_USHORT) )
+      {
+      itkDebugMacro("Meta data " << key << " of type " << object->GetMetaDataObjectTypeName()
+                                 << " is not written");
+      }
+    }
+
+  // the chunked datasets of the pixels of the image and its resolution
+  // levels, filled when the regions are written
+  const unsigned int numberOfLevels = this->ComputeNumberOfResolutionLevels();
+  HDF5Handle         levels(numberOfLevels > 1
+                            ? H5Gcreate2(image, ResolutionLevelsName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT) : -1,
+                            H5Gclose);
+  if ( numberOfLevels > 1 && !levels.IsValid() )
+    {
+    itkExceptionMacro("Unable to create the resolution levels group in file: " << m_FileName);
+    }
+  std::vector< SizeValueType > levelSize(m_Dimensions);
+  for ( unsigned int l = 0; l < numberOfLevels; l++ )
+    {
+    if ( l > 0 )
+      {
+      // the center of the first block of the previous level
+      const std::vector< SizeValueType > previousSize(levelSize);
+      HalveSize(levelSize);
+      for ( unsigned int i = 0; i < dimension; i++ )
+        {
+        if ( levelSize[i] == previousSize[i] )
+          {
+          continue;
+          }
+        const std::vector< double > & direction = this->GetDirection(i);
+        for ( unsigned int j = 0; j < dimension; j++ )
+          {
+          origin[j] += 0.5 * spacing[i] * direction[j];
+          }
+        spacing[i] *= 2.0;
+        }
+      std::copy( levelSize.begin(), levelSize.end(), size.begin() );
+      }
+
+    HDF5Handle level(l > 0 ? H5Gcreate2(file, ResolutionLevelName(l).c_str(), H5P_DEFAULT, H5P_DEFAULT,
+                                        H5P_DEFAULT) : -1, H5Gclose);
+    if ( l > 0
+         && ( !level.IsValid()
+              || !WriteArray(level, OriginName, H5T_NATIVE_DOUBLE, origin, vectorDimensions)
+              || !WriteArray(level, SpacingName, H5T_NATIVE_DOUBLE, spacing, vectorDimensions)
+              || !WriteArray(level, DimensionName, H5T_NATIVE_ULONG, size, vectorDimensions) ) )
+      {
+      itkExceptionMacro("Unable to write the geometry of resolution level " << l << " in file: " << m_FileName);
+      }
+
+    const unsigned int                 numberOfComponents = this->GetNumberOfComponents();
+    const unsigned int                 rank = numberOfComponents > 1 ? dimension + 1 : dimension;
+    const std::vector< SizeValueType > chunkSize = this->ComputeChunkSize(levelSize);
+    std::vector< hsize_t >             dimensions(rank, numberOfComponents);
+    std::vector< hsize_t >             chunkDimensions(rank, numberOfComponents);
+    for ( unsigned int i = 0; i < dimension; i++ )
+      {
+      dimensions[dimension - 1 - i] = levelSize[i];
+      chunkDimensions[dimension - 1 - i] = chunkSize[i];
+      }
+    HDF5Handle space(H5Screate_simple(rank, &dimensions[0], 0), H5Sclose);
+    HDF5Handle properties(H5Pcreate(H5P_DATASET_CREATE), H5Pclose);
+    if ( !space.IsValid() || !properties.IsValid()
+         || H5Pset_chunk(properties, rank, &chunkDimensions[0]) < 0
+         || ( m_UseCompression && H5Pset_deflate(properties, m_CompressionLevel) < 0 ) )
+      {
+      itkExceptionMacro("Unable to set up the VoxelData dataset in file: " << m_FileName);
+      }
+    HDF5Handle dataset(H5Dcreate2(l > 0 ? static_cast< hid_t >( level ) : static_cast< hid_t >( image ),
+                                  VoxelDataName, type, space, H5P_DEFAULT, properties, H5P_DEFAULT),
+                       H5Dclose);
+    if ( !dataset.IsValid() )
+      {
+      itkExceptionMacro("Unable to create the VoxelData dataset of resolution level " << l
+                        << " in file: " << m_FileName);
+      }
+    }
+}
+
+void HDF5ImageIO::Write(const void *buffer)
+{
+  ImageIORegion largestRegion( this->GetNumberOfDimensions() );
+  for ( unsigned int i = 0; i < this->GetNumberOfDimensions(); i++ )
+    {
+    largestRegion.SetIndex(i, 0);
+    largestRegion.SetSize(i, m_Dimensions[i]);
+    }
+
+  HDF5LockHolder lock(HDF5Lock);
+
+  // the first piece creates the file, the next ones are written in it
+  if ( !m_UseStreamedWriting || m_IORegion == largestRegion
+       || !itksys::SystemTools::FileExists( m_FileName.c_str() ) )
+    {
+    this->WriteImageHeader();
+    }
+
+  HDF5Handle file(H5Fopen(m_FileName.c_str(), H5F_ACC_RDWR, H5P_DEFAULT), H5Fclose);
+  if ( !file.IsValid() )
+    {
+    itkExceptionMacro("Unable to open file: " << m_FileName);
+    }
+  HDF5Handle image(H5Gopen2(file, ImageName, H5P_DEFAULT), H5Gclose);
+  HDF5Handle dataset(image.IsValid() ? H5Dopen2(image, VoxelDataName, H5P_DEFAULT) : -1, H5Dclose);
+  if ( !dataset.IsValid() )
+    {
+    itkExceptionMacro("Unable to open the VoxelData dataset in file: " << m_FileName);
+    }
+
+  const hid_t type = ComponentTypeToHDF5(m_ComponentType);
+  if ( !WriteIORegion(dataset, type, m_IORegion, this->GetNumberOfComponents(), buffer) )
+    {
+    itkExceptionMacro("Unable to write the region " << m_IORegion << " in file: " << m_FileName);
+    }
+
+  // the resolution levels of the file are updated from the blocks of
+  // the last level covering the IO region; the pixels of these blocks
+  // which are outside of the IO region are read back from the image
+  const unsigned int numberOfLevels = CountResolutionLevels(image);
+  if ( numberOfLevels == 1 )
+    {
+    return;
+    }
+  const unsigned int  dimension = this->GetNumberOfDimensions();
+  const unsigned int  numberOfComponents = this->GetNumberOfComponents();
+  const SizeValueType blockSize = static_cast< SizeValueType >( 1 ) << ( numberOfLevels - 1 );
+  ImageIORegion       region(dimension);
+  for ( unsigned int i = 0; i < dimension; i++ )
+    {
+    const SizeValueType begin = m_IORegion.GetIndex(i) / blockSize * blockSize;
+    const SizeValueType end = std::min( ( m_IORegion.GetIndex(i) + m_IORegion.GetSize(i) + blockSize - 1 )
+                                        / blockSize * blockSize, m_Dimensions[i] );
+    region.SetIndex(i, begin);
+    region.SetSize(i, end - begin);
+    }
+
+  std::vector< char > input;
+  std::vector< char > output;
+  const void         *levelBuffer = buffer;
+  if ( region != m_IORegion )
+    {
+    input.resize(region.GetNumberOfPixels() * numberOfComponents * this->GetComponentSize());
+    if ( !ReadIORegion(dataset, type, region, numberOfComponents, &input[0]) )
+      {
+      itkExceptionMacro("Unable to read the region " << region << " from file: " << m_FileName);
+      }
+    levelBuffer = &input[0];
+    }
+
+  std::vector< SizeValueType > size(m_Dimensions);
+  for ( unsigned int l = 1; l < numberOfLevels; l++ )
+    {
+    const std::vector< SizeValueType > previousSize(size);
+    HalveSize(size);
+    std::vector< bool > halved(dimension);
+    ImageIORegion       levelRegion(dimension);
+    for ( unsigned int i = 0; i < dimension; i++ )
+      {
+      halved[i] = size[i] != previousSize[i];
+      SizeValueType begin = region.GetIndex(i);
+      SizeValueType end = begin + region.GetSize(i);
+      if ( halved[i] )
+        {
+        begin /= 2;
+        end = std::min(end / 2, size[i]);
+        }
+      if ( end <= begin )
+        {
+        // only the last pixels, which are not part of a block, are left
+        return;
+        }
+      levelRegion.SetIndex(i, begin);
+      levelRegion.SetSize(i, end - begin);
+      }
+
+    output.resize(levelRegion.GetNumberOfPixels() * numberOfComponents * this->GetComponentSize());
+    if ( !ShrinkRegion(m_ComponentType, levelBuffer, region, &output[0], levelRegion, halved, numberOfComponents) )
+      {
+      itkExceptionMacro("Unsupported component type: " << this->GetComponentTypeAsString(m_ComponentType));
+      }
+
+    HDF5Handle level(H5Gopen2(file, ResolutionLevelName(l).c_str(), H5P_DEFAULT), H5Gclose);
+    HDF5Handle levelDataset(level.IsValid() ? H5Dopen2(level, VoxelDataName, H5P_DEFAULT) : -1, H5Dclose);
+    if ( !levelDataset.IsValid() )
+      {
+      itkExceptionMacro("Unable to open the VoxelData dataset of resolution level " << l
+                        << " in file: " << m_FileName);
+      }
+    if ( !WriteIORegion(levelDataset, type, levelRegion, numberOfComponents, &output[0]) )
+      {
+      itkExceptionMacro("Unable to write the region " << levelRegion << " of resolution level " << l
+                        << " in file: " << m_FileName);
+      }
+
+    input.swap(output);
+    levelBuffer = &input[0];
+    region = levelRegion;
+    }
+}
+
+ImageIORegion
+HDF5ImageIO
+::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const
+{
+  ImageIORegion streamableRegion(this->m_NumberOfDimensions);
+
+  if ( !m_UseStreamedReading )
+    {
+    for ( unsigned int i = 0; i < this->m_NumberOfDimensions; i++ )
+      {
+      streamableRegion.SetSize(i, this->m_Dimensions[i]);
+      streamableRegion.SetIndex(i, 0);
+      }
+    }
+  else
+    {
+    streamableRegion = requestedRegion;
+    }
+
+  return streamableRegion;
+}
+
+bool HDF5ImageIO::ComputeSplit(unsigned int numberOfRequestedSplits,
+                               const ImageIORegion & pasteRegion,
+                               unsigned int & splitAxis,
+                               SizeValueType & valuesPerPiece) const
+{
+  // split on the outermost dimension available
+  int axis = pasteRegion.GetImageDimension() - 1;
+  while ( axis >= 0 && pasteRegion.GetSize(axis) == 1 )
+    {
+    --axis;
+    }
+  if ( axis < 0 || numberOfRequestedSplits == 0 )
+    {
+    return false;
+    }
+  splitAxis = axis;
+
+  // the pieces hold whole chunks and whole blocks of the last resolution
+  // level along the split axis, so no pixel is read back to compute the
+  // levels
+  const SizeValueType range = pasteRegion.GetSize(axis);
+  const SizeValueType chunk = this->ComputeChunkSize(m_Dimensions)[axis];
+  const SizeValueType blockSize =
+    static_cast< SizeValueType >( 1 ) << ( this->ComputeNumberOfResolutionLevels() - 1 );
+  SizeValueType divisor = chunk;
+  for ( SizeValueType remainder = blockSize; remainder != 0; )
+    {
+    const SizeValueType next = divisor % remainder;
+    divisor = remainder;
+    remainder = next;
+    }
+  const SizeValueType step = chunk / divisor * blockSize;
+  valuesPerPiece = ( range + numberOfRequestedSplits - 1 ) / numberOfRequestedSplits;
+  valuesPerPiece = std::min( ( valuesPerPiece + step - 1 ) / step * step, range );
+  return true;
+}
+
+unsigned int
+HDF5ImageIO::GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                               const ImageIORegion & pasteRegion,
+                                               const ImageIORegion & largestPossibleRegion)
+{
+  if ( !itksys::SystemTools::FileExists( m_FileName.c_str() ) )
+    {
+    // file doesn't exits so we don't have potential problems
+    }
+  else if ( pasteRegion != largestPossibleRegion )
+    {
+    // we are going to be pasting (may be streaming too)
+
+    // need to check to see if the file is compatible
+    std::string errorMessage;
+    Pointer     headerImageIOReader = Self::New();
+
+    try
+      {
+      headerImageIOReader->SetFileName( m_FileName.c_str() );
+      headerImageIOReader->ReadImageInformation();
+      }
+    catch ( ... )
+      {
+      errorMessage = "Unable to read information from file: " + m_FileName;
+      }
+
+    if ( errorMessage.size() )
+      {
+      // Can't read file
+      }
+    else if ( headerImageIOReader->GetNumberOfComponents() != this->GetNumberOfComponents()
+              || headerImageIOReader->GetComponentType() != this->GetComponentType() )
+      {
+      errorMessage = "Component type does not match in file: " + m_FileName;
+      }
+    else if ( headerImageIOReader->GetNumberOfDimensions() != this->GetNumberOfDimensions() )
+      {
+      errorMessage = "Dimensions does not match in file: " + m_FileName;
+      }
+    else
+      {
+      for ( unsigned int i = 0; i < this->GetNumberOfDimensions(); ++i )
+        {
+        if ( headerImageIOReader->GetDimensions(i) != this->GetDimensions(i)
+             || headerImageIOReader->GetSpacing(i) != this->GetSpacing(i)
+             || headerImageIOReader->GetOrigin(i) != this->GetOrigin(i) )
+          {
+          errorMessage = "Size, spacing or origin does not match in file: " + m_FileName;
+          break;
+          }
+        if ( headerImageIOReader->GetDirection(i) != this->GetDirection(i) )
+          {
+          errorMessage = "Direction cosines does not match in file: " + m_FileName;
+          break;
+          }
+        }
+      }
+
+    if ( errorMessage.size() )
+      {
+      itkExceptionMacro("Unable to paste because pasting file exists and is different. " << errorMessage);
+      }
+    }
+  else if ( numberOfRequestedSplits != 1 )
+    {
+    // we are going be streaming
+
+    // need to remove the file incase the file doesn't match our
+    // current header/meta data information
+    if ( !itksys::SystemTools::RemoveFile( m_FileName.c_str() ) )
+      {
+      itkExceptionMacro("Unable to remove file for streaming: " << m_FileName);
+      }
+    }
+
+  unsigned int  splitAxis;
+  SizeValueType valuesPerPiece;
+  if ( !this->ComputeSplit(numberOfRequestedSplits, pasteRegion, splitAxis, valuesPerPiece) )
+    {
+    return 1;
+    }
+  return static_cast< unsigned int >(
+    ( pasteRegion.GetSize(splitAxis) + valuesPerPiece - 1 ) / valuesPerPiece );
+}
+
+ImageIORegion
+HDF5ImageIO::GetSplitRegionForWriting( unsigned int ithPiece,
+                                       unsigned int numberOfActualSplits,
+                                       const ImageIORegion & pasteRegion,
+                                       const ImageIORegion & itkNotUsed(largestPossibleRegion) )
+{
+  ImageIORegion splitRegion = pasteRegion;
+  unsigned int  splitAxis;
+  SizeValueType valuesPerPiece;
+  if ( !this->ComputeSplit(numberOfActualSplits, pasteRegion, splitAxis, valuesPerPiece) )
+    {
+    return splitRegion;
+    }
+
+  const SizeValueType start = ithPiece * valuesPerPiece;
+  splitRegion.SetIndex(splitAxis, pasteRegion.GetIndex(splitAxis) + start);
+  splitRegion.SetSize( splitAxis, std::min(valuesPerPiece, pasteRegion.GetSize(splitAxis) - start) );
+
+  itkDebugMacro("  Split Piece: " << splitRegion);
+
+  return splitRegion;
+}
+} // end namespace itk
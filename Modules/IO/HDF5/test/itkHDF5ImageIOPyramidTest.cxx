@@ -0,0 +1,342 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkHDF5ImageIO.h"
+#include "itkHDF5ImageIOFactory.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+// Write images with their resolution levels, whole, streamed and
+// pasted, and read back each level whole and by regions. The pixels of
+// the image are a linear function of the physical point, so the average
+// of a block of pixels is the value at the physical point of the pixel
+// of the level, except where a region is pasted.
+
+namespace
+{
+typedef itk::Image< float, 3 >             ImageType;
+typedef itk::ImageFileReader< ImageType >  ReaderType;
+typedef itk::ImageFileWriter< ImageType >  WriterType;
+
+const float PasteOffset = 100.0f;
+
+double LinearValue(const ImageType::PointType & point)
+{
+  return 2.0 * point[0] - 3.0 * point[1] + 0.5 * point[2] + 7.0;
+}
+
+ImageType::Pointer CreateImage()
+{
+  ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 30;
+  size[2] = 21;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 0.75;
+  spacing[2] = 2.0;
+  image->SetSpacing(spacing);
+  ImageType::PointType origin;
+  origin[0] = -10.0;
+  origin[1] = 3.5;
+  origin[2] = 8.0;
+  image->SetOrigin(origin);
+  ImageType::DirectionType direction;
+  direction.Fill(0.0);
+  direction[0][1] = 1.0;
+  direction[1][0] = -1.0;
+  direction[2][2] = 1.0;
+  image->SetDirection(direction);
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    image->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    it.Set( static_cast< float >( LinearValue(point) ) );
+    }
+  return image;
+}
+
+ReaderType::Pointer CreateReader(const std::string & fileName, unsigned int level)
+{
+  itk::HDF5ImageIO::Pointer io = itk::HDF5ImageIO::New();
+  io->SetResolutionLevel(level);
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->SetImageIO(io);
+  return reader;
+}
+
+// check a region of a level against the blocks of the image it averages,
+// with PasteOffset added to the pixels of the image in pasteRegion
+int CheckLevel(const ImageType *level, const ImageType::RegionType & region, const ImageType *image,
+               const ImageType::SizeType & factors, const ImageType::RegionType & pasteRegion)
+{
+  ImageType::SizeType    expectedSize;
+  ImageType::SpacingType expectedSpacing;
+  ImageType::PointType   expectedOrigin = image->GetOrigin();
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    expectedSize[i] = image->GetLargestPossibleRegion().GetSize(i) / factors[i];
+    expectedSpacing[i] = image->GetSpacing()[i] * factors[i];
+    for ( unsigned int j = 0; j < 3; j++ )
+      {
+      expectedOrigin[j] += image->GetDirection()[j][i] * image->GetSpacing()[i] * ( factors[i] - 1 ) / 2.0;
+      }
+    }
+  if ( level->GetLargestPossibleRegion().GetSize() != expectedSize
+       || level->GetDirection() != image->GetDirection()
+       || ( level->GetSpacing() - expectedSpacing ).GetNorm() > 1e-9
+       || level->GetOrigin().EuclideanDistanceTo(expectedOrigin) > 1e-9 )
+    {
+    std::cerr << "The level of size " << level->GetLargestPossibleRegion().GetSize() << ", spacing "
+              << level->GetSpacing() << " and origin " << level->GetOrigin() << " should have size "
+              << expectedSize << ", spacing " << expectedSpacing << " and origin " << expectedOrigin
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( level->GetBufferedRegion() != region )
+    {
+    std::cerr << "The buffered region is " << level->GetBufferedRegion()
+              << " instead of " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it(level, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    level->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+
+    // the part of the block inside the paste region
+    double pasted = 1.0;
+    for ( unsigned int i = 0; i < 3; i++ )
+      {
+      const long begin = it.GetIndex()[i] * static_cast< long >( factors[i] );
+      const long end = begin + static_cast< long >( factors[i] );
+      const long pasteBegin = pasteRegion.GetIndex(i);
+      const long pasteEnd = pasteBegin + static_cast< long >( pasteRegion.GetSize(i) );
+      pasted *= vnl_math_max( vnl_math_min(end, pasteEnd) - vnl_math_max(begin, pasteBegin), 0L )
+                / static_cast< double >( factors[i] );
+      }
+
+    const double expected = LinearValue(point) + PasteOffset * pasted;
+    if ( vnl_math_abs(it.Get() - expected) > 1e-3 * ( 1.0 + vnl_math_abs(expected) ) )
+      {
+      std::cerr << "Pixel " << it.GetIndex() << " of the level of size "
+                << level->GetLargestPossibleRegion().GetSize() << " is " << it.Get()
+                << " instead of " << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+// read all the levels of a file whole, and a region of each level
+int CheckLevels(const std::string & fileName, const ImageType *image, unsigned int numberOfLevels,
+                const ImageType::RegionType & pasteRegion)
+{
+  ReaderType::Pointer reader = CreateReader(fileName, 0);
+  reader->UpdateOutputInformation();
+  const itk::HDF5ImageIO *io = dynamic_cast< const itk::HDF5ImageIO * >( reader->GetImageIO() );
+  if ( io->GetNumberOfResolutionLevels() != numberOfLevels )
+    {
+    std::cerr << fileName << " has " << io->GetNumberOfResolutionLevels()
+              << " resolution levels instead of " << numberOfLevels << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::SizeType factors;
+  factors.Fill(1);
+  for ( unsigned int l = 0; l < numberOfLevels; l++ )
+    {
+    if ( l > 0 )
+      {
+      for ( unsigned int i = 0; i < 3; i++ )
+        {
+        if ( image->GetLargestPossibleRegion().GetSize(i) / factors[i] >= 2 )
+          {
+          factors[i] *= 2;
+          }
+        }
+      }
+
+    reader = CreateReader(fileName, l);
+    reader->Update();
+    if ( CheckLevel(reader->GetOutput(), reader->GetOutput()->GetLargestPossibleRegion(), image,
+                    factors, pasteRegion) != EXIT_SUCCESS )
+      {
+      std::cerr << "Resolution level " << l << " of " << fileName << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // the last half of the level along each axis
+    ImageType::RegionType region = reader->GetOutput()->GetLargestPossibleRegion();
+    for ( unsigned int i = 0; i < 3; i++ )
+      {
+      region.SetIndex( i, region.GetSize(i) / 2 );
+      region.SetSize( i, region.GetSize(i) - region.GetSize(i) / 2 );
+      }
+    reader = CreateReader(fileName, l);
+    reader->UpdateOutputInformation();
+    reader->GetOutput()->SetRequestedRegion(region);
+    reader->Update();
+    if ( CheckLevel(reader->GetOutput(), region, image, factors, pasteRegion) != EXIT_SUCCESS )
+      {
+      std::cerr << "Region " << region << " of resolution level " << l << " of " << fileName << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // a level which is not in the file
+  reader = CreateReader(fileName, numberOfLevels);
+  try
+    {
+    reader->Update();
+    std::cerr << "Reading resolution level " << numberOfLevels << " of " << fileName
+              << " does not fail" << std::endl;
+    return EXIT_FAILURE;
+    }
+  catch ( itk::ExceptionObject & )
+    {}
+  return EXIT_SUCCESS;
+}
+
+void WriteLevels(ImageType *image, const std::string & fileName, unsigned int numberOfLevels,
+                 unsigned int numberOfStreamDivisions, const std::string & inputFileName = "")
+{
+  itk::HDF5ImageIO::Pointer io = itk::HDF5ImageIO::New();
+  io->SetNumberOfResolutionLevels(numberOfLevels);
+  io->SetMaximumChunkSizeInBytes(37 * 30 * sizeof( float ) * 3);
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  ReaderType::Pointer input = CreateReader(inputFileName, 0);
+  if ( !inputFileName.empty() )
+    {
+    writer->SetInput( input->GetOutput() );
+    }
+  writer->SetImageIO(io);
+  writer->SetFileName(fileName);
+  writer->UseCompressionOn();
+  writer->SetNumberOfStreamDivisions(numberOfStreamDivisions);
+  writer->Update();
+}
+}
+
+int itkHDF5ImageIOPyramidTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkIOHDF5Tests itkHDF5ImageIOPyramidTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ObjectFactoryBase::RegisterFactory( itk::HDF5ImageIOFactory::New() );
+
+  const std::string     directory = av[1];
+  ImageType::Pointer    image = CreateImage();
+  ImageType::RegionType noPasteRegion;
+  int                   status = EXIT_SUCCESS;
+  try
+    {
+    // the levels stop when no axis can be halved any more
+    const std::string fileName = directory + "/itkHDF5ImageIOPyramidTest.h5";
+    const std::string streamedFileName = directory + "/itkHDF5ImageIOPyramidTestStreamed.h5";
+    WriteLevels(image, fileName, 4, 1);
+    WriteLevels(image, streamedFileName, 4, 5, fileName);
+    if ( CheckLevels(fileName, image, 4, noPasteRegion) != EXIT_SUCCESS
+         || CheckLevels(streamedFileName, image, 4, noPasteRegion) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    const std::string allLevelsFileName = directory + "/itkHDF5ImageIOPyramidTestAllLevels.h5";
+    WriteLevels(image, allLevelsFileName, 10, 3, fileName);
+    if ( CheckLevels(allLevelsFileName, image, 6, noPasteRegion) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    // paste a region which is not aligned on the blocks of the levels
+    ImageType::RegionType pasteRegion;
+    pasteRegion.SetIndex(0, 5);
+    pasteRegion.SetSize(0, 15);
+    pasteRegion.SetIndex(1, 3);
+    pasteRegion.SetSize(1, 14);
+    pasteRegion.SetIndex(2, 2);
+    pasteRegion.SetSize(2, 7);
+    itk::ImageIORegion ioRegion(3);
+    for ( unsigned int i = 0; i < 3; i++ )
+      {
+      ioRegion.SetIndex( i, pasteRegion.GetIndex(i) );
+      ioRegion.SetSize( i, pasteRegion.GetSize(i) );
+      }
+    ImageType::Pointer pasted = ImageType::New();
+    pasted->CopyInformation(image);
+    pasted->SetLargestPossibleRegion( image->GetLargestPossibleRegion() );
+    pasted->SetBufferedRegion(pasteRegion);
+    pasted->SetRequestedRegion(pasteRegion);
+    pasted->Allocate();
+    itk::ImageRegionIteratorWithIndex< ImageType > it(pasted, pasteRegion);
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      it.Set( image->GetPixel( it.GetIndex() ) + PasteOffset );
+      }
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput(pasted);
+    writer->SetFileName(streamedFileName);
+    writer->SetIORegion(ioRegion);
+    writer->UseCompressionOn();
+    writer->Update();
+    if ( CheckLevels(streamedFileName, image, 4, pasteRegion) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    // reading an overview reads a small part of the file
+    itk::TimeProbe timers[2];
+    for ( unsigned int t = 0; t < 2; t++ )
+      {
+      ReaderType::Pointer reader = CreateReader(fileName, 3 * t);
+      timers[t].Start();
+      reader->Update();
+      timers[t].Stop();
+      }
+    std::cout << "Image read in " << timers[0].GetTotal() << " s, resolution level 3 in "
+              << timers[1].GetTotal() << " s" << std::endl;
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -0,0 +1,348 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkHDF5ImageIO.h"
+#include "itkHDF5ImageIOFactory.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMetaDataObject.h"
+#include "itkVector.h"
+
+// Write images in HDF5 files, with and without compression and
+// streaming, and read them back whole and by regions.
+
+namespace
+{
+typedef itk::Image< short, 3 >                     ImageType;
+typedef itk::Image< itk::Vector< float, 3 >, 3 >   VectorImageType;
+
+short ExpectedPixel(const ImageType::IndexType & index)
+{
+  return static_cast< short >( index[0] - 7 * index[1] + 100 * index[2] );
+}
+
+ImageType::Pointer CreateImage()
+{
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 30;
+  size[2] = 20;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 0.75;
+  spacing[2] = 2.0;
+  image->SetSpacing(spacing);
+  ImageType::PointType origin;
+  origin[0] = -10.0;
+  origin[1] = 3.5;
+  origin[2] = 8.0;
+  image->SetOrigin(origin);
+  ImageType::DirectionType direction;
+  direction.Fill(0.0);
+  direction[0][1] = 1.0;
+  direction[1][0] = -1.0;
+  direction[2][2] = 1.0;
+  image->SetDirection(direction);
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( ExpectedPixel( it.GetIndex() ) );
+    }
+
+  itk::MetaDataDictionary & dictionary = image->GetMetaDataDictionary();
+  itk::EncapsulateMetaData< std::string >(dictionary, "Description", "An HDF5 image");
+  itk::EncapsulateMetaData< double >(dictionary, "Temperature", 36.6);
+  itk::EncapsulateMetaData< int >(dictionary, "Count", -42);
+  itk::EncapsulateMetaData< unsigned short >(dictionary, "Channel", 3);
+  return image;
+}
+
+int CheckImage(const ImageType *image, const ImageType *expected, const ImageType::RegionType & region)
+{
+  if ( image->GetBufferedRegion() != region )
+    {
+    std::cerr << "The buffered region is " << image->GetBufferedRegion()
+              << " instead of " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( image->GetLargestPossibleRegion() != expected->GetLargestPossibleRegion()
+       || image->GetSpacing() != expected->GetSpacing()
+       || image->GetOrigin() != expected->GetOrigin()
+       || image->GetDirection() != expected->GetDirection() )
+    {
+    std::cerr << "The geometry of the image is not the one written" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it(image, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != ExpectedPixel( it.GetIndex() ) )
+      {
+      std::cerr << "Pixel " << it.GetIndex() << " is " << it.Get()
+                << " instead of " << ExpectedPixel( it.GetIndex() ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  const itk::MetaDataDictionary & dictionary = image->GetMetaDataDictionary();
+  std::string    description;
+  double         temperature = 0.0;
+  int            count = 0;
+  unsigned short channel = 0;
+  if ( !itk::ExposeMetaData< std::string >(dictionary, "Description", description)
+       || description != "An HDF5 image"
+       || !itk::ExposeMetaData< double >(dictionary, "Temperature", temperature)
+       || temperature != 36.6
+       || !itk::ExposeMetaData< int >(dictionary, "Count", count)
+       || count != -42
+       || !itk::ExposeMetaData< unsigned short >(dictionary, "Channel", channel)
+       || channel != 3 )
+    {
+    std::cerr << "The meta data are not the ones written" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+typedef itk::ImageFileReader< ImageType > ReaderType;
+
+// When streaming, the pixels are read by pieces from a file written
+// before, and written by pieces in chunks of 2 slices.
+int WriteAndRead(const ImageType *image, const std::string & fileName,
+                 bool compression, unsigned int numberOfStreamDivisions,
+                 const std::string & inputFileName = "")
+{
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  ReaderType::Pointer input = ReaderType::New();
+  if ( !inputFileName.empty() )
+    {
+    input->SetFileName(inputFileName);
+    writer->SetInput( input->GetOutput() );
+    itk::HDF5ImageIO::Pointer io = itk::HDF5ImageIO::New();
+    io->SetMaximumChunkSizeInBytes(40 * 30 * sizeof( short ) * 2);
+    writer->SetImageIO(io);
+    }
+  writer->SetFileName(fileName);
+  writer->SetUseCompression(compression);
+  writer->SetNumberOfStreamDivisions(numberOfStreamDivisions);
+  writer->Update();
+
+  // the whole image
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->Update();
+  if ( dynamic_cast< itk::HDF5ImageIO * >( reader->GetImageIO() ) == 0 )
+    {
+    std::cerr << fileName << " is not read by HDF5ImageIO" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( CheckImage(reader->GetOutput(), image, image->GetLargestPossibleRegion()) != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // a region of the image, read alone
+  ImageType::RegionType region = image->GetLargestPossibleRegion();
+  region.SetIndex(0, 3);
+  region.SetSize(0, 21);
+  region.SetIndex(2, 11);
+  region.SetSize(2, 6);
+  reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->UpdateOutputInformation();
+  reader->GetOutput()->SetRequestedRegion(region);
+  reader->Update();
+  return CheckImage(reader->GetOutput(), image, region);
+}
+}
+
+int itkHDF5ImageIOTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkIOHDF5Tests itkHDF5ImageIOTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ObjectFactoryBase::RegisterFactory( itk::HDF5ImageIOFactory::New() );
+
+  const std::string directory = av[1];
+  ImageType::Pointer image = CreateImage();
+  int                status = EXIT_SUCCESS;
+  try
+    {
+    const std::string fileName = directory + "/itkHDF5ImageIOTest.h5";
+    if ( WriteAndRead(image, fileName, false, 1) != EXIT_SUCCESS
+         || WriteAndRead(image, directory + "/itkHDF5ImageIOTestCompressed.h5", true, 1) != EXIT_SUCCESS
+         || WriteAndRead(image, directory + "/itkHDF5ImageIOTestStreamed.hdf5", false, 4, fileName) != EXIT_SUCCESS
+         || WriteAndRead(image, directory + "/itkHDF5ImageIOTestStreamedCompressed.hdf5", true, 7, fileName)
+         != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    // paste a region in the existing file
+    const std::string     pasteFileName = directory + "/itkHDF5ImageIOTestCompressed.h5";
+    ImageType::RegionType pasteRegion = image->GetLargestPossibleRegion();
+    pasteRegion.SetIndex(1, 10);
+    pasteRegion.SetSize(1, 5);
+    itk::ImageIORegion ioRegion(3);
+    for ( unsigned int i = 0; i < 3; i++ )
+      {
+      ioRegion.SetIndex( i, pasteRegion.GetIndex(i) );
+      ioRegion.SetSize( i, pasteRegion.GetSize(i) );
+      }
+    // only the paste region is buffered, otherwise the whole image is
+    // written
+    ImageType::Pointer zeros = ImageType::New();
+    zeros->CopyInformation(image);
+    zeros->SetLargestPossibleRegion( image->GetLargestPossibleRegion() );
+    zeros->SetBufferedRegion(pasteRegion);
+    zeros->SetRequestedRegion(pasteRegion);
+    zeros->Allocate();
+    zeros->FillBuffer(0);
+
+    typedef itk::ImageFileWriter< ImageType > WriterType;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput(zeros);
+    writer->SetFileName(pasteFileName);
+    writer->SetIORegion(ioRegion);
+    writer->SetUseCompression(true);
+    writer->Update();
+
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(pasteFileName);
+    reader->Update();
+    itk::ImageRegionConstIteratorWithIndex< ImageType > it( reader->GetOutput(),
+                                                           reader->GetOutput()->GetBufferedRegion() );
+    for ( ; !it.IsAtEnd(); ++it )
+      {
+      const short expected = pasteRegion.IsInside( it.GetIndex() ) ? 0 : ExpectedPixel( it.GetIndex() );
+      if ( it.Get() != expected )
+        {
+        std::cerr << "Pasted pixel " << it.GetIndex() << " is " << it.Get()
+                  << " instead of " << expected << std::endl;
+        status = EXIT_FAILURE;
+        break;
+        }
+      }
+
+    // multi-component pixels
+    VectorImageType::Pointer vectorImage = VectorImageType::New();
+    vectorImage->SetRegions( image->GetLargestPossibleRegion() );
+    vectorImage->Allocate();
+    itk::ImageRegionIteratorWithIndex< VectorImageType > vit( vectorImage, vectorImage->GetBufferedRegion() );
+    for ( ; !vit.IsAtEnd(); ++vit )
+      {
+      VectorImageType::PixelType pixel;
+      for ( unsigned int c = 0; c < 3; c++ )
+        {
+        pixel[c] = 0.5f * ExpectedPixel( vit.GetIndex() ) + c;
+        }
+      vit.Set(pixel);
+      }
+    typedef itk::ImageFileWriter< VectorImageType > VectorWriterType;
+    VectorWriterType::Pointer vectorWriter = VectorWriterType::New();
+    vectorWriter->SetInput(vectorImage);
+    vectorWriter->SetFileName(directory + "/itkHDF5ImageIOTestVector.h5");
+    vectorWriter->SetUseCompression(true);
+    vectorWriter->SetNumberOfStreamDivisions(3);
+    vectorWriter->Update();
+
+    typedef itk::ImageFileReader< VectorImageType > VectorReaderType;
+    VectorReaderType::Pointer vectorReader = VectorReaderType::New();
+    vectorReader->SetFileName(directory + "/itkHDF5ImageIOTestVector.h5");
+    vectorReader->Update();
+    if ( vectorReader->GetImageIO()->GetPixelType() != itk::ImageIOBase::VECTOR
+         || vectorReader->GetImageIO()->GetNumberOfComponents() != 3 )
+      {
+      std::cerr << "The vector pixel type is read as "
+                << vectorReader->GetImageIO()->GetPixelTypeAsString( vectorReader->GetImageIO()->GetPixelType() )
+                << std::endl;
+      status = EXIT_FAILURE;
+      }
+    itk::ImageRegionConstIteratorWithIndex< VectorImageType > rit( vectorReader->GetOutput(),
+                                                                  vectorReader->GetOutput()->GetBufferedRegion() );
+    for ( vit.GoToBegin(); !vit.IsAtEnd(); ++vit, ++rit )
+      {
+      if ( vit.Get() != rit.Get() )
+        {
+        std::cerr << "Vector pixel " << rit.GetIndex() << " is " << rit.Get()
+                  << " instead of " << vit.Get() << std::endl;
+        status = EXIT_FAILURE;
+        break;
+        }
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the pieces written when streaming hold whole chunks
+  itk::HDF5ImageIO::Pointer io = itk::HDF5ImageIO::New();
+  io->SetFileName(directory + "/itkHDF5ImageIOTestSplits.h5");
+  io->SetNumberOfDimensions(3);
+  itk::ImageIORegion largestRegion(3);
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    io->SetDimensions( i, image->GetLargestPossibleRegion().GetSize(i) );
+    largestRegion.SetSize( i, image->GetLargestPossibleRegion().GetSize(i) );
+    }
+  io->SetPixelTypeInfo( static_cast< const short * >( 0 ) );
+  // chunks of 3 slices of 40x30 shorts
+  io->SetMaximumChunkSizeInBytes(40 * 30 * sizeof( short ) * 4);
+  const unsigned int numberOfSplits = io->GetActualNumberOfSplitsForWriting(4, largestRegion, largestRegion);
+  if ( numberOfSplits != 4 )
+    {
+    std::cerr << numberOfSplits << " pieces instead of 4" << std::endl;
+    status = EXIT_FAILURE;
+    }
+  itk::SizeValueType next = 0;
+  for ( unsigned int piece = 0; piece < numberOfSplits; piece++ )
+    {
+    const itk::ImageIORegion split =
+      io->GetSplitRegionForWriting(piece, numberOfSplits, largestRegion, largestRegion);
+    if ( split.GetIndex(2) != static_cast< itk::OffsetValueType >( next ) || split.GetIndex(2) % 3 != 0 )
+      {
+      std::cerr << "Piece " << piece << " is " << split << std::endl;
+      status = EXIT_FAILURE;
+      }
+    next += split.GetSize(2);
+    }
+  if ( next != 20 )
+    {
+    std::cerr << "The pieces hold " << next << " slices instead of 20" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageSeriesReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkHDF5ImageIOFactory.h"
+#include <sstream>
+
+// Read a series of compressed HDF5 slices with one and several threads:
+// the readers of the slices share the lock of the HDF5 library.
+
+typedef itk::Image< short, 2 >               SliceType;
+typedef itk::Image< short, 3 >               VolumeType;
+typedef itk::ImageSeriesReader< VolumeType > SeriesReaderType;
+
+static short ExpectedPixel(long slice, long x, long y)
+{
+  return static_cast< short >( 1000 * slice + x + 20 * y );
+}
+
+int itkHDF5ImageSeriesReaderThreadsTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkIOTests itkHDF5ImageSeriesReaderThreadsTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ObjectFactoryBase::RegisterFactory( itk::HDF5ImageIOFactory::New() );
+
+  const unsigned int numberOfSlices = 12;
+
+  SliceType::SizeType size;
+  size[0] = 37;
+  size[1] = 29;
+
+  typedef itk::ImageFileWriter< SliceType > WriterType;
+  SeriesReaderType::FileNamesContainer fileNames;
+  try
+    {
+    for ( unsigned int i = 0; i < numberOfSlices; i++ )
+      {
+      SliceType::Pointer slice = SliceType::New();
+      slice->SetRegions(size);
+      slice->Allocate();
+      itk::ImageRegionIteratorWithIndex< SliceType > it( slice, slice->GetBufferedRegion() );
+      for ( ; !it.IsAtEnd(); ++it )
+        {
+        it.Set( ExpectedPixel(i, it.GetIndex()[0], it.GetIndex()[1]) );
+        }
+
+      std::ostringstream fileName;
+      fileName << av[1] << "/itkHDF5ImageSeriesReaderThreadsTest" << i << ".h5";
+      fileNames.push_back( fileName.str() );
+
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetInput(slice);
+      writer->SetFileName( fileName.str() );
+      writer->UseCompressionOn();
+      writer->Update();
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  int status = EXIT_SUCCESS;
+  const unsigned int threads[3] = { 1, 4, 8 };
+  for ( unsigned int t = 0; t < 3; t++ )
+    {
+    // several passes, to give the threads a chance to overlap
+    for ( unsigned int pass = 0; pass < 4; pass++ )
+      {
+      SeriesReaderType::Pointer reader = SeriesReaderType::New();
+      reader->SetFileNames(fileNames);
+      reader->SetNumberOfThreads(threads[t]);
+      try
+        {
+        reader->Update();
+        }
+      catch ( itk::ExceptionObject & ex )
+        {
+        std::cerr << ex << " with " << threads[t] << " threads" << std::endl;
+        return EXIT_FAILURE;
+        }
+
+      VolumeType::Pointer volume = reader->GetOutput();
+      if ( volume->GetLargestPossibleRegion().GetSize(2) != numberOfSlices )
+        {
+        std::cerr << "The volume has " << volume->GetLargestPossibleRegion().GetSize(2)
+                  << " slices instead of " << numberOfSlices << std::endl;
+        return EXIT_FAILURE;
+        }
+      itk::ImageRegionIteratorWithIndex< VolumeType > it( volume, volume->GetBufferedRegion() );
+      for ( ; !it.IsAtEnd(); ++it )
+        {
+        const VolumeType::IndexType index = it.GetIndex();
+        if ( it.Get() != ExpectedPixel(index[2], index[0], index[1]) )
+          {
+          std::cerr << "Pixel " << index << " is " << it.Get() << " instead of "
+                    << ExpectedPixel(index[2], index[0], index[1])
+                    << " with " << threads[t] << " threads" << std::endl;
+          status = EXIT_FAILURE;
+          break;
+          }
+        }
+      }
+    }
+
+  return status;
+}
@@ -33,6 +33,15 @@ namespace itk
  *
  *  \brief Read MetaImage file format.
  *
+ *  When UseCompression is on and CompressionBlockSize is not 0, the
+ *  image is cut in blocks of CompressionBlockSize bytes which are
+ *  compressed independently by up to NumberOfThreads threads. The
+ *  blocks are written as a single zlib stream, so the file can still be
+ *  read by any MetaImage reader, followed by the offsets of the blocks
+ *  in that stream. When such a file is read, the blocks are
+ *  decompressed by several threads, and a region of the image is read
+ *  by decompressing only the blocks which hold it.
+ *
  *  \ingroup IOFilters
  * \ingroup ITK-IO-Meta
  */
@@ -118,11 +127,12 @@ public:
                            const ImageIORegion & largestPossibleRegion);
 
   /** Determine if the ImageIO can stream reading from this
-   *  file. Only time cannot stream read/write is if compression is used.
+   *  file. Only time cannot stream read/write is if compression is used,
+   *  unless the file is compressed by blocks.
    *  CanRead must be called prior to this function. */
   virtual bool CanStreamRead()
   {
-    if ( m_MetaImage.CompressedData() )
+    if ( m_MetaImage.CompressedData() && m_FileCompressionBlockSize == 0 )
       {
       return false;
       }
@@ -148,19 +158,51 @@ public:
    * \warning this is only used when streaming is on. */
   itkSetMacro(SubSamplingFactor, unsigned int);
   itkGetConstMacro(SubSamplingFactor, unsigned int);
+
+  /** Set/Get the size in bytes of the blocks of the image which are
+   * compressed independently when UseCompression is on. 0, the default,
+   * compresses the image as a single block. */
+  itkSetMacro(CompressionBlockSize, SizeValueType);
+  itkGetConstMacro(CompressionBlockSize, SizeValueType);
+
 protected:
   MetaImageIO();
   ~MetaImageIO();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
 private:
+  /** A MetaImage which writes element data compressed by blocks. */
+  class BlockCompressedMetaImage:public MetaImage
+  {
+public:
+    /** Write the header and the compressed data, which are made of a
+     * zlib stream of compressedDataSize bytes followed by the offsets
+     * of the blocks in the stream. */
+    bool WriteCompressedData(const char *headerName, const unsigned char *data,
+                             std::streamoff dataSize, std::streamoff compressedDataSize,
+                             SizeValueType blockSize);
+
+    std::streamoff GetCompressedDataSize() const
+    {
+      return m_CompressedDataSize;
+    }
+  };
+
+  /** Write the whole image compressed by blocks. */
+  void WriteCompressedBlocks(const void *buffer);
 
-  MetaImage m_MetaImage;
+  /** Read the IO region of an image compressed by blocks. */
+  void ReadCompressedBlocks(void *buffer);
+
+  BlockCompressedMetaImage m_MetaImage;
 
   MetaImageIO(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
 
   unsigned int m_SubSamplingFactor;
+
+  SizeValueType m_CompressionBlockSize;
+  SizeValueType m_FileCompressionBlockSize;
 };
 } // end namespace itk
 
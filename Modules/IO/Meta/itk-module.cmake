@@ -1,2 +1,2 @@
-itk_module(ITK-IO-Meta DEPENDS ITK-MetaIO ITK-IO-Base TEST_DEPENDS ITK-TestKernel ITK-Smoothing)
+itk_module(ITK-IO-Meta DEPENDS ITK-MetaIO ITK-IO-Base ITK-ZLIB TEST_DEPENDS ITK-TestKernel ITK-Smoothing)
 # Extra test dependency of  ITk-Smoothing is caused by itkMetaStreamingIOTest.
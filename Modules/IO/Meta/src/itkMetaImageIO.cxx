@@ -26,14 +26,159 @@
 #include "itkSpatialOrientationAdapter.h"
 #include "itkMetaDataObject.h"
 #include "itkIOCommon.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkByteSwapper.h"
 #include "itksys/SystemTools.hxx"
+#include "itk_zlib.h"
 
 namespace itk
 {
+namespace
+{
+// header field which holds the size of the blocks compressed
+// independently
+const char *const CompressionBlockSizeField = "CompressedDataBlockSize";
+
+/** The blocks of an image which are compressed or decompressed by the
+ * threads. */
+struct CompressedBlocksThreadStruct
+{
+  bool ( *ProcessBlock )(CompressedBlocksThreadStruct *, SizeValueType);
+
+  // the uncompressed image
+  unsigned char *Data;
+  SizeValueType  DataSize;
+  SizeValueType  BlockSize;
+
+  // the blocks compressed, and their checksums
+  std::vector< std::vector< unsigned char > > *CompressedBlocks;
+  std::vector< uLong > *                       Checksums;
+
+  // the blocks read from the zlib stream, where Offsets[b] is the end
+  // of block b, and Data holds the blocks from FirstBlock
+  const unsigned char *              CompressedData;
+  std::streamoff                     CompressedDataOffset;
+  const std::vector< std::streamoff > *Offsets;
+  SizeValueType                      FirstBlock;
+
+  SimpleFastMutexLock Lock;
+  SizeValueType       NextBlock;
+  SizeValueType       LastBlock;
+  bool                Failed;
+};
+
+SizeValueType GetBlockSize(const CompressedBlocksThreadStruct *str, SizeValueType block)
+{
+  return std::min( str->BlockSize, str->DataSize - block * str->BlockSize );
+}
+
+/** Deflate a block alone, ending with a sync flush so the blocks can
+ * be concatenated, or with the end of the stream for the last one. */
+bool CompressBlock(CompressedBlocksThreadStruct *str, SizeValueType block)
+{
+  const SizeValueType  size = GetBlockSize(str, block);
+  unsigned char *      data = str->Data + block * str->BlockSize;
+  const bool           lastBlock = ( block + 1 ) * str->BlockSize >= str->DataSize;
+
+  z_stream z;
+  z.zalloc = Z_NULL;
+  z.zfree = Z_NULL;
+  z.opaque = Z_NULL;
+  if ( deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK )
+    {
+    return false;
+    }
+
+  std::vector< unsigned char > & compressed = ( *str->CompressedBlocks )[block];
+  compressed.resize(deflateBound(&z, size) + 64);
+  z.next_in = data;
+  z.avail_in = static_cast< uInt >( size );
+  z.next_out = &compressed[0];
+  z.avail_out = static_cast< uInt >( compressed.size() );
+  const int  result = deflate(&z, lastBlock ? Z_FINISH : Z_SYNC_FLUSH);
+  const bool done = lastBlock ? result == Z_STREAM_END : ( result == Z_OK && z.avail_out > 0 );
+  compressed.resize(z.total_out);
+  deflateEnd(&z);
+
+  ( *str->Checksums )[block] = adler32(adler32(0L, Z_NULL, 0), data, static_cast< uInt >( size ));
+  return done && z.avail_in == 0;
+}
+
+bool DecompressBlock(CompressedBlocksThreadStruct *str, SizeValueType block)
+{
+  const std::streamoff begin = block == 0 ? 2 : ( *str->Offsets )[block - 1];
+  const std::streamoff end = ( *str->Offsets )[block];
+  const SizeValueType  size = GetBlockSize(str, block);
+
+  z_stream z;
+  z.zalloc = Z_NULL;
+  z.zfree = Z_NULL;
+  z.opaque = Z_NULL;
+  z.next_in = const_cast< unsigned char * >( str->CompressedData + begin - str->CompressedDataOffset );
+  z.avail_in = static_cast< uInt >( end - begin );
+  if ( inflateInit2(&z, -MAX_WBITS) != Z_OK )
+    {
+    return false;
+    }
+  z.next_out = str->Data + ( block - str->FirstBlock ) * str->BlockSize;
+  z.avail_out = static_cast< uInt >( size );
+  const int result = inflate(&z, Z_SYNC_FLUSH);
+  inflateEnd(&z);
+  return ( result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR ) && z.avail_out == 0;
+}
+
+ITK_THREAD_RETURN_TYPE CompressedBlocksThreaderCallback(void *arg)
+{
+  CompressedBlocksThreadStruct *str = (CompressedBlocksThreadStruct *)
+                                      ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  for (;; )
+    {
+    str->Lock.Lock();
+    if ( str->Failed || str->NextBlock > str->LastBlock )
+      {
+      str->Lock.Unlock();
+      break;
+      }
+    const SizeValueType block = str->NextBlock++;
+    str->Lock.Unlock();
+
+    if ( !str->ProcessBlock(str, block) )
+      {
+      str->Lock.Lock();
+      str->Failed = true;
+      str->Lock.Unlock();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Process the blocks from NextBlock to LastBlock with up to
+ * numberOfThreads threads. */
+bool ProcessCompressedBlocks(CompressedBlocksThreadStruct & str, int numberOfThreads)
+{
+  str.Failed = false;
+  MultiThreader::Pointer threader = MultiThreader::New();
+  const SizeValueType    numberOfBlocks = str.LastBlock - str.NextBlock + 1;
+  threader->SetNumberOfThreads(numberOfThreads);
+  if ( numberOfBlocks < static_cast< SizeValueType >( threader->GetNumberOfThreads() ) )
+    {
+    threader->SetNumberOfThreads( static_cast< int >( numberOfBlocks ) );
+    }
+  threader->SetSingleMethod(CompressedBlocksThreaderCallback, &str);
+  threader->SingleMethodExecute();
+  return !str.Failed;
+}
+} // end anonymous namespace
+
 MetaImageIO::MetaImageIO()
 {
   m_FileType = Binary;
   m_SubSamplingFactor = 1;
+  m_CompressionBlockSize = 0;
+  m_FileCompressionBlockSize = 0;
   if ( MET_SystemByteOrderMSB() )
     {
     m_ByteOrder = BigEndian;
@@ -58,6 +203,7 @@ void MetaImageIO::PrintSelf(std::ostream & os, Indent indent) const
   Superclass::PrintSelf(os, indent);
   m_MetaImage.PrintInfo();
   os << indent << "SubSamplingFactor: " << m_SubSamplingFactor << "\n";
+  os << indent << "CompressionBlockSize: " << m_CompressionBlockSize << "\n";
 }
 
 void MetaImageIO::SetDataFileName(const char *filename)
@@ -84,6 +230,7 @@ bool MetaImageIO::CanReadFile(const char *filename)
 
 void MetaImageIO::ReadImageInformation()
 {
+  m_FileCompressionBlockSize = 0;
   if ( !m_MetaImage.Read(m_FileName.c_str(), false) )
     {
     itkExceptionMacro( "File cannot be read: "
@@ -832,6 +979,15 @@ void MetaImageIO::ReadImageInformation()
     {
     std::string key( m_MetaImage.GetAdditionalReadFieldName(f) );
     std::string value ( m_MetaImage.GetAdditionalReadFieldValue(f) );
+    if ( key == CompressionBlockSizeField )
+      {
+      if ( m_MetaImage.BinaryData() && m_MetaImage.CompressedData() )
+        {
+        std::istringstream blockSize(value);
+        blockSize >> m_FileCompressionBlockSize;
+        }
+      continue;
+      }
     EncapsulateMetaData< std::string >( thisMetaDict,key,value );
     }
 
@@ -870,7 +1026,11 @@ void MetaImageIO::Read(void *buffer)
     largestRegion.SetSize( i, this->GetDimensions(i) );
     }
 
-  if ( largestRegion != m_IORegion )
+  if ( m_FileCompressionBlockSize > 0 && m_SubSamplingFactor == 1 )
+    {
+    this->ReadCompressedBlocks(buffer);
+    }
+  else if ( largestRegion != m_IORegion )
     {
     int *indexMin = new int[nDims];
     int *indexMax = new int[nDims];
@@ -1507,6 +1667,13 @@ MetaImageIO
     delete[] indexMin;
     delete[] indexMax;
     }
+  else if ( m_UseCompression && binaryData && m_CompressionBlockSize > 0
+            && this->GetImageSizeInBytes() > 0
+            && !strchr(m_MetaImage.ElementDataFileName(), '%')
+            && strcmp(m_MetaImage.ElementDataFileName(), "LIST") )
+    {
+    this->WriteCompressedBlocks(buffer);
+    }
   else
     {
     if ( !m_MetaImage.Write( m_FileName.c_str() ) )
@@ -1686,4 +1853,283 @@ MetaImageIO::GetSplitRegionForWriting( unsigned int ithPiece,
 {
   return GetSplitRegionForWritingCanStreamWrite(ithPiece, numberOfActualSplits, pasteRegion);
 }
+
+void MetaImageIO::WriteCompressedBlocks(const void *buffer)
+{
+  CompressedBlocksThreadStruct str;
+  str.ProcessBlock = CompressBlock;
+  str.Data = static_cast< unsigned char * >( const_cast< void * >( buffer ) );
+  str.DataSize = this->GetImageSizeInBytes();
+  str.BlockSize = m_CompressionBlockSize;
+
+  const SizeValueType                         numberOfBlocks = ( str.DataSize + str.BlockSize - 1 ) / str.BlockSize;
+  std::vector< std::vector< unsigned char > > compressedBlocks(numberOfBlocks);
+  std::vector< uLong >                        checksums(numberOfBlocks);
+  str.CompressedBlocks = &compressedBlocks;
+  str.Checksums = &checksums;
+  str.NextBlock = 0;
+  str.LastBlock = numberOfBlocks - 1;
+  if ( !ProcessCompressedBlocks( str, this->GetNumberOfThreads() ) )
+    {
+    itkExceptionMacro("Unable to compress the image for: " << this->GetFileName());
+    }
+
+  // a single zlib stream, made of the header, the blocks and the
+  // checksum of the image, followed by the offsets of the ends of the
+  // blocks in the stream
+  std::streamoff compressedDataSize = 2 + 4;
+  for ( SizeValueType b = 0; b < numberOfBlocks; b++ )
+    {
+    compressedDataSize += compressedBlocks[b].size();
+    }
+  std::vector< unsigned char > data;
+  data.reserve(compressedDataSize + 8 * numberOfBlocks);
+  data.push_back(0x78);
+  data.push_back(0x9c);
+
+  std::vector< std::streamoff > offsets(numberOfBlocks);
+  uLong                         checksum = checksums[0];
+  for ( SizeValueType b = 0; b < numberOfBlocks; b++ )
+    {
+    data.insert( data.end(), compressedBlocks[b].begin(), compressedBlocks[b].end() );
+    std::vector< unsigned char >().swap(compressedBlocks[b]);
+    offsets[b] = data.size();
+    if ( b > 0 )
+      {
+      checksum = adler32_combine( checksum, checksums[b],
+                                  static_cast< z_off_t >( GetBlockSize(&str, b) ) );
+      }
+    }
+  for ( int i = 3; i >= 0; i-- )
+    {
+    data.push_back( static_cast< unsigned char >( ( checksum >> ( 8 * i ) ) & 0xff ) );
+    }
+  for ( SizeValueType b = 0; b < numberOfBlocks; b++ )
+    {
+    for ( unsigned int i = 0; i < 8; i++ )
+      {
+      data.push_back( static_cast< unsigned char >( ( static_cast< unsigned long long >( offsets[b] )
+                                                      >> ( 8 * i ) ) & 0xff ) );
+      }
+    }
+
+  if ( !m_MetaImage.WriteCompressedData(m_FileName.c_str(), &data[0], data.size(),
+                                        compressedDataSize, m_CompressionBlockSize) )
+    {
+    itkExceptionMacro( "File cannot be written: "
+                       << this->GetFileName()
+                       << std::endl
+                       << "Reason: "
+                       << itksys::SystemTools::GetLastSystemError() );
+    }
+}
+
+void MetaImageIO::ReadCompressedBlocks(void *buffer)
+{
+  const unsigned int  nDims = this->GetNumberOfDimensions();
+  const SizeValueType dataSize = this->GetImageSizeInBytes();
+  const SizeValueType blockSize = m_FileCompressionBlockSize;
+  const SizeValueType numberOfBlocks = ( dataSize + blockSize - 1 ) / blockSize;
+
+  // the compressed data and the offsets are at the end of the file
+  std::string dataFileName = m_MetaImage.ElementDataFileName();
+  if ( dataFileName == "LOCAL" )
+    {
+    dataFileName = m_FileName;
+    }
+  else if ( !itksys::SystemTools::FileIsFullPath( dataFileName.c_str() ) )
+    {
+    const std::string path = itksys::SystemTools::GetFilenamePath(m_FileName);
+    if ( !path.empty() )
+      {
+      dataFileName = path + "/" + dataFileName;
+      }
+    }
+  std::ifstream file(dataFileName.c_str(), std::ios::in | std::ios::binary);
+  file.seekg(0, std::ios::end);
+  const std::streamoff compressedDataSize = m_MetaImage.GetCompressedDataSize();
+  const std::streamoff dataOffset = static_cast< std::streamoff >( file.tellg() )
+                                    - compressedDataSize - 8 * numberOfBlocks;
+  if ( !file || compressedDataSize <= 0 || dataOffset < 0 )
+    {
+    itkExceptionMacro("Unable to find the compressed blocks in: " << dataFileName);
+    }
+
+  std::vector< unsigned char > offsetBytes(8 * numberOfBlocks);
+  file.seekg(dataOffset + compressedDataSize);
+  file.read( reinterpret_cast< char * >( &offsetBytes[0] ), offsetBytes.size() );
+  std::vector< std::streamoff > offsets(numberOfBlocks);
+  std::streamoff                previousOffset = 2;
+  for ( SizeValueType b = 0; b < numberOfBlocks; b++ )
+    {
+    unsigned long long offset = 0;
+    for ( unsigned int i = 0; i < 8; i++ )
+      {
+      offset |= static_cast< unsigned long long >( offsetBytes[8 * b + i] ) << ( 8 * i );
+      }
+    offsets[b] = static_cast< std::streamoff >( offset );
+    if ( offsets[b] < previousOffset || offsets[b] > compressedDataSize - 4 )
+      {
+      itkExceptionMacro("Invalid offsets of the compressed blocks in: " << dataFileName);
+      }
+    previousOffset = offsets[b];
+    }
+
+  // the blocks which hold the first and the last pixels of the region
+  ImageIORegion largestRegion(nDims);
+  std::vector< SizeValueType > strides(nDims);
+  SizeValueType                firstByte = 0;
+  SizeValueType                lastByte = 0;
+  for ( unsigned int i = 0; i < nDims; i++ )
+    {
+    largestRegion.SetIndex(i, 0);
+    largestRegion.SetSize( i, this->GetDimensions(i) );
+    strides[i] = i == 0 ? this->GetPixelSize() : strides[i - 1] * this->GetDimensions(i - 1);
+    firstByte += m_IORegion.GetIndex(i) * strides[i];
+    lastByte += ( m_IORegion.GetIndex(i) + m_IORegion.GetSize(i) - 1 ) * strides[i];
+    }
+  lastByte += this->GetPixelSize() - 1;
+  const bool readLargestRegion = ( m_IORegion == largestRegion );
+
+  CompressedBlocksThreadStruct str;
+  str.ProcessBlock = DecompressBlock;
+  str.DataSize = dataSize;
+  str.BlockSize = blockSize;
+  str.Offsets = &offsets;
+  str.FirstBlock = firstByte / blockSize;
+  str.NextBlock = str.FirstBlock;
+  str.LastBlock = lastByte / blockSize;
+
+  str.CompressedDataOffset = str.FirstBlock == 0 ? 2 : offsets[str.FirstBlock - 1];
+  std::vector< unsigned char > compressedData(offsets[str.LastBlock] - str.CompressedDataOffset);
+  file.seekg(dataOffset + str.CompressedDataOffset);
+  file.read( reinterpret_cast< char * >( &compressedData[0] ), compressedData.size() );
+  if ( !file )
+    {
+    itkExceptionMacro("Unable to read the compressed blocks in: " << dataFileName);
+    }
+  str.CompressedData = &compressedData[0];
+
+  // the blocks of the whole image are decompressed in the buffer
+  std::vector< unsigned char > blocks;
+  if ( readLargestRegion )
+    {
+    str.Data = static_cast< unsigned char * >( buffer );
+    }
+  else
+    {
+    blocks.resize( std::min( ( str.LastBlock + 1 ) * blockSize, dataSize ) - str.FirstBlock * blockSize );
+    str.Data = &blocks[0];
+    }
+  if ( !ProcessCompressedBlocks( str, this->GetNumberOfThreads() ) )
+    {
+    itkExceptionMacro("Unable to decompress the blocks in: " << dataFileName);
+    }
+
+  if ( !readLargestRegion )
+    {
+    // copy the rows of the region
+    const SizeValueType          rowSize = m_IORegion.GetSize(0) * this->GetPixelSize();
+    const SizeValueType          numberOfRows = m_IORegion.GetNumberOfPixels() / m_IORegion.GetSize(0);
+    std::vector< SizeValueType > index(nDims, 0);
+    unsigned char *              out = static_cast< unsigned char * >( buffer );
+    for ( SizeValueType r = 0; r < numberOfRows; r++ )
+      {
+      SizeValueType offset = m_IORegion.GetIndex(0) * strides[0];
+      for ( unsigned int i = 1; i < nDims; i++ )
+        {
+        offset += ( m_IORegion.GetIndex(i) + index[i] ) * strides[i];
+        }
+      memcpy(out, &blocks[offset - str.FirstBlock * blockSize], rowSize);
+      out += rowSize;
+      for ( unsigned int i = 1; i < nDims; i++ )
+        {
+        if ( ++index[i] < m_IORegion.GetSize(i) )
+          {
+          break;
+          }
+        index[i] = 0;
+        }
+      }
+    }
+
+  // the data are written in the byte order of the system
+  if ( m_MetaImage.BinaryDataByteOrderMSB() != ByteSwapper< int >::SystemIsBigEndian() )
+    {
+    m_MetaImage.ElementData(buffer, false);
+    m_MetaImage.ElementByteOrderFix( m_IORegion.GetNumberOfPixels() );
+    }
+}
+
+bool MetaImageIO::BlockCompressedMetaImage::WriteCompressedData(const char *headerName,
+                                                                const unsigned char *data,
+                                                                std::streamoff dataSize,
+                                                                std::streamoff compressedDataSize,
+                                                                SizeValueType blockSize)
+{
+  FileName(headerName);
+
+  // name the data file as MetaImage::Write
+  const bool userDataFileName = strlen(m_ElementDataFileName) > 0;
+  if ( !userDataFileName )
+    {
+    int suffix = 0;
+    MET_GetFileSuffixPtr(m_FileName, &suffix);
+    if ( !strcmp(&m_FileName[suffix], "mha") )
+      {
+      ElementDataFileName("LOCAL");
+      }
+    else
+      {
+      MET_SetFileSuffix(m_FileName, "mhd");
+      strcpy(m_ElementDataFileName, m_FileName);
+      MET_SetFileSuffix(m_ElementDataFileName, "zraw");
+      }
+    }
+  MET_SetFileSuffix(m_FileName, strcmp(m_ElementDataFileName, "LOCAL") ? "mhd" : "mha");
+
+  char pathName[2048];
+  if ( MET_GetFilePath(m_FileName, pathName) )
+    {
+    char elementPathName[2048];
+    MET_GetFilePath(m_ElementDataFileName, elementPathName);
+    if ( !strcmp(pathName, elementPathName) )
+      {
+      strcpy(elementPathName, &m_ElementDataFileName[strlen(pathName)]);
+      strcpy(m_ElementDataFileName, elementPathName);
+      }
+    }
+
+  METAIO_STREAM::ofstream stream;
+  stream.open(m_FileName, METAIO_STREAM::ios::binary | METAIO_STREAM::ios::out
+              | METAIO_STREAM::ios::trunc);
+  bool result = stream.is_open();
+  if ( result )
+    {
+    m_WriteStream = &stream;
+    m_CompressedDataSize = compressedDataSize;
+    M_SetupWriteFields();
+
+    // the size of the blocks goes before the ElementDataFile, which
+    // must be the last field
+    std::ostringstream blockSizeValue;
+    blockSizeValue << blockSize;
+    MET_FieldRecordType *field = new MET_FieldRecordType;
+    MET_InitWriteField( field, CompressionBlockSizeField, MET_STRING,
+                        blockSizeValue.str().size(), blockSizeValue.str().c_str() );
+    m_Fields.insert(m_Fields.empty() ? m_Fields.end() : m_Fields.end() - 1, field);
+
+    result = M_Write() && M_WriteElements(&stream, data, dataSize);
+    m_WriteStream = NULL;
+    m_CompressedDataSize = 0;
+    stream.close();
+    result = result && !stream.fail();
+    }
+
+  if ( !userDataFileName )
+    {
+    ElementDataFileName("");
+    }
+  return result;
+}
 } // end namespace itk
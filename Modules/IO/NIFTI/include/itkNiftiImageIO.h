@@ -35,12 +35,21 @@
 
 namespace itk
 {
+class NiftiGzipIndex;
+
 /** \class NiftiImageIO
  *
  * \author Hans J. Johnson
  * \brief Class that defines how to read Nifti file format.
  * Nifti IMAGE FILE FORMAT - As much information as I can determine from sourceforge.net/projects/Niftilib
  *
+ * Regions, such as one volume of a 4D series, are read without reading
+ * the rest of the file. In compressed files, the points from which the
+ * decompression can restart are recorded as the file is read, so that
+ * the following regions are decompressed from the closest point instead
+ * of from the start of the file. Uncompressed files with pixels stored
+ * as in ITK can also be written by pieces, or pasted into.
+ *
  * \ingroup IOFilters
  * \ingroup ITK-IO-NIFTI
  */
@@ -91,11 +100,27 @@ public:
    * that the IORegions has been set properly. */
   virtual void Write(const void *buffer);
 
+  /** Any region can be read. */
+  virtual bool CanStreamRead()
+  {
+    return true;
+  }
+
   /** Calculate the region of the image that can be efficiently read
    *  in response to a given requested region. */
   virtual ImageIORegion
   GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const;
 
+  /** Uncompressed images of scalar, complex, RGB or RGBA pixels can be
+   * written by pieces, and pasted into an existing file. */
+  virtual bool CanStreamWrite();
+
+  /** Removes the existing file when the whole image is streamed, checks
+   * that it matches the image when pasting into it. */
+  virtual unsigned int GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                                         const ImageIORegion & pasteRegion,
+                                                         const ImageIORegion & largestPossibleRegion);
+
   /** A mode to allow the Nifti filter to read and write to the LegacyAnalyze75 format as interpreted by
     * the nifti library maintainers.  This format does not properly respect the file orientation fields.
     * The itkAnalyzeImageIO file reader/writer should be used to match the Analyze75 file definitions as
@@ -120,8 +145,14 @@ private:
 
   void  SetImageIOMetadataFromNIfTI();
 
+  /** Write the IORegion of an image which can be streamed. */
+  void  WriteRegion(const void *buffer);
+
   nifti_image *m_NiftiImage;
 
+  /** Random access into the data of compressed files. */
+  NiftiGzipIndex *m_GzipIndex;
+
   double m_RescaleSlope;
   double m_RescaleIntercept;
 
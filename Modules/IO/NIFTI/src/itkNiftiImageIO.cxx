@@ -348,10 +348,266 @@ int SymMatDim(int count)
   return dim;
 }
 
+//
+// Random access into a gzip file, as in examples/zran.c of zlib. The
+// points at which the decompression can restart, with the 32 KB of data
+// preceding them, are recorded once every Span bytes of decompressed data
+// as the file is read. A read starts from the closest point before it,
+// or carries on from where the previous read stopped when that is closer,
+// so that the pieces of a streamed image are decompressed only once.
+class NiftiGzipIndex
+{
+public:
+  NiftiGzipIndex():
+    m_File(0),
+    m_FileSize(0),
+    m_ModificationTime(0),
+    m_Span(0),
+    m_StreamActive(false),
+    m_InputPosition(0),
+    m_OutputPosition(0),
+    m_WindowPosition(0)
+  {}
+
+  ~NiftiGzipIndex()
+  {
+    this->Close();
+    this->Clear();
+  }
+
+  // Open the file, forgetting the recorded points if it is another file
+  // or if it changed. dataSize is the size of the decompressed file.
+  bool Open(const char *fileName, size_t dataSize)
+  {
+    const unsigned long fileSize = itksys::SystemTools::FileLength(fileName);
+    const long int      modificationTime = itksys::SystemTools::ModifiedTime(fileName);
+
+    if ( m_FileName != fileName || m_FileSize != fileSize || m_ModificationTime != modificationTime )
+      {
+      this->Clear();
+      m_FileName = fileName;
+      m_FileSize = fileSize;
+      m_ModificationTime = modificationTime;
+      // at most 1024 points of 32 KB each
+      m_Span = vnl_math_max( static_cast< size_t >( 1 << 20 ), dataSize / 1024 );
+      }
+    m_File = fopen(fileName, "rb");
+    if ( m_File == 0 )
+      {
+      return false;
+      }
+    // carry on from where the previous read stopped
+    if ( m_StreamActive && fseek(m_File, static_cast< long >( m_InputPosition ), SEEK_SET) != 0 )
+      {
+      this->EndStream();
+      }
+    return true;
+  }
+
+  void Close()
+  {
+    if ( m_File != 0 )
+      {
+      fclose(m_File);
+      m_File = 0;
+      }
+  }
+
+  // Read length bytes from offset in the decompressed file.
+  bool Read(size_t offset, size_t length, char *out)
+  {
+    // the last point before offset
+    const AccessPoint *point = 0;
+    for ( size_t p = m_Points.size(); p > 0; p-- )
+      {
+      if ( m_Points[p - 1]->Output <= offset )
+        {
+        point = m_Points[p - 1];
+        break;
+        }
+      }
+    if ( !m_StreamActive || offset < m_OutputPosition
+         || ( point != 0 && point->Output > m_OutputPosition ) )
+      {
+      if ( !this->Restart(point) )
+        {
+        return false;
+        }
+      }
+
+    const size_t end = offset + length;
+    while ( m_OutputPosition < end )
+      {
+      if ( m_Stream.avail_in == 0 )
+        {
+        const size_t numberOfBytes = fread(m_Input, 1, InputSize, m_File);
+        if ( numberOfBytes == 0 )
+          {
+          this->EndStream();
+          return false;
+          }
+        m_InputPosition += numberOfBytes;
+        m_Stream.avail_in = static_cast< uInt >( numberOfBytes );
+        m_Stream.next_in = m_Input;
+        }
+      if ( m_WindowPosition == WindowSize )
+        {
+        m_WindowPosition = 0;
+        }
+      m_Stream.avail_out = static_cast< uInt >( WindowSize - m_WindowPosition );
+      m_Stream.next_out = m_Window + m_WindowPosition;
+
+      // stop at the end of each deflate block, where a point may be
+      // recorded
+      const int ret = inflate(&m_Stream, Z_BLOCK);
+      if ( ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR )
+        {
+        this->EndStream();
+        return false;
+        }
+
+      const size_t produced = WindowSize - m_WindowPosition - m_Stream.avail_out;
+      const size_t first = vnl_math_max(m_OutputPosition, offset);
+      const size_t last = vnl_math_min(m_OutputPosition + produced, end);
+      if ( first < last )
+        {
+        memcpy(out + ( first - offset ), m_Window + m_WindowPosition + ( first - m_OutputPosition ), last - first);
+        }
+      m_WindowPosition += produced;
+      m_OutputPosition += produced;
+
+      if ( ret == Z_STREAM_END )
+        {
+        this->EndStream();
+        return m_OutputPosition >= end;
+        }
+      // at the end of a block which is not the last one
+      if ( ( m_Stream.data_type & 128 ) && !( m_Stream.data_type & 64 )
+           && m_OutputPosition >= ( m_Points.empty() ? 0 : m_Points.back()->Output ) + m_Span )
+        {
+        this->AddPoint();
+        }
+      }
+    return true;
+  }
+
+private:
+  static const size_t WindowSize = 32768;
+  static const size_t InputSize = 16384;
+
+  struct AccessPoint {
+    size_t Output;
+    size_t Input;
+    int Bits;
+    unsigned char Window[WindowSize];
+  };
+
+  void Clear()
+  {
+    this->EndStream();
+    for ( size_t p = 0; p < m_Points.size(); p++ )
+      {
+      delete m_Points[p];
+      }
+    m_Points.clear();
+    m_FileName.clear();
+  }
+
+  void EndStream()
+  {
+    if ( m_StreamActive )
+      {
+      inflateEnd(&m_Stream);
+      m_StreamActive = false;
+      }
+  }
+
+  // start decompressing from point, or from the start of the file
+  bool Restart(const AccessPoint *point)
+  {
+    this->EndStream();
+    m_Stream.zalloc = Z_NULL;
+    m_Stream.zfree = Z_NULL;
+    m_Stream.opaque = Z_NULL;
+    m_Stream.avail_in = 0;
+    m_Stream.next_in = Z_NULL;
+    // a raw deflate stream from a point, the gzip header otherwise
+    if ( inflateInit2( &m_Stream, point != 0 ? -15 : 47 ) != Z_OK )
+      {
+      return false;
+      }
+    m_StreamActive = true;
+    m_WindowPosition = 0;
+    m_OutputPosition = 0;
+    m_InputPosition = 0;
+    if ( point != 0 )
+      {
+      // the point may be in the middle of a byte
+      m_InputPosition = point->Input - ( point->Bits ? 1 : 0 );
+      }
+    if ( fseek(m_File, static_cast< long >( m_InputPosition ), SEEK_SET) != 0 )
+      {
+      this->EndStream();
+      return false;
+      }
+    if ( point != 0 )
+      {
+      if ( point->Bits )
+        {
+        const int c = getc(m_File);
+        if ( c == EOF )
+          {
+          this->EndStream();
+          return false;
+          }
+        m_InputPosition++;
+        inflatePrime(&m_Stream, point->Bits, c >> ( 8 - point->Bits ));
+        }
+      inflateSetDictionary( &m_Stream, point->Window, static_cast< uInt >( WindowSize ) );
+      m_OutputPosition = point->Output;
+      }
+    return true;
+  }
+
+  // record the current position, at the end of a deflate block
+  void AddPoint()
+  {
+    AccessPoint *point = new AccessPoint;
+
+    point->Output = m_OutputPosition;
+    point->Input = m_InputPosition - m_Stream.avail_in;
+    point->Bits = m_Stream.data_type & 7;
+    // the window holds the last WindowSize bytes since m_Span is larger
+    const size_t oldest = WindowSize - m_WindowPosition;
+    memcpy(point->Window, m_Window + m_WindowPosition, oldest);
+    memcpy(point->Window + oldest, m_Window, m_WindowPosition);
+    m_Points.push_back(point);
+  }
+
+  std::string                 m_FileName;
+  FILE *                      m_File;
+  unsigned long               m_FileSize;
+  long int                    m_ModificationTime;
+  size_t                      m_Span;
+  std::vector< AccessPoint * > m_Points;
+
+  z_stream      m_Stream;
+  bool          m_StreamActive;
+  size_t        m_InputPosition;
+  size_t        m_OutputPosition;
+  size_t        m_WindowPosition;
+  unsigned char m_Input[InputSize];
+  unsigned char m_Window[WindowSize];
+};
+
 ImageIORegion
 NiftiImageIO
 ::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const
 {
+  if ( !this->m_UseStreamedReading )
+    {
+    return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requestedRegion);
+    }
   return requestedRegion;
 }
 
@@ -362,6 +618,7 @@ NiftiImageIO::NiftiImageIO():
   m_OnDiskComponentType(UNKNOWNCOMPONENTTYPE),
   m_LegacyAnalyze75Mode(false)
 {
+  this->m_GzipIndex = new NiftiGzipIndex;
   this->SetNumberOfDimensions(3);
   nifti_set_debug_level(0); // suppress error messages
   this->AddSupportedWriteExtension(".nia");
@@ -383,6 +640,7 @@ NiftiImageIO::NiftiImageIO():
 NiftiImageIO::~NiftiImageIO()
 {
   nifti_image_free(this->m_NiftiImage);
+  delete this->m_GzipIndex;
 }
 
 void
@@ -402,6 +660,53 @@ NiftiImageIO
   return ValidFileNameFound;
 }
 
+bool
+NiftiImageIO
+::CanStreamWrite()
+{
+  const unsigned int numComponents = this->GetNumberOfComponents();
+  const bool         sameLayout = ( numComponents == 1
+                                    || ( numComponents == 2 && this->GetPixelType() == COMPLEX )
+                                    || ( numComponents == 3 && this->GetPixelType() == RGB )
+                                    || ( numComponents == 4 && this->GetPixelType() == RGBA ) );
+  const char *extension = nifti_find_file_extension( this->GetFileName() );
+
+  // compressed and ascii files are written at once
+  return sameLayout
+         && extension != NULL && strcmp(extension, ".nia") != 0
+         && !nifti_is_gzfile( this->GetFileName() );
+}
+
+unsigned int
+NiftiImageIO
+::GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                    const ImageIORegion & pasteRegion,
+                                    const ImageIORegion & largestPossibleRegion)
+{
+  if ( !this->CanStreamWrite() )
+    {
+    return Superclass::GetActualNumberOfSplitsForWriting(numberOfRequestedSplits,
+                                                         pasteRegion,
+                                                         largestPossibleRegion);
+    }
+  if ( pasteRegion == largestPossibleRegion && numberOfRequestedSplits != 1 )
+    {
+    // the pieces are pasted into a new file, the existing one may not
+    // match the image
+    this->WriteImageInformation();
+    const char *fileNames[2] = { this->m_NiftiImage->fname, this->m_NiftiImage->iname };
+    for ( unsigned int i = 0; i < 2; i++ )
+      {
+      if ( fileNames[i] != NULL && itksys::SystemTools::FileExists(fileNames[i])
+           && !itksys::SystemTools::RemoveFile(fileNames[i]) )
+        {
+        itkExceptionMacro(<< "Unable to remove file for streaming: " << fileNames[i]);
+        }
+      }
+    }
+  return this->GetActualNumberOfSplitsForWritingCanStreamWrite(numberOfRequestedSplits, pasteRegion);
+}
+
 bool
 NiftiImageIO::MustRescale()
 {
@@ -437,6 +742,171 @@ CastCopy(float *to, void *from, size_t pixelcount)
     }
 }
 
+//
+// Byte swap the voxels read from the file and set the bad floats to 0, as
+// nifti_read_buffer does.
+static void
+SwapAndFixNiftiBuffer(void *buffer, size_t numberOfBytes, const nifti_image *nim)
+{
+  if ( nim->swapsize > 1 && nim->byteorder != nifti_short_order() )
+    {
+    nifti_swap_Nbytes(static_cast< int >( numberOfBytes / nim->swapsize ), nim->swapsize, buffer);
+    }
+  switch ( nim->datatype )
+    {
+    case NIFTI_TYPE_FLOAT32:
+    case NIFTI_TYPE_COMPLEX64:
+      {
+      float *data = static_cast< float * >( buffer );
+      for ( size_t i = 0; i < numberOfBytes / sizeof( float ); i++ )
+        {
+        if ( !vnl_math_isfinite(data[i]) )
+          {
+          data[i] = 0;
+          }
+        }
+      }
+      break;
+    case NIFTI_TYPE_FLOAT64:
+    case NIFTI_TYPE_COMPLEX128:
+      {
+      double *data = static_cast< double * >( buffer );
+      for ( size_t i = 0; i < numberOfBytes / sizeof( double ); i++ )
+        {
+        if ( !vnl_math_isfinite(data[i]) )
+          {
+          data[i] = 0;
+          }
+        }
+      }
+      break;
+    }
+}
+
+//
+// Read the voxels of the region of nim given by origin and size straight
+// into buffer, which must have the on-disk voxel layout. Runs of voxels
+// which are contiguous on disk, the whole image when the region spans it,
+// are read with a single call. Unlike nifti_image_load and
+// nifti_read_subregion_image, niftilib never allocates, keeps or frees the
+// buffer. Compressed files are read through gzipIndex.
+static bool
+ReadNiftiRegionInPlace(nifti_image *nim, const int *origin, const int *size, void *buffer,
+                       NiftiGzipIndex *gzipIndex)
+{
+  for ( int d = 0; d < 7; d++ )
+    {
+    if ( size[d] <= 0 )
+      {
+      // an empty region, nothing to read
+      return true;
+      }
+    }
+
+  char *imageName = nifti_findimgname(nim->iname, nim->nifti_type);
+
+  if ( imageName == 0 )
+    {
+    return false;
+    }
+  const bool compressed = nifti_is_gzfile(imageName) != 0;
+  znzFile    fp = NULL;
+  if ( compressed )
+    {
+    size_t dataSize = static_cast< size_t >( nim->nbyper );
+    for ( int d = 1; d <= nim->ndim; d++ )
+      {
+      dataSize *= static_cast< size_t >( nim->dim[d] );
+      }
+    if ( !gzipIndex->Open(imageName, nim->iname_offset + dataSize) )
+      {
+      free(imageName);
+      return false;
+      }
+    }
+  else
+    {
+    fp = znzopen(imageName, "rb", 0);
+    }
+  free(imageName);
+  if ( !compressed && znz_isnull(fp) )
+    {
+    return false;
+    }
+
+  const int ndim = vnl_math_min(nim->ndim, 7);
+  size_t    strides[7];
+  strides[0] = 1;
+  for ( int d = 1; d < ndim; d++ )
+    {
+    strides[d] = strides[d - 1] * static_cast< size_t >( nim->dim[d] );
+    }
+
+  // the dimensions spanned entirely by the region are read together with
+  // the next one
+  int    outer = 1;
+  size_t run = size[0];
+  while ( outer < ndim && origin[outer - 1] == 0 && size[outer - 1] == nim->dim[outer] )
+    {
+    run *= size[outer];
+    outer++;
+    }
+  const size_t runBytes = run * static_cast< size_t >( nim->nbyper );
+
+  int index[7];
+  for ( int d = 0; d < ndim; d++ )
+    {
+    index[d] = origin[d];
+    }
+  char *out = static_cast< char * >( buffer );
+  bool  ok = true;
+  for (;; )
+    {
+    size_t offset = 0;
+    for ( int d = 0; d < ndim; d++ )
+      {
+      offset += static_cast< size_t >( index[d] ) * strides[d];
+      }
+    const size_t position = nim->iname_offset + offset * nim->nbyper;
+    if ( compressed )
+      {
+      if ( !gzipIndex->Read(position, runBytes, out) )
+        {
+        ok = false;
+        break;
+        }
+      SwapAndFixNiftiBuffer(out, runBytes, nim);
+      }
+    else if ( znzseek(fp, static_cast< long >( position ), SEEK_SET) < 0
+              || nifti_read_buffer(fp, out, runBytes, nim) != runBytes )
+      {
+      ok = false;
+      break;
+      }
+    out += runBytes;
+
+    int d = outer;
+    while ( d < ndim && ++index[d] == origin[d] + size[d] )
+      {
+      index[d] = origin[d];
+      d++;
+      }
+    if ( d >= ndim )
+      {
+      break;
+      }
+    }
+  if ( compressed )
+    {
+    gzipIndex->Close();
+    }
+  else
+    {
+    znzclose(fp);
+    }
+  return ok;
+}
+
 void NiftiImageIO::Read(void *buffer)
 {
   void *data = 0;
@@ -471,8 +941,11 @@ void NiftiImageIO::Read(void *buffer)
     // other dims out of the way
     _size[6] = _size[5];
     _size[5] = _size[4];
+    _origin[6] = _origin[5];
+    _origin[5] = _origin[4];
     // sizes = x y z t vecsize
     _size[4] = numComponents;
+    _origin[4] = 0;
     }
   // Free memory if any was occupied already (incase of re-using the IO filter).
   if ( this->m_NiftiImage != NULL )
@@ -489,36 +962,80 @@ void NiftiImageIO::Read(void *buffer)
     }
 
   //
-  // decide whether to read whole region or subregion, by stepping
-  // thru dims and comparing them to requested sizes
-  for ( i = 0; i < this->GetNumberOfDimensions(); i++ )
-    {
-    if ( this->m_NiftiImage->dim[i + 1] != _size[i] )
+  // if the voxels are neither reordered nor promoted to float, the
+  // nifti layout is the itk layout and the data can be read straight
+  // into the output buffer, without a copy. Otherwise only the region is
+  // read, into a buffer of the on-disk layout.
+  const bool sameLayout = ( numComponents == 1
+                            || this->GetPixelType() == COMPLEX
+                            || this->GetPixelType() == RGB
+                            || this->GetPixelType() == RGBA );
+  if ( this->m_NiftiImage->iname_offset >= 0 )
+    {
+    if ( sameLayout
+         && !( this->MustRescale() && this->m_ComponentType != this->m_OnDiskComponentType ) )
       {
-      break;
+      data = buffer;
       }
-    }
-  // if all dimensions match requested size, just read in
-  // all data as a block
-  if ( i == this->GetNumberOfDimensions() )
-    {
-    if ( nifti_image_load(this->m_NiftiImage) == -1 )
+    else
+      {
+      size_t regionSize = static_cast< size_t >( this->m_NiftiImage->nbyper );
+      for ( i = 0; i < 7; i++ )
+        {
+        regionSize *= static_cast< size_t >( _size[i] );
+        }
+      // malloc, as the buffers allocated by niftilib which are freed below
+      data = malloc(regionSize);
+      if ( data == 0 )
+        {
+        itkExceptionMacro( << "Failed to allocate " << regionSize
+                           << " bytes to read file: " << this->GetFileName() );
+        }
+      }
+    if ( !ReadNiftiRegionInPlace(this->m_NiftiImage, _origin, _size, data, this->m_GzipIndex) )
       {
-      itkExceptionMacro( << "nifti_image_load failed for file: "
+      if ( data != buffer )
+        {
+        free(data);
+        }
+      itkExceptionMacro( << "Reading the image data failed for file: "
                          << this->GetFileName() );
       }
-    data = this->m_NiftiImage->data;
     }
   else
     {
-    // read in a subregion
-    if ( nifti_read_subregion_image(this->m_NiftiImage,
-                                    _origin,
-                                    _size,
-                                    &data) == -1 || this->m_NiftiImage == NULL )
+    //
+    // decide whether to read whole region or subregion, by stepping
+    // thru dims and comparing them to requested sizes
+    for ( i = 0; i < this->GetNumberOfDimensions(); i++ )
       {
-      itkExceptionMacro( << "nifti_read_subregion_image failed for file: "
-                         << this->GetFileName() );
+      if ( this->m_NiftiImage->dim[i + 1] != _size[i] )
+        {
+        break;
+        }
+      }
+    // if all dimensions match requested size, just read in
+    // all data as a block
+    if ( i == this->GetNumberOfDimensions() )
+      {
+      if ( nifti_image_load(this->m_NiftiImage) == -1 )
+        {
+        itkExceptionMacro( << "nifti_image_load failed for file: "
+                           << this->GetFileName() );
+        }
+      data = this->m_NiftiImage->data;
+      }
+    else
+      {
+      // read in a subregion
+      if ( nifti_read_subregion_image(this->m_NiftiImage,
+                                      _origin,
+                                      _size,
+                                      &data) == -1 || this->m_NiftiImage == NULL )
+        {
+        itkExceptionMacro( << "nifti_read_subregion_image failed for file: "
+                           << this->GetFileName() );
+        }
       }
     }
   unsigned int pixelSize = this->m_NiftiImage->nbyper;
@@ -537,7 +1054,7 @@ void NiftiImageIO::Read(void *buffer)
 
     // Deal with correct management of 64bits platforms
     const size_t imageSizeInComponents =
-      static_cast< size_t >( this->GetImageSizeInComponents() );
+      static_cast< size_t >( numElts ) * numComponents;
 
     //
     // allocate new buffer for floats. Malloc instead of new to
@@ -596,26 +1113,29 @@ void NiftiImageIO::Read(void *buffer)
        || this->GetPixelType() == RGB
        || this->GetPixelType() == RGBA )
     {
-    const size_t NumBytes = numElts * pixelSize;
-    memcpy(buffer, data, NumBytes);
-    //
-    // if read_subregion was called it allocates a buffer that needs to be
-    // freed.
-    if ( data != this->m_NiftiImage->data )
+    if ( data != buffer )
       {
-      free(data);
+      const size_t NumBytes = numElts * pixelSize;
+      memcpy(buffer, data, NumBytes);
+      //
+      // if read_subregion was called it allocates a buffer that needs to be
+      // freed.
+      if ( data != this->m_NiftiImage->data )
+        {
+        free(data);
+        }
       }
     }
   else
     {
     // otherwise nifti is x y z t vec l m 0, itk is
-    // vec x y z t l m o
+    // vec x y z t l m o, both over the region read
     const char *       niftibuf = (const char *)data;
     char *             itkbuf = (char *)buffer;
-    const unsigned int rowdist = this->m_NiftiImage->dim[1];
-    const unsigned int slicedist = rowdist * this->m_NiftiImage->dim[2];
-    const unsigned int volumedist = slicedist * this->m_NiftiImage->dim[3];
-    const unsigned int seriesdist = volumedist * this->m_NiftiImage->dim[4];
+    const unsigned int rowdist = _size[0];
+    const unsigned int slicedist = rowdist * _size[1];
+    const unsigned int volumedist = slicedist * _size[2];
+    const unsigned int seriesdist = volumedist * _size[3];
     //
     // as per ITK bug 0007485
     // NIfTI is lower triangular, ITK is upper triangular.
@@ -634,13 +1154,13 @@ void NiftiImageIO::Read(void *buffer)
         vecOrder[i] = i;
         }
       }
-    for ( int t = 0; t < this->m_NiftiImage->dim[4]; t++ )
+    for ( int t = 0; t < _size[3]; t++ )
       {
-      for ( int z = 0; z < this->m_NiftiImage->dim[3]; z++ )
+      for ( int z = 0; z < _size[2]; z++ )
         {
-        for ( int y = 0; y < this->m_NiftiImage->dim[2]; y++ )
+        for ( int y = 0; y < _size[1]; y++ )
           {
-          for ( int x = 0; x < this->m_NiftiImage->dim[1]; x++ )
+          for ( int x = 0; x < _size[0]; x++ )
             {
             for ( unsigned int c = 0; c < numComponents; c++ )
               {
@@ -1856,10 +2376,161 @@ NiftiImageIO::SetNIfTIOrientationFromImageIO(unsigned short int origdims, unsign
 /**
  * Write the image Information before writing data
  */
+void
+NiftiImageIO
+::WriteRegion(const void *buffer)
+{
+  this->WriteImageInformation();
+  nifti_image *nim = this->m_NiftiImage;
+
+  int inameOffset;
+  if ( !itksys::SystemTools::FileExists(nim->fname) || !itksys::SystemTools::FileExists(nim->iname) )
+    {
+    // the first piece writes the header and sets the size of the file,
+    // the voxels of the pieces not written yet are 0
+    znzFile fp = nifti_image_write_hdr_img(nim, 2, "wb");
+    if ( znz_isnull(fp) )
+      {
+      itkExceptionMacro(<< "Could not write the header of file: " << nim->fname);
+      }
+    inameOffset = nim->iname_offset;
+    const size_t dataSize = static_cast< size_t >( nim->nvox ) * static_cast< size_t >( nim->nbyper );
+    const char   zero = 0;
+    const bool   ok = dataSize == 0
+                      || ( znzseek(fp, static_cast< long >( inameOffset + dataSize - 1 ), SEEK_SET) >= 0
+                           && znzwrite(&zero, 1, 1, fp) == 1 );
+    znzclose(fp);
+    if ( !ok )
+      {
+      itkExceptionMacro(<< "Could not write file: " << nim->iname);
+      }
+    }
+  else
+    {
+    // paste into the existing file, which must hold an image of the
+    // same size and pixel type
+    nifti_image *existing = nifti_image_read(nim->fname, false);
+    if ( existing == NULL )
+      {
+      itkExceptionMacro(<< "Unable to paste because the header of file "
+                        << nim->fname << " cannot be read");
+      }
+    bool matches = existing->datatype == nim->datatype
+                   && existing->byteorder == nifti_short_order()
+                   && existing->iname_offset >= 0;
+    for ( int d = 1; d < 8; d++ )
+      {
+      const int existingSize = ( d <= existing->dim[0] ) ? existing->dim[d] : 1;
+      const int size = ( d <= nim->dim[0] ) ? nim->dim[d] : 1;
+      matches = matches && ( vnl_math_max(existingSize, 1) == vnl_math_max(size, 1) );
+      }
+    inameOffset = existing->iname_offset;
+    nifti_image_free(existing);
+    if ( !matches )
+      {
+      itkExceptionMacro(<< "Unable to paste because the image in file " << nim->fname
+                        << " has another size or pixel type");
+      }
+    }
+
+  for ( unsigned int d = 0; d < this->m_IORegion.GetImageDimension(); d++ )
+    {
+    if ( this->m_IORegion.GetSize(d) == 0 )
+      {
+      // an empty region, nothing to write
+      return;
+      }
+    }
+
+  znzFile fp = znzopen(nim->iname, "r+b", 0);
+  if ( znz_isnull(fp) )
+    {
+    itkExceptionMacro(<< "Could not open file for writing: " << nim->iname);
+    }
+
+  int origin[7];
+  int size[7];
+  for ( unsigned int d = 0; d < 7; d++ )
+    {
+    origin[d] = ( d < this->m_IORegion.GetImageDimension() ) ? static_cast< int >( this->m_IORegion.GetIndex(d) ) : 0;
+    size[d] = ( d < this->m_IORegion.GetImageDimension() ) ? static_cast< int >( this->m_IORegion.GetSize(d) ) : 1;
+    }
+  const int ndim = vnl_math_min(nim->dim[0], 7);
+  size_t    strides[7];
+  strides[0] = 1;
+  for ( int d = 1; d < ndim; d++ )
+    {
+    strides[d] = strides[d - 1] * static_cast< size_t >( nim->dim[d] );
+    }
+
+  // as when reading, the rows of the region, or longer runs of voxels
+  // contiguous in the file, are written at once
+  int    outer = 1;
+  size_t run = size[0];
+  while ( outer < ndim && origin[outer - 1] == 0 && size[outer - 1] == nim->dim[outer] )
+    {
+    run *= size[outer];
+    outer++;
+    }
+  const size_t runBytes = run * static_cast< size_t >( nim->nbyper );
+
+  int index[7];
+  for ( int d = 0; d < ndim; d++ )
+    {
+    index[d] = origin[d];
+    }
+  const char *in = static_cast< const char * >( buffer );
+  bool        ok = true;
+  for (;; )
+    {
+    size_t offset = 0;
+    for ( int d = 0; d < ndim; d++ )
+      {
+      offset += static_cast< size_t >( index[d] ) * strides[d];
+      }
+    if ( znzseek(fp, static_cast< long >( inameOffset + offset * nim->nbyper ), SEEK_SET) < 0
+         || nifti_write_buffer(fp, in, runBytes) != runBytes )
+      {
+      ok = false;
+      break;
+      }
+    in += runBytes;
+
+    int d = outer;
+    while ( d < ndim && ++index[d] == origin[d] + size[d] )
+      {
+      index[d] = origin[d];
+      d++;
+      }
+    if ( d >= ndim )
+      {
+      break;
+      }
+    }
+  znzclose(fp);
+  if ( !ok )
+    {
+    itkExceptionMacro(<< "Writing the image data failed for file: " << nim->iname);
+    }
+}
+
 void
 NiftiImageIO
 ::Write(const void *buffer)
 {
+  if ( this->m_UseStreamedWriting && this->CanStreamWrite() )
+    {
+    // the pieces of a streamed image are pasted into the file
+    for ( unsigned int d = 0; d < this->m_IORegion.GetImageDimension(); d++ )
+      {
+      if ( this->m_IORegion.GetIndex(d) != 0
+           || this->m_IORegion.GetSize(d) != this->GetDimensions(d) )
+        {
+        this->WriteRegion(buffer);
+        return;
+        }
+      }
+    }
   this->WriteImageInformation();
   unsigned int numComponents = this->GetNumberOfComponents();
   if ( numComponents == 1
@@ -0,0 +1,206 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkNiftiImageIOTest.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+#include <vector>
+#include <cstring>
+
+// Read whole images and sub-regions of images, which the NiftiImageIO
+// reads straight into the buffer of the caller, and check the voxels.
+// The time taken by the whole reads is reported, and the time taken by a
+// read straight into the buffer is compared with a read through a buffer
+// of niftilib, as NiftiImageIO used to do, whose size is reported.
+
+typedef itk::Image< short, 4 > ShortImageType;
+
+static short ExpectedVoxel(const ShortImageType::IndexType & index)
+{
+  return static_cast< short >( index[0] + 3 * index[1] - 50 * index[2] + 1000 * index[3] );
+}
+
+static itk::ImageIORegion ToIORegion(const ShortImageType::RegionType & region)
+{
+  itk::ImageIORegion ioRegion(4);
+  for ( unsigned int i = 0; i < 4; i++ )
+    {
+    ioRegion.SetIndex( i, region.GetIndex()[i] );
+    ioRegion.SetSize( i, region.GetSize()[i] );
+    }
+  return ioRegion;
+}
+
+static int CheckRegion(const std::string & fileName, const ShortImageType::RegionType & region)
+{
+  itk::NiftiImageIO::Pointer io = itk::NiftiImageIO::New();
+  io->SetFileName( fileName.c_str() );
+  io->ReadImageInformation();
+  io->SetIORegion( ToIORegion(region) );
+
+  // one more voxel, which must not be written
+  std::vector< short > buffer(region.GetNumberOfPixels() + 1, 12345);
+  io->Read(&buffer[0]);
+
+  ShortImageType::Pointer image = ShortImageType::New();
+  image->SetRegions(region);
+  image->GetPixelContainer()->SetImportPointer( &buffer[0], region.GetNumberOfPixels(), false );
+
+  itk::ImageRegionIteratorWithIndex< ShortImageType > it(image, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( it.Get() != ExpectedVoxel( it.GetIndex() ) )
+      {
+      std::cerr << fileName << ": voxel " << it.GetIndex() << " is " << it.Get()
+                << " instead of " << ExpectedVoxel( it.GetIndex() ) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if ( buffer.back() != 12345 )
+    {
+    std::cerr << fileName << ": the read went past the end of the region " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+// the read through niftilib needs a second buffer of the size of the
+// image, which is reported
+static void CompareReads(const std::string & fileName, const ShortImageType::RegionType & region)
+{
+  const size_t         numberOfVoxels = region.GetNumberOfPixels();
+  std::vector< short > buffer(numberOfVoxels, 0);
+
+  itk::NiftiImageIO::Pointer io = itk::NiftiImageIO::New();
+  io->SetFileName( fileName.c_str() );
+  io->ReadImageInformation();
+  io->SetIORegion( ToIORegion(region) );
+  itk::TimeProbe directTimer;
+  directTimer.Start();
+  io->Read(&buffer[0]);
+  directTimer.Stop();
+
+  itk::TimeProbe stagedTimer;
+  stagedTimer.Start();
+  nifti_image *image = nifti_image_read(fileName.c_str(), 1);
+  size_t       stagedBytes = 0;
+  if ( image && image->data )
+    {
+    stagedBytes = image->nvox * image->nbyper;
+    std::memcpy(&buffer[0], image->data, numberOfVoxels * sizeof( short ) );
+    }
+  stagedTimer.Stop();
+  nifti_image_free(image);
+
+  std::cout << fileName << ": read into the buffer in " << directTimer.GetTotal()
+            << " s; through niftilib in " << stagedTimer.GetTotal() << " s, with a "
+            << stagedBytes << " bytes buffer" << std::endl;
+}
+
+int itkNiftiImageIOTest12(int ac, char *av[])
+{
+  if ( ac > 1 )
+    {
+    char *testdir = *++av;
+    itksys::SystemTools::ChangeDirectory(testdir);
+    }
+  else
+    {
+    return EXIT_FAILURE;
+    }
+
+  ShortImageType::SizeType size;
+  size[0] = 61;
+  size[1] = 47;
+  size[2] = 23;
+  size[3] = 3;
+  ShortImageType::Pointer image = ShortImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ShortImageType > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( ExpectedVoxel( it.GetIndex() ) );
+    }
+
+  int status = EXIT_SUCCESS;
+  const char *fileNames[2] = { "itkNiftiImageIOTest12.nii", "itkNiftiImageIOTest12.nii.gz" };
+  for ( unsigned int f = 0; f < 2; f++ )
+    {
+    try
+      {
+      WriteImage< ShortImageType >(image, fileNames[f]);
+
+      itk::TimeProbe timer;
+      timer.Start();
+      if ( CheckRegion( fileNames[f], image->GetLargestPossibleRegion() ) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      timer.Stop();
+      std::cout << fileNames[f] << ": whole image read in " << timer.GetTotal() << " s" << std::endl;
+
+      // rows, slices and volumes of the region are contiguous in turn
+      ShortImageType::RegionType region = image->GetLargestPossibleRegion();
+      region.SetIndex(3, 1);
+      region.SetSize(3, 2);
+      if ( CheckRegion(fileNames[f], region) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      region.SetIndex(2, 4);
+      region.SetSize(2, 9);
+      if ( CheckRegion(fileNames[f], region) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      region.SetIndex(1, 10);
+      region.SetSize(1, 5);
+      if ( CheckRegion(fileNames[f], region) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      region.SetIndex(0, 7);
+      region.SetSize(0, 30);
+      if ( CheckRegion(fileNames[f], region) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+
+      // an empty region reads nothing
+      region.SetSize(0, 0);
+      if ( CheckRegion(fileNames[f], region) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+
+      CompareReads( fileNames[f], image->GetLargestPossibleRegion() );
+      }
+    catch ( itk::ExceptionObject & ex )
+      {
+      std::cerr << fileNames[f] << ": " << ex << std::endl;
+      status = EXIT_FAILURE;
+      }
+    Remove(fileNames[f]);
+    }
+
+  return status;
+}
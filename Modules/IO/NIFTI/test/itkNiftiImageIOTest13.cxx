@@ -0,0 +1,390 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkNiftiImageIOTest.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkStreamingImageFilter.h"
+#include "itkTimeProbe.h"
+#include <iterator>
+
+// Read single volumes of 4D series, in order and backward, stream
+// images and vector images through the reader, write images by pieces
+// and paste regions into existing files, and check the voxels. The time
+// taken to read the volumes of the compressed series is reported.
+
+typedef itk::Image< short, 4 >                      SeriesType;
+typedef itk::Image< itk::Vector< float, 3 >, 3 >    VectorImageType;
+
+static short ExpectedVoxel(const SeriesType::IndexType & index)
+{
+  return static_cast< short >( 7 * index[0] - 5 * index[1] + 11 * index[2] + 1013 * index[3] );
+}
+
+template< class TImage >
+static bool IsExpected(const TImage *image, const typename TImage::IndexType & index)
+{
+  return image->GetPixel(index) == static_cast< typename TImage::PixelType >( ExpectedVoxel(index) );
+}
+
+static bool IsExpected(const VectorImageType *image, const VectorImageType::IndexType & index)
+{
+  const VectorImageType::PixelType & pixel = image->GetPixel(index);
+  for ( unsigned int c = 0; c < 3; c++ )
+    {
+    if ( pixel[c] != index[0] + 10 * index[1] + 100 * index[2] + 0.25f * c )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// the reader buffers only the region requested, whose voxels are checked
+template< class TReader >
+static int CheckRegion(TReader *reader, const typename TReader::OutputImageType::RegionType & region,
+                       const std::string & fileName)
+{
+  typedef typename TReader::OutputImageType ImageType;
+  reader->GetOutput()->SetRequestedRegion(region);
+  reader->GetOutput()->Update();
+  if ( reader->GetOutput()->GetBufferedRegion() != region )
+    {
+    std::cerr << fileName << ": the buffered region " << reader->GetOutput()->GetBufferedRegion()
+              << " is not the requested region " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ImageRegionIteratorWithIndex< ImageType > it(reader->GetOutput(), region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( !IsExpected( reader->GetOutput(), it.GetIndex() ) )
+      {
+      std::cerr << fileName << ": voxel " << it.GetIndex() << " is " << it.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+static int ReadVolumes(const std::string & fileName, const SeriesType::RegionType & largestRegion)
+{
+  typedef itk::ImageFileReader< SeriesType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+
+  const unsigned int numberOfVolumes = largestRegion.GetSize(3);
+  itk::TimeProbe     timers[2];
+  for ( unsigned int backward = 0; backward < 2; backward++ )
+    {
+    timers[backward].Start();
+    for ( unsigned int v = 0; v < numberOfVolumes; v++ )
+      {
+      SeriesType::RegionType region = largestRegion;
+      region.SetIndex(3, backward ? numberOfVolumes - 1 - v : v);
+      region.SetSize(3, 1);
+      if ( CheckRegion(reader.GetPointer(), region, fileName) != EXIT_SUCCESS )
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    timers[backward].Stop();
+    }
+  std::cout << fileName << ": volumes read in order in " << timers[0].GetTotal()
+            << " s, backward in " << timers[1].GetTotal() << " s" << std::endl;
+
+  // a block in the middle of the series
+  SeriesType::RegionType region = largestRegion;
+  region.SetIndex(0, 5);
+  region.SetSize(0, 40);
+  region.SetIndex(1, 20);
+  region.SetSize(1, 3);
+  region.SetIndex(3, 2);
+  region.SetSize(3, 5);
+  return CheckRegion(reader.GetPointer(), region, fileName);
+}
+
+template< class TImage >
+static int CheckImage(const TImage *image, const std::string & fileName)
+{
+  itk::ImageRegionConstIteratorWithIndex< TImage > it( image, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( !IsExpected( image, it.GetIndex() ) )
+      {
+      std::cerr << fileName << ": voxel " << it.GetIndex() << " is " << it.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+// stream the file through a reader
+template< class TImage >
+static int StreamImage(const std::string & fileName)
+{
+  typedef itk::ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  typedef itk::StreamingImageFilter< TImage, TImage > StreamerType;
+  typename StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( reader->GetOutput() );
+  streamer->SetNumberOfStreamDivisions(7);
+  streamer->Update();
+  return CheckImage(streamer->GetOutput(), fileName);
+}
+
+int itkNiftiImageIOTest13(int ac, char *av[])
+{
+  if ( ac > 1 )
+    {
+    char *testdir = *++av;
+    itksys::SystemTools::ChangeDirectory(testdir);
+    }
+  else
+    {
+    return EXIT_FAILURE;
+    }
+
+  SeriesType::SizeType size;
+  size[0] = 64;
+  size[1] = 60;
+  size[2] = 32;
+  size[3] = 12;
+  SeriesType::Pointer series = SeriesType::New();
+  series->SetRegions(size);
+  series->Allocate();
+  itk::ImageRegionIteratorWithIndex< SeriesType > it( series, series->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    it.Set( ExpectedVoxel( it.GetIndex() ) );
+    }
+
+  typedef itk::ImageFileWriter< SeriesType > WriterType;
+  typedef itk::ImageFileReader< SeriesType > ReaderType;
+
+  int status = EXIT_SUCCESS;
+  const char *fileNames[3] = { "itkNiftiImageIOTest13.nii", "itkNiftiImageIOTest13.nii.gz",
+                               "itkNiftiImageIOTest13.hdr" };
+  for ( unsigned int f = 0; f < 3; f++ )
+    {
+    try
+      {
+      // written by pieces, but for the compressed file
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetInput(series);
+      writer->SetFileName(fileNames[f]);
+      writer->SetNumberOfStreamDivisions(5);
+      writer->Update();
+
+      ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName(fileNames[f]);
+      reader->Update();
+      if ( CheckImage(reader->GetOutput(), fileNames[f]) != EXIT_SUCCESS
+           || ReadVolumes(fileNames[f], series->GetLargestPossibleRegion()) != EXIT_SUCCESS
+           || StreamImage< SeriesType >(fileNames[f]) != EXIT_SUCCESS )
+        {
+        status = EXIT_FAILURE;
+        }
+      }
+    catch ( itk::ExceptionObject & ex )
+      {
+      std::cerr << fileNames[f] << ": " << ex << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+
+  // paste a region into the file streamed above, and into a new file
+  SeriesType::RegionType pasteRegion = series->GetLargestPossibleRegion();
+  pasteRegion.SetIndex(1, 13);
+  pasteRegion.SetSize(1, 20);
+  pasteRegion.SetIndex(3, 4);
+  pasteRegion.SetSize(3, 3);
+  itk::ImageIORegion pasteIORegion(4);
+  for ( unsigned int i = 0; i < 4; i++ )
+    {
+    pasteIORegion.SetIndex( i, pasteRegion.GetIndex(i) );
+    pasteIORegion.SetSize( i, pasteRegion.GetSize(i) );
+    }
+  // only the paste region is buffered, otherwise the whole image is
+  // written
+  SeriesType::Pointer pasted = SeriesType::New();
+  pasted->SetLargestPossibleRegion( series->GetLargestPossibleRegion() );
+  pasted->SetBufferedRegion(pasteRegion);
+  pasted->SetRequestedRegion(pasteRegion);
+  pasted->Allocate();
+  for ( it = itk::ImageRegionIteratorWithIndex< SeriesType >(pasted, pasteRegion); !it.IsAtEnd(); ++it )
+    {
+    it.Set( ExpectedVoxel( it.GetIndex() ) + 1 );
+    }
+  const char *pasteFileNames[2] = { fileNames[0], "itkNiftiImageIOTest13Paste.nii" };
+  for ( unsigned int f = 0; f < 2; f++ )
+    {
+    try
+      {
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetInput(pasted);
+      writer->SetFileName(pasteFileNames[f]);
+      writer->SetIORegion(pasteIORegion);
+      writer->Update();
+
+      ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName(pasteFileNames[f]);
+      reader->Update();
+      for ( it = itk::ImageRegionIteratorWithIndex< SeriesType >( reader->GetOutput(),
+                                                                  series->GetLargestPossibleRegion() );
+            !it.IsAtEnd(); ++it )
+        {
+        short expected = ( f == 0 ) ? ExpectedVoxel( it.GetIndex() ) : 0;
+        if ( pasteRegion.IsInside( it.GetIndex() ) )
+          {
+          expected = ExpectedVoxel( it.GetIndex() ) + 1;
+          }
+        if ( it.Get() != expected )
+          {
+          std::cerr << pasteFileNames[f] << ": pasted voxel " << it.GetIndex() << " is "
+                    << it.Get() << " instead of " << expected << std::endl;
+          status = EXIT_FAILURE;
+          break;
+          }
+        }
+      }
+    catch ( itk::ExceptionObject & ex )
+      {
+      std::cerr << pasteFileNames[f] << ": " << ex << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+
+  // pasting an empty region leaves the file unchanged
+  try
+    {
+    std::ifstream before(pasteFileNames[1], std::ios::binary);
+    const std::string beforeBytes( ( std::istreambuf_iterator< char >(before) ),
+                                   std::istreambuf_iterator< char >() );
+    before.close();
+    itk::NiftiImageIO::Pointer io = itk::NiftiImageIO::New();
+    io->SetFileName(pasteFileNames[1]);
+    io->ReadImageInformation();
+    io->SetUseStreamedWriting(true);
+    itk::ImageIORegion emptyIORegion(pasteIORegion);
+    emptyIORegion.SetSize(3, 0);
+    io->SetIORegion(emptyIORegion);
+    const short unused = 0;
+    io->Write(&unused);
+    std::ifstream after(pasteFileNames[1], std::ios::binary);
+    const std::string afterBytes( ( std::istreambuf_iterator< char >(after) ),
+                                  std::istreambuf_iterator< char >() );
+    if ( afterBytes != beforeBytes )
+      {
+      std::cerr << pasteFileNames[1] << ": pasting an empty region changed the file" << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << pasteFileNames[1] << ": " << ex << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // pasting into a file of another size fails
+  try
+    {
+    typedef itk::Image< short, 3 > VolumeType;
+    VolumeType::SizeType volumeSize;
+    volumeSize.Fill(16);
+    VolumeType::RegionType volumeRegion(volumeSize);
+    volumeRegion.SetSize(2, 4);
+    VolumeType::Pointer volume = VolumeType::New();
+    volume->SetLargestPossibleRegion( VolumeType::RegionType(volumeSize) );
+    volume->SetBufferedRegion(volumeRegion);
+    volume->SetRequestedRegion(volumeRegion);
+    volume->Allocate();
+    volume->FillBuffer(0);
+    itk::ImageIORegion volumeIORegion(3);
+    for ( unsigned int i = 0; i < 3; i++ )
+      {
+      volumeIORegion.SetSize( i, volumeRegion.GetSize(i) );
+      }
+    typedef itk::ImageFileWriter< VolumeType > VolumeWriterType;
+    VolumeWriterType::Pointer writer = VolumeWriterType::New();
+    writer->SetInput(volume);
+    writer->SetFileName(pasteFileNames[1]);
+    writer->SetIORegion(volumeIORegion);
+    writer->Update();
+    std::cerr << "Pasting into a file of another size is not reported" << std::endl;
+    status = EXIT_FAILURE;
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cout << "Caught expected exception: " << ex.GetDescription() << std::endl;
+    }
+
+  // the vector components are reordered for the region read
+  VectorImageType::SizeType vectorSize;
+  vectorSize[0] = 21;
+  vectorSize[1] = 17;
+  vectorSize[2] = 9;
+  VectorImageType::Pointer vectorImage = VectorImageType::New();
+  vectorImage->SetRegions(vectorSize);
+  vectorImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< VectorImageType > vit( vectorImage, vectorImage->GetBufferedRegion() );
+  for ( ; !vit.IsAtEnd(); ++vit )
+    {
+    VectorImageType::PixelType pixel;
+    for ( unsigned int c = 0; c < 3; c++ )
+      {
+      pixel[c] = vit.GetIndex()[0] + 10 * vit.GetIndex()[1] + 100 * vit.GetIndex()[2] + 0.25f * c;
+      }
+    vit.Set(pixel);
+    }
+  const char *vectorFileName = "itkNiftiImageIOTest13Vector.nii.gz";
+  try
+    {
+    WriteImage< VectorImageType >(vectorImage, vectorFileName);
+    typedef itk::ImageFileReader< VectorImageType > VectorReaderType;
+    VectorReaderType::Pointer reader = VectorReaderType::New();
+    reader->SetFileName(vectorFileName);
+    VectorImageType::RegionType region( vectorSize );
+    region.SetIndex(1, 4);
+    region.SetSize(1, 10);
+    region.SetIndex(2, 3);
+    region.SetSize(2, 2);
+    if ( CheckRegion(reader.GetPointer(), region, vectorFileName) != EXIT_SUCCESS
+         || StreamImage< VectorImageType >(vectorFileName) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << vectorFileName << ": " << ex << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  for ( unsigned int f = 0; f < 3; f++ )
+    {
+    Remove(fileNames[f]);
+    }
+  Remove("itkNiftiImageIOTest13.img");
+  Remove(pasteFileNames[1]);
+  Remove(vectorFileName);
+
+  return status;
+}
@@ -24,6 +24,7 @@
 
 #include "itkImageIOBase.h"
 #include <fstream>
+#include <vector>
 #include "NrrdIO.h"
 
 namespace itk
@@ -34,6 +35,16 @@ namespace itk
  * The Nrrd format was developed as part of the Teem package
  * (teem.sourceforge.net).
  *
+ * When UseCompression is on and CompressionBlockSize is not 0, the
+ * image is cut in blocks of CompressionBlockSize bytes which are
+ * deflated independently by up to NumberOfThreads threads. The blocks
+ * are written as a single gzip stream, so the file can still be read
+ * by any NRRD reader, and the offsets of their ends in that stream are
+ * stored in the ITK_CompressedDataBlockOffsets key/value pair of the
+ * header. When such a file is read, the blocks are inflated by several
+ * threads, and a region of the image is read by inflating only the
+ * blocks which hold it.
+ *
  *  \ingroup IOFilters
  * \ingroup ITK-IO-NRRD
  */
@@ -79,8 +90,26 @@ public:
    * that the IORegions has been set properly. */
   virtual void Write(const void *buffer);
 
+  /** Only the files compressed by blocks can be streamed.
+   * ReadImageInformation must be called prior to this function. */
+  virtual bool CanStreamRead()
+  {
+    return m_FileCompressionBlockSize > 0;
+  }
+
+  /** The requested region is read from a file compressed by blocks,
+   * the whole image otherwise. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
+
+  /** Set/Get the size in bytes of the blocks of the image which are
+   * compressed independently when UseCompression is on. 0, the default,
+   * compresses the image as a single block. */
+  itkSetMacro(CompressionBlockSize, SizeValueType);
+  itkGetConstMacro(CompressionBlockSize, SizeValueType);
+
 protected:
-  NrrdImageIO() {}
+  NrrdImageIO():m_CompressionBlockSize(0), m_FileCompressionBlockSize(0) {}
   ~NrrdImageIO() {}
   void PrintSelf(std::ostream & os, Indent indent) const;
 
@@ -93,6 +122,19 @@ protected:
 private:
   NrrdImageIO(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
+
+  /** Compress the image by blocks into a gzip stream, and return the
+   * offsets of the ends of the blocks in the stream. */
+  void CompressBlocks(const void *buffer, std::vector< unsigned char > & data,
+                      std::vector< SizeValueType > & offsets);
+
+  /** Read the IO region of an image compressed by blocks. */
+  void ReadCompressedBlocks(void *buffer);
+
+  SizeValueType m_CompressionBlockSize;
+
+  SizeValueType                m_FileCompressionBlockSize;
+  std::vector< SizeValueType > m_FileCompressionBlockOffsets;
 };
 } // end namespace itk
 
@@ -1 +1 @@
-itk_module(ITK-IO-NRRD DEPENDS ITK-NrrdIO ITK-IO-Base TEST_DEPENDS ITK-TestKernel)
+itk_module(ITK-IO-NRRD DEPENDS ITK-NrrdIO ITK-IO-Base ITK-ZLIB TEST_DEPENDS ITK-TestKernel)
@@ -24,11 +24,167 @@
 #include "itkMetaDataObject.h"
 #include "itkIOCommon.h"
 #include "itkFloatingPointExceptions.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itksys/SystemTools.hxx"
+#include "itk_zlib.h"
+#include <sstream>
 
 namespace itk
 {
 #define KEY_PREFIX "NRRD_"
 
+namespace
+{
+// key/value pairs which hold the size of the blocks compressed
+// independently and the offsets of their ends in the gzip stream
+const char *const CompressionBlockSizeKey = "ITK_CompressedDataBlockSize";
+const char *const CompressionBlockOffsetsKey = "ITK_CompressedDataBlockOffsets";
+
+// size of the header of the gzip stream, which has no optional field
+const SizeValueType GzipHeaderSize = 10;
+
+/** The blocks of an image which are compressed or decompressed by the
+ * threads. */
+struct CompressedBlocksThreadStruct
+{
+  bool ( *ProcessBlock )(CompressedBlocksThreadStruct *, SizeValueType);
+
+  // the uncompressed image
+  unsigned char *Data;
+  SizeValueType  DataSize;
+  SizeValueType  BlockSize;
+
+  // the blocks compressed, and their checksums
+  std::vector< std::vector< unsigned char > > *CompressedBlocks;
+  std::vector< uLong > *                       Checksums;
+
+  // the blocks read from the gzip stream, where Offsets[b] is the end
+  // of block b, and Data holds the blocks from FirstBlock
+  const unsigned char *               CompressedData;
+  SizeValueType                       CompressedDataOffset;
+  const std::vector< SizeValueType > *Offsets;
+  SizeValueType                       FirstBlock;
+
+  SimpleFastMutexLock Lock;
+  SizeValueType       NextBlock;
+  SizeValueType       LastBlock;
+  bool                Failed;
+};
+
+SizeValueType GetBlockSize(const CompressedBlocksThreadStruct *str, SizeValueType block)
+{
+  return std::min( str->BlockSize, str->DataSize - block * str->BlockSize );
+}
+
+/** Deflate a block alone, ending with a sync flush so the blocks can
+ * be concatenated, or with the end of the stream for the last one. */
+bool CompressBlock(CompressedBlocksThreadStruct *str, SizeValueType block)
+{
+  const SizeValueType size = GetBlockSize(str, block);
+  unsigned char *     data = str->Data + block * str->BlockSize;
+  const bool          lastBlock = ( block + 1 ) * str->BlockSize >= str->DataSize;
+
+  z_stream z;
+  z.zalloc = Z_NULL;
+  z.zfree = Z_NULL;
+  z.opaque = Z_NULL;
+  if ( deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK )
+    {
+    return false;
+    }
+
+  std::vector< unsigned char > & compressed = ( *str->CompressedBlocks )[block];
+  compressed.resize(deflateBound(&z, size) + 64);
+  z.next_in = data;
+  z.avail_in = static_cast< uInt >( size );
+  z.next_out = &compressed[0];
+  z.avail_out = static_cast< uInt >( compressed.size() );
+  const int  result = deflate(&z, lastBlock ? Z_FINISH : Z_SYNC_FLUSH);
+  const bool done = lastBlock ? result == Z_STREAM_END : ( result == Z_OK && z.avail_out > 0 );
+  compressed.resize(z.total_out);
+  deflateEnd(&z);
+
+  ( *str->Checksums )[block] = crc32(crc32(0L, Z_NULL, 0), data, static_cast< uInt >( size ));
+  return done && z.avail_in == 0;
+}
+
+bool DecompressBlock(CompressedBlocksThreadStruct *str, SizeValueType block)
+{
+  const SizeValueType begin = block == 0 ? GzipHeaderSize : ( *str->Offsets )[block - 1];
+  const SizeValueType end = ( *str->Offsets )[block];
+  const SizeValueType size = GetBlockSize(str, block);
+
+  z_stream z;
+  z.zalloc = Z_NULL;
+  z.zfree = Z_NULL;
+  z.opaque = Z_NULL;
+  z.next_in = const_cast< unsigned char * >( str->CompressedData + begin - str->CompressedDataOffset );
+  z.avail_in = static_cast< uInt >( end - begin );
+  if ( inflateInit2(&z, -MAX_WBITS) != Z_OK )
+    {
+    return false;
+    }
+  z.next_out = str->Data + ( block - str->FirstBlock ) * str->BlockSize;
+  z.avail_out = static_cast< uInt >( size );
+  const int result = inflate(&z, Z_SYNC_FLUSH);
+  inflateEnd(&z);
+  return ( result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR ) && z.avail_out == 0;
+}
+
+ITK_THREAD_RETURN_TYPE CompressedBlocksThreaderCallback(void *arg)
+{
+  CompressedBlocksThreadStruct *str = (CompressedBlocksThreadStruct *)
+                                      ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  for (;; )
+    {
+    str->Lock.Lock();
+    if ( str->Failed || str->NextBlock > str->LastBlock )
+      {
+      str->Lock.Unlock();
+      break;
+      }
+    const SizeValueType block = str->NextBlock++;
+    str->Lock.Unlock();
+
+    if ( !str->ProcessBlock(str, block) )
+      {
+      str->Lock.Lock();
+      str->Failed = true;
+      str->Lock.Unlock();
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Process the blocks from NextBlock to LastBlock with up to
+ * numberOfThreads threads. */
+bool ProcessCompressedBlocks(CompressedBlocksThreadStruct & str, int numberOfThreads)
+{
+  str.Failed = false;
+  MultiThreader::Pointer threader = MultiThreader::New();
+  const SizeValueType    numberOfBlocks = str.LastBlock - str.NextBlock + 1;
+  threader->SetNumberOfThreads(numberOfThreads);
+  if ( numberOfBlocks < static_cast< SizeValueType >( threader->GetNumberOfThreads() ) )
+    {
+    threader->SetNumberOfThreads( static_cast< int >( numberOfBlocks ) );
+    }
+  threader->SetSingleMethod(CompressedBlocksThreaderCallback, &str);
+  threader->SingleMethodExecute();
+  return !str.Failed;
+}
+
+void PutLittleEndian32(std::vector< unsigned char > & data, uLong value)
+{
+  for ( unsigned int i = 0; i < 4; i++ )
+    {
+    data.push_back( static_cast< unsigned char >( ( value >> ( 8 * i ) ) & 0xff ) );
+    }
+}
+} // end anonymous namespace
+
 bool NrrdImageIO::SupportsDimension(unsigned long dim)
 {
   if ( 1 == this->GetNumberOfComponents() )
@@ -44,6 +200,7 @@ bool NrrdImageIO::SupportsDimension(unsigned long dim)
 void NrrdImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "CompressionBlockSize: " << m_CompressionBlockSize << "\n";
 }
 
 ImageIOBase::IOComponentType
@@ -541,15 +698,60 @@ void NrrdImageIO::ReadImageInformation()
   MetaDataDictionary & thisDic = this->GetMetaDataDictionary();
   std::string          classname( this->GetNameOfClass() );
   EncapsulateMetaData< std::string >(thisDic, ITK_InputFilterName, classname);
+  std::string blockSizeValue;
+  std::string blockOffsetsValue;
   for ( unsigned int kvpi = 0; kvpi < nrrdKeyValueSize(nrrd); kvpi++ )
     {
     nrrdKeyValueIndex(nrrd, &keyPtr, &valPtr, kvpi);
-    EncapsulateMetaData< std::string >( thisDic, std::string(keyPtr),
-                                        std::string(valPtr) );
+    if ( !strcmp(keyPtr, CompressionBlockSizeKey) )
+      {
+      blockSizeValue = valPtr;
+      }
+    else if ( !strcmp(keyPtr, CompressionBlockOffsetsKey) )
+      {
+      blockOffsetsValue = valPtr;
+      }
+    else
+      {
+      EncapsulateMetaData< std::string >( thisDic, std::string(keyPtr),
+                                          std::string(valPtr) );
+      }
     keyPtr = (char *)airFree(keyPtr);
     valPtr = (char *)airFree(valPtr);
     }
 
+  // the blocks compressed independently are only used when the data
+  // are read from a single gzip stream in the order of ITK
+  m_FileCompressionBlockSize = 0;
+  m_FileCompressionBlockOffsets.clear();
+  if ( !blockSizeValue.empty()
+       && nio->encoding == nrrdEncodingGzip
+       && !nio->dataFNFormat && nio->dataFNArr->len <= 1
+       && nio->byteSkip == 0
+       && ( 0 == rangeAxisNum
+            || ( 0 == rangeAxisIdx[0] && nrrdKind3DMaskedSymMatrix != nrrd->axis[0].kind ) ) )
+    {
+    SizeValueType      blockSize = 0;
+    std::istringstream blockSizeStream(blockSizeValue);
+    blockSizeStream >> blockSize;
+    std::istringstream blockOffsetsStream(blockOffsetsValue);
+    SizeValueType      offset;
+    while ( blockOffsetsStream >> offset )
+      {
+      m_FileCompressionBlockOffsets.push_back(offset);
+      }
+    const SizeValueType dataSize = this->GetImageSizeInBytes();
+    if ( blockSize > 0 && dataSize > 0
+         && m_FileCompressionBlockOffsets.size() == ( dataSize + blockSize - 1 ) / blockSize )
+      {
+      m_FileCompressionBlockSize = blockSize;
+      }
+    else
+      {
+      m_FileCompressionBlockOffsets.clear();
+      }
+    }
+
   // save in MetaDataDictionary those important nrrd fields that
   // (currently) have no ITK equivalent. NOTE that for the per-axis
   // information, we use the same axis index (axii) as in ITK, NOT
@@ -676,6 +878,12 @@ void NrrdImageIO::ReadImageInformation()
 
 void NrrdImageIO::Read(void *buffer)
 {
+  if ( m_FileCompressionBlockSize > 0 )
+    {
+    this->ReadCompressedBlocks(buffer);
+    return;
+    }
+
   Nrrd *       nrrd = nrrdNew();
   unsigned int baseDim;
   bool         nrrdAllocated;
@@ -1042,7 +1250,7 @@ void NrrdImageIO::Write(const void *buffer)
           }
         }
       }
-    else
+    else if ( *keyIt != CompressionBlockSizeKey && *keyIt != CompressionBlockOffsetsKey )
       {
       // not a NRRD field packed into meta data; just a regular key/value
       std::string value;
@@ -1090,6 +1298,26 @@ void NrrdImageIO::Write(const void *buffer)
       break;
     }
 
+  // the data compressed by blocks are written after the header, whose
+  // key/value pairs hold the offsets of the blocks
+  std::vector< unsigned char > compressedData;
+  if ( nio->encoding == nrrdEncodingGzip && m_CompressionBlockSize > 0
+       && this->GetImageSizeInBytes() > 0 )
+    {
+    std::vector< SizeValueType > offsets;
+    this->CompressBlocks(buffer, compressedData, offsets);
+    std::ostringstream blockSizeValue;
+    blockSizeValue << m_CompressionBlockSize;
+    std::ostringstream offsetsValue;
+    for ( SizeValueType b = 0; b < offsets.size(); b++ )
+      {
+      offsetsValue << ( b > 0 ? " " : "" ) << offsets[b];
+      }
+    nrrdKeyValueAdd( nrrd, CompressionBlockSizeKey, blockSizeValue.str().c_str() );
+    nrrdKeyValueAdd( nrrd, CompressionBlockOffsetsKey, offsetsValue.str().c_str() );
+    nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+    }
+
   // Write the nrrd to file.
   if ( nrrdSave(this->GetFileName(), nrrd, nio) )
     {
@@ -1098,8 +1326,245 @@ void NrrdImageIO::Write(const void *buffer)
                       << this->GetFileName() << ":\n" << err);
     }
 
+  if ( !compressedData.empty() )
+    {
+    // the data follow an attached header, or go in the data file named
+    // in a detached one
+    std::string dataFileName = this->GetFileName();
+    const char *mode = "ab";
+    if ( nio->detachedHeader && nio->dataFNArr->len == 1 )
+      {
+      dataFileName = nio->dataFN[0];
+      const std::string path = itksys::SystemTools::GetFilenamePath( this->GetFileName() );
+      if ( !path.empty() && !itksys::SystemTools::FileIsFullPath( dataFileName.c_str() ) )
+        {
+        dataFileName = path + "/" + dataFileName;
+        }
+      mode = "wb";
+      }
+    FILE *     file = fopen(dataFileName.c_str(), mode);
+    const bool written = file
+                         && fwrite(&compressedData[0], 1, compressedData.size(), file) == compressedData.size();
+    if ( !file || fclose(file) != 0 || !written )
+      {
+      itkExceptionMacro("Write: Error writing the compressed blocks in "
+                        << dataFileName);
+      }
+    }
+
   // Free the nrrd struct but don't touch nrrd->data
   nrrd = nrrdNix(nrrd);
   nio = nrrdIoStateNix(nio);
 }
+
+ImageIORegion
+NrrdImageIO
+::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const
+{
+  if ( m_UseStreamedReading && m_FileCompressionBlockSize > 0 )
+    {
+    return requested;
+    }
+  return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requested);
+}
+
+void NrrdImageIO::CompressBlocks(const void *buffer, std::vector< unsigned char > & data,
+                                 std::vector< SizeValueType > & offsets)
+{
+  CompressedBlocksThreadStruct str;
+  str.ProcessBlock = CompressBlock;
+  str.Data = static_cast< unsigned char * >( const_cast< void * >( buffer ) );
+  str.DataSize = this->GetImageSizeInBytes();
+  str.BlockSize = m_CompressionBlockSize;
+
+  const SizeValueType                         numberOfBlocks = ( str.DataSize + str.BlockSize - 1 ) / str.BlockSize;
+  std::vector< std::vector< unsigned char > > compressedBlocks(numberOfBlocks);
+  std::vector< uLong >                        checksums(numberOfBlocks);
+  str.CompressedBlocks = &compressedBlocks;
+  str.Checksums = &checksums;
+  str.NextBlock = 0;
+  str.LastBlock = numberOfBlocks - 1;
+  if ( !ProcessCompressedBlocks( str, this->GetNumberOfThreads() ) )
+    {
+    itkExceptionMacro("Unable to compress the image for: " << this->GetFileName());
+    }
+
+  // a single gzip stream, made of the header, the blocks, the checksum
+  // and the size of the image
+  SizeValueType compressedDataSize = GzipHeaderSize + 8;
+  for ( SizeValueType b = 0; b < numberOfBlocks; b++ )
+    {
+    compressedDataSize += compressedBlocks[b].size();
+    }
+  const unsigned char header[GzipHeaderSize] = { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff };
+  data.clear();
+  data.reserve(compressedDataSize);
+  data.insert(data.end(), header, header + GzipHeaderSize);
+
+  offsets.resize(numberOfBlocks);
+  uLong checksum = checksums[0];
+  for ( SizeValueType b = 0; b < numberOfBlocks; b++ )
+    {
+    data.insert( data.end(), compressedBlocks[b].begin(), compressedBlocks[b].end() );
+    std::vector< unsigned char >().swap(compressedBlocks[b]);
+    offsets[b] = data.size();
+    if ( b > 0 )
+      {
+      checksum = crc32_combine( checksum, checksums[b],
+                                static_cast< z_off_t >( GetBlockSize(&str, b) ) );
+      }
+    }
+  PutLittleEndian32(data, checksum);
+  PutLittleEndian32( data, static_cast< uLong >( str.DataSize & 0xffffffffUL ) );
+}
+
+void NrrdImageIO::ReadCompressedBlocks(void *buffer)
+{
+  const unsigned int  nDims = this->GetNumberOfDimensions();
+  const SizeValueType dataSize = this->GetImageSizeInBytes();
+  const SizeValueType blockSize = m_FileCompressionBlockSize;
+  const std::vector< SizeValueType > & offsets = m_FileCompressionBlockOffsets;
+  const SizeValueType numberOfBlocks = offsets.size();
+
+  // the data file, past the header when it is attached
+  Nrrd *       nrrd = nrrdNew();
+  NrrdIoState *nio = nrrdIoStateNew();
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  nrrdIoStateSet(nio, nrrdIoStateKeepNrrdDataFileOpen, 1);
+  bool saveFPEState(FloatingPointExceptions::GetExceptionAction());
+  FloatingPointExceptions::Disable();
+  const int loaded = nrrdLoad(nrrd, this->GetFileName(), nio);
+  FloatingPointExceptions::SetEnabled(saveFPEState);
+  FILE *file = nio->dataFile;
+  nio->dataFile = NULL;
+  nrrd = nrrdNix(nrrd);
+  nio = nrrdIoStateNix(nio);
+  if ( loaded != 0 || !file )
+    {
+    char *err = biffGetDone(NRRD); // would be nice to free(err)
+    itkExceptionMacro("Read: Error reading "
+                      << this->GetFileName() << ":\n" << err);
+    }
+  const long dataOffset = ftell(file);
+
+  SizeValueType previousOffset = GzipHeaderSize;
+  for ( SizeValueType b = 0; b < numberOfBlocks; b++ )
+    {
+    if ( offsets[b] < previousOffset )
+      {
+      fclose(file);
+      itkExceptionMacro("Invalid offsets of the compressed blocks in: " << this->GetFileName());
+      }
+    previousOffset = offsets[b];
+    }
+
+  // the blocks which hold the first and the last pixels of the region,
+  // whose axes beyond the image have index 0 and size 1
+  ImageIORegion                largestRegion(nDims);
+  ImageIORegion                region(nDims);
+  std::vector< SizeValueType > strides(nDims);
+  SizeValueType                firstByte = 0;
+  SizeValueType                lastByte = 0;
+  for ( unsigned int i = 0; i < nDims; i++ )
+    {
+    largestRegion.SetIndex(i, 0);
+    largestRegion.SetSize( i, this->GetDimensions(i) );
+    if ( i < m_IORegion.GetImageDimension() )
+      {
+      region.SetIndex( i, m_IORegion.GetIndex(i) );
+      region.SetSize( i, m_IORegion.GetSize(i) );
+      }
+    else
+      {
+      region.SetIndex(i, 0);
+      region.SetSize(i, 1);
+      }
+    if ( region.GetSize(i) == 0 )
+      {
+      fclose(file);
+      return;
+      }
+    strides[i] = i == 0 ? this->GetPixelSize() : strides[i - 1] * this->GetDimensions(i - 1);
+    firstByte += region.GetIndex(i) * strides[i];
+    lastByte += ( region.GetIndex(i) + region.GetSize(i) - 1 ) * strides[i];
+    }
+  lastByte += this->GetPixelSize() - 1;
+  const bool readLargestRegion = ( region == largestRegion );
+
+  CompressedBlocksThreadStruct str;
+  str.ProcessBlock = DecompressBlock;
+  str.DataSize = dataSize;
+  str.BlockSize = blockSize;
+  str.Offsets = &offsets;
+  str.FirstBlock = firstByte / blockSize;
+  str.NextBlock = str.FirstBlock;
+  str.LastBlock = lastByte / blockSize;
+
+  str.CompressedDataOffset = str.FirstBlock == 0 ? GzipHeaderSize : offsets[str.FirstBlock - 1];
+  std::vector< unsigned char > compressedData(offsets[str.LastBlock] - str.CompressedDataOffset);
+  const bool                   read = fseek(file, dataOffset + static_cast< long >( str.CompressedDataOffset ),
+                                            SEEK_SET) == 0
+                                      && fread(&compressedData[0], 1, compressedData.size(), file)
+                                      == compressedData.size();
+  fclose(file);
+  if ( !read )
+    {
+    itkExceptionMacro("Unable to read the compressed blocks in: " << this->GetFileName());
+    }
+  str.CompressedData = &compressedData[0];
+
+  // the blocks of the whole image are decompressed in the buffer
+  std::vector< unsigned char > blocks;
+  if ( readLargestRegion )
+    {
+    str.Data = static_cast< unsigned char * >( buffer );
+    }
+  else
+    {
+    blocks.resize( std::min( ( str.LastBlock + 1 ) * blockSize, dataSize ) - str.FirstBlock * blockSize );
+    str.Data = &blocks[0];
+    }
+  if ( !ProcessCompressedBlocks( str, this->GetNumberOfThreads() ) )
+    {
+    itkExceptionMacro("Unable to decompress the blocks in: " << this->GetFileName());
+    }
+
+  if ( !readLargestRegion )
+    {
+    // copy the rows of the region
+    const SizeValueType          rowSize = region.GetSize(0) * this->GetPixelSize();
+    const SizeValueType          numberOfRows = region.GetNumberOfPixels() / region.GetSize(0);
+    std::vector< SizeValueType > index(nDims, 0);
+    unsigned char *              out = static_cast< unsigned char * >( buffer );
+    for ( SizeValueType r = 0; r < numberOfRows; r++ )
+      {
+      SizeValueType offset = region.GetIndex(0) * strides[0];
+      for ( unsigned int i = 1; i < nDims; i++ )
+        {
+        offset += ( region.GetIndex(i) + index[i] ) * strides[i];
+        }
+      memcpy(out, &blocks[offset - str.FirstBlock * blockSize], rowSize);
+      out += rowSize;
+      for ( unsigned int i = 1; i < nDims; i++ )
+        {
+        if ( ++index[i] < region.GetSize(i) )
+          {
+          break;
+          }
+        index[i] = 0;
+        }
+      }
+    }
+
+  // the data are in the byte order of the file
+  if ( ( this->GetByteOrder() == BigEndian && airEndianLittle == AIR_ENDIAN )
+       || ( this->GetByteOrder() == LittleEndian && airEndianBig == AIR_ENDIAN ) )
+    {
+    size_t numberOfValues = region.GetNumberOfPixels() * this->GetNumberOfComponents();
+    nrrd = nrrdNew();
+    nrrdWrap_nva(nrrd, buffer, this->ITKToNrrdComponentType(m_ComponentType), 1, &numberOfValues);
+    nrrdSwapEndian(nrrd);
+    nrrd = nrrdNix(nrrd);
+    }
+}
 } // end namespace itk
@@ -0,0 +1,222 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkNrrdImageIO.h"
+#include "itkRGBPixel.h"
+
+// Write images compressed by blocks with several threads, and read them
+// back whole, by regions, and with NrrdIO, which ignores the blocks.
+
+namespace
+{
+typedef itk::Image< short, 3 >                          ImageType;
+typedef itk::Image< itk::RGBPixel< unsigned char >, 3 > RGBImageType;
+
+short ExpectedPixel(const ImageType::IndexType & index)
+{
+  return static_cast< short >( index[0] - 7 * index[1] + 300 * index[2] );
+}
+
+void ExpectedPixel(const RGBImageType::IndexType & index, itk::RGBPixel< unsigned char > & pixel)
+{
+  pixel[0] = static_cast< unsigned char >( index[0] );
+  pixel[1] = static_cast< unsigned char >( index[1] * 3 );
+  pixel[2] = static_cast< unsigned char >( index[2] + index[0] );
+}
+
+bool CheckPixel(const ImageType::IndexType & index, short value)
+{
+  return value == ExpectedPixel(index);
+}
+
+bool CheckPixel(const RGBImageType::IndexType & index,
+                const itk::RGBPixel< unsigned char > & value)
+{
+  itk::RGBPixel< unsigned char > expected;
+  ExpectedPixel(index, expected);
+  return value == expected;
+}
+
+void SetPixel(const ImageType::IndexType & index, short & value)
+{
+  value = ExpectedPixel(index);
+}
+
+void SetPixel(const RGBImageType::IndexType & index, itk::RGBPixel< unsigned char > & value)
+{
+  ExpectedPixel(index, value);
+}
+
+template< class TImage >
+int CheckImage(const TImage *image, const typename TImage::RegionType & region,
+               const std::string & fileName)
+{
+  if ( image->GetBufferedRegion() != region )
+    {
+    std::cerr << fileName << ": the buffered region is " << image->GetBufferedRegion()
+              << " instead of " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ImageRegionConstIteratorWithIndex< TImage > it(image, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    if ( !CheckPixel( it.GetIndex(), it.Get() ) )
+      {
+      std::cerr << fileName << ": wrong pixel at " << it.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+template< class TImage >
+int WriteAndRead(const std::string & fileName, itk::SizeValueType blockSize)
+{
+  typename TImage::SizeType size;
+  size[0] = 45;
+  size[1] = 31;
+  size[2] = 23;
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    typename TImage::PixelType pixel;
+    SetPixel(it.GetIndex(), pixel);
+    it.Set(pixel);
+    }
+
+  itk::NrrdImageIO::Pointer writerIO = itk::NrrdImageIO::New();
+  writerIO->SetCompressionBlockSize(blockSize);
+  typedef itk::ImageFileWriter< TImage > WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+  writer->SetImageIO(writerIO);
+  writer->UseCompressionOn();
+  writer->Update();
+
+  // the whole image, whose dictionary does not hold the offsets
+  typedef itk::ImageFileReader< TImage > ReaderType;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  reader->Update();
+  if ( CheckImage( reader->GetOutput(), image->GetLargestPossibleRegion(), fileName ) != EXIT_SUCCESS )
+    {
+    return EXIT_FAILURE;
+    }
+  if ( !reader->GetImageIO()->CanStreamRead()
+       || reader->GetImageIO()->GetMetaDataDictionary().HasKey("ITK_CompressedDataBlockOffsets") )
+    {
+    std::cerr << fileName << ": the blocks are not read by NrrdImageIO" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // regions which do not start or end on the blocks
+  for ( unsigned int r = 0; r < 3; r++ )
+    {
+    typename TImage::RegionType region = image->GetLargestPossibleRegion();
+    region.SetIndex(2, 2 + 5 * r);
+    region.SetSize(2, 3 + r);
+    if ( r > 0 )
+      {
+      region.SetIndex(1, 3 * r);
+      region.SetSize(1, 11);
+      }
+    if ( r > 1 )
+      {
+      region.SetIndex(0, 9);
+      region.SetSize(0, 13);
+      }
+
+    typename ReaderType::Pointer regionReader = ReaderType::New();
+    regionReader->SetFileName(fileName);
+    regionReader->UseStreamingOn();
+    regionReader->UpdateOutputInformation();
+    regionReader->GetOutput()->SetRequestedRegion(region);
+    regionReader->GetOutput()->Update();
+    if ( CheckImage(regionReader->GetOutput(), region, fileName) != EXIT_SUCCESS )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the data remain a single gzip stream
+  Nrrd *nrrd = nrrdNew();
+  if ( nrrdLoad(nrrd, fileName.c_str(), NULL) != 0 )
+    {
+    char *err = biffGetDone(NRRD);
+    std::cerr << fileName << ": NrrdIO cannot read the file:\n" << err << std::endl;
+    free(err);
+    nrrdNuke(nrrd);
+    return EXIT_FAILURE;
+    }
+  const bool same = nrrdElementNumber(nrrd) * nrrdElementSize(nrrd)
+                    == image->GetPixelContainer()->Size() * sizeof( typename TImage::PixelType )
+                    && !memcmp( nrrd->data, image->GetBufferPointer(),
+                                image->GetPixelContainer()->Size() * sizeof( typename TImage::PixelType ) );
+  nrrdNuke(nrrd);
+  if ( !same )
+    {
+    std::cerr << fileName << ": NrrdIO reads different pixels" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+int itkNrrdImageIOCompressionBlocksTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkIOTests itkNrrdImageIOCompressionBlocksTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::string directory = av[1];
+  int               status = EXIT_SUCCESS;
+  try
+    {
+    // several blocks, a single block, and the blocks of an image whose
+    // pixels are split between blocks
+    if ( WriteAndRead< ImageType >(directory + "/NrrdImageIOCompressionBlocksTest.nrrd", 4096) != EXIT_SUCCESS
+         || WriteAndRead< ImageType >(directory + "/NrrdImageIOCompressionBlocksTest.nhdr", 10000) != EXIT_SUCCESS
+         || WriteAndRead< ImageType >(directory + "/NrrdImageIOCompressionBlocksTest1.nrrd", 1 << 20)
+         != EXIT_SUCCESS
+         || WriteAndRead< RGBImageType >(directory + "/NrrdImageIOCompressionBlocksTestRGB.nrrd", 1000)
+         != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -206,12 +206,14 @@ void RawImageIO< TPixel, VImageDimension >
     if ( m_ByteOrder == LittleEndian )                            \
       {                                                           \
       InternalByteSwapperType::SwapRangeFromSystemToLittleEndian( \
-        (StrongType *)buffer, this->GetImageSizeInComponents() ); \
+        (StrongType *)buffer, this->GetImageSizeInComponents(),   \
+        this->GetNumberOfThreads() );                             \
       }                                                           \
     else if ( m_ByteOrder == BigEndian )                          \
       {                                                           \
       InternalByteSwapperType::SwapRangeFromSystemToBigEndian(    \
-        (StrongType *)buffer, this->GetImageSizeInComponents() ); \
+        (StrongType *)buffer, this->GetImageSizeInComponents(),   \
+        this->GetNumberOfThreads() );                             \
       }                                                           \
     }
 
@@ -276,7 +278,8 @@ void RawImageIO< TPixel, VImageDimension >
       char *tempBuffer = new char[numberOfBytes];                       \
       memcpy(tempBuffer, buffer, numberOfBytes);                        \
       InternalByteSwapperType::SwapRangeFromSystemToLittleEndian(       \
-        (StrongType *)tempBuffer, numberOfComponents);                  \
+        (StrongType *)tempBuffer, numberOfComponents,                   \
+        this->GetNumberOfThreads() );                                   \
       file.write(tempBuffer, numberOfBytes);                            \
       delete[] tempBuffer;                                              \
       }                                                                 \
@@ -285,7 +288,8 @@ void RawImageIO< TPixel, VImageDimension >
       char *tempBuffer = new char[numberOfBytes];                       \
       memcpy(tempBuffer, buffer, numberOfBytes);                        \
       InternalByteSwapperType::SwapRangeFromSystemToBigEndian(          \
-        (StrongType *)tempBuffer, numberOfComponents);                  \
+        (StrongType *)tempBuffer, numberOfComponents,                   \
+        this->GetNumberOfThreads() );                                   \
       file.write(tempBuffer, numberOfBytes);                            \
       delete[] tempBuffer;                                              \
       }                                                                 \
@@ -220,26 +220,31 @@ void StimulateImageIO::Read(void *buffer)
     {
     case CHAR:
       ByteSwapper< char >::SwapRangeFromSystemToBigEndian( (char *)buffer,
-                                                           static_cast< SizeValueType >( this->GetImageSizeInComponents() ) );
+                                                           static_cast< SizeValueType >( this->GetImageSizeInComponents() ),
+                                                           this->GetNumberOfThreads() );
       break;
     case SHORT:
       ByteSwapper< short >::SwapRangeFromSystemToBigEndian( (short *)buffer,
                                                             static_cast< SizeValueType >( this->
-                                                                                          GetImageSizeInComponents() ) );
+                                                                                          GetImageSizeInComponents() ),
+                                                            this->GetNumberOfThreads() );
       break;
     case INT:
       ByteSwapper< int >::SwapRangeFromSystemToBigEndian( (int *)buffer,
-                                                          static_cast< SizeValueType >( this->GetImageSizeInComponents() ) );
+                                                          static_cast< SizeValueType >( this->GetImageSizeInComponents() ),
+                                                          this->GetNumberOfThreads() );
       break;
     case FLOAT:
       ByteSwapper< float >::SwapRangeFromSystemToBigEndian( (float *)buffer,
                                                             static_cast< SizeValueType >( this->
-                                                                                          GetImageSizeInComponents() ) );
+                                                                                          GetImageSizeInComponents() ),
+                                                            this->GetNumberOfThreads() );
       break;
     case DOUBLE:
       ByteSwapper< double >::SwapRangeFromSystemToBigEndian( (double *)buffer,
                                                              static_cast< SizeValueType >( this->
-                                                                                           GetImageSizeInComponents() ) );
+                                                                                           GetImageSizeInComponents() ),
+                                                             this->GetNumberOfThreads() );
       break;
     default:
       break;
@@ -608,26 +613,28 @@ void StimulateImageIO::Write(const void *buffer)
       case CHAR:
         file << "BYTE";
         ByteSwapper< char >::SwapRangeFromSystemToBigEndian(reinterpret_cast< char * >( tempmemory ),
-                                                            numberOfComponents);
+                                                            numberOfComponents, this->GetNumberOfThreads());
         break;
       case SHORT:
         file << "WORD";
         ByteSwapper< short int >::SwapRangeFromSystemToBigEndian(reinterpret_cast< short int * >( tempmemory ),
-                                                                 numberOfComponents);
+                                                                 numberOfComponents,
+                                                                 this->GetNumberOfThreads());
         break;
       case INT:
         file << "LWORD";
-        ByteSwapper< int >::SwapRangeFromSystemToBigEndian(reinterpret_cast< int * >( tempmemory ), numberOfComponents);
+        ByteSwapper< int >::SwapRangeFromSystemToBigEndian(reinterpret_cast< int * >( tempmemory ), numberOfComponents,
+                                                           this->GetNumberOfThreads());
         break;
       case FLOAT:
         file << "REAL";
         ByteSwapper< float >::SwapRangeFromSystemToBigEndian(reinterpret_cast< float * >( tempmemory ),
-                                                             numberOfComponents);
+                                                             numberOfComponents, this->GetNumberOfThreads());
         break;
       case DOUBLE:
         file << "COMPLEX";
         ByteSwapper< double >::SwapRangeFromSystemToBigEndian(reinterpret_cast< double * >( tempmemory ),
-                                                              numberOfComponents);
+                                                              numberOfComponents, this->GetNumberOfThreads());
         break;
       default:
         break;
@@ -25,12 +25,19 @@ namespace itk
 {
 //BTX
 class TIFFReaderInternal;
+class TIFFWriterInternal;
 //ETX
 
 /** \class TIFFImageIO
  *
  * \brief ImageIO object for reading and writing TIFF images
  *
+ * Grayscale and RGB images stored by strips or by tiles, in a single
+ * page or in several pages, are streamed: only the strips or the tiles
+ * of the pages which intersect the requested region are decoded, by up
+ * to NumberOfThreads threads. The images are written by strips, or by tiles when a
+ * tile size is set, and may be streamed by bands of rows or of pages.
+ *
  * \ingroup IOFilters
  *
  * \ingroup ITK-IO-TIFF
@@ -71,6 +78,18 @@ public:
   /** Reads 3D data from tiled tiff. */
   virtual void ReadTiles(void *buffer);
 
+  /** The grayscale and RGB images stored by strips or by tiles can be
+   * streamed. Valid after ReadImageInformation(). */
+  virtual bool CanStreamRead()
+  {
+    return m_ReadStripsOrTiles;
+  }
+
+  /** Returns the requested region when the image can be streamed, the
+   * largest possible region otherwise. */
+  virtual ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requested) const;
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -85,6 +104,30 @@ public:
    * that the IORegion has been set properly. */
   virtual void Write(const void *buffer);
 
+  /** The images are written by bands of rows, or of pages for 3D
+   * images, which are given in order. Pasting is not supported. */
+  virtual bool CanStreamWrite()
+  {
+    return true;
+  }
+
+  /** The bands of rows of the tiled images hold whole tiles. */
+  virtual unsigned int GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                                         const ImageIORegion & pasteRegion,
+                                                         const ImageIORegion & largestPossibleRegion);
+
+  virtual ImageIORegion GetSplitRegionForWriting(unsigned int ithPiece,
+                                                 unsigned int numberOfActualSplits,
+                                                 const ImageIORegion & pasteRegion,
+                                                 const ImageIORegion & largestPossibleRegion);
+
+  /** Set/Get the size of the tiles of the written images, which must be
+   * multiples of 16. 0, the default, writes the images by strips. */
+  itkSetMacro(TileWidth, unsigned int);
+  itkGetConstMacro(TileWidth, unsigned int);
+  itkSetMacro(TileHeight, unsigned int);
+  itkGetConstMacro(TileHeight, unsigned int);
+
   enum { NOFORMAT, RGB_, GRAYSCALE, PALETTE_RGB, PALETTE_GRAYSCALE, OTHER };
 
   //BTX
@@ -131,6 +174,9 @@ protected:
 
   void InternalWrite(const void *buffer);
 
+  /** Reads the strips or the tiles of the IORegion. */
+  void ReadStripsOrTiles(void *buffer);
+
   void InitializeColors();
 
   void ReadGenericImage(void *out,
@@ -158,6 +204,9 @@ protected:
   TIFFReaderInternal *m_InternalImage;
 
   int m_Compression;
+
+  unsigned int m_TileWidth;
+  unsigned int m_TileHeight;
 private:
   TIFFImageIO(const Self &);    //purposely not implemented
   void operator=(const Self &); //purposely not implemented
@@ -167,6 +216,16 @@ private:
   unsigned short *m_ColorBlue;
   int             m_TotalColors;
   unsigned int    m_ImageFormat;
+
+  // Whether the IORegion can be read by strips or tiles
+  bool m_ReadStripsOrTiles;
+
+  // The file being written by bands
+  TIFFWriterInternal *m_InternalWriter;
+
+  // The number of rows, or of pages, of the bands written
+  SizeValueType GetRowsOrPagesPerPiece(unsigned int numberOfSplits,
+                                       const ImageIORegion & largestPossibleRegion) const;
 };
 } // end namespace itk
 
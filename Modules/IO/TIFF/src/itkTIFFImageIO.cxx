@@ -22,6 +22,8 @@
 #include "itkTIFFImageIO.h"
 #include "itkRGBPixel.h"
 #include "itkRGBAPixel.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 #include "itksys/SystemTools.hxx"
 #include <stdio.h>
 #include <stdlib.h>
@@ -71,6 +73,28 @@ public:
   short          m_SampleFormat;
 };
 
+class TIFFWriterInternal
+{
+public:
+  TIFFWriterInternal():m_Image(NULL), m_NextPage(0), m_NextRow(0) {}
+
+  void Close()
+  {
+    if ( this->m_Image )
+      {
+      TIFFClose(this->m_Image);
+      }
+    this->m_Image = NULL;
+    this->m_NextPage = 0;
+    this->m_NextRow = 0;
+  }
+
+  // The file stays open until its last band is written
+  TIFF *       m_Image;
+  unsigned int m_NextPage;
+  unsigned int m_NextRow;
+};
+
 int TIFFReaderInternal::Open(const char *filename)
 {
   this->Clean();
@@ -1273,14 +1297,265 @@ void TIFFImageIO::ReadVolume(void *buffer)
     }
 }
 
+namespace
+{
+// A strip or a tile which intersects the region read
+struct TIFFBlock {
+  uint32       DirectoryOffset;
+  unsigned int Page;
+  bool         Tiled;
+  uint32       X;
+  uint32       Y;
+  uint32       Width;
+  uint32       Height;
+};
+
+struct TIFFBlocksThreadStruct {
+  std::string                    FileName;
+  const std::vector< TIFFBlock > *Blocks;
+  const ImageIORegion            *Region;
+  unsigned int                   PixelSize;
+  unsigned char                  *Buffer;
+  SimpleFastMutexLock            Lock;
+  size_t                         NextBlock;
+  bool                           Failed;
+};
+
+// Each thread decodes the blocks with its own handle on the file
+ITK_THREAD_RETURN_TYPE TIFFBlocksThreaderCallback(void *arg)
+{
+  TIFFBlocksThreadStruct *str = (TIFFBlocksThreadStruct *)
+                                ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  TIFF *tif = TIFFOpen(str->FileName.c_str(), "r");
+  if ( !tif )
+    {
+    str->Lock.Lock();
+    str->Failed = true;
+    str->Lock.Unlock();
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  const ImageIORegion & region = *str->Region;
+  const uint32          regionX = region.GetIndex(0);
+  const uint32          regionY = region.GetIndex(1);
+  const uint32          regionWidth = region.GetSize(0);
+  const uint32          regionHeight = region.GetSize(1);
+  const unsigned int    pixelSize = str->PixelSize;
+
+  uint32                       directoryOffset = TIFFCurrentDirOffset(tif);
+  std::vector< unsigned char > data;
+  bool                         failed = false;
+  while ( !failed )
+    {
+    str->Lock.Lock();
+    failed = str->Failed;
+    const size_t b = str->NextBlock++;
+    str->Lock.Unlock();
+    if ( failed || b >= str->Blocks->size() )
+      {
+      break;
+      }
+    const TIFFBlock & block = ( *str->Blocks )[b];
+
+    if ( block.DirectoryOffset != directoryOffset )
+      {
+      if ( !TIFFSetSubDirectory(tif, block.DirectoryOffset) )
+        {
+        failed = true;
+        break;
+        }
+      directoryOffset = block.DirectoryOffset;
+      }
+
+    tsize_t size;
+    if ( block.Tiled )
+      {
+      data.resize( TIFFTileSize(tif) );
+      size = TIFFReadEncodedTile(tif, TIFFComputeTile(tif, block.X, block.Y, 0, 0),
+                                 &data[0], data.size());
+      }
+    else
+      {
+      data.resize( TIFFStripSize(tif) );
+      size = TIFFReadEncodedStrip(tif, TIFFComputeStrip(tif, block.Y, 0),
+                                  &data[0], data.size());
+      }
+    if ( size < 0 )
+      {
+      failed = true;
+      break;
+      }
+
+    // copy the rows of the block which are inside the region
+    const uint32 x0 = std::max(block.X, regionX);
+    const uint32 x1 = std::min(block.X + block.Width, regionX + regionWidth);
+    const uint32 y0 = std::max(block.Y, regionY);
+    const uint32 y1 = std::min(block.Y + block.Height, regionY + regionHeight);
+    for ( uint32 y = y0; y < y1; y++ )
+      {
+      const size_t in = ( static_cast< size_t >( y - block.Y ) * block.Width + ( x0 - block.X ) ) * pixelSize;
+      if ( in + ( x1 - x0 ) * pixelSize > static_cast< size_t >( size ) )
+        {
+        failed = true;
+        break;
+        }
+      const size_t out = ( ( static_cast< size_t >( block.Page ) * regionHeight + ( y - regionY ) )
+                           * regionWidth + ( x0 - regionX ) ) * pixelSize;
+      memcpy(str->Buffer + out, &data[in], ( x1 - x0 ) * pixelSize);
+      }
+    }
+  TIFFClose(tif);
+
+  if ( failed )
+    {
+    str->Lock.Lock();
+    str->Failed = true;
+    str->Lock.Unlock();
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+}
+
+/** Read the strips or the tiles of the pages which intersect the region */
+void TIFFImageIO::ReadStripsOrTiles(void *buffer)
+{
+  ImageIORegion region(3);
+  for ( unsigned int i = 0; i < 3; i++ )
+    {
+    if ( i < m_IORegion.GetImageDimension() )
+      {
+      region.SetIndex( i, m_IORegion.GetIndex(i) );
+      region.SetSize( i, m_IORegion.GetSize(i) );
+      }
+    else
+      {
+      region.SetIndex(i, 0);
+      region.SetSize(i, 1);
+      }
+    }
+  const unsigned int firstPage = region.GetIndex(2);
+  const unsigned int lastPage = firstPage + region.GetSize(2);
+  const uint32       regionX = region.GetIndex(0);
+  const uint32       regionY = region.GetIndex(1);
+  const uint32       regionX1 = regionX + region.GetSize(0);
+  const uint32       regionY1 = regionY + region.GetSize(1);
+
+  // the blocks of the pages of the region. The pages of the volumes do
+  // not include the reduced images.
+  const bool             volume = m_IORegion.GetImageDimension() > 2 && m_InternalImage->m_NumberOfPages > 1;
+  TIFF *                 tif = m_InternalImage->m_Image;
+  std::vector< TIFFBlock > blocks;
+  unsigned int           page = 0;
+  TIFFSetDirectory(tif, 0);
+  do
+    {
+    if ( volume && m_InternalImage->m_SubFiles > 0 )
+      {
+      int32 subfiletype = 6;
+      if ( TIFFGetField(tif, TIFFTAG_SUBFILETYPE, &subfiletype) && subfiletype != 0 )
+        {
+        continue;
+        }
+      }
+    if ( page >= firstPage )
+      {
+      uint32         width = 0;
+      uint32         height = 0;
+      unsigned short samplesPerPixel = 0;
+      unsigned short bitsPerSample = 0;
+      TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+      TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+      TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+      TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+      if ( width != m_InternalImage->m_Width || height != m_InternalImage->m_Height
+           || samplesPerPixel != m_InternalImage->m_SamplesPerPixel
+           || bitsPerSample != m_InternalImage->m_BitsPerSample )
+        {
+        itkExceptionMacro(<< "The page " << page << " differs from the first page of " << m_FileName);
+        }
+
+      TIFFBlock block;
+      block.DirectoryOffset = TIFFCurrentDirOffset(tif);
+      block.Page = page - firstPage;
+      block.Tiled = TIFFIsTiled(tif) != 0;
+      if ( block.Tiled )
+        {
+        TIFFGetField(tif, TIFFTAG_TILEWIDTH, &block.Width);
+        TIFFGetField(tif, TIFFTAG_TILELENGTH, &block.Height);
+        }
+      else
+        {
+        block.Width = width;
+        TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &block.Height);
+        block.Height = std::min(block.Height, height);
+        }
+      if ( block.Width == 0 || block.Height == 0 )
+        {
+        itkExceptionMacro(<< "Invalid strips or tiles in " << m_FileName);
+        }
+      for ( block.Y = regionY - regionY % block.Height; block.Y < regionY1; block.Y += block.Height )
+        {
+        for ( block.X = regionX - regionX % block.Width; block.X < regionX1; block.X += block.Width )
+          {
+          blocks.push_back(block);
+          }
+        }
+      }
+    page++;
+    }
+  while ( page < lastPage && TIFFReadDirectory(tif) );
+
+  if ( page < lastPage )
+    {
+    itkExceptionMacro(<< "Cannot find the page " << page << " in " << m_FileName);
+    }
+
+  TIFFBlocksThreadStruct str;
+  str.FileName = m_FileName;
+  str.Blocks = &blocks;
+  str.Region = &region;
+  str.PixelSize = this->GetPixelSize();
+  str.Buffer = static_cast< unsigned char * >( buffer );
+  str.NextBlock = 0;
+  str.Failed = false;
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( std::min( this->GetNumberOfThreads(),
+                                          static_cast< int >( blocks.size() ) ) );
+  threader->SetSingleMethod(TIFFBlocksThreaderCallback, &str);
+  threader->SingleMethodExecute();
+
+  if ( str.Failed )
+    {
+    itkExceptionMacro(<< "Cannot read the strips or the tiles of " << m_FileName);
+    }
+}
+
 void TIFFImageIO::Read(void *buffer)
 {
+  // The file is closed after each read, when streaming
+  if ( !m_InternalImage->m_IsOpen )
+    {
+    if ( !m_InternalImage->Open( m_FileName.c_str() ) )
+      {
+      itkExceptionMacro(<< "Cannot open the file: " << m_FileName);
+      }
+    }
+
   if ( m_InternalImage->m_Compression == COMPRESSION_OJPEG )
     {
     itkExceptionMacro(<< "This reader cannot read old JPEG compression");
     return;
     }
 
+  if ( m_ReadStripsOrTiles )
+    {
+    this->ReadStripsOrTiles(buffer);
+    m_InternalImage->Clean();
+    return;
+    }
+
   // The IO region should be of dimensions 3 otherwise we read only the first
   // page
   if ( m_InternalImage->m_NumberOfPages > 0 && this->GetIORegion().GetImageDimension() > 2 )
@@ -1383,6 +1658,11 @@ TIFFImageIO::TIFFImageIO()
 
   m_Compression = TIFFImageIO::PackBits;
 
+  m_TileWidth = 0;
+  m_TileHeight = 0;
+  m_ReadStripsOrTiles = false;
+  m_InternalWriter = new TIFFWriterInternal;
+
   this->AddSupportedWriteExtension(".tif");
   this->AddSupportedWriteExtension(".TIF");
   this->AddSupportedWriteExtension(".tiff");
@@ -1398,12 +1678,16 @@ TIFFImageIO::~TIFFImageIO()
 {
   m_InternalImage->Clean();
   delete m_InternalImage;
+  m_InternalWriter->Close();
+  delete m_InternalWriter;
 }
 
 void TIFFImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "Compression: " << m_Compression << "\n";
+  os << indent << "TileWidth: " << m_TileWidth << "\n";
+  os << indent << "TileHeight: " << m_TileHeight << "\n";
 }
 
 void TIFFImageIO::InitializeColors()
@@ -1543,9 +1827,30 @@ void TIFFImageIO::ReadImageInformation()
     m_Origin[2] = 0.0;
     }
 
+  // The grayscale and RGB images whose samples are decoded as they are
+  // stored can be read by strips or tiles
+  m_ReadStripsOrTiles = m_InternalImage->CanRead()
+                        && m_InternalImage->m_NumberOfTiles == 0
+                        && m_InternalImage->m_Orientation == ORIENTATION_TOPLEFT
+                        && ( ( m_InternalImage->m_Photometrics == PHOTOMETRIC_MINISBLACK
+                               && m_InternalImage->m_SamplesPerPixel == 1 )
+                             || ( m_InternalImage->m_Photometrics == PHOTOMETRIC_RGB
+                                  && m_InternalImage->m_SamplesPerPixel == 3 ) );
+
   return;
 }
 
+ImageIORegion
+TIFFImageIO
+::GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const
+{
+  if ( m_UseStreamedReading && m_ReadStripsOrTiles )
+    {
+    return requestedRegion;
+    }
+  return Superclass::GenerateStreamableReadRegionFromRequestedRegion(requestedRegion);
+}
+
 bool TIFFImageIO::CanWriteFile(const char *name)
 {
   std::string filename = name;
@@ -1649,6 +1954,67 @@ public:
   static void TIFFUnmapFile(thandle_t, tdata_t, toff_t) {}
 };
 
+TIFFImageIO::SizeValueType
+TIFFImageIO::GetRowsOrPagesPerPiece(unsigned int numberOfSplits,
+                                    const ImageIORegion & largestPossibleRegion) const
+{
+  const unsigned int  axis = largestPossibleRegion.GetImageDimension() > 2 ? 2 : 1;
+  const SizeValueType size = largestPossibleRegion.GetSize(axis);
+  SizeValueType       perPiece = ( size + numberOfSplits - 1 ) / numberOfSplits;
+
+  if ( axis == 1 && m_TileWidth > 0 && m_TileHeight > 0 )
+    {
+    perPiece = ( ( perPiece + m_TileHeight - 1 ) / m_TileHeight ) * m_TileHeight;
+    }
+  return std::max( perPiece, static_cast< SizeValueType >( 1 ) );
+}
+
+unsigned int
+TIFFImageIO::GetActualNumberOfSplitsForWriting(unsigned int numberOfRequestedSplits,
+                                               const ImageIORegion & pasteRegion,
+                                               const ImageIORegion & largestPossibleRegion)
+{
+  if ( pasteRegion != largestPossibleRegion )
+    {
+    itkExceptionMacro( "Pasting is not supported! Can't write:" << this->GetFileName() );
+    }
+  if ( largestPossibleRegion.GetImageDimension() < 2 || numberOfRequestedSplits <= 1 )
+    {
+    return 1;
+    }
+
+  const unsigned int  axis = largestPossibleRegion.GetImageDimension() > 2 ? 2 : 1;
+  const SizeValueType perPiece = this->GetRowsOrPagesPerPiece(numberOfRequestedSplits, largestPossibleRegion);
+  return static_cast< unsigned int >( ( largestPossibleRegion.GetSize(axis) + perPiece - 1 ) / perPiece );
+}
+
+ImageIORegion
+TIFFImageIO::GetSplitRegionForWriting(unsigned int ithPiece,
+                                      unsigned int numberOfActualSplits,
+                                      const ImageIORegion & itkNotUsed(pasteRegion),
+                                      const ImageIORegion & largestPossibleRegion)
+{
+  ImageIORegion splitRegion = largestPossibleRegion;
+  if ( largestPossibleRegion.GetImageDimension() < 2 || numberOfActualSplits <= 1 )
+    {
+    return splitRegion;
+    }
+
+  const unsigned int  axis = largestPossibleRegion.GetImageDimension() > 2 ? 2 : 1;
+  const SizeValueType perPiece = this->GetRowsOrPagesPerPiece(numberOfActualSplits, largestPossibleRegion);
+  const SizeValueType first = ithPiece * perPiece;
+  splitRegion.SetIndex(axis, largestPossibleRegion.GetIndex(axis) + first);
+  if ( ithPiece + 1 < numberOfActualSplits )
+    {
+    splitRegion.SetSize(axis, perPiece);
+    }
+  else
+    {
+    splitRegion.SetSize(axis, largestPossibleRegion.GetSize(axis) - first);
+    }
+  return splitRegion;
+}
+
 void TIFFImageIO::InternalWrite(const void *buffer)
 {
   char *outPtr = (char *)buffer;
@@ -1662,6 +2028,52 @@ void TIFFImageIO::InternalWrite(const void *buffer)
     pages = m_Dimensions[2];
     }
 
+  // The buffer holds a band of rows of a 2D image, or of pages of a 3D
+  // image. The bands are written in order to the file, which stays open
+  // until its last band is written.
+  unsigned int firstRow = 0;
+  unsigned int lastRow = height;
+  unsigned int firstPage = 0;
+  unsigned int lastPage = pages;
+  if ( m_IORegion.GetImageDimension() >= 2 )
+    {
+    if ( m_IORegion.GetIndex(0) != 0 || m_IORegion.GetSize(0) != width )
+      {
+      itkExceptionMacro(<< "TIFFImageIO can only write whole rows: " << m_IORegion);
+      }
+    if ( m_NumberOfDimensions == 3 )
+      {
+      if ( m_IORegion.GetIndex(1) != 0 || m_IORegion.GetSize(1) != height )
+        {
+        itkExceptionMacro(<< "TIFFImageIO can only write whole pages: " << m_IORegion);
+        }
+      if ( m_IORegion.GetImageDimension() > 2 )
+        {
+        firstPage = m_IORegion.GetIndex(2);
+        lastPage = firstPage + m_IORegion.GetSize(2);
+        }
+      }
+    else
+      {
+      firstRow = m_IORegion.GetIndex(1);
+      lastRow = firstRow + m_IORegion.GetSize(1);
+      }
+    }
+
+  const bool tiled = m_TileWidth > 0 && m_TileHeight > 0;
+  if ( tiled )
+    {
+    if ( m_TileWidth % 16 != 0 || m_TileHeight % 16 != 0 )
+      {
+      itkExceptionMacro(<< "The size of the tiles must be a multiple of 16: "
+                        << m_TileWidth << "x" << m_TileHeight);
+      }
+    if ( firstRow % m_TileHeight != 0 || ( lastRow % m_TileHeight != 0 && lastRow != height ) )
+      {
+      itkExceptionMacro(<< "The rows written must hold whole tiles: " << m_IORegion);
+      }
+    }
+
   int    scomponents = this->GetNumberOfComponents();
   double resolution = -1;
   uint32 rowsperstrip = ( uint32 ) - 1;
@@ -1688,126 +2100,155 @@ void TIFFImageIO::InternalWrite(const void *buffer)
 
   int predictor;
 
-  TIFF *tif = TIFFOpen(m_FileName.c_str(), "w");
-  if ( !tif )
+  TIFF *tif;
+  if ( firstRow == 0 && firstPage == 0 )
     {
-    itkExceptionMacro( "Error while trying to open file for writing: "
-                       << this->GetFileName()
-                       << std::endl
-                       << "Reason: "
-                       << itksys::SystemTools::GetLastSystemError() );
-    }
+    m_InternalWriter->Close();
+    tif = TIFFOpen(m_FileName.c_str(), "w");
+    if ( !tif )
+      {
+      itkExceptionMacro( "Error while trying to open file for writing: "
+                         << this->GetFileName()
+                         << std::endl
+                         << "Reason: "
+                         << itksys::SystemTools::GetLastSystemError() );
+      }
+    m_InternalWriter->m_Image = tif;
+
+    if ( this->GetComponentType() == SHORT
+         || this->GetComponentType() == CHAR )
+      {
+      TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_INT);
+      }
 
-  if ( this->GetComponentType() == SHORT
-       || this->GetComponentType() == CHAR )
+    if ( m_NumberOfDimensions == 3 )
+      {
+      TIFFCreateDirectory(tif);
+      }
+    }
+  else
     {
-    TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_INT);
+    tif = m_InternalWriter->m_Image;
+    if ( !tif || firstPage != m_InternalWriter->m_NextPage || firstRow != m_InternalWriter->m_NextRow )
+      {
+      m_InternalWriter->Close();
+      itkExceptionMacro(<< "The bands of " << m_FileName << " must be written in order: " << m_IORegion);
+      }
     }
 
   uint32 w = width;
   uint32 h = height;
 
-  if ( m_NumberOfDimensions == 3 )
-    {
-    TIFFCreateDirectory(tif);
-    }
-  for ( page = 0; page < pages; page++ )
+  for ( page = firstPage; page < lastPage; page++ )
     {
-    TIFFSetDirectory(tif, page);
-    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, w);
-    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, h);
-    TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
-    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, scomponents);
-    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bps); // Fix for stype
-    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-    if ( this->GetComponentType() == SHORT
-         || this->GetComponentType() == CHAR )
+    // the directory of a 2D image is set up by its first band
+    if ( firstRow == 0 )
       {
-      TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_INT);
-      }
-    TIFFSetField(tif, TIFFTAG_SOFTWARE, "InsightToolkit");
+      TIFFSetDirectory(tif, page);
+      TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, w);
+      TIFFSetField(tif, TIFFTAG_IMAGELENGTH, h);
+      TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+      TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, scomponents);
+      TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bps); // Fix for stype
+      TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+      if ( this->GetComponentType() == SHORT
+           || this->GetComponentType() == CHAR )
+        {
+        TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_INT);
+        }
+      TIFFSetField(tif, TIFFTAG_SOFTWARE, "InsightToolkit");
 
-    if ( scomponents > 3 )
-      {
-      // if number of scalar components is greater than 3, that means we assume
-      // there is alpha.
-      uint16  extra_samples = scomponents - 3;
-      uint16 *sample_info = new uint16[scomponents - 3];
-      sample_info[0] = EXTRASAMPLE_ASSOCALPHA;
-      int cc;
-      for ( cc = 1; cc < scomponents - 3; cc++ )
+      if ( scomponents > 3 )
         {
-        sample_info[cc] = EXTRASAMPLE_UNSPECIFIED;
+        // if number of scalar components is greater than 3, that means we assume
+        // there is alpha.
+        uint16  extra_samples = scomponents - 3;
+        uint16 *sample_info = new uint16[scomponents - 3];
+        sample_info[0] = EXTRASAMPLE_ASSOCALPHA;
+        int cc;
+        for ( cc = 1; cc < scomponents - 3; cc++ )
+          {
+          sample_info[cc] = EXTRASAMPLE_UNSPECIFIED;
+          }
+        TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, extra_samples,
+                     sample_info);
+        delete[] sample_info;
         }
-      TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, extra_samples,
-                   sample_info);
-      delete[] sample_info;
-      }
 
-    int compression;
+      int compression;
 
-    if ( m_UseCompression )
-      {
-      switch ( m_Compression )
+      if ( m_UseCompression )
         {
-        case TIFFImageIO::PackBits:
-          compression = COMPRESSION_PACKBITS; break;
-        case TIFFImageIO::JPEG:
-          compression = COMPRESSION_JPEG; break;
-        case TIFFImageIO::Deflate:
-          compression = COMPRESSION_DEFLATE; break;
-        case TIFFImageIO::LZW:
-          compression = COMPRESSION_LZW; break;
-        default:
-          compression = COMPRESSION_NONE;
+        switch ( m_Compression )
+          {
+          case TIFFImageIO::PackBits:
+            compression = COMPRESSION_PACKBITS; break;
+          case TIFFImageIO::JPEG:
+            compression = COMPRESSION_JPEG; break;
+          case TIFFImageIO::Deflate:
+            compression = COMPRESSION_DEFLATE; break;
+          case TIFFImageIO::LZW:
+            compression = COMPRESSION_LZW; break;
+          default:
+            compression = COMPRESSION_NONE;
+          }
+        }
+      else
+        {
+        compression = COMPRESSION_NONE;
         }
-      }
-    else
-      {
-      compression = COMPRESSION_NONE;
-      }
 
-    TIFFSetField(tif, TIFFTAG_COMPRESSION, compression); // Fix for compression
+      TIFFSetField(tif, TIFFTAG_COMPRESSION, compression); // Fix for compression
 
-    uint16 photometric = ( scomponents == 1 ) ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB;
+      uint16 photometric = ( scomponents == 1 ) ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB;
 
-    if ( compression == COMPRESSION_JPEG )
-      {
-      TIFFSetField(tif, TIFFTAG_JPEGQUALITY, 75); // Parameter
-      TIFFSetField(tif, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
-      photometric = PHOTOMETRIC_YCBCR;
-      }
-    else if ( compression == COMPRESSION_LZW )
-      {
-      predictor = 2;
-      TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
-      itkDebugMacro(<< "LZW compression is patented outside US so it is disabled");
-      }
-    else if ( compression == COMPRESSION_DEFLATE )
-      {
-      predictor = 2;
-      TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
-      }
+      if ( compression == COMPRESSION_JPEG )
+        {
+        TIFFSetField(tif, TIFFTAG_JPEGQUALITY, 75); // Parameter
+        TIFFSetField(tif, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+        photometric = PHOTOMETRIC_YCBCR;
+        }
+      else if ( compression == COMPRESSION_LZW )
+        {
+        predictor = 2;
+        TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
+        itkDebugMacro(<< "LZW compression is patented outside US so it is disabled");
+        }
+      else if ( compression == COMPRESSION_DEFLATE )
+        {
+        predictor = 2;
+        TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor);
+        }
 
-    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, photometric); // Fix for scomponents
+      TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, photometric); // Fix for scomponents
 
-    TIFFSetField( tif,
-                  TIFFTAG_ROWSPERSTRIP,
-                  TIFFDefaultStripSize(tif, rowsperstrip) );
-    if ( resolution > 0 )
-      {
-      TIFFSetField(tif, TIFFTAG_XRESOLUTION, resolution);
-      TIFFSetField(tif, TIFFTAG_YRESOLUTION, resolution);
-      TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, RESUNIT_INCH);
-      }
+      if ( tiled )
+        {
+        TIFFSetField(tif, TIFFTAG_TILEWIDTH, m_TileWidth);
+        TIFFSetField(tif, TIFFTAG_TILELENGTH, m_TileHeight);
+        }
+      else
+        {
+        TIFFSetField( tif,
+                      TIFFTAG_ROWSPERSTRIP,
+                      TIFFDefaultStripSize(tif, rowsperstrip) );
+        }
+      if ( resolution > 0 )
+        {
+        TIFFSetField(tif, TIFFTAG_XRESOLUTION, resolution);
+        TIFFSetField(tif, TIFFTAG_YRESOLUTION, resolution);
+        TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, RESUNIT_INCH);
+        }
 
-    if ( m_NumberOfDimensions == 3 )
-      {
-      // We are writing single page of the multipage file
-      TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
-      // Set the page number
-      TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, pages);
+      if ( m_NumberOfDimensions == 3 )
+        {
+        // We are writing single page of the multipage file
+        TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE);
+        // Set the page number
+        TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, pages);
+        }
       }
+
     int rowLength; // in bytes
 
     switch ( this->GetComponentType() )
@@ -1832,16 +2273,43 @@ void TIFFImageIO::InternalWrite(const void *buffer)
     rowLength *= this->GetNumberOfComponents();
     rowLength *= width;
 
-    int row = 0;
-    for ( unsigned int idx2 = 0; idx2 < height; idx2++ )
+    if ( tiled )
       {
-      if ( TIFFWriteScanline(tif, const_cast< char * >( outPtr ), row, 0) < 0 )
+      // the tiles at the right and bottom borders are padded with zeros
+      std::vector< char > tile( TIFFTileSize(tif) );
+      for ( unsigned int y = firstRow; y < lastRow; y += m_TileHeight )
         {
-        itkExceptionMacro(<< "TIFFImageIO: error out of disk space");
-        break;
+        const unsigned int tileRows = std::min(m_TileHeight, height - y);
+        for ( unsigned int x = 0; x < width; x += m_TileWidth )
+          {
+          const unsigned int tileRowLength = std::min(m_TileWidth, width - x) * ( rowLength / width );
+          std::fill(tile.begin(), tile.end(), 0);
+          for ( unsigned int yy = 0; yy < tileRows; yy++ )
+            {
+            memcpy(&tile[yy * m_TileWidth * ( rowLength / width )],
+                   outPtr + ( y - firstRow + yy ) * rowLength + x * ( rowLength / width ),
+                   tileRowLength);
+            }
+          if ( TIFFWriteEncodedTile(tif, TIFFComputeTile(tif, x, y, 0, 0), &tile[0], tile.size()) < 0 )
+            {
+            m_InternalWriter->Close();
+            itkExceptionMacro(<< "TIFFImageIO: error out of disk space");
+            }
+          }
+        }
+      outPtr += ( lastRow - firstRow ) * rowLength;
+      }
+    else
+      {
+      for ( unsigned int row = firstRow; row < lastRow; row++ )
+        {
+        if ( TIFFWriteScanline(tif, const_cast< char * >( outPtr ), row, 0) < 0 )
+          {
+          m_InternalWriter->Close();
+          itkExceptionMacro(<< "TIFFImageIO: error out of disk space");
+          }
+        outPtr += rowLength;
         }
-      outPtr += rowLength;
-      row++;
       }
 
     if ( m_NumberOfDimensions == 3 )
@@ -1849,7 +2317,20 @@ void TIFFImageIO::InternalWrite(const void *buffer)
       TIFFWriteDirectory(tif);
       }
     }
-  TIFFClose(tif);
+
+  // the file is closed after its last band
+  if ( lastPage == pages && lastRow == height )
+    {
+    m_InternalWriter->Close();
+    }
+  else if ( m_NumberOfDimensions == 3 )
+    {
+    m_InternalWriter->m_NextPage = lastPage;
+    }
+  else
+    {
+    m_InternalWriter->m_NextRow = lastRow;
+    }
 }
 
 bool TIFFImageIO::CanFindTIFFTag(unsigned int t)
@@ -0,0 +1,228 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkTIFFImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkRGBPixel.h"
+
+// Write TIFF images by strips and by tiles, streaming them from a
+// streamed reader, and read them back whole and by regions.
+
+namespace
+{
+typedef itk::Image< itk::RGBPixel< unsigned char >, 2 > RGBImageType;
+typedef itk::Image< short, 3 >                          VolumeType;
+
+void ExpectedPixel(const RGBImageType::IndexType & index, itk::RGBPixel< unsigned char > & pixel)
+{
+  pixel[0] = static_cast< unsigned char >( index[0] );
+  pixel[1] = static_cast< unsigned char >( index[1] * 3 );
+  pixel[2] = static_cast< unsigned char >( index[0] + index[1] );
+}
+
+void ExpectedPixel(const VolumeType::IndexType & index, short & pixel)
+{
+  pixel = static_cast< short >( index[0] - 7 * index[1] + 300 * index[2] );
+}
+
+template< class TImage >
+typename TImage::Pointer CreateImage(const typename TImage::SizeType & size)
+{
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< TImage > it( image, image->GetBufferedRegion() );
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    typename TImage::PixelType pixel;
+    ExpectedPixel(it.GetIndex(), pixel);
+    it.Set(pixel);
+    }
+  return image;
+}
+
+template< class TImage >
+int CheckImage(const TImage *image, const typename TImage::RegionType & region,
+               const std::string & fileName)
+{
+  if ( image->GetBufferedRegion() != region )
+    {
+    std::cerr << fileName << ": the buffered region is " << image->GetBufferedRegion()
+              << " instead of " << region << std::endl;
+    return EXIT_FAILURE;
+    }
+  itk::ImageRegionConstIteratorWithIndex< TImage > it(image, region);
+  for ( ; !it.IsAtEnd(); ++it )
+    {
+    typename TImage::PixelType expected;
+    ExpectedPixel(it.GetIndex(), expected);
+    if ( it.Get() != expected )
+      {
+      std::cerr << fileName << ": wrong pixel at " << it.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+// Write the image by strips, stream it to a file written by bands of
+// tiles, and read regions of both files
+template< class TImage >
+int WriteAndRead(const typename TImage::SizeType & size, const std::string & stripsFileName,
+                 const std::string & tilesFileName, const typename TImage::RegionType & region)
+{
+  typedef itk::ImageFileWriter< TImage > WriterType;
+  typedef itk::ImageFileReader< TImage > ReaderType;
+
+  typename TImage::Pointer image = CreateImage< TImage >(size);
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(image);
+  writer->SetFileName(stripsFileName);
+  writer->Update();
+
+  typename ReaderType::Pointer streamingReader = ReaderType::New();
+  streamingReader->SetFileName(stripsFileName);
+  streamingReader->UseStreamingOn();
+
+  itk::TIFFImageIO::Pointer tilesIO = itk::TIFFImageIO::New();
+  tilesIO->SetTileWidth(32);
+  tilesIO->SetTileHeight(16);
+  typename WriterType::Pointer tilesWriter = WriterType::New();
+  tilesWriter->SetInput( streamingReader->GetOutput() );
+  tilesWriter->SetFileName(tilesFileName);
+  tilesWriter->SetImageIO(tilesIO);
+  tilesWriter->SetNumberOfStreamDivisions(5);
+  tilesWriter->Update();
+
+  // the reader gave the last band
+  if ( streamingReader->GetOutput()->GetBufferedRegion() == image->GetLargestPossibleRegion() )
+    {
+    std::cerr << tilesFileName << " was not streamed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::string fileNames[2] = { stripsFileName, tilesFileName };
+  for ( unsigned int f = 0; f < 2; f++ )
+    {
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(fileNames[f]);
+    reader->Update();
+    if ( CheckImage( reader->GetOutput(), image->GetLargestPossibleRegion(), fileNames[f] ) != EXIT_SUCCESS )
+      {
+      return EXIT_FAILURE;
+      }
+
+    typename ReaderType::Pointer regionReader = ReaderType::New();
+    regionReader->SetFileName(fileNames[f]);
+    regionReader->UseStreamingOn();
+    regionReader->UpdateOutputInformation();
+    regionReader->GetOutput()->SetRequestedRegion(region);
+    regionReader->GetOutput()->Update();
+    if ( CheckImage(regionReader->GetOutput(), region, fileNames[f]) != EXIT_SUCCESS )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+int itkTIFFImageIOStreamingTest(int ac, char *av[])
+{
+  if ( ac < 2 )
+    {
+    std::cerr << "usage: itkIOTests itkTIFFImageIOStreamingTest outputDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::string directory = av[1];
+
+  int status = EXIT_SUCCESS;
+  try
+    {
+    // a 2D RGB image, whose tiles overlap the borders
+    RGBImageType::SizeType rgbSize;
+    rgbSize[0] = 150;
+    rgbSize[1] = 101;
+    RGBImageType::RegionType rgbRegion;
+    rgbRegion.SetIndex(0, 37);
+    rgbRegion.SetIndex(1, 20);
+    rgbRegion.SetSize(0, 70);
+    rgbRegion.SetSize(1, 45);
+    if ( WriteAndRead< RGBImageType >(rgbSize, directory + "/TIFFImageIOStreamingTestStrips.tif",
+                                      directory + "/TIFFImageIOStreamingTestTiles.tif",
+                                      rgbRegion) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    // a multi-page image, streamed by pages
+    VolumeType::SizeType volumeSize;
+    volumeSize[0] = 40;
+    volumeSize[1] = 30;
+    volumeSize[2] = 12;
+    VolumeType::RegionType volumeRegion;
+    volumeRegion.SetIndex(0, 3);
+    volumeRegion.SetIndex(1, 17);
+    volumeRegion.SetIndex(2, 5);
+    volumeRegion.SetSize(0, 33);
+    volumeRegion.SetSize(1, 9);
+    volumeRegion.SetSize(2, 4);
+    if ( WriteAndRead< VolumeType >(volumeSize, directory + "/TIFFImageIOStreamingTestPages.tif",
+                                    directory + "/TIFFImageIOStreamingTestTiledPages.tif",
+                                    volumeRegion) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cerr << ex << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // pasting is not supported
+  RGBImageType::SizeType size;
+  size[0] = 20;
+  size[1] = 20;
+  typedef itk::ImageFileWriter< RGBImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( CreateImage< RGBImageType >(size) );
+  writer->SetFileName(directory + "/TIFFImageIOStreamingTestPaste.tif");
+  itk::ImageIORegion pasteRegion(2);
+  pasteRegion.SetSize(0, 10);
+  pasteRegion.SetSize(1, 10);
+  writer->SetIORegion(pasteRegion);
+  try
+    {
+    writer->Update();
+    std::cerr << "Pasting is not reported" << std::endl;
+    status = EXIT_FAILURE;
+    }
+  catch ( itk::ExceptionObject & ex )
+    {
+    std::cout << "Caught expected exception: " << ex.GetDescription() << std::endl;
+    }
+
+  return status;
+}
@@ -579,13 +579,16 @@ void VTKImageIO::Read(void *buffer)
         case 1:
           break;
         case 2:
-          ByteSwapper< uint16_t >::SwapRangeFromSystemToBigEndian( (uint16_t *)buffer, this->GetImageSizeInComponents() );
+          ByteSwapper< uint16_t >::SwapRangeFromSystemToBigEndian( (uint16_t *)buffer, this->GetImageSizeInComponents(),
+                                                                   this->GetNumberOfThreads() );
           break;
         case 4:
-          ByteSwapper< uint32_t >::SwapRangeFromSystemToBigEndian( (uint32_t *)buffer, this->GetImageSizeInComponents() );
+          ByteSwapper< uint32_t >::SwapRangeFromSystemToBigEndian( (uint32_t *)buffer, this->GetImageSizeInComponents(),
+                                                                   this->GetNumberOfThreads() );
           break;
         case 8:
-          ByteSwapper< uint64_t >::SwapRangeFromSystemToBigEndian( (uint64_t *)buffer, this->GetImageSizeInComponents() );
+          ByteSwapper< uint64_t >::SwapRangeFromSystemToBigEndian( (uint64_t *)buffer, this->GetImageSizeInComponents(),
+                                                                   this->GetNumberOfThreads() );
           break;
         default:
           itkExceptionMacro(<< "Unknown component size" << size);
@@ -962,17 +965,20 @@ void VTKImageIO::Write(const void *buffer)
           case 2:
             ByteSwapper< uint16_t >::SwapRangeFromSystemToBigEndian( (uint16_t *)( tempmemory ),
                                                                      static_cast< BufferSizeType >( this->
-                                                                                                    GetImageSizeInComponents() ) );
+                                                                                                    GetImageSizeInComponents() ),
+                                                                     this->GetNumberOfThreads() );
             break;
           case 4:
             ByteSwapper< uint32_t >::SwapRangeFromSystemToBigEndian( (uint32_t *)( tempmemory ),
                                                                      static_cast< BufferSizeType >( this->
-                                                                                                    GetImageSizeInComponents() ) );
+                                                                                                    GetImageSizeInComponents() ),
+                                                                     this->GetNumberOfThreads() );
             break;
           case 8:
             ByteSwapper< uint64_t >::SwapRangeFromSystemToBigEndian( (uint64_t *)( tempmemory ),
                                                                      static_cast< BufferSizeType >( this->
-                                                                                                    GetImageSizeInComponents() ) );
+                                                                                                    GetImageSizeInComponents() ),
+                                                                     this->GetNumberOfThreads() );
             break;
           }
 
@@ -137,6 +137,7 @@ public:
   typedef typename Superclass::ParametersValueType ParametersValueType;
   /** Jacobian type. */
   typedef typename Superclass::JacobianType JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   /** Standard coordinate point type for this class. */
   typedef typename Superclass::InputPointType  InputPointType;
   typedef typename Superclass::OutputPointType OutputPointType;
@@ -323,6 +324,15 @@ public:
    */
   virtual const JacobianType & GetJacobian(const InputPointType  &) const;
 
+  /** Compute the part of the jacobian which may be non zero, by
+   * concatenating the ones of the transforms to optimize, in the same
+   * order as GetJacobian(). */
+  virtual void GetSparseJacobian(const InputPointType & p,
+                                 JacobianType & jacobian,
+                                 NonZeroJacobianIndicesType & nonZeroJacobianIndices) const;
+
+  virtual unsigned int GetNumberOfNonZeroJacobianIndices(void) const;
+
   /** Get/Set Parameter functions work on the current list of transforms
       that are set to be optimized (active) using the
       'Set[Nth|All]TransformToOptimze' routines.
@@ -188,6 +188,68 @@ CompositeTransform<TScalar, NDimensions>
   return this->m_Jacobian;
 }
 
+template
+<class TScalar, unsigned int NDimensions>
+void
+CompositeTransform<TScalar, NDimensions>
+::GetSparseJacobian( const InputPointType & p,
+                     JacobianType & jacobian,
+                     NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
+{
+  const unsigned int numberOfIndices = this->GetNumberOfNonZeroJacobianIndices();
+  if( jacobian.rows() != NDimensions || jacobian.cols() != numberOfIndices )
+    {
+    jacobian.SetSize( NDimensions, numberOfIndices );
+    }
+  if( nonZeroJacobianIndices.Size() != numberOfIndices )
+    {
+    nonZeroJacobianIndices.SetSize( numberOfIndices );
+    }
+
+  JacobianType               subJacobian;
+  NonZeroJacobianIndicesType subIndices;
+  unsigned int               parameterOffset = 0;
+  unsigned int               column = 0;
+  OutputPointType            transformedPoint( p );
+
+  for( signed long tind = (signed long) this->GetNumberOfTransforms()-1;
+        tind >= 0; tind-- )
+    {
+    TransformTypePointer transform = this->GetNthTransform( tind );
+    if( this->GetNthTransformToOptimize( tind ) )
+      {
+      transform->GetSparseJacobian( transformedPoint, subJacobian, subIndices );
+      jacobian.update( subJacobian, 0, column );
+      for( unsigned int k = 0; k < subIndices.Size(); k++ )
+        {
+        nonZeroJacobianIndices[column + k] = subIndices[k] + parameterOffset;
+        }
+      column += subIndices.Size();
+      parameterOffset += transform->GetNumberOfParameters();
+      }
+    /* Transform the point so it's ready for next transform's Jacobian */
+    transformedPoint = transform->TransformPoint( transformedPoint );
+    }
+}
+
+template
+<class TScalar, unsigned int NDimensions>
+unsigned int
+CompositeTransform<TScalar, NDimensions>
+::GetNumberOfNonZeroJacobianIndices(void) const
+{
+  unsigned int result = 0;
+  typename TransformQueueType::iterator it;
+  TransformQueueType transforms = this->GetTransformsToOptimizeQueue();
+
+  for( it = transforms.begin(); it != transforms.end(); ++it )
+    {
+    result += (*it)->GetNumberOfNonZeroJacobianIndices();
+    }
+
+  return result;
+}
+
 template
 <class TScalar, unsigned int NDimensions>
 const typename CompositeTransform< TScalar, NDimensions >::ParametersType &
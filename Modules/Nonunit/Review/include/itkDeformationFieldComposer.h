@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkDeformationFieldComposer_h
+#define __itkDeformationFieldComposer_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include "itkImageRegionSplitter.h"
+
+namespace itk
+{
+/** \class DeformationFieldComposer
+ * \brief Composes two deformation fields in a single multithreaded pass.
+ *
+ * Compose() computes the deformation field of the transformation
+ * outer o inner, that is
+ *
+ *    \f[
+ *      output(x) = inner(x) + outer(x + inner(x))
+ *    \f]
+ *
+ * The outer field is interpolated linearly, and extrapolated with its
+ * nearest pixel outside of its buffer. The result is the one of a
+ * WarpVectorImageFilter using a
+ * VectorLinearInterpolateNearestNeighborExtrapolateImageFunction followed
+ * by an AddImageFilter, without the intermediate warped field.
+ *
+ * The output field is written in place: it must be allocated by the
+ * caller with the geometry and the buffered region of the inner field.
+ * The output may be the inner field itself, but not the outer field,
+ * which is read around each pixel. Filters composing fields repeatedly,
+ * such as ExponentialDeformationFieldImageFilter, can therefore swap
+ * the pixel containers of two fields instead of allocating a new field
+ * at each composition.
+ *
+ * \sa ExponentialDeformationFieldImageFilter
+ * \sa DiffeomorphicDemonsRegistrationFilter
+ *
+ * \ingroup ITK-Review
+ */
+template< class TDeformationField >
+class ITK_EXPORT DeformationFieldComposer:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef DeformationFieldComposer   Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DeformationFieldComposer, Object);
+
+  /** Some convenient typedefs. */
+  typedef TDeformationField                         DeformationFieldType;
+  typedef typename DeformationFieldType::PixelType  PixelType;
+  typedef typename PixelType::ValueType             ValueType;
+  typedef typename DeformationFieldType::RegionType RegionType;
+  typedef typename DeformationFieldType::IndexType  IndexType;
+  typedef typename DeformationFieldType::PointType  PointType;
+
+  /** Image dimension. */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TDeformationField::ImageDimension);
+  itkStaticConstMacro(PixelDimension, unsigned int,
+                      PixelType::Dimension);
+
+  /** Set/Get the number of threads used by Compose(). */
+  itkSetMacro(NumberOfThreads, unsigned int);
+  itkGetConstMacro(NumberOfThreads, unsigned int);
+
+  /** Write inner(x) + outer(x + inner(x)) in output for the pixels x of
+   * the buffered region of the output. */
+  void Compose(const DeformationFieldType *outer,
+               const DeformationFieldType *inner,
+               DeformationFieldType *output) const;
+
+protected:
+  DeformationFieldComposer();
+  virtual ~DeformationFieldComposer() {}
+
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Compose the fields over the region of one thread. */
+  void ThreadedCompose(const DeformationFieldType *outer,
+                       const DeformationFieldType *inner,
+                       DeformationFieldType *output,
+                       const RegionType & region) const;
+
+private:
+  DeformationFieldComposer(const Self &); //purposely not implemented
+  void operator=(const Self &);           //purposely not implemented
+
+  typedef ImageRegionSplitter< itkGetStaticConstMacro(ImageDimension) > SplitterType;
+
+  /** Structure passed to the threads. */
+  struct ComposeThreadStruct {
+    const Self *Composer;
+    const DeformationFieldType *Outer;
+    const DeformationFieldType *Inner;
+    DeformationFieldType *Output;
+    typename SplitterType::Pointer Splitter;
+    unsigned int NumberOfSplits;
+  };
+
+  /** Compose the fields over the split region of the current thread. */
+  static ITK_THREAD_RETURN_TYPE ComposeThreaderCallback(void *arg);
+
+  MultiThreader::Pointer m_Threader;
+  unsigned int           m_NumberOfThreads;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDeformationFieldComposer.txx"
+#endif
+
+#endif
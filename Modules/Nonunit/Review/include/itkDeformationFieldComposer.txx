@@ -0,0 +1,245 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkDeformationFieldComposer_txx
+#define __itkDeformationFieldComposer_txx
+
+#include "itkDeformationFieldComposer.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkContinuousIndex.h"
+
+namespace itk
+{
+/**
+ * Initialize new instance
+ */
+template< class TDeformationField >
+DeformationFieldComposer< TDeformationField >
+::DeformationFieldComposer()
+{
+  m_Threader = MultiThreader::New();
+  m_NumberOfThreads = m_Threader->GetNumberOfThreads();
+}
+
+/**
+ * Print out a description of self
+ */
+template< class TDeformationField >
+void
+DeformationFieldComposer< TDeformationField >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+}
+
+/**
+ * Compose the fields with the threads
+ */
+template< class TDeformationField >
+void
+DeformationFieldComposer< TDeformationField >
+::Compose(const DeformationFieldType *outer,
+          const DeformationFieldType *inner,
+          DeformationFieldType *output) const
+{
+  if ( !outer || !inner || !output )
+    {
+    itkExceptionMacro(<< "The outer, inner and output fields must be set");
+    }
+  if ( outer == output )
+    {
+    itkExceptionMacro(<< "The output field can not be the outer field");
+    }
+  if ( !inner->GetBufferedRegion().IsInside( output->GetBufferedRegion() ) )
+    {
+    itkExceptionMacro(<< "The buffered region of the output field "
+                      << output->GetBufferedRegion()
+                      << " is not inside the one of the inner field "
+                      << inner->GetBufferedRegion() );
+    }
+
+  ComposeThreadStruct str;
+  str.Composer = this;
+  str.Outer = outer;
+  str.Inner = inner;
+  str.Output = output;
+  str.Splitter = SplitterType::New();
+  str.NumberOfSplits = str.Splitter->GetNumberOfSplits(
+    output->GetBufferedRegion(), m_NumberOfThreads);
+
+  m_Threader->SetNumberOfThreads(str.NumberOfSplits);
+  m_Threader->SetSingleMethod(Self::ComposeThreaderCallback, &str);
+  m_Threader->SingleMethodExecute();
+
+  output->Modified();
+}
+
+template< class TDeformationField >
+ITK_THREAD_RETURN_TYPE
+DeformationFieldComposer< TDeformationField >
+::ComposeThreaderCallback(void *arg)
+{
+  const unsigned int threadId =
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const ComposeThreadStruct *str = (ComposeThreadStruct *)
+                                   ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  if ( threadId < str->NumberOfSplits )
+    {
+    const RegionType region = str->Splitter->GetSplit(
+      threadId, str->NumberOfSplits, str->Output->GetBufferedRegion() );
+    str->Composer->ThreadedCompose(str->Outer, str->Inner, str->Output, region);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ * Compose the fields over a region
+ */
+template< class TDeformationField >
+void
+DeformationFieldComposer< TDeformationField >
+::ThreadedCompose(const DeformationFieldType *outer,
+                  const DeformationFieldType *inner,
+                  DeformationFieldType *output,
+                  const RegionType & region) const
+{
+  typedef typename IndexType::IndexValueType IndexValueType;
+  typedef ContinuousIndex< double, ImageDimension > ContinuousIndexType;
+
+  const unsigned int numberOfNeighbors = 1 << ImageDimension;
+
+  // the bounds of the outer field used to extrapolate it
+  const RegionType & outerRegion = outer->GetBufferedRegion();
+  IndexType          startIndex = outerRegion.GetIndex();
+  IndexType          endIndex;
+  for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+    {
+    endIndex[dim] = startIndex[dim]
+                    + static_cast< IndexValueType >( outerRegion.GetSize(dim) ) - 1;
+    }
+  const OffsetValueType *offsetTable = outer->GetOffsetTable();
+  const PixelType *      outerBuffer = outer->GetBufferPointer();
+
+  ImageRegionConstIteratorWithIndex< DeformationFieldType > innerIt(inner, region);
+  ImageRegionIterator< DeformationFieldType >               outputIt(output, region);
+
+  PointType           point;
+  ContinuousIndexType index;
+  IndexValueType      baseIndex[ImageDimension];
+  double              distance[ImageDimension];
+  double              value[PixelDimension];
+  PixelType           composed;
+
+  for ( innerIt.GoToBegin(), outputIt.GoToBegin(); !innerIt.IsAtEnd(); ++innerIt, ++outputIt )
+    {
+    // read the displacement before the output, which may be the inner
+    // field, is written
+    const PixelType displacement = innerIt.Get();
+
+    inner->TransformIndexToPhysicalPoint(innerIt.GetIndex(), point);
+    for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      point[dim] += displacement[dim];
+      }
+    outer->TransformPhysicalPointToContinuousIndex(point, index);
+
+    // base index = closest index below the point, or the nearest
+    // index of the buffer
+    for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+      {
+      baseIndex[dim] = Math::Floor< IndexValueType >(index[dim]);
+
+      if ( baseIndex[dim] >= startIndex[dim] )
+        {
+        if ( baseIndex[dim] < endIndex[dim] )
+          {
+          distance[dim] = index[dim] - static_cast< double >( baseIndex[dim] );
+          }
+        else
+          {
+          baseIndex[dim] = endIndex[dim];
+          distance[dim] = 0.0;
+          }
+        }
+      else
+        {
+        baseIndex[dim] = startIndex[dim];
+        distance[dim] = 0.0;
+        }
+      }
+
+    // the interpolated value is the sum of the neighbors weighted by
+    // their overlap with a pixel centered on the point
+    for ( unsigned int k = 0; k < PixelDimension; k++ )
+      {
+      value[k] = 0.0;
+      }
+    double totalOverlap = 0.0;
+    for ( unsigned int counter = 0; counter < numberOfNeighbors; counter++ )
+      {
+      double          overlap = 1.0;
+      OffsetValueType offset = 0;
+      unsigned int    upper = counter;  // each bit indicates upper/lower neighbour
+      for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
+        {
+        if ( upper & 1 )
+          {
+          offset += ( baseIndex[dim] + 1 - startIndex[dim] ) * offsetTable[dim];
+          overlap *= distance[dim];
+          }
+        else
+          {
+          offset += ( baseIndex[dim] - startIndex[dim] ) * offsetTable[dim];
+          overlap *= 1.0 - distance[dim];
+          }
+        upper >>= 1;
+        }
+
+      // the neighbor may be outside of the buffer when its overlap is zero
+      if ( overlap )
+        {
+        const PixelType & neighbor = outerBuffer[offset];
+        for ( unsigned int k = 0; k < PixelDimension; k++ )
+          {
+          value[k] += overlap * static_cast< double >( neighbor[k] );
+          }
+        totalOverlap += overlap;
+        }
+
+      if ( totalOverlap == 1.0 )
+        {
+        // finished
+        break;
+        }
+      }
+
+    for ( unsigned int k = 0; k < PixelDimension; k++ )
+      {
+      composed[k] = static_cast< ValueType >( value[k] );
+      composed[k] += displacement[k];
+      }
+    outputIt.Set(composed);
+    }
+}
+} // end namespace itk
+
+#endif
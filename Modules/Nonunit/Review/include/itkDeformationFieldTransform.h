@@ -71,6 +71,7 @@ public:
 
   /** Jacobian type. */
   typedef typename Superclass::JacobianType  JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
 
   /** Standard coordinate point type for this class. */
   typedef typename Superclass::InputPointType   InputPointType;
@@ -154,6 +155,19 @@ public:
    */
   virtual JacobianType & GetJacobian( const InputPointType & ) const;
 
+  /** There are no parameters for this transform: the part of the Jacobian
+   * which may be non zero is empty. */
+  virtual void GetSparseJacobian( const InputPointType &,
+                                  JacobianType & jacobian,
+                                  NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
+    {
+    jacobian.SetSize( NDimensions, 0 );
+    nonZeroJacobianIndices.SetSize( 0 );
+    }
+
+  virtual unsigned int GetNumberOfNonZeroJacobianIndices(void) const
+    { return 0; }
+
   /** Return an inverse of this transform. */
   bool GetInverse( Self *inverse ) const;
 
@@ -23,6 +23,7 @@
 
 #include "itkMultiplyByConstantImageFilter.h"
 #include "itkExponentialDeformationFieldImageFilter.h"
+#include "itkDeformationFieldComposer.h"
 
 namespace itk
 {
@@ -163,6 +164,10 @@ protected:
   /** Apply update. */
   virtual void ApplyUpdate(TimeStepType dt);
 
+  /** Release the memory of the internal buffers once the solution has
+   * been generated. */
+  virtual void PostProcessOutput();
+
 private:
   DiffeomorphicDemonsRegistrationFilter(const Self &); //purposely not
                                                        // implemented
@@ -184,29 +189,20 @@ private:
   typedef ExponentialDeformationFieldImageFilter<
     DeformationFieldType, DeformationFieldType >        FieldExponentiatorType;
 
-  typedef WarpVectorImageFilter<
-    DeformationFieldType,
-    DeformationFieldType, DeformationFieldType >        VectorWarperType;
-
-  typedef VectorLinearInterpolateNearestNeighborExtrapolateImageFunction<
-    DeformationFieldType, double >                      FieldInterpolatorType;
+  typedef DeformationFieldComposer< DeformationFieldType > ComposerType;
 
-  typedef AddImageFilter<
-    DeformationFieldType,
-    DeformationFieldType, DeformationFieldType >        AdderType;
-
-  typedef typename MultiplyByConstantType::Pointer   MultiplyByConstantPointer;
-  typedef typename FieldExponentiatorType::Pointer   FieldExponentiatorPointer;
-  typedef typename VectorWarperType::Pointer         VectorWarperPointer;
-  typedef typename FieldInterpolatorType::Pointer    FieldInterpolatorPointer;
-  typedef typename FieldInterpolatorType::OutputType FieldInterpolatorOutputType;
-  typedef typename AdderType::Pointer                AdderPointer;
+  typedef typename MultiplyByConstantType::Pointer MultiplyByConstantPointer;
+  typedef typename FieldExponentiatorType::Pointer FieldExponentiatorPointer;
+  typedef typename ComposerType::Pointer           ComposerPointer;
 
   MultiplyByConstantPointer m_Multiplier;
   FieldExponentiatorPointer m_Exponentiator;
-  VectorWarperPointer       m_Warper;
-  AdderPointer              m_Adder;
+  ComposerPointer           m_Composer;
   bool                      m_UseFirstOrderExp;
+
+  /** Field the composition is written to, its buffer is then swapped
+   * with the one of the output. */
+  DeformationFieldPointer m_ComposedField;
 };
 } // end namespace itk
 
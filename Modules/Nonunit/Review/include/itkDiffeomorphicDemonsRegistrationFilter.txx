@@ -42,13 +42,8 @@ DiffeomorphicDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeformationFi
 
   m_Exponentiator = FieldExponentiatorType::New();
 
-  m_Warper = VectorWarperType::New();
-  FieldInterpolatorPointer VectorInterpolator =
-    FieldInterpolatorType::New();
-  m_Warper->SetInterpolator(VectorInterpolator);
-
-  m_Adder = AdderType::New();
-  m_Adder->InPlaceOn();
+  m_Composer = ComposerType::New();
+  m_ComposedField = DeformationFieldType::New();
 }
 
 /**
@@ -269,22 +264,23 @@ DiffeomorphicDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeformationFi
     this->GetUpdateBuffer()->Graft( m_Multiplier->GetOutput() );
     }
 
+  // The composition is written to a field whose buffer is then swapped
+  // with the one of the output. Allocate() keeps the memory of the
+  // previous iteration.
+  DeformationFieldPointer output = this->GetOutput();
+  m_ComposedField->CopyInformation(output);
+  m_ComposedField->SetRequestedRegion( output->GetRequestedRegion() );
+  m_ComposedField->SetBufferedRegion( output->GetBufferedRegion() );
+  m_ComposedField->Allocate();
+
+  m_Composer->SetNumberOfThreads( this->GetNumberOfThreads() );
+
   if ( this->m_UseFirstOrderExp )
     {
     // use s <- s o (Id +u)
 
     // skip exponential and compose the vector fields
-    m_Warper->SetOutputOrigin( this->GetUpdateBuffer()->GetOrigin() );
-    m_Warper->SetOutputSpacing( this->GetUpdateBuffer()->GetSpacing() );
-    m_Warper->SetOutputDirection( this->GetUpdateBuffer()->GetDirection() );
-    m_Warper->SetInput( this->GetOutput() );
-    m_Warper->SetDeformationField( this->GetUpdateBuffer() );
-
-    m_Adder->SetInput1( m_Warper->GetOutput() );
-    m_Adder->SetInput2( this->GetUpdateBuffer() );
-
-    m_Adder->GetOutput()->SetRequestedRegion(
-      this->GetOutput()->GetRequestedRegion() );
+    m_Composer->Compose(output, this->GetUpdateBuffer(), m_ComposedField);
     }
   else
     {
@@ -292,6 +288,7 @@ DiffeomorphicDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeformationFi
 
     // compute the exponential
     m_Exponentiator->SetInput( this->GetUpdateBuffer() );
+    m_Exponentiator->SetNumberOfThreads( this->GetNumberOfThreads() );
 
     const double imposedMaxUpStep = this->GetMaximumUpdateStepLength();
     if ( imposedMaxUpStep > 0.0 )
@@ -321,26 +318,14 @@ DiffeomorphicDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeformationFi
     m_Exponentiator->Update();
 
     // compose the vector fields
-    m_Warper->SetOutputOrigin( this->GetUpdateBuffer()->GetOrigin() );
-    m_Warper->SetOutputSpacing( this->GetUpdateBuffer()->GetSpacing() );
-    m_Warper->SetOutputDirection( this->GetUpdateBuffer()->GetDirection() );
-    m_Warper->SetInput( this->GetOutput() );
-    m_Warper->SetDeformationField( m_Exponentiator->GetOutput() );
-
-    m_Warper->Update();
-
-    m_Adder->SetInput1( m_Warper->GetOutput() );
-    m_Adder->SetInput2( m_Exponentiator->GetOutput() );
-
-    m_Adder->GetOutput()->SetRequestedRegion(
-      this->GetOutput()->GetRequestedRegion() );
+    m_Composer->Compose(output, m_Exponentiator->GetOutput(), m_ComposedField);
     }
 
-  // Triggers update
-  m_Adder->Update();
-
-  // Region passing stuff
-  this->GraftOutput( m_Adder->GetOutput() );
+  typedef typename DeformationFieldType::PixelContainerPointer PixelContainerPointer;
+  PixelContainerPointer swapPtr = output->GetPixelContainer();
+  output->SetPixelContainer( m_ComposedField->GetPixelContainer() );
+  m_ComposedField->SetPixelContainer(swapPtr);
+  output->Modified();
 
   DemonsRegistrationFunctionType *drfp = this->DownCastDifferenceFunctionType();
 
@@ -355,6 +340,18 @@ DiffeomorphicDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeformationFi
     }
 }
 
+/**
+ * Release memory of internal buffers
+ */
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+DiffeomorphicDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::PostProcessOutput()
+{
+  this->Superclass::PostProcessOutput();
+  m_ComposedField->Initialize();
+}
+
 template< class TFixedImage, class TMovingImage, class TDeformationField >
 void
 DiffeomorphicDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
@@ -20,9 +20,7 @@
 
 #include "itkDivideByConstantImageFilter.h"
 #include "itkCastImageFilter.h"
-#include "itkWarpVectorImageFilter.h"
-#include "itkVectorLinearInterpolateNearestNeighborExtrapolateImageFunction.h"
-#include "itkAddImageFilter.h"
+#include "itkDeformationFieldComposer.h"
 
 namespace itk
 {
@@ -48,6 +46,13 @@ namespace itk
  *    \f]
  *
  *
+ * Each squaring composes the field with itself in a single multithreaded
+ * pass (see DeformationFieldComposer) into a temporary field, whose
+ * buffer is then swapped with the one of the output. The temporary field
+ * is kept between updates, so that repeated exponentiations of fields of
+ * the same size, as done by DiffeomorphicDemonsRegistrationFilter at each
+ * iteration, do not allocate any image.
+ *
  * This filter expects both the input and output images to be of pixel type
  * Vector.
  *
@@ -150,22 +155,11 @@ protected:
   typedef CastImageFilter<
     InputImageType, OutputImageType >                   CasterType;
 
-  typedef WarpVectorImageFilter<
-    OutputImageType,
-    OutputImageType, OutputImageType >                  VectorWarperType;
-
-  typedef VectorLinearInterpolateNearestNeighborExtrapolateImageFunction<
-    OutputImageType, double >                            FieldInterpolatorType;
+  typedef DeformationFieldComposer< OutputImageType > ComposerType;
 
-  typedef AddImageFilter<
-    OutputImageType, OutputImageType, OutputImageType > AdderType;
-
-  typedef typename DivideByConstantType::Pointer     DivideByConstantPointer;
-  typedef typename CasterType::Pointer               CasterPointer;
-  typedef typename VectorWarperType::Pointer         VectorWarperPointer;
-  typedef typename FieldInterpolatorType::Pointer    FieldInterpolatorPointer;
-  typedef typename FieldInterpolatorType::OutputType FieldInterpolatorOutputType;
-  typedef typename AdderType::Pointer                AdderPointer;
+  typedef typename DivideByConstantType::Pointer DivideByConstantPointer;
+  typedef typename CasterType::Pointer           CasterPointer;
+  typedef typename ComposerType::Pointer         ComposerPointer;
 private:
   ExponentialDeformationFieldImageFilter(const Self &); //purposely not
                                                         // implemented
@@ -179,8 +173,10 @@ private:
 
   DivideByConstantPointer m_Divider;
   CasterPointer           m_Caster;
-  VectorWarperPointer     m_Warper;
-  AdderPointer            m_Adder;
+  ComposerPointer         m_Composer;
+
+  /** Field the output is composed into at each squaring. */
+  OutputImagePointer m_TempField;
 };
 } // end namespace itk
 
@@ -36,14 +36,8 @@ ExponentialDeformationFieldImageFilter< TInputImage, TOutputImage >
   m_ComputeInverse = false;
   m_Divider = DivideByConstantType::New();
   m_Caster = CasterType::New();
-  m_Warper = VectorWarperType::New();
-
-  FieldInterpolatorPointer VectorInterpolator =
-    FieldInterpolatorType::New();
-  m_Warper->SetInterpolator(VectorInterpolator);
-
-  m_Adder = AdderType::New();
-  m_Adder->InPlaceOn();
+  m_Composer = ComposerType::New();
+  m_TempField = OutputImageType::New();
 }
 
 /**
@@ -185,39 +179,28 @@ ExponentialDeformationFieldImageFilter< TInputImage, TOutputImage >
 
   progress.CompletedPixel();
 
-  // Do the iterative composition of the vector field
-  m_Warper->SetOutputOrigin( inputPtr->GetOrigin() );
-  m_Warper->SetOutputSpacing( inputPtr->GetSpacing() );
-  m_Warper->SetOutputDirection( inputPtr->GetDirection() );
-
-  for ( unsigned int i = 0; i < numiter; i++ )
-    {
-    m_Warper->SetInput( this->GetOutput() );
-    m_Warper->SetDeformationField( this->GetOutput() );
-
-    m_Warper->GetOutput()->SetRequestedRegion(
-      this->GetOutput()->GetRequestedRegion() );
+  // Do the iterative composition of the vector field. The field is
+  // composed with itself into the temporary field, whose buffer is then
+  // swapped with the one of the output. Allocate() keeps the memory of
+  // the previous update when it is large enough.
+  OutputImagePointer outputPtr = this->GetOutput();
+  m_TempField->CopyInformation(outputPtr);
+  m_TempField->SetRequestedRegion( outputPtr->GetRequestedRegion() );
+  m_TempField->SetBufferedRegion( outputPtr->GetBufferedRegion() );
+  m_TempField->Allocate();
 
-    m_Warper->Update();
+  m_Composer->SetNumberOfThreads( this->GetNumberOfThreads() );
 
-    OutputImagePointer warpedIm = m_Warper->GetOutput();
-    warpedIm->DisconnectPipeline();
+  typedef typename OutputImageType::PixelContainerPointer PixelContainerPointer;
+  PixelContainerPointer swapPtr;
 
-    // Remember we chose to use an inplace adder
-    m_Adder->SetInput1( this->GetOutput() );
-
-    m_Adder->SetInput2(warpedIm);
-    m_Adder->GetOutput()->SetRequestedRegion(
-      this->GetOutput()->GetRequestedRegion() );
-
-    m_Adder->Update();
-
-    // Region passing stuff
-    this->GraftOutput( m_Adder->GetOutput() );
+  for ( unsigned int i = 0; i < numiter; i++ )
+    {
+    m_Composer->Compose(outputPtr, outputPtr, m_TempField);
 
-    // Make a call to modified. This seems only necessary for
-    // a non-inplace adder but it doesn't hurt anyhow.
-    this->GetOutput()->Modified();
+    swapPtr = outputPtr->GetPixelContainer();
+    outputPtr->SetPixelContainer( m_TempField->GetPixelContainer() );
+    m_TempField->SetPixelContainer(swapPtr);
 
     progress.CompletedPixel();
     }
@@ -21,6 +21,7 @@
 #include "itkPDEDeformableRegistrationFilter.h"
 #include "itkESMDemonsRegistrationFunction.h"
 
+#include "itkAddImageFilter.h"
 #include "itkMultiplyByConstantImageFilter.h"
 #include "itkExponentialDeformationFieldImageFilter.h"
 
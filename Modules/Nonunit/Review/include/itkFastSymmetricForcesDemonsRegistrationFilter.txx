@@ -243,39 +243,47 @@ FastSymmetricForcesDemonsRegistrationFilter< TFixedImage, TMovingImage, TDeforma
     this->SmoothUpdateField();
     }
 
-  // use time step if necessary
-  if ( vcl_fabs(dt - 1.0) > 1.0e-4 )
+  if ( this->GetUseFusedUpdate() && this->GetSmoothDeformationField() )
     {
-    itkDebugMacro("Using timestep: " << dt);
-    m_Multiplier->SetConstant(dt);
-    m_Multiplier->SetInput( this->GetUpdateBuffer() );
-    m_Multiplier->GraftOutput( this->GetUpdateBuffer() );
-    // in place update
-    m_Multiplier->Update();
-    // graft output back to this->GetUpdateBuffer()
-    this->GetUpdateBuffer()->Graft( m_Multiplier->GetOutput() );
+    // add the update and smooth the deformation field in a single pass
+    this->ApplyUpdateAndSmoothDeformationField(dt);
+    }
+  else
+    {
+    // use time step if necessary
+    if ( vcl_fabs(dt - 1.0) > 1.0e-4 )
+      {
+      itkDebugMacro("Using timestep: " << dt);
+      m_Multiplier->SetConstant(dt);
+      m_Multiplier->SetInput( this->GetUpdateBuffer() );
+      m_Multiplier->GraftOutput( this->GetUpdateBuffer() );
+      // in place update
+      m_Multiplier->Update();
+      // graft output back to this->GetUpdateBuffer()
+      this->GetUpdateBuffer()->Graft( m_Multiplier->GetOutput() );
+      }
+
+    m_Adder->SetInput1( this->GetOutput() );
+    m_Adder->SetInput2( this->GetUpdateBuffer() );
+
+    m_Adder->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+    m_Adder->Update();
+
+    // Region passing stuff
+    this->GraftOutput( m_Adder->GetOutput() );
+
+    /*
+     * Smooth the deformation field
+     */
+    if ( this->GetSmoothDeformationField() )
+      {
+      this->SmoothDeformationField();
+      }
     }
-
-  m_Adder->SetInput1( this->GetOutput() );
-  m_Adder->SetInput2( this->GetUpdateBuffer() );
-
-  m_Adder->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
-  m_Adder->Update();
-
-  // Region passing stuff
-  this->GraftOutput( m_Adder->GetOutput() );
 
   DemonsRegistrationFunctionType *drfp = this->DownCastDifferenceFunctionType();
 
   this->SetRMSChange( drfp->GetRMSChange() );
-
-  /*
-   * Smooth the deformation field
-   */
-  if ( this->GetSmoothDeformationField() )
-    {
-    this->SmoothDeformationField();
-    }
 }
 
 template< class TFixedImage, class TMovingImage, class TDeformationField >
@@ -114,9 +114,8 @@ MaskedMovingHistogramImageFilter< TInputImage, TMaskImage, TOutputImage, TKernel
   return res;
 }
 
-// a modified version that uses line iterators and only moves the
-// histogram in one direction. Hopefully it will be a bit simpler and
-// faster due to improved memory access and a tighter loop.
+// a single histogram is moved over the region of the thread in snake
+// order, so it never has to be copied or rebuilt
 template< class TInputImage, class TMaskImage, class TOutputImage, class TKernel, class THistogram >
 void
 MaskedMovingHistogramImageFilter< TInputImage, TMaskImage, TOutputImage, TKernel, THistogram >
@@ -134,27 +133,23 @@ MaskedMovingHistogramImageFilter< TInputImage, TMaskImage, TOutputImage, TKernel
 
   RegionType inputRegion = inputImage->GetRequestedRegion();
 
-  // initialize the histogram
-  for ( typename OffsetListType::iterator listIt = this->m_KernelOffsets.begin();
-        listIt != this->m_KernelOffsets.end(); listIt++ )
+  // get the lists of added and removed offsets for a move in both
+  // directions along each axis. It's very important for performances to
+  // get a pointer and not a copy.
+  const OffsetListType *addedLists[ImageDimension][2];
+  const OffsetListType *removedLists[ImageDimension][2];
+  for ( unsigned int i = 0; i < ImageDimension; i++ )
     {
-    IndexType idx = outputRegionForThread.GetIndex() + ( *listIt );
-    if ( inputRegion.IsInside(idx) && maskImage->GetPixel(idx) == m_MaskValue )
-      {
-      histogram.AddPixel( inputImage->GetPixel(idx) );
-      }
-    else
-      {
-      histogram.AddBoundary();
-      }
+    OffsetType offset;
+    offset.Fill(0);
+    offset[i] = -1;
+    addedLists[i][0] = &this->m_AddedOffsets[offset];
+    removedLists[i][0] = &this->m_RemovedOffsets[offset];
+    offset[i] = 1;
+    addedLists[i][1] = &this->m_AddedOffsets[offset];
+    removedLists[i][1] = &this->m_RemovedOffsets[offset];
     }
 
-  // now move the histogram
-  FixedArray< short, ImageDimension > direction;
-  direction.Fill(1);
-  int        axis = ImageDimension - 1;
-  OffsetType offset;
-  offset.Fill(0);
   RegionType stRegion;
   stRegion.SetSize( this->m_Kernel.GetSize() );
   stRegion.PadByRadius(1);   // must pad the region by one because of the
@@ -166,56 +161,49 @@ MaskedMovingHistogramImageFilter< TInputImage, TMaskImage, TOutputImage, TKernel
     centerOffset[i] = stRegion.GetSize()[i] / 2;
     }
 
-  int BestDirection = this->m_Axes[axis];
-  int LineLength = inputRegion.GetSize()[BestDirection];
+  const int           BestDirection = this->m_Axes[ImageDimension - 1];
+  const SizeValueType LineLength = outputRegionForThread.GetSize()[BestDirection];
 
   // Report progress every line instead of every pixel
-  ProgressReporter progress(this, threadId,
-                            outputRegionForThread.GetNumberOfPixels() / outputRegionForThread.GetSize()[BestDirection]);
-  // init the offset and get the lists for the best axis
-  offset[BestDirection] = direction[BestDirection];
-  // it's very important for performances to get a pointer and not a copy
-  const OffsetListType *addedList = &this->m_AddedOffsets[offset];
-  const OffsetListType *removedList = &this->m_RemovedOffsets[offset];
-
-  typedef ImageLinearConstIteratorWithIndex< InputImageType > InputLineIteratorType;
-  InputLineIteratorType InLineIt(inputImage, outputRegionForThread);
-  InLineIt.SetDirection(BestDirection);
-
-  typedef ImageRegionIterator< OutputImageType > OutputIteratorType;
-  InLineIt.GoToBegin();
-  IndexType LineStart;
-  InLineIt.GoToBegin();
-
-  typedef typename std::vector< HistogramType > HistVecType;
-  HistVecType HistVec(ImageDimension);
-  typedef typename std::vector< IndexType > IndexVecType;
-  IndexVecType PrevLineStartVec(ImageDimension);
+  ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels() / LineLength);
 
-  // Steps is used to keep track of the order in which the line
-  // iterator passes over the various dimensions.
-  int *Steps = new int[ImageDimension];
-
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
+  // initialize the histogram on the first pixel of the region
+  IndexType currentIdx = outputRegionForThread.GetIndex();
+  for ( typename OffsetListType::iterator listIt = this->m_KernelOffsets.begin();
+        listIt != this->m_KernelOffsets.end(); listIt++ )
     {
-    HistVec[i] = histogram;
-    PrevLineStartVec[i] = InLineIt.GetIndex();
-    Steps[i] = 0;
+    IndexType idx = currentIdx + ( *listIt );
+    if ( inputRegion.IsInside(idx) && maskImage->GetPixel(idx) == m_MaskValue )
+      {
+      histogram.AddPixel( inputImage->GetPixel(idx) );
+      }
+    else
+      {
+      histogram.AddBoundary();
+      }
     }
 
-  while ( !InLineIt.IsAtEnd() )
+  typename Superclass::DirectionType direction;
+  direction.Fill(1);
+  int axis = BestDirection;
+  for (;; )
     {
-    HistogramType & histRef = HistVec[BestDirection];
-    IndexType      PrevLineStart = InLineIt.GetIndex();
-    for ( InLineIt.GoToBeginOfLine(); !InLineIt.IsAtEndOfLine(); ++InLineIt )
+    for ( SizeValueType n = 0; n < LineLength; n++ )
       {
-      // Update the histogram
-      IndexType currentIdx = InLineIt.GetIndex();
+      if ( n > 0 )
+        {
+        // move the histogram along the line
+        const int d = direction[BestDirection] > 0;
+        stRegion.SetIndex(currentIdx - centerOffset);
+        pushHistogram(histogram, addedLists[BestDirection][d], removedLists[BestDirection][d],
+                      inputRegion, stRegion, inputImage, maskImage, currentIdx);
+        currentIdx[BestDirection] += direction[BestDirection];
+        }
 
-      if ( maskImage->GetPixel(currentIdx) == m_MaskValue && histRef.IsValid() )
+      if ( maskImage->GetPixel(currentIdx) == m_MaskValue && histogram.IsValid() )
         {
         outputImage->SetPixel( currentIdx,
-                               static_cast< OutputPixelType >( histRef.GetValue( inputImage->GetPixel(currentIdx) ) ) );
+                               static_cast< OutputPixelType >( histogram.GetValue( inputImage->GetPixel(currentIdx) ) ) );
         if ( this->m_GenerateOutputMask )
           {
           outputMask->SetPixel(currentIdx, m_MaskValue);
@@ -229,54 +217,20 @@ MaskedMovingHistogramImageFilter< TInputImage, TMaskImage, TOutputImage, TKernel
           outputMask->SetPixel(currentIdx, m_BackgroundMaskValue);
           }
         }
-      stRegion.SetIndex(currentIdx - centerOffset);
-      pushHistogram(histRef, addedList, removedList, inputRegion,
-                    stRegion, inputImage, maskImage, currentIdx);
       }
-    Steps[BestDirection] += LineLength;
-    InLineIt.NextLine();
-    if ( InLineIt.IsAtEnd() )
-      {
-      break;
-      }
-    LineStart = InLineIt.GetIndex();
-    // This section updates the histogram for the next line
-    // Since we aren't zig zagging we need to figure out which
-    // histogram to update and the direction in which to push
-    // it. Then we need to copy that histogram to the relevant
-    // places
-    OffsetType LineOffset, Changes;
-    // Figure out which stored histogram to move and in
-    // which direction
-    int LineDirection = 0;
-    // This function deals with changing planes etc
-    this->GetDirAndOffset(LineStart, PrevLineStart,
-                          LineOffset, Changes, LineDirection);
-    ++( Steps[LineDirection] );
-    IndexType             PrevLineStartHist = LineStart - LineOffset;
-    const OffsetListType *addedListLine = &this->m_AddedOffsets[LineOffset];
-    const OffsetListType *removedListLine = &this->m_RemovedOffsets[LineOffset];
-    HistogramType &       tmpHist = HistVec[LineDirection];
-    stRegion.SetIndex(PrevLineStart - centerOffset);
-    // Now move the histogram
-    pushHistogram(tmpHist, addedListLine, removedListLine, inputRegion,
-                  stRegion, inputImage, maskImage, PrevLineStartHist);
+    progress.CompletedPixel();
 
-    //PrevLineStartVec[LineDirection] = LineStart;
-    // copy the updated histogram and line start entries to the
-    // relevant directions. When updating direction 2, for example,
-    // new copies of directions 0 and 1 should be made.
-    for ( unsigned int i = 0; i < ImageDimension; i++ )
+    if ( !this->GetNextSnakeLine(outputRegionForThread, currentIdx, direction, axis) )
       {
-      if ( Steps[i] > Steps[LineDirection] )
-        {
-        // make sure this is the right thing to do
-        HistVec[i] = HistVec[LineDirection];
-        }
+      break;
       }
-    progress.CompletedPixel();
+    // move the histogram to the next line
+    const int d = direction[axis] > 0;
+    stRegion.SetIndex(currentIdx - centerOffset);
+    pushHistogram(histogram, addedLists[axis][d], removedLists[axis][d],
+                  inputRegion, stRegion, inputImage, maskImage, currentIdx);
+    currentIdx[axis] += direction[axis];
     }
-  delete[] Steps;
 }
 
 template< class TInputImage, class TMaskImage, class TOutputImage, class TKernel, class THistogram >
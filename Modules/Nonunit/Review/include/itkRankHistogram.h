@@ -19,6 +19,7 @@
 #ifndef __itkRankHistogram_h
 #define __itkRankHistogram_h
 #include "itkNumericTraits.h"
+#include "itkTieredRankHistogram.h"
 
 namespace itk
 {
@@ -386,26 +387,104 @@ private:
   int           m_Entries;
 };
 
-// now create MorphologicalGradientHistogram specilizations using the VectorMorphologicalGradientHistogram
+// A rank histogram for the integer types of 16 bits or less, using the
+// two level histogram also used by MedianImageFilter: it is never
+// brute forced and its size doesn't depend on the content of the image.
+template< class TInputPixel >
+class TieredVectorRankHistogram
+{
+public:
+  TieredVectorRankHistogram()
+  {
+    m_Rank = 0.5;
+  }
+
+  ~TieredVectorRankHistogram() {}
+
+  bool IsValid()
+  {
+    return m_Histogram.GetNumberOfEntries() > 0;
+  }
+
+  TInputPixel GetValueBruteForce()
+  {
+    return this->GetValue( NumericTraits< TInputPixel >::Zero );
+  }
+
+  TInputPixel GetValue(const TInputPixel &)
+  {
+    const SizeValueType entries = m_Histogram.GetNumberOfEntries();
+
+    if ( entries == 0 )
+      {
+      return NumericTraits< TInputPixel >::max();
+      }
+    return m_Histogram.GetValueAtRank( (SizeValueType)( m_Rank * ( entries - 1 ) ) );
+  }
+
+  void AddPixel(const TInputPixel & p)
+  {
+    m_Histogram.AddPixel(p);
+  }
+
+  void RemovePixel(const TInputPixel & p)
+  {
+    m_Histogram.RemovePixel(p);
+  }
+
+  void SetRank(float rank)
+  {
+    m_Rank = rank;
+  }
+
+  void AddBoundary(){}
+
+  void RemoveBoundary(){}
+
+  static bool UseVectorBasedAlgorithm()
+  {
+    return true;
+  }
+
+protected:
+  float m_Rank;
+
+private:
+  TieredRankHistogram< TInputPixel > m_Histogram;
+};
+
+// now create RankHistogram specilizations using the TieredVectorRankHistogram
 // as base class
 
 /** \cond HIDE_SPECIALIZATION_DOCUMENTATION */
 
 template<>
 class RankHistogram<unsigned char>:
-  public VectorRankHistogram<unsigned char>
+  public TieredVectorRankHistogram<unsigned char>
 {
 };
 
 template<>
 class RankHistogram<signed char>:
-  public VectorRankHistogram<signed char>
+  public TieredVectorRankHistogram<signed char>
 {
 };
 
 template<>
 class RankHistogram<bool>:
-  public VectorRankHistogram<bool>
+  public TieredVectorRankHistogram<bool>
+{
+};
+
+template<>
+class RankHistogram<unsigned short>:
+  public TieredVectorRankHistogram<unsigned short>
+{
+};
+
+template<>
+class RankHistogram<short>:
+  public TieredVectorRankHistogram<short>
 {
 };
 
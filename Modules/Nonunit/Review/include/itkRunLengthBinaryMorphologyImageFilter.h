@@ -0,0 +1,168 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRunLengthBinaryMorphologyImageFilter_h
+#define __itkRunLengthBinaryMorphologyImageFilter_h
+
+#include "itkLabelObject.h"
+#include "itkLabelMap.h"
+#include "itkBinaryImageToLabelMapFilter.h"
+#include "itkAggregateLabelMapFilter.h"
+#include "itkRunLengthBinaryMorphologyLabelMapFilter.h"
+#include "itkLabelMapToBinaryImageFilter.h"
+
+namespace itk
+{
+/** \class RunLengthBinaryMorphologyImageFilter
+ * \brief Binary dilation, erosion, opening or closing computed on the
+ * run-length encoded foreground.
+ *
+ * The foreground of the input image is converted to a single label object
+ * made of lines, processed with RunLengthBinaryMorphologyLabelMapFilter,
+ * and converted back to a binary image.  The computation time depends on
+ * the number of lines in the foreground and on the number of runs in the
+ * structuring element rather than on the number of pixels, which makes
+ * this filter well suited to sparse masks and large kernels.
+ *
+ * The result is the same as the one of BinaryDilateImageFilter and
+ * BinaryErodeImageFilter with an arbitrary FlatStructuringElement. The
+ * pixels outside the image are considered as background for the dilation
+ * and as foreground for the erosion.  The opening and the closing are the
+ * ones of BinaryMorphologicalOpeningImageFilter and of
+ * BinaryMorphologicalClosingImageFilter without safe border.
+ *
+ * \sa RunLengthBinaryMorphologyLabelMapFilter, BinaryDilateImageFilter,
+ * BinaryErodeImageFilter, BinaryMorphologicalOpeningImageFilter,
+ * BinaryMorphologicalClosingImageFilter
+ * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
+ * \ingroup ITK-Review
+ */
+template< class TInputImage,
+          class TKernel = FlatStructuringElement< ::itk::GetImageDimension< TInputImage >::ImageDimension > >
+class ITK_EXPORT RunLengthBinaryMorphologyImageFilter:
+  public ImageToImageFilter< TInputImage, TInputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthBinaryMorphologyImageFilter           Self;
+  typedef ImageToImageFilter< TInputImage, TInputImage > Superclass;
+  typedef SmartPointer< Self >                           Pointer;
+  typedef SmartPointer< const Self >                     ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                            InputImageType;
+  typedef TInputImage                            OutputImageType;
+  typedef typename InputImageType::Pointer       InputImagePointer;
+  typedef typename InputImageType::ConstPointer  InputImageConstPointer;
+  typedef typename InputImageType::RegionType    InputImageRegionType;
+  typedef typename InputImageType::PixelType     InputImagePixelType;
+  typedef typename OutputImageType::Pointer      OutputImagePointer;
+  typedef typename OutputImageType::ConstPointer OutputImageConstPointer;
+  typedef typename OutputImageType::RegionType   OutputImageRegionType;
+  typedef typename OutputImageType::PixelType    OutputImagePixelType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(InputImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(OutputImageDimension, unsigned int, TInputImage::ImageDimension);
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  typedef TKernel KernelType;
+
+  typedef SizeValueType                                                           LabelType;
+  typedef LabelObject< LabelType, itkGetStaticConstMacro(ImageDimension) >        LabelObjectType;
+  typedef LabelMap< LabelObjectType >                                             LabelMapType;
+  typedef BinaryImageToLabelMapFilter< InputImageType, LabelMapType >             LabelizerType;
+  typedef AggregateLabelMapFilter< LabelMapType >                                 AggregatorType;
+  typedef RunLengthBinaryMorphologyLabelMapFilter< LabelMapType, KernelType >     MorphologyType;
+  typedef LabelMapToBinaryImageFilter< LabelMapType, OutputImageType >            BinarizerType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(RunLengthBinaryMorphologyImageFilter, ImageToImageFilter);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro( InputEqualityComparableCheck,
+                   ( Concept::EqualityComparable< InputImagePixelType > ) );
+  itkConceptMacro( InputOStreamWritableCheck,
+                   ( Concept::OStreamWritable< InputImagePixelType > ) );
+  /** End concept checking */
+#endif
+
+  /**
+   * Set/Get the value used as "background" in the output image.
+   * Defaults to NumericTraits<PixelType>::NonpositiveMin().
+   */
+  itkSetMacro(BackgroundValue, OutputImagePixelType);
+  itkGetConstMacro(BackgroundValue, OutputImagePixelType);
+
+  /**
+   * Set/Get the value of the foreground, in the input and in the output
+   * image. Defaults to NumericTraits<PixelType>::max().
+   */
+  itkSetMacro(ForegroundValue, OutputImagePixelType);
+  itkGetConstMacro(ForegroundValue, OutputImagePixelType);
+
+  /** Set/Get the structuring element. Default is a 3x3...x3 box. */
+  itkSetMacro(Kernel, KernelType);
+  itkGetConstReferenceMacro(Kernel, KernelType);
+
+  /** Set/Get the operation. Default is DILATE. */
+  itkSetMacro(Operation, int);
+  itkGetConstMacro(Operation, int);
+
+  /** define values used to determine which operation to apply */
+  enum {
+    DILATE = MorphologyType::DILATE,
+    ERODE = MorphologyType::ERODE,
+    OPENING = MorphologyType::OPENING,
+    CLOSING = MorphologyType::CLOSING
+    } OperationChoice;
+
+protected:
+  RunLengthBinaryMorphologyImageFilter();
+  ~RunLengthBinaryMorphologyImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** RunLengthBinaryMorphologyImageFilter needs the entire input to be available.
+   * Thus, it needs to provide an implementation of GenerateInputRequestedRegion(). */
+  void GenerateInputRequestedRegion();
+
+  /** RunLengthBinaryMorphologyImageFilter will produce the entire output. */
+  void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) );
+
+  /** This filter delegates to a mini-pipeline of label map filters. */
+  void GenerateData();
+
+private:
+  RunLengthBinaryMorphologyImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                       //purposely not implemented
+
+  OutputImagePixelType m_BackgroundValue;
+  OutputImagePixelType m_ForegroundValue;
+  KernelType           m_Kernel;
+  int                  m_Operation;
+}; // end of class
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRunLengthBinaryMorphologyImageFilter.txx"
+#endif
+
+#endif
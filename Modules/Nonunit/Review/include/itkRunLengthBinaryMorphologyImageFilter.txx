@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRunLengthBinaryMorphologyImageFilter_txx
+#define __itkRunLengthBinaryMorphologyImageFilter_txx
+
+#include "itkRunLengthBinaryMorphologyImageFilter.h"
+#include "itkProgressAccumulator.h"
+
+namespace itk
+{
+template< class TInputImage, class TKernel >
+RunLengthBinaryMorphologyImageFilter< TInputImage, TKernel >
+::RunLengthBinaryMorphologyImageFilter()
+{
+  m_BackgroundValue = NumericTraits< OutputImagePixelType >::NonpositiveMin();
+  m_ForegroundValue = NumericTraits< OutputImagePixelType >::max();
+  m_Kernel.SetRadius(1);
+  for ( unsigned int i = 0; i < m_Kernel.Size(); i++ )
+    {
+    m_Kernel[i] = true;
+    }
+  m_Operation = DILATE;
+}
+
+template< class TInputImage, class TKernel >
+void
+RunLengthBinaryMorphologyImageFilter< TInputImage, TKernel >
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  // We need all the input.
+  InputImagePointer input = const_cast< InputImageType * >( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+    }
+}
+
+template< class TInputImage, class TKernel >
+void
+RunLengthBinaryMorphologyImageFilter< TInputImage, TKernel >
+::EnlargeOutputRequestedRegion(DataObject *)
+{
+  this->GetOutput()
+  ->SetRequestedRegion( this->GetOutput()->GetLargestPossibleRegion() );
+}
+
+template< class TInputImage, class TKernel >
+void
+RunLengthBinaryMorphologyImageFilter< TInputImage, TKernel >
+::GenerateData()
+{
+  // Create a process accumulator for tracking the progress of this minipipeline
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+
+  progress->SetMiniPipelineFilter(this);
+
+  // Allocate the output
+  this->AllocateOutputs();
+
+  typename LabelizerType::Pointer labelizer = LabelizerType::New();
+  labelizer->SetInput( this->GetInput() );
+  labelizer->SetInputForegroundValue(m_ForegroundValue);
+  labelizer->SetOutputBackgroundValue(NumericTraits< LabelType >::Zero);
+  labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
+  progress->RegisterInternalFilter(labelizer, .3f);
+
+  // erosion is not distributive over the union of the connected
+  // components, so all the foreground must be in the same object
+  typename AggregatorType::Pointer aggregator = AggregatorType::New();
+  aggregator->SetInput( labelizer->GetOutput() );
+  aggregator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  progress->RegisterInternalFilter(aggregator, .1f);
+
+  typename MorphologyType::Pointer morphology = MorphologyType::New();
+  morphology->SetInput( aggregator->GetOutput() );
+  morphology->SetKernel(m_Kernel);
+  morphology->SetOperation(m_Operation);
+  morphology->SetNumberOfThreads( this->GetNumberOfThreads() );
+  progress->RegisterInternalFilter(morphology, .4f);
+
+  typename BinarizerType::Pointer binarizer = BinarizerType::New();
+  binarizer->SetInput( morphology->GetOutput() );
+  binarizer->SetForegroundValue(m_ForegroundValue);
+  binarizer->SetBackgroundValue(m_BackgroundValue);
+  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
+  progress->RegisterInternalFilter(binarizer, .2f);
+
+  binarizer->GraftOutput( this->GetOutput() );
+  binarizer->Update();
+  this->GraftOutput( binarizer->GetOutput() );
+}
+
+template< class TInputImage, class TKernel >
+void
+RunLengthBinaryMorphologyImageFilter< TInputImage, TKernel >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "BackgroundValue: "
+     << static_cast< typename NumericTraits< OutputImagePixelType >::PrintType >( m_BackgroundValue ) << std::endl;
+  os << indent << "ForegroundValue: "
+     << static_cast< typename NumericTraits< OutputImagePixelType >::PrintType >( m_ForegroundValue ) << std::endl;
+  os << indent << "Kernel: " << m_Kernel << std::endl;
+  os << indent << "Operation: " << m_Operation << std::endl;
+}
+} // end namespace itk
+#endif
@@ -0,0 +1,188 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRunLengthBinaryMorphologyLabelMapFilter_h
+#define __itkRunLengthBinaryMorphologyLabelMapFilter_h
+
+#include "itkInPlaceLabelMapFilter.h"
+#include "itkFlatStructuringElement.h"
+#include <map>
+#include <vector>
+
+namespace itk
+{
+/** \class RunLengthBinaryMorphologyLabelMapFilter
+ * \brief Dilate, erode, open or close each object of a label map,
+ * working directly on the lines of the objects.
+ *
+ * The structuring element is decomposed in runs of consecutive active
+ * pixels along the first dimension.  Each label object is then processed
+ * row by row: a dilation is the union of the object lines translated and
+ * lengthened by every run of the kernel, and an erosion is the
+ * intersection of the object lines translated and shortened by every run
+ * of the reflected kernel.  The cost is thus proportional to the number of lines
+ * of the objects times the number of runs in the kernel, and not to the
+ * number of pixels, which makes this filter efficient on sparse objects
+ * and large images.
+ *
+ * The result of the dilation is cropped to the largest possible region
+ * of the label map.  As in BinaryErodeImageFilter, the erosion is the
+ * complement of the dilation of the background with the same kernel, and
+ * the pixels outside the largest possible region are considered as
+ * foreground during the erosion.  When the kernel does not contain its
+ * center, the erosion may thus add pixels to the object, and all the rows
+ * of the image are considered.  As in BinaryMorphologicalClosingImageFilter,
+ * the closing keeps the pixels of the object.  Objects which become empty
+ * are removed from the label map.
+ *
+ * Each object is processed independently of the other ones, and the
+ * objects are processed in parallel. After a dilation, the objects may
+ * overlap.
+ *
+ * \sa RunLengthBinaryMorphologyImageFilter, BinaryDilateImageFilter,
+ * BinaryErodeImageFilter, FlatStructuringElement, LabelObject
+ * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
+ * \ingroup ITK-Review
+ */
+template< class TImage,
+          class TKernel = FlatStructuringElement< ::itk::GetImageDimension< TImage >::ImageDimension > >
+class ITK_EXPORT RunLengthBinaryMorphologyLabelMapFilter:
+  public InPlaceLabelMapFilter< TImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthBinaryMorphologyLabelMapFilter Self;
+  typedef InPlaceLabelMapFilter< TImage >         Superclass;
+  typedef SmartPointer< Self >                    Pointer;
+  typedef SmartPointer< const Self >              ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                                        ImageType;
+  typedef typename ImageType::Pointer                   ImagePointer;
+  typedef typename ImageType::ConstPointer              ImageConstPointer;
+  typedef typename ImageType::PixelType                 PixelType;
+  typedef typename ImageType::IndexType                 IndexType;
+  typedef typename ImageType::RegionType                RegionType;
+  typedef typename ImageType::LabelObjectType           LabelObjectType;
+  typedef typename LabelObjectType::LengthType          LengthType;
+  typedef typename LabelObjectType::OffsetType          OffsetType;
+  typedef typename Superclass::LabelObjectContainerType LabelObjectContainerType;
+
+  typedef TKernel KernelType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(RunLengthBinaryMorphologyLabelMapFilter, InPlaceLabelMapFilter);
+
+  /** Set/Get the structuring element. Default is a 3x3...x3 box. */
+  itkSetMacro(Kernel, KernelType);
+  itkGetConstReferenceMacro(Kernel, KernelType);
+
+  /** Set/Get the operation applied to the objects. Default is DILATE. */
+  itkSetMacro(Operation, int);
+  itkGetConstMacro(Operation, int);
+
+  /** define values used to determine which operation to apply */
+  enum {
+    DILATE = 0,
+    ERODE = 1,
+    OPENING = 2,
+    CLOSING = 3
+    } OperationChoice;
+
+  /** A run of the kernel: the offset of its first pixel, and its
+   * length along the first dimension. */
+  struct KernelRunType {
+    OffsetType      m_Offset;
+    OffsetValueType m_Length;
+  };
+  typedef std::vector< KernelRunType > KernelRunContainerType;
+
+  /** Return the runs the kernel has been decomposed in during the last
+   * execution. */
+  const KernelRunContainerType & GetKernelRuns() const
+  {
+    return m_KernelRuns;
+  }
+
+protected:
+  RunLengthBinaryMorphologyLabelMapFilter();
+  ~RunLengthBinaryMorphologyLabelMapFilter() {}
+
+  virtual void BeforeThreadedGenerateData();
+
+  virtual void ThreadedProcessLabelObject(LabelObjectType *labelObject);
+
+  virtual void AfterThreadedGenerateData();
+
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Half open intervals [begin, end) along the first dimension. */
+  typedef std::pair< IndexValueType, IndexValueType > IntervalType;
+  typedef std::vector< IntervalType >                 IntervalContainerType;
+
+  /** The lines of an object, grouped by row. The key is the index of
+   * the row, with its first component set to 0. */
+  typedef std::map< IndexType, IntervalContainerType,
+                    typename IndexType::LexicographicCompare > RowMapType;
+
+  /** Dilate the rows of an object with the kernel runs. */
+  void DilateRows(const RowMapType & rows, RowMapType & result) const;
+
+  /** Erode the rows of an object with the kernel runs. */
+  void ErodeRows(const RowMapType & rows, RowMapType & result) const;
+
+private:
+  RunLengthBinaryMorphologyLabelMapFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                          //purposely not implemented
+
+  /** Sort the intervals and merge the ones which overlap or touch. */
+  static void NormalizeIntervals(IntervalContainerType & intervals);
+
+  /** Return true if the row is inside the largest possible region. */
+  bool IsRowInside(const IndexType & row) const;
+
+  KernelType m_Kernel;
+
+  int m_Operation;
+
+  KernelRunContainerType m_KernelRuns;
+
+  /** The runs of the kernel mirrored through its center, used by the
+   * erosion. */
+  KernelRunContainerType m_ReflectedKernelRuns;
+
+  /** Largest distance to the center of the pixels of a kernel run along
+   * the first dimension, plus one. */
+  OffsetValueType m_KernelExtent;
+
+  bool m_KernelHasCenter;
+
+  RegionType m_Region;
+}; // end of class
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRunLengthBinaryMorphologyLabelMapFilter.txx"
+#endif
+
+#endif
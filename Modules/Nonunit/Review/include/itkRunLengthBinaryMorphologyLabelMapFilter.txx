@@ -0,0 +1,423 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRunLengthBinaryMorphologyLabelMapFilter_txx
+#define __itkRunLengthBinaryMorphologyLabelMapFilter_txx
+
+#include "itkRunLengthBinaryMorphologyLabelMapFilter.h"
+#include <algorithm>
+#include <set>
+
+namespace itk
+{
+template< class TImage, class TKernel >
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::RunLengthBinaryMorphologyLabelMapFilter()
+{
+  m_Kernel.SetRadius(1);
+  for ( unsigned int i = 0; i < m_Kernel.Size(); i++ )
+    {
+    m_Kernel[i] = true;
+    }
+  m_Operation = DILATE;
+  m_KernelExtent = 0;
+  m_KernelHasCenter = true;
+}
+
+template< class TImage, class TKernel >
+void
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  m_Region = this->GetOutput()->GetLargestPossibleRegion();
+
+  // decompose the kernel in runs along the first dimension. The offsets
+  // of the neighborhood are ordered with the first dimension moving
+  // fastest, so the consecutive active pixels of a row are contiguous.
+  m_KernelRuns.clear();
+  m_KernelExtent = 0;
+  bool inRun = false;
+  for ( unsigned int i = 0; i < m_Kernel.Size(); i++ )
+    {
+    const OffsetType offset = m_Kernel.GetOffset(i);
+    if ( inRun && ( !m_Kernel[i] || offset[0] == -static_cast< OffsetValueType >( m_Kernel.GetRadius(0) ) ) )
+      {
+      inRun = false;
+      }
+    if ( m_Kernel[i] )
+      {
+      if ( inRun )
+        {
+        m_KernelRuns.back().m_Length++;
+        }
+      else
+        {
+        KernelRunType run;
+        run.m_Offset = offset;
+        run.m_Length = 1;
+        m_KernelRuns.push_back(run);
+        inRun = true;
+        }
+      }
+    }
+
+  // the erosion is the complement of the dilation of the background, as
+  // in BinaryErodeImageFilter: a pixel is kept when the reflected kernel
+  // only covers foreground pixels
+  m_ReflectedKernelRuns.clear();
+  for ( typename KernelRunContainerType::const_iterator kit = m_KernelRuns.begin();
+        kit != m_KernelRuns.end(); ++kit )
+    {
+    KernelRunType run;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      run.m_Offset[d] = -kit->m_Offset[d];
+      }
+    run.m_Offset[0] -= kit->m_Length - 1;
+    run.m_Length = kit->m_Length;
+    m_ReflectedKernelRuns.push_back(run);
+
+    const OffsetValueType extent = vnl_math_max( vnl_math_abs(kit->m_Offset[0]),
+                                                 vnl_math_abs(kit->m_Offset[0] + kit->m_Length - 1) ) + 1;
+    m_KernelExtent = vnl_math_max(m_KernelExtent, extent);
+    }
+
+  m_KernelHasCenter = m_Kernel.Size() > 0 && m_Kernel[m_Kernel.Size() / 2];
+}
+
+template< class TImage, class TKernel >
+bool
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::IsRowInside(const IndexType & row) const
+{
+  for ( unsigned int d = 1; d < ImageDimension; d++ )
+    {
+    if ( row[d] < m_Region.GetIndex()[d]
+         || row[d] >= m_Region.GetIndex()[d] + static_cast< OffsetValueType >( m_Region.GetSize()[d] ) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+template< class TImage, class TKernel >
+void
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::NormalizeIntervals(IntervalContainerType & intervals)
+{
+  if ( intervals.empty() )
+    {
+    return;
+    }
+
+  std::sort( intervals.begin(), intervals.end() );
+
+  typename IntervalContainerType::iterator out = intervals.begin();
+  for ( typename IntervalContainerType::iterator it = intervals.begin() + 1;
+        it != intervals.end(); ++it )
+    {
+    if ( it->first <= out->second )
+      {
+      out->second = vnl_math_max(out->second, it->second);
+      }
+    else
+      {
+      ++out;
+      *out = *it;
+      }
+    }
+  intervals.erase( out + 1, intervals.end() );
+}
+
+template< class TImage, class TKernel >
+void
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::DilateRows(const RowMapType & rows, RowMapType & result) const
+{
+  const IndexValueType begin = m_Region.GetIndex()[0];
+  const IndexValueType end = begin + static_cast< OffsetValueType >( m_Region.GetSize()[0] );
+
+  result.clear();
+  for ( typename RowMapType::const_iterator rit = rows.begin(); rit != rows.end(); ++rit )
+    {
+    for ( typename KernelRunContainerType::const_iterator kit = m_KernelRuns.begin();
+          kit != m_KernelRuns.end(); ++kit )
+      {
+      IndexType row = rit->first + kit->m_Offset;
+      row[0] = 0;
+      if ( !this->IsRowInside(row) )
+        {
+        continue;
+        }
+
+      IntervalContainerType & intervals = result[row];
+      for ( typename IntervalContainerType::const_iterator iit = rit->second.begin();
+            iit != rit->second.end(); ++iit )
+        {
+        const IndexValueType b = vnl_math_max(begin, iit->first + kit->m_Offset[0]);
+        const IndexValueType e =
+          vnl_math_min(end, iit->second + kit->m_Offset[0] + kit->m_Length - 1);
+        if ( b < e )
+          {
+          intervals.push_back( IntervalType(b, e) );
+          }
+        }
+      }
+    }
+
+  for ( typename RowMapType::iterator rit = result.begin(); rit != result.end(); ++rit )
+    {
+    NormalizeIntervals(rit->second);
+    }
+}
+
+template< class TImage, class TKernel >
+void
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::ErodeRows(const RowMapType & rows, RowMapType & result) const
+{
+  const IndexValueType begin = m_Region.GetIndex()[0];
+  const IndexValueType end = begin + static_cast< OffsetValueType >( m_Region.GetSize()[0] );
+
+  result.clear();
+  if ( m_Region.GetNumberOfPixels() == 0 )
+    {
+    return;
+    }
+
+  typedef std::set< IndexType, typename IndexType::LexicographicCompare > RowSetType;
+  RowSetType candidates;
+  if ( m_KernelHasCenter )
+    {
+    // the pixels kept are on the object
+    for ( typename RowMapType::const_iterator rit = rows.begin(); rit != rows.end(); ++rit )
+      {
+      candidates.insert(rit->first);
+      }
+    }
+  else
+    {
+    // a pixel outside the object is kept when the reflected kernel only
+    // covers foreground pixels: every row of the image may be kept
+    IndexType row = m_Region.GetIndex();
+    row[0] = 0;
+    const SizeValueType numberOfRows = m_Region.GetNumberOfPixels() / m_Region.GetSize()[0];
+    for ( SizeValueType r = 0; r < numberOfRows; r++ )
+      {
+      candidates.insert(row);
+      for ( unsigned int d = 1; d < ImageDimension; d++ )
+        {
+        if ( ++row[d] < m_Region.GetIndex()[d] + static_cast< OffsetValueType >( m_Region.GetSize()[d] ) )
+          {
+          break;
+          }
+        row[d] = m_Region.GetIndex()[d];
+        }
+      }
+    }
+
+  IntervalContainerType extended;
+  IntervalContainerType eroded;
+  IntervalContainerType intersection;
+  for ( typename RowSetType::const_iterator cit = candidates.begin(); cit != candidates.end(); ++cit )
+    {
+    IntervalContainerType current;
+    current.push_back( IntervalType(begin, end) );
+
+    for ( typename KernelRunContainerType::const_iterator kit = m_ReflectedKernelRuns.begin();
+          kit != m_ReflectedKernelRuns.end() && !current.empty(); ++kit )
+      {
+      IndexType row = *cit + kit->m_Offset;
+      row[0] = 0;
+      if ( !this->IsRowInside(row) )
+        {
+        // the pixels outside the image are foreground: no constraint
+        continue;
+        }
+
+      // the lines of the object on that row, and the foreground outside
+      // the image on both sides
+      extended.clear();
+      extended.push_back( IntervalType(begin - m_KernelExtent, begin) );
+      typename RowMapType::const_iterator rit = rows.find(row);
+      if ( rit != rows.end() )
+        {
+        extended.insert( extended.end(), rit->second.begin(), rit->second.end() );
+        }
+      extended.push_back( IntervalType(end, end + m_KernelExtent) );
+      NormalizeIntervals(extended);
+
+      // positions p such that [p + offset, p + offset + length) is
+      // foreground
+      eroded.clear();
+      for ( typename IntervalContainerType::const_iterator iit = extended.begin();
+            iit != extended.end(); ++iit )
+        {
+        const IndexValueType b = iit->first - kit->m_Offset[0];
+        const IndexValueType e = iit->second - ( kit->m_Offset[0] + kit->m_Length - 1 );
+        if ( b < e )
+          {
+          eroded.push_back( IntervalType(b, e) );
+          }
+        }
+
+      // intersect with the intervals already computed for that row. Both
+      // containers are sorted and made of disjoint intervals.
+      intersection.clear();
+      typename IntervalContainerType::const_iterator ait = current.begin();
+      typename IntervalContainerType::const_iterator bit = eroded.begin();
+      while ( ait != current.end() && bit != eroded.end() )
+        {
+        const IndexValueType b = vnl_math_max(ait->first, bit->first);
+        const IndexValueType e = vnl_math_min(ait->second, bit->second);
+        if ( b < e )
+          {
+          intersection.push_back( IntervalType(b, e) );
+          }
+        if ( ait->second < bit->second )
+          {
+          ++ait;
+          }
+        else
+          {
+          ++bit;
+          }
+        }
+      current.swap(intersection);
+      }
+
+    if ( !current.empty() )
+      {
+      result[*cit].swap(current);
+      }
+    }
+}
+
+template< class TImage, class TKernel >
+void
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::ThreadedProcessLabelObject(LabelObjectType *labelObject)
+{
+  typedef typename LabelObjectType::LineContainerType LineContainerType;
+  LineContainerType & lines = labelObject->GetLineContainer();
+
+  // group the lines by row
+  RowMapType rows;
+  for ( typename LineContainerType::const_iterator lit = lines.begin(); lit != lines.end(); ++lit )
+    {
+    IndexType row = lit->GetIndex();
+    const IndexValueType b = row[0];
+    row[0] = 0;
+    rows[row].push_back( IntervalType( b, b + static_cast< OffsetValueType >( lit->GetLength() ) ) );
+    }
+  for ( typename RowMapType::iterator rit = rows.begin(); rit != rows.end(); ++rit )
+    {
+    NormalizeIntervals(rit->second);
+    }
+
+  RowMapType result;
+  switch ( m_Operation )
+    {
+    case ERODE:
+      this->ErodeRows(rows, result);
+      break;
+    case OPENING:
+      this->ErodeRows(rows, result);
+      rows.swap(result);
+      this->DilateRows(rows, result);
+      break;
+    case CLOSING:
+      {
+      RowMapType dilated;
+      this->DilateRows(rows, dilated);
+      this->ErodeRows(dilated, result);
+      if ( !m_KernelHasCenter )
+        {
+        // as in BinaryMorphologicalClosingImageFilter, the pixels of the
+        // object are kept, even if the erosion removed them
+        for ( typename RowMapType::const_iterator rit = rows.begin(); rit != rows.end(); ++rit )
+          {
+          IntervalContainerType & intervals = result[rit->first];
+          intervals.insert( intervals.end(), rit->second.begin(), rit->second.end() );
+          NormalizeIntervals(intervals);
+          }
+        }
+      break;
+      }
+    default:
+      this->DilateRows(rows, result);
+      break;
+    }
+
+  // and put the lines back in the object
+  lines.clear();
+  for ( typename RowMapType::const_iterator rit = result.begin(); rit != result.end(); ++rit )
+    {
+    IndexType idx = rit->first;
+    for ( typename IntervalContainerType::const_iterator iit = rit->second.begin();
+          iit != rit->second.end(); ++iit )
+      {
+      idx[0] = iit->first;
+      labelObject->AddLine( idx, static_cast< LengthType >( iit->second - iit->first ) );
+      }
+    }
+}
+
+template< class TImage, class TKernel >
+void
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::AfterThreadedGenerateData()
+{
+  Superclass::AfterThreadedGenerateData();
+
+  // remove the objects which have been completely eroded. That can't be
+  // done in the threads, while the label objects are being iterated.
+  ImageType *output = this->GetOutput();
+
+  std::vector< PixelType > emptyLabels;
+  const LabelObjectContainerType & labelObjects = output->GetLabelObjectContainer();
+  for ( typename LabelObjectContainerType::const_iterator it = labelObjects.begin();
+        it != labelObjects.end(); ++it )
+    {
+    if ( it->second->Empty() )
+      {
+      emptyLabels.push_back(it->first);
+      }
+    }
+  for ( typename std::vector< PixelType >::const_iterator it = emptyLabels.begin();
+        it != emptyLabels.end(); ++it )
+    {
+    output->RemoveLabel(*it);
+    }
+}
+
+template< class TImage, class TKernel >
+void
+RunLengthBinaryMorphologyLabelMapFilter< TImage, TKernel >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Kernel: " << m_Kernel << std::endl;
+  os << indent << "Operation: " << m_Operation << std::endl;
+  os << indent << "Number of kernel runs: " << m_KernelRuns.size() << std::endl;
+}
+} // end namespace itk
+#endif
@@ -0,0 +1,230 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkStreamingMorphologicalWatershedImageFilter_h
+#define __itkStreamingMorphologicalWatershedImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkOneWayEquivalencyTable.h"
+#include <map>
+#include <vector>
+
+namespace itk
+{
+/** \class StreamingMorphologicalWatershedImageFilter
+ * \brief Morphological watershed computed tile by tile with bounded memory.
+ *
+ * This filter produces the same kind of labeling as
+ * MorphologicalWatershedImageFilter, but never requests more than one
+ * padded tile of its input at a time, and it is able to produce any
+ * requested sub-region of its output.  It can thus be placed between a
+ * streaming ImageFileReader and an ImageFileWriter with
+ * NumberOfStreamDivisions set to segment images that do not fit in
+ * memory.
+ *
+ * The largest possible region is divided in tiles of size TileSize.
+ * Each tile is padded by Overlap pixels, the padded region is pulled
+ * from the upstream pipeline and segmented with
+ * MorphologicalWatershedImageFilter.  The first time the output is
+ * requested, all the tiles are visited once to assign a range of
+ * labels to each tile and to record in a OneWayEquivalencyTable the
+ * basins which meet across the tile seams.  Only the labels on the
+ * seam planes of the tiles not yet visited are kept in memory.
+ *
+ * The two tiles on each side of a seam both segment the first plane of
+ * the upper tile, but with a different context, so a basin of one tile
+ * may cover parts of two basins of the other one.  A basin is thus only
+ * merged with the basin of the other tile sharing the most pixels of
+ * the seam plane with it, when that basin also shares the most pixels
+ * with it.  When the overlap is too small to resolve the flooding of a
+ * basin, this may split the basin but never merges two basins through
+ * a single one of the other tile.  The
+ * requested output region is then generated by segmenting again the
+ * tiles it intersects and by relabeling them through the flattened
+ * equivalency table.
+ *
+ * Peak memory is thus bounded by the size of a padded tile, the seam
+ * planes of one row of tiles and the number of basins crossing a seam,
+ * independently of the image size.  The result matches the one of
+ * MorphologicalWatershedImageFilter as long as the flooding of the
+ * basins crossing a seam is resolved within the overlap; increasing the
+ * Overlap makes the tiled result converge to the global one.
+ *
+ * Watershed pixels are labeled 0.  TOutputImage should be an integer
+ * type large enough to hold the sum of the number of basins of all the
+ * tiles.  Labels are in no particular order and are not consecutive;
+ * pass the output to a RelabelComponentImageFilter to reorder them.
+ *
+ * \sa MorphologicalWatershedImageFilter, OneWayEquivalencyTable
+ * \sa StreamingImageFilter, ImageFileWriter
+ * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
+ * \ingroup WatershedSegmentation
+ * \ingroup ITK-Review
+ */
+template< class TInputImage, class TOutputImage >
+class ITK_EXPORT StreamingMorphologicalWatershedImageFilter:
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef StreamingMorphologicalWatershedImageFilter      Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                            Pointer;
+  typedef SmartPointer< const Self >                      ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                            InputImageType;
+  typedef TOutputImage                           OutputImageType;
+  typedef typename InputImageType::Pointer       InputImagePointer;
+  typedef typename InputImageType::ConstPointer  InputImageConstPointer;
+  typedef typename InputImageType::RegionType    InputImageRegionType;
+  typedef typename InputImageType::PixelType     InputImagePixelType;
+  typedef typename InputImageType::SizeType      SizeType;
+  typedef typename InputImageType::IndexType     IndexType;
+  typedef typename OutputImageType::Pointer      OutputImagePointer;
+  typedef typename OutputImageType::ConstPointer OutputImageConstPointer;
+  typedef typename OutputImageType::RegionType   OutputImageRegionType;
+  typedef typename OutputImageType::PixelType    OutputImagePixelType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(InputImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+  itkStaticConstMacro(OutputImageDimension, unsigned int,
+                      TOutputImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(StreamingMorphologicalWatershedImageFilter,
+               ImageToImageFilter);
+
+  /**
+   * Set/Get whether the connected components are defined strictly by
+   * face connectivity or by face+edge+vertex connectivity.  Default is
+   * FullyConnectedOff.  For objects that are 1 pixel wide, use
+   * FullyConnectedOn.
+   */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstReferenceMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /**
+   * Set/Get whether the watershed pixel must be marked or not. Default
+   * is true.
+   */
+  itkSetMacro(MarkWatershedLine, bool);
+  itkGetConstReferenceMacro(MarkWatershedLine, bool);
+  itkBooleanMacro(MarkWatershedLine);
+
+  /** Set/Get the height of the minima removed before the flooding.
+   * Default is 0. */
+  itkSetMacro(Level, InputImagePixelType);
+  itkGetConstMacro(Level, InputImagePixelType);
+
+  /** Set/Get the size of the tiles the input is divided in. The last
+   * tile along each dimension may be smaller. Default is 256 pixels in
+   * each dimension. */
+  itkSetMacro(TileSize, SizeType);
+  itkGetConstReferenceMacro(TileSize, SizeType);
+
+  /** Set/Get the number of pixels each tile is padded with on each side
+   * before being segmented. It must be at least 1 in each dimension.
+   * Default is 16 pixels in each dimension. */
+  itkSetMacro(Overlap, SizeType);
+  itkGetConstReferenceMacro(Overlap, SizeType);
+
+  /** Return the number of tiles the largest possible region is divided
+   * in, or 0 without an input. Valid after UpdateOutputInformation(). */
+  SizeValueType GetNumberOfTiles() const;
+
+  /** This filter manages the requested region of its input tile by tile
+   * and does not propagate the output requested region upstream. */
+  virtual void PropagateRequestedRegion(DataObject *output);
+
+  /** Run the seam analysis if required, then generate the requested
+   * region of the output one tile at a time. */
+  virtual void UpdateOutputData(DataObject *output);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro( OutputIsIntegerCheck,
+                   ( Concept::IsInteger< OutputImagePixelType > ) );
+  itkConceptMacro( SameDimensionCheck,
+                   ( Concept::SameDimension< InputImageDimension, OutputImageDimension > ) );
+  /** End concept checking */
+#endif
+protected:
+  StreamingMorphologicalWatershedImageFilter();
+  ~StreamingMorphologicalWatershedImageFilter() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Visit all the tiles once to compute the label offset of each tile
+   * and the equivalencies between the basins meeting at the seams. */
+  void AnalyzeTiles();
+
+  /** Segment the padded region of a tile. The input is pulled from the
+   * upstream pipeline for that region only. */
+  OutputImagePointer SegmentTile(const InputImageRegionType & paddedRegion);
+
+  /** Return the region of the tile with the given number, and its
+   * padded version clipped to the largest possible region. */
+  InputImageRegionType GetTileRegion(SizeValueType tile) const;
+
+  InputImageRegionType GetPaddedTileRegion(const InputImageRegionType & tileRegion) const;
+
+private:
+  StreamingMorphologicalWatershedImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &);                             //purposely not implemented
+
+  /** Record that the basins a and b are the same one. */
+  void MergeLabels(unsigned long a, unsigned long b);
+
+  typedef std::vector< unsigned long >                                 SeamType;
+  typedef std::map< std::pair< SizeValueType, unsigned int >, SeamType > SeamMapType;
+
+  /** Merge the basins of two tiles which are each other's best match on
+   * a seam plane, given the labels of the plane in both tiles. */
+  void MergeSeam(const SeamType & lower, const SeamType & upper);
+
+  bool m_FullyConnected;
+
+  bool m_MarkWatershedLine;
+
+  InputImagePixelType m_Level;
+
+  SizeType m_TileSize;
+
+  SizeType m_Overlap;
+
+  /** Number of tiles along each dimension. */
+  SizeType m_NumberOfTilesPerDimension;
+
+  /** First label of each tile, minus one. */
+  std::vector< unsigned long > m_TileLabelOffsets;
+
+  OneWayEquivalencyTable::Pointer m_EquivalencyTable;
+
+  TimeStamp m_AnalysisTime;
+}; // end of class
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkStreamingMorphologicalWatershedImageFilter.txx"
+#endif
+
+#endif
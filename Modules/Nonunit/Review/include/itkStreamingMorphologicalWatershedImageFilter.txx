@@ -0,0 +1,462 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkStreamingMorphologicalWatershedImageFilter_txx
+#define __itkStreamingMorphologicalWatershedImageFilter_txx
+
+#include "itkStreamingMorphologicalWatershedImageFilter.h"
+#include "itkMorphologicalWatershedImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+template< class TInputImage, class TOutputImage >
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::StreamingMorphologicalWatershedImageFilter()
+{
+  m_FullyConnected = false;
+  m_MarkWatershedLine = true;
+  m_Level = NumericTraits< InputImagePixelType >::Zero;
+  m_TileSize.Fill(256);
+  m_Overlap.Fill(16);
+  m_NumberOfTilesPerDimension.Fill(0);
+  m_EquivalencyTable = OneWayEquivalencyTable::New();
+}
+
+template< class TInputImage, class TOutputImage >
+SizeValueType
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::GetNumberOfTiles() const
+{
+  const InputImageType *input = this->GetInput();
+  if ( !input )
+    {
+    return 0;
+    }
+
+  const InputImageRegionType & largest = input->GetLargestPossibleRegion();
+  SizeValueType                numberOfTiles = 1;
+
+  for ( unsigned int d = 0; d < InputImageDimension; d++ )
+    {
+    if ( m_TileSize[d] == 0 )
+      {
+      return 0;
+      }
+    numberOfTiles *= ( largest.GetSize()[d] + m_TileSize[d] - 1 ) / m_TileSize[d];
+    }
+  return numberOfTiles;
+}
+
+template< class TInputImage, class TOutputImage >
+typename StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >::InputImageRegionType
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::GetTileRegion(SizeValueType tile) const
+{
+  const InputImageRegionType & largest = this->GetInput()->GetLargestPossibleRegion();
+  InputImageRegionType         region;
+
+  for ( unsigned int d = 0; d < InputImageDimension; d++ )
+    {
+    const SizeValueType numberOfTiles =
+      ( largest.GetSize()[d] + m_TileSize[d] - 1 ) / m_TileSize[d];
+    const SizeValueType position = tile % numberOfTiles;
+    tile /= numberOfTiles;
+
+    const SizeValueType start = position * m_TileSize[d];
+    region.SetIndex( d, largest.GetIndex()[d] + static_cast< OffsetValueType >( start ) );
+    region.SetSize( d, vnl_math_min( m_TileSize[d], largest.GetSize()[d] - start ) );
+    }
+  return region;
+}
+
+template< class TInputImage, class TOutputImage >
+typename StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >::InputImageRegionType
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::GetPaddedTileRegion(const InputImageRegionType & tileRegion) const
+{
+  InputImageRegionType padded = tileRegion;
+
+  padded.PadByRadius(m_Overlap);
+  padded.Crop( this->GetInput()->GetLargestPossibleRegion() );
+  return padded;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::PropagateRequestedRegion(DataObject *output)
+{
+  // check flag to avoid executing forever if there is a loop
+  if ( this->m_Updating )
+    {
+    return;
+    }
+
+  this->EnlargeOutputRequestedRegion(output);
+  this->GenerateOutputRequestedRegion(output);
+
+  // the requested region of the input is set tile by tile when the
+  // filter executes, so it is not propagated here
+}
+
+template< class TInputImage, class TOutputImage >
+typename StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >::OutputImagePointer
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::SegmentTile(const InputImageRegionType & paddedRegion)
+{
+  // pull only the padded tile from the upstream pipeline
+  InputImagePointer inputPtr = const_cast< InputImageType * >( this->GetInput() );
+
+  inputPtr->SetRequestedRegion(paddedRegion);
+  inputPtr->PropagateRequestedRegion();
+  inputPtr->UpdateOutputData();
+
+  // copy it in an image disconnected from the pipeline, with the padded
+  // region as largest possible region, so the watershed stays inside
+  // the tile
+  InputImagePointer tile = InputImageType::New();
+  tile->CopyInformation(inputPtr);
+  tile->SetRegions(paddedRegion);
+  tile->Allocate();
+
+  ImageRegionConstIterator< InputImageType > inIt(inputPtr, paddedRegion);
+  ImageRegionIterator< InputImageType >      tileIt(tile, paddedRegion);
+  for ( inIt.GoToBegin(), tileIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++tileIt )
+    {
+    tileIt.Set( inIt.Get() );
+    }
+
+  typedef MorphologicalWatershedImageFilter< InputImageType, OutputImageType > WatershedType;
+  typename WatershedType::Pointer wshed = WatershedType::New();
+  wshed->SetInput(tile);
+  wshed->SetFullyConnected(m_FullyConnected);
+  wshed->SetMarkWatershedLine(m_MarkWatershedLine);
+  wshed->SetLevel(m_Level);
+  wshed->SetNumberOfThreads( this->GetNumberOfThreads() );
+  wshed->Update();
+
+  OutputImagePointer labels = wshed->GetOutput();
+  labels->DisconnectPipeline();
+  return labels;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::MergeLabels(unsigned long a, unsigned long b)
+{
+  a = m_EquivalencyTable->RecursiveLookup(a);
+  b = m_EquivalencyTable->RecursiveLookup(b);
+
+  // always point the largest root to the smallest one to avoid cycles
+  if ( a < b )
+    {
+    m_EquivalencyTable->Add(b, a);
+    }
+  else if ( b < a )
+    {
+    m_EquivalencyTable->Add(a, b);
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::MergeSeam(const SeamType & lower, const SeamType & upper)
+{
+  // number of pixels of the seam plane shared by each pair of basins
+  typedef std::map< std::pair< unsigned long, unsigned long >, SizeValueType > OverlapMapType;
+  OverlapMapType overlaps;
+  for ( size_t i = 0; i < lower.size(); i++ )
+    {
+    if ( lower[i] != 0 && upper[i] != 0 )
+      {
+      ++overlaps[std::make_pair(lower[i], upper[i])];
+      }
+    }
+
+  // the basin of the other tile sharing the most pixels with each basin
+  typedef std::map< unsigned long, std::pair< unsigned long, SizeValueType > > BestMatchMapType;
+  BestMatchMapType lowerMatches;
+  BestMatchMapType upperMatches;
+  for ( typename OverlapMapType::const_iterator it = overlaps.begin(); it != overlaps.end(); ++it )
+    {
+    const unsigned long lowerLabel = it->first.first;
+    const unsigned long upperLabel = it->first.second;
+    std::pair< unsigned long, SizeValueType > & lowerMatch = lowerMatches[lowerLabel];
+    if ( it->second > lowerMatch.second )
+      {
+      lowerMatch = std::make_pair(upperLabel, it->second);
+      }
+    std::pair< unsigned long, SizeValueType > & upperMatch = upperMatches[upperLabel];
+    if ( it->second > upperMatch.second )
+      {
+      upperMatch = std::make_pair(lowerLabel, it->second);
+      }
+    }
+
+  // a basin split differently by the two tiles only merges with its
+  // mutual best match, so two basins of one tile are never merged
+  // through a single basin of the other one
+  for ( typename BestMatchMapType::const_iterator it = lowerMatches.begin(); it != lowerMatches.end(); ++it )
+    {
+    if ( upperMatches[it->second.first].first == it->first )
+      {
+      this->MergeLabels(it->first, it->second.first);
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::AnalyzeTiles()
+{
+  for ( unsigned int d = 0; d < InputImageDimension; d++ )
+    {
+    if ( m_TileSize[d] == 0 )
+      {
+      itkExceptionMacro(<< "TileSize must be at least 1 in each dimension.");
+      }
+    if ( m_Overlap[d] == 0 )
+      {
+      itkExceptionMacro(<< "Overlap must be at least 1 in each dimension.");
+      }
+    }
+
+  const InputImageRegionType & largest = this->GetInput()->GetLargestPossibleRegion();
+  SizeValueType                stride[InputImageDimension];
+  SizeValueType                numberOfTiles = 1;
+  for ( unsigned int d = 0; d < InputImageDimension; d++ )
+    {
+    m_NumberOfTilesPerDimension[d] =
+      ( largest.GetSize()[d] + m_TileSize[d] - 1 ) / m_TileSize[d];
+    stride[d] = numberOfTiles;
+    numberOfTiles *= m_NumberOfTilesPerDimension[d];
+    }
+
+  m_EquivalencyTable->Clear();
+  m_TileLabelOffsets.resize(numberOfTiles);
+
+  // labels on the first plane of the tiles not yet visited, as seen by
+  // their already visited lower neighbor
+  SeamMapType seams;
+
+  const unsigned long maxLabel =
+    static_cast< unsigned long >( NumericTraits< OutputImagePixelType >::max() );
+  unsigned long offset = 0;
+
+  for ( SizeValueType tile = 0; tile < numberOfTiles && !this->GetAbortGenerateData(); tile++ )
+    {
+    const InputImageRegionType tileRegion = this->GetTileRegion(tile);
+    const InputImageRegionType paddedRegion = this->GetPaddedTileRegion(tileRegion);
+    OutputImagePointer         labels = this->SegmentTile(paddedRegion);
+
+    unsigned long tileMaxLabel = 0;
+    ImageRegionConstIterator< OutputImageType > lit( labels, paddedRegion );
+    for ( lit.GoToBegin(); !lit.IsAtEnd(); ++lit )
+      {
+      tileMaxLabel = vnl_math_max( tileMaxLabel, static_cast< unsigned long >( lit.Get() ) );
+      }
+    if ( tileMaxLabel > maxLabel - offset )
+      {
+      itkExceptionMacro(<< "The output pixel type is too small to hold the labels of all the tiles.");
+      }
+    m_TileLabelOffsets[tile] = offset;
+
+    for ( unsigned int d = 0; d < InputImageDimension; d++ )
+      {
+      const SizeValueType position = ( tile / stride[d] ) % m_NumberOfTilesPerDimension[d];
+
+      // connect the basins crossing the seam with the lower neighbor
+      if ( position > 0 )
+        {
+        typename SeamMapType::iterator seamIt =
+          seams.find( std::make_pair(tile - stride[d], d) );
+        if ( seamIt != seams.end() )
+          {
+          InputImageRegionType plane = tileRegion;
+          plane.SetSize(d, 1);
+          SeamType seam;
+          seam.reserve( plane.GetNumberOfPixels() );
+          ImageRegionConstIterator< OutputImageType > pit(labels, plane);
+          for ( pit.GoToBegin(); !pit.IsAtEnd(); ++pit )
+            {
+            const unsigned long label = static_cast< unsigned long >( pit.Get() );
+            seam.push_back(label == 0 ? 0 : label + offset);
+            }
+          this->MergeSeam(seamIt->second, seam);
+          seams.erase(seamIt);
+          }
+        }
+
+      // keep the labels of the first plane of the upper neighbor
+      if ( position + 1 < m_NumberOfTilesPerDimension[d] )
+        {
+        InputImageRegionType plane = tileRegion;
+        plane.SetIndex( d, tileRegion.GetIndex()[d]
+                        + static_cast< OffsetValueType >( tileRegion.GetSize()[d] ) );
+        plane.SetSize(d, 1);
+
+        SeamType & seam = seams[std::make_pair(tile, d)];
+        seam.reserve( plane.GetNumberOfPixels() );
+        ImageRegionConstIterator< OutputImageType > pit(labels, plane);
+        for ( pit.GoToBegin(); !pit.IsAtEnd(); ++pit )
+          {
+          const unsigned long label = static_cast< unsigned long >( pit.Get() );
+          seam.push_back(label == 0 ? 0 : label + offset);
+          }
+        }
+      }
+
+    offset += tileMaxLabel;
+    this->UpdateProgress( 0.5f * ( tile + 1 ) / numberOfTiles );
+    }
+
+  m_EquivalencyTable->Flatten();
+}
+
+template< class TInputImage, class TOutputImage >
+void
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::UpdateOutputData( DataObject *itkNotUsed(output) )
+{
+  // prevent chasing our tail
+  if ( this->m_Updating )
+    {
+    return;
+    }
+
+  // Prepare all the outputs. This may deallocate previous bulk data.
+  this->PrepareOutputs();
+
+  // Make sure we have the necessary inputs
+  unsigned int ninputs = this->GetNumberOfValidRequiredInputs();
+  if ( ninputs < this->GetNumberOfRequiredInputs() )
+    {
+    itkExceptionMacro(
+      << "At least " << static_cast< unsigned int >( this->GetNumberOfRequiredInputs() )
+      << " inputs are required but only " << ninputs << " are specified.");
+    return;
+    }
+  this->SetAbortGenerateData(0);
+  this->SetProgress(0.0);
+  this->m_Updating = true;
+
+  this->InvokeEvent( StartEvent() );
+
+  InputImagePointer inputPtr = const_cast< InputImageType * >( this->GetInput() );
+
+  try
+    {
+    // the tile offsets and the seam equivalencies are computed once for
+    // all the requested regions, and only recomputed when the filter or
+    // the upstream pipeline is modified
+    if ( m_AnalysisTime < this->GetMTime()
+         || m_AnalysisTime < inputPtr->GetPipelineMTime()
+         || m_TileLabelOffsets.size() != this->GetNumberOfTiles() )
+      {
+      this->AnalyzeTiles();
+      m_AnalysisTime.Modified();
+      }
+
+    OutputImagePointer    outputPtr = this->GetOutput();
+    OutputImageRegionType outputRegion = outputPtr->GetRequestedRegion();
+    outputPtr->SetBufferedRegion(outputRegion);
+    outputPtr->Allocate();
+
+    const SizeValueType numberOfTiles = this->GetNumberOfTiles();
+    for ( SizeValueType tile = 0; tile < numberOfTiles && !this->GetAbortGenerateData(); tile++ )
+      {
+      const InputImageRegionType tileRegion = this->GetTileRegion(tile);
+      OutputImageRegionType      region = tileRegion;
+      if ( !region.Crop(outputRegion) )
+        {
+        continue;
+        }
+
+      OutputImagePointer  labels = this->SegmentTile( this->GetPaddedTileRegion(tileRegion) );
+      const unsigned long offset = m_TileLabelOffsets[tile];
+
+      ImageRegionConstIterator< OutputImageType > lit(labels, region);
+      ImageRegionIterator< OutputImageType >      oit(outputPtr, region);
+      for ( lit.GoToBegin(), oit.GoToBegin(); !lit.IsAtEnd(); ++lit, ++oit )
+        {
+        const unsigned long label = static_cast< unsigned long >( lit.Get() );
+        if ( label == 0 )
+          {
+          oit.Set(NumericTraits< OutputImagePixelType >::Zero);
+          }
+        else
+          {
+          oit.Set( static_cast< OutputImagePixelType >(
+                     m_EquivalencyTable->Lookup(label + offset) ) );
+          }
+        }
+
+      this->UpdateProgress( 0.5f + 0.5f * ( tile + 1 ) / numberOfTiles );
+      }
+    }
+  catch ( ... )
+    {
+    this->m_Updating = false;
+    throw;
+    }
+
+  if ( !this->GetAbortGenerateData() )
+    {
+    this->UpdateProgress(1.0);
+    }
+
+  this->InvokeEvent( EndEvent() );
+
+  // Now we have to mark the data as up to data.
+  for ( unsigned int idx = 0; idx < this->GetNumberOfOutputs(); ++idx )
+    {
+    if ( this->GetOutput(idx) )
+      {
+      this->GetOutput(idx)->DataHasBeenGenerated();
+      }
+    }
+
+  // Release any inputs if marked for release
+  this->ReleaseInputs();
+
+  this->m_Updating = false;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+StreamingMorphologicalWatershedImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FullyConnected: "  << m_FullyConnected << std::endl;
+  os << indent << "MarkWatershedLine: "  << m_MarkWatershedLine << std::endl;
+  os << indent << "Level: "
+     << static_cast< typename NumericTraits< InputImagePixelType >::PrintType >( m_Level )
+     << std::endl;
+  os << indent << "TileSize: "  << m_TileSize << std::endl;
+  os << indent << "Overlap: "  << m_Overlap << std::endl;
+  os << indent << "EquivalencyTable: "  << m_EquivalencyTable.GetPointer() << std::endl;
+}
+} // end namespace itk
+#endif
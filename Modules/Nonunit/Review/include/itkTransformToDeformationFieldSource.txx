@@ -22,9 +22,10 @@
 
 #include "itkIdentityTransform.h"
 #include "itkProgressReporter.h"
-#include "itkImageRegionIteratorWithIndex.h"
 #include "itkImageLinearIteratorWithIndex.h"
 
+#include <vector>
+
 namespace itk
 {
 /**
@@ -210,15 +211,37 @@ TransformToDeformationFieldSource< TOutputImage, TTransformPrecisionType >
   // Get the output pointer
   OutputImagePointer outputPtr = this->GetOutput();
 
-  // Create an iterator that will walk the output region for this thread.
-  typedef ImageRegionIteratorWithIndex< TOutputImage > OutputIteratorType;
+  // Create an iterator that will walk the output region for this thread,
+  // one scanline at a time.
+  typedef ImageLinearIteratorWithIndex< TOutputImage > OutputIteratorType;
   OutputIteratorType outIt(outputPtr, outputRegionForThread);
+  outIt.SetDirection(0);
+
+  // The points of a scanline are mapped by the transform at once
+  typedef typename TransformType::InputPointType   TransformInputPointType;
+  typedef typename TransformType::OutputPointType  TransformOutputPointType;
+  typedef typename TransformType::InputVectorType  TransformInputVectorType;
+  const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+  std::vector< TransformOutputPointType > transformedPoints(lineLength);
 
   // Define a few variables that will be used to translate from an input pixel
   // to an output pixel
   PointType outputPoint;         // Coordinates of output pixel
-  PointType transformedPoint;    // Coordinates of transformed pixel
   PixelType deformation;         // the difference
+  IndexType index;
+
+  // The physical step between two pixels of a scanline
+  index = outIt.GetIndex();
+  outputPtr->TransformIndexToPhysicalPoint(index, outputPoint);
+  PointType outputPointNeighbour;
+  ++index[0];
+  outputPtr->TransformIndexToPhysicalPoint(index, outputPointNeighbour);
+  TransformInputVectorType step;
+  TransformInputPointType  firstPoint;
+  for ( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+    step[i] = outputPointNeighbour[i] - outputPoint[i];
+    }
 
   // Support for progress methods/callbacks
   ProgressReporter progress( this, threadId,
@@ -228,25 +251,34 @@ TransformToDeformationFieldSource< TOutputImage, TTransformPrecisionType >
   outIt.GoToBegin();
   while ( !outIt.IsAtEnd() )
     {
-    // Determine the index of the current output pixel
+    // Compute the transformed points of the scanline
     outputPtr->TransformIndexToPhysicalPoint(outIt.GetIndex(), outputPoint);
-
-    // Compute corresponding input pixel position
-    transformedPoint = this->m_Transform->TransformPoint(outputPoint);
-
-    // Compute the deformation
     for ( unsigned int i = 0; i < ImageDimension; ++i )
       {
-      deformation[i] = static_cast< PixelValueType >(
-        transformedPoint[i] - outputPoint[i] );
+      firstPoint[i] = outputPoint[i];
       }
+    this->m_Transform->TransformScanline(firstPoint, step,
+                                         &transformedPoints[0], lineLength);
+
+    SizeValueType p = 0;
+    while ( !outIt.IsAtEndOfLine() )
+      {
+      // Compute the deformation
+      for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        deformation[i] = static_cast< PixelValueType >(
+          transformedPoints[p][i] - ( firstPoint[i] + p * step[i] ) );
+        }
 
-    // Set it
-    outIt.Set(deformation);
+      // Set it
+      outIt.Set(deformation);
 
-    // Update progress and iterator
-    progress.CompletedPixel();
-    ++outIt;
+      // Update progress and iterator
+      progress.CompletedPixel();
+      ++outIt;
+      ++p;
+      }
+    outIt.NextLine();
     }
 } // end NonlinearThreadedGenerateData()
 
@@ -0,0 +1,182 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+/** This test composes two deformation fields with the
+ * DeformationFieldComposer and compares the result with the one of a
+ * WarpVectorImageFilter followed by an AddImageFilter.
+ */
+
+#include "itkDeformationFieldComposer.h"
+#include "itkWarpVectorImageFilter.h"
+#include "itkVectorLinearInterpolateNearestNeighborExtrapolateImageFunction.h"
+#include "itkAddImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+namespace
+{
+template< class TField >
+typename TField::Pointer MakeField(double amplitude, double phase)
+{
+  typename TField::SizeType size;
+  size[0] = 57;
+  size[1] = 43;
+  typename TField::IndexType index;
+  index[0] = -3;
+  index[1] = 5;
+  typename TField::RegionType region(index, size);
+  typename TField::SpacingType spacing;
+  spacing[0] = 0.8;
+  spacing[1] = 1.3;
+  typename TField::PointType origin;
+  origin[0] = 10.0;
+  origin[1] = -4.0;
+  typename TField::DirectionType direction;
+  direction[0][0] = 0.6;
+  direction[0][1] = -0.8;
+  direction[1][0] = 0.8;
+  direction[1][1] = 0.6;
+
+  typename TField::Pointer field = TField::New();
+  field->SetRegions(region);
+  field->SetSpacing(spacing);
+  field->SetOrigin(origin);
+  field->SetDirection(direction);
+  field->Allocate();
+
+  // a smooth field, with large displacements near the borders to check
+  // the extrapolation
+  itk::ImageRegionIteratorWithIndex< TField > it(field, region);
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double x = it.GetIndex()[0];
+    const double y = it.GetIndex()[1];
+    typename TField::PixelType value;
+    value[0] = amplitude * vcl_sin(0.11 * x + 0.07 * y + phase);
+    value[1] = amplitude * vcl_cos(0.05 * x - 0.13 * y + phase);
+    it.Set(value);
+    }
+  return field;
+}
+
+template< class TField >
+bool SameFields(const TField *field1, const TField *field2, const char *name)
+{
+  itk::ImageRegionConstIteratorWithIndex< TField > it1( field1, field1->GetBufferedRegion() );
+  for ( it1.GoToBegin(); !it1.IsAtEnd(); ++it1 )
+    {
+    const typename TField::PixelType value2 = field2->GetPixel( it1.GetIndex() );
+    for ( unsigned int k = 0; k < TField::PixelType::Dimension; k++ )
+      {
+      if ( vnl_math_abs(it1.Get()[k] - value2[k]) > 1e-5 )
+        {
+        std::cerr << name << ": the composed field is " << value2
+                  << " instead of " << it1.Get() << " at " << it1.GetIndex()
+                  << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkDeformationFieldComposerTest( int, char * [] )
+{
+  const unsigned int Dimension = 2;
+
+  typedef itk::Vector< float, Dimension >    VectorPixelType;
+  typedef itk::Image< VectorPixelType, Dimension > FieldType;
+
+  typedef itk::DeformationFieldComposer< FieldType > ComposerType;
+  typedef itk::WarpVectorImageFilter< FieldType, FieldType, FieldType > WarperType;
+  typedef itk::VectorLinearInterpolateNearestNeighborExtrapolateImageFunction<
+    FieldType, double >                                                 InterpolatorType;
+  typedef itk::AddImageFilter< FieldType, FieldType, FieldType > AdderType;
+
+  FieldType::Pointer outer = MakeField< FieldType >(6.0, 0.0);
+  FieldType::Pointer inner = MakeField< FieldType >(9.0, 1.0);
+
+  // the reference composition
+  WarperType::Pointer warper = WarperType::New();
+  warper->SetInterpolator( InterpolatorType::New() );
+  warper->SetOutputOrigin( inner->GetOrigin() );
+  warper->SetOutputSpacing( inner->GetSpacing() );
+  warper->SetOutputDirection( inner->GetDirection() );
+  warper->SetInput(outer);
+  warper->SetDeformationField(inner);
+
+  AdderType::Pointer adder = AdderType::New();
+  adder->SetInput1( warper->GetOutput() );
+  adder->SetInput2(inner);
+
+  itk::TimeProbe pipelineTimer;
+  pipelineTimer.Start();
+  adder->Update();
+  pipelineTimer.Stop();
+  FieldType::ConstPointer expected = adder->GetOutput();
+
+  // compose into a new field
+  ComposerType::Pointer composer = ComposerType::New();
+  composer->SetNumberOfThreads(3);
+  std::cout << composer << std::endl;
+
+  FieldType::Pointer output = FieldType::New();
+  output->CopyInformation(inner);
+  output->SetRegions( inner->GetBufferedRegion() );
+  output->Allocate();
+
+  itk::TimeProbe composerTimer;
+  composerTimer.Start();
+  composer->Compose(outer, inner, output);
+  composerTimer.Stop();
+  if ( !SameFields< FieldType >(expected, output, "Compose") )
+    {
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "WarpVectorImageFilter and AddImageFilter: " << pipelineTimer.GetTotal()
+            << " s, DeformationFieldComposer: " << composerTimer.GetTotal() << " s"
+            << std::endl;
+
+  // compose in place of the inner field
+  composer->Compose(outer, inner, inner);
+  if ( !SameFields< FieldType >(expected, inner, "Compose in place") )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the outer field is read around each pixel and can not be the output
+  bool caught = false;
+  try
+    {
+    composer->Compose(outer, inner, outer);
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cout << "Caught expected exception: " << e.GetDescription() << std::endl;
+    caught = true;
+    }
+  if ( !caught )
+    {
+    std::cerr << "Composing in place of the outer field did not throw" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
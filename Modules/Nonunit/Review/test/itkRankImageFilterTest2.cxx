@@ -0,0 +1,180 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkRankImageFilter.h"
+#include "itkMedianImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+// Compare the rank and median filters on 16 bit images, for which they
+// use the tiered histogram, with the same filters on int images, for
+// which RankImageFilter uses the map based histogram and
+// MedianImageFilter sorts the neighborhood of each pixel.
+
+namespace
+{
+typedef itk::Image< int, 3 > ReferenceImageType;
+
+template< class TImage >
+void CreateImages(TImage *image, ReferenceImageType *reference)
+{
+  typedef typename TImage::PixelType PixelType;
+
+  typename TImage::SizeType size;
+  size[0] = 31;
+  size[1] = 23;
+  size[2] = 13;
+  image->SetRegions( size );
+  image->Allocate();
+  reference->SetRegions( size );
+  reference->Allocate();
+
+  // a CT like ramp with noise, and a few pixels at the bounds of the
+  // pixel type
+  const long minimum = itk::NumericTraits< PixelType >::NonpositiveMin();
+  const long maximum = itk::NumericTraits< PixelType >::max();
+  const long offset = minimum < 0 ? -1024 : 0;
+  unsigned long seed = 1;
+  itk::ImageRegionIterator< TImage >             it( image, image->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< ReferenceImageType > rit( reference, reference->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it, ++rit )
+    {
+    seed = ( seed * 1103515245 + 12345 ) % 2147483648UL;
+    const typename TImage::IndexType index = it.GetIndex();
+    long value = offset + 100 * index[0] + 20 * index[1] + 50 * index[2]
+                 + static_cast< long >( ( seed >> 8 ) % 600 ) - 300;
+    if ( ( seed >> 4 ) % 97 == 0 )
+      {
+      value = ( seed >> 12 ) % 2 ? minimum : maximum;
+      }
+    value = vnl_math_max( minimum, vnl_math_min( maximum, value ) );
+    it.Set( static_cast< PixelType >( value ) );
+    rit.Set( static_cast< int >( value ) );
+    }
+}
+
+template< class TImage >
+unsigned long CountDifferences(const TImage *image, const ReferenceImageType *reference)
+{
+  unsigned long differences = 0;
+  itk::ImageRegionConstIterator< TImage >             it( image, image->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ReferenceImageType > rit( reference, reference->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it, ++rit )
+    {
+    if ( static_cast< int >( it.Get() ) != rit.Get() )
+      {
+      differences++;
+      }
+    }
+  return differences;
+}
+
+template< class TImage >
+int CheckPixelType(const char *name)
+{
+  typedef itk::FlatStructuringElement< 3 >                                           KernelType;
+  typedef itk::RankImageFilter< TImage, TImage, KernelType >                         RankType;
+  typedef itk::RankImageFilter< ReferenceImageType, ReferenceImageType, KernelType > ReferenceRankType;
+  typedef itk::MedianImageFilter< TImage, TImage >                                   MedianType;
+  typedef itk::MedianImageFilter< ReferenceImageType, ReferenceImageType >           ReferenceMedianType;
+
+  typename TImage::Pointer    image = TImage::New();
+  ReferenceImageType::Pointer reference = ReferenceImageType::New();
+  CreateImages< TImage >( image, reference );
+
+  int status = EXIT_SUCCESS;
+
+  typename RankType::Pointer rank = RankType::New();
+  ReferenceRankType::Pointer referenceRank = ReferenceRankType::New();
+  if ( !rank->GetUseVectorBasedAlgorithm() || referenceRank->GetUseVectorBasedAlgorithm() )
+    {
+    std::cerr << name << ": the rank filters don't use the expected histograms" << std::endl;
+    status = EXIT_FAILURE;
+    }
+  rank->SetInput( image );
+  referenceRank->SetInput( reference );
+
+  const float ranks[] = { 0.0, 0.3, 0.5, 0.9, 1.0 };
+  for ( unsigned int r = 1; r <= 4; r += 3 )
+    {
+    typename RankType::RadiusType radius;
+    radius[0] = r;
+    radius[1] = r / 2 + 1;
+    radius[2] = r - 1;
+    rank->SetRadius( radius );
+    referenceRank->SetRadius( radius );
+    for ( unsigned int k = 0; k < sizeof( ranks ) / sizeof( ranks[0] ); k++ )
+      {
+      rank->SetRank( ranks[k] );
+      referenceRank->SetRank( ranks[k] );
+      rank->Update();
+      referenceRank->Update();
+      const unsigned long differences = CountDifferences< TImage >( rank->GetOutput(), referenceRank->GetOutput() );
+      if ( differences != 0 )
+        {
+        std::cerr << name << ", rank " << ranks[k] << ", radius " << radius << ": "
+                  << differences << " pixels differ from the map based histogram" << std::endl;
+        status = EXIT_FAILURE;
+        }
+      }
+    }
+
+  // the smaller neighborhood is sorted, the others use the histogram
+  typename MedianType::Pointer median = MedianType::New();
+  typename ReferenceMedianType::Pointer referenceMedian = ReferenceMedianType::New();
+  median->SetInput( image );
+  referenceMedian->SetInput( reference );
+  for ( unsigned int r = 1; r <= 7; r += 3 )
+    {
+    typename MedianType::InputSizeType radius;
+    radius[0] = r;
+    radius[1] = r / 2 + 1;
+    radius[2] = r / 3 + 1;
+    median->SetRadius( radius );
+    referenceMedian->SetRadius( radius );
+    median->Update();
+    referenceMedian->Update();
+    const unsigned long differences = CountDifferences< TImage >( median->GetOutput(), referenceMedian->GetOutput() );
+    if ( differences != 0 )
+      {
+      std::cerr << name << ", median radius " << radius << ": "
+                << differences << " pixels differ from the sorted neighborhood" << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+
+  return status;
+}
+}
+
+int itkRankImageFilterTest2(int, char* [] )
+{
+  int status = EXIT_SUCCESS;
+  if ( CheckPixelType< itk::Image< short, 3 > >("short") != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( CheckPixelType< itk::Image< unsigned short, 3 > >("unsigned short") != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  return status;
+}
@@ -177,6 +177,8 @@
 #include "itkRelabelLabelMapFilter.h"
 #include "itkRobustAutomaticThresholdCalculator.txx"
 #include "itkRobustAutomaticThresholdImageFilter.txx"
+#include "itkRunLengthBinaryMorphologyImageFilter.txx"
+#include "itkRunLengthBinaryMorphologyLabelMapFilter.txx"
 #include "itkScalarChanAndVeseDenseLevelSetImageFilter.txx"
 #include "itkScalarChanAndVeseLevelSetFunction.txx"
 #include "itkScalarChanAndVeseLevelSetFunctionData.h"
@@ -208,6 +210,7 @@
 #include "itkStatisticsRelabelLabelMapFilter.txx"
 #include "itkStatisticsUniqueLabelMapFilter.txx"
 #include "itkStochasticFractalDimensionImageFilter.txx"
+#include "itkStreamingMorphologicalWatershedImageFilter.txx"
 #include "itkSubtractConstantFromImageFilter.h"
 #include "itkSummerColormapFunction.txx"
 #include "itkTransformToDeformationFieldSource.txx"
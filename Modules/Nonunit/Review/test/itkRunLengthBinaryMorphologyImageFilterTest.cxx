@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkBinaryDilateImageFilter.h"
+#include "itkBinaryErodeImageFilter.h"
+#include "itkRunLengthBinaryMorphologyImageFilter.h"
+
+int itkRunLengthBinaryMorphologyImageFilterTest(int argc, char * argv[])
+{
+  if( argc < 5 )
+    {
+    std::cerr << "Missing Parameters " << std::endl;
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " InputImage OutputImage Radius Operation" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int dim = 2;
+
+  typedef unsigned char                         PixelType;
+  typedef itk::Image< PixelType, dim >          ImageType;
+  typedef itk::FlatStructuringElement< dim >    KernelType;
+
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  KernelType::RadiusType radius;
+  radius.Fill( atoi( argv[3] ) );
+  KernelType kernel = KernelType::Ball( radius );
+
+  const int operation = atoi( argv[4] );
+
+  typedef itk::RunLengthBinaryMorphologyImageFilter< ImageType, KernelType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( reader->GetOutput() );
+  filter->SetKernel( kernel );
+  filter->SetOperation( operation );
+  filter->SetForegroundValue( 255 );
+  filter->SetBackgroundValue( 0 );
+
+  if ( filter->GetOperation() != operation )
+    {
+    std::cerr << "Set/Get Operation problem." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::SimpleFilterWatcher watcher(filter, "filter");
+
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( filter->GetOutput() );
+  writer->SetFileName( argv[2] );
+
+  // compute the same result with the pixel based filters
+  typedef itk::BinaryDilateImageFilter< ImageType, ImageType, KernelType > DilateType;
+  typedef itk::BinaryErodeImageFilter< ImageType, ImageType, KernelType >  ErodeType;
+  DilateType::Pointer dilate = DilateType::New();
+  dilate->SetKernel( kernel );
+  dilate->SetForegroundValue( 255 );
+  dilate->SetBackgroundValue( 0 );
+  ErodeType::Pointer erode = ErodeType::New();
+  erode->SetKernel( kernel );
+  erode->SetForegroundValue( 255 );
+  erode->SetBackgroundValue( 0 );
+
+  ImageType * reference;
+  switch( operation )
+    {
+    case FilterType::DILATE:
+      dilate->SetInput( reader->GetOutput() );
+      reference = dilate->GetOutput();
+      break;
+    case FilterType::ERODE:
+      erode->SetInput( reader->GetOutput() );
+      reference = erode->GetOutput();
+      break;
+    case FilterType::OPENING:
+      erode->SetInput( reader->GetOutput() );
+      dilate->SetInput( erode->GetOutput() );
+      reference = dilate->GetOutput();
+      break;
+    case FilterType::CLOSING:
+      dilate->SetInput( reader->GetOutput() );
+      erode->SetInput( dilate->GetOutput() );
+      reference = erode->GetOutput();
+      break;
+    default:
+      std::cerr << "Unknown operation: " << operation << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  try
+    {
+    writer->Update();
+    reference->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageRegionConstIterator< ImageType > IteratorType;
+  IteratorType rit( reference, reference->GetLargestPossibleRegion() );
+  IteratorType fit( filter->GetOutput(), reference->GetLargestPossibleRegion() );
+  unsigned long differences = 0;
+  for ( rit.GoToBegin(), fit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++fit )
+    {
+    if ( rit.Get() != fit.Get() )
+      {
+      differences++;
+      }
+    }
+
+  if ( differences != 0 )
+    {
+    std::cerr << differences << " pixels differ from the pixel based filters." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,320 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageRegionIterator.h"
+#include "itkBinaryDilateImageFilter.h"
+#include "itkBinaryErodeImageFilter.h"
+#include "itkBinaryMorphologicalOpeningImageFilter.h"
+#include "itkBinaryMorphologicalClosingImageFilter.h"
+#include "itkRunLengthBinaryMorphologyImageFilter.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+// Compare the dilation, erosion, opening and closing of random binary
+// images computed on the lines of a label map with the pixel based
+// filters, with a symmetric kernel and an asymmetric kernel without its
+// center. Like BinaryErodeImageFilter, the erosion must consider the
+// pixels outside the image as foreground, and be the complement of the
+// dilation of the complement with the same kernel.
+
+namespace
+{
+const unsigned char Foreground = 255;
+const unsigned char Background = 0;
+
+template< class TImage >
+typename TImage::Pointer CreateRandomImage(const typename TImage::SizeType & size, double density)
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(2011);
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions(size);
+  image->Allocate();
+  itk::ImageRegionIterator< TImage > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    it.Set( generator->GetUniformVariate(0.0, 1.0) < density ? Foreground : Background );
+    }
+  return image;
+}
+
+template< class TImage >
+typename TImage::Pointer Complement(const TImage *image)
+{
+  typename TImage::Pointer complement = TImage::New();
+  complement->SetRegions( image->GetLargestPossibleRegion() );
+  complement->Allocate();
+  itk::ImageRegionConstIterator< TImage > it( image, image->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< TImage >      cit( complement, image->GetLargestPossibleRegion() );
+  for ( ; !it.IsAtEnd(); ++it, ++cit )
+    {
+    cit.Set( it.Get() == Foreground ? Background : Foreground );
+    }
+  return complement;
+}
+
+// the operation computed on the lines of a single label object
+template< class TImage, class TKernel >
+typename TImage::Pointer RunLength(const TImage *image, const TKernel & kernel, int operation)
+{
+  typedef itk::RunLengthBinaryMorphologyImageFilter< TImage, TKernel > ImageFilterType;
+
+  typename ImageFilterType::LabelizerType::Pointer labelizer = ImageFilterType::LabelizerType::New();
+  labelizer->SetInput( image );
+  labelizer->SetInputForegroundValue( Foreground );
+
+  typename ImageFilterType::AggregatorType::Pointer aggregator = ImageFilterType::AggregatorType::New();
+  aggregator->SetInput( labelizer->GetOutput() );
+
+  typename ImageFilterType::MorphologyType::Pointer morphology = ImageFilterType::MorphologyType::New();
+  morphology->SetInput( aggregator->GetOutput() );
+  morphology->SetKernel( kernel );
+  morphology->SetOperation( operation );
+
+  typename ImageFilterType::BinarizerType::Pointer binarizer = ImageFilterType::BinarizerType::New();
+  binarizer->SetInput( morphology->GetOutput() );
+  binarizer->SetForegroundValue( Foreground );
+  binarizer->SetBackgroundValue( Background );
+  binarizer->Update();
+
+  typename TImage::Pointer output = binarizer->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+// the same operation computed with the pixel based filters
+template< class TImage, class TKernel >
+typename TImage::Pointer Reference(const TImage *image, const TKernel & kernel, int operation,
+                                   bool boundaryToForeground = true)
+{
+  typedef itk::RunLengthBinaryMorphologyImageFilter< TImage, TKernel >            ImageFilterType;
+  typedef itk::BinaryDilateImageFilter< TImage, TImage, TKernel >                 DilateType;
+  typedef itk::BinaryErodeImageFilter< TImage, TImage, TKernel >                  ErodeType;
+  typedef itk::BinaryMorphologicalOpeningImageFilter< TImage, TImage, TKernel >   OpeningType;
+  typedef itk::BinaryMorphologicalClosingImageFilter< TImage, TImage, TKernel >   ClosingType;
+
+  typename TImage::Pointer output;
+  switch ( operation )
+    {
+    case ImageFilterType::DILATE:
+      {
+      typename DilateType::Pointer dilate = DilateType::New();
+      dilate->SetInput( image );
+      dilate->SetKernel( kernel );
+      dilate->SetForegroundValue( Foreground );
+      dilate->SetBackgroundValue( Background );
+      dilate->Update();
+      output = dilate->GetOutput();
+      break;
+      }
+    case ImageFilterType::ERODE:
+      {
+      typename ErodeType::Pointer erode = ErodeType::New();
+      erode->SetInput( image );
+      erode->SetKernel( kernel );
+      erode->SetForegroundValue( Foreground );
+      erode->SetBackgroundValue( Background );
+      erode->SetBoundaryToForeground( boundaryToForeground );
+      erode->Update();
+      output = erode->GetOutput();
+      break;
+      }
+    case ImageFilterType::OPENING:
+      {
+      typename OpeningType::Pointer opening = OpeningType::New();
+      opening->SetInput( image );
+      opening->SetKernel( kernel );
+      opening->SetForegroundValue( Foreground );
+      opening->SetBackgroundValue( Background );
+      opening->Update();
+      output = opening->GetOutput();
+      break;
+      }
+    default:
+      {
+      // the closing of the image, not of the image padded with background
+      typename ClosingType::Pointer closing = ClosingType::New();
+      closing->SetInput( image );
+      closing->SetKernel( kernel );
+      closing->SetForegroundValue( Foreground );
+      closing->SafeBorderOff();
+      closing->Update();
+      output = closing->GetOutput();
+      break;
+      }
+    }
+  output->DisconnectPipeline();
+  return output;
+}
+
+template< class TImage >
+itk::SizeValueType CountDifferences(const TImage *image1, const TImage *image2)
+{
+  itk::SizeValueType                      differences = 0;
+  itk::ImageRegionConstIterator< TImage > it1( image1, image1->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< TImage > it2( image2, image1->GetLargestPossibleRegion() );
+  for ( ; !it1.IsAtEnd(); ++it1, ++it2 )
+    {
+    if ( it1.Get() != it2.Get() )
+      {
+      differences++;
+      }
+    }
+  return differences;
+}
+
+// The dilation and the closing are computed on a sparse image, the
+// erosion and the opening on a dense one, so that they do not fill or
+// empty the image.
+template< class TImage, class TKernel >
+int CheckKernel(const TImage *sparseImage, const TImage *denseImage, const TKernel & kernel,
+                const char *name)
+{
+  typedef itk::RunLengthBinaryMorphologyImageFilter< TImage, TKernel > ImageFilterType;
+
+  const char *operationNames[4] = { "dilate", "erode", "opening", "closing" };
+  int         status = EXIT_SUCCESS;
+
+  for ( int operation = ImageFilterType::DILATE; operation <= ImageFilterType::CLOSING; operation++ )
+    {
+    const TImage *image = ( operation == ImageFilterType::ERODE || operation == ImageFilterType::OPENING )
+                          ? denseImage : sparseImage;
+    typename TImage::Pointer runLength = RunLength(image, kernel, operation);
+    typename TImage::Pointer reference = Reference(image, kernel, operation);
+    const itk::SizeValueType differences = CountDifferences( runLength.GetPointer(), reference.GetPointer() );
+    std::cout << name << " " << operationNames[operation] << ": "
+              << differences << " pixels differ from the pixel based filters" << std::endl;
+    if ( differences != 0 )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+
+  // erode( X, B ) = not dilate( not X, B ) on the whole image, since the
+  // pixels outside are foreground for the erosion of X and background for
+  // the dilation of its complement
+  typename TImage::Pointer eroded = RunLength(denseImage, kernel, ImageFilterType::ERODE);
+  typename TImage::Pointer complement = Complement(denseImage);
+  typename TImage::Pointer dilated = RunLength(complement.GetPointer(), kernel, ImageFilterType::DILATE);
+  const itk::SizeValueType dualityDifferences =
+    CountDifferences( eroded.GetPointer(), Complement( dilated.GetPointer() ).GetPointer() );
+  if ( dualityDifferences != 0 )
+    {
+    std::cerr << name << ": the erosion differs from the dual of the dilation in "
+              << dualityDifferences << " pixels" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // the border rule matters on this image
+  typename TImage::Pointer erodedWithBackgroundBorder =
+    Reference(denseImage, kernel, ImageFilterType::ERODE, false);
+  if ( CountDifferences( eroded.GetPointer(), erodedWithBackgroundBorder.GetPointer() ) == 0 )
+    {
+    std::cerr << name << ": the boundary of the image does not change the erosion" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // an image full of foreground is not eroded
+  typename TImage::Pointer full =
+    CreateRandomImage< TImage >( denseImage->GetLargestPossibleRegion().GetSize(), 2.0 );
+  typename TImage::Pointer erodedFull = RunLength(full.GetPointer(), kernel, ImageFilterType::ERODE);
+  if ( CountDifferences( full.GetPointer(), erodedFull.GetPointer() ) != 0 )
+    {
+    std::cerr << name << ": the erosion of a full image is not full" << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
+
+template< unsigned int VDimension >
+int CheckDimension(const typename itk::Image< unsigned char, VDimension >::SizeType & size)
+{
+  typedef itk::Image< unsigned char, VDimension > ImageType;
+  typedef itk::FlatStructuringElement< VDimension > KernelType;
+
+  typename ImageType::Pointer sparseImage = CreateRandomImage< ImageType >(size, 0.1);
+  typename ImageType::Pointer denseImage = CreateRandomImage< ImageType >(size, 0.9);
+
+  typename KernelType::RadiusType radius;
+  radius.Fill(2);
+  KernelType ball = KernelType::Ball(radius);
+
+  // a kernel without the center and without symmetry, made of several
+  // runs on some rows
+  radius.Fill(1);
+  radius[0] = 3;
+  KernelType asymmetric;
+  asymmetric.SetRadius(radius);
+  for ( unsigned int i = 0; i < asymmetric.Size(); i++ )
+    {
+    asymmetric[i] = ( i * 7 ) % 5 < 3;
+    }
+  asymmetric[asymmetric.Size() / 2] = false;
+
+  int status = EXIT_SUCCESS;
+  if ( CheckKernel(sparseImage.GetPointer(), denseImage.GetPointer(), ball, "ball") != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( CheckKernel(sparseImage.GetPointer(), denseImage.GetPointer(), asymmetric, "asymmetric")
+       != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  return status;
+}
+}
+
+int itkRunLengthBinaryMorphologyLabelMapFilterTest(int, char *[])
+{
+  int status = EXIT_SUCCESS;
+
+  try
+    {
+    itk::Size< 2 > size2;
+    size2[0] = 67;
+    size2[1] = 45;
+    std::cout << "2D" << std::endl;
+    if ( CheckDimension< 2 >(size2) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+
+    itk::Size< 3 > size3;
+    size3[0] = 29;
+    size3[1] = 17;
+    size3[2] = 11;
+    std::cout << "3D" << std::endl;
+    if ( CheckDimension< 3 >(size3) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return status;
+}
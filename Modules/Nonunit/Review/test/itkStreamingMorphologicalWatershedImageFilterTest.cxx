@@ -0,0 +1,265 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkMorphologicalWatershedImageFilter.h"
+#include "itkStreamingMorphologicalWatershedImageFilter.h"
+#include <map>
+
+typedef itk::Image< unsigned long, 2 > LabelImageType;
+
+// count the basins of the tiled result and check that each of them is
+// one basin of the reference and the other way around, with the same
+// watershed lines
+static bool CompareBasins(const LabelImageType *reference, const LabelImageType *tiled,
+                          unsigned long & numberOfReferenceBasins, unsigned long & numberOfTiledBasins)
+{
+  typedef std::map< unsigned long, unsigned long > LabelMapType;
+  LabelMapType referenceToTiled;
+  LabelMapType tiledToReference;
+  bool         same = true;
+
+  typedef itk::ImageRegionConstIterator< LabelImageType > IteratorType;
+  IteratorType rit( reference, reference->GetLargestPossibleRegion() );
+  IteratorType tit( tiled, reference->GetLargestPossibleRegion() );
+  for ( rit.GoToBegin(), tit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++tit )
+    {
+    if ( ( rit.Get() == 0 ) != ( tit.Get() == 0 ) )
+      {
+      same = false;
+      }
+    if ( rit.Get() != 0 )
+      {
+      std::pair< LabelMapType::iterator, bool > inserted =
+        referenceToTiled.insert( std::make_pair( rit.Get(), tit.Get() ) );
+      same = same && inserted.first->second == tit.Get();
+      }
+    if ( tit.Get() != 0 )
+      {
+      std::pair< LabelMapType::iterator, bool > inserted =
+        tiledToReference.insert( std::make_pair( tit.Get(), rit.Get() ) );
+      same = same && inserted.first->second == rit.Get();
+      }
+    }
+  numberOfReferenceBasins = referenceToTiled.size();
+  numberOfTiledBasins = tiledToReference.size();
+  return same;
+}
+
+int itkStreamingMorphologicalWatershedImageFilterTest(int argc, char * argv[])
+{
+  if( argc < 5 )
+    {
+    std::cerr << "Missing Parameters " << std::endl;
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " InputImage OutputImage TileSize Overlap" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const int dim = 2;
+
+  typedef unsigned char                    PixelType;
+  typedef itk::Image< PixelType, dim >     ImageType;
+
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  typedef itk::MorphologicalWatershedImageFilter<
+    ImageType, LabelImageType > ReferenceType;
+  ReferenceType::Pointer reference = ReferenceType::New();
+  reference->SetInput( reader->GetOutput() );
+
+  typedef itk::StreamingMorphologicalWatershedImageFilter<
+    ImageType, LabelImageType > FilterType;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( reader->GetOutput() );
+
+  // test default values
+  if ( filter->GetMarkWatershedLine( ) != true )
+    {
+    std::cerr << "Wrong default MarkWatershedLine." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( filter->GetFullyConnected( ) != false )
+    {
+    std::cerr << "Wrong default FullyConnected." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // with a single tile, the result must be the one of the non streaming
+  // filter
+  FilterType::SizeType tileSize;
+  tileSize.Fill( 100000 );
+  filter->SetTileSize( tileSize );
+
+  try
+    {
+    reference->Update();
+    filter->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if ( filter->GetNumberOfTiles() != 1 )
+    {
+    std::cerr << "Wrong number of tiles: " << filter->GetNumberOfTiles() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::ImageRegionConstIterator< LabelImageType > IteratorType;
+  IteratorType rit( reference->GetOutput(),
+                    reference->GetOutput()->GetLargestPossibleRegion() );
+  IteratorType fit( filter->GetOutput(),
+                    reference->GetOutput()->GetLargestPossibleRegion() );
+  for ( rit.GoToBegin(), fit.GoToBegin(); !rit.IsAtEnd(); ++rit, ++fit )
+    {
+    if ( rit.Get() != fit.Get() )
+      {
+      std::cerr << "Single tile result differs from MorphologicalWatershedImageFilter at "
+                << rit.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // now split the image in tiles and stream the output
+  tileSize.Fill( atoi( argv[3] ) );
+  filter->SetTileSize( tileSize );
+  FilterType::SizeType overlap;
+  overlap.Fill( atoi( argv[4] ) );
+  filter->SetOverlap( overlap );
+
+  itk::SimpleFilterWatcher watcher(filter, "filter");
+
+  typedef itk::ImageFileWriter< LabelImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( filter->GetOutput() );
+  writer->SetFileName( argv[2] );
+  writer->SetNumberOfStreamDivisions( 4 );
+
+  try
+    {
+    writer->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the streamed output must be the same as the one produced at once
+  typedef itk::ImageFileReader< LabelImageType > LabelReaderType;
+  LabelReaderType::Pointer streamed = LabelReaderType::New();
+  streamed->SetFileName( argv[2] );
+
+  try
+    {
+    streamed->Update();
+    filter->GetOutput()->SetRequestedRegionToLargestPossibleRegion();
+    filter->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "Number of tiles: " << filter->GetNumberOfTiles() << std::endl;
+
+  IteratorType sit( streamed->GetOutput(),
+                    streamed->GetOutput()->GetLargestPossibleRegion() );
+  IteratorType ait( filter->GetOutput(),
+                    streamed->GetOutput()->GetLargestPossibleRegion() );
+  for ( sit.GoToBegin(), ait.GoToBegin(); !sit.IsAtEnd(); ++sit, ++ait )
+    {
+    if ( sit.Get() != ait.Get() )
+      {
+      std::cerr << "Streamed result differs from the non streamed one at "
+                << sit.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // the tiles give the basins of the non streaming filter when the
+  // overlap is large enough to resolve their flooding
+  unsigned long numberOfReferenceBasins;
+  unsigned long numberOfTiledBasins;
+  if ( !CompareBasins( reference->GetOutput(), filter->GetOutput(),
+                       numberOfReferenceBasins, numberOfTiledBasins ) )
+    {
+    std::cerr << "The " << numberOfTiledBasins << " tiled basins are not the "
+              << numberOfReferenceBasins << " basins of MorphologicalWatershedImageFilter" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // larger basins, with an overlap resolving them and a smaller one
+  reference->SetLevel( 20 );
+  filter->SetLevel( 20 );
+  overlap.Fill( 32 );
+  filter->SetOverlap( overlap );
+  try
+    {
+    reference->Update();
+    filter->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( !CompareBasins( reference->GetOutput(), filter->GetOutput(),
+                       numberOfReferenceBasins, numberOfTiledBasins ) )
+    {
+    std::cerr << "With level 20, the " << numberOfTiledBasins << " tiled basins are not the "
+              << numberOfReferenceBasins << " basins of MorphologicalWatershedImageFilter" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // a basin segmented differently by two tiles is not merged with
+  // several basins across the seam
+  overlap.Fill( 8 );
+  filter->SetOverlap( overlap );
+  try
+    {
+    filter->Update();
+    }
+  catch ( itk::ExceptionObject & excp )
+    {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+  CompareBasins( reference->GetOutput(), filter->GetOutput(),
+                 numberOfReferenceBasins, numberOfTiledBasins );
+  std::cout << "With level 20 and a small overlap: " << numberOfTiledBasins
+            << " tiled basins, " << numberOfReferenceBasins << " reference basins" << std::endl;
+  if ( numberOfTiledBasins < numberOfReferenceBasins )
+    {
+    std::cerr << "Basins are merged across the seams" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
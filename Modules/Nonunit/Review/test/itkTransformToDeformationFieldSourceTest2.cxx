@@ -0,0 +1,196 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+/** This test generates a deformation field from a BSpline deformable
+ * transform and checks that every vector of the field equals the
+ * displacement found by calling TransformPoint() on the physical point of
+ * its pixel. The field is computed one scanline at a time.
+ */
+
+#include "itkImage.h"
+#include "itkVector.h"
+#include "itkAffineTransform.h"
+#include "itkBSplineDeformableTransform.h"
+#include "itkTransformToDeformationFieldSource.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+int itkTransformToDeformationFieldSourceTest2( int, char * [] )
+{
+  /** Typedefs. */
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double CoordRepresentationType;
+
+  typedef itk::Vector< float, Dimension >          VectorPixelType;
+  typedef itk::Image< VectorPixelType, Dimension > DeformationFieldImageType;
+
+  typedef itk::BSplineDeformableTransform<
+    CoordRepresentationType, Dimension, SplineOrder > TransformType;
+  typedef itk::AffineTransform<
+    CoordRepresentationType, Dimension >              BulkTransformType;
+
+  typedef itk::TransformToDeformationFieldSource<
+    DeformationFieldImageType,
+    CoordRepresentationType >                         DeformationFieldGeneratorType;
+
+  typedef DeformationFieldImageType::SizeType      SizeType;
+  typedef DeformationFieldImageType::SpacingType   SpacingType;
+  typedef DeformationFieldImageType::PointType     PointType;
+  typedef DeformationFieldImageType::IndexType     IndexType;
+  typedef DeformationFieldImageType::DirectionType DirectionType;
+
+  /** Create the transform: a grid covering part of the field only, so that
+   * some of the pixels are outside the valid region of the grid. */
+  TransformType::RegionType::SizeType gridSize;
+  gridSize.Fill(8);
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize(gridSize);
+  TransformType::SpacingType gridSpacing;
+  gridSpacing[0] = 4.0;
+  gridSpacing[1] = 5.0;
+  gridSpacing[2] = 6.0;
+  TransformType::OriginType gridOrigin;
+  gridOrigin[0] = -6.0;
+  gridOrigin[1] = -8.0;
+  gridOrigin[2] = -10.0;
+  TransformType::DirectionType gridDirection;
+  gridDirection.SetIdentity();
+  gridDirection[0][0] = 0.8;
+  gridDirection[0][1] = -0.6;
+  gridDirection[1][0] = 0.6;
+  gridDirection[1][1] = 0.8;
+
+  TransformType::Pointer bsplineTransform = TransformType::New();
+  bsplineTransform->SetGridSpacing(gridSpacing);
+  bsplineTransform->SetGridOrigin(gridOrigin);
+  bsplineTransform->SetGridRegion(gridRegion);
+  bsplineTransform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters( bsplineTransform->GetNumberOfParameters() );
+  for ( unsigned int p = 0; p < parameters.Size(); p++ )
+    {
+    parameters[p] = 0.15 * ( p % 11 ) - 0.7;
+    }
+  bsplineTransform->SetParametersByValue(parameters);
+
+  BulkTransformType::Pointer bulkTransform = BulkTransformType::New();
+  BulkTransformType::OutputVectorType translation;
+  translation[0] = 1.5;
+  translation[1] = -0.5;
+  translation[2] = 2.0;
+  bulkTransform->Translate(translation);
+  bulkTransform->Rotate(0, 2, 0.1);
+  bsplineTransform->SetBulkTransform(bulkTransform);
+
+  /** Set the output information. */
+  SizeType size;
+  size[0] = 31;
+  size[1] = 17;
+  size[2] = 13;
+  IndexType index;
+  index[0] = 2;
+  index[1] = -1;
+  index[2] = 0;
+  SpacingType spacing;
+  spacing[0] = 0.9;
+  spacing[1] = 1.7;
+  spacing[2] = 2.5;
+  PointType origin;
+  origin[0] = -12.0;
+  origin[1] = 5.0;
+  origin[2] = 4.0;
+  DirectionType direction;
+  direction.SetIdentity();
+  direction[1][1] = 0.0;
+  direction[1][2] = 1.0;
+  direction[2][1] = -1.0;
+  direction[2][2] = 0.0;
+
+  DeformationFieldGeneratorType::Pointer defGenerator =
+    DeformationFieldGeneratorType::New();
+  defGenerator->SetOutputSize(size);
+  defGenerator->SetOutputIndex(index);
+  defGenerator->SetOutputSpacing(spacing);
+  defGenerator->SetOutputOrigin(origin);
+  defGenerator->SetOutputDirection(direction);
+  defGenerator->SetTransform(bsplineTransform);
+  defGenerator->SetNumberOfThreads(3);
+  try
+    {
+    defGenerator->Update();
+    }
+  catch ( itk::ExceptionObject & e )
+    {
+    std::cerr << "Exception detected while generating deformation field";
+    std::cerr << " : "  << e.GetDescription();
+    return EXIT_FAILURE;
+    }
+
+  /** Compare with the points transformed one at a time. */
+  DeformationFieldImageType::ConstPointer field = defGenerator->GetOutput();
+  typedef itk::ImageRegionConstIteratorWithIndex< DeformationFieldImageType > IteratorType;
+  IteratorType it( field, field->GetLargestPossibleRegion() );
+
+  const double tolerance = 1e-4;
+  unsigned int numberOfDeformedPixels = 0;
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    PointType point;
+    field->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    const TransformType::OutputPointType transformedPoint =
+      bsplineTransform->TransformPoint(point);
+    const TransformType::OutputPointType bulkPoint =
+      bulkTransform->TransformPoint(point);
+
+    const VectorPixelType deformation = it.Get();
+    bool deformed = false;
+    for ( unsigned int i = 0; i < Dimension; i++ )
+      {
+      const double expected = transformedPoint[i] - point[i];
+      if ( vnl_math_abs( deformation[i] - expected ) > tolerance )
+        {
+        std::cerr << "Deformation at " << it.GetIndex() << " is "
+                  << deformation << " instead of "
+                  << transformedPoint - point << std::endl;
+        return EXIT_FAILURE;
+        }
+      if ( vnl_math_abs( transformedPoint[i] - bulkPoint[i] ) > tolerance )
+        {
+        deformed = true;
+        }
+      }
+    if ( deformed )
+      {
+      ++numberOfDeformedPixels;
+      }
+    }
+
+  /** Both pixels inside and outside the grid must have been checked. */
+  const unsigned int numberOfPixels = field->GetLargestPossibleRegion().GetNumberOfPixels();
+  if ( numberOfDeformedPixels == 0 || numberOfDeformedPixels == numberOfPixels )
+    {
+    std::cerr << numberOfDeformedPixels << " of the " << numberOfPixels
+              << " pixels are deformed by the grid" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << numberOfDeformedPixels << " of the " << numberOfPixels
+            << " pixels are deformed by the grid" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -51,6 +51,11 @@ namespace itk
  * Cerebral Angiograms,", IEEE Transactions on Medical Imaging,
  * 22(11):1417-1426.
  *
+ * The gradient images are computed by multithreaded filters. The range of
+ * the moved image gradients and the similarity measure are then computed
+ * in threads, each thread taking a piece of the fixed image region, and
+ * the sums of the threads are added in the order of the threads.
+ *
  * \ingroup RegistrationMetrics
  * \ingroup ITK-RegistrationCommon
  */
@@ -163,6 +168,28 @@ protected:
   typedef NeighborhoodOperatorImageFilter<
     MovedGradientImageType, MovedGradientImageType > MovedSobelFilter;
 private:
+  /** The data shared by the threads iterating over the gradient images,
+   * and the results of each thread. The measure is computed when a
+   * subtraction factor is provided, the range of the moved image
+   * gradients otherwise. */
+  struct ThreadStruct {
+    const Self *Metric;
+    const double *SubtractionFactor;
+    unsigned int NumberOfSplits;
+    std::vector< MeasureType > Measure;
+    std::vector< MovedGradientPixelType > MinMovedGradient;
+    std::vector< MovedGradientPixelType > MaxMovedGradient;
+    std::vector< bool > HasPixels;
+  };
+
+  /** Run the threads over the fixed image region. */
+  void ProcessFixedImageRegion(ThreadStruct & str) const;
+
+  /** Compute the range or the measure of a piece of the fixed image region. */
+  void ThreadedProcessFixedImageRegion(ThreadStruct & str, unsigned int threadId) const;
+
+  static ITK_THREAD_RETURN_TYPE ProcessFixedImageRegionThreaderCallback(void *arg);
+
   GradientDifferenceImageToImageMetric(const Self &); //purposely not
                                                       // implemented
   void operator=(const Self &);                       //purposely not
@@ -20,6 +20,7 @@
 
 #include "itkGradientDifferenceImageToImageMetric.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionSplitter.h"
 #include "itkNumericTraits.h"
 
 #include <iostream>
@@ -158,39 +159,173 @@ void
 GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::ComputeMovedGradientRange(void) const
 {
-  unsigned int           iDimension;
-  MovedGradientPixelType gradient;
+  ThreadStruct str;
+  str.SubtractionFactor = NULL;
+  this->ProcessFixedImageRegion(str);
 
-  for ( iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+  // the range of the first piece, then of the others in order
+  bool hasPixels = false;
+  for ( unsigned int t = 0; t < str.NumberOfSplits; t++ )
     {
-    typedef itk::ImageRegionConstIteratorWithIndex<
-      MovedGradientImageType > IteratorType;
+    if ( !str.HasPixels[t] )
+      {
+      continue;
+      }
+    for ( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+      {
+      const MovedGradientPixelType & minGradient = str.MinMovedGradient[t * FixedImageDimension + iDimension];
+      const MovedGradientPixelType & maxGradient = str.MaxMovedGradient[t * FixedImageDimension + iDimension];
+      if ( !hasPixels || minGradient < m_MinMovedGradient[iDimension] )
+        {
+        m_MinMovedGradient[iDimension] = minGradient;
+        }
+      if ( !hasPixels || maxGradient > m_MaxMovedGradient[iDimension] )
+        {
+        m_MaxMovedGradient[iDimension] = maxGradient;
+        }
+      }
+    hasPixels = true;
+    }
+}
 
-    IteratorType iterate( m_MovedSobelFilters[iDimension]->GetOutput(),
-                          this->GetFixedImageRegion() );
+/**
+ * Run the threads over the pieces of the fixed image region
+ */
+template< class TFixedImage, class TMovingImage >
+void
+GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
+::ProcessFixedImageRegion(ThreadStruct & str) const
+{
+  typedef ImageRegionSplitter< itkGetStaticConstMacro(FixedImageDimension) > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+
+  str.Metric = this;
+  str.NumberOfSplits = splitter->GetNumberOfSplits( this->GetFixedImageRegion(), this->m_NumberOfThreads );
+  str.Measure.assign(str.NumberOfSplits, NumericTraits< MeasureType >::Zero);
+  str.MinMovedGradient.assign(str.NumberOfSplits * FixedImageDimension,
+                              NumericTraits< MovedGradientPixelType >::Zero);
+  str.MaxMovedGradient.assign(str.NumberOfSplits * FixedImageDimension,
+                              NumericTraits< MovedGradientPixelType >::Zero);
+  str.HasPixels.assign(str.NumberOfSplits, false);
+
+  this->m_Threader->SetNumberOfThreads(str.NumberOfSplits);
+  this->m_Threader->SetSingleMethod(ProcessFixedImageRegionThreaderCallback, &str);
+  this->m_Threader->SingleMethodExecute();
+  this->m_Threader->SetNumberOfThreads(this->m_NumberOfThreads);
+}
 
-    gradient = iterate.Get();
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
+::ProcessFixedImageRegionThreaderCallback(void *arg)
+{
+  const MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
 
-    m_MinMovedGradient[iDimension] = gradient;
-    m_MaxMovedGradient[iDimension] = gradient;
+  if ( static_cast< unsigned int >( info->ThreadID ) < str->NumberOfSplits )
+    {
+    str->Metric->ThreadedProcessFixedImageRegion(*str, info->ThreadID);
+    }
 
-    while ( !iterate.IsAtEnd() )
-      {
-      gradient = iterate.Get();
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ * Compute the range of the moved image gradients or the measure over a
+ * piece of the fixed image region
+ */
+template< class TFixedImage, class TMovingImage >
+void
+GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedProcessFixedImageRegion(ThreadStruct & str, unsigned int threadId) const
+{
+  typedef ImageRegionSplitter< itkGetStaticConstMacro(FixedImageDimension) > SplitterType;
+  typename SplitterType::Pointer splitter = SplitterType::New();
+  const typename Superclass::FixedImageRegionType region =
+    splitter->GetSplit(threadId, str.NumberOfSplits, this->GetFixedImageRegion() );
+
+  MeasureType measure = NumericTraits< MeasureType >::Zero;
+
+  for ( unsigned int iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
+    {
+    typedef  itk::ImageRegionConstIteratorWithIndex< MovedGradientImageType >
+    MovedIteratorType;
+
+    MovedIteratorType movedIterator(m_MovedSobelFilters[iDimension]->GetOutput(), region);
 
-      if ( gradient > m_MaxMovedGradient[iDimension] )
+    if ( !str.SubtractionFactor )
+      {
+      // the range of the moved image gradients
+      if ( movedIterator.IsAtEnd() )
         {
-        m_MaxMovedGradient[iDimension] = gradient;
+        continue;
         }
 
-      if ( gradient < m_MinMovedGradient[iDimension] )
+      MovedGradientPixelType gradient = movedIterator.Get();
+      MovedGradientPixelType minGradient = gradient;
+      MovedGradientPixelType maxGradient = gradient;
+
+      while ( !movedIterator.IsAtEnd() )
         {
-        m_MinMovedGradient[iDimension] = gradient;
+        gradient = movedIterator.Get();
+
+        if ( gradient > maxGradient )
+          {
+          maxGradient = gradient;
+          }
+
+        if ( gradient < minGradient )
+          {
+          minGradient = gradient;
+          }
+
+        ++movedIterator;
         }
 
-      ++iterate;
+      str.MinMovedGradient[threadId * FixedImageDimension + iDimension] = minGradient;
+      str.MaxMovedGradient[threadId * FixedImageDimension + iDimension] = maxGradient;
+      str.HasPixels[threadId] = true;
+      continue;
+      }
+
+    if ( m_Variance[iDimension] == NumericTraits< MovedGradientPixelType >::Zero )
+      {
+      continue;
+      }
+
+    // Iterate over the fixed and moving gradient images
+    // calculating the similarity measure
+
+    MovedGradientPixelType movedGradient;
+    FixedGradientPixelType fixedGradient;
+
+    MovedGradientPixelType diff;
+
+    typedef  itk::ImageRegionConstIteratorWithIndex< FixedGradientImageType >
+    FixedIteratorType;
+
+    FixedIteratorType fixedIterator(m_FixedSobelFilters[iDimension]->GetOutput(), region);
+
+    while ( !fixedIterator.IsAtEnd() )
+      {
+      // Get the moving and fixed image gradients
+
+      movedGradient = movedIterator.Get();
+      fixedGradient  = fixedIterator.Get();
+
+      // And calculate the gradient difference
+
+      diff = fixedGradient - str.SubtractionFactor[iDimension] * movedGradient;
+
+      measure += m_Variance[iDimension] / ( m_Variance[iDimension] + diff * diff );
+
+      ++fixedIterator;
+      ++movedIterator;
       }
     }
+
+  str.Measure[threadId] = measure;
 }
 
 /**
@@ -286,51 +421,21 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 
   for ( iDimension = 0; iDimension < FixedImageDimension; iDimension++ )
     {
-    if ( m_Variance[iDimension] == NumericTraits< MovedGradientPixelType >::Zero )
-      {
-      continue;
-      }
-    // Iterate over the fixed and moving gradient images
-    // calculating the similarity measure
-
-    MovedGradientPixelType movedGradient;
-    FixedGradientPixelType fixedGradient;
-
-    MovedGradientPixelType diff;
-
-    typedef  itk::ImageRegionConstIteratorWithIndex< FixedGradientImageType >
-    FixedIteratorType;
-
-    FixedIteratorType fixedIterator( m_FixedSobelFilters[iDimension]->GetOutput(),
-                                     this->GetFixedImageRegion() );
-
-    typedef  itk::ImageRegionConstIteratorWithIndex< MovedGradientImageType >
-    MovedIteratorType;
-
-    MovedIteratorType movedIterator( m_MovedSobelFilters[iDimension]->GetOutput(),
-                                     this->GetFixedImageRegion() );
-
     m_FixedSobelFilters[iDimension]->UpdateLargestPossibleRegion();
     m_MovedSobelFilters[iDimension]->UpdateLargestPossibleRegion();
+    }
 
-    this->m_NumberOfPixelsCounted = 0;
-
-    while ( !fixedIterator.IsAtEnd() )
-      {
-      // Get the moving and fixed image gradients
-
-      movedGradient = movedIterator.Get();
-      fixedGradient  = fixedIterator.Get();
-
-      // And calculate the gradient difference
-
-      diff = fixedGradient - subtractionFactor[iDimension] * movedGradient;
+  this->m_NumberOfPixelsCounted = 0;
 
-      measure += m_Variance[iDimension] / ( m_Variance[iDimension] + diff * diff );
+  // Iterate over the fixed and moving gradient images in threads,
+  // and add the measures of the threads in order
+  ThreadStruct str;
+  str.SubtractionFactor = subtractionFactor;
+  this->ProcessFixedImageRegion(str);
 
-      ++fixedIterator;
-      ++movedIterator;
-      }
+  for ( unsigned int t = 0; t < str.NumberOfSplits; t++ )
+    {
+    measure += str.Measure[t];
     }
 
   return measure;
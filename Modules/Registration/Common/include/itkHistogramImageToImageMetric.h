@@ -32,6 +32,11 @@ namespace itk
   The metric computes the similarity measure between pixels in the
   moving image and pixels in the fixed image using a histogram.
 
+  The joint histogram is filled by several threads, each one counting its
+  samples of the fixed image in its own array of frequencies; the arrays are
+  then added in the order of the threads. By default all the pixels of the
+  fixed image region are used.
+
   \ingroup RegistrationMetrics
  * \ingroup ITK-RegistrationCommon
  */
@@ -68,6 +73,7 @@ public:
   FixedImageConstPointerType;
   typedef typename Superclass::MovingImageConstPointer
   MovingImageConstPointerType;
+  typedef typename Superclass::MovingImagePointType       MovingImagePointType;
 
   /** Typedefs for histogram. This should have been defined as
       Histogram<RealType,2> but a bug in VC++7 produced an internal compiler
@@ -77,8 +83,11 @@ public:
   typedef typename HistogramType::MeasurementVectorType MeasurementVectorType;
   typedef typename HistogramType::SizeType              HistogramSizeType;
   typedef typename HistogramType::Pointer               HistogramPointer;
+  typedef typename HistogramType::IndexType             HistogramIndexType;
+  typedef typename HistogramType::AbsoluteFrequencyType HistogramFrequencyType;
 
-  /** Initializes the metric. */
+  /** Initializes the metric, and allocates the frequencies counted by each
+   * thread. */
   void Initialize()
   throw ( ExceptionObject );
 
@@ -156,7 +165,7 @@ protected:
   /** Constructor is protected to ensure that \c New() function is used to
       create instances. */
   HistogramImageToImageMetric();
-  virtual ~HistogramImageToImageMetric() {}
+  virtual ~HistogramImageToImageMetric();
 
   /** The histogram size. */
   HistogramSizeType m_HistogramSize;
@@ -218,6 +227,25 @@ private:
   /** Pointer to the joint histogram. This is updated during every call to
    * GetValue() */
   HistogramPointer m_Histogram;
+
+  /** The frequencies counted by one thread, and the buffers used to find
+   * the bin of a sample. */
+  struct ThreaderHistogramType {
+    std::vector< HistogramFrequencyType > frequencies;
+    MeasurementVectorType                 measurement;
+    HistogramIndexType                    index;
+  };
+
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          SizeValueType fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
+  ThreaderHistogramType *m_ThreaderHistograms;
+
+  /** The histogram being computed by ComputeHistogram(), used by the
+   * threads to find the bins of the samples. */
+  mutable const HistogramType *m_ComputedHistogram;
 };
 } // end namespace itk
 
@@ -22,7 +22,7 @@
 #include "itkHistogramImageToImageMetric.h"
 #include "itkNumericTraits.h"
 #include "itkImageRegionConstIterator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -42,6 +42,26 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
   m_Histogram->SetMeasurementVectorSize(2);
   m_LowerBoundSetByUser = false;
   m_UpperBoundSetByUser = false;
+
+  m_ThreaderHistograms = NULL;
+  m_ComputedHistogram = NULL;
+  this->m_WithinThreadPreProcess = false;
+  this->m_WithinThreadPostProcess = false;
+
+  //  For backward compatibility, the default behavior is to use all the pixels
+  //  in the fixed image.
+  this->SetUseAllPixels(true);
+}
+
+template< class TFixedImage, class TMovingImage >
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::~HistogramImageToImageMetric()
+{
+  if ( m_ThreaderHistograms != NULL )
+    {
+    delete[] m_ThreaderHistograms;
+    }
+  m_ThreaderHistograms = NULL;
 }
 
 template< class TFixedImage, class TMovingImage >
@@ -146,6 +166,26 @@ throw ( ExceptionObject )
         maxMoving + ( maxMoving - minMoving ) * m_UpperBoundIncreaseFactor;
       }
     }
+
+  this->Superclass::MultiThreadingInitialize();
+
+  if ( m_ThreaderHistograms != NULL )
+    {
+    delete[] m_ThreaderHistograms;
+    }
+  m_ThreaderHistograms = new ThreaderHistogramType[this->m_NumberOfThreads];
+
+  SizeValueType numberOfBins = 1;
+  for ( unsigned int i = 0; i < m_HistogramSize.Size(); i++ )
+    {
+    numberOfBins *= m_HistogramSize[i];
+    }
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    m_ThreaderHistograms[threadID].frequencies.resize(numberOfBins);
+    m_ThreaderHistograms[threadID].measurement.SetSize(2);
+    m_ThreaderHistograms[threadID].index.SetSize(2);
+    }
 }
 
 template< class TFixedImage, class TMovingImage >
@@ -244,77 +284,82 @@ HistogramImageToImageMetric< TFixedImage, TMovingImage >
 }
 
 template< class TFixedImage, class TMovingImage >
-void
+inline bool
 HistogramImageToImageMetric< TFixedImage, TMovingImage >
-::ComputeHistogram(TransformParametersType const & parameters,
-                   HistogramType & histogram) const
+::GetValueThreadProcessSample(unsigned int threadID,
+                              SizeValueType fixedImageSample,
+                              const MovingImagePointType & itkNotUsed(mappedPoint),
+                              double movingImageValue) const
 {
-  FixedImageConstPointerType fixedImage = this->m_FixedImage;
+  const double fixedValue = this->m_FixedImageSamples[fixedImageSample].value;
 
-  if ( !fixedImage )
+  if ( m_UsePaddingValue && !( fixedValue > m_PaddingValue ) )
     {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
+    return false;
     }
 
-  typedef itk::ImageRegionConstIteratorWithIndex< FixedImageType >
-  FixedIteratorType;
+  ThreaderHistogramType & threaderHistogram = m_ThreaderHistograms[threadID];
 
-  typename FixedImageType::IndexType index;
-  typename FixedImageType::RegionType fixedRegion;
+  // same bin as Histogram::IncreaseFrequencyOfMeasurement()
+  threaderHistogram.measurement[0] = fixedValue;
+  threaderHistogram.measurement[1] = movingImageValue;
+  m_ComputedHistogram->GetIndex(threaderHistogram.measurement, threaderHistogram.index);
+  const SizeValueType bin = m_ComputedHistogram->GetInstanceIdentifier(threaderHistogram.index);
+  if ( bin < threaderHistogram.frequencies.size() )
+    {
+    ++threaderHistogram.frequencies[bin];
+    }
 
-  fixedRegion = this->GetFixedImageRegion();
-  FixedIteratorType ti(fixedImage, fixedRegion);
+  return true;
+}
 
-  this->m_NumberOfPixelsCounted = 0;
-  this->SetTransformParameters(parameters);
+template< class TFixedImage, class TMovingImage >
+void
+HistogramImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeHistogram(TransformParametersType const & parameters,
+                   HistogramType & histogram) const
+{
+  if ( !this->m_FixedImage )
+    {
+    itkExceptionMacro(<< "Fixed image has not been assigned");
+    }
+
+  if ( m_ThreaderHistograms == NULL )
+    {
+    itkExceptionMacro(<< "The metric has not been initialized, maybe you forgot to call Initialize()");
+    }
 
   histogram.Initialize(m_HistogramSize, m_LowerBound, m_UpperBound);
 
-  ti.GoToBegin();
-  while ( !ti.IsAtEnd() )
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
     {
-    index = ti.GetIndex();
+    std::fill(m_ThreaderHistograms[threadID].frequencies.begin(),
+              m_ThreaderHistograms[threadID].frequencies.end(),
+              NumericTraits< HistogramFrequencyType >::Zero);
+    }
 
-    if ( fixedRegion.IsInside(index)
-         && ( !m_UsePaddingValue
-              || ( m_UsePaddingValue && ti.Get() > m_PaddingValue ) ) )
-      {
-      InputPointType inputPoint;
-      fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+  this->SetTransformParameters(parameters);
 
-      if ( this->m_FixedImageMask
-           && !this->m_FixedImageMask->IsInside(inputPoint) )
-        {
-        ++ti;
-        continue;
-        }
+  m_ComputedHistogram = &histogram;
 
-      OutputPointType transformedPoint =
-        this->m_Transform->TransformPoint(inputPoint);
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueMultiThreadedInitiate();
 
-      if ( this->m_MovingImageMask
-           && !this->m_MovingImageMask->IsInside(transformedPoint) )
-        {
-        ++ti;
-        continue;
-        }
+  m_ComputedHistogram = NULL;
 
-      if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-        {
-        const RealType movingValue =
-          this->m_Interpolator->Evaluate(transformedPoint);
-        const RealType fixedValue = ti.Get();
-        this->m_NumberOfPixelsCounted++;
-
-        typename HistogramType::MeasurementVectorType sample;
-        sample.SetSize(2);
-        sample[0] = fixedValue;
-        sample[1] = movingValue;
-        histogram.IncreaseFrequencyOfMeasurement(sample, 1);
-        }
+  // the frequencies of the threads are always added in the same order
+  const SizeValueType numberOfBins = m_ThreaderHistograms[0].frequencies.size();
+  for ( SizeValueType bin = 0; bin < numberOfBins; bin++ )
+    {
+    HistogramFrequencyType frequency = m_ThreaderHistograms[0].frequencies[bin];
+    for ( unsigned int threadID = 1; threadID < this->m_NumberOfThreads; threadID++ )
+      {
+      frequency += m_ThreaderHistograms[threadID].frequencies[bin];
+      }
+    if ( frequency > 0 )
+      {
+      histogram.SetFrequency(bin, frequency);
       }
-
-    ++ti;
     }
 
   itkDebugMacro("NumberOfPixelsCounted = " << this->m_NumberOfPixelsCounted);
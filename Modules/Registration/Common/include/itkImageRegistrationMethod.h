@@ -216,6 +216,13 @@ protected:
 
   /** Provides derived classes with the ability to set this private var */
   itkSetMacro(LastTransformParameters, ParametersType);
+
+  /** Draw new fixed image samples in the metric after each iteration of
+   * the optimizer, when the metric uses a stochastic sampling, and
+   * increase their number when the gradient changes direction.
+   * \sa ImageToImageMetric::SetUseStochasticSampling() */
+  void ResampleFixedImage();
+
 private:
   ImageRegistrationMethod(const Self &); //purposely not implemented
   void operator=(const Self &);          //purposely not implemented
@@ -234,6 +241,10 @@ private:
 
   bool                 m_FixedImageRegionDefined;
   FixedImageRegionType m_FixedImageRegion;
+
+  /** Gradient of the metric at the previous iteration, with a stochastic
+   * sampling. */
+  typename MetricType::DerivativeType m_PreviousGradient;
 };
 } // end namespace itk
 
@@ -19,6 +19,9 @@
 #define __itkImageRegistrationMethod_txx
 
 #include "itkImageRegistrationMethod.h"
+#include "itkRegularStepGradientDescentBaseOptimizer.h"
+#include "itkGradientDescentOptimizer.h"
+#include "itkCommand.h"
 
 namespace itk
 {
@@ -267,6 +270,22 @@ void
 ImageRegistrationMethod< TFixedImage, TMovingImage >
 ::StartOptimization(void)
 {
+  // With a stochastic sampling, the metric draws new fixed image samples
+  // after each iteration. This is only done with the gradient descent
+  // optimizers, which evaluate the metric once per iteration.
+  const bool resample = m_Metric->GetUseStochasticSampling()
+                        && ( dynamic_cast< RegularStepGradientDescentBaseOptimizer * >( m_Optimizer.GetPointer() )
+                             || dynamic_cast< GradientDescentOptimizer * >( m_Optimizer.GetPointer() ) );
+  unsigned long resampleTag = 0;
+  if ( resample )
+    {
+    typedef SimpleMemberCommand< Self > CommandType;
+    typename CommandType::Pointer command = CommandType::New();
+    command->SetCallbackFunction(this, &Self::ResampleFixedImage);
+    resampleTag = m_Optimizer->AddObserver(IterationEvent(), command);
+    m_PreviousGradient = typename MetricType::DerivativeType();
+    }
+
   try
     {
     // do the optimization
@@ -274,6 +293,11 @@ ImageRegistrationMethod< TFixedImage, TMovingImage >
     }
   catch ( ExceptionObject & err )
     {
+    if ( resample )
+      {
+      m_Optimizer->RemoveObserver(resampleTag);
+      }
+
     // An error has occurred in the optimization.
     // Update the parameters
     m_LastTransformParameters = m_Optimizer->GetCurrentPosition();
@@ -282,11 +306,61 @@ ImageRegistrationMethod< TFixedImage, TMovingImage >
     throw err;
     }
 
+  if ( resample )
+    {
+    m_Optimizer->RemoveObserver(resampleTag);
+    }
+
   // get the results
   m_LastTransformParameters = m_Optimizer->GetCurrentPosition();
   m_Transform->SetParameters(m_LastTransformParameters);
 }
 
+/**
+ * Draw new fixed image samples after an iteration of the optimizer
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+ImageRegistrationMethod< TFixedImage, TMovingImage >
+::ResampleFixedImage()
+{
+  const typename MetricType::DerivativeType *gradient = NULL;
+
+  RegularStepGradientDescentBaseOptimizer *regularStepOptimizer =
+    dynamic_cast< RegularStepGradientDescentBaseOptimizer * >( m_Optimizer.GetPointer() );
+  GradientDescentOptimizer *gradientDescentOptimizer =
+    dynamic_cast< GradientDescentOptimizer * >( m_Optimizer.GetPointer() );
+  if ( regularStepOptimizer )
+    {
+    gradient = &regularStepOptimizer->GetGradient();
+    }
+  else if ( gradientDescentOptimizer )
+    {
+    gradient = &gradientDescentOptimizer->GetGradient();
+    }
+
+  // When the gradient changes direction, the optimizer oscillates around
+  // the optimum: more samples give a more accurate gradient from now on.
+  if ( gradient )
+    {
+    if ( m_PreviousGradient.Size() == gradient->Size() )
+      {
+      double scalarProduct = 0.0;
+      for ( unsigned int i = 0; i < gradient->Size(); i++ )
+        {
+        scalarProduct += m_PreviousGradient[i] * ( *gradient )[i];
+        }
+      if ( scalarProduct < 0.0 )
+        {
+        m_Metric->IncreaseNumberOfFixedImageSamples();
+        }
+      }
+    m_PreviousGradient = *gradient;
+    }
+
+  m_Metric->ResampleFixedImage();
+}
+
 /**
  * PrintSelf
  */
@@ -98,6 +98,8 @@ public:
   typedef typename TransformType::OutputPointType OutputPointType;
   typedef typename TransformType::ParametersType  TransformParametersType;
   typedef typename TransformType::JacobianType    TransformJacobianType;
+  typedef typename TransformType::NonZeroJacobianIndicesType
+  NonZeroJacobianIndicesType;
 
   /** Index and Point typedef support. */
   typedef typename FixedImageType::IndexType           FixedImageIndexType;
@@ -121,6 +123,9 @@ public:
 
   typedef typename InterpolatorType::Pointer InterpolatorPointer;
 
+  /** Type of the continuous index of a point mapped in the moving image */
+  typedef typename InterpolatorType::ContinuousIndexType MovingImageContinuousIndexType;
+
   /**  Type for the mask of the fixed image. Only pixels that are "inside"
        this mask will be considered for the computation of the metric */
   typedef SpatialObject< itkGetStaticConstMacro(FixedImageDimension) > FixedImageMaskType;
@@ -203,6 +208,13 @@ public:
 
   itkGetConstReferenceMacro(NumberOfThreads, unsigned int);
 
+  /** Return true if the metric draws new samples from the random number
+   * generator shared by the process at each evaluation, instead of once
+   * in Initialize(). Such metrics cannot be evaluated concurrently with
+   * each other without losing the reproducibility of their samples. */
+  virtual bool GetDrawsSamplesAtEachEvaluation() const
+  { return false; }
+
   /** Set/Get gradient computation. */
   itkSetMacro(ComputeGradient, bool);
   itkGetConstReferenceMacro(ComputeGradient, bool);
@@ -318,6 +330,66 @@ public:
   itkGetConstReferenceMacro(UseCachingOfBSplineWeights, bool);
   itkBooleanMacro(UseCachingOfBSplineWeights);
 
+  /** This boolean flag enables/disables the reuse of the fixed image
+   * samples from one call of Initialize() to the next. When it is
+   * enabled, the samples are only drawn again if the fixed image, the
+   * fixed image mask or the parameters of the metric have been modified
+   * since they were drawn: a registration restarted with the same images,
+   * for instance from other initial parameters, then uses the same
+   * samples without scanning the fixed image again. The reuse is
+   * disabled by default, so a new set of random samples is drawn at each
+   * initialization. */
+  itkSetMacro(ReuseFixedImageSamples, bool);
+  itkGetConstReferenceMacro(ReuseFixedImageSamples, bool);
+  itkBooleanMacro(ReuseFixedImageSamples);
+
+  /** Select whether the fixed image samples are drawn in strata: the
+   * fixed image region is divided, in the order of its pixels, in as many
+   * runs of consecutive pixels as samples, and each sample is drawn at
+   * random in its own run. The samples then cover the region more evenly
+   * than purely random samples, like a regular grid with jitter. This
+   * only applies to the random sampling of the fixed image region, and
+   * is disabled by default. */
+  itkSetMacro(UseStratifiedSampling, bool);
+  itkGetConstReferenceMacro(UseStratifiedSampling, bool);
+  itkBooleanMacro(UseStratifiedSampling);
+
+  /** Select whether a new set of fixed image samples is drawn at each
+   * iteration of the optimizer, instead of once in Initialize(). Each
+   * iteration then estimates the metric and its derivative from another
+   * random subset of the fixed image, so a small number of samples is
+   * enough for a stochastic gradient descent. The ImageRegistrationMethod
+   * draws the new samples when its optimizer is a
+   * RegularStepGradientDescentOptimizer or a GradientDescentOptimizer.
+   * Disabled by default.
+   * \sa ResampleFixedImage() */
+  itkSetMacro(UseStochasticSampling, bool);
+  itkGetConstReferenceMacro(UseStochasticSampling, bool);
+  itkBooleanMacro(UseStochasticSampling);
+
+  /** Maximum number of fixed image samples reached by
+   * IncreaseNumberOfFixedImageSamples(). The default, zero, keeps the
+   * number of samples constant. */
+  itkSetMacro(MaximumNumberOfFixedImageSamples, SizeValueType);
+  itkGetConstReferenceMacro(MaximumNumberOfFixedImageSamples, SizeValueType);
+
+  /** Factor by which IncreaseNumberOfFixedImageSamples() multiplies the
+   * number of fixed image samples. The default is 2. */
+  itkSetMacro(FixedImageSamplesGrowthFactor, double);
+  itkGetConstReferenceMacro(FixedImageSamplesGrowthFactor, double);
+
+  /** Draw a new set of fixed image samples, once the metric has been
+   * initialized, and update the values cached for each sample. */
+  virtual void ResampleFixedImage(void);
+
+  /** Multiply the number of fixed image samples by the growth factor, up
+   * to the maximum number of samples. A stochastic optimization calls it
+   * when it starts to oscillate, so that the estimates of the metric
+   * derivative become more accurate as the optimizer converges. The new
+   * number of samples is used by the next call to ResampleFixedImage().
+   * Return true if the number of samples has changed. */
+  bool IncreaseNumberOfFixedImageSamples(void);
+
   typedef MultiThreader MultiThreaderType;
   /** Get the Threader. */
   itkGetConstObjectMacro(Threader, MultiThreaderType);
@@ -373,6 +445,20 @@ public:
   virtual void SampleFullFixedImageRegion(FixedImageSampleContainer &
                                           samples) const;
 
+  /** Uniformly select a sample set from the fixed image domain, with one
+   * sample in each run of consecutive pixels.
+   * \sa SetUseStratifiedSampling() */
+  virtual void SampleFixedImageRegionInStrata(FixedImageSampleContainer &
+                                              samples) const;
+
+  /** Draw the fixed image samples according to the sampling parameters
+   * of the metric. */
+  void SampleFixedImageDomain(void);
+
+  /** Allocate the cache of the B-spline weights of the fixed image samples
+   * and fill it. \sa SetUseCachingOfBSplineWeights() */
+  void CacheBSplineTransformValues(void);
+
   /** Container to store a set of points and fixed image values. */
   FixedImageSampleContainer m_FixedImageSamples;
 
@@ -394,11 +480,32 @@ public:
    * will do the work for thread=0. */
   TransformPointer *m_ThreaderTransform;
 
+  /** Buffers for the sparse Jacobian of the transform, one per thread, so
+   * it can be computed without allocation for each sample.
+   * \sa Transform::GetSparseJacobian() */
+  mutable TransformJacobianType *     m_ThreaderJacobian;
+  mutable NonZeroJacobianIndicesType *m_ThreaderNonZeroJacobianIndices;
+
   InterpolatorPointer m_Interpolator;
 
   bool                 m_ComputeGradient;
   GradientImagePointer m_GradientImage;
 
+  /** Time at which the gradient image was computed. The gradient image
+   * is only computed again when the moving image or the metric have been
+   * modified since. */
+  TimeStamp m_GradientImageTime;
+
+  /** Time at which the fixed image samples were drawn.
+   * \sa SetReuseFixedImageSamples() */
+  bool      m_ReuseFixedImageSamples;
+  TimeStamp m_FixedImageSamplesTime;
+
+  bool          m_UseStratifiedSampling;
+  bool          m_UseStochasticSampling;
+  SizeValueType m_MaximumNumberOfFixedImageSamples;
+  double        m_FixedImageSamplesGrowthFactor;
+
   FixedImageMaskConstPointer  m_FixedImageMask;
   MovingImageMaskConstPointer m_MovingImageMask;
 
@@ -495,6 +602,23 @@ public:
                                              ImageDerivativesType & gradient,
                                              unsigned int threadID) const;
 
+  /** Check that a point mapped by the transform is inside the moving image
+   * mask and buffer, and evaluate the moving image there. */
+  void EvaluateMovingImageValue(const MovingImagePointType & mappedPoint,
+                                bool & sampleOk,
+                                double & movingImageValue,
+                                unsigned int threadID) const;
+
+  void EvaluateMovingImageValueAndDerivatives(const MovingImagePointType & mappedPoint,
+                                              bool & sampleOk,
+                                              double & movingImageValue,
+                                              ImageDerivativesType & gradient,
+                                              unsigned int threadID) const;
+
+  /** Number of samples mapped at once by TransformPoints() in the threads,
+   * when the transform is not a BSplineDeformableTransform. */
+  itkStaticConstMacro(SampleBlockSize, unsigned int, 64);
+
   /** Boolean to indicate if the interpolator BSpline. */
   bool m_InterpolatorIsBSpline;
   /** Pointer to BSplineInterpolator. */
@@ -534,6 +658,12 @@ public:
 
   static ITK_THREAD_RETURN_TYPE  GetValueMultiThreadedPostProcess(void *arg);
 
+  /** Get the contiguous range of the fixed image samples processed by a
+   * thread. */
+  void GetThreadSampleRange(unsigned int threadID,
+                            SizeValueType & firstSample,
+                            SizeValueType & numberOfSamples) const;
+
   virtual inline void       GetValueThread(unsigned int threadID) const;
 
   virtual inline void       GetValueThreadPreProcess(
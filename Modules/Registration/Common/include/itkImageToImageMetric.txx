@@ -20,6 +20,9 @@
 
 #include "itkImageToImageMetric.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -58,6 +61,8 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   m_Transform         = NULL; // has to be provided by the user.
   m_ThreaderTransform = NULL; // constructed at initialization.
+  m_ThreaderJacobian = NULL;
+  m_ThreaderNonZeroJacobianIndices = NULL;
 
   m_Interpolator  = 0; // has to be provided by the user.
 
@@ -76,6 +81,12 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   this->m_UseCachingOfBSplineWeights = true;
 
+  m_ReuseFixedImageSamples = false;
+  m_UseStratifiedSampling = false;
+  m_UseStochasticSampling = false;
+  m_MaximumNumberOfFixedImageSamples = 0;
+  m_FixedImageSamplesGrowthFactor = 2.0;
+
   /* if 100% backward compatible, we should include this...but...
   typename BSplineTransformType::Pointer transformer =
            BSplineTransformType::New();
@@ -103,6 +114,18 @@ ImageToImageMetric< TFixedImage, TMovingImage >
     }
   m_ThreaderTransform = NULL;
 
+  if ( m_ThreaderJacobian != NULL )
+    {
+    delete[] m_ThreaderJacobian;
+    }
+  m_ThreaderJacobian = NULL;
+
+  if ( m_ThreaderNonZeroJacobianIndices != NULL )
+    {
+    delete[] m_ThreaderNonZeroJacobianIndices;
+    }
+  m_ThreaderNonZeroJacobianIndices = NULL;
+
   if ( this->m_ThreaderBSplineTransformWeights != NULL )
     {
     delete[] this->m_ThreaderBSplineTransformWeights;
@@ -174,6 +197,7 @@ ImageToImageMetric< TFixedImage, TMovingImage >
     {
     m_FixedImageIndexes[i] = indexes[i];
     }
+  this->Modified();
 }
 
 template< class TFixedImage, class TMovingImage >
@@ -239,6 +263,7 @@ ImageToImageMetric< TFixedImage, TMovingImage >
       {
       this->SetNumberOfFixedImageSamples( this->m_FixedImageRegion.GetNumberOfPixels() );
       }
+    this->Modified();
     }
 }
 
@@ -339,9 +364,18 @@ throw ( ExceptionObject )
 
   m_Interpolator->SetInputImage(m_MovingImage);
 
+  // The gradient image only depends on the moving image and on the
+  // parameters of the metric: keep the one computed by a previous
+  // initialization if none of them has been modified since.
   if ( m_ComputeGradient )
     {
-    ComputeGradient();
+    if ( m_GradientImage.IsNull()
+         || m_MovingImage->GetMTime() > m_GradientImageTime.GetMTime()
+         || this->GetMTime() > m_GradientImageTime.GetMTime() )
+      {
+      ComputeGradient();
+      m_GradientImageTime.Modified();
+      }
     }
 
   // If there are any observers on the metric, call them to give the
@@ -387,33 +421,39 @@ throw ( ExceptionObject )
     this->m_ThreaderTransform[ithread] = transformCopy;
     }
 
-  m_FixedImageSamples.resize(m_NumberOfFixedImageSamples);
-  if ( m_UseSequentialSampling )
+  // Allocate the buffers of the sparse Jacobian used in every thread
+  if ( m_ThreaderJacobian != NULL )
     {
-    //
-    // Take all the pixels within the fixed image region)
-    // to create the sample points list.
-    //
-    SampleFullFixedImageRegion(m_FixedImageSamples);
+    delete[] m_ThreaderJacobian;
     }
-  else
+  m_ThreaderJacobian = new TransformJacobianType[m_NumberOfThreads];
+  if ( m_ThreaderNonZeroJacobianIndices != NULL )
     {
-    if ( m_UseFixedImageIndexes )
-      {
-      //
-      //  Use the list of indexes passed to the SetFixedImageIndexes
-      //  member function .
-      //
-      SampleFixedImageIndexes(m_FixedImageSamples);
-      }
-    else
-      {
-      //
-      // Uniformly sample the fixed image (within the fixed image region)
-      // to create the sample points list.
-      //
-      SampleFixedImageRegion(m_FixedImageSamples);
-      }
+    delete[] m_ThreaderNonZeroJacobianIndices;
+    }
+  m_ThreaderNonZeroJacobianIndices = new NonZeroJacobianIndicesType[m_NumberOfThreads];
+  const unsigned int numberOfNonZeroJacobianIndices =
+    this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  for ( unsigned int ithread = 0; ithread < m_NumberOfThreads; ++ithread )
+    {
+    m_ThreaderJacobian[ithread].SetSize(MovingImageDimension, numberOfNonZeroJacobianIndices);
+    m_ThreaderNonZeroJacobianIndices[ithread].SetSize(numberOfNonZeroJacobianIndices);
+    }
+
+  // Keep the samples drawn by the previous initialization if the fixed
+  // image, its mask and the parameters of the metric are unchanged.
+  bool sampleFixedImage = true;
+  if ( m_ReuseFixedImageSamples && !m_FixedImageSamples.empty() )
+    {
+    const unsigned long samplesTime = m_FixedImageSamplesTime.GetMTime();
+    sampleFixedImage = this->GetMTime() > samplesTime
+                       || m_FixedImage->GetMTime() > samplesTime
+                       || ( m_FixedImageMask.IsNotNull() && m_FixedImageMask->GetMTime() > samplesTime );
+    }
+
+  if ( sampleFixedImage )
+    {
+    this->SampleFixedImageDomain();
     }
 
   //
@@ -500,14 +540,7 @@ throw ( ExceptionObject )
 
     if ( this->m_UseCachingOfBSplineWeights )
       {
-      m_BSplineTransformWeightsArray.SetSize(
-        m_NumberOfFixedImageSamples, m_NumBSplineWeights);
-      m_BSplineTransformIndicesArray.SetSize(
-        m_NumberOfFixedImageSamples, m_NumBSplineWeights);
-      m_BSplinePreTransformPointsArray.resize(m_NumberOfFixedImageSamples);
-      m_WithinBSplineSupportRegionArray.resize(m_NumberOfFixedImageSamples);
-
-      this->PreComputeTransformValues();
+      this->CacheBSplineTransformValues();
       }
     else
       {
@@ -531,6 +564,120 @@ throw ( ExceptionObject )
     }
 }
 
+/**
+ * Draw the fixed image samples
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::SampleFixedImageDomain(void)
+{
+  m_FixedImageSamples.resize(m_NumberOfFixedImageSamples);
+  if ( m_UseSequentialSampling )
+    {
+    //
+    // Take all the pixels within the fixed image region)
+    // to create the sample points list.
+    //
+    SampleFullFixedImageRegion(m_FixedImageSamples);
+    }
+  else
+    {
+    if ( m_UseFixedImageIndexes )
+      {
+      //
+      //  Use the list of indexes passed to the SetFixedImageIndexes
+      //  member function .
+      //
+      SampleFixedImageIndexes(m_FixedImageSamples);
+      }
+    else
+      {
+      //
+      // Uniformly sample the fixed image (within the fixed image region)
+      // to create the sample points list.
+      //
+      if ( m_UseStratifiedSampling )
+        {
+        SampleFixedImageRegionInStrata(m_FixedImageSamples);
+        }
+      else
+        {
+        SampleFixedImageRegion(m_FixedImageSamples);
+        }
+      }
+    }
+  m_FixedImageSamplesTime.Modified();
+}
+
+/**
+ * Draw a new set of fixed image samples
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::ResampleFixedImage(void)
+{
+  if ( m_FixedImageSamples.empty() )
+    {
+    itkExceptionMacro(<< "The metric must be initialized before drawing new fixed image samples");
+    }
+
+  this->SampleFixedImageDomain();
+
+  if ( m_TransformIsBSpline && m_UseCachingOfBSplineWeights )
+    {
+    this->CacheBSplineTransformValues();
+
+    // PreComputeTransformValues() resets the parameters of the transform
+    if ( m_Parameters.Size() == m_NumberOfParameters )
+      {
+      m_Transform->SetParameters(m_Parameters);
+      }
+    }
+}
+
+/**
+ * Increase the number of fixed image samples
+ */
+template< class TFixedImage, class TMovingImage >
+bool
+ImageToImageMetric< TFixedImage, TMovingImage >
+::IncreaseNumberOfFixedImageSamples(void)
+{
+  if ( m_UseAllPixels
+       || m_NumberOfFixedImageSamples >= m_MaximumNumberOfFixedImageSamples )
+    {
+    return false;
+    }
+
+  SizeValueType numberOfSamples = static_cast< SizeValueType >(
+    m_NumberOfFixedImageSamples * m_FixedImageSamplesGrowthFactor );
+  numberOfSamples = std::max(numberOfSamples, m_NumberOfFixedImageSamples + 1);
+  numberOfSamples = std::min(numberOfSamples, m_MaximumNumberOfFixedImageSamples);
+
+  this->SetNumberOfFixedImageSamples(numberOfSamples);
+  return true;
+}
+
+/**
+ * Allocate and fill the cache of the B-spline weights of the samples
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::CacheBSplineTransformValues(void)
+{
+  m_BSplineTransformWeightsArray.SetSize(
+    m_NumberOfFixedImageSamples, m_NumBSplineWeights);
+  m_BSplineTransformIndicesArray.SetSize(
+    m_NumberOfFixedImageSamples, m_NumBSplineWeights);
+  m_BSplinePreTransformPointsArray.resize(m_NumberOfFixedImageSamples);
+  m_WithinBSplineSupportRegionArray.resize(m_NumberOfFixedImageSamples);
+
+  this->PreComputeTransformValues();
+}
+
 /**
  * Use the indexes that have been passed to the metric
  */
@@ -681,6 +828,95 @@ ImageToImageMetric< TFixedImage, TMovingImage >
     }
 }
 
+/**
+ * Uniformly sample the fixed image domain, with one sample in each run of
+ * consecutive pixels
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::SampleFixedImageRegionInStrata(FixedImageSampleContainer & samples) const
+{
+  if ( samples.size() != m_NumberOfFixedImageSamples )
+    {
+    throw ExceptionObject(__FILE__, __LINE__,
+                          "Sample size does not match desired number of samples");
+    }
+
+  typedef Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  typename GeneratorType::Pointer generator = GeneratorType::GetInstance();
+
+  const FixedImageRegionType & region = this->GetFixedImageRegion();
+  const double                 numberOfPixels =
+    static_cast< double >( region.GetNumberOfPixels() );
+
+  // With a mask or a threshold, a few pixels of each run are tried before
+  // giving up the run
+  const bool         checkSamples = m_FixedImageMask.IsNotNull()
+                                    || m_UseFixedImageSamplesIntensityThreshold;
+  const unsigned int numberOfTrials = checkSamples ? 10 : 1;
+
+  FixedImageIndexType index;
+  InputPointType      inputPoint;
+  SizeValueType       samplesFound = 0;
+
+  for ( SizeValueType stratum = 0; stratum < m_NumberOfFixedImageSamples; stratum++ )
+    {
+    const SizeValueType first = static_cast< SizeValueType >(
+      stratum * numberOfPixels / m_NumberOfFixedImageSamples );
+    const SizeValueType next = static_cast< SizeValueType >(
+      ( stratum + 1 ) * numberOfPixels / m_NumberOfFixedImageSamples );
+    const SizeValueType length = ( next > first ) ? next - first : 1;
+
+    for ( unsigned int trial = 0; trial < numberOfTrials; trial++ )
+      {
+      // Index of a random pixel of the run
+      SizeValueType offset = first + generator->GetIntegerVariate(
+        static_cast< typename GeneratorType::IntegerType >( length - 1 ) );
+      for ( unsigned int d = 0; d < FixedImageDimension; d++ )
+        {
+        index[d] = region.GetIndex()[d] + static_cast< FixedImageIndexValueType >( offset % region.GetSize()[d] );
+        offset /= region.GetSize()[d];
+        }
+      m_FixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+
+      if ( m_FixedImageMask.IsNotNull() )
+        {
+        double val;
+        if ( !m_FixedImageMask->ValueAt(inputPoint, val) || val == 0 )
+          {
+          continue;
+          }
+        }
+
+      const FixedImagePixelType value = m_FixedImage->GetPixel(index);
+      if ( m_UseFixedImageSamplesIntensityThreshold
+           && value < m_FixedImageSamplesIntensityThreshold )
+        {
+        continue;
+        }
+
+      samples[samplesFound].point = inputPoint;
+      samples[samplesFound].value = value;
+      samples[samplesFound].valueIndex = 0;
+      ++samplesFound;
+      break;
+      }
+    }
+
+  if ( samplesFound == 0 )
+    {
+    itkExceptionMacro(<< "No valid sample found in the fixed image region");
+    }
+
+  // Replicate the samples found to fill in the runs without a valid
+  // pixel, as the random sampling does
+  for ( SizeValueType count = 0; samplesFound < m_NumberOfFixedImageSamples; ++count, ++samplesFound )
+    {
+    samples[samplesFound] = samples[count];
+    }
+}
+
 /**
  * Sample the fixed image domain using all pixels in the Fixed image region
  */
@@ -978,31 +1214,49 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   if ( sampleOk )
     {
-    // If user provided a mask over the Moving image
-    if ( m_MovingImageMask )
+    this->EvaluateMovingImageValue(mappedPoint, sampleOk, movingImageValue, threadID);
+    }
+}
+
+/**
+ * Evaluate the moving image at a mapped point
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateMovingImageValue(const MovingImagePointType & mappedPoint,
+                           bool & sampleOk,
+                           double & movingImageValue,
+                           unsigned int threadID) const
+{
+  // If user provided a mask over the Moving image
+  if ( m_MovingImageMask )
+    {
+    // Check if mapped point is within the support region of the moving image
+    // mask
+    sampleOk = m_MovingImageMask->IsInside(mappedPoint);
+    if ( !sampleOk )
       {
-      // Check if mapped point is within the support region of the moving image
-      // mask
-      sampleOk = sampleOk && m_MovingImageMask->IsInside(mappedPoint);
+      return;
       }
+    }
+
+  // Map the point to the moving image grid once, for both the buffer
+  // check and the interpolation
+  MovingImageContinuousIndexType movingIndex;
+  m_Interpolator->ConvertPointToContinuousIndex(mappedPoint, movingIndex);
 
+  // Check if mapped point inside image buffer
+  sampleOk = m_Interpolator->IsInsideBuffer(movingIndex);
+  if ( sampleOk )
+    {
     if ( m_InterpolatorIsBSpline )
       {
-      // Check if mapped point inside image buffer
-      sampleOk = sampleOk && m_BSplineInterpolator->IsInsideBuffer(mappedPoint);
-      if ( sampleOk )
-        {
-        movingImageValue = m_BSplineInterpolator->Evaluate(mappedPoint, threadID);
-        }
+      movingImageValue = m_BSplineInterpolator->EvaluateAtContinuousIndex(movingIndex, threadID);
       }
     else
       {
-      // Check if mapped point inside image buffer
-      sampleOk = sampleOk && m_Interpolator->IsInsideBuffer(mappedPoint);
-      if ( sampleOk )
-        {
-        movingImageValue = m_Interpolator->Evaluate(mappedPoint);
-        }
+      movingImageValue = m_Interpolator->EvaluateAtContinuousIndex(movingIndex);
       }
     }
 }
@@ -1096,35 +1350,64 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   if ( sampleOk )
     {
-    // If user provided a mask over the Moving image
-    if ( m_MovingImageMask )
+    this->EvaluateMovingImageValueAndDerivatives(mappedPoint, sampleOk, movingImageValue,
+                                                 movingImageGradient, threadID);
+    }
+}
+
+/**
+ * Evaluate the moving image and its derivatives at a mapped point
+ */
+template< class TFixedImage, class TMovingImage >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateMovingImageValueAndDerivatives(const MovingImagePointType & mappedPoint,
+                                         bool & sampleOk,
+                                         double & movingImageValue,
+                                         ImageDerivativesType & movingImageGradient,
+                                         unsigned int threadID) const
+{
+  // If user provided a mask over the Moving image
+  if ( m_MovingImageMask )
+    {
+    // Check if mapped point is within the support region of the moving image
+    // mask
+    sampleOk = m_MovingImageMask->IsInside(mappedPoint);
+    if ( !sampleOk )
       {
-      // Check if mapped point is within the support region of the moving image
-      // mask
-      sampleOk = sampleOk && m_MovingImageMask->IsInside(mappedPoint);
+      return;
       }
+    }
+
+  // Map the point to the moving image grid once, for the buffer check,
+  // the interpolation and the lookup in the gradient image
+  MovingImageContinuousIndexType movingIndex;
+  m_Interpolator->ConvertPointToContinuousIndex(mappedPoint, movingIndex);
 
+  // Check if mapped point inside image buffer
+  sampleOk = m_Interpolator->IsInsideBuffer(movingIndex);
+  if ( sampleOk )
+    {
     if ( m_InterpolatorIsBSpline )
       {
-      // Check if mapped point inside image buffer
-      sampleOk = sampleOk && m_BSplineInterpolator->IsInsideBuffer(mappedPoint);
-      if ( sampleOk )
-        {
-        this->m_BSplineInterpolator->EvaluateValueAndDerivative(mappedPoint,
-                                                                movingImageValue,
-                                                                movingImageGradient,
-                                                                threadID);
-        }
+      this->m_BSplineInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(movingIndex,
+                                                                               movingImageValue,
+                                                                               movingImageGradient,
+                                                                               threadID);
       }
     else
       {
-      // Check if mapped point inside image buffer
-      sampleOk = sampleOk && m_Interpolator->IsInsideBuffer(mappedPoint);
-      if ( sampleOk )
+      if ( m_ComputeGradient )
+        {
+        MovingImageIndexType mappedIndex;
+        mappedIndex.CopyWithRound(movingIndex);
+        movingImageGradient = m_GradientImage->GetPixel(mappedIndex);
+        }
+      else
         {
         this->ComputeImageDerivatives(mappedPoint, movingImageGradient, threadID);
-        movingImageValue = this->m_Interpolator->Evaluate(mappedPoint);
         }
+      movingImageValue = this->m_Interpolator->EvaluateAtContinuousIndex(movingIndex);
       }
     }
 }
@@ -1271,21 +1554,32 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 template< class TFixedImage, class TMovingImage  >
 void
 ImageToImageMetric< TFixedImage, TMovingImage >
-::GetValueThread(unsigned int threadID) const
+::GetThreadSampleRange(unsigned int threadID,
+                       SizeValueType & firstSample,
+                       SizeValueType & numberOfSamples) const
 {
   // Figure out how many samples to process
-  int chunkSize = m_NumberOfFixedImageSamples / m_NumberOfThreads;
+  numberOfSamples = m_NumberOfFixedImageSamples / m_NumberOfThreads;
 
   // Skip to this thread's samples to process
-  unsigned int fixedImageSample = threadID * chunkSize;
+  firstSample = threadID * numberOfSamples;
 
   if ( threadID == m_NumberOfThreads - 1 )
     {
-    chunkSize = m_NumberOfFixedImageSamples
-                - ( ( m_NumberOfThreads - 1 )
-                    * chunkSize );
+    numberOfSamples = m_NumberOfFixedImageSamples
+                      - ( ( m_NumberOfThreads - 1 )
+                          * numberOfSamples );
     }
+}
 
+template< class TFixedImage, class TMovingImage  >
+void
+ImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThread(unsigned int threadID) const
+{
+  SizeValueType fixedImageSample;
+  SizeValueType chunkSize;
+  this->GetThreadSampleRange(threadID, fixedImageSample, chunkSize);
 
   if ( m_WithinThreadPreProcess )
     {
@@ -1294,22 +1588,58 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   // Process the samples
   int numSamples = 0;
-  for ( int count = 0; count < chunkSize; ++count, ++fixedImageSample )
+  if ( !m_TransformIsBSpline )
     {
-    MovingImagePointType mappedPoint;
-    bool                 sampleOk;
-    double               movingImageValue;
-    // Get moving image value
-    this->TransformPoint(fixedImageSample, mappedPoint, sampleOk, movingImageValue,
-                         threadID);
+    // Map the samples by blocks, with one call to the transform per block
+    const TransformType *transform = ( threadID > 0 ) ?
+                                     this->m_ThreaderTransform[threadID - 1].GetPointer() :
+                                     this->m_Transform.GetPointer();
+    FixedImagePointType  fixedPoints[SampleBlockSize];
+    MovingImagePointType mappedPoints[SampleBlockSize];
+    while ( chunkSize > 0 )
+      {
+      const SizeValueType blockSize = vnl_math_min(chunkSize, static_cast< SizeValueType >( SampleBlockSize ) );
+      for ( SizeValueType k = 0; k < blockSize; k++ )
+        {
+        fixedPoints[k] = m_FixedImageSamples[fixedImageSample + k].point;
+        }
+      transform->TransformPoints(fixedPoints, mappedPoints, blockSize);
+
+      for ( SizeValueType k = 0; k < blockSize; ++k, ++fixedImageSample )
+        {
+        bool   sampleOk;
+        double movingImageValue;
+        this->EvaluateMovingImageValue(mappedPoints[k], sampleOk, movingImageValue, threadID);
 
-    if ( sampleOk )
+        // CALL USER FUNCTION
+        if ( sampleOk && GetValueThreadProcessSample(threadID, fixedImageSample,
+                                                     mappedPoints[k], movingImageValue) )
+          {
+          ++numSamples;
+          }
+        }
+      chunkSize -= blockSize;
+      }
+    }
+  else
+    {
+    for ( SizeValueType count = 0; count < chunkSize; ++count, ++fixedImageSample )
       {
-      // CALL USER FUNCTION
-      if ( GetValueThreadProcessSample(threadID, fixedImageSample,
-                                       mappedPoint, movingImageValue) )
+      MovingImagePointType mappedPoint;
+      bool                 sampleOk;
+      double               movingImageValue;
+      // Get moving image value
+      this->TransformPoint(fixedImageSample, mappedPoint, sampleOk, movingImageValue,
+                           threadID);
+
+      if ( sampleOk )
         {
-        ++numSamples;
+        // CALL USER FUNCTION
+        if ( GetValueThreadProcessSample(threadID, fixedImageSample,
+                                         mappedPoint, movingImageValue) )
+          {
+          ++numSamples;
+          }
         }
       }
     }
@@ -1436,18 +1766,9 @@ void
 ImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValueAndDerivativeThread(unsigned int threadID) const
 {
-  // Figure out how many samples to process
-  int chunkSize = m_NumberOfFixedImageSamples / m_NumberOfThreads;
-
-  // Skip to this thread's samples to process
-  unsigned int fixedImageSample = threadID * chunkSize;
-
-  if ( threadID == m_NumberOfThreads - 1 )
-    {
-    chunkSize = m_NumberOfFixedImageSamples
-                - ( ( m_NumberOfThreads - 1 )
-                    * chunkSize );
-    }
+  SizeValueType fixedImageSample;
+  SizeValueType chunkSize;
+  this->GetThreadSampleRange(threadID, fixedImageSample, chunkSize);
 
   int numSamples = 0;
 
@@ -1461,23 +1782,61 @@ ImageToImageMetric< TFixedImage, TMovingImage >
   bool                 sampleOk;
   double               movingImageValue;
   ImageDerivativesType movingImageGradientValue;
-  for ( int count = 0; count < chunkSize; ++count, ++fixedImageSample )
+  if ( !m_TransformIsBSpline )
     {
-    // Get moving image value
-    TransformPointWithDerivatives(fixedImageSample, mappedPoint, sampleOk,
-                                  movingImageValue, movingImageGradientValue,
-                                  threadID);
+    // Map the samples by blocks, with one call to the transform per block
+    const TransformType *transform = ( threadID > 0 ) ?
+                                     this->m_ThreaderTransform[threadID - 1].GetPointer() :
+                                     this->m_Transform.GetPointer();
+    FixedImagePointType  fixedPoints[SampleBlockSize];
+    MovingImagePointType mappedPoints[SampleBlockSize];
+    while ( chunkSize > 0 )
+      {
+      const SizeValueType blockSize = vnl_math_min(chunkSize, static_cast< SizeValueType >( SampleBlockSize ) );
+      for ( SizeValueType k = 0; k < blockSize; k++ )
+        {
+        fixedPoints[k] = m_FixedImageSamples[fixedImageSample + k].point;
+        }
+      transform->TransformPoints(fixedPoints, mappedPoints, blockSize);
 
-    if ( sampleOk )
+      for ( SizeValueType k = 0; k < blockSize; ++k, ++fixedImageSample )
+        {
+        this->EvaluateMovingImageValueAndDerivatives(mappedPoints[k], sampleOk, movingImageValue,
+                                                     movingImageGradientValue, threadID);
+
+        // CALL USER FUNCTION
+        if ( sampleOk && this->GetValueAndDerivativeThreadProcessSample(threadID,
+                                                                        fixedImageSample,
+                                                                        mappedPoints[k],
+                                                                        movingImageValue,
+                                                                        movingImageGradientValue) )
+          {
+          ++numSamples;
+          }
+        }
+      chunkSize -= blockSize;
+      }
+    }
+  else
+    {
+    for ( SizeValueType count = 0; count < chunkSize; ++count, ++fixedImageSample )
       {
-      // CALL USER FUNCTION
-      if ( this->GetValueAndDerivativeThreadProcessSample(threadID,
-                                                          fixedImageSample,
-                                                          mappedPoint,
-                                                          movingImageValue,
-                                                          movingImageGradientValue) )
+      // Get moving image value
+      TransformPointWithDerivatives(fixedImageSample, mappedPoint, sampleOk,
+                                    movingImageValue, movingImageGradientValue,
+                                    threadID);
+
+      if ( sampleOk )
         {
-        ++numSamples;
+        // CALL USER FUNCTION
+        if ( this->GetValueAndDerivativeThreadProcessSample(threadID,
+                                                            fixedImageSample,
+                                                            mappedPoint,
+                                                            movingImageValue,
+                                                            movingImageGradientValue) )
+          {
+          ++numSamples;
+          }
         }
       }
     }
@@ -1571,6 +1930,17 @@ ImageToImageMetric< TFixedImage, TMovingImage >
 
   os << indent << "UseCachingOfBSplineWeights: ";
   os << this->m_UseCachingOfBSplineWeights << std::endl;
+
+  os << indent << "ReuseFixedImageSamples: ";
+  os << this->m_ReuseFixedImageSamples << std::endl;
+  os << indent << "UseStratifiedSampling: ";
+  os << this->m_UseStratifiedSampling << std::endl;
+  os << indent << "UseStochasticSampling: ";
+  os << this->m_UseStochasticSampling << std::endl;
+  os << indent << "MaximumNumberOfFixedImageSamples: ";
+  os << this->m_MaximumNumberOfFixedImageSamples << std::endl;
+  os << indent << "FixedImageSamplesGrowthFactor: ";
+  os << this->m_FixedImageSamplesGrowthFactor << std::endl;
 }
 
 /** This method can be const because we are not altering the m_ThreaderTransform
@@ -47,6 +47,10 @@ namespace itk
  * (perfect foreground alignment).  When dealing with optimizers that can
  * only minimize a metric, use the ComplementOn() method.
  *
+ * The areas are accumulated over the samples of the fixed image by
+ * several threads. By default all the pixels of the fixed image region
+ * are used.
+ *
  * \ingroup RegistrationMetrics
  * \ingroup ITK-RegistrationCommon
  */
@@ -74,6 +78,7 @@ public:
   typedef typename Superclass::TransformPointer        TransformPointer;
   typedef typename Superclass::TransformParametersType TransformParametersType;
   typedef typename Superclass::TransformJacobianType   TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::GradientImageType       GradientImageType;
   typedef typename Superclass::GradientPixelType       GradientPixelType;
   typedef typename Superclass::InputPointType          InputPointType;
@@ -86,6 +91,20 @@ public:
   typedef typename Superclass::FixedImageConstPointer  FixedImageConstPointer;
   typedef typename Superclass::MovingImageConstPointer MovingImageConstPointer;
   typedef typename Superclass::FixedImageRegionType    FixedImageRegionType;
+  typedef typename Superclass::MovingImagePointType    MovingImagePointType;
+  typedef typename Superclass::ImageDerivativesType    ImageDerivativesType;
+
+  /** The moving image dimension. */
+  itkStaticConstMacro(MovingImageDimension, unsigned int,
+                      MovingImageType::ImageDimension);
+
+  /** Initialize the metric, count the foreground samples of the fixed
+   * image and allocate the sums accumulated by each thread. */
+  virtual void Initialize(void)
+  throw ( ExceptionObject );
+
+  /** Draw new fixed image samples and count their foreground. */
+  virtual void ResampleFixedImage(void);
 
   /** Computes the gradient image and assigns it to m_GradientImage */
   void ComputeGradient();
@@ -101,8 +120,8 @@ public:
    *  been set, the metric value is 1.0-2*|A&B|/(|A|+|B|). */
   MeasureType GetValue(const TransformParametersType & parameters) const;
 
-  /** Get both the value and derivative. This method internally calls the
-    \c GetValue() and the \c GetDerivative() method. */
+  /** Get both the value and derivative, in a single pass over the
+   * samples of the fixed image. */
   void GetValueAndDerivative(const TransformParametersType & parameters,
                              MeasureType & Value, DerivativeType & Derivative) const;
 
@@ -120,15 +139,48 @@ public:
   itkGetConstMacro(Complement, bool);
 protected:
   KappaStatisticImageToImageMetric();
-  virtual ~KappaStatisticImageToImageMetric() {}
+  virtual ~KappaStatisticImageToImageMetric();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
 private:
   KappaStatisticImageToImageMetric(const Self &); //purposely not implemented
   void operator=(const Self &);                   //purposely not implemented
 
+  /** The foreground areas accumulated by each thread. */
+  struct AreasType {
+    SizeValueType movingArea;
+    SizeValueType intersection;
+  };
+
+  /** Count the samples of the fixed image in the foreground. */
+  void ComputeFixedForegroundArea();
+
+  void ResetThreaderAreas() const;
+
+  /** Add the areas of the threads. */
+  AreasType ReduceThreaderAreas() const;
+
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          SizeValueType fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
+  inline bool GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                                       SizeValueType fixedImageSample,
+                                                       const MovingImagePointType & mappedPoint,
+                                                       double movingImageValue,
+                                                       const ImageDerivativesType &
+                                                       movingImageGradientValue) const;
+
   RealType m_ForegroundValue;
   bool     m_Complement;
+
+  /** Number of samples of the fixed image in the foreground. */
+  SizeValueType m_FixedForegroundArea;
+
+  AreasType *     m_ThreaderAreas;
+  DerivativeType *m_ThreaderSum1;
+  DerivativeType *m_ThreaderSum2;
 };
 } // end namespace itk
 
@@ -35,269 +35,338 @@ KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
   this->SetComputeGradient(true);
   m_ForegroundValue = 255;
   m_Complement = false;
+
+  m_FixedForegroundArea = 0;
+  m_ThreaderAreas = NULL;
+  m_ThreaderSum1 = NULL;
+  m_ThreaderSum2 = NULL;
+  this->m_WithinThreadPreProcess = false;
+  this->m_WithinThreadPostProcess = false;
+
+  //  For backward compatibility, the default behavior is to use all the pixels
+  //  in the fixed image.
+  this->SetUseAllPixels(true);
 }
 
-/**
- * Get the match Measure
- */
 template< class TFixedImage, class TMovingImage >
-typename KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
-::GetValue(const TransformParametersType & parameters) const
+::~KappaStatisticImageToImageMetric()
 {
-  itkDebugMacro("GetValue( " << parameters << " ) ");
+  if ( m_ThreaderAreas != NULL )
+    {
+    delete[] m_ThreaderAreas;
+    }
+  m_ThreaderAreas = NULL;
 
-  this->SetTransformParameters(parameters);
+  if ( m_ThreaderSum1 != NULL )
+    {
+    delete[] m_ThreaderSum1;
+    }
+  m_ThreaderSum1 = NULL;
 
-  //Get the fixed image
-  //
-  //
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-  if ( !fixedImage )
+  if ( m_ThreaderSum2 != NULL )
     {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
+    delete[] m_ThreaderSum2;
     }
+  m_ThreaderSum2 = NULL;
+}
 
-  //Get an iterator over the fixed image
-  //
-  //
-  typedef  ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-  typename FixedImageType::IndexType fixedIndex;
-  FixedIteratorType fi( fixedImage, fixedImage->GetBufferedRegion() );
+/**
+ * Initialize
+ */
+template< class TFixedImage, class TMovingImage >
+void
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::Initialize(void)
+throw ( ExceptionObject )
+{
+  this->Superclass::Initialize();
+  this->Superclass::MultiThreadingInitialize();
 
-  //Get the moving image
-  //
-  //
-  MovingImageConstPointer movingImage = this->m_MovingImage;
-  if ( !movingImage )
+  // The foreground area of the fixed image does not depend on the
+  // transform: count it once.
+  this->ComputeFixedForegroundArea();
+
+  if ( m_ThreaderAreas != NULL )
     {
-    itkExceptionMacro(<< "Moving image has not been assigned");
+    delete[] m_ThreaderAreas;
     }
+  m_ThreaderAreas = new AreasType[this->m_NumberOfThreads];
 
-  //Following are used in the metric computation.  'measure' is the
-  //value of the metric.  'fixedForegroundArea' is the total area
-  //of the foreground region in the fixed image.
-  //'movingForegroundArea' is the foreground area in the moving image
-  //in the area of overlap under the current transformation.
-  //'intersection' is the area of foreground intersection between the
-  //fixed and moving image.
-  //
-  //
-  MeasureType measure;
-  MeasureType intersection         = NumericTraits< MeasureType >::Zero;
-  MeasureType movingForegroundArea = NumericTraits< MeasureType >::Zero;
-  MeasureType fixedForegroundArea  = NumericTraits< MeasureType >::Zero;
-
-  //Compute fixedForegroundArea, movingForegroundArea, and
-  //intersection.  Loop over the fixed image.
-  //
-  //
-  while ( !fi.IsAtEnd() )
+  if ( m_ThreaderSum1 != NULL )
     {
-    fixedIndex = fi.GetIndex();
+    delete[] m_ThreaderSum1;
+    }
+  m_ThreaderSum1 = new DerivativeType[this->m_NumberOfThreads];
 
-    InputPointType fixedInputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(fixedIndex, fixedInputPoint);
+  if ( m_ThreaderSum2 != NULL )
+    {
+    delete[] m_ThreaderSum2;
+    }
+  m_ThreaderSum2 = new DerivativeType[this->m_NumberOfThreads];
 
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(fixedInputPoint) )
-      {
-      ++fi;
-      continue;
-      }
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    m_ThreaderSum1[threadID].SetSize(this->m_NumberOfParameters);
+    m_ThreaderSum2[threadID].SetSize(this->m_NumberOfParameters);
+    }
+}
 
-    const RealType fixedValue = fi.Get();
+/**
+ * Draw new fixed image samples
+ */
+template< class TFixedImage, class TMovingImage >
+void
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::ResampleFixedImage(void)
+{
+  this->Superclass::ResampleFixedImage();
+  this->ComputeFixedForegroundArea();
+}
 
-    //Increment 'fixedForegroundArea'
-    //
-    //
-    if ( fixedValue == m_ForegroundValue )
+/**
+ * Count the samples of the fixed image in the foreground
+ */
+template< class TFixedImage, class TMovingImage >
+void
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeFixedForegroundArea()
+{
+  m_FixedForegroundArea = 0;
+  for ( SizeValueType i = 0; i < this->m_NumberOfFixedImageSamples; i++ )
+    {
+    if ( this->m_FixedImageSamples[i].value == m_ForegroundValue )
       {
-      fixedForegroundArea++;
+      m_FixedForegroundArea++;
       }
+    }
+}
 
-    //Get the point in the transformed moving image corresponding to
-    //the point in the fixed image (physical coordinates)
-    //
-    //
-    OutputPointType
-      transformedPoint = this->m_Transform->TransformPoint(fixedInputPoint);
-
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++fi;
-      continue;
-      }
+template< class TFixedImage, class TMovingImage >
+void
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::ResetThreaderAreas() const
+{
+  if ( m_ThreaderAreas == NULL )
+    {
+    itkExceptionMacro(<< "The metric has not been initialized, maybe you forgot to call Initialize()");
+    }
 
-    //Compute movingForegroundArea and intersection
-    //
-    //
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue = this->m_Interpolator->Evaluate(transformedPoint);
-      if ( movingValue == m_ForegroundValue )
-        {
-        movingForegroundArea++;
-        }
-      if ( ( movingValue == m_ForegroundValue ) && ( fixedValue == m_ForegroundValue ) )
-        {
-        intersection++;
-        }
-      }
-    ++fi;
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    m_ThreaderAreas[threadID].movingArea = 0;
+    m_ThreaderAreas[threadID].intersection = 0;
     }
+}
 
-  //Compute the final metric value
-  //
-  //
-  if ( !m_Complement )
+template< class TFixedImage, class TMovingImage >
+typename KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >::AreasType
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::ReduceThreaderAreas() const
+{
+  AreasType areas = m_ThreaderAreas[0];
+
+  for ( unsigned int threadID = 1; threadID < this->m_NumberOfThreads; threadID++ )
     {
-    measure = 2.0 * ( intersection ) / ( fixedForegroundArea + movingForegroundArea );
+    areas.movingArea += m_ThreaderAreas[threadID].movingArea;
+    areas.intersection += m_ThreaderAreas[threadID].intersection;
     }
-  else
+  return areas;
+}
+
+template< class TFixedImage, class TMovingImage  >
+inline bool
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThreadProcessSample(unsigned int threadID,
+                              SizeValueType fixedImageSample,
+                              const MovingImagePointType & itkNotUsed(mappedPoint),
+                              double movingImageValue) const
+{
+  if ( movingImageValue == m_ForegroundValue )
     {
-    measure = 1.0 - 2.0 * ( intersection ) / ( fixedForegroundArea + movingForegroundArea );
+    AreasType & areas = m_ThreaderAreas[threadID];
+    areas.movingArea++;
+    if ( this->m_FixedImageSamples[fixedImageSample].value == m_ForegroundValue )
+      {
+      areas.intersection++;
+      }
     }
 
-  return measure;
+  return true;
 }
 
 /**
- * Get the Derivative Measure
+ * Get the match Measure
  */
 template< class TFixedImage, class TMovingImage >
-void
+typename KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
-::GetDerivative(const TransformParametersType & parameters,
-                DerivativeType & derivative) const
+::GetValue(const TransformParametersType & parameters) const
 {
-  itkDebugMacro("GetDerivative( " << parameters << " ) ");
+  itkDebugMacro("GetValue( " << parameters << " ) ");
 
-  if ( !this->GetGradientImage() )
+  if ( !this->m_FixedImage )
     {
-    itkExceptionMacro(<< "The gradient image is null, maybe you forgot to call Initialize()");
+    itkExceptionMacro(<< "Fixed image has not been assigned");
     }
 
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-  if ( !fixedImage )
+  if ( !this->m_MovingImage )
     {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
+    itkExceptionMacro(<< "Moving image has not been assigned");
     }
 
-  const unsigned int ImageDimension = FixedImageType::ImageDimension;
-
-  typedef  ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
+  this->ResetThreaderAreas();
 
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
-
-  typename FixedImageType::IndexType index;
+  this->SetTransformParameters(parameters);
 
-  this->m_NumberOfPixelsCounted = 0;
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueMultiThreadedInitiate();
 
-  this->SetTransformParameters(parameters);
+  const AreasType areas = this->ReduceThreaderAreas();
 
-  const unsigned int ParametersDimension = this->GetNumberOfParameters();
-  derivative = DerivativeType(ParametersDimension);
-  derivative.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+  //Compute the final metric value
+  //
+  //
+  MeasureType measure = 2.0 * areas.intersection
+                        / ( static_cast< MeasureType >( m_FixedForegroundArea ) + areas.movingArea );
+  if ( m_Complement )
+    {
+    measure = 1.0 - measure;
+    }
 
-  typedef Array< double > ArrayType;
+  return measure;
+}
 
-  ArrayType sum1 = ArrayType(ParametersDimension);
-  sum1.Fill(NumericTraits< ITK_TYPENAME ArrayType::ValueType >::Zero);
+template< class TFixedImage, class TMovingImage  >
+inline bool
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                           SizeValueType fixedImageSample,
+                                           const MovingImagePointType & mappedPoint,
+                                           double movingImageValue,
+                                           const ImageDerivativesType &
+                                           movingImageGradientValue) const
+{
+  this->GetValueThreadProcessSample(threadID, fixedImageSample,
+                                    mappedPoint, movingImageValue);
 
-  ArrayType sum2 = ArrayType(ParametersDimension);
-  sum2.Fill(NumericTraits< ITK_TYPENAME ArrayType::ValueType >::Zero);
+  const bool fixedForeground =
+    ( this->m_FixedImageSamples[fixedImageSample].value == m_ForegroundValue );
 
-  int fixedArea = 0;
-  int movingArea = 0;
-  int intersection = 0;
+  // Need to use one of the threader transforms if we're
+  // not in thread 0.
+  TransformType *transform;
 
-  ti.GoToBegin();
-  while ( !ti.IsAtEnd() )
+  if ( threadID > 0 )
+    {
+    transform = this->m_ThreaderTransform[threadID - 1];
+    }
+  else
     {
-    index = ti.GetIndex();
+    transform = this->m_Transform;
+    }
 
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+  TransformJacobianType &      jacobian = this->m_ThreaderJacobian[threadID];
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices = this->m_ThreaderNonZeroJacobianIndices[threadID];
+  transform->GetSparseJacobian(this->m_FixedImageSamples[fixedImageSample].point,
+                               jacobian, nonZeroJacobianIndices);
 
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
+  DerivativeType & sum1 = m_ThreaderSum1[threadID];
+  DerivativeType & sum2 = m_ThreaderSum2[threadID];
 
-    const RealType fixedValue = ti.Value();
-    if ( fixedValue == m_ForegroundValue )
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
+    {
+    const unsigned int par = nonZeroJacobianIndices[k];
+    for ( unsigned int dim = 0; dim < MovingImageDimension; dim++ )
       {
-      fixedArea++;
+      sum2[par] += jacobian(dim, k) * movingImageGradientValue[dim];
+      if ( fixedForeground )
+        {
+        sum1[par] += 2.0 * jacobian(dim, k) * movingImageGradientValue[dim];
+        }
       }
+    }
 
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
+  return true;
+}
 
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
+/**
+ * Get the Derivative Measure
+ */
+template< class TFixedImage, class TMovingImage >
+void
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::GetDerivative(const TransformParametersType & parameters,
+                DerivativeType & derivative) const
+{
+  itkDebugMacro("GetDerivative( " << parameters << " ) ");
 
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
+  MeasureType value;
 
-      if ( movingValue == m_ForegroundValue )
-        {
-        movingArea++;
-        }
+  // call the combined version
+  this->GetValueAndDerivative(parameters, value, derivative);
+}
 
-      if ( ( movingValue == m_ForegroundValue ) && ( fixedValue == m_ForegroundValue ) )
-        {
-        intersection++;
-        }
+/**
+ * Get both the match Measure and theDerivative Measure
+ */
+template< class TFixedImage, class TMovingImage >
+void
+KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivative(const TransformParametersType & parameters,
+                        MeasureType & value, DerivativeType  & derivative) const
+{
+  if ( !this->GetGradientImage() )
+    {
+    itkExceptionMacro(<< "The gradient image is null, maybe you forgot to call Initialize()");
+    }
 
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
+  if ( !this->m_FixedImage )
+    {
+    itkExceptionMacro(<< "Fixed image has not been assigned");
+    }
 
-      this->m_NumberOfPixelsCounted++;
+  this->ResetThreaderAreas();
 
-      // Get the gradient by NearestNeighboorInterpolation:
-      // which is equivalent to round up the point components.
-      typedef typename OutputPointType::CoordRepType CoordRepType;
-      typedef ContinuousIndex< CoordRepType, MovingImageType::ImageDimension >
-      MovingImageContinuousIndexType;
+  const unsigned int ParametersDimension = this->GetNumberOfParameters();
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    m_ThreaderSum1[threadID].Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+    m_ThreaderSum2[threadID].Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+    }
 
-      MovingImageContinuousIndexType tempIndex;
-      this->m_MovingImage->TransformPhysicalPointToContinuousIndex(transformedPoint, tempIndex);
+  this->SetTransformParameters(parameters);
 
-      typename MovingImageType::IndexType mappedIndex;
-      mappedIndex.CopyWithRound(tempIndex);
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueAndDerivativeMultiThreadedInitiate();
 
-      const GradientPixelType gradient = this->m_GradientImage->GetPixel(mappedIndex);
+  if ( !this->m_NumberOfPixelsCounted )
+    {
+    itkExceptionMacro(<< "All the points mapped to outside of the moving image");
+    }
 
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
-        {
-        for ( unsigned int dim = 0; dim < ImageDimension; dim++ )
-          {
-          sum2[par] += jacobian(dim, par) * gradient[dim];
-          if ( fixedValue == m_ForegroundValue )
-            {
-            sum1[par] += 2.0 * jacobian(dim, par) * gradient[dim];
-            }
-          }
-        }
-      }
-    ++ti;
+  const AreasType areas = this->ReduceThreaderAreas();
+
+  DerivativeType sum1 = m_ThreaderSum1[0];
+  DerivativeType sum2 = m_ThreaderSum2[0];
+  for ( unsigned int threadID = 1; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    sum1 += m_ThreaderSum1[threadID];
+    sum2 += m_ThreaderSum2[threadID];
     }
 
-  if ( !this->m_NumberOfPixelsCounted )
+  const double areaSum = double(m_FixedForegroundArea) + double(areas.movingArea);
+
+  value = 2.0 * areas.intersection / areaSum;
+  if ( m_Complement )
     {
-    itkExceptionMacro(<< "All the points mapped to outside of the moving image");
+    value = 1.0 - value;
     }
-  else
+
+  derivative = DerivativeType(ParametersDimension);
+  for ( unsigned int par = 0; par < ParametersDimension; par++ )
     {
-    double areaSum = double(fixedArea) + double(movingArea);
-    for ( unsigned int par = 0; par < ParametersDimension; par++ )
-      {
-      derivative[par] = -( areaSum * sum1[par] - 2.0 * intersection * sum2[par] ) / ( areaSum * areaSum );
-      }
+    derivative[par] = -( areaSum * sum1[par] - 2.0 * areas.intersection * sum2[par] ) / ( areaSum * areaSum );
     }
 }
 
@@ -372,19 +441,6 @@ KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
   this->m_GradientImage = tempGradientImage;
 }
 
-/**
- * Get both the match Measure and theDerivative Measure
- */
-template< class TFixedImage, class TMovingImage >
-void
-KappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
-::GetValueAndDerivative(const TransformParametersType & parameters,
-                        MeasureType & Value, DerivativeType  & Derivative) const
-{
-  Value      = this->GetValue(parameters);
-  this->GetDerivative(parameters, Derivative);
-}
-
 /**
  * PrintSelf
  */
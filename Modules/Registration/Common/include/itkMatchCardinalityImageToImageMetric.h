@@ -123,9 +123,11 @@ public:
   itkBooleanMacro(MeasureMatches);
   itkGetConstMacro(MeasureMatches, bool);
 
-  /** Return the multithreader used by this class. */
+  /** Return the multithreader used by this class. It is the multithreader
+   * of the superclass, so that the metric uses the NumberOfThreads set on
+   * it. */
   MultiThreader * GetMultiThreader()
-  { return m_Threader; }
+  { return this->m_Threader; }
 protected:
   MatchCardinalityImageToImageMetric();
   virtual ~MatchCardinalityImageToImageMetric() {}
@@ -171,10 +173,6 @@ private:
   bool                         m_MeasureMatches;
   std::vector< MeasureType >   m_ThreadMatches;
   std::vector< SizeValueType > m_ThreadCounts;
-
-  /** Support processing data in multiple threads. Used by subclasses
-   * (e.g., ImageSource). */
-  MultiThreader::Pointer m_Threader;
 };
 } // end namespace itk
 
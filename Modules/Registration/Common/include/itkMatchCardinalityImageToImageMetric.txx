@@ -35,8 +35,6 @@ MatchCardinalityImageToImageMetric< TFixedImage, TMovingImage >
   this->SetComputeGradient(false); // don't use the default gradients
   m_MeasureMatches = true;         // default to measure percentage of pixel
                                    // matches
-
-  m_Threader = MultiThreader::New();
 }
 
 /*
@@ -131,6 +131,7 @@ public:
   typedef typename Superclass::TransformType                  TransformType;
   typedef typename Superclass::TransformPointer               TransformPointer;
   typedef typename Superclass::TransformJacobianType          TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType     NonZeroJacobianIndicesType;
   typedef typename Superclass::InterpolatorType               InterpolatorType;
   typedef typename Superclass::MeasureType                    MeasureType;
   typedef typename Superclass::DerivativeType                 DerivativeType;
@@ -165,6 +166,10 @@ public:
   virtual void Initialize(void)
   throw ( ExceptionObject );
 
+  /** Draw new fixed image samples, and compute their Parzen window
+   * indices. */
+  virtual void ResampleFixedImage(void);
+
   /**  Get the value. */
   MeasureType GetValue(const ParametersType & parameters) const;
 
@@ -201,6 +206,11 @@ public:
    * equals to the product of (number of histogram bins)^2 times number of
    * transform parameters. This method is well suited for Transform with a small
    * number of parameters.
+   * The fixed image samples are sorted by bin, so that each thread writes
+   * the derivatives of its own rows of the joint PDF. Only the rows of the
+   * bins whose samples are processed by several threads are accumulated
+   * in buffers of the threads, of size (number of histogram bins) times
+   * number of transform parameters, and added when the threads are done.
    *
    * UseExplicitPDFDerivatives = False will compute the Metric derivative by
    * first computing the weights for each one of the Joint PDF bins and caching
@@ -209,7 +219,9 @@ public:
    * method an extra 2D array is used for storing the weights of each one of
    * the PDF bins. This is an array of doubles with size equals to (number of
    * histogram bins)^2. This method is well suited for Transforms with a large
-   * number of parameters, such as, BSplineDeformableTransforms. */
+   * number of parameters, such as, BSplineDeformableTransforms. The
+   * derivatives accumulated by the threads are added in parallel, each
+   * thread adding a range of the parameters. */
   itkSetMacro(UseExplicitPDFDerivatives, bool);
   itkGetConstReferenceMacro(UseExplicitPDFDerivatives, bool);
   itkBooleanMacro(UseExplicitPDFDerivatives);
@@ -293,6 +305,18 @@ private:
   virtual void ComputeFixedImageParzenWindowIndices(
     FixedImageSampleContainer & samples);
 
+  /** Sort the fixed image samples by parzen window index, and find the
+   * rows of the joint PDF derivatives written by each thread. */
+  void ComputeThreaderFixedImageParzenWindowRanges();
+
+  typedef typename FixedImageSampleContainer::value_type FixedImageSamplePointType;
+
+  static bool FixedImageSampleLessThan(const FixedImageSamplePointType & a,
+                                       const FixedImageSamplePointType & b)
+  {
+    return a.valueIndex < b.valueIndex;
+  }
+
   /** Compute PDF derivative contribution for each parameter. */
   virtual void ComputePDFDerivatives(unsigned int threadID,
                                      unsigned int sampleNumber,
@@ -304,12 +328,25 @@ private:
 
   PDFValueType *m_ThreaderFixedImageMarginalPDF;
 
-  typename JointPDFType::Pointer              * m_ThreaderJointPDF;
-  typename JointPDFDerivativesType::Pointer   * m_ThreaderJointPDFDerivatives;
+  typename JointPDFType::Pointer * m_ThreaderJointPDF;
 
   int *m_ThreaderJointPDFStartBin;
   int *m_ThreaderJointPDFEndBin;
 
+  /** The fixed image parzen window indices of the first and last samples
+   * of each thread, and the number of threads which have samples in each
+   * fixed image bin. */
+  int *         m_ThreaderFirstFixedBin;
+  int *         m_ThreaderLastFixedBin;
+  unsigned int *m_FixedBinNumberOfThreads;
+
+  /** The first and last fixed image bins of each thread, if they are shared
+   * with other threads, or -1. The derivatives of their rows of the joint
+   * PDF are accumulated in two buffers per thread. */
+  int *                         m_ThreaderFirstSharedFixedBin;
+  int *                         m_ThreaderLastSharedFixedBin;
+  JointPDFDerivativesValueType *m_ThreaderSharedJointPDFDerivatives;
+
   mutable double *m_ThreaderJointPDFSum;
 
   mutable double m_JointPDFSum;
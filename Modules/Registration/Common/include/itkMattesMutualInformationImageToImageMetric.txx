@@ -28,6 +28,8 @@
 #include "vnl/vnl_vector.h"
 #include "vnl/vnl_c_vector.h"
 
+#include <algorithm>
+
 namespace itk
 {
 /**
@@ -65,9 +67,14 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   // For multi-threading the metric
   m_ThreaderFixedImageMarginalPDF(NULL),
   m_ThreaderJointPDF(NULL),
-  m_ThreaderJointPDFDerivatives(NULL),
   m_ThreaderJointPDFStartBin(NULL),
   m_ThreaderJointPDFEndBin(NULL),
+  m_ThreaderFirstFixedBin(NULL),
+  m_ThreaderLastFixedBin(NULL),
+  m_FixedBinNumberOfThreads(NULL),
+  m_ThreaderFirstSharedFixedBin(NULL),
+  m_ThreaderLastSharedFixedBin(NULL),
+  m_ThreaderSharedJointPDFDerivatives(NULL),
   m_ThreaderJointPDFSum(NULL),
   m_JointPDFSum(0.0),
 
@@ -100,12 +107,6 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     }
   m_ThreaderJointPDF = NULL;
 
-  if ( m_ThreaderJointPDFDerivatives != NULL )
-    {
-    delete[] m_ThreaderJointPDFDerivatives;
-    }
-  m_ThreaderJointPDFDerivatives = NULL;
-
   if ( m_ThreaderFixedImageMarginalPDF != NULL )
     {
     delete[] m_ThreaderFixedImageMarginalPDF;
@@ -124,6 +125,42 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     }
   m_ThreaderJointPDFEndBin = NULL;
 
+  if ( m_ThreaderFirstFixedBin != NULL )
+    {
+    delete[] m_ThreaderFirstFixedBin;
+    }
+  m_ThreaderFirstFixedBin = NULL;
+
+  if ( m_ThreaderLastFixedBin != NULL )
+    {
+    delete[] m_ThreaderLastFixedBin;
+    }
+  m_ThreaderLastFixedBin = NULL;
+
+  if ( m_FixedBinNumberOfThreads != NULL )
+    {
+    delete[] m_FixedBinNumberOfThreads;
+    }
+  m_FixedBinNumberOfThreads = NULL;
+
+  if ( m_ThreaderFirstSharedFixedBin != NULL )
+    {
+    delete[] m_ThreaderFirstSharedFixedBin;
+    }
+  m_ThreaderFirstSharedFixedBin = NULL;
+
+  if ( m_ThreaderLastSharedFixedBin != NULL )
+    {
+    delete[] m_ThreaderLastSharedFixedBin;
+    }
+  m_ThreaderLastSharedFixedBin = NULL;
+
+  if ( m_ThreaderSharedJointPDFDerivatives != NULL )
+    {
+    delete[] m_ThreaderSharedJointPDFDerivatives;
+    }
+  m_ThreaderSharedJointPDFDerivatives = NULL;
+
   if ( m_ThreaderJointPDFSum != NULL )
     {
     delete[] m_ThreaderJointPDFSum;
@@ -390,31 +427,31 @@ throw ( ExceptionObject )
 
   unsigned int threadID;
 
-  int binRange = m_NumberOfHistogramBins / this->m_NumberOfThreads;
-
   for ( threadID = 0; threadID < this->m_NumberOfThreads - 1; threadID++ )
     {
     m_ThreaderJointPDF[threadID] = JointPDFType::New();
     m_ThreaderJointPDF[threadID]->SetRegions(jointPDFRegion);
     m_ThreaderJointPDF[threadID]->Allocate();
-
-    m_ThreaderJointPDFStartBin[threadID] = threadID * binRange;
-    m_ThreaderJointPDFEndBin[threadID] = ( threadID + 1 ) * binRange - 1;
     }
 
-  m_ThreaderJointPDFStartBin[this->m_NumberOfThreads - 1] =
-    ( this->m_NumberOfThreads - 1 ) * binRange;
-
-  m_ThreaderJointPDFEndBin[this->m_NumberOfThreads - 1] = m_NumberOfHistogramBins - 1;
+  // The bins are spread as evenly as possible over the threads, even when
+  // there are more threads than bins.
+  for ( threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    m_ThreaderJointPDFStartBin[threadID] =
+      static_cast< int >( threadID * m_NumberOfHistogramBins / this->m_NumberOfThreads );
+    m_ThreaderJointPDFEndBin[threadID] =
+      static_cast< int >( ( threadID + 1 ) * m_NumberOfHistogramBins / this->m_NumberOfThreads ) - 1;
+    }
 
   // Release memory of arrays that may have been used for
   // previous executions of this metric with different settings
   // of the memory caching flags.
-  if ( m_ThreaderJointPDFDerivatives != NULL )
+  if ( m_ThreaderSharedJointPDFDerivatives != NULL )
     {
-    delete[] m_ThreaderJointPDFDerivatives;
+    delete[] m_ThreaderSharedJointPDFDerivatives;
     }
-  m_ThreaderJointPDFDerivatives = NULL;
+  m_ThreaderSharedJointPDFDerivatives = NULL;
 
   if ( m_ThreaderMetricDerivative != NULL )
     {
@@ -424,16 +461,13 @@ throw ( ExceptionObject )
 
   if ( this->m_UseExplicitPDFDerivatives )
     {
-    m_ThreaderJointPDFDerivatives = new typename
-                                    JointPDFDerivativesType::Pointer[this->m_NumberOfThreads - 1];
+    this->ComputeThreaderFixedImageParzenWindowRanges();
 
-    for ( threadID = 0; threadID < this->m_NumberOfThreads - 1; threadID++ )
-      {
-      m_ThreaderJointPDFDerivatives[threadID] = JointPDFDerivativesType::New();
-      m_ThreaderJointPDFDerivatives[threadID]->SetRegions(
-        jointPDFDerivativesRegion);
-      m_ThreaderJointPDFDerivatives[threadID]->Allocate();
-      }
+    // Two rows of the joint PDF derivatives per thread, instead of a copy
+    // of the whole joint PDF derivatives.
+    m_ThreaderSharedJointPDFDerivatives =
+      new JointPDFDerivativesValueType[2 * this->m_NumberOfThreads
+                                       * m_JointPDFDerivatives->GetOffsetTable()[2]];
     }
   else
     {
@@ -446,6 +480,141 @@ throw ( ExceptionObject )
     }
 }
 
+/**
+ * Draw new fixed image samples
+ */
+template< class TFixedImage, class TMovingImage >
+void
+MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ResampleFixedImage(void)
+{
+  if ( this->m_FixedImageSamples.empty() )
+    {
+    itkExceptionMacro(<< "The metric must be initialized before drawing new fixed image samples");
+    }
+
+  this->SampleFixedImageDomain();
+  this->ComputeFixedImageParzenWindowIndices(this->m_FixedImageSamples);
+
+  // The weights of the B-spline transform are cached once the samples are
+  // sorted by fixed image bin.
+  if ( this->m_UseExplicitPDFDerivatives )
+    {
+    this->ComputeThreaderFixedImageParzenWindowRanges();
+    }
+  else if ( this->m_TransformIsBSpline && this->m_UseCachingOfBSplineWeights )
+    {
+    this->CacheBSplineTransformValues();
+    }
+
+  // PreComputeTransformValues() resets the parameters of the transform
+  if ( this->m_TransformIsBSpline && this->m_UseCachingOfBSplineWeights
+       && this->m_Parameters.Size() == this->m_NumberOfParameters )
+    {
+    this->m_Transform->SetParameters(this->m_Parameters);
+    }
+}
+
+/**
+ * Sort the samples by fixed image bin, and find the bins of each thread
+ */
+template< class TFixedImage, class TMovingImage >
+void
+MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeThreaderFixedImageParzenWindowRanges()
+{
+  std::stable_sort(this->m_FixedImageSamples.begin(),
+                   this->m_FixedImageSamples.end(),
+                   FixedImageSampleLessThan);
+
+  // The weights of the B-spline transform are cached by sample number.
+  if ( this->m_TransformIsBSpline && this->m_UseCachingOfBSplineWeights )
+    {
+    this->CacheBSplineTransformValues();
+    }
+
+  if ( m_ThreaderFirstFixedBin != NULL )
+    {
+    delete[] m_ThreaderFirstFixedBin;
+    }
+  m_ThreaderFirstFixedBin = new int[this->m_NumberOfThreads];
+
+  if ( m_ThreaderLastFixedBin != NULL )
+    {
+    delete[] m_ThreaderLastFixedBin;
+    }
+  m_ThreaderLastFixedBin = new int[this->m_NumberOfThreads];
+
+  if ( m_FixedBinNumberOfThreads != NULL )
+    {
+    delete[] m_FixedBinNumberOfThreads;
+    }
+  m_FixedBinNumberOfThreads = new unsigned int[m_NumberOfHistogramBins];
+
+  if ( m_ThreaderFirstSharedFixedBin != NULL )
+    {
+    delete[] m_ThreaderFirstSharedFixedBin;
+    }
+  m_ThreaderFirstSharedFixedBin = new int[this->m_NumberOfThreads];
+
+  if ( m_ThreaderLastSharedFixedBin != NULL )
+    {
+    delete[] m_ThreaderLastSharedFixedBin;
+    }
+  m_ThreaderLastSharedFixedBin = new int[this->m_NumberOfThreads];
+
+  std::fill(m_FixedBinNumberOfThreads, m_FixedBinNumberOfThreads + m_NumberOfHistogramBins, 0U);
+
+  unsigned int threadID;
+  for ( threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    SizeValueType firstSample;
+    SizeValueType numberOfSamples;
+    this->GetThreadSampleRange(threadID, firstSample, numberOfSamples);
+
+    if ( numberOfSamples == 0 )
+      {
+      m_ThreaderFirstFixedBin[threadID] = 0;
+      m_ThreaderLastFixedBin[threadID] = -1;
+      continue;
+      }
+
+    m_ThreaderFirstFixedBin[threadID] =
+      this->m_FixedImageSamples[firstSample].valueIndex;
+    m_ThreaderLastFixedBin[threadID] =
+      this->m_FixedImageSamples[firstSample + numberOfSamples - 1].valueIndex;
+    for ( int bin = m_ThreaderFirstFixedBin[threadID];
+          bin <= m_ThreaderLastFixedBin[threadID];
+          bin++ )
+      {
+      ++m_FixedBinNumberOfThreads[bin];
+      }
+    }
+
+  // Since the samples are sorted, only the first and last bins of a thread
+  // may contain samples of other threads.
+  for ( threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    const int firstBin = m_ThreaderFirstFixedBin[threadID];
+    const int lastBin = m_ThreaderLastFixedBin[threadID];
+
+    m_ThreaderFirstSharedFixedBin[threadID] = -1;
+    m_ThreaderLastSharedFixedBin[threadID] = -1;
+    if ( firstBin > lastBin )
+      {
+      continue;
+      }
+    if ( m_FixedBinNumberOfThreads[firstBin] > 1 )
+      {
+      m_ThreaderFirstSharedFixedBin[threadID] = firstBin;
+      }
+    if ( lastBin != firstBin && m_FixedBinNumberOfThreads[lastBin] > 1 )
+      {
+      m_ThreaderLastSharedFixedBin[threadID] = lastBin;
+      }
+    }
+}
+
 /**
  * Uniformly sample the fixed image domain using a random walk
  */
@@ -760,6 +929,12 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValueAndDerivativeThreadPreProcess( unsigned int threadID,
                                          bool itkNotUsed(withinSampleThread) ) const
 {
+  if ( this->m_ImplicitDerivativesSecondPass )
+    {
+    // the joint PDF computed by the first pass is kept
+    return;
+    }
+
   if ( threadID > 0 )
     {
     memset(m_ThreaderJointPDF[threadID - 1]->GetBufferPointer(),
@@ -770,13 +945,6 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
                                                * m_NumberOfHistogramBins] ),
             0,
             m_NumberOfHistogramBins * sizeof( PDFValueType ) );
-
-    if ( this->m_UseExplicitPDFDerivatives )
-      {
-      memset(m_ThreaderJointPDFDerivatives[threadID - 1]->GetBufferPointer(),
-             0,
-             m_JointPDFDerivativesBufferSize);
-      }
     }
   else
     {
@@ -786,12 +954,39 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     memset( m_FixedImageMarginalPDF,
             0,
             m_NumberOfHistogramBins * sizeof( PDFValueType ) );
+    }
 
-    if ( this->m_UseExplicitPDFDerivatives )
+  if ( this->m_UseExplicitPDFDerivatives )
+    {
+    // Each thread clears the rows it writes: the rows of the bins which
+    // only contain its samples, and its buffers for the shared bins. The
+    // rows of the shared bins are set after the threads are done.
+    const SizeValueType rowSize = m_JointPDFDerivatives->GetOffsetTable()[2];
+    const int           firstSharedBin = m_ThreaderFirstSharedFixedBin[threadID];
+    const int           lastSharedBin = m_ThreaderLastSharedFixedBin[threadID];
+
+    for ( int bin = m_ThreaderFirstFixedBin[threadID];
+          bin <= m_ThreaderLastFixedBin[threadID];
+          bin++ )
       {
-      memset(m_JointPDFDerivatives->GetBufferPointer(),
+      if ( bin != firstSharedBin && bin != lastSharedBin )
+        {
+        memset(m_JointPDFDerivatives->GetBufferPointer() + bin * rowSize,
+               0,
+               rowSize * sizeof( JointPDFDerivativesValueType ) );
+        }
+      }
+    if ( firstSharedBin >= 0 )
+      {
+      memset(m_ThreaderSharedJointPDFDerivatives + 2 * threadID * rowSize,
              0,
-             m_JointPDFDerivativesBufferSize);
+             rowSize * sizeof( JointPDFDerivativesValueType ) );
+      }
+    if ( lastSharedBin >= 0 )
+      {
+      memset(m_ThreaderSharedJointPDFDerivatives + ( 2 * threadID + 1 ) * rowSize,
+             0,
+             rowSize * sizeof( JointPDFDerivativesValueType ) );
       }
     }
 }
@@ -820,11 +1015,11 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     return false;
     }
 
-  unsigned int fixedImageParzenWindowIndex =
+  const unsigned int fixedImageParzenWindowIndex =
     this->m_FixedImageSamples[fixedImageSample].valueIndex;
 
   // Determine parzen window arguments (see eqn 6 of Mattes paper [2]).
-  double movingImageParzenWindowTerm = movingImageValue
+  const double movingImageParzenWindowTerm = movingImageValue
                                        / m_MovingImageBinSize
                                        - m_MovingImageNormalizedMin;
   OffsetValueType movingImageParzenWindowIndex =
@@ -845,6 +1040,30 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       }
     }
 
+  // Move to the first affected bin
+  int       pdfMovingIndex = static_cast< int >( movingImageParzenWindowIndex ) - 1;
+  const int pdfMovingIndexMax = static_cast< int >( movingImageParzenWindowIndex ) + 2;
+
+  double movingImageParzenWindowArg = static_cast< double >( pdfMovingIndex )
+                                      - movingImageParzenWindowTerm;
+
+  if ( this->m_ImplicitDerivativesSecondPass )
+    {
+    // The joint PDF has been computed by the first pass: only the
+    // contributions to the derivative are accumulated.
+    while ( pdfMovingIndex <= pdfMovingIndexMax )
+      {
+      this->ComputePDFDerivatives(threadID,
+                                  fixedImageSample,
+                                  pdfMovingIndex,
+                                  movingImageGradientValue,
+                                  m_CubicBSplineDerivativeKernel->Evaluate(movingImageParzenWindowArg) );
+      movingImageParzenWindowArg += 1;
+      ++pdfMovingIndex;
+      }
+    return true;
+    }
+
   // Since a zero-order BSpline (box car) kernel is used for
   // the fixed image marginal pdf, we need only increment the
   // fixedImageParzenWindowIndex by value of 1.0.
@@ -888,12 +1107,7 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     }
 
   // Move the pointer to the fist affected bin
-  int pdfMovingIndex = static_cast< int >( movingImageParzenWindowIndex ) - 1;
   pdfPtr += pdfMovingIndex;
-  const int pdfMovingIndexMax = static_cast< int >( movingImageParzenWindowIndex ) + 2;
-
-  double movingImageParzenWindowArg = static_cast< double >( pdfMovingIndex )
-                                      - static_cast< double >( movingImageParzenWindowTerm );
 
   while ( pdfMovingIndex <= pdfMovingIndexMax )
     {
@@ -901,7 +1115,7 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
                                                   ->Evaluate(
                                                     movingImageParzenWindowArg) );
 
-    if ( this->m_UseExplicitPDFDerivatives || this->m_ImplicitDerivativesSecondPass )
+    if ( this->m_UseExplicitPDFDerivatives )
       {
       // Compute the cubicBSplineDerivative for later repeated use.
       const double cubicBSplineDerivativeValue =
@@ -928,40 +1142,84 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValueAndDerivativeThreadPostProcess(unsigned int threadID,
                                          bool withinSampleThread) const
 {
+  if ( this->m_ImplicitDerivativesSecondPass )
+    {
+    // Add the derivatives of the threads for a range of the parameters,
+    // always in the order of the threads.
+    const unsigned int firstParameter = static_cast< unsigned int >(
+      static_cast< SizeValueType >( threadID ) * this->m_NumberOfParameters / this->m_NumberOfThreads );
+    const unsigned int endParameter = static_cast< unsigned int >(
+      static_cast< SizeValueType >( threadID + 1 ) * this->m_NumberOfParameters / this->m_NumberOfThreads );
+    for ( unsigned int t = 0; t < this->m_NumberOfThreads - 1; t++ )
+      {
+      const DerivativeType & source = this->m_ThreaderMetricDerivative[t];
+      for ( unsigned int pp = firstParameter; pp < endParameter; pp++ )
+        {
+        this->m_MetricDerivative[pp] += source[pp];
+        }
+      }
+    return;
+    }
+
   this->GetValueThreadPostProcess(threadID, withinSampleThread);
 
   if ( this->m_UseExplicitPDFDerivatives )
     {
-    const unsigned int rowSize = this->m_NumberOfParameters * m_NumberOfHistogramBins;
+    const SizeValueType rowSize = m_JointPDFDerivatives->GetOffsetTable()[2];
 
-    const unsigned int maxI =
-      rowSize * ( m_ThreaderJointPDFEndBin[threadID]
-                  - m_ThreaderJointPDFStartBin[threadID] + 1 );
-
-    JointPDFDerivativesValueType *const pdfDPtrStart = m_JointPDFDerivatives->GetBufferPointer()
-                   + ( m_ThreaderJointPDFStartBin[threadID] * rowSize );
-    const unsigned int tPdfDPtrOffset = m_ThreaderJointPDFStartBin[threadID] *  rowSize;
-    for ( unsigned int t = 0; t < this->m_NumberOfThreads - 1; t++ )
+    // The rows of the bins which contain the samples of one thread have
+    // been written by this thread. The rows of the shared bins are the
+    // sums of the buffers of the threads, and the other rows are zero.
+    for ( int bin = m_ThreaderJointPDFStartBin[threadID];
+          bin <= m_ThreaderJointPDFEndBin[threadID];
+          bin++ )
       {
-      JointPDFDerivativesValueType *pdfDPtr = pdfDPtrStart;
-      JointPDFDerivativesValueType const *tPdfDPtr = m_ThreaderJointPDFDerivatives[t]->GetBufferPointer() + tPdfDPtrOffset;
-      JointPDFDerivativesValueType const * const tPdfDPtrEnd = tPdfDPtr + maxI;
-      // for(i = 0; i < maxI; i++)
-      while ( tPdfDPtr < tPdfDPtrEnd )
+      if ( m_FixedBinNumberOfThreads[bin] == 1 )
+        {
+        continue;
+        }
+
+      JointPDFDerivativesValueType *const pdfDPtrStart =
+        m_JointPDFDerivatives->GetBufferPointer() + bin * rowSize;
+      memset( pdfDPtrStart, 0, rowSize * sizeof( JointPDFDerivativesValueType ) );
+
+      for ( unsigned int t = 0; t < this->m_NumberOfThreads; t++ )
         {
-        *( pdfDPtr++ ) += *( tPdfDPtr++ );
+        JointPDFDerivativesValueType const *tPdfDPtr;
+        if ( m_ThreaderFirstSharedFixedBin[t] == bin )
+          {
+          tPdfDPtr = m_ThreaderSharedJointPDFDerivatives + 2 * t * rowSize;
+          }
+        else if ( m_ThreaderLastSharedFixedBin[t] == bin )
+          {
+          tPdfDPtr = m_ThreaderSharedJointPDFDerivatives + ( 2 * t + 1 ) * rowSize;
+          }
+        else
+          {
+          continue;
+          }
+        JointPDFDerivativesValueType *pdfDPtr = pdfDPtrStart;
+        JointPDFDerivativesValueType const * const tPdfDPtrEnd = tPdfDPtr + rowSize;
+        while ( tPdfDPtr < tPdfDPtrEnd )
+          {
+          *( pdfDPtr++ ) += *( tPdfDPtr++ );
+          }
         }
       }
 
     const double nFactor = 1.0 / ( m_MovingImageBinSize
                              * this->m_NumberOfPixelsCounted );
 
-    JointPDFDerivativesValueType *pdfDPtr = pdfDPtrStart;
-    JointPDFDerivativesValueType const * const tPdfDPtrEnd = pdfDPtrStart + maxI;
-    //for(int i = 0; i < maxI; i++)
-    while ( pdfDPtr < tPdfDPtrEnd )
+    const int numberOfBins = m_ThreaderJointPDFEndBin[threadID] - m_ThreaderJointPDFStartBin[threadID] + 1;
+    if ( numberOfBins > 0 )
       {
-      *( pdfDPtr++ ) *= nFactor;
+      JointPDFDerivativesValueType *pdfDPtr = m_JointPDFDerivatives->GetBufferPointer()
+                                              + m_ThreaderJointPDFStartBin[threadID] * rowSize;
+      JointPDFDerivativesValueType const * const tPdfDPtrEnd = pdfDPtr + numberOfBins * rowSize;
+      while ( pdfDPtr < tPdfDPtrEnd )
+        {
+        *( pdfDPtr++ ) *= nFactor;
+        }
       }
     }
 }
@@ -1125,19 +1383,11 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     // MUST BE CALLED TO INITIATE PROCESSING ON SAMPLES
     this->GetValueAndDerivativeMultiThreadedInitiate();
 
-    // CALL IF DOING THREADED POST PROCESSING
+    // CALL IF DOING THREADED POST PROCESSING: consolidate the contributions
+    // from each one of the threads to the total derivative.
     this->GetValueAndDerivativeMultiThreadedPostProcessInitiate();
 
-    // Consolidate the contributions from each one of the threads to the total
-    // derivative.
-    for ( unsigned int t = 0; t < this->m_NumberOfThreads - 1; t++ )
-      {
-      DerivativeType const * const source = &( this->m_ThreaderMetricDerivative[t] );
-      for ( unsigned int pp = 0; pp < this->m_NumberOfParameters; pp++ )
-        {
-        this->m_MetricDerivative[pp] += ( *source )[pp];
-        }
-      }
+    this->m_ImplicitDerivativesSecondPass = false;
 
     derivative = this->m_MetricDerivative;
     }
@@ -1184,18 +1434,22 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 
   if ( this->m_UseExplicitPDFDerivatives )
     {
-    if ( threadID > 0 )
+    // The rows of the bins shared with other threads are accumulated in
+    // the buffers of the thread.
+    const SizeValueType rowSize = m_JointPDFDerivatives->GetOffsetTable()[2];
+    if ( pdfFixedIndex == m_ThreaderFirstSharedFixedBin[threadID] )
+      {
+      derivPtr = m_ThreaderSharedJointPDFDerivatives + 2 * threadID * rowSize;
+      }
+    else if ( pdfFixedIndex == m_ThreaderLastSharedFixedBin[threadID] )
       {
-      derivPtr = m_ThreaderJointPDFDerivatives[threadID - 1]->GetBufferPointer()
-                 + ( pdfFixedIndex  * m_JointPDFDerivatives->GetOffsetTable()[2] )
-                 + ( pdfMovingIndex * m_JointPDFDerivatives->GetOffsetTable()[1] );
+      derivPtr = m_ThreaderSharedJointPDFDerivatives + ( 2 * threadID + 1 ) * rowSize;
       }
     else
       {
-      derivPtr = m_JointPDFDerivatives->GetBufferPointer()
-                 + ( pdfFixedIndex  * m_JointPDFDerivatives->GetOffsetTable()[2] )
-                 + ( pdfMovingIndex * m_JointPDFDerivatives->GetOffsetTable()[1] );
+      derivPtr = m_JointPDFDerivatives->GetBufferPointer() + pdfFixedIndex * rowSize;
       }
+    derivPtr += pdfMovingIndex * m_JointPDFDerivatives->GetOffsetTable()[1];
     }
   else
     {
@@ -1239,23 +1493,26 @@ MattesMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       transform = this->m_Transform;
       }
 
-    const JacobianType & jacobian =
-      transform->GetJacobian(this->m_FixedImageSamples[sampleNumber].point);
+    // Only the parameters which may have a non zero derivative are visited.
+    JacobianType &               jacobian = this->m_ThreaderJacobian[threadID];
+    NonZeroJacobianIndicesType & nonZeroJacobianIndices = this->m_ThreaderNonZeroJacobianIndices[threadID];
+    transform->GetSparseJacobian(this->m_FixedImageSamples[sampleNumber].point,
+                                 jacobian, nonZeroJacobianIndices);
 
-    for ( unsigned int mu = 0; mu < this->m_NumberOfParameters; mu++ )
+    for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
       {
       double innerProduct = 0.0;
       for ( unsigned int dim = 0; dim < Superclass::FixedImageDimension; dim++ )
         {
-        innerProduct += jacobian[dim][mu] * movingImageGradientValue[dim];
+        innerProduct += jacobian[dim][k] * movingImageGradientValue[dim];
         }
 
-      const double derivativeContribution = innerProduct * cubicBSplineDerivativeValue;
+      const double       derivativeContribution = innerProduct * cubicBSplineDerivativeValue;
+      const unsigned int mu = nonZeroJacobianIndices[k];
 
       if ( this->m_UseExplicitPDFDerivatives )
         {
-        *( derivPtr ) -= derivativeContribution;
-        ++derivPtr;
+        derivPtr[mu] -= derivativeContribution;
         }
       else
         {
@@ -39,6 +39,10 @@ namespace itk
  * on it. Values at these non-grid position of the Fixed image are interpolated
  * using a user-selected Interpolator.
  *
+ * The value is accumulated over the samples of the fixed image by several
+ * threads. The derivative is computed by finite differences of the value.
+ * By default all the pixels of the fixed image region are used.
+ *
  * \ingroup RegistrationMetrics
  * \ingroup ITK-RegistrationCommon
  */
@@ -74,6 +78,12 @@ public:
   typedef typename Superclass::MovingImageType         MovingImageType;
   typedef typename Superclass::FixedImageConstPointer  FixedImageConstPointer;
   typedef typename Superclass::MovingImageConstPointer MovingImageConstPointer;
+  typedef typename Superclass::MovingImagePointType    MovingImagePointType;
+
+  /** Initialize the metric, and allocate the sums accumulated by each
+   * thread. */
+  virtual void Initialize(void)
+  throw ( ExceptionObject );
 
   /** Get the derivatives of the match measure. */
   void GetDerivative(const TransformParametersType & parameters,
@@ -97,7 +107,7 @@ public:
   itkSetMacro(Delta, double);
 protected:
   MeanReciprocalSquareDifferenceImageToImageMetric();
-  virtual ~MeanReciprocalSquareDifferenceImageToImageMetric() {}
+  virtual ~MeanReciprocalSquareDifferenceImageToImageMetric();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
 private:
@@ -108,8 +118,15 @@ private:
                                                                   // not
                                                                   // implemented
 
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          SizeValueType fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
   double m_Lambda;
   double m_Delta;
+
+  MeasureType *m_ThreaderMeasure;
 };
 } // end namespace itk
 
@@ -66,6 +66,7 @@ public:
   typedef typename Superclass::TransformPointer        TransformPointer;
   typedef typename Superclass::TransformParametersType TransformParametersType;
   typedef typename Superclass::TransformJacobianType   TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::InputPointType          InputPointType;
   typedef typename Superclass::OutputPointType         OutputPointType;
   typedef typename Superclass::GradientPixelType       GradientPixelType;
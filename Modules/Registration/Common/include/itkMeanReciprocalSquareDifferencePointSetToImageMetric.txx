@@ -135,6 +135,10 @@ MeanReciprocalSquareDifferencePointSetToImageMetric< TFixedPointSet, TMovingImag
   PointDataIterator pointDataItr = fixedPointSet->GetPointData()->Begin();
   PointDataIterator pointDataEnd = fixedPointSet->GetPointData()->End();
 
+  // buffers for the part of the Jacobian which may be non zero
+  TransformJacobianType      jacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+
   while ( pointItr != pointEnd && pointDataItr != pointDataEnd )
     {
     InputPointType inputPoint;
@@ -152,8 +156,7 @@ MeanReciprocalSquareDifferencePointSetToImageMetric< TFixedPointSet, TMovingImag
       const RealType diffSquared = diff * diff;
 
       // Now compute the derivatives
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
+      this->m_Transform->GetSparseJacobian(inputPoint, jacobian, nonZeroJacobianIndices);
 
       // Get the gradient by NearestNeighboorInterpolation:
       // which is equivalent to round up the point components.
@@ -170,14 +173,15 @@ MeanReciprocalSquareDifferencePointSetToImageMetric< TFixedPointSet, TMovingImag
       const GradientPixelType gradient =
         this->GetGradientImage()->GetPixel(mappedIndex);
 
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
+      for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
         {
+        const unsigned int par = nonZeroJacobianIndices[k];
         RealType sum = NumericTraits< RealType >::Zero;
         for ( unsigned int dim = 0; dim < Self::FixedPointSetDimension; dim++ )
           {
           //Will it be computationally more efficient to instead calculate the
           //derivative using finite differences ?
-          sum -= jacobian(dim, par)
+          sum -= jacobian(dim, k)
                  * gradient[dim] / ( vcl_pow(lambdaSquared + diffSquared, 2) );
           }
         derivative[par] += diff * sum;
@@ -240,6 +244,10 @@ MeanReciprocalSquareDifferencePointSetToImageMetric< TFixedPointSet, TMovingImag
   PointDataIterator pointDataItr = fixedPointSet->GetPointData()->Begin();
   PointDataIterator pointDataEnd = fixedPointSet->GetPointData()->End();
 
+  // buffers for the part of the Jacobian which may be non zero
+  TransformJacobianType      jacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+
   while ( pointItr != pointEnd && pointDataItr != pointDataEnd )
     {
     InputPointType inputPoint;
@@ -255,8 +263,7 @@ MeanReciprocalSquareDifferencePointSetToImageMetric< TFixedPointSet, TMovingImag
       this->m_NumberOfPixelsCounted++;
 
       // Now compute the derivatives
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
+      this->m_Transform->GetSparseJacobian(inputPoint, jacobian, nonZeroJacobianIndices);
 
       const RealType diff = movingValue - fixedValue;
       const RealType diffSquared = diff * diff;
@@ -277,12 +284,13 @@ MeanReciprocalSquareDifferencePointSetToImageMetric< TFixedPointSet, TMovingImag
       const GradientPixelType gradient =
         this->GetGradientImage()->GetPixel(mappedIndex);
 
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
+      for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
         {
+        const unsigned int par = nonZeroJacobianIndices[k];
         RealType sum = NumericTraits< RealType >::Zero;
         for ( unsigned int dim = 0; dim < Self::FixedPointSetDimension; dim++ )
           {
-          sum -= jacobian(dim, par) * gradient[dim]
+          sum -= jacobian(dim, k) * gradient[dim]
                  * vcl_pow(lambdaSquared + diffSquared, 2);
           }
         derivative[par] += diff * sum;
@@ -201,17 +201,19 @@ MeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
     }
 
   // Jacobian should be evaluated at the unmapped (fixed image) point.
-  const TransformJacobianType & jacobian = transform
-                                           ->GetJacobian(fixedImagePoint);
+  // Only the parameters which may have a non zero derivative are visited.
+  TransformJacobianType &      jacobian = this->m_ThreaderJacobian[threadID];
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices = this->m_ThreaderNonZeroJacobianIndices[threadID];
+  transform->GetSparseJacobian(fixedImagePoint, jacobian, nonZeroJacobianIndices);
 
-  for ( unsigned int par = 0; par < this->m_NumberOfParameters; par++ )
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
     {
     double sum = 0.0;
     for ( unsigned int dim = 0; dim < MovingImageDimension; dim++ )
       {
-      sum += 2.0 *diff *jacobian(dim, par) * movingImageGradientValue[dim];
+      sum += 2.0 *diff *jacobian(dim, k) * movingImageGradientValue[dim];
       }
-    m_ThreaderMSEDerivatives[threadID][par] += sum;
+    m_ThreaderMSEDerivatives[threadID][nonZeroJacobianIndices[k]] += sum;
     }
 
   return true;
@@ -129,6 +129,10 @@ MeanSquaresPointSetToImageMetric< TFixedPointSet, TMovingImage >
   PointDataIterator pointDataItr = fixedPointSet->GetPointData()->Begin();
   PointDataIterator pointDataEnd = fixedPointSet->GetPointData()->End();
 
+  // buffers for the part of the Jacobian which may be non zero
+  TransformJacobianType      jacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+
   while ( pointItr != pointEnd && pointDataItr != pointDataEnd )
     {
     InputPointType inputPoint;
@@ -145,8 +149,7 @@ MeanSquaresPointSetToImageMetric< TFixedPointSet, TMovingImage >
       const RealType diff = movingValue - fixedValue;
 
       // Now compute the derivatives
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
+      this->m_Transform->GetSparseJacobian(inputPoint, jacobian, nonZeroJacobianIndices);
 
       // Get the gradient by NearestNeighboorInterpolation:
       // which is equivalent to round up the point components.
@@ -163,12 +166,13 @@ MeanSquaresPointSetToImageMetric< TFixedPointSet, TMovingImage >
       const GradientPixelType gradient =
         this->GetGradientImage()->GetPixel(mappedIndex);
 
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
+      for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
         {
+        const unsigned int par = nonZeroJacobianIndices[k];
         RealType sum = NumericTraits< RealType >::Zero;
         for ( unsigned int dim = 0; dim < Self::FixedPointSetDimension; dim++ )
           {
-          sum += 2.0 *diff *jacobian(dim, par) * gradient[dim];
+          sum += 2.0 *diff *jacobian(dim, k) * gradient[dim];
           }
         derivative[par] += sum;
         }
@@ -229,6 +233,10 @@ MeanSquaresPointSetToImageMetric< TFixedPointSet, TMovingImage >
   PointDataIterator pointDataItr = fixedPointSet->GetPointData()->Begin();
   PointDataIterator pointDataEnd = fixedPointSet->GetPointData()->End();
 
+  // buffers for the part of the Jacobian which may be non zero
+  TransformJacobianType      jacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+
   while ( pointItr != pointEnd && pointDataItr != pointDataEnd )
     {
     InputPointType inputPoint;
@@ -244,8 +252,7 @@ MeanSquaresPointSetToImageMetric< TFixedPointSet, TMovingImage >
       this->m_NumberOfPixelsCounted++;
 
       // Now compute the derivatives
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
+      this->m_Transform->GetSparseJacobian(inputPoint, jacobian, nonZeroJacobianIndices);
 
       const RealType diff = movingValue - fixedValue;
 
@@ -266,12 +273,13 @@ MeanSquaresPointSetToImageMetric< TFixedPointSet, TMovingImage >
       const GradientPixelType gradient =
         this->GetGradientImage()->GetPixel(mappedIndex);
 
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
+      for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
         {
+        const unsigned int par = nonZeroJacobianIndices[k];
         RealType sum = NumericTraits< RealType >::Zero;
         for ( unsigned int dim = 0; dim < Self::FixedPointSetDimension; dim++ )
           {
-          sum += 2.0 *diff *jacobian(dim, par) * gradient[dim];
+          sum += 2.0 *diff *jacobian(dim, k) * gradient[dim];
           }
         derivative[par] += sum;
         }
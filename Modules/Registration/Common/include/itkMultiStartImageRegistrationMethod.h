@@ -0,0 +1,292 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiStartImageRegistrationMethod_h
+#define __itkMultiStartImageRegistrationMethod_h
+
+#include "itkImageToImageMetric.h"
+#include "itkSingleValuedNonLinearOptimizer.h"
+#include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include <vector>
+#include <string>
+
+namespace itk
+{
+/** \class MultiStartImageRegistrationMethod
+ * \brief Run several registrations from different initial parameters
+ * concurrently and rank their results.
+ *
+ * Each start is a complete set of registration components (metric,
+ * optimizer, transform and interpolator) with its own initial transform
+ * parameters, added with AddStart(). The components of a start must not
+ * be shared with another start since the starts are optimized by
+ * concurrent threads. The fixed and moving images, and their
+ * multi-resolution pyramids when NumberOfLevels is greater than one, are
+ * computed once and shared read-only by all the starts.
+ *
+ * At each resolution level, the metrics of the remaining starts are
+ * initialized one after the other with the same seed of the random
+ * number generator, so that they all use the same samples of the fixed
+ * image and their values can be compared. The optimizers are then run
+ * by a pool of threads, each thread taking the next start to optimize
+ * until none is left. The threads of the multithreader are divided
+ * between the starts optimized concurrently and the threads of their
+ * metric. When a metric draws new samples from the shared random number
+ * generator at each evaluation, like MutualInformationImageToImageMetric,
+ * the starts are instead optimized one after the other in the calling
+ * thread, each one from the same seed, and their metric uses all the
+ * threads.
+ *
+ * After each level except the last one, the starts are ranked by the
+ * value of their metric and only the FractionOfStartsKept best ones are
+ * optimized at the next level, from the parameters found at this level.
+ * A start which throws an exception is discarded.
+ *
+ * The results are ranked by the number of levels the starts completed,
+ * and then by the value of their metric, the best one first. The metric
+ * is minimized unless Maximize is on, as it must be for the optimizers.
+ *
+ * \sa MultiResolutionImageRegistrationMethod
+ * \ingroup RegistrationFilters
+ * \ingroup ITK-RegistrationCommon
+ */
+template< typename TFixedImage, typename TMovingImage >
+class ITK_EXPORT MultiStartImageRegistrationMethod:public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiStartImageRegistrationMethod Self;
+  typedef Object                            Superclass;
+  typedef SmartPointer< Self >              Pointer;
+  typedef SmartPointer< const Self >        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiStartImageRegistrationMethod, Object);
+
+  /**  Type of the Fixed image. */
+  typedef          TFixedImage                  FixedImageType;
+  typedef typename FixedImageType::ConstPointer FixedImageConstPointer;
+  typedef typename FixedImageType::RegionType   FixedImageRegionType;
+
+  /**  Type of the Moving image. */
+  typedef          TMovingImage                  MovingImageType;
+  typedef typename MovingImageType::ConstPointer MovingImageConstPointer;
+
+  /**  Type of the metric. */
+  typedef ImageToImageMetric< FixedImageType, MovingImageType > MetricType;
+  typedef typename MetricType::Pointer                          MetricPointer;
+  typedef typename MetricType::MeasureType                      MeasureType;
+
+  /**  Type of the Transform . */
+  typedef typename MetricType::TransformType TransformType;
+  typedef typename TransformType::Pointer    TransformPointer;
+
+  /**  Type of the Interpolator. */
+  typedef typename MetricType::InterpolatorType InterpolatorType;
+  typedef typename InterpolatorType::Pointer    InterpolatorPointer;
+
+  /**  Type of the optimizer. */
+  typedef SingleValuedNonLinearOptimizer OptimizerType;
+  typedef OptimizerType::Pointer         OptimizerPointer;
+
+  /** Type of the Fixed image multiresolution pyramid. */
+  typedef MultiResolutionPyramidImageFilter< FixedImageType, FixedImageType > FixedImagePyramidType;
+  typedef typename FixedImagePyramidType::Pointer                             FixedImagePyramidPointer;
+
+  /** Type of pyramid schedule type */
+  typedef typename FixedImagePyramidType::ScheduleType ScheduleType;
+
+  /** Type of the moving image multiresolution pyramid. */
+  typedef MultiResolutionPyramidImageFilter< MovingImageType, MovingImageType > MovingImagePyramidType;
+  typedef typename MovingImagePyramidType::Pointer                              MovingImagePyramidPointer;
+
+  /** Type of the Transformation parameters This is the same type used to
+   *  represent the search space of the optimization algorithm */
+  typedef  typename MetricType::TransformParametersType ParametersType;
+
+  /** Method that initiates the registration of all the starts. */
+  void StartRegistration();
+
+  /** Set/Get the Fixed image. */
+  itkSetConstObjectMacro(FixedImage, FixedImageType);
+  itkGetConstObjectMacro(FixedImage, FixedImageType);
+
+  /** Set/Get the Moving image. */
+  itkSetConstObjectMacro(MovingImage, MovingImageType);
+  itkGetConstObjectMacro(MovingImage, MovingImageType);
+
+  /** Set/Get the region of the fixed image at the finest level. The
+   * default is the buffered region of the fixed image. */
+  itkSetMacro(FixedImageRegion, FixedImageRegionType);
+  itkGetConstReferenceMacro(FixedImageRegion, FixedImageRegionType);
+
+  /** Set/Get the number of multi-resolution levels. The default is one,
+   * which registers the images without computing pyramids. */
+  itkSetClampMacro( NumberOfLevels, SizeValueType, 1, NumericTraits< SizeValueType >::max() );
+  itkGetConstMacro(NumberOfLevels, SizeValueType);
+
+  /** Get the current resolution level being processed. */
+  itkGetConstMacro(CurrentLevel, SizeValueType);
+
+  /** Set/Get the fraction of the starts optimized at a level which are
+   * optimized again at the next level. At least one start is kept. The
+   * default is 0.5. */
+  itkSetClampMacro(FractionOfStartsKept, double, 0.0, 1.0);
+  itkGetConstMacro(FractionOfStartsKept, double);
+
+  /** Set/Get whether the best start has the largest value of the metric.
+   * The default is off. */
+  itkSetMacro(Maximize, bool);
+  itkGetConstMacro(Maximize, bool);
+  itkBooleanMacro(Maximize);
+
+  /** Set/Get the seed of the random number generator used by the metrics
+   * to sample the fixed image. */
+  itkSetMacro(RandomSeed, int);
+  itkGetConstMacro(RandomSeed, int);
+
+  /** Set/Get the number of threads shared by the starts and their
+   * metrics. */
+  void SetNumberOfThreads(unsigned int numberOfThreads);
+
+  itkGetConstMacro(NumberOfThreads, unsigned int);
+
+  /** Add a start with its own components and initial transform
+   * parameters. */
+  void AddStart(MetricType *metric, OptimizerType *optimizer,
+                TransformType *transform, InterpolatorType *interpolator,
+                const ParametersType & initialParameters);
+
+  /** Remove all the starts and their results. */
+  void ClearStarts();
+
+  /** Get the number of starts added. */
+  unsigned int GetNumberOfStarts() const
+  {
+    return static_cast< unsigned int >( m_Starts.size() );
+  }
+
+  /** Get the number of starts which have a result after the
+   * registration, that is the starts which did not throw an exception. */
+  unsigned int GetNumberOfResults() const
+  {
+    return static_cast< unsigned int >( m_Ranking.size() );
+  }
+
+  /** Get the start with the given rank, the best one being 0. */
+  unsigned int GetResultStart(unsigned int rank) const;
+
+  /** Get the last transform parameters of the start with the given
+   * rank. */
+  const ParametersType & GetResultParameters(unsigned int rank) const;
+
+  /** Get the value of the metric for the start with the given rank, at
+   * the last level it completed. */
+  MeasureType GetResultValue(unsigned int rank) const;
+
+  /** Get the number of levels completed by the start with the given
+   * rank. */
+  SizeValueType GetResultNumberOfLevels(unsigned int rank) const;
+
+protected:
+  MultiStartImageRegistrationMethod();
+  virtual ~MultiStartImageRegistrationMethod() {}
+  void PrintSelf(std::ostream & os, Indent indent) const;
+
+  /** Compute the pyramids and the fixed image region of each level. */
+  void PreparePyramids(void);
+
+  /** Connect the components of the remaining starts to the images of
+   * the current level and initialize their metric. */
+  void InitializeStarts(void);
+
+  /** Optimize the remaining starts in threads. */
+  void OptimizeStarts(void);
+
+  /** Rank the starts and keep the best ones for the next level. */
+  void RankStarts(bool prune);
+
+private:
+  MultiStartImageRegistrationMethod(const Self &); //purposely not implemented
+  void operator=(const Self &);                    //purposely not implemented
+
+  /** The components, parameters and result of a start. */
+  struct StartType {
+    MetricPointer metric;
+    OptimizerPointer optimizer;
+    TransformPointer transform;
+    InterpolatorPointer interpolator;
+    ParametersType initialParameters;
+    ParametersType parameters;
+    MeasureType value;
+    SizeValueType numberOfLevels;
+    bool failed;
+    std::string error;
+  };
+
+  /** Optimize one start after the other until none is left. */
+  static ITK_THREAD_RETURN_TYPE OptimizeStartsThreaderCallback(void *arg);
+
+  /** Return true if the metric of a remaining start draws samples from
+   * the shared random number generator at each evaluation. */
+  bool MetricsDrawSamplesAtEachEvaluation(void) const;
+
+  /** Optimize a start and compute its value at the current level. */
+  void OptimizeStart(unsigned int start);
+
+  MovingImageConstPointer m_MovingImage;
+  FixedImageConstPointer  m_FixedImage;
+  FixedImageRegionType    m_FixedImageRegion;
+
+  MovingImagePyramidPointer m_MovingImagePyramid;
+  FixedImagePyramidPointer  m_FixedImagePyramid;
+
+  std::vector< FixedImageRegionType > m_FixedImageRegionPyramid;
+
+  SizeValueType m_NumberOfLevels;
+  SizeValueType m_CurrentLevel;
+  double        m_FractionOfStartsKept;
+  bool          m_Maximize;
+  int           m_RandomSeed;
+
+  std::vector< StartType > m_Starts;
+
+  /** The starts optimized at the current level. */
+  std::vector< unsigned int > m_RemainingStarts;
+
+  /** All the starts with a result, the best one first. */
+  std::vector< unsigned int > m_Ranking;
+
+  /** The next of the remaining starts to optimize. */
+  unsigned int        m_NextStart;
+  SimpleFastMutexLock m_NextStartLock;
+
+  MultiThreader::Pointer m_Threader;
+  unsigned int           m_NumberOfThreads;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiStartImageRegistrationMethod.txx"
+#endif
+
+#endif
@@ -0,0 +1,535 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiStartImageRegistrationMethod_txx
+#define __itkMultiStartImageRegistrationMethod_txx
+
+#include "itkMultiStartImageRegistrationMethod.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <algorithm>
+
+namespace itk
+{
+/*
+ * Constructor
+ */
+template< typename TFixedImage, typename TMovingImage >
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::MultiStartImageRegistrationMethod()
+{
+  m_FixedImage   = 0; // has to be provided by the user.
+  m_MovingImage  = 0; // has to be provided by the user.
+
+  m_NumberOfLevels = 1;
+  m_CurrentLevel = 0;
+  m_FractionOfStartsKept = 0.5;
+  m_Maximize = false;
+  m_RandomSeed = 121212;
+  m_NextStart = 0;
+
+  m_Threader = MultiThreader::New();
+  m_NumberOfThreads = m_Threader->GetNumberOfThreads();
+}
+
+/*
+ * Set the number of threads, clamped by the multithreader
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::SetNumberOfThreads(unsigned int numberOfThreads)
+{
+  m_Threader->SetNumberOfThreads(numberOfThreads);
+  if ( m_NumberOfThreads != static_cast< unsigned int >( m_Threader->GetNumberOfThreads() ) )
+    {
+    m_NumberOfThreads = m_Threader->GetNumberOfThreads();
+    this->Modified();
+    }
+}
+
+/*
+ * Add a start
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::AddStart(MetricType *metric, OptimizerType *optimizer,
+           TransformType *transform, InterpolatorType *interpolator,
+           const ParametersType & initialParameters)
+{
+  if ( !metric || !optimizer || !transform || !interpolator )
+    {
+    itkExceptionMacro(<< "A component of the start is not present");
+    }
+
+  if ( initialParameters.Size() != transform->GetNumberOfParameters() )
+    {
+    itkExceptionMacro(<< "Size mismatch between initial parameter and transform");
+    }
+
+  for ( unsigned int s = 0; s < m_Starts.size(); s++ )
+    {
+    if ( m_Starts[s].metric == metric || m_Starts[s].optimizer == optimizer
+         || m_Starts[s].transform == transform || m_Starts[s].interpolator == interpolator )
+      {
+      itkExceptionMacro(<< "A component of the start is shared with start " << s);
+      }
+    }
+
+  StartType start;
+  start.metric = metric;
+  start.optimizer = optimizer;
+  start.transform = transform;
+  start.interpolator = interpolator;
+  start.initialParameters = initialParameters;
+  start.parameters = initialParameters;
+  start.value = NumericTraits< MeasureType >::Zero;
+  start.numberOfLevels = 0;
+  start.failed = false;
+  m_Starts.push_back(start);
+
+  this->Modified();
+}
+
+/*
+ * Remove all the starts
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::ClearStarts()
+{
+  m_Starts.clear();
+  m_RemainingStarts.clear();
+  m_Ranking.clear();
+  this->Modified();
+}
+
+/*
+ * Compute the pyramids and the fixed image region of each level
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::PreparePyramids(void)
+{
+  // Sanity checks
+  if ( !m_FixedImage )
+    {
+    itkExceptionMacro(<< "FixedImage is not present");
+    }
+
+  if ( !m_MovingImage )
+    {
+    itkExceptionMacro(<< "MovingImage is not present");
+    }
+
+  // The default region is taken at each run, since the fixed image may
+  // have changed
+  FixedImageRegionType fixedImageRegion = m_FixedImageRegion;
+  if ( fixedImageRegion.GetNumberOfPixels() == 0 )
+    {
+    fixedImageRegion = m_FixedImage->GetBufferedRegion();
+    }
+
+  m_FixedImageRegionPyramid.resize(m_NumberOfLevels);
+
+  if ( m_NumberOfLevels == 1 )
+    {
+    // the images are registered at their resolution
+    m_FixedImagePyramid = 0;
+    m_MovingImagePyramid = 0;
+    m_FixedImageRegionPyramid[0] = fixedImageRegion;
+    return;
+    }
+
+  m_FixedImagePyramid = FixedImagePyramidType::New();
+  m_FixedImagePyramid->SetNumberOfLevels(m_NumberOfLevels);
+  m_FixedImagePyramid->SetInput(m_FixedImage);
+  m_FixedImagePyramid->UpdateLargestPossibleRegion();
+
+  m_MovingImagePyramid = MovingImagePyramidType::New();
+  m_MovingImagePyramid->SetNumberOfLevels(m_NumberOfLevels);
+  m_MovingImagePyramid->SetInput(m_MovingImage);
+  m_MovingImagePyramid->UpdateLargestPossibleRegion();
+
+  typedef typename FixedImageRegionType::SizeType  SizeType;
+  typedef typename FixedImageRegionType::IndexType IndexType;
+
+  const ScheduleType schedule = m_FixedImagePyramid->GetSchedule();
+
+  SizeType  inputSize  = fixedImageRegion.GetSize();
+  IndexType inputStart = fixedImageRegion.GetIndex();
+
+  // Same algorithm as the MultiResolutionImageRegistrationMethod,
+  // compatible with the ShrinkImageFilter.
+  for ( unsigned int level = 0; level < m_NumberOfLevels; level++ )
+    {
+    SizeType  size;
+    IndexType start;
+    for ( unsigned int dim = 0; dim < TFixedImage::ImageDimension; dim++ )
+      {
+      const float scaleFactor = static_cast< float >( schedule[level][dim] );
+
+      size[dim] = static_cast< typename SizeType::SizeValueType >(
+        vcl_floor(static_cast< float >( inputSize[dim] ) / scaleFactor) );
+      if ( size[dim] < 1 )
+        {
+        size[dim] = 1;
+        }
+
+      start[dim] = static_cast< typename IndexType::IndexValueType >(
+        vcl_ceil(static_cast< float >( inputStart[dim] ) / scaleFactor) );
+      }
+    m_FixedImageRegionPyramid[level].SetSize(size);
+    m_FixedImageRegionPyramid[level].SetIndex(start);
+    }
+}
+
+/*
+ * Connect the remaining starts to the images of the current level
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::InitializeStarts(void)
+{
+  const FixedImageType *fixedImage = m_FixedImage;
+  const MovingImageType *movingImage = m_MovingImage;
+  if ( m_FixedImagePyramid )
+    {
+    fixedImage = m_FixedImagePyramid->GetOutput(m_CurrentLevel);
+    movingImage = m_MovingImagePyramid->GetOutput(m_CurrentLevel);
+    }
+
+  // Divide the threads between the concurrent starts and their metric.
+  // The metrics which draw samples at each evaluation are optimized one
+  // after the other and get all the threads.
+  const unsigned int numberOfRemainingStarts =
+    static_cast< unsigned int >( m_RemainingStarts.size() );
+  const unsigned int numberOfConcurrentStarts =
+    this->MetricsDrawSamplesAtEachEvaluation() ? 1u :
+    vnl_math_min(m_NumberOfThreads, numberOfRemainingStarts);
+  const unsigned int numberOfMetricThreads =
+    vnl_math_max(1u, m_NumberOfThreads / vnl_math_max(1u, numberOfConcurrentStarts) );
+
+  for ( unsigned int r = 0; r < numberOfRemainingStarts; r++ )
+    {
+    StartType & start = m_Starts[m_RemainingStarts[r]];
+
+    start.metric->SetMovingImage(movingImage);
+    start.metric->SetFixedImage(fixedImage);
+    start.metric->SetTransform(start.transform);
+    start.metric->SetInterpolator(start.interpolator);
+    start.metric->SetFixedImageRegion(m_FixedImageRegionPyramid[m_CurrentLevel]);
+    start.metric->SetNumberOfThreads(numberOfMetricThreads);
+
+    start.transform->SetParameters(start.parameters);
+
+    // The random number generator is shared by the metrics: the same
+    // seed gives the same samples to all the starts.
+    Statistics::MersenneTwisterRandomVariateGenerator::GetInstance()->SetSeed(m_RandomSeed);
+    start.metric->Initialize();
+
+    start.optimizer->SetCostFunction(start.metric);
+    start.optimizer->SetInitialPosition(start.parameters);
+    }
+}
+
+/*
+ * Optimize the remaining starts in threads
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::OptimizeStarts(void)
+{
+  const unsigned int numberOfRemainingStarts =
+    static_cast< unsigned int >( m_RemainingStarts.size() );
+
+  if ( this->MetricsDrawSamplesAtEachEvaluation() )
+    {
+    // The starts would draw their samples concurrently from the shared
+    // random number generator: optimize them in this thread, each one
+    // from the same seed, so that the results do not depend on the order
+    // of the draws.
+    for ( unsigned int r = 0; r < numberOfRemainingStarts; r++ )
+      {
+      Statistics::MersenneTwisterRandomVariateGenerator::GetInstance()->SetSeed(m_RandomSeed);
+      this->OptimizeStart(m_RemainingStarts[r]);
+      }
+    return;
+    }
+
+  m_NextStart = 0;
+  m_Threader->SetNumberOfThreads( vnl_math_max( 1u, vnl_math_min(m_NumberOfThreads, numberOfRemainingStarts) ) );
+  m_Threader->SetSingleMethod(OptimizeStartsThreaderCallback, this);
+  m_Threader->SingleMethodExecute();
+  m_Threader->SetNumberOfThreads(m_NumberOfThreads);
+}
+
+template< typename TFixedImage, typename TMovingImage >
+ITK_THREAD_RETURN_TYPE
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::OptimizeStartsThreaderCallback(void *arg)
+{
+  Self *self = static_cast< Self * >(
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  const unsigned int numberOfRemainingStarts =
+    static_cast< unsigned int >( self->m_RemainingStarts.size() );
+  for (;; )
+    {
+    self->m_NextStartLock.Lock();
+    const unsigned int next = self->m_NextStart++;
+    self->m_NextStartLock.Unlock();
+
+    if ( next >= numberOfRemainingStarts )
+      {
+      break;
+      }
+    self->OptimizeStart(self->m_RemainingStarts[next]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/*
+ * Check whether a metric of the remaining starts draws samples at each
+ * evaluation
+ */
+template< typename TFixedImage, typename TMovingImage >
+bool
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::MetricsDrawSamplesAtEachEvaluation(void) const
+{
+  for ( unsigned int r = 0; r < m_RemainingStarts.size(); r++ )
+    {
+    if ( m_Starts[m_RemainingStarts[r]].metric->GetDrawsSamplesAtEachEvaluation() )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+/*
+ * Optimize a start. Only the components of this start are modified.
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::OptimizeStart(unsigned int s)
+{
+  StartType & start = m_Starts[s];
+
+  try
+    {
+    start.optimizer->StartOptimization();
+    start.parameters = start.optimizer->GetCurrentPosition();
+    start.transform->SetParameters(start.parameters);
+    start.value = start.metric->GetValue(start.parameters);
+    start.numberOfLevels = m_CurrentLevel + 1;
+    }
+  catch ( ExceptionObject & err )
+    {
+    start.failed = true;
+    start.error = err.GetDescription();
+    }
+  catch ( std::exception & err )
+    {
+    start.failed = true;
+    start.error = err.what();
+    }
+}
+
+/*
+ * Rank the starts and keep the best ones for the next level
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::RankStarts(bool prune)
+{
+  // Sort by the number of levels not completed, then by value
+  typedef std::pair< MeasureType, unsigned int >     ValueStartType;
+  typedef std::pair< SizeValueType, ValueStartType > KeyType;
+
+  std::vector< KeyType > keys;
+  for ( unsigned int s = 0; s < m_Starts.size(); s++ )
+    {
+    const StartType & start = m_Starts[s];
+    if ( start.failed )
+      {
+      continue;
+      }
+    const MeasureType value = m_Maximize ? -start.value : start.value;
+    keys.push_back( KeyType( m_NumberOfLevels - start.numberOfLevels,
+                             ValueStartType(value, s) ) );
+    }
+  std::sort( keys.begin(), keys.end() );
+
+  m_Ranking.resize( keys.size() );
+  for ( unsigned int r = 0; r < keys.size(); r++ )
+    {
+    m_Ranking[r] = keys[r].second.second;
+    }
+
+  // The starts which completed this level are ranked first
+  std::vector< unsigned int > remainingStarts;
+  for ( unsigned int r = 0; r < m_Ranking.size(); r++ )
+    {
+    if ( m_Starts[m_Ranking[r]].numberOfLevels == m_CurrentLevel + 1 )
+      {
+      remainingStarts.push_back(m_Ranking[r]);
+      }
+    }
+
+  if ( prune && !remainingStarts.empty() )
+    {
+    const unsigned int numberOfKeptStarts = vnl_math_max( 1u, static_cast< unsigned int >(
+        vcl_ceil( m_FractionOfStartsKept * remainingStarts.size() ) ) );
+    if ( numberOfKeptStarts < remainingStarts.size() )
+      {
+      remainingStarts.resize(numberOfKeptStarts);
+      }
+    }
+  m_RemainingStarts = remainingStarts;
+}
+
+/*
+ * Starts the Registration Process
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::StartRegistration(void)
+{
+  if ( m_Starts.empty() )
+    {
+    itkExceptionMacro(<< "No start is present");
+    }
+
+  this->PreparePyramids();
+
+  m_RemainingStarts.clear();
+  for ( unsigned int s = 0; s < m_Starts.size(); s++ )
+    {
+    StartType & start = m_Starts[s];
+    start.parameters = start.initialParameters;
+    start.value = NumericTraits< MeasureType >::Zero;
+    start.numberOfLevels = 0;
+    start.failed = false;
+    start.error = "";
+    m_RemainingStarts.push_back(s);
+    }
+  m_Ranking.clear();
+
+  this->InvokeEvent( StartEvent() );
+
+  for ( m_CurrentLevel = 0; m_CurrentLevel < m_NumberOfLevels; m_CurrentLevel++ )
+    {
+    this->InitializeStarts();
+    this->OptimizeStarts();
+    this->RankStarts(m_CurrentLevel < m_NumberOfLevels - 1);
+
+    // Invoke an iteration event after each level, with the starts ranked.
+    this->InvokeEvent( IterationEvent() );
+
+    if ( m_RemainingStarts.empty() )
+      {
+      break;
+      }
+    }
+
+  this->InvokeEvent( EndEvent() );
+
+  if ( m_Ranking.empty() )
+    {
+    itkExceptionMacro(<< "All the starts failed, the first one with: " << m_Starts[0].error);
+    }
+}
+
+/*
+ * Results
+ */
+template< typename TFixedImage, typename TMovingImage >
+unsigned int
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::GetResultStart(unsigned int rank) const
+{
+  if ( rank >= m_Ranking.size() )
+    {
+    itkExceptionMacro(<< "Rank " << rank << " is out of range [0," << m_Ranking.size() << ")");
+    }
+  return m_Ranking[rank];
+}
+
+template< typename TFixedImage, typename TMovingImage >
+const typename MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >::ParametersType &
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::GetResultParameters(unsigned int rank) const
+{
+  return m_Starts[this->GetResultStart(rank)].parameters;
+}
+
+template< typename TFixedImage, typename TMovingImage >
+typename MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >::MeasureType
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::GetResultValue(unsigned int rank) const
+{
+  return m_Starts[this->GetResultStart(rank)].value;
+}
+
+template< typename TFixedImage, typename TMovingImage >
+SizeValueType
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::GetResultNumberOfLevels(unsigned int rank) const
+{
+  return m_Starts[this->GetResultStart(rank)].numberOfLevels;
+}
+
+/*
+ * PrintSelf
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiStartImageRegistrationMethod< TFixedImage, TMovingImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "FixedImage: " << m_FixedImage.GetPointer() << std::endl;
+  os << indent << "MovingImage: " << m_MovingImage.GetPointer() << std::endl;
+  os << indent << "FixedImageRegion: " << m_FixedImageRegion << std::endl;
+  os << indent << "NumberOfLevels: " << m_NumberOfLevels << std::endl;
+  os << indent << "CurrentLevel: " << m_CurrentLevel << std::endl;
+  os << indent << "FractionOfStartsKept: " << m_FractionOfStartsKept << std::endl;
+  os << indent << "Maximize: " << m_Maximize << std::endl;
+  os << indent << "RandomSeed: " << m_RandomSeed << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfStarts: " << m_Starts.size() << std::endl;
+  for ( unsigned int r = 0; r < m_Ranking.size(); r++ )
+    {
+    const StartType & start = m_Starts[m_Ranking[r]];
+    os << indent << "Result " << r << ": start " << m_Ranking[r]
+       << ", value " << start.value << " after " << start.numberOfLevels
+       << " levels, parameters " << start.parameters << std::endl;
+    }
+}
+} // end namespace itk
+
+#endif
@@ -54,6 +54,11 @@ namespace itk
  * where the probability density distributions are estimated using
  * Parzen windows.
  *
+ * The samples are drawn in the calling thread. The sums over the pairs of
+ * samples are then computed in threads, each thread taking a range of the
+ * samples B, and the sums of the threads are added in the order of the
+ * threads.
+ *
  * By default a Gaussian kernel is used in the density estimation.
  * Other option include Cauchy and spline-based. A user can specify
  * the kernel passing in a pointer a KernelFunction using the
@@ -112,6 +117,7 @@ public:
   typedef typename Superclass::TransformType           TransformType;
   typedef typename Superclass::TransformPointer        TransformPointer;
   typedef typename Superclass::TransformJacobianType   TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::InterpolatorType        InterpolatorType;
   typedef typename Superclass::MeasureType             MeasureType;
   typedef typename Superclass::DerivativeType          DerivativeType;
@@ -189,6 +195,10 @@ public:
 
   void ReinitializeSeed(int);
 
+  /** The samples A and B are drawn at each evaluation. */
+  virtual bool GetDrawsSamplesAtEachEvaluation() const
+  { return true; }
+
 protected:
   MutualInformationImageToImageMetric();
   virtual ~MutualInformationImageToImageMetric() {}
@@ -245,6 +255,34 @@ public:
    */
   void CalculateDerivatives(const FixedImagePointType &, DerivativeType &) const;
 
+  /** Image derivatives of the samples, computed before the threads. */
+  typedef std::vector< DerivativeType > DerivativeContainer;
+
+  /** The data shared by the threads computing the sums, and the sums of
+   * each thread. */
+  struct ThreadStruct {
+    const Self *Metric;
+    const DerivativeContainer *SampleADerivatives;
+    const DerivativeContainer *SampleBDerivatives;
+    std::vector< double > LogSumFixed;
+    std::vector< double > LogSumMoving;
+    std::vector< double > LogSumJoint;
+    std::vector< DerivativeType > Derivative;
+  };
+
+  /** Compute the log sums over the samples B, and the derivative when the
+   * derivatives of the samples are provided, in threads. */
+  void ComputeSums(const DerivativeContainer *sampleADerivatives,
+                   const DerivativeContainer *sampleBDerivatives,
+                   double & logSumFixed, double & logSumMoving, double & logSumJoint,
+                   DerivativeType & derivative) const;
+
+  /** Compute the sums of a range of the samples B. */
+  void ThreadedComputeSums(ThreadStruct & str, unsigned int threadId,
+                           unsigned int numberOfThreads) const;
+
+  static ITK_THREAD_RETURN_TYPE ComputeSumsThreaderCallback(void *arg);
+
   typedef typename Superclass::CoordinateRepresentationType
   CoordinateRepresentationType;
   typedef CentralDifferenceImageFunction< MovingImageType,
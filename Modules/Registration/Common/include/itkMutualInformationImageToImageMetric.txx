@@ -213,43 +213,12 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   this->SampleFixedImageDomain(m_SampleB);
 
   // calculate the mutual information
-  double dLogSumFixed = 0.0;
-  double dLogSumMoving    = 0.0;
-  double dLogSumJoint  = 0.0;
-
-  typename SpatialSampleContainer::const_iterator aiter;
-  typename SpatialSampleContainer::const_iterator aend = m_SampleA.end();
-  typename SpatialSampleContainer::const_iterator biter;
-  typename SpatialSampleContainer::const_iterator bend = m_SampleB.end();
+  double         dLogSumFixed = 0.0;
+  double         dLogSumMoving    = 0.0;
+  double         dLogSumJoint  = 0.0;
+  DerivativeType derivative;
 
-  for ( biter = m_SampleB.begin(); biter != bend; ++biter )
-    {
-    double dSumFixed  = m_MinProbability;
-    double dSumMoving     = m_MinProbability;
-    double dSumJoint   = m_MinProbability;
-
-    for ( aiter = m_SampleA.begin(); aiter != aend; ++aiter )
-      {
-      double valueFixed;
-      double valueMoving;
-
-      valueFixed = ( ( *biter ).FixedImageValue - ( *aiter ).FixedImageValue )
-                   / m_FixedImageStandardDeviation;
-      valueFixed = m_KernelFunction->Evaluate(valueFixed);
-
-      valueMoving = ( ( *biter ).MovingImageValue - ( *aiter ).MovingImageValue )
-                    / m_MovingImageStandardDeviation;
-      valueMoving = m_KernelFunction->Evaluate(valueMoving);
-
-      dSumFixed += valueFixed;
-      dSumMoving += valueMoving;
-      dSumJoint += valueFixed * valueMoving;
-      } // end of sample A loop
-
-    dLogSumFixed -= ( dSumFixed > 0.0 ) ? vcl_log(dSumFixed) : 0.0;
-    dLogSumMoving -= ( dSumMoving > 0.0 ) ? vcl_log(dSumMoving) : 0.0;
-    dLogSumJoint -= ( dSumJoint > 0.0 ) ? vcl_log(dSumJoint) : 0.0;
-    } // end of sample B loop
+  this->ComputeSums(NULL, NULL, dLogSumFixed, dLogSumMoving, dLogSumJoint, derivative);
 
   double nsamp   = double(m_NumberOfSpatialSamples);
 
@@ -308,12 +277,16 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   typename SpatialSampleContainer::iterator biter;
   typename SpatialSampleContainer::const_iterator bend = m_SampleB.end();
 
-  // precalculate all the image derivatives for sample A
-  typedef std::vector< DerivativeType > DerivativeContainer;
+  // precalculate all the image derivatives for samples A and B, since
+  // the transform and the derivative calculator are not used by the
+  // threads
   DerivativeContainer sampleADerivatives;
   sampleADerivatives.resize(m_NumberOfSpatialSamples);
+  DerivativeContainer sampleBDerivatives;
+  sampleBDerivatives.resize(m_NumberOfSpatialSamples);
 
   typename DerivativeContainer::iterator aditer;
+  typename DerivativeContainer::iterator bditer;
   DerivativeType tempDeriv(numberOfParameters);
 
   for ( aiter = m_SampleA.begin(), aditer = sampleADerivatives.begin();
@@ -323,11 +296,120 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     this->CalculateDerivatives( ( *aiter ).FixedImagePointValue, tempDeriv );
     ( *aditer ) = tempDeriv;
     }
+  for ( biter = m_SampleB.begin(), bditer = sampleBDerivatives.begin();
+        biter != bend; ++biter, ++bditer )
+    {
+    this->CalculateDerivatives( ( *biter ).FixedImagePointValue, tempDeriv );
+    ( *bditer ) = tempDeriv;
+    }
 
-  DerivativeType derivB(numberOfParameters);
+  this->ComputeSums(&sampleADerivatives, &sampleBDerivatives,
+                    dLogSumFixed, dLogSumMoving, dLogSumJoint, derivative);
 
-  for ( biter = m_SampleB.begin(); biter != bend; ++biter )
+  double nsamp    = double(m_NumberOfSpatialSamples);
+
+  double threshold = -0.5 *nsamp *vcl_log(m_MinProbability);
+  if ( dLogSumMoving > threshold || dLogSumFixed > threshold
+       || dLogSumJoint > threshold  )
+    {
+    // at least half the samples in B did not occur within
+    // the Parzen window width of samples in A
+    itkExceptionMacro(<< "Standard deviation is too small");
+    }
+
+  value  = dLogSumFixed + dLogSumMoving - dLogSumJoint;
+  value /= nsamp;
+  value += vcl_log(nsamp);
+
+  derivative /= nsamp;
+  derivative /= vnl_math_sqr(m_MovingImageStandardDeviation);
+}
+
+/*
+ * Compute the sums over the samples in threads
+ */
+template< class TFixedImage, class TMovingImage  >
+void
+MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeSums(const DerivativeContainer *sampleADerivatives,
+              const DerivativeContainer *sampleBDerivatives,
+              double & logSumFixed, double & logSumMoving, double & logSumJoint,
+              DerivativeType & derivative) const
+{
+  const unsigned int numberOfThreads =
+    vnl_math_min(this->m_NumberOfThreads, m_NumberOfSpatialSamples);
+
+  ThreadStruct str;
+  str.Metric = this;
+  str.SampleADerivatives = sampleADerivatives;
+  str.SampleBDerivatives = sampleBDerivatives;
+  str.LogSumFixed.resize(numberOfThreads, 0.0);
+  str.LogSumMoving.resize(numberOfThreads, 0.0);
+  str.LogSumJoint.resize(numberOfThreads, 0.0);
+  if ( sampleADerivatives )
     {
+    DerivativeType zero( derivative.Size() );
+    zero.Fill(0.0);
+    str.Derivative.resize(numberOfThreads, zero);
+    }
+
+  this->m_Threader->SetNumberOfThreads(numberOfThreads);
+  this->m_Threader->SetSingleMethod(ComputeSumsThreaderCallback, &str);
+  this->m_Threader->SingleMethodExecute();
+  this->m_Threader->SetNumberOfThreads(this->m_NumberOfThreads);
+
+  // add the sums in the order of the threads
+  for ( unsigned int t = 0; t < numberOfThreads; t++ )
+    {
+    logSumFixed += str.LogSumFixed[t];
+    logSumMoving += str.LogSumMoving[t];
+    logSumJoint += str.LogSumJoint[t];
+    if ( sampleADerivatives )
+      {
+      derivative += str.Derivative[t];
+      }
+    }
+}
+
+template< class TFixedImage, class TMovingImage  >
+ITK_THREAD_RETURN_TYPE
+MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeSumsThreaderCallback(void *arg)
+{
+  const MultiThreader::ThreadInfoStruct *info =
+    static_cast< MultiThreader::ThreadInfoStruct * >( arg );
+  ThreadStruct *str = static_cast< ThreadStruct * >( info->UserData );
+
+  str->Metric->ThreadedComputeSums(*str, info->ThreadID, info->NumberOfThreads);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/*
+ * Compute the sums over a range of the samples B
+ */
+template< class TFixedImage, class TMovingImage  >
+void
+MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedComputeSums(ThreadStruct & str, unsigned int threadId,
+                      unsigned int numberOfThreads) const
+{
+  const SizeValueType numberOfSamples = m_SampleB.size();
+  const SizeValueType first = numberOfSamples * threadId / numberOfThreads;
+  const SizeValueType last = numberOfSamples * ( threadId + 1 ) / numberOfThreads;
+
+  double dLogSumFixed = 0.0;
+  double dLogSumMoving    = 0.0;
+  double dLogSumJoint  = 0.0;
+
+  typename SpatialSampleContainer::const_iterator aiter;
+  typename SpatialSampleContainer::const_iterator aend = m_SampleA.end();
+  typename DerivativeContainer::const_iterator    aditer;
+
+  for ( SizeValueType b = first; b < last; ++b )
+    {
+    const SpatialSample & sampleB = m_SampleB[b];
+
     double dDenominatorMoving = m_MinProbability;
     double dDenominatorJoint = m_MinProbability;
 
@@ -338,11 +420,11 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       double valueFixed;
       double valueMoving;
 
-      valueFixed = ( ( *biter ).FixedImageValue - ( *aiter ).FixedImageValue )
+      valueFixed = ( sampleB.FixedImageValue - ( *aiter ).FixedImageValue )
                    / m_FixedImageStandardDeviation;
       valueFixed = m_KernelFunction->Evaluate(valueFixed);
 
-      valueMoving = ( ( *biter ).MovingImageValue - ( *aiter ).MovingImageValue )
+      valueMoving = ( sampleB.MovingImageValue - ( *aiter ).MovingImageValue )
                     / m_MovingImageStandardDeviation;
       valueMoving = m_KernelFunction->Evaluate(valueMoving);
 
@@ -365,12 +447,16 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       dLogSumJoint -= vcl_log(dDenominatorJoint);
       }
 
-    /** get the image derivative for this B sample */
-    this->CalculateDerivatives( ( *biter ).FixedImagePointValue, derivB );
+    if ( !str.SampleADerivatives )
+      {
+      continue;
+      }
+
+    DerivativeType & derivative = str.Derivative[threadId];
 
     double totalWeight = 0.0;
 
-    for ( aiter = m_SampleA.begin(), aditer = sampleADerivatives.begin();
+    for ( aiter = m_SampleA.begin(), aditer = str.SampleADerivatives->begin();
           aiter != aend; ++aiter, ++aditer )
       {
       double valueFixed;
@@ -379,11 +465,11 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       double weightJoint;
       double weight;
 
-      valueFixed = ( ( *biter ).FixedImageValue - ( *aiter ).FixedImageValue )
+      valueFixed = ( sampleB.FixedImageValue - ( *aiter ).FixedImageValue )
                    / m_FixedImageStandardDeviation;
       valueFixed = m_KernelFunction->Evaluate(valueFixed);
 
-      valueMoving = ( ( *biter ).MovingImageValue - ( *aiter ).MovingImageValue )
+      valueMoving = ( sampleB.MovingImageValue - ( *aiter ).MovingImageValue )
                     / m_MovingImageStandardDeviation;
       valueMoving = m_KernelFunction->Evaluate(valueMoving);
 
@@ -391,32 +477,18 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       weightJoint = valueMoving * valueFixed / dDenominatorJoint;
 
       weight = ( weightMoving - weightJoint );
-      weight *= ( *biter ).MovingImageValue - ( *aiter ).MovingImageValue;
+      weight *= sampleB.MovingImageValue - ( *aiter ).MovingImageValue;
 
       totalWeight += weight;
       derivative -= ( *aditer ) * weight;
       } // end of sample A loop
 
-    derivative += derivB * totalWeight;
+    derivative += ( *str.SampleBDerivatives )[b] * totalWeight;
     } // end of sample B loop
 
-  double nsamp    = double(m_NumberOfSpatialSamples);
-
-  double threshold = -0.5 *nsamp *vcl_log(m_MinProbability);
-  if ( dLogSumMoving > threshold || dLogSumFixed > threshold
-       || dLogSumJoint > threshold  )
-    {
-    // at least half the samples in B did not occur within
-    // the Parzen window width of samples in A
-    itkExceptionMacro(<< "Standard deviation is too small");
-    }
-
-  value  = dLogSumFixed + dLogSumMoving - dLogSumJoint;
-  value /= nsamp;
-  value += vcl_log(nsamp);
-
-  derivative /= nsamp;
-  derivative /= vnl_math_sqr(m_MovingImageStandardDeviation);
+  str.LogSumFixed[threadId] = dLogSumFixed;
+  str.LogSumMoving[threadId] = dLogSumMoving;
+  str.LogSumJoint[threadId] = dLogSumJoint;
 }
 
 /*
@@ -441,7 +513,7 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
  *
  * This is a temporary solution until this feature is implemented
  * in the mapper. This solution only works for any transform
- * that support GetJacobian()
+ * that support GetSparseJacobian()
  */
 template< class TFixedImage, class TMovingImage  >
 void
@@ -464,17 +536,17 @@ MutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     return;
     }
 
-  typedef typename TransformType::JacobianType JacobianType;
-  const JacobianType & jacobian = this->m_Transform->GetJacobian(point);
-
-  unsigned int numberOfParameters = this->m_Transform->GetNumberOfParameters();
+  TransformJacobianType      jacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+  this->m_Transform->GetSparseJacobian(point, jacobian, nonZeroJacobianIndices);
 
-  for ( unsigned int k = 0; k < numberOfParameters; k++ )
+  derivatives.Fill(0.0);
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
     {
-    derivatives[k] = 0.0;
+    const unsigned int par = nonZeroJacobianIndices[k];
     for ( unsigned int j = 0; j < MovingImageDimension; j++ )
       {
-      derivatives[k] += jacobian[j][k] * imageDerivatives[j];
+      derivatives[par] += jacobian[j][k] * imageDerivatives[j];
       }
     }
 }
@@ -35,6 +35,10 @@ namespace itk
  * Interpolator. The correlation is normalized by the autocorrelations of both
  * the fixed and moving images.
  *
+ * The sums over the samples of the fixed image are accumulated by several
+ * threads, and the value and the derivative are computed in a single pass.
+ * By default all the pixels of the fixed image region are used.
+ *
  * \ingroup RegistrationMetrics
  * \ingroup ITK-RegistrationCommon
  */
@@ -62,6 +66,7 @@ public:
   typedef typename Superclass::TransformPointer        TransformPointer;
   typedef typename Superclass::TransformParametersType TransformParametersType;
   typedef typename Superclass::TransformJacobianType   TransformJacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
   typedef typename Superclass::GradientPixelType       GradientPixelType;
   typedef typename Superclass::OutputPointType         OutputPointType;
   typedef typename Superclass::InputPointType          InputPointType;
@@ -72,6 +77,17 @@ public:
   typedef typename Superclass::MovingImageType         MovingImageType;
   typedef typename Superclass::FixedImageConstPointer  FixedImageConstPointer;
   typedef typename Superclass::MovingImageConstPointer MovingImageConstPointer;
+  typedef typename Superclass::MovingImagePointType    MovingImagePointType;
+  typedef typename Superclass::ImageDerivativesType    ImageDerivativesType;
+
+  /** The moving image dimension. */
+  itkStaticConstMacro(MovingImageDimension, unsigned int,
+                      MovingImageType::ImageDimension);
+
+  /** Initialize the metric, and allocate the sums accumulated by each
+   * thread. */
+  virtual void Initialize(void)
+  throw ( ExceptionObject );
 
   /** Get the derivatives of the match measure. */
   void GetDerivative(const TransformParametersType & parameters,
@@ -93,7 +109,7 @@ public:
   itkBooleanMacro(SubtractMean);
 protected:
   NormalizedCorrelationImageToImageMetric();
-  virtual ~NormalizedCorrelationImageToImageMetric() {}
+  virtual ~NormalizedCorrelationImageToImageMetric();
   void PrintSelf(std::ostream & os, Indent indent) const;
 
 private:
@@ -102,7 +118,40 @@ private:
   void operator=(const Self &);                          //purposely not
                                                          // implemented
 
+  typedef typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+
+  /** The sums accumulated by each thread over its samples. */
+  struct SumsType {
+    AccumulateType sff;
+    AccumulateType smm;
+    AccumulateType sfm;
+    AccumulateType sf;
+    AccumulateType sm;
+  };
+
+  void ResetThreaderSums() const;
+
+  /** Add the sums of the threads and subtract the means if required. */
+  SumsType ReduceThreaderSums() const;
+
+  inline bool GetValueThreadProcessSample(unsigned int threadID,
+                                          SizeValueType fixedImageSample,
+                                          const MovingImagePointType & mappedPoint,
+                                          double movingImageValue) const;
+
+  inline bool GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                                       SizeValueType fixedImageSample,
+                                                       const MovingImagePointType & mappedPoint,
+                                                       double movingImageValue,
+                                                       const ImageDerivativesType &
+                                                       movingImageGradientValue) const;
+
   bool m_SubtractMean;
+
+  SumsType *      m_ThreaderSums;
+  DerivativeType *m_ThreaderDerivativeF;
+  DerivativeType *m_ThreaderDerivativeM;
+  DerivativeType *m_ThreaderDerivativeD;
 };
 } // end namespace itk
 
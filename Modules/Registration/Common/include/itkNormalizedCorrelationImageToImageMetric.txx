@@ -19,7 +19,6 @@
 #define __itkNormalizedCorrelationImageToImageMetric_txx
 
 #include "itkNormalizedCorrelationImageToImageMetric.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
 
 namespace itk
 {
@@ -31,287 +30,276 @@ NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 ::NormalizedCorrelationImageToImageMetric()
 {
   m_SubtractMean = false;
+
+  m_ThreaderSums = NULL;
+  m_ThreaderDerivativeF = NULL;
+  m_ThreaderDerivativeM = NULL;
+  m_ThreaderDerivativeD = NULL;
+  this->m_WithinThreadPreProcess = false;
+  this->m_WithinThreadPostProcess = false;
+
+  //  For backward compatibility, the default behavior is to use all the pixels
+  //  in the fixed image.
+  this->SetUseAllPixels(true);
 }
 
-/**
- * Get the match Measure
- */
 template< class TFixedImage, class TMovingImage >
-typename NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
 NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::GetValue(const TransformParametersType & parameters) const
+::~NormalizedCorrelationImageToImageMetric()
 {
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-
-  if ( !fixedImage )
+  if ( m_ThreaderSums != NULL )
     {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
+    delete[] m_ThreaderSums;
     }
+  m_ThreaderSums = NULL;
 
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
-
-  typename FixedImageType::IndexType index;
-
-  MeasureType measure;
-
-  this->m_NumberOfPixelsCounted = 0;
-
-  this->SetTransformParameters(parameters);
-
-  typedef  typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
-
-  AccumulateType sff = NumericTraits< AccumulateType >::Zero;
-  AccumulateType smm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sfm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sf  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sm  = NumericTraits< AccumulateType >::Zero;
-
-  while ( !ti.IsAtEnd() )
+  if ( m_ThreaderDerivativeF != NULL )
     {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
+    delete[] m_ThreaderDerivativeF;
+    }
+  m_ThreaderDerivativeF = NULL;
 
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
+  if ( m_ThreaderDerivativeM != NULL )
+    {
+    delete[] m_ThreaderDerivativeM;
+    }
+  m_ThreaderDerivativeM = NULL;
 
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
+  if ( m_ThreaderDerivativeD != NULL )
+    {
+    delete[] m_ThreaderDerivativeD;
+    }
+  m_ThreaderDerivativeD = NULL;
+}
 
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue   = ti.Get();
-      sff += fixedValue  * fixedValue;
-      smm += movingValue * movingValue;
-      sfm += fixedValue  * movingValue;
-      if ( this->m_SubtractMean )
-        {
-        sf += fixedValue;
-        sm += movingValue;
-        }
-      this->m_NumberOfPixelsCounted++;
-      }
+/**
+ * Initialize
+ */
+template< class TFixedImage, class TMovingImage >
+void
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::Initialize(void)
+throw ( ExceptionObject )
+{
+  this->Superclass::Initialize();
+  this->Superclass::MultiThreadingInitialize();
 
-    ++ti;
+  if ( m_ThreaderSums != NULL )
+    {
+    delete[] m_ThreaderSums;
     }
+  m_ThreaderSums = new SumsType[this->m_NumberOfThreads];
 
-  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
+  if ( m_ThreaderDerivativeF != NULL )
     {
-    sff -= ( sf * sf / this->m_NumberOfPixelsCounted );
-    smm -= ( sm * sm / this->m_NumberOfPixelsCounted );
-    sfm -= ( sf * sm / this->m_NumberOfPixelsCounted );
+    delete[] m_ThreaderDerivativeF;
     }
+  m_ThreaderDerivativeF = new DerivativeType[this->m_NumberOfThreads];
 
-  const RealType denom = -1.0 * vcl_sqrt(sff * smm);
-
-  if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
+  if ( m_ThreaderDerivativeM != NULL )
     {
-    measure = sfm / denom;
+    delete[] m_ThreaderDerivativeM;
     }
-  else
+  m_ThreaderDerivativeM = new DerivativeType[this->m_NumberOfThreads];
+
+  if ( m_ThreaderDerivativeD != NULL )
     {
-    measure = NumericTraits< MeasureType >::Zero;
+    delete[] m_ThreaderDerivativeD;
     }
+  m_ThreaderDerivativeD = new DerivativeType[this->m_NumberOfThreads];
 
-  return measure;
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    m_ThreaderDerivativeF[threadID].SetSize(this->m_NumberOfParameters);
+    m_ThreaderDerivativeM[threadID].SetSize(this->m_NumberOfParameters);
+    m_ThreaderDerivativeD[threadID].SetSize(this->m_NumberOfParameters);
+    }
 }
 
 /**
- * Get the Derivative Measure
+ * Reset the sums of all the threads
  */
 template< class TFixedImage, class TMovingImage >
 void
 NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
-::GetDerivative(const TransformParametersType & parameters,
-                DerivativeType & derivative) const
+::ResetThreaderSums() const
 {
-  if ( !this->GetGradientImage() )
+  if ( m_ThreaderSums == NULL )
     {
-    itkExceptionMacro(<< "The gradient image is null, maybe you forgot to call Initialize()");
+    itkExceptionMacro(<< "The metric has not been initialized, maybe you forgot to call Initialize()");
     }
 
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
-
-  if ( !fixedImage )
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
     {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
+    SumsType & sums = m_ThreaderSums[threadID];
+    sums.sff = NumericTraits< AccumulateType >::Zero;
+    sums.smm = NumericTraits< AccumulateType >::Zero;
+    sums.sfm = NumericTraits< AccumulateType >::Zero;
+    sums.sf  = NumericTraits< AccumulateType >::Zero;
+    sums.sm  = NumericTraits< AccumulateType >::Zero;
     }
+}
 
-  const unsigned int dimension = FixedImageType::ImageDimension;
-
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
-
-  typename FixedImageType::IndexType index;
-
-  this->m_NumberOfPixelsCounted = 0;
+/**
+ * Add the sums of all the threads, always in the same order so that the
+ * result does not depend on the scheduling of the threads.
+ */
+template< class TFixedImage, class TMovingImage >
+typename NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >::SumsType
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::ReduceThreaderSums() const
+{
+  SumsType sums = m_ThreaderSums[0];
 
-  this->SetTransformParameters(parameters);
+  for ( unsigned int threadID = 1; threadID < this->m_NumberOfThreads; threadID++ )
+    {
+    sums.sff += m_ThreaderSums[threadID].sff;
+    sums.smm += m_ThreaderSums[threadID].smm;
+    sums.sfm += m_ThreaderSums[threadID].sfm;
+    sums.sf  += m_ThreaderSums[threadID].sf;
+    sums.sm  += m_ThreaderSums[threadID].sm;
+    }
 
-  typedef  typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
+    {
+    sums.sff -= ( sums.sf * sums.sf / this->m_NumberOfPixelsCounted );
+    sums.smm -= ( sums.sm * sums.sm / this->m_NumberOfPixelsCounted );
+    sums.sfm -= ( sums.sf * sums.sm / this->m_NumberOfPixelsCounted );
+    }
 
-  AccumulateType sff  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType smm  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sfm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sf  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sm  = NumericTraits< AccumulateType >::Zero;
+  return sums;
+}
 
-  const unsigned int ParametersDimension = this->GetNumberOfParameters();
-  derivative = DerivativeType(ParametersDimension);
-  derivative.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+template< class TFixedImage, class TMovingImage  >
+inline bool
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueThreadProcessSample(unsigned int threadID,
+                              SizeValueType fixedImageSample,
+                              const MovingImagePointType & itkNotUsed(mappedPoint),
+                              double movingImageValue) const
+{
+  const RealType fixedValue = this->m_FixedImageSamples[fixedImageSample].value;
+  SumsType &     sums = m_ThreaderSums[threadID];
 
-  DerivativeType derivativeF = DerivativeType(ParametersDimension);
-  derivativeF.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+  sums.sff += fixedValue  * fixedValue;
+  sums.smm += movingImageValue * movingImageValue;
+  sums.sfm += fixedValue  * movingImageValue;
+  if ( this->m_SubtractMean )
+    {
+    sums.sf += fixedValue;
+    sums.sm += movingImageValue;
+    }
 
-  DerivativeType derivativeM = DerivativeType(ParametersDimension);
-  derivativeM.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+  return true;
+}
 
-  ti.GoToBegin();
-  // First compute the sums
-  while ( !ti.IsAtEnd() )
+/**
+ * Get the match Measure
+ */
+template< class TFixedImage, class TMovingImage >
+typename NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValue(const TransformParametersType & parameters) const
+{
+  if ( !this->m_FixedImage )
     {
-    index = ti.GetIndex();
+    itkExceptionMacro(<< "Fixed image has not been assigned");
+    }
 
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+  this->ResetThreaderSums();
 
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
+  this->SetTransformParameters(parameters);
 
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueMultiThreadedInitiate();
 
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
+  const SumsType sums = this->ReduceThreaderSums();
 
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue   = ti.Get();
-      sff += fixedValue  * fixedValue;
-      smm += movingValue * movingValue;
-      sfm += fixedValue  * movingValue;
-      if ( this->m_SubtractMean )
-        {
-        sf += fixedValue;
-        sm += movingValue;
-        }
-      this->m_NumberOfPixelsCounted++;
-      }
+  const RealType denom = -1.0 * vcl_sqrt(sums.sff * sums.smm);
 
-    ++ti;
+  MeasureType measure;
+  if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
+    {
+    measure = sums.sfm / denom;
     }
-
-  // Compute contributions to derivatives
-  ti.GoToBegin();
-  while ( !ti.IsAtEnd() )
+  else
     {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
+    measure = NumericTraits< MeasureType >::Zero;
+    }
 
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
+  return measure;
+}
 
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
+template< class TFixedImage, class TMovingImage  >
+inline bool
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivativeThreadProcessSample(unsigned int threadID,
+                                           SizeValueType fixedImageSample,
+                                           const MovingImagePointType & mappedPoint,
+                                           double movingImageValue,
+                                           const ImageDerivativesType &
+                                           movingImageGradientValue) const
+{
+  this->GetValueThreadProcessSample(threadID, fixedImageSample,
+                                    mappedPoint, movingImageValue);
 
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
+  const RealType fixedValue = this->m_FixedImageSamples[fixedImageSample].value;
 
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue     = ti.Get();
-
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
-
-      // Get the gradient by NearestNeighboorInterpolation:
-      // which is equivalent to round up the point components.
-      typedef typename OutputPointType::CoordRepType CoordRepType;
-      typedef ContinuousIndex< CoordRepType, MovingImageType::ImageDimension >
-      MovingImageContinuousIndexType;
-
-      MovingImageContinuousIndexType tempIndex;
-      this->m_MovingImage->TransformPhysicalPointToContinuousIndex(transformedPoint, tempIndex);
-
-      typename MovingImageType::IndexType mappedIndex;
-      mappedIndex.CopyWithRound(tempIndex);
-
-      const GradientPixelType gradient =
-        this->GetGradientImage()->GetPixel(mappedIndex);
-
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
-        {
-        RealType sumF = NumericTraits< RealType >::Zero;
-        RealType sumM = NumericTraits< RealType >::Zero;
-        for ( unsigned int dim = 0; dim < dimension; dim++ )
-          {
-          const RealType differential = jacobian(dim, par) * gradient[dim];
-          sumF += fixedValue  * differential;
-          sumM += movingValue * differential;
-          if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-            {
-            sumF -= differential * sf / this->m_NumberOfPixelsCounted;
-            sumM -= differential * sm / this->m_NumberOfPixelsCounted;
-            }
-          }
-        derivativeF[par] += sumF;
-        derivativeM[par] += sumM;
-        }
-      }
+  // Need to use one of the threader transforms if we're
+  // not in thread 0.
+  TransformType *transform;
 
-    ++ti;
+  if ( threadID > 0 )
+    {
+    transform = this->m_ThreaderTransform[threadID - 1];
     }
-
-  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
+  else
     {
-    sff -= ( sf * sf / this->m_NumberOfPixelsCounted );
-    smm -= ( sm * sm / this->m_NumberOfPixelsCounted );
-    sfm -= ( sf * sm / this->m_NumberOfPixelsCounted );
+    transform = this->m_Transform;
     }
 
-  const RealType denom = -1.0 * vcl_sqrt(sff * smm);
+  // Jacobian should be evaluated at the unmapped (fixed image) point.
+  TransformJacobianType &      jacobian = this->m_ThreaderJacobian[threadID];
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices = this->m_ThreaderNonZeroJacobianIndices[threadID];
+  transform->GetSparseJacobian(this->m_FixedImageSamples[fixedImageSample].point,
+                               jacobian, nonZeroJacobianIndices);
 
-  if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
+  DerivativeType & derivativeF = m_ThreaderDerivativeF[threadID];
+  DerivativeType & derivativeM = m_ThreaderDerivativeM[threadID];
+  DerivativeType & derivativeD = m_ThreaderDerivativeD[threadID];
+
+  for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
     {
-    for ( unsigned int i = 0; i < ParametersDimension; i++ )
+    const unsigned int par = nonZeroJacobianIndices[k];
+    RealType           sumD = NumericTraits< RealType >::Zero;
+    for ( unsigned int dim = 0; dim < MovingImageDimension; dim++ )
       {
-      derivative[i] = ( derivativeF[i] - ( sfm / smm ) * derivativeM[i] ) / denom;
+      sumD += jacobian(dim, k) * movingImageGradientValue[dim];
       }
-    }
-  else
-    {
-    for ( unsigned int i = 0; i < ParametersDimension; i++ )
+    derivativeF[par] += fixedValue * sumD;
+    derivativeM[par] += movingImageValue * sumD;
+    if ( this->m_SubtractMean )
       {
-      derivative[i] = NumericTraits< MeasureType >::Zero;
+      derivativeD[par] += sumD;
       }
     }
+
+  return true;
+}
+
+/**
+ * Get the Derivative Measure
+ */
+template< class TFixedImage, class TMovingImage >
+void
+NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
+::GetDerivative(const TransformParametersType & parameters,
+                DerivativeType & derivative) const
+{
+  MeasureType value;
+
+  // call the combined version
+  this->GetValueAndDerivative(parameters, value, derivative);
 }
 
 /*
@@ -323,176 +311,61 @@ NormalizedCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 ::GetValueAndDerivative(const TransformParametersType & parameters,
                         MeasureType & value, DerivativeType  & derivative) const
 {
-  if ( !this->GetGradientImage() )
+  if ( !this->m_FixedImage )
     {
-    itkExceptionMacro(<< "The gradient image is null, maybe you forgot to call Initialize()");
+    itkExceptionMacro(<< "Fixed image has not been assigned");
     }
 
-  FixedImageConstPointer fixedImage = this->m_FixedImage;
+  this->ResetThreaderSums();
 
-  if ( !fixedImage )
+  const unsigned int ParametersDimension = this->GetNumberOfParameters();
+  for ( unsigned int threadID = 0; threadID < this->m_NumberOfThreads; threadID++ )
     {
-    itkExceptionMacro(<< "Fixed image has not been assigned");
+    m_ThreaderDerivativeF[threadID].Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+    m_ThreaderDerivativeM[threadID].Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
+    m_ThreaderDerivativeD[threadID].Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
     }
 
-  const unsigned int dimension = FixedImageType::ImageDimension;
-
-  typedef  itk::ImageRegionConstIteratorWithIndex< FixedImageType > FixedIteratorType;
-
-  FixedIteratorType ti( fixedImage, this->GetFixedImageRegion() );
-
-  typename FixedImageType::IndexType index;
-
-  this->m_NumberOfPixelsCounted = 0;
-
   this->SetTransformParameters(parameters);
 
-  typedef  typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  // MUST BE CALLED TO INITIATE PROCESSING
+  this->GetValueAndDerivativeMultiThreadedInitiate();
 
-  AccumulateType sff  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType smm  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sfm = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sf  = NumericTraits< AccumulateType >::Zero;
-  AccumulateType sm  = NumericTraits< AccumulateType >::Zero;
+  const SumsType sums = this->ReduceThreaderSums();
 
-  const unsigned int ParametersDimension = this->GetNumberOfParameters();
-  derivative = DerivativeType(ParametersDimension);
-  derivative.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  DerivativeType derivativeF = DerivativeType(ParametersDimension);
-  derivativeF.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  DerivativeType derivativeM = DerivativeType(ParametersDimension);
-  derivativeM.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  DerivativeType derivativeM1 = DerivativeType(ParametersDimension);
-  derivativeM1.Fill(NumericTraits< ITK_TYPENAME DerivativeType::ValueType >::Zero);
-
-  ti.GoToBegin();
-  // First compute the sums
-  while ( !ti.IsAtEnd() )
+  DerivativeType derivativeF = m_ThreaderDerivativeF[0];
+  DerivativeType derivativeM = m_ThreaderDerivativeM[0];
+  DerivativeType derivativeD = m_ThreaderDerivativeD[0];
+  for ( unsigned int threadID = 1; threadID < this->m_NumberOfThreads; threadID++ )
     {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
-
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
-      {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue   = ti.Get();
-      sff += fixedValue  * fixedValue;
-      smm += movingValue * movingValue;
-      sfm += fixedValue  * movingValue;
-      if ( this->m_SubtractMean )
-        {
-        sf += fixedValue;
-        sm += movingValue;
-        }
-      this->m_NumberOfPixelsCounted++;
-      }
-
-    ++ti;
+    derivativeF += m_ThreaderDerivativeF[threadID];
+    derivativeM += m_ThreaderDerivativeM[threadID];
+    derivativeD += m_ThreaderDerivativeD[threadID];
     }
 
-  // Compute contributions to derivatives
-  ti.GoToBegin();
-  while ( !ti.IsAtEnd() )
+  // the sums of the derivatives of the centered values
+  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
     {
-    index = ti.GetIndex();
-
-    InputPointType inputPoint;
-    fixedImage->TransformIndexToPhysicalPoint(index, inputPoint);
-
-    if ( this->m_FixedImageMask && !this->m_FixedImageMask->IsInside(inputPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    OutputPointType transformedPoint = this->m_Transform->TransformPoint(inputPoint);
-
-    if ( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside(transformedPoint) )
-      {
-      ++ti;
-      continue;
-      }
-
-    if ( this->m_Interpolator->IsInsideBuffer(transformedPoint) )
+    const RealType meanF = sums.sf / this->m_NumberOfPixelsCounted;
+    const RealType meanM = sums.sm / this->m_NumberOfPixelsCounted;
+    for ( unsigned int i = 0; i < ParametersDimension; i++ )
       {
-      const RealType movingValue  = this->m_Interpolator->Evaluate(transformedPoint);
-      const RealType fixedValue     = ti.Get();
-
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
-
-      // Get the gradient by NearestNeighboorInterpolation:
-      // which is equivalent to round up the point components.
-      typedef typename OutputPointType::CoordRepType CoordRepType;
-      typedef ContinuousIndex< CoordRepType, MovingImageType::ImageDimension >
-      MovingImageContinuousIndexType;
-
-      MovingImageContinuousIndexType tempIndex;
-      this->m_MovingImage->TransformPhysicalPointToContinuousIndex(transformedPoint, tempIndex);
-
-      typename MovingImageType::IndexType mappedIndex;
-      mappedIndex.CopyWithRound(tempIndex);
-
-      const GradientPixelType gradient =
-        this->GetGradientImage()->GetPixel(mappedIndex);
-
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
-        {
-        RealType sumF = NumericTraits< RealType >::Zero;
-        RealType sumM = NumericTraits< RealType >::Zero;
-        for ( unsigned int dim = 0; dim < dimension; dim++ )
-          {
-          const RealType differential = jacobian(dim, par) * gradient[dim];
-          sumF += fixedValue  * differential;
-          sumM += movingValue * differential;
-          if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-            {
-            sumF -= differential * sf / this->m_NumberOfPixelsCounted;
-            sumM -= differential * sm / this->m_NumberOfPixelsCounted;
-            }
-          }
-        derivativeF[par] += sumF;
-        derivativeM[par] += sumM;
-        }
+      derivativeF[i] -= meanF * derivativeD[i];
+      derivativeM[i] -= meanM * derivativeD[i];
       }
-    ++ti;
     }
 
-  if ( this->m_SubtractMean && this->m_NumberOfPixelsCounted > 0 )
-    {
-    sff -= ( sf * sf / this->m_NumberOfPixelsCounted );
-    smm -= ( sm * sm / this->m_NumberOfPixelsCounted );
-    sfm -= ( sf * sm / this->m_NumberOfPixelsCounted );
-    }
+  derivative = DerivativeType(ParametersDimension);
 
-  const RealType denom = -1.0 * vcl_sqrt(sff * smm);
+  const RealType denom = -1.0 * vcl_sqrt(sums.sff * sums.smm);
 
   if ( this->m_NumberOfPixelsCounted > 0 && denom != 0.0 )
     {
     for ( unsigned int i = 0; i < ParametersDimension; i++ )
       {
-      derivative[i] = ( derivativeF[i] - ( sfm / smm ) * derivativeM[i] ) / denom;
+      derivative[i] = ( derivativeF[i] - ( sums.sfm / sums.smm ) * derivativeM[i] ) / denom;
       }
-    value = sfm / denom;
+    value = sums.sfm / denom;
     }
   else
     {
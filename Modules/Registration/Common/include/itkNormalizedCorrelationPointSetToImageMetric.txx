@@ -169,6 +169,10 @@ NormalizedCorrelationPointSetToImageMetric< TFixedPointSet, TMovingImage >
   PointDataIterator pointDataItr = fixedPointSet->GetPointData()->Begin();
   PointDataIterator pointDataEnd = fixedPointSet->GetPointData()->End();
 
+  // buffers for the part of the Jacobian which may be non zero
+  TransformJacobianType      jacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+
   while ( pointItr != pointEnd && pointDataItr != pointDataEnd )
     {
     InputPointType inputPoint;
@@ -193,8 +197,7 @@ NormalizedCorrelationPointSetToImageMetric< TFixedPointSet, TMovingImage >
       this->m_NumberOfPixelsCounted++;
 
       // Now compute the derivatives
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
+      this->m_Transform->GetSparseJacobian(inputPoint, jacobian, nonZeroJacobianIndices);
 
       // Get the gradient by NearestNeighboorInterpolation:
       // which is equivalent to round up the point components.
@@ -211,12 +214,13 @@ NormalizedCorrelationPointSetToImageMetric< TFixedPointSet, TMovingImage >
       const GradientPixelType gradient =
         this->GetGradientImage()->GetPixel(mappedIndex);
 
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
+      for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
         {
+        const unsigned int par = nonZeroJacobianIndices[k];
         RealType sumD = NumericTraits< RealType >::Zero;
         for ( unsigned int dim = 0; dim < dimension; dim++ )
           {
-          const RealType differential = jacobian(dim, par) * gradient[dim];
+          const RealType differential = jacobian(dim, k) * gradient[dim];
           sumD += differential;
           }
         derivativeF[par] += sumD * fixedValue;
@@ -317,6 +321,10 @@ NormalizedCorrelationPointSetToImageMetric< TFixedPointSet, TMovingImage >
   PointDataIterator pointDataItr = fixedPointSet->GetPointData()->Begin();
   PointDataIterator pointDataEnd = fixedPointSet->GetPointData()->End();
 
+  // buffers for the part of the Jacobian which may be non zero
+  TransformJacobianType      jacobian;
+  NonZeroJacobianIndicesType nonZeroJacobianIndices;
+
   while ( pointItr != pointEnd && pointDataItr != pointDataEnd )
     {
     InputPointType inputPoint;
@@ -341,8 +349,7 @@ NormalizedCorrelationPointSetToImageMetric< TFixedPointSet, TMovingImage >
       this->m_NumberOfPixelsCounted++;
 
       // Now compute the derivatives
-      const TransformJacobianType & jacobian =
-        this->m_Transform->GetJacobian(inputPoint);
+      this->m_Transform->GetSparseJacobian(inputPoint, jacobian, nonZeroJacobianIndices);
 
       // Get the gradient by NearestNeighboorInterpolation:
       // which is equivalent to round up the point components.
@@ -359,12 +366,13 @@ NormalizedCorrelationPointSetToImageMetric< TFixedPointSet, TMovingImage >
       const GradientPixelType gradient =
         this->GetGradientImage()->GetPixel(mappedIndex);
 
-      for ( unsigned int par = 0; par < ParametersDimension; par++ )
+      for ( unsigned int k = 0; k < nonZeroJacobianIndices.Size(); k++ )
         {
+        const unsigned int par = nonZeroJacobianIndices[k];
         RealType sumD = NumericTraits< RealType >::Zero;
         for ( unsigned int dim = 0; dim < dimension; dim++ )
           {
-          const RealType differential = jacobian(dim, par) * gradient[dim];
+          const RealType differential = jacobian(dim, k) * gradient[dim];
           sumD += differential;
           }
         derivativeF[par] += sumD * fixedValue;
@@ -88,6 +88,7 @@ public:
   typedef typename TransformType::OutputPointType OutputPointType;
   typedef typename TransformType::ParametersType  TransformParametersType;
   typedef typename TransformType::JacobianType    TransformJacobianType;
+  typedef typename TransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
 
   /**  Type of the Interpolator Base class */
   typedef InterpolateImageFunction<
@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkImageRegistrationMethod.h"
+#include "itkMeanSquaresImageToImageMetric.h"
+#include "itkMattesMutualInformationImageToImageMetric.h"
+#include "itkRegularStepGradientDescentOptimizer.h"
+#include "itkTranslationTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Register two images shifted by a known translation, with a metric which
+// draws new random samples at each iteration of the optimizer and
+// increases their number as the optimizer converges.
+
+namespace
+{
+const unsigned int Dimension = 2;
+
+typedef itk::Image< float, Dimension >                              ImageType;
+typedef itk::TranslationTransform< double, Dimension >              TransformType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double >    InterpolatorType;
+typedef itk::RegularStepGradientDescentOptimizer                    OptimizerType;
+typedef itk::ImageRegistrationMethod< ImageType, ImageType >        RegistrationType;
+typedef RegistrationType::MetricType                                MetricType;
+
+ImageType::Pointer CreateImage(double cx, double cy)
+{
+  ImageType::SizeType size;
+  size[0] = 100;
+  size[1] = 100;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double dx = it.GetIndex()[0] - cx;
+    const double dy = it.GetIndex()[1] - cy;
+    it.Set( static_cast< float >( 100.0 * vcl_exp( -( dx * dx + 2.0 * dy * dy ) / 400.0 ) ) );
+    }
+  return image;
+}
+
+int Register(MetricType *metric, const char *name)
+{
+  ImageType::Pointer fixedImage = CreateImage(50.0, 50.0);
+  ImageType::Pointer movingImage = CreateImage(53.0, 48.0);
+
+  TransformType::Pointer    transform = TransformType::New();
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  OptimizerType::Pointer    optimizer = OptimizerType::New();
+  optimizer->SetMaximumStepLength( 1.0 );
+  optimizer->SetMinimumStepLength( 0.01 );
+  optimizer->SetNumberOfIterations( 200 );
+
+  metric->ReinitializeSeed( 1234 );
+  metric->SetNumberOfFixedImageSamples( 200 );
+  metric->UseStochasticSamplingOn();
+  metric->UseStratifiedSamplingOn();
+  metric->SetMaximumNumberOfFixedImageSamples( 3200 );
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetMetric( metric );
+  registration->SetOptimizer( optimizer );
+  registration->SetTransform( transform );
+  registration->SetInterpolator( interpolator );
+
+  RegistrationType::ParametersType initialParameters( transform->GetNumberOfParameters() );
+  initialParameters.Fill( 0.0 );
+  registration->SetInitialTransformParameters( initialParameters );
+  registration->Update();
+
+  const RegistrationType::ParametersType & parameters = registration->GetLastTransformParameters();
+  std::cout << name << ": " << parameters << " after " << optimizer->GetCurrentIteration()
+            << " iterations with " << metric->GetNumberOfFixedImageSamples() << " samples" << std::endl;
+
+  int status = EXIT_SUCCESS;
+  if ( vnl_math_abs( parameters[0] - 3.0 ) > 0.1 || vnl_math_abs( parameters[1] + 2.0 ) > 0.1 )
+    {
+    std::cerr << name << ": the translation " << parameters << " is not ( 3, -2 )." << std::endl;
+    status = EXIT_FAILURE;
+    }
+  if ( metric->GetNumberOfFixedImageSamples() <= 200 )
+    {
+    std::cerr << name << ": the number of samples did not increase." << std::endl;
+    status = EXIT_FAILURE;
+    }
+  return status;
+}
+}
+
+int itkImageRegistrationMethodStochasticSamplingTest(int, char *[])
+{
+  int status = EXIT_SUCCESS;
+
+  typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType > MeanSquaresType;
+  MeanSquaresType::Pointer meanSquares = MeanSquaresType::New();
+  if ( Register( meanSquares, "MeanSquaresImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // the samples are sorted by fixed image bin for the explicit derivatives
+  typedef itk::MattesMutualInformationImageToImageMetric< ImageType, ImageType > MattesType;
+  MattesType::Pointer mattes = MattesType::New();
+  mattes->SetNumberOfHistogramBins( 24 );
+  if ( Register( mattes, "MattesMutualInformationImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  MattesType::Pointer mattesImplicit = MattesType::New();
+  mattesImplicit->SetNumberOfHistogramBins( 24 );
+  mattesImplicit->UseExplicitPDFDerivativesOff();
+  if ( Register( mattesImplicit, "MattesMutualInformationImageToImageMetric without explicit PDF derivatives" )
+       != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
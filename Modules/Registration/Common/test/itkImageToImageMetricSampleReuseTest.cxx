@@ -0,0 +1,148 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMeanSquaresImageToImageMetric.h"
+#include "itkTranslationTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Check that the fixed image samples are kept from one initialization of
+// the metric to the next when ReuseFixedImageSamples is on, and drawn
+// again when the fixed image is modified, and that the gradient image is
+// only computed again when the moving image is modified.
+
+namespace
+{
+const unsigned int Dimension = 2;
+
+typedef itk::Image< float, Dimension >                                 ImageType;
+typedef itk::TranslationTransform< double, Dimension >                 TransformType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double >       InterpolatorType;
+typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType >     MetricType;
+
+ImageType::Pointer CreateImage(double cx, double cy)
+{
+  ImageType::SizeType size;
+  size[0] = 90;
+  size[1] = 70;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double dx = it.GetIndex()[0] - cx;
+    const double dy = it.GetIndex()[1] - cy;
+    it.Set( static_cast< float >( 100.0 * vcl_exp( -( dx * dx + dy * dy ) / 300.0 )
+                                  + 0.3 * it.GetIndex()[1] ) );
+    }
+  return image;
+}
+
+// Draw the samples with a new seed, and return the value of the metric
+MetricType::MeasureType InitializeAndEvaluate(MetricType *metric, int seed,
+                                              const MetricType::ParametersType & parameters)
+{
+  metric->ReinitializeSeed( seed );
+  metric->Initialize();
+  return metric->GetValue( parameters );
+}
+}
+
+int itkImageToImageMetricSampleReuseTest(int, char *[])
+{
+  ImageType::Pointer fixedImage = CreateImage(40.0, 30.0);
+  ImageType::Pointer movingImage = CreateImage(43.0, 28.0);
+
+  TransformType::Pointer    transform = TransformType::New();
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( fixedImage );
+  metric->SetMovingImage( movingImage );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->SetTransform( transform );
+  metric->SetInterpolator( interpolator );
+  metric->SetNumberOfFixedImageSamples( 500 );
+
+  TransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  parameters[0] = 1.5;
+  parameters[1] = -0.75;
+
+  int status = EXIT_SUCCESS;
+
+  // By default, a new set of samples is drawn at each initialization
+  const MetricType::MeasureType firstValue = InitializeAndEvaluate( metric, 1, parameters );
+  const MetricType::MeasureType otherValue = InitializeAndEvaluate( metric, 2, parameters );
+  if ( firstValue == otherValue )
+    {
+    std::cerr << "The same value " << firstValue << " is computed with other random samples." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  metric->ReuseFixedImageSamplesOn();
+  const MetricType::MeasureType sampledValue = InitializeAndEvaluate( metric, 1, parameters );
+  if ( sampledValue != firstValue )
+    {
+    std::cerr << "The value " << sampledValue << " differs from " << firstValue
+              << " with the same random samples." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  const MetricType::GradientImageType *gradientImage = metric->GetGradientImage();
+
+  // The samples are reused, even if the seed changes
+  const MetricType::MeasureType reusedValue = InitializeAndEvaluate( metric, 2, parameters );
+  if ( reusedValue != sampledValue )
+    {
+    std::cerr << "The samples are not reused: the value is " << reusedValue
+              << " instead of " << sampledValue << "." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  if ( metric->GetGradientImage() != gradientImage )
+    {
+    std::cerr << "The gradient image is computed again although the moving image is unchanged." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // The samples are drawn again when the fixed image is modified
+  fixedImage->Modified();
+  const MetricType::MeasureType resampledValue = InitializeAndEvaluate( metric, 2, parameters );
+  if ( resampledValue != otherValue )
+    {
+    std::cerr << "The samples are not drawn again after the fixed image is modified: the value is "
+              << resampledValue << " instead of " << otherValue << "." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // The gradient image is computed again when the moving image is modified
+  movingImage->Modified();
+  metric->Initialize();
+  if ( metric->GetGradientImage() == gradientImage )
+    {
+    std::cerr << "The gradient image is not computed again after the moving image is modified." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -0,0 +1,374 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMeanSquaresImageToImageMetric.h"
+#include "itkNormalizedCorrelationImageToImageMetric.h"
+#include "itkMeanReciprocalSquareDifferenceImageToImageMetric.h"
+#include "itkMattesMutualInformationImageToImageMetric.h"
+#include "itkMutualInformationHistogramImageToImageMetric.h"
+#include "itkKappaStatisticImageToImageMetric.h"
+#include "itkMutualInformationImageToImageMetric.h"
+#include "itkGradientDifferenceImageToImageMetric.h"
+#include "itkMatchCardinalityImageToImageMetric.h"
+#include "itkTranslationTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+// Check that the metrics computed in threads give the same value and
+// derivative whatever the number of threads, and exactly the same
+// results when they are evaluated twice with the same number of threads.
+// The number of evaluations per second is reported for each number of
+// threads. The kappa statistic is also compared with the value of the
+// loop over the fixed image it used before being threaded. The
+// Viola-Wells mutual information draws new samples at each evaluation:
+// the random number generator is reseeded before each of them.
+
+namespace
+{
+const unsigned int Dimension = 2;
+
+typedef itk::Image< float, Dimension >                           ImageType;
+typedef itk::TranslationTransform< double, Dimension >           TransformType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double > InterpolatorType;
+
+typedef itk::MutualInformationImageToImageMetric< ImageType, ImageType > MutualInformationType;
+
+ImageType::Pointer CreateImage(double cx, double cy)
+{
+  ImageType::SizeType size;
+  size[0] = 150;
+  size[1] = 120;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double dx = it.GetIndex()[0] - cx;
+    const double dy = it.GetIndex()[1] - cy;
+    it.Set( static_cast< float >( 200.0 * vcl_exp( -( dx * dx + 2.0 * dy * dy ) / 800.0 )
+                                  + 0.1 * it.GetIndex()[0] ) );
+    }
+  return image;
+}
+
+// an ellipse of foreground pixels
+ImageType::Pointer CreateBinaryImage(double cx, double cy)
+{
+  ImageType::Pointer image = CreateImage(cx, cy);
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double dx = it.GetIndex()[0] - cx;
+    const double dy = it.GetIndex()[1] - cy;
+    it.Set( dx * dx + 2.0 * dy * dy < 1600.0 ? 255.0f : 0.0f );
+    }
+  return image;
+}
+
+TransformType::ParametersType CreateParameters()
+{
+  TransformType::ParametersType parameters(Dimension);
+  parameters[0] = 2.5;
+  parameters[1] = -1.75;
+  return parameters;
+}
+
+// the kappa statistic computed by looping over the fixed image
+double ComputeKappa(const ImageType *fixedImage, const ImageType *movingImage,
+                    const TransformType::ParametersType & parameters)
+{
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetParameters(parameters);
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetInputImage(movingImage);
+
+  double fixedArea = 0.0;
+  double movingArea = 0.0;
+  double intersection = 0.0;
+  itk::ImageRegionConstIteratorWithIndex< ImageType > it( fixedImage, fixedImage->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    ImageType::PointType point;
+    fixedImage->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+    const bool fixedForeground = it.Get() == 255.0f;
+    if ( fixedForeground )
+      {
+      fixedArea++;
+      }
+    const TransformType::OutputPointType mappedPoint = transform->TransformPoint(point);
+    if ( interpolator->IsInsideBuffer(mappedPoint) && interpolator->Evaluate(mappedPoint) == 255.0 )
+      {
+      movingArea++;
+      if ( fixedForeground )
+        {
+        intersection++;
+        }
+      }
+    }
+  return 2.0 * intersection / ( fixedArea + movingArea );
+}
+
+// nothing to do before evaluating the metrics which sample once
+template< class TMetric >
+void PrepareEvaluation(TMetric *)
+{}
+
+void PrepareEvaluation(MutualInformationType *metric)
+{
+  metric->ReinitializeSeed( 121212 );
+}
+
+template< class TMetric >
+int CheckMetric(TMetric *metric, ImageType *fixedImage, ImageType *movingImage, const char *name,
+                double relativeTolerance = 1e-8)
+{
+  typedef typename TMetric::MeasureType    MeasureType;
+  typedef typename TMetric::DerivativeType DerivativeType;
+
+  TransformType::Pointer    transform = TransformType::New();
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+  metric->SetFixedImage( fixedImage );
+  metric->SetMovingImage( movingImage );
+  metric->SetFixedImageRegion( fixedImage->GetBufferedRegion() );
+  metric->SetTransform( transform );
+  metric->SetInterpolator( interpolator );
+
+  const TransformType::ParametersType parameters = CreateParameters();
+
+  const unsigned int numberOfEvaluations = 10;
+  const unsigned int threads[4] = { 1, 2, 4, 7 };
+
+  MeasureType    referenceValue = 0.0;
+  DerivativeType referenceDerivative;
+  int            status = EXIT_SUCCESS;
+
+  std::cout << name << std::endl;
+  for ( unsigned int t = 0; t < 4; t++ )
+    {
+    metric->SetNumberOfThreads( threads[t] );
+    metric->Initialize();
+
+    MeasureType    value;
+    DerivativeType derivative;
+    PrepareEvaluation( metric );
+    metric->GetValueAndDerivative( parameters, value, derivative );
+
+    MeasureType    value2;
+    DerivativeType derivative2;
+    PrepareEvaluation( metric );
+    metric->GetValueAndDerivative( parameters, value2, derivative2 );
+
+    if ( value != value2 || derivative != derivative2 )
+      {
+      std::cerr << name << " with " << threads[t] << " threads: two evaluations differ: "
+                << value << " " << derivative << " and " << value2 << " " << derivative2 << std::endl;
+      status = EXIT_FAILURE;
+      }
+
+    if ( t == 0 )
+      {
+      referenceValue = value;
+      referenceDerivative = derivative;
+      }
+    else
+      {
+      // the sums are added in another order with another number of threads
+      const double tolerance = relativeTolerance * ( 1.0 + vnl_math_abs( referenceValue ) );
+      bool         same = vnl_math_abs( value - referenceValue ) <= tolerance;
+      for ( unsigned int p = 0; p < derivative.Size(); p++ )
+        {
+        same = same && vnl_math_abs( derivative[p] - referenceDerivative[p] )
+               <= relativeTolerance * ( 1.0 + vnl_math_abs( referenceDerivative[p] ) );
+        }
+      if ( !same )
+        {
+        std::cerr << name << " with " << threads[t] << " threads: " << value << " " << derivative
+                  << " instead of " << referenceValue << " " << referenceDerivative << std::endl;
+        status = EXIT_FAILURE;
+        }
+      }
+
+    itk::TimeProbe timer;
+    timer.Start();
+    for ( unsigned int e = 0; e < numberOfEvaluations; e++ )
+      {
+      PrepareEvaluation( metric );
+      metric->GetValueAndDerivative( parameters, value, derivative );
+      }
+    timer.Stop();
+    std::cout << "  " << threads[t] << " threads: value " << value << ", "
+              << numberOfEvaluations / vnl_math_max( timer.GetTotal(), 1e-9 )
+              << " evaluations/s" << std::endl;
+    }
+
+  return status;
+}
+}
+
+int itkImageToImageMetricThreadingTest(int, char *[])
+{
+  ImageType::Pointer fixedImage = CreateImage(70.0, 60.0);
+  ImageType::Pointer movingImage = CreateImage(73.0, 58.0);
+
+  int status = EXIT_SUCCESS;
+
+  typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType > MeanSquaresType;
+  MeanSquaresType::Pointer meanSquares = MeanSquaresType::New();
+  if ( CheckMetric( meanSquares.GetPointer(), fixedImage, movingImage,
+                    "MeanSquaresImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::NormalizedCorrelationImageToImageMetric< ImageType, ImageType > CorrelationType;
+  CorrelationType::Pointer correlation = CorrelationType::New();
+  correlation->SubtractMeanOn();
+  if ( CheckMetric( correlation.GetPointer(), fixedImage, movingImage,
+                    "NormalizedCorrelationImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::MeanReciprocalSquareDifferenceImageToImageMetric< ImageType, ImageType > ReciprocalType;
+  ReciprocalType::Pointer reciprocal = ReciprocalType::New();
+  reciprocal->SetLambda( 10.0 );
+  reciprocal->SetDelta( 0.01 );
+  if ( CheckMetric( reciprocal.GetPointer(), fixedImage, movingImage,
+                    "MeanReciprocalSquareDifferenceImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::MattesMutualInformationImageToImageMetric< ImageType, ImageType > MattesType;
+  MattesType::Pointer mattes = MattesType::New();
+  mattes->SetNumberOfHistogramBins( 32 );
+  mattes->UseAllPixelsOn();
+  // the joint PDF is stored in single precision
+  if ( CheckMetric( mattes.GetPointer(), fixedImage, movingImage,
+                    "MattesMutualInformationImageToImageMetric", 1e-5 ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // the derivatives of the joint PDF accumulated by the threads
+  MattesType::Pointer mattesImplicit = MattesType::New();
+  mattesImplicit->SetNumberOfHistogramBins( 32 );
+  mattesImplicit->UseAllPixelsOn();
+  mattesImplicit->UseExplicitPDFDerivativesOff();
+  if ( CheckMetric( mattesImplicit.GetPointer(), fixedImage, movingImage,
+                    "MattesMutualInformationImageToImageMetric without explicit PDF derivatives", 1e-5 )
+       != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::MutualInformationHistogramImageToImageMetric< ImageType, ImageType > HistogramType;
+  HistogramType::Pointer histogram = HistogramType::New();
+  HistogramType::HistogramSizeType histogramSize;
+  histogramSize.SetSize(2);
+  histogramSize.Fill(32);
+  histogram->SetHistogramSize( histogramSize );
+  if ( CheckMetric( histogram.GetPointer(), fixedImage, movingImage,
+                    "MutualInformationHistogramImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  MutualInformationType::Pointer mutualInformation = MutualInformationType::New();
+  mutualInformation->SetNumberOfSpatialSamples( 300 );
+  mutualInformation->SetFixedImageStandardDeviation( 10.0 );
+  mutualInformation->SetMovingImageStandardDeviation( 10.0 );
+  if ( CheckMetric( mutualInformation.GetPointer(), fixedImage, movingImage,
+                    "MutualInformationImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  // the derivative is computed by finite differences of sums
+  typedef itk::GradientDifferenceImageToImageMetric< ImageType, ImageType > GradientDifferenceType;
+  GradientDifferenceType::Pointer gradientDifference = GradientDifferenceType::New();
+  if ( CheckMetric( gradientDifference.GetPointer(), fixedImage, movingImage,
+                    "GradientDifferenceImageToImageMetric", 1e-6 ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::KappaStatisticImageToImageMetric< ImageType, ImageType > KappaType;
+  ImageType::Pointer fixedBinaryImage = CreateBinaryImage(70.0, 60.0);
+  ImageType::Pointer movingBinaryImage = CreateBinaryImage(73.0, 58.0);
+  KappaType::Pointer kappa = KappaType::New();
+  kappa->SetForegroundValue( 255.0 );
+  if ( CheckMetric( kappa.GetPointer(), fixedBinaryImage, movingBinaryImage,
+                    "KappaStatisticImageToImageMetric" ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  const double kappaValue = kappa->GetValue( CreateParameters() );
+  const double expectedKappaValue = ComputeKappa(fixedBinaryImage, movingBinaryImage, CreateParameters());
+  if ( vnl_math_abs(kappaValue - expectedKappaValue) > 1e-12 || kappaValue <= 0.0 || kappaValue >= 1.0 )
+    {
+    std::cerr << "KappaStatisticImageToImageMetric: " << kappaValue << " instead of "
+              << expectedKappaValue << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // the match cardinality has no derivative: only its value is compared
+  typedef itk::MatchCardinalityImageToImageMetric< ImageType, ImageType > MatchCardinalityType;
+  MatchCardinalityType::Pointer matchCardinality = MatchCardinalityType::New();
+  matchCardinality->SetFixedImage( fixedBinaryImage );
+  matchCardinality->SetMovingImage( movingBinaryImage );
+  matchCardinality->SetFixedImageRegion( fixedBinaryImage->GetBufferedRegion() );
+  matchCardinality->SetTransform( TransformType::New() );
+  matchCardinality->SetInterpolator( InterpolatorType::New() );
+  const unsigned int threads[4] = { 1, 2, 4, 7 };
+  double             referenceMatches = 0.0;
+  std::cout << "MatchCardinalityImageToImageMetric" << std::endl;
+  for ( unsigned int t = 0; t < 4; t++ )
+    {
+    matchCardinality->SetNumberOfThreads( threads[t] );
+    matchCardinality->Initialize();
+    const double matches = matchCardinality->GetValue( CreateParameters() );
+    std::cout << "  " << threads[t] << " threads: value " << matches << std::endl;
+    if ( matchCardinality->GetMultiThreader() != matchCardinality->GetThreader() )
+      {
+      std::cerr << "MatchCardinalityImageToImageMetric does not use the multithreader of the metric"
+                << std::endl;
+      status = EXIT_FAILURE;
+      }
+    if ( t == 0 )
+      {
+      referenceMatches = matches;
+      }
+    else if ( matches != referenceMatches )
+      {
+      std::cerr << "MatchCardinalityImageToImageMetric with " << threads[t] << " threads: " << matches
+                << " instead of " << referenceMatches << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+
+  return status;
+}
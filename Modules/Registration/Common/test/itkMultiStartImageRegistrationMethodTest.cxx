@@ -0,0 +1,288 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkMultiStartImageRegistrationMethod.h"
+#include "itkMeanSquaresImageToImageMetric.h"
+#include "itkMutualInformationImageToImageMetric.h"
+#include "itkRegularStepGradientDescentOptimizer.h"
+#include "itkTranslationTransform.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Register two images shifted by a known translation from several
+// initial translations, on two levels. The starts far from the solution
+// are pruned after the first level, and a start which maps the fixed
+// image outside the moving image fails. The registration is then run
+// again with a smaller fixed image. The starts of the Viola-Wells mutual
+// information, which draws samples at each evaluation, must give the
+// same results whatever the number of threads.
+
+namespace
+{
+const unsigned int Dimension = 2;
+
+typedef itk::Image< float, Dimension >                                 ImageType;
+typedef itk::TranslationTransform< double, Dimension >                 TransformType;
+typedef itk::LinearInterpolateImageFunction< ImageType, double >       InterpolatorType;
+typedef itk::MeanSquaresImageToImageMetric< ImageType, ImageType >     MetricType;
+typedef itk::RegularStepGradientDescentOptimizer                       OptimizerType;
+typedef itk::MultiStartImageRegistrationMethod< ImageType, ImageType > RegistrationType;
+
+ImageType::Pointer CreateImage(double cx, double cy)
+{
+  ImageType::SizeType size;
+  size[0] = 100;
+  size[1] = 100;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const double dx = it.GetIndex()[0] - cx;
+    const double dy = it.GetIndex()[1] - cy;
+    it.Set( static_cast< float >( 100.0 * vcl_exp( -( dx * dx + 2.0 * dy * dy ) / 400.0 ) ) );
+    }
+  return image;
+}
+
+typedef itk::MutualInformationImageToImageMetric< ImageType, ImageType > MutualInformationType;
+
+// Register with the Viola-Wells mutual information from three starts
+RegistrationType::Pointer RegisterWithMutualInformation(ImageType *fixedImage, ImageType *movingImage,
+                                                        unsigned int numberOfThreads)
+{
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetNumberOfThreads( numberOfThreads );
+  registration->SetRandomSeed( 1234 );
+  registration->MaximizeOn();
+
+  const double initialTranslations[3][Dimension] = { { 0.0, 0.0 }, { 5.0, -4.0 }, { -3.0, 2.0 } };
+  for ( unsigned int s = 0; s < 3; s++ )
+    {
+    MutualInformationType::Pointer metric = MutualInformationType::New();
+    OptimizerType::Pointer         optimizer = OptimizerType::New();
+    metric->SetNumberOfSpatialSamples( 100 );
+    metric->SetFixedImageStandardDeviation( 5.0 );
+    metric->SetMovingImageStandardDeviation( 5.0 );
+    optimizer->MaximizeOn();
+    optimizer->SetMaximumStepLength( 1.0 );
+    optimizer->SetMinimumStepLength( 0.01 );
+    optimizer->SetNumberOfIterations( 20 );
+
+    RegistrationType::ParametersType initialParameters( Dimension );
+    initialParameters[0] = initialTranslations[s][0];
+    initialParameters[1] = initialTranslations[s][1];
+
+    registration->AddStart( metric, optimizer, TransformType::New(), InterpolatorType::New(),
+                            initialParameters );
+    }
+  registration->StartRegistration();
+  return registration;
+}
+}
+
+int itkMultiStartImageRegistrationMethodTest(int, char *[])
+{
+  ImageType::Pointer fixedImage = CreateImage(50.0, 50.0);
+  ImageType::Pointer movingImage = CreateImage(53.0, 48.0);
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetNumberOfLevels( 2 );
+  registration->SetFractionOfStartsKept( 0.5 );
+
+  const unsigned int numberOfStarts = 7;
+  const double       initialTranslations[numberOfStarts][Dimension] = {
+      { 0.0, 0.0 }, { 20.0, 15.0 }, { -20.0, 10.0 }, { 6.0, 1.0 },
+      { 15.0, -20.0 }, { -2.0, -6.0 }, { 500.0, 500.0 } };
+
+  for ( unsigned int s = 0; s < numberOfStarts; s++ )
+    {
+    MetricType::Pointer       metric = MetricType::New();
+    OptimizerType::Pointer    optimizer = OptimizerType::New();
+    TransformType::Pointer    transform = TransformType::New();
+    InterpolatorType::Pointer interpolator = InterpolatorType::New();
+
+    metric->SetNumberOfFixedImageSamples( 2000 );
+    optimizer->SetMaximumStepLength( 2.0 );
+    optimizer->SetMinimumStepLength( 0.01 );
+    optimizer->SetNumberOfIterations( 100 );
+
+    RegistrationType::ParametersType initialParameters( transform->GetNumberOfParameters() );
+    initialParameters[0] = initialTranslations[s][0];
+    initialParameters[1] = initialTranslations[s][1];
+
+    registration->AddStart( metric, optimizer, transform, interpolator, initialParameters );
+    }
+
+  // the components of a start cannot be shared
+  bool caught = false;
+  try
+    {
+    RegistrationType::ParametersType initialParameters( Dimension );
+    initialParameters.Fill( 0.0 );
+    registration->AddStart( MetricType::New(), OptimizerType::New(), TransformType::New(),
+                            InterpolatorType::New(), initialParameters );
+    MetricType::Pointer metric = MetricType::New();
+    registration->AddStart( metric, OptimizerType::New(), TransformType::New(),
+                            InterpolatorType::New(), initialParameters );
+    registration->AddStart( metric, OptimizerType::New(), TransformType::New(),
+                            InterpolatorType::New(), initialParameters );
+    }
+  catch ( itk::ExceptionObject & err )
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    caught = true;
+    }
+
+  int status = EXIT_SUCCESS;
+  if ( !caught || registration->GetNumberOfStarts() != numberOfStarts + 2 )
+    {
+    std::cerr << "A start sharing a component was added." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  try
+    {
+    registration->StartRegistration();
+    }
+  catch ( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  registration->Print( std::cout );
+
+  // the start outside of the moving image fails
+  if ( registration->GetNumberOfResults() != numberOfStarts + 1 )
+    {
+    std::cerr << registration->GetNumberOfResults() << " results instead of "
+              << numberOfStarts + 1 << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  for ( unsigned int r = 0; r < registration->GetNumberOfResults(); r++ )
+    {
+    if ( registration->GetResultStart( r ) == numberOfStarts - 1 )
+      {
+      std::cerr << "The start outside of the moving image has a result." << std::endl;
+      status = EXIT_FAILURE;
+      }
+    if ( r > 0 && registration->GetResultNumberOfLevels( r ) == registration->GetResultNumberOfLevels( r - 1 )
+         && registration->GetResultValue( r ) < registration->GetResultValue( r - 1 ) )
+      {
+      std::cerr << "The result " << r << " is better than the result " << r - 1 << std::endl;
+      status = EXIT_FAILURE;
+      }
+    }
+
+  // half of the starts are optimized at the finest level
+  unsigned int numberOfFinishedStarts = 0;
+  for ( unsigned int r = 0; r < registration->GetNumberOfResults(); r++ )
+    {
+    if ( registration->GetResultNumberOfLevels( r ) == 2 )
+      {
+      numberOfFinishedStarts++;
+      }
+    }
+  if ( numberOfFinishedStarts != 4 )
+    {
+    std::cerr << numberOfFinishedStarts << " starts were optimized at the finest level instead of 4"
+              << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  const RegistrationType::ParametersType & parameters = registration->GetResultParameters( 0 );
+  std::cout << "Best translation: " << parameters << " from start " << registration->GetResultStart( 0 )
+            << std::endl;
+  if ( vnl_math_abs( parameters[0] - 3.0 ) > 0.1 || vnl_math_abs( parameters[1] + 2.0 ) > 0.1 )
+    {
+    std::cerr << "The best translation " << parameters << " is not ( 3, -2 )." << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  // the default fixed image region follows the new fixed image
+  ImageType::Pointer     smallFixedImage = ImageType::New();
+  ImageType::RegionType  smallRegion( fixedImage->GetLargestPossibleRegion() );
+  smallRegion.SetSize( 0, 80 );
+  smallRegion.SetSize( 1, 70 );
+  smallFixedImage->SetRegions( smallRegion );
+  smallFixedImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > smallIt( smallFixedImage, smallRegion );
+  for ( smallIt.GoToBegin(); !smallIt.IsAtEnd(); ++smallIt )
+    {
+    smallIt.Set( fixedImage->GetPixel( smallIt.GetIndex() ) );
+    }
+  try
+    {
+    registration->SetFixedImage( smallFixedImage );
+    registration->StartRegistration();
+    }
+  catch ( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+  if ( registration->GetNumberOfResults() != numberOfStarts + 1 )
+    {
+    std::cerr << "With the smaller fixed image: " << registration->GetNumberOfResults()
+              << " results instead of " << numberOfStarts + 1 << std::endl;
+    status = EXIT_FAILURE;
+    }
+
+  try
+    {
+    RegistrationType::Pointer reference = RegisterWithMutualInformation( fixedImage, movingImage, 1 );
+    RegistrationType::Pointer threaded = RegisterWithMutualInformation( fixedImage, movingImage, 4 );
+    if ( reference->GetNumberOfResults() != 3 || threaded->GetNumberOfResults() != 3 )
+      {
+      std::cerr << "Mutual information: " << reference->GetNumberOfResults() << " and "
+                << threaded->GetNumberOfResults() << " results instead of 3" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for ( unsigned int r = 0; r < 3; r++ )
+      {
+      std::cout << "Mutual information start " << reference->GetResultStart( r ) << ": "
+                << reference->GetResultParameters( r ) << " " << reference->GetResultValue( r ) << std::endl;
+      if ( threaded->GetResultStart( r ) != reference->GetResultStart( r )
+           || threaded->GetResultParameters( r ) != reference->GetResultParameters( r )
+           || threaded->GetResultValue( r ) != reference->GetResultValue( r ) )
+        {
+        std::cerr << "Mutual information: the result " << r << " differs with 4 threads: "
+                  << threaded->GetResultParameters( r ) << " " << threaded->GetResultValue( r ) << std::endl;
+        status = EXIT_FAILURE;
+        }
+      }
+    }
+  catch ( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -20,6 +20,7 @@
 
 #include "itkDenseFiniteDifferenceImageFilter.h"
 #include "itkPDEDeformableRegistrationFunction.h"
+#include "itkImageRegionSplitter.h"
 
 namespace itk
 {
@@ -103,6 +104,7 @@ public:
 
   /** Types inherithed from the superclass */
   typedef typename Superclass::OutputImageType OutputImageType;
+  typedef typename Superclass::TimeStepType    TimeStepType;
 
   /** FiniteDifferenceFunction type. */
   typedef typename Superclass::FiniteDifferenceFunctionType
@@ -182,6 +184,20 @@ public:
    * smoothing the update field. */
   itkGetConstReferenceMacro(UpdateFieldStandardDeviations, StandardDeviationsType);
 
+  /** Set/Get whether the update of the deformation field and its
+   * smoothing are fused in a single multithreaded pass. When it is on and
+   * SmoothDeformationField is on, the update computed in an iteration is
+   * added to the deformation field while the field is smoothed at the
+   * beginning of the next iteration, so that the field is read and
+   * written once per iteration instead of once for the update and once
+   * for each direction of the smoothing. The deformation field is the same
+   * as the one computed without fusion, but the output seen by the
+   * observers of the IterationEvent does not include the last update yet.
+   * The default is off. */
+  itkSetMacro(UseFusedUpdate, bool);
+  itkGetConstMacro(UseFusedUpdate, bool);
+  itkBooleanMacro(UseFusedUpdate);
+
   /** Stop the registration after the current iteration. */
   virtual void StopRegistration()
   { m_StopRegistrationFlag = true; }
@@ -230,6 +246,31 @@ protected:
    * UpdateFieldStandardDeviations. */
   virtual void SmoothUpdateField();
 
+  /** Smooth a field in place with a separable Gaussian operator of the
+   * given standard deviations. Each direction is convolved in a single
+   * multithreaded pass into a temporary field whose pixel container is
+   * then swapped with the one of the field, so that no image is allocated
+   * once the temporary field has the size of the field. The borders are
+   * handled with zero flux Neumann conditions. */
+  virtual void SmoothGivenField(DeformationFieldType *field,
+                                const StandardDeviationsType & standardDeviations);
+
+  /** Add the update buffer scaled by the time step to the deformation
+   * field and smooth the result with the StandardDeviations in a single
+   * multithreaded pass. Each thread sweeps a slab of the field along its
+   * last direction and keeps the hyperslices needed by the Gaussian kernel
+   * of that direction, updated and smoothed along the other directions, in
+   * a ring of buffers. The result is the same as the one of
+   * Superclass::ApplyUpdate() followed by SmoothDeformationField(). */
+  virtual void ApplyUpdateAndSmoothDeformationField(TimeStepType dt);
+
+  /** Add the update to the deformation field, or postpone it to the
+   * smoothing of the next iteration when UseFusedUpdate is on. */
+  virtual void ApplyUpdate(TimeStepType dt);
+
+  /** Apply the postponed update before computing the next one. */
+  virtual TimeStepType CalculateChange();
+
   /** This method is called after the solution has been generated. In this case,
    * the filter release the memory of the internal buffers. */
   virtual void PostProcessOutput();
@@ -263,9 +304,58 @@ private:
   bool m_SmoothDeformationField;
   bool m_SmoothUpdateField;
 
+  /** Fuse the update with the smoothing of the deformation field. */
+  bool m_UseFusedUpdate;
+
+  /** Time step of the update which is not yet added to the deformation
+   * field. */
+  bool         m_UpdatePending;
+  TimeStepType m_PendingTimeStep;
+
   /** Temporary deformation field use for smoothing the
    * the deformation field. */
   DeformationFieldPointer m_TempField;
+
+  /** Give the temporary field the geometry of the field and allocate it. */
+  void AllocateTempField(const DeformationFieldType *field);
+
+  /** Add the postponed update to the deformation field. */
+  void ApplyPendingUpdate();
+
+  /** Structure passed to the threads convolving a field along one
+   * direction. */
+  typedef typename DeformationFieldType::RegionType   FieldRegionType;
+  typedef ImageRegionSplitter< ImageDimension >       FieldSplitterType;
+  typedef typename DeformationFieldType::PixelType    FieldPixelType;
+  typedef typename FieldPixelType::ValueType          FieldScalarType;
+  struct SmoothFieldThreadStruct {
+    const DeformationFieldType *Input;
+    DeformationFieldType *Output;
+    typename FieldSplitterType::Pointer Splitter;
+    unsigned int NumberOfSplits;
+    unsigned int Direction;
+    const FieldScalarType *Kernel;
+    unsigned int Radius;
+  };
+
+  /** Convolve the split region of the current thread along one
+   * direction. */
+  static ITK_THREAD_RETURN_TYPE SmoothFieldThreaderCallback(void *arg);
+
+  /** Structure passed to the threads updating and smoothing a slab of the
+   * deformation field. */
+  typedef std::vector< FieldScalarType > KernelType;
+  struct FusedUpdateThreadStruct {
+    const DeformationFieldType *Field;
+    const DeformationFieldType *Update;
+    DeformationFieldType *Output;
+    TimeStepType TimeStep;
+    const KernelType *Kernels;
+    unsigned int NumberOfSlabs;
+  };
+
+  /** Update and smooth the slab of the current thread. */
+  static ITK_THREAD_RETURN_TYPE FusedUpdateThreaderCallback(void *arg);
 private:
   /** Maximum error for Gaussian operator approximation. */
   double m_MaximumError;
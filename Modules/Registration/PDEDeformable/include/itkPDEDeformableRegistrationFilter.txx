@@ -25,7 +25,6 @@
 #include "itkDataObject.h"
 
 #include "itkGaussianOperator.h"
-#include "itkVectorNeighborhoodOperatorImageFilter.h"
 
 #include "vnl/vnl_math.h"
 
@@ -56,6 +55,10 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
 
   m_SmoothDeformationField = true;
   m_SmoothUpdateField = false;
+
+  m_UseFusedUpdate = false;
+  m_UpdatePending = false;
+  m_PendingTimeStep = 0.0;
 }
 
 /*
@@ -213,6 +216,8 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
     os << m_UpdateFieldStandardDeviations[j] << ", ";
     }
   os << m_UpdateFieldStandardDeviations[j] << "]" << std::endl;
+  os << indent << "Use fused update: "
+     << ( m_UseFusedUpdate ? "on" : "off" ) << std::endl;
   os << indent << "StopRegistrationFlag: ";
   os << m_StopRegistrationFlag << std::endl;
   os << indent << "MaximumError: ";
@@ -362,6 +367,8 @@ void
 PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
 ::PostProcessOutput()
 {
+  // the update of the last iteration is not followed by a smoothing
+  this->ApplyPendingUpdate();
   this->Superclass::PostProcessOutput();
   m_TempField->Initialize();
 }
@@ -376,6 +383,52 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
 {
   this->Superclass::Initialize();
   m_StopRegistrationFlag = false;
+  m_UpdatePending = false;
+}
+
+/*
+ * Apply the update, or postpone it to the smoothing of the next iteration
+ */
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::ApplyUpdate(TimeStepType dt)
+{
+  if ( m_UseFusedUpdate && m_SmoothDeformationField )
+    {
+    m_PendingTimeStep = dt;
+    m_UpdatePending = true;
+    this->GetOutput()->Modified();
+    }
+  else
+    {
+    this->Superclass::ApplyUpdate(dt);
+    }
+}
+
+/*
+ * Apply the postponed update if the subclass did not smooth the field
+ */
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+typename PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::TimeStepType
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::CalculateChange()
+{
+  this->ApplyPendingUpdate();
+  return this->Superclass::CalculateChange();
+}
+
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::ApplyPendingUpdate()
+{
+  if ( m_UpdatePending )
+    {
+    m_UpdatePending = false;
+    this->Superclass::ApplyUpdate(m_PendingTimeStep);
+    }
 }
 
 /*
@@ -386,9 +439,92 @@ void
 PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
 ::SmoothDeformationField()
 {
-  DeformationFieldPointer field = this->GetOutput();
+  if ( m_UpdatePending )
+    {
+    m_UpdatePending = false;
+    this->ApplyUpdateAndSmoothDeformationField(m_PendingTimeStep);
+    }
+  else
+    {
+    this->SmoothGivenField(this->GetOutput(), m_StandardDeviations);
+    }
+}
+
+/*
+ * Smooth deformation using a separable Gaussian kernel
+ */
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::SmoothUpdateField()
+{
+  // The update buffer will be overwritten with new data.
+  this->SmoothGivenField(this->GetUpdateBuffer(),
+                         this->GetUpdateFieldStandardDeviations());
+}
+
+/*
+ * Smooth a field in place using a separable Gaussian kernel
+ */
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::SmoothGivenField(DeformationFieldType *field,
+                   const StandardDeviationsType & standardDeviations)
+{
+  this->AllocateTempField(field);
+
+  typedef GaussianOperator< FieldScalarType, ImageDimension > OperatorType;
+
+  typedef typename DeformationFieldType::PixelContainerPointer
+  PixelContainerPointer;
+  PixelContainerPointer swapPtr;
+
+  SmoothFieldThreadStruct str;
+  str.Splitter = FieldSplitterType::New();
+  str.NumberOfSplits = str.Splitter->GetNumberOfSplits(
+    field->GetBufferedRegion(), this->GetNumberOfThreads() );
+
+  std::vector< FieldScalarType > kernel;
+  for ( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+    // smooth along this dimension
+    OperatorType oper;
+    oper.SetDirection(j);
+    double variance = vnl_math_sqr(standardDeviations[j]);
+    oper.SetVariance(variance);
+    oper.SetMaximumError(m_MaximumError);
+    oper.SetMaximumKernelWidth(m_MaximumKernelWidth);
+    oper.CreateDirectional();
+    kernel.assign( oper.Begin(), oper.End() );
+
+    str.Input = field;
+    str.Output = m_TempField;
+    str.Direction = j;
+    str.Kernel = &kernel[0];
+    str.Radius = oper.GetRadius(j);
+
+    this->GetMultiThreader()->SetNumberOfThreads(str.NumberOfSplits);
+    this->GetMultiThreader()->SetSingleMethod(this->SmoothFieldThreaderCallback,
+                                              &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    // swap the containers, the field now holds the smoothed values
+    swapPtr = field->GetPixelContainer();
+    field->SetPixelContainer( m_TempField->GetPixelContainer() );
+    m_TempField->SetPixelContainer(swapPtr);
+    }
+
+  field->Modified();
+}
 
-  // copy field to TempField
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+void
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::AllocateTempField(const DeformationFieldType *field)
+{
+  // the temporary field has the geometry of the field. Allocate() keeps
+  // the memory of the previous call when it is large enough.
   m_TempField->SetOrigin( field->GetOrigin() );
   m_TempField->SetSpacing( field->GetSpacing() );
   m_TempField->SetDirection( field->GetDirection() );
@@ -398,113 +534,267 @@ PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
     field->GetRequestedRegion() );
   m_TempField->SetBufferedRegion( field->GetBufferedRegion() );
   m_TempField->Allocate();
+}
 
-  typedef typename DeformationFieldType::PixelType       VectorType;
-  typedef typename VectorType::ValueType                 ScalarType;
-  typedef GaussianOperator< ScalarType, ImageDimension > OperatorType;
-  typedef VectorNeighborhoodOperatorImageFilter<
-    DeformationFieldType,
-    DeformationFieldType >                             SmootherType;
-
-  OperatorType *oper = new OperatorType;
-  typename SmootherType::Pointer smoother = SmootherType::New();
-
-  typedef typename DeformationFieldType::PixelContainerPointer
-  PixelContainerPointer;
-  PixelContainerPointer swapPtr;
-
-  // graft the output field onto the mini-pipeline
-  smoother->GraftOutput(m_TempField);
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+ITK_THREAD_RETURN_TYPE
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::SmoothFieldThreaderCallback(void *arg)
+{
+  const unsigned int threadId =
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const SmoothFieldThreadStruct *str = (SmoothFieldThreadStruct *)
+                                       ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
 
-  for ( unsigned int j = 0; j < ImageDimension; j++ )
+  if ( threadId >= str->NumberOfSplits )
     {
-    // smooth along this dimension
-    oper->SetDirection(j);
-    double variance = vnl_math_sqr(m_StandardDeviations[j]);
-    oper->SetVariance(variance);
-    oper->SetMaximumError(m_MaximumError);
-    oper->SetMaximumKernelWidth(m_MaximumKernelWidth);
-    oper->CreateDirectional();
+    return ITK_THREAD_RETURN_VALUE;
+    }
 
-    // todo: make sure we only smooth within the buffered region
-    smoother->SetOperator(*oper);
-    smoother->SetInput(field);
-    smoother->Update();
+  const FieldRegionType & bufferedRegion = str->Input->GetBufferedRegion();
+  const FieldRegionType   region =
+    str->Splitter->GetSplit(threadId, str->NumberOfSplits, bufferedRegion);
+
+  // the pixels beyond the borders of the buffer along the direction are
+  // replaced by the pixel on the border
+  const unsigned int    direction = str->Direction;
+  const OffsetValueType radius = str->Radius;
+  const OffsetValueType first = bufferedRegion.GetIndex(direction);
+  const OffsetValueType last = first
+                               + static_cast< OffsetValueType >( bufferedRegion.GetSize(direction) ) - 1;
+  const OffsetValueType stride = str->Input->GetOffsetTable()[direction];
+  const SizeValueType   lineLength = region.GetSize(direction);
+
+  const FieldPixelType *inputBuffer = str->Input->GetBufferPointer();
+  FieldPixelType *      outputBuffer = str->Output->GetBufferPointer();
+
+  ImageLinearIteratorWithIndex< DeformationFieldType > it(str->Output, region);
+  it.SetDirection(direction);
+  it.GoToBegin();
+  while ( !it.IsAtEnd() )
+    {
+    // both fields have the same buffered region
+    const typename DeformationFieldType::IndexType lineIndex = it.GetIndex();
+    OffsetValueType offset = str->Input->ComputeOffset(lineIndex);
+    OffsetValueType position = lineIndex[direction];
 
-    if ( j < ImageDimension - 1 )
+    for ( SizeValueType i = 0; i < lineLength; ++i, ++position, offset += stride )
       {
-      // swap the containers
-      swapPtr = smoother->GetOutput()->GetPixelContainer();
-      smoother->GraftOutput(field);
-      field->SetPixelContainer(swapPtr);
-      smoother->Modified();
+      FieldPixelType sum;
+      for ( unsigned int k = 0; k < FieldPixelType::Dimension; ++k )
+        {
+        sum[k] = NumericTraits< FieldScalarType >::Zero;
+        }
+
+      const FieldScalarType *coefficient = str->Kernel;
+      for ( OffsetValueType n = position - radius; n <= position + radius; ++n, ++coefficient )
+        {
+        const OffsetValueType clamped = ( n < first ) ? first : ( ( n > last ) ? last : n );
+        const FieldPixelType &value = inputBuffer[offset + ( clamped - position ) * stride];
+        for ( unsigned int k = 0; k < FieldPixelType::Dimension; ++k )
+          {
+          sum[k] += *coefficient * value[k];
+          }
+        }
+
+      outputBuffer[offset] = sum;
       }
+    it.NextLine();
     }
 
-  // graft the output back to this filter
-  m_TempField->SetPixelContainer( field->GetPixelContainer() );
-  this->GraftOutput( smoother->GetOutput() );
-
-  delete oper;
+  return ITK_THREAD_RETURN_VALUE;
 }
-
 /*
- * Smooth deformation using a separable Gaussian kernel
+ * Add the update to the deformation field and smooth the result in a
+ * single pass
  */
 template< class TFixedImage, class TMovingImage, class TDeformationField >
 void
 PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
-::SmoothUpdateField()
+::ApplyUpdateAndSmoothDeformationField(TimeStepType dt)
 {
-  // The update buffer will be overwritten with new data.
-  DeformationFieldPointer field = this->GetUpdateBuffer();
+  DeformationFieldType *field = this->GetOutput();
+  DeformationFieldType *update = this->GetUpdateBuffer();
+
+  // the update is applied to the requested region of the output
+  if ( field->GetRequestedRegion() != field->GetBufferedRegion()
+       || update->GetBufferedRegion() != field->GetBufferedRegion() )
+    {
+    this->Superclass::ApplyUpdate(dt);
+    this->SmoothGivenField(field, m_StandardDeviations);
+    return;
+    }
 
-  typedef typename DeformationFieldType::PixelType       VectorType;
-  typedef typename VectorType::ValueType                 ScalarType;
-  typedef GaussianOperator< ScalarType, ImageDimension > OperatorType;
-  typedef VectorNeighborhoodOperatorImageFilter<
-    DeformationFieldType,
-    DeformationFieldType >                             SmootherType;
+  this->AllocateTempField(field);
 
-  OperatorType opers[ImageDimension];
-  typename SmootherType::Pointer smoothers[ImageDimension];
+  typedef GaussianOperator< FieldScalarType, ImageDimension > OperatorType;
 
+  KernelType kernels[ImageDimension];
   for ( unsigned int j = 0; j < ImageDimension; j++ )
     {
-    // smooth along this dimension
-    opers[j].SetDirection(j);
-    double variance = vnl_math_sqr(this->GetUpdateFieldStandardDeviations()[j]);
-    //double variance = vnl_math_sqr( 1.0 );
-    opers[j].SetVariance(variance);
-    opers[j].SetMaximumError( this->GetMaximumError() );
-    opers[j].SetMaximumKernelWidth( this->GetMaximumKernelWidth() );
-    opers[j].CreateDirectional();
-
-    smoothers[j] = SmootherType::New();
-    smoothers[j]->SetOperator(opers[j]);
-    smoothers[j]->ReleaseDataFlagOn();
-
-    if ( j > 0 )
+    OperatorType oper;
+    oper.SetDirection(j);
+    double variance = vnl_math_sqr(m_StandardDeviations[j]);
+    oper.SetVariance(variance);
+    oper.SetMaximumError(m_MaximumError);
+    oper.SetMaximumKernelWidth(m_MaximumKernelWidth);
+    oper.CreateDirectional();
+    kernels[j].assign( oper.Begin(), oper.End() );
+    }
+
+  FusedUpdateThreadStruct str;
+  str.Field = field;
+  str.Update = update;
+  str.Output = m_TempField;
+  str.TimeStep = dt;
+  str.Kernels = kernels;
+  str.NumberOfSlabs = vnl_math_min(
+    static_cast< SizeValueType >( this->GetNumberOfThreads() ),
+    field->GetBufferedRegion().GetSize(ImageDimension - 1) );
+
+  this->GetMultiThreader()->SetNumberOfThreads(str.NumberOfSlabs);
+  this->GetMultiThreader()->SetSingleMethod(this->FusedUpdateThreaderCallback,
+                                            &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // swap the containers, the field now holds the smoothed values
+  typename DeformationFieldType::PixelContainerPointer swapPtr =
+    field->GetPixelContainer();
+  field->SetPixelContainer( m_TempField->GetPixelContainer() );
+  m_TempField->SetPixelContainer(swapPtr);
+
+  field->Modified();
+}
+
+template< class TFixedImage, class TMovingImage, class TDeformationField >
+ITK_THREAD_RETURN_TYPE
+PDEDeformableRegistrationFilter< TFixedImage, TMovingImage, TDeformationField >
+::FusedUpdateThreaderCallback(void *arg)
+{
+  const unsigned int threadId =
+    ( (MultiThreader::ThreadInfoStruct *)( arg ) )->ThreadID;
+  const FusedUpdateThreadStruct *str = (FusedUpdateThreadStruct *)
+                                       ( ( (MultiThreader::ThreadInfoStruct *)( arg ) )->UserData );
+
+  if ( threadId >= str->NumberOfSlabs )
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  // the hyperslices orthogonal to the last direction are contiguous in
+  // the buffers, which all have the same buffered region
+  const unsigned int      last = ImageDimension - 1;
+  const FieldRegionType & region = str->Field->GetBufferedRegion();
+  const OffsetValueType   sliceSize = str->Field->GetOffsetTable()[last];
+  const OffsetValueType   numberOfSlices = region.GetSize(last);
+  const OffsetValueType   begin = numberOfSlices * threadId / str->NumberOfSlabs;
+  const OffsetValueType   end = numberOfSlices * ( threadId + 1 ) / str->NumberOfSlabs;
+
+  const FieldPixelType *fieldBuffer = str->Field->GetBufferPointer();
+  const FieldPixelType *updateBuffer = str->Update->GetBufferPointer();
+  FieldPixelType *      outputBuffer = str->Output->GetBufferPointer();
+
+  // the hyperslices within the radius of the kernel along the last
+  // direction. The slice s is kept in the buffer s modulo the size of the
+  // ring until it is out of the kernel.
+  const KernelType &    lastKernel = str->Kernels[last];
+  const OffsetValueType radius = ( lastKernel.size() - 1 ) / 2;
+  const OffsetValueType ringSize = 2 * radius + 1;
+  std::vector< std::vector< FieldPixelType > > ring( ringSize );
+  std::vector< OffsetValueType >               ringSlice(ringSize, -1);
+  std::vector< FieldPixelType >                scratch(sliceSize);
+
+  for ( OffsetValueType slice = begin; slice < end; ++slice )
+    {
+    // update and smooth the missing hyperslices along the other directions
+    for ( OffsetValueType n = slice - radius; n <= slice + radius; ++n )
+      {
+      const OffsetValueType clamped =
+        ( n < 0 ) ? 0 : ( ( n >= numberOfSlices ) ? numberOfSlices - 1 : n );
+      std::vector< FieldPixelType > & hyperslice = ring[clamped % ringSize];
+      if ( ringSlice[clamped % ringSize] == clamped )
+        {
+        continue;
+        }
+      ringSlice[clamped % ringSize] = clamped;
+      hyperslice.resize(sliceSize);
+
+      // same operations as DenseFiniteDifferenceImageFilter::ThreadedApplyUpdate()
+      const FieldPixelType *o = fieldBuffer + clamped * sliceSize;
+      const FieldPixelType *u = updateBuffer + clamped * sliceSize;
+      for ( OffsetValueType p = 0; p < sliceSize; ++p )
+        {
+        hyperslice[p] = o[p];
+        hyperslice[p] += static_cast< FieldPixelType >( u[p] * str->TimeStep );
+        }
+
+      for ( unsigned int direction = 0; direction < last; ++direction )
+        {
+        const KernelType &    kernel = str->Kernels[direction];
+        const OffsetValueType r = ( kernel.size() - 1 ) / 2;
+        const OffsetValueType stride = str->Field->GetOffsetTable()[direction];
+        const OffsetValueType size = region.GetSize(direction);
+        // position of the pixel p along the direction
+        OffsetValueType position = 0;
+        OffsetValueType count = 0;
+        for ( OffsetValueType p = 0; p < sliceSize; ++p )
+          {
+          FieldPixelType sum;
+          for ( unsigned int k = 0; k < FieldPixelType::Dimension; ++k )
+            {
+            sum[k] = NumericTraits< FieldScalarType >::Zero;
+            }
+          typename KernelType::const_iterator coefficient = kernel.begin();
+          for ( OffsetValueType m = position - r; m <= position + r; ++m, ++coefficient )
+            {
+            const OffsetValueType c = ( m < 0 ) ? 0 : ( ( m >= size ) ? size - 1 : m );
+            const FieldPixelType &value = hyperslice[p + ( c - position ) * stride];
+            for ( unsigned int k = 0; k < FieldPixelType::Dimension; ++k )
+              {
+              sum[k] += *coefficient * value[k];
+              }
+            }
+          scratch[p] = sum;
+          if ( ++count == stride )
+            {
+            count = 0;
+            if ( ++position == size )
+              {
+              position = 0;
+              }
+            }
+          }
+        hyperslice.swap(scratch);
+        }
+      }
+
+    // convolve along the last direction, adding the taps in the order
+    // of SmoothFieldThreaderCallback()
+    FieldPixelType *output = outputBuffer + slice * sliceSize;
+    for ( OffsetValueType p = 0; p < sliceSize; ++p )
+      {
+      for ( unsigned int k = 0; k < FieldPixelType::Dimension; ++k )
+        {
+        output[p][k] = NumericTraits< FieldScalarType >::Zero;
+        }
+      }
+    typename KernelType::const_iterator coefficient = lastKernel.begin();
+    for ( OffsetValueType n = slice - radius; n <= slice + radius; ++n, ++coefficient )
       {
-      smoothers[j]->SetInput( smoothers[j - 1]->GetOutput() );
+      const OffsetValueType clamped =
+        ( n < 0 ) ? 0 : ( ( n >= numberOfSlices ) ? numberOfSlices - 1 : n );
+      const FieldPixelType *value = &ring[clamped % ringSize][0];
+      for ( OffsetValueType p = 0; p < sliceSize; ++p )
+        {
+        for ( unsigned int k = 0; k < FieldPixelType::Dimension; ++k )
+          {
+          output[p][k] += *coefficient * value[p][k];
+          }
+        }
       }
     }
-  smoothers[0]->SetInput(field);
-  smoothers[ImageDimension - 1]->GetOutput()
-  ->SetRequestedRegion( field->GetBufferedRegion() );
-
-  smoothers[ImageDimension - 1]->Update();
-
-  // field to contain the final smoothed data, do the equivalent of a graft
-  field->SetPixelContainer( smoothers[ImageDimension - 1]->GetOutput()
-                            ->GetPixelContainer() );
-  field->SetRequestedRegion( smoothers[ImageDimension - 1]->GetOutput()
-                             ->GetRequestedRegion() );
-  field->SetBufferedRegion( smoothers[ImageDimension - 1]->GetOutput()
-                            ->GetBufferedRegion() );
-  field->SetLargestPossibleRegion( smoothers[ImageDimension - 1]->GetOutput()
-                                   ->GetLargestPossibleRegion() );
-  field->CopyInformation( smoothers[ImageDimension - 1]->GetOutput() );
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 } // end namespace itk
 
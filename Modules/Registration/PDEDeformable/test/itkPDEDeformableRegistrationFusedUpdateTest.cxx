@@ -0,0 +1,154 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkDemonsRegistrationFilter.h"
+#include "itkSymmetricForcesDemonsRegistrationFilter.h"
+#include "itkLevelSetMotionRegistrationFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+// Check that the deformation field computed with UseFusedUpdate on is the
+// same as the one computed with it off, and report the time taken by
+// both.
+
+namespace
+{
+const unsigned int ImageDimension = 3;
+
+typedef itk::Image< float, ImageDimension >         ImageType;
+typedef itk::Vector< float, ImageDimension >        VectorType;
+typedef itk::Image< VectorType, ImageDimension >    FieldType;
+
+// an ellipsoid with a smooth border
+ImageType::Pointer CreateImage(const double *center)
+{
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 36;
+  size[2] = 30;
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    double distance = 0.0;
+    for ( unsigned int j = 0; j < ImageDimension; j++ )
+      {
+      distance += vnl_math_sqr( ( it.GetIndex()[j] - center[j] ) / ( 8.0 + j ) );
+      }
+    it.Set( 100.0 / ( 1.0 + vcl_exp( 4.0 * ( vcl_sqrt(distance) - 1.0 ) ) ) );
+    }
+  return image;
+}
+
+template< class TRegistration >
+int CompareFusedUpdate(const char *name, bool smoothUpdateField)
+{
+  const double fixedCenter[ImageDimension] = { 20.0, 18.0, 15.0 };
+  const double movingCenter[ImageDimension] = { 22.0, 16.5, 14.0 };
+
+  ImageType::Pointer fixed = CreateImage(fixedCenter);
+  ImageType::Pointer moving = CreateImage(movingCenter);
+
+  FieldType::Pointer fields[2];
+  itk::TimeProbe     timers[2];
+  for ( unsigned int fused = 0; fused < 2; fused++ )
+    {
+    typename TRegistration::Pointer registration = TRegistration::New();
+    registration->SetFixedImage(fixed);
+    registration->SetMovingImage(moving);
+    registration->SetNumberOfIterations(20);
+    registration->SetStandardDeviations(1.5);
+    registration->SetSmoothUpdateField(smoothUpdateField);
+    registration->SetUseFusedUpdate(fused != 0);
+
+    timers[fused].Start();
+    registration->Update();
+    timers[fused].Stop();
+
+    fields[fused] = registration->GetOutput();
+    fields[fused]->DisconnectPipeline();
+    }
+
+  std::cout << name << ( smoothUpdateField ? " (smooth update field)" : "" )
+            << ": " << timers[0].GetTotal() << " s, fused "
+            << timers[1].GetTotal() << " s" << std::endl;
+
+  itk::ImageRegionIteratorWithIndex< FieldType > it( fields[0], fields[0]->GetBufferedRegion() );
+  itk::ImageRegionIteratorWithIndex< FieldType > fusedIt( fields[1], fields[1]->GetBufferedRegion() );
+  double maximumNorm = 0.0;
+  for ( ; !it.IsAtEnd(); ++it, ++fusedIt )
+    {
+    if ( it.Get() != fusedIt.Get() )
+      {
+      std::cerr << name << ": the fused update gives " << fusedIt.Get()
+                << " instead of " << it.Get() << " at " << it.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    maximumNorm = vnl_math_max( maximumNorm, static_cast< double >( it.Get().GetNorm() ) );
+    }
+
+  // the images are registered
+  if ( maximumNorm < 0.5 )
+    {
+    std::cerr << name << ": the deformation field is too small: " << maximumNorm << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
+}
+
+int itkPDEDeformableRegistrationFusedUpdateTest(int, char *[])
+{
+  int status = EXIT_SUCCESS;
+
+  typedef itk::DemonsRegistrationFilter< ImageType, ImageType, FieldType > DemonsType;
+  if ( CompareFusedUpdate< DemonsType >("DemonsRegistrationFilter", false) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+  if ( CompareFusedUpdate< DemonsType >("DemonsRegistrationFilter", true) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::SymmetricForcesDemonsRegistrationFilter< ImageType, ImageType, FieldType >
+  SymmetricForcesType;
+  if ( CompareFusedUpdate< SymmetricForcesType >("SymmetricForcesDemonsRegistrationFilter",
+                                                 false) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  typedef itk::LevelSetMotionRegistrationFilter< ImageType, ImageType, FieldType >
+  LevelSetMotionType;
+  if ( CompareFusedUpdate< LevelSetMotionType >("LevelSetMotionRegistrationFilter",
+                                                false) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}
@@ -34,6 +34,11 @@ namespace itk
  * For the case of binary images the median can be obtained by simply conting
  * the neigbors that are foreground.
  *
+ * The neighborhood is moved along the lines of the image, and only the
+ * pixels entering and leaving it are counted at each step, so the cost
+ * per pixel is proportional to the size of a face of the neighborhood,
+ * rather than to its volume.
+ *
  * A median filter is one of the family of nonlinear filters.  It is
  * used to smooth an image without being biased by outliers or shot noise.
  *
@@ -137,6 +142,11 @@ protected:
   void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                             int threadId);
 
+  /** Count the foreground pixels with a neighborhood moved along the
+   * lines of the image. */
+  void MovingWindowThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                        int threadId);
+
 private:
   BinaryMedianImageFilter(const Self &); //purposely not implemented
   void operator=(const Self &);          //purposely not implemented
@@ -22,6 +22,7 @@
 #include "itkConstNeighborhoodIterator.h"
 #include "itkNeighborhoodInnerProduct.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
@@ -96,6 +97,15 @@ BinaryMedianImageFilter< TInputImage, TOutputImage >
 ::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
                        int threadId)
 {
+  // moving the neighborhood costs two faces of the neighborhood per
+  // pixel, and is cheaper than counting the whole neighborhood as soon
+  // as its radius is not null along the first dimension
+  if ( m_Radius[0] > 0 )
+    {
+    this->MovingWindowThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
   ZeroFluxNeumannBoundaryCondition< InputImageType > nbc;
 
   ConstNeighborhoodIterator< InputImageType > bit;
@@ -159,6 +169,125 @@ BinaryMedianImageFilter< TInputImage, TOutputImage >
     }
 }
 
+template< class TInputImage, class TOutputImage >
+void
+BinaryMedianImageFilter< TInputImage, TOutputImage >
+::MovingWindowThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                   int threadId)
+{
+  typedef typename InputImageType::IndexType IndexType;
+  typedef std::vector< OffsetValueType >     OffsetContainerType;
+
+  OutputImageType *     output = this->GetOutput();
+  const InputImageType *input = this->GetInput();
+
+  // The pixels outside the buffered region are replaced by the nearest
+  // pixel of the buffered region, as with the
+  // ZeroFluxNeumannBoundaryCondition used by the neighborhood iterator.
+  const InputImageRegionType bufferedRegion = input->GetBufferedRegion();
+  const IndexType            bufferedIndex = bufferedRegion.GetIndex();
+  const OffsetValueType *    offsetTable = input->GetOffsetTable();
+  const InputPixelType *     buffer = input->GetBufferPointer();
+  IndexType                  bufferedLast;
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    bufferedLast[i] = bufferedIndex[i] + static_cast< OffsetValueType >( bufferedRegion.GetSize()[i] ) - 1;
+    }
+
+  SizeValueType neighborhoodSize = 1;
+  for ( unsigned int i = 0; i < InputImageDimension; i++ )
+    {
+    neighborhoodSize *= 2 * m_Radius[i] + 1;
+    }
+  const SizeValueType   medianPosition = neighborhoodSize / 2;
+  const OffsetValueType radius0 = static_cast< OffsetValueType >( m_Radius[0] );
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels()
+                             / outputRegionForThread.GetSize()[0] );
+
+  OffsetContainerType columnOffsets;
+  OffsetContainerType previousOffsets;
+
+  ImageLinearIteratorWithIndex< OutputImageType > it(output, outputRegionForThread);
+  it.SetDirection(0);
+  for ( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+    {
+    const IndexType lineStart = it.GetIndex();
+
+    // offsets in the buffer of the pixels of a column of the
+    // neighborhood, made of all the dimensions but the first one
+    columnOffsets.assign(1, 0);
+    for ( unsigned int i = 1; i < InputImageDimension; i++ )
+      {
+      previousOffsets.swap(columnOffsets);
+      columnOffsets.clear();
+      for ( OffsetValueType k = -static_cast< OffsetValueType >( m_Radius[i] );
+            k <= static_cast< OffsetValueType >( m_Radius[i] ); k++ )
+        {
+        const OffsetValueType coord =
+          vnl_math_min( vnl_math_max(lineStart[i] + k, bufferedIndex[i]), bufferedLast[i] );
+        const OffsetValueType offset = ( coord - bufferedIndex[i] ) * offsetTable[i];
+        for ( typename OffsetContainerType::const_iterator oit = previousOffsets.begin();
+              oit != previousOffsets.end(); ++oit )
+          {
+          columnOffsets.push_back(*oit + offset);
+          }
+        }
+      }
+
+    // count the foreground pixels in the neighborhood of the first pixel
+    OffsetValueType x = lineStart[0];
+    SizeValueType   count = 0;
+    for ( OffsetValueType k = x - radius0; k <= x + radius0; k++ )
+      {
+      const InputPixelType *column = buffer
+                                     + vnl_math_min(vnl_math_max(k, bufferedIndex[0]), bufferedLast[0])
+                                     - bufferedIndex[0];
+      for ( typename OffsetContainerType::const_iterator oit = columnOffsets.begin();
+            oit != columnOffsets.end(); ++oit )
+        {
+        if ( column[*oit] == m_ForegroundValue )
+          {
+          count++;
+          }
+        }
+      }
+
+    // and move the neighborhood along the line
+    for ( it.GoToBeginOfLine(); !it.IsAtEndOfLine(); ++it, ++x )
+      {
+      if ( count > medianPosition )
+        {
+        it.Set( static_cast< OutputPixelType >( m_ForegroundValue ) );
+        }
+      else
+        {
+        it.Set( static_cast< OutputPixelType >( m_BackgroundValue ) );
+        }
+
+      const InputPixelType *removed = buffer
+                                      + vnl_math_min(vnl_math_max(x - radius0, bufferedIndex[0]), bufferedLast[0])
+                                      - bufferedIndex[0];
+      const InputPixelType *added = buffer
+                                    + vnl_math_min(vnl_math_max(x + radius0 + 1, bufferedIndex[0]), bufferedLast[0])
+                                    - bufferedIndex[0];
+      for ( typename OffsetContainerType::const_iterator oit = columnOffsets.begin();
+            oit != columnOffsets.end(); ++oit )
+        {
+        if ( added[*oit] == m_ForegroundValue )
+          {
+          count++;
+          }
+        if ( removed[*oit] == m_ForegroundValue )
+          {
+          count--;
+          }
+        }
+      }
+    progress.CompletedPixel();
+    }
+}
+
 /**
  * Standard "PrintSelf" method
  */
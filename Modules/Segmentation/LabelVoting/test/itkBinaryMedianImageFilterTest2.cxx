@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "itkBinaryMedianImageFilter.h"
+#include "itkVotingBinaryImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+// Compare BinaryMedianImageFilter, which moves the neighborhood along
+// the lines when the radius is not null along the first dimension, with
+// VotingBinaryImageFilter, which counts the whole neighborhood of each
+// pixel: with birth and survival thresholds of half the neighborhood plus
+// one, it computes the same binary median.
+
+namespace
+{
+typedef unsigned short PixelType;
+
+const PixelType Foreground = 97;
+const PixelType Background = 29;
+
+template< unsigned int VDimension >
+int CheckRadius(const itk::Image< PixelType, VDimension > *image,
+                const typename itk::Image< PixelType, VDimension >::SizeType & radius)
+{
+  typedef itk::Image< PixelType, VDimension >                  ImageType;
+  typedef itk::BinaryMedianImageFilter< ImageType, ImageType > MedianType;
+  typedef itk::VotingBinaryImageFilter< ImageType, ImageType > VotingType;
+
+  typename MedianType::Pointer median = MedianType::New();
+  median->SetInput( image );
+  median->SetRadius( radius );
+  median->SetForegroundValue( Foreground );
+  median->SetBackgroundValue( Background );
+  median->SetNumberOfThreads( 3 );
+  median->Update();
+
+  unsigned int neighborhoodSize = 1;
+  for ( unsigned int i = 0; i < VDimension; i++ )
+    {
+    neighborhoodSize *= 2 * radius[i] + 1;
+    }
+
+  typename VotingType::Pointer voting = VotingType::New();
+  voting->SetInput( image );
+  voting->SetRadius( radius );
+  voting->SetForegroundValue( Foreground );
+  voting->SetBackgroundValue( Background );
+  voting->SetBirthThreshold( neighborhoodSize / 2 + 1 );
+  voting->SetSurvivalThreshold( neighborhoodSize / 2 + 1 );
+  voting->Update();
+
+  unsigned long differences = 0;
+  itk::ImageRegionConstIteratorWithIndex< ImageType > mit( median->GetOutput(),
+                                                           image->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIteratorWithIndex< ImageType > vit( voting->GetOutput(),
+                                                           image->GetLargestPossibleRegion() );
+  for ( ; !mit.IsAtEnd(); ++mit, ++vit )
+    {
+    if ( mit.Get() != vit.Get() )
+      {
+      differences++;
+      }
+    }
+
+  std::cout << VDimension << "D, radius " << radius << ": " << differences
+            << " pixels differ from VotingBinaryImageFilter" << std::endl;
+  return differences == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+template< unsigned int VDimension >
+int CheckDimension(const typename itk::Image< PixelType, VDimension >::SizeType & size,
+                   const unsigned long radii[][VDimension], unsigned int numberOfRadii)
+{
+  typedef itk::Image< PixelType, VDimension > ImageType;
+
+  // an image which doesn't start at the origin of the index space, made
+  // of foreground and background pixels only, with about as many of each
+  typename ImageType::RegionType region;
+  for ( unsigned int i = 0; i < VDimension; i++ )
+    {
+    region.SetIndex( i, 3 - 5 * static_cast< long >( i ) );
+    }
+  region.SetSize( size );
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+  image->Allocate();
+
+  unsigned long seed = 1;
+  itk::ImageRegionIterator< ImageType > it( image, region );
+  for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    seed = ( seed * 1103515245 + 12345 ) % 2147483648UL;
+    it.Set( ( seed >> 16 ) % 100 < 48 ? Foreground : Background );
+    }
+
+  int status = EXIT_SUCCESS;
+  for ( unsigned int r = 0; r < numberOfRadii; r++ )
+    {
+    typename ImageType::SizeType radius;
+    for ( unsigned int i = 0; i < VDimension; i++ )
+      {
+      radius[i] = radii[r][i];
+      }
+    if ( CheckRadius< VDimension >( image, radius ) != EXIT_SUCCESS )
+      {
+      status = EXIT_FAILURE;
+      }
+    }
+  return status;
+}
+}
+
+int itkBinaryMedianImageFilterTest2(int, char* [] )
+{
+  int status = EXIT_SUCCESS;
+
+  // the radius along the first dimension is null in the first case, for
+  // which the whole neighborhood is counted for each pixel
+  itk::Size< 2 > size2;
+  size2[0] = 53;
+  size2[1] = 37;
+  const unsigned long radii2[][2] = { { 0, 2 }, { 1, 1 }, { 4, 0 }, { 3, 7 }, { 20, 2 } };
+  if ( CheckDimension< 2 >( size2, radii2, 5 ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  itk::Size< 3 > size3;
+  size3[0] = 23;
+  size3[1] = 19;
+  size3[2] = 11;
+  const unsigned long radii3[][3] = { { 0, 1, 2 }, { 1, 1, 1 }, { 2, 0, 3 }, { 5, 3, 1 } };
+  if ( CheckDimension< 3 >( size3, radii3, 4 ) != EXIT_SUCCESS )
+    {
+    status = EXIT_FAILURE;
+    }
+
+  return status;
+}